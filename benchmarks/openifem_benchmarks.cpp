@@ -0,0 +1,529 @@
+/**
+ * Microbenchmarks of the kernels in the coupling and the solid solvers.
+ *
+ * Every benchmark is set up on a generated mesh with a number of global
+ * refinements, then its body is repeated until the minimum time is reached.
+ * The results are printed and written in the JSON format of Google Benchmark
+ * so that the runs before and after a change can be compared with its tools.
+ *
+ * Usage: openifem_benchmarks [--benchmark_filter=<substring>]
+ *                            [--benchmark_out=<file>]
+ *                            [--benchmark_min_time=<seconds>]
+ *                            [--sizes=<refinements,...>]
+ *
+ * The private kernels of the solvers, i.e., the BlockSchurPreconditioners and
+ * the cell assembly, are only reachable through the solvers and are measured
+ * by the timer sections of the regression tests instead.
+ */
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/lac/vector.h>
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "hyper_elastic_kernel.h"
+#include "nodal_projection.h"
+#include "utilities.h"
+
+extern template class Utils::CellLocator<2, DoFHandler<2, 2>>;
+extern template class Utils::CellLocator<3, DoFHandler<3, 3>>;
+extern template class Utils::CellLinkedList<2>;
+extern template class Utils::CellLinkedList<3>;
+extern template class Utils::SPHInterpolator<2, Vector<double>>;
+extern template class Utils::SPHInterpolator<3, Vector<double>>;
+extern template class Utils::SPHSourceCells<2>;
+extern template class Utils::SPHSourceCells<3>;
+extern template class Utils::SPHPointEvaluator<2, Vector<double>>;
+extern template class Utils::SPHPointEvaluator<3, Vector<double>>;
+
+using namespace dealii;
+
+namespace
+{
+  /// The body of a benchmark and the number of items it processes per call.
+  struct Body
+  {
+    std::function<void()> run;
+    unsigned long items;
+  };
+
+  struct Benchmark
+  {
+    std::string name;
+    std::function<Body(const unsigned int)> setup;
+  };
+
+  struct Result
+  {
+    std::string name;
+    unsigned long iterations;
+    double real_time; //!< ns per iteration
+    double cpu_time;  //!< ns per iteration
+    double items_per_second;
+  };
+
+  /// A mesh of a ball with a vector and a scalar element.
+  template <int dim>
+  struct Mesh
+  {
+    Mesh(const unsigned int n_refinements)
+      : fe(FE_Q<dim>(1), dim), scalar_fe(1)
+    {
+      GridGenerator::hyper_ball(tria);
+      tria.refine_global(n_refinements);
+      dof_handler.initialize(tria, fe);
+      scalar_dof_handler.initialize(tria, scalar_fe);
+    }
+
+    Triangulation<dim> tria;
+    FESystem<dim> fe;
+    FE_Q<dim> scalar_fe;
+    DoFHandler<dim> dof_handler;
+    DoFHandler<dim> scalar_dof_handler;
+  };
+
+  /// Points uniformly distributed in the bounding box of the unit ball.
+  template <int dim>
+  std::vector<Point<dim>> random_points(const unsigned int n_points)
+  {
+    std::mt19937 generator(2019);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    std::vector<Point<dim>> points(n_points);
+    for (auto &p : points)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            p[d] = distribution(generator);
+          }
+      }
+    return points;
+  }
+
+  /// Points along a line through the ball, as a moving point would be.
+  template <int dim>
+  std::vector<Point<dim>> path_points(const unsigned int n_points)
+  {
+    std::vector<Point<dim>> points(n_points);
+    for (unsigned int i = 0; i < n_points; ++i)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            points[i][d] = -0.6 + 1.2 * i / n_points;
+          }
+      }
+    return points;
+  }
+
+  /// The cell boxes binned by the inside test of the serial FSI in 2D.
+  template <int dim>
+  std::vector<typename Utils::CellLinkedList<dim>::Box>
+  cell_boxes(const DoFHandler<dim> &dof_handler)
+  {
+    std::vector<typename Utils::CellLinkedList<dim>::Box> boxes;
+    for (auto cell : dof_handler.active_cell_iterators())
+      {
+        typename Utils::CellLinkedList<dim>::Box box(cell->vertex(0),
+                                                     cell->vertex(0));
+        for (unsigned int v = 1; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                box.first[d] = std::min(box.first[d], cell->vertex(v)[d]);
+                box.second[d] = std::max(box.second[d], cell->vertex(v)[d]);
+              }
+          }
+        boxes.push_back(box);
+      }
+    return boxes;
+  }
+
+  /// FSI::point_in_solid in 2D: the candidates from the cell-linked list.
+  Body point_in_solid_2d(const unsigned int n_refinements)
+  {
+    auto mesh = std::make_shared<Mesh<2>>(n_refinements);
+    auto cells =
+      std::make_shared<std::vector<DoFHandler<2>::active_cell_iterator>>();
+    for (auto cell : mesh->dof_handler.active_cell_iterators())
+      {
+        cells->push_back(cell);
+      }
+    auto list = std::make_shared<Utils::CellLinkedList<2>>();
+    list->build(cell_boxes(mesh->dof_handler));
+    auto points =
+      std::make_shared<std::vector<Point<2>>>(random_points<2>(1000));
+    return {[mesh, cells, list, points]() {
+              std::vector<unsigned int> candidates;
+              unsigned int n_inside = 0;
+              for (auto &p : *points)
+                {
+                  list->point_query(p, candidates);
+                  for (auto c : candidates)
+                    {
+                      if ((*cells)[c]->point_inside(p))
+                        {
+                          ++n_inside;
+                          break;
+                        }
+                    }
+                }
+              (void)n_inside;
+            },
+            points->size()};
+  }
+
+  /// FSI::point_in_solid in 3D: the rays against the boundary surface.
+  Body point_in_solid_3d(const unsigned int n_refinements)
+  {
+    auto mesh = std::make_shared<Mesh<3>>(n_refinements);
+    auto surface = std::make_shared<Utils::ClosedSurface>();
+    surface->reinit(mesh->tria);
+    auto points =
+      std::make_shared<std::vector<Point<3>>>(random_points<3>(1000));
+    return {[mesh, surface, points]() {
+              unsigned int n_inside = 0;
+              for (auto &p : *points)
+                {
+                  n_inside += surface->point_inside(p);
+                }
+              (void)n_inside;
+            },
+            points->size()};
+  }
+
+  /// CellLocator::search, either from the last cell or globally.
+  template <int dim>
+  Body cell_locator_search(const unsigned int n_refinements,
+                           const bool use_hint)
+  {
+    auto mesh = std::make_shared<Mesh<dim>>(n_refinements);
+    auto locator =
+      std::make_shared<Utils::CellLocator<dim, DoFHandler<dim>>>(
+        mesh->dof_handler);
+    locator->reinit();
+    auto points =
+      std::make_shared<std::vector<Point<dim>>>(path_points<dim>(200));
+    return {[mesh, locator, points, use_hint]() {
+              auto hint = mesh->dof_handler.begin_active();
+              for (auto &p : *points)
+                {
+                  auto cell = locator->search(
+                    p, use_hint ? hint : mesh->dof_handler.begin_active());
+                  if (locator->found_cell())
+                    {
+                      hint = cell;
+                    }
+                }
+            },
+            points->size()};
+  }
+
+  /// SPHInterpolator construction, by a loop over the cells or from bins.
+  template <int dim>
+  Body sph_construction(const unsigned int n_refinements, const bool binned)
+  {
+    auto mesh = std::make_shared<Mesh<dim>>(n_refinements);
+    auto source_cells = std::make_shared<Utils::SPHSourceCells<dim>>();
+    source_cells->reinit(mesh->dof_handler);
+    auto points =
+      std::make_shared<std::vector<Point<dim>>>(random_points<dim>(100));
+    return {
+      [mesh, source_cells, points, binned]() {
+        for (auto &p : *points)
+          {
+            if (binned)
+              {
+                Utils::SPHInterpolator<dim, Vector<double>> interpolator(
+                  mesh->dof_handler, p, *source_cells);
+              }
+            else
+              {
+                Utils::SPHInterpolator<dim, Vector<double>> interpolator(
+                  mesh->dof_handler, p);
+              }
+          }
+      },
+      points->size()};
+  }
+
+  /// SPHPointEvaluator::evaluate of the values and gradients.
+  template <int dim>
+  Body sph_batch_evaluation(const unsigned int n_refinements)
+  {
+    auto mesh = std::make_shared<Mesh<dim>>(n_refinements);
+    Utils::SPHSourceCells<dim> source_cells;
+    source_cells.reinit(mesh->dof_handler);
+    auto evaluator =
+      std::make_shared<Utils::SPHPointEvaluator<dim, Vector<double>>>(
+        mesh->dof_handler);
+    const unsigned int n_points = 1000;
+    evaluator->reinit(random_points<dim>(n_points), source_cells);
+    auto solution =
+      std::make_shared<Vector<double>>(mesh->dof_handler.n_dofs());
+    for (unsigned int i = 0; i < solution->size(); ++i)
+      {
+        (*solution)[i] = std::sin(i);
+      }
+    return {[mesh, evaluator, solution]() {
+              std::vector<Vector<double>> values;
+              std::vector<std::vector<Tensor<1, dim>>> gradients;
+              evaluator->evaluate(*solution, values, gradients);
+            },
+            n_points};
+  }
+
+  /// The constitutive kernel of the hyperelastic solvers at 1000 points.
+  template <int dim>
+  Body neo_hookean_kernel(const unsigned int)
+  {
+    using Kernel = Solid::HyperElasticKernel<Solid::NeoHookean, dim>;
+    using Number = typename Kernel::Number;
+    const unsigned int n_batches = 1000 / Kernel::n_lanes;
+    auto F = std::make_shared<std::vector<Tensor<2, dim, Number>>>(n_batches);
+    std::mt19937 generator(2019);
+    std::uniform_real_distribution<double> distribution(-0.1, 0.1);
+    for (auto &f : *F)
+      {
+        for (unsigned int i = 0; i < dim; ++i)
+          {
+            for (unsigned int j = 0; j < dim; ++j)
+              {
+                for (unsigned int v = 0; v < Kernel::n_lanes; ++v)
+                  {
+                    f[i][j][v] = (i == j ? 1.0 : 0.0) + distribution(generator);
+                  }
+              }
+          }
+      }
+    return {[F]() {
+              Number c1, kappa, det_F;
+              c1 = 1.0;
+              kappa = 10.0;
+              SymmetricTensor<2, dim, Number> tau;
+              SymmetricTensor<4, dim, Number> Jc;
+              for (auto &f : *F)
+                {
+                  Kernel::evaluate(c1, kappa, f, det_F, tau, Jc);
+                }
+            },
+            n_batches * Kernel::n_lanes};
+  }
+
+  /// The projection of the strain and stress of the solid solvers.
+  template <int dim>
+  Body nodal_projection(const unsigned int n_refinements)
+  {
+    auto mesh = std::make_shared<Mesh<dim>>(n_refinements);
+    return {[mesh]() {
+              const QGauss<dim> quadrature(2);
+              const unsigned int n_components = 2 * dim * dim;
+              Utils::NodalProjection<dim> projection(
+                mesh->scalar_fe,
+                quadrature,
+                n_components,
+                mesh->scalar_dof_handler.n_dofs());
+              std::vector<types::global_dof_index> dof_indices(
+                mesh->scalar_fe.dofs_per_cell);
+              for (auto cell : mesh->scalar_dof_handler.active_cell_iterators())
+                {
+                  for (unsigned int q = 0; q < quadrature.size(); ++q)
+                    {
+                      for (unsigned int k = 0; k < n_components; ++k)
+                        {
+                          projection.value(q, k) = q + k;
+                        }
+                    }
+                  cell->get_dof_indices(dof_indices);
+                  projection.add_cell(dof_indices);
+                }
+              Vector<double> sum(mesh->scalar_dof_handler.n_dofs());
+              projection.add_to(0, sum);
+            },
+            mesh->tria.n_active_cells()};
+  }
+
+  std::vector<Benchmark> benchmarks()
+  {
+    return {
+      {"FSI::point_in_solid<2>", point_in_solid_2d},
+      {"FSI::point_in_solid<3>", point_in_solid_3d},
+      {"CellLocator::search<2>/hint",
+       [](const unsigned int n) { return cell_locator_search<2>(n, true); }},
+      {"CellLocator::search<2>/global",
+       [](const unsigned int n) { return cell_locator_search<2>(n, false); }},
+      {"CellLocator::search<3>/hint",
+       [](const unsigned int n) { return cell_locator_search<3>(n, true); }},
+      {"SPHInterpolator<2>/all_cells",
+       [](const unsigned int n) { return sph_construction<2>(n, false); }},
+      {"SPHInterpolator<2>/binned",
+       [](const unsigned int n) { return sph_construction<2>(n, true); }},
+      {"SPHInterpolator<3>/binned",
+       [](const unsigned int n) { return sph_construction<3>(n, true); }},
+      {"SPHPointEvaluator<2>::evaluate", sph_batch_evaluation<2>},
+      {"HyperElasticKernel<NeoHookean, 3>::evaluate", neo_hookean_kernel<3>},
+      {"NodalProjection<2>", nodal_projection<2>},
+      {"NodalProjection<3>", nodal_projection<3>}};
+  }
+
+  /// Repeat the body until the minimum time is reached.
+  Result run(const std::string &name, const Body &body, const double min_time)
+  {
+    using Clock = std::chrono::steady_clock;
+    body.run(); // Warm up
+    unsigned long iterations = 0;
+    const Clock::time_point start = Clock::now();
+    const std::clock_t cpu_start = std::clock();
+    double elapsed = 0;
+    while (elapsed < min_time)
+      {
+        body.run();
+        ++iterations;
+        elapsed =
+          std::chrono::duration<double>(Clock::now() - start).count();
+      }
+    const double cpu_elapsed =
+      static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    return {name,
+            iterations,
+            1e9 * elapsed / iterations,
+            1e9 * cpu_elapsed / iterations,
+            body.items * iterations / elapsed};
+  }
+
+  void write_json(const std::string &filename,
+                  const std::string &executable,
+                  const std::vector<Result> &results)
+  {
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(
+      date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+    std::ofstream file(filename);
+    AssertThrow(file, ExcMessage("Cannot open " + filename));
+    file << std::setprecision(10);
+    file << "{\n  \"context\": {\n"
+         << "    \"date\": \"" << date << "\",\n"
+         << "    \"executable\": \"" << executable << "\"\n  },\n"
+         << "  \"benchmarks\": [";
+    for (unsigned int i = 0; i < results.size(); ++i)
+      {
+        const Result &r = results[i];
+        file << (i == 0 ? "\n" : ",\n") << "    {\n"
+             << "      \"name\": \"" << r.name << "\",\n"
+             << "      \"iterations\": " << r.iterations << ",\n"
+             << "      \"real_time\": " << r.real_time << ",\n"
+             << "      \"cpu_time\": " << r.cpu_time << ",\n"
+             << "      \"time_unit\": \"ns\",\n"
+             << "      \"items_per_second\": " << r.items_per_second << "\n"
+             << "    }";
+      }
+    file << "\n  ]\n}\n";
+  }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      std::string filter;
+      std::string output = "openifem_benchmarks.json";
+      double min_time = 0.5;
+      std::vector<unsigned int> sizes = {3, 4, 5};
+      for (int i = 1; i < argc; ++i)
+        {
+          const std::string arg(argv[i]);
+          auto value = [&arg](const std::string &option) {
+            return arg.substr(option.size());
+          };
+          if (arg.find("--benchmark_filter=") == 0)
+            {
+              filter = value("--benchmark_filter=");
+            }
+          else if (arg.find("--benchmark_out=") == 0)
+            {
+              output = value("--benchmark_out=");
+            }
+          else if (arg.find("--benchmark_min_time=") == 0)
+            {
+              min_time = std::stod(value("--benchmark_min_time="));
+            }
+          else if (arg.find("--sizes=") == 0)
+            {
+              sizes.clear();
+              std::istringstream list(value("--sizes="));
+              std::string size;
+              while (std::getline(list, size, ','))
+                {
+                  sizes.push_back(std::stoi(size));
+                }
+            }
+          else
+            {
+              AssertThrow(false, ExcMessage("Unknown option " + arg));
+            }
+        }
+
+      std::vector<Result> results;
+      std::cout << std::left << std::setw(56) << "Benchmark" << std::right
+                << std::setw(14) << "Time (ns)" << std::setw(12)
+                << "Iterations" << std::setw(16) << "Items/s" << std::endl;
+      for (auto &benchmark : benchmarks())
+        {
+          for (auto size : sizes)
+            {
+              const std::string name =
+                benchmark.name + "/" + std::to_string(size);
+              if (name.find(filter) == std::string::npos)
+                continue;
+              const Result result =
+                run(name, benchmark.setup(size), min_time);
+              std::cout << std::left << std::setw(56) << result.name
+                        << std::right << std::setw(14) << std::fixed
+                        << std::setprecision(0) << result.real_time
+                        << std::setw(12) << result.iterations << std::setw(16)
+                        << std::scientific << std::setprecision(3)
+                        << result.items_per_second << std::endl;
+              results.push_back(result);
+            }
+        }
+      write_json(output, argv[0], results);
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,421 @@
+/**
+ * Weak and strong scaling runs of the MPI solvers on generated meshes.
+ *
+ * The simulation type of the parameter file picks the case, which is the
+ * geometry of one of the MPI tests with colorized boundaries:
+ * - Fluid: InsIMEX in the channel of fluid_pipe_mpi, 2 x 0.1 with cells of
+ *   0.04 (and as deep as high in 3D);
+ * - Solid: HyperElasticity in the beam of solid_beam_bending_mpi_NeoHookean,
+ *   40 x 4 (x 4) cells over 10 x 1 (x 1);
+ * - FSI: InsIM and SharedHyperElasticity in the box and the sphere of
+ *   fsi_gravity_mpi.
+ * The Global refinements of the parameter file are the refinements of the
+ * fluid and the solid meshes. For strong scaling they are used as they are.
+ * For weak scaling every factor of 2^dim of the number of processes adds a
+ * global refinement of the distributed mesh, and the remaining factor
+ * replicates the domain along x, so the DoFs per process stay the same when
+ * the number of processes is a power of 2. The shared solid of the FSI case
+ * is not scaled.
+ *
+ * A fixed number of time steps is run with the performance summary of the
+ * solvers, whose timer sections are then grouped into the phases setup,
+ * assembly, preconditioner setup, solve, coupling and output. The throughput
+ * of a phase is the number of DoFs, times the time steps except for the
+ * setup, over its wall time on the first process. The solve includes the
+ * parts of the preconditioner setup that are done inside of the solvers.
+ * The results are printed and written as JSON.
+ *
+ * Usage: mpirun -np <n> openifem_scaling <parameters.prm>
+ *                                        [--scaling=weak|strong]
+ *                                        [--steps=<time steps>]
+ *                                        [--out=<file>]
+ */
+#include <deal.II/base/mpi.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/grid/grid_generator.h>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mpi_fsi.h"
+#include "mpi_hyper_elasticity.h"
+#include "mpi_insim.h"
+#include "mpi_insimex.h"
+#include "mpi_shared_hyper_elasticity.h"
+#include "parameters.h"
+#include "utilities.h"
+
+extern template class Fluid::MPI::InsIM<2>;
+extern template class Fluid::MPI::InsIM<3>;
+extern template class Fluid::MPI::InsIMEX<2>;
+extern template class Fluid::MPI::InsIMEX<3>;
+extern template class Solid::MPI::HyperElasticity<2>;
+extern template class Solid::MPI::HyperElasticity<3>;
+extern template class Solid::MPI::SharedHyperElasticity<2>;
+extern template class Solid::MPI::SharedHyperElasticity<3>;
+extern template class Utils::GridCreator<2>;
+extern template class Utils::GridCreator<3>;
+extern template class MPI::FSI<2>;
+extern template class MPI::FSI<3>;
+
+using namespace dealii;
+
+namespace
+{
+  /// The extra global refinements and the replication of the domain.
+  struct Scaling
+  {
+    unsigned int refinements;
+    unsigned int replicas;
+  };
+
+  /// Keep the DoFs per process for weak scaling, the problem for strong.
+  Scaling make_scaling(const bool weak, const unsigned int dim)
+  {
+    Scaling scaling{0, 1};
+    if (!weak)
+      {
+        return scaling;
+      }
+    unsigned int factor = Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD);
+    const unsigned int children = 1u << dim;
+    while (factor >= children)
+      {
+        factor /= children;
+        ++scaling.refinements;
+      }
+    scaling.replicas = factor;
+    return scaling;
+  }
+
+  /// A box of subdivisions starting at the origin, replicated along x.
+  template <int dim>
+  void replicated_box(Triangulation<dim> &tria,
+                      std::vector<unsigned int> subdivisions,
+                      Point<dim> extent,
+                      const unsigned int replicas)
+  {
+    subdivisions[0] *= replicas;
+    extent[0] *= replicas;
+    GridGenerator::subdivided_hyper_rectangle(
+      tria, subdivisions, Point<dim>(), extent, true);
+  }
+
+  /// Run a case and return the number of DoFs of its solvers.
+  template <int dim>
+  types::global_dof_index run_case(const Parameters::AllParameters &params,
+                                   const Scaling &scaling)
+  {
+    const unsigned int fluid_refinements =
+      params.global_refinements[0] + scaling.refinements;
+    const unsigned int solid_refinements =
+      params.global_refinements[1] + scaling.refinements;
+    if (params.simulation_type == "Fluid")
+      {
+        const double L = 2.0, D = 0.2, h = 0.04;
+        parallel::distributed::Triangulation<dim> tria(MPI_COMM_WORLD);
+        std::vector<unsigned int> subdivisions(
+          dim, static_cast<unsigned int>(D / (2 * h)));
+        subdivisions[0] = static_cast<unsigned int>(L / h);
+        Point<dim> extent;
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            extent[d] = d == 0 ? L : D / 2;
+          }
+        replicated_box(tria, subdivisions, extent, scaling.replicas);
+        tria.refine_global(fluid_refinements);
+        Fluid::MPI::InsIMEX<dim> flow(tria, params);
+        flow.run();
+        return flow.get_current_solution().size();
+      }
+    else if (params.simulation_type == "Solid")
+      {
+        const double L = 10.0, H = 1.0;
+        parallel::distributed::Triangulation<dim> tria(MPI_COMM_WORLD);
+        std::vector<unsigned int> subdivisions(dim, 4);
+        subdivisions[0] = 40;
+        Point<dim> extent;
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            extent[d] = d == 0 ? L : H;
+          }
+        replicated_box(tria, subdivisions, extent, scaling.replicas);
+        tria.refine_global(solid_refinements);
+        Solid::MPI::HyperElasticity<dim> solid(tria, params);
+        solid.run();
+        return solid.get_current_solution().size();
+      }
+    AssertThrow(params.simulation_type == "FSI",
+                ExcMessage("Unknown simulation type " +
+                           params.simulation_type + "!"));
+    const double L = 1, W = 2, H = 5, R = 0.125, h = 0.25;
+    parallel::distributed::Triangulation<dim> fluid_tria(MPI_COMM_WORLD);
+    std::vector<unsigned int> subdivisions(dim,
+                                           static_cast<unsigned int>(W / h));
+    subdivisions[dim - 1] = static_cast<unsigned int>(H / h);
+    Point<dim> extent, center;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        extent[d] = d == dim - 1 ? -H : W;
+        center[d] = d == dim - 1 ? -L : L;
+      }
+    replicated_box(fluid_tria, subdivisions, extent, scaling.replicas);
+    fluid_tria.refine_global(fluid_refinements);
+    Fluid::MPI::InsIM<dim> fluid(fluid_tria, params);
+
+    Triangulation<dim> solid_tria;
+    Utils::GridCreator<dim>::sphere(solid_tria, center, R);
+    solid_tria.refine_global(params.global_refinements[1]);
+    Solid::MPI::SharedHyperElasticity<dim> solid(solid_tria, params);
+
+    MPI::FSI<dim> fsi(fluid, solid, params, true);
+    fsi.run();
+    return fluid.get_current_solution().size() +
+           solid.get_current_solution().size();
+  }
+
+  /// The phase of a timer section of a solver, empty if it is in none.
+  std::string phase(const std::string &solver, const std::string &section)
+  {
+    if (section == "Setup system")
+      return "setup";
+    if (section.find("Assemble") == 0 || section == "Update QPH data")
+      return "assembly";
+    if (section == "AMG setup" || section == "MUMPS factorization" ||
+        section == "Matrix-free setup" ||
+        section == "Update matrix-free tangent")
+      return "preconditioner setup";
+    if (section == "Solve linear system")
+      return "solve";
+    if (solver == "fsi" &&
+        (section == "Move solid mesh" || section == "Update indicator" ||
+         section == "Find fluid BC" || section == "Find solid BC" ||
+         section == "Update solid overlap"))
+      return "coupling";
+    if (section == "Output results")
+      return "output";
+    return "";
+  }
+
+  /// Add up the sections in the summary into the phases.
+  std::map<std::string, double> read_phases(const std::string &filename)
+  {
+    std::map<std::string, double> phases;
+    for (const std::string name : {"setup",
+                                   "assembly",
+                                   "preconditioner setup",
+                                   "solve",
+                                   "coupling",
+                                   "output"})
+      {
+        phases[name] = 0;
+      }
+    std::ifstream file(filename);
+    AssertThrow(file, ExcMessage("Cannot open " + filename));
+    std::string line;
+    while (std::getline(file, line))
+      {
+        if (line.empty())
+          continue;
+        std::istringstream entry_stream(line);
+        boost::property_tree::ptree entry;
+        boost::property_tree::read_json(entry_stream, entry);
+        const std::string solver = entry.get<std::string>("name");
+        for (const auto &section : entry.get_child("sections"))
+          {
+            const std::string name = phase(solver, section.first);
+            if (!name.empty())
+              {
+                phases[name] += section.second.get_value<double>();
+              }
+          }
+      }
+    return phases;
+  }
+
+  void write_json(const std::string &filename,
+                  const std::string &executable,
+                  const std::string &parameters,
+                  const bool weak,
+                  const unsigned int steps,
+                  const types::global_dof_index n_dofs,
+                  const double wall_time,
+                  const std::map<std::string, double> &phases,
+                  const std::map<std::string, double> &throughput)
+  {
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(
+      date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+    std::ofstream file(filename);
+    AssertThrow(file, ExcMessage("Cannot open " + filename));
+    file << std::setprecision(10);
+    file << "{\n  \"context\": {\n"
+         << "    \"date\": \"" << date << "\",\n"
+         << "    \"executable\": \"" << executable << "\",\n"
+         << "    \"parameters\": \"" << parameters << "\",\n"
+         << "    \"scaling\": \"" << (weak ? "weak" : "strong") << "\",\n"
+         << "    \"processes\": "
+         << Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD) << ",\n"
+         << "    \"dofs\": " << n_dofs << ",\n"
+         << "    \"time_steps\": " << steps << ",\n"
+         << "    \"wall_time\": " << wall_time << "\n  },\n"
+         << "  \"phases\": [";
+    bool first = true;
+    for (const auto &p : phases)
+      {
+        file << (first ? "\n" : ",\n") << "    {\n"
+             << "      \"name\": \"" << p.first << "\",\n"
+             << "      \"wall_time\": " << p.second << ",\n"
+             << "      \"dofs_per_second\": " << throughput.at(p.first)
+             << "\n    }";
+        first = false;
+      }
+    file << "\n  ]\n}\n";
+  }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      const bool root = Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0;
+
+      std::string infile("parameters.prm");
+      std::string output = "openifem_scaling.json";
+      bool weak = true;
+      unsigned int steps = 10;
+      for (int i = 1; i < argc; ++i)
+        {
+          const std::string arg(argv[i]);
+          auto value = [&arg](const std::string &option) {
+            return arg.substr(option.size());
+          };
+          if (arg.find("--scaling=") == 0)
+            {
+              AssertThrow(value("--scaling=") == "weak" ||
+                            value("--scaling=") == "strong",
+                          ExcMessage("The scaling must be weak or strong!"));
+              weak = value("--scaling=") == "weak";
+            }
+          else if (arg.find("--steps=") == 0)
+            {
+              steps = std::stoi(value("--steps="));
+            }
+          else if (arg.find("--out=") == 0)
+            {
+              output = value("--out=");
+            }
+          else if (arg.find("--") != 0)
+            {
+              infile = arg;
+            }
+          else
+            {
+              AssertThrow(false, ExcMessage("Unknown option " + arg));
+            }
+        }
+
+      // The solvers append to the summary when they are destroyed.
+      const std::string summary = output + ".summary";
+      if (root)
+        {
+          std::remove(summary.c_str());
+        }
+      const Parameters::AllParameters params(
+        infile,
+        "Simulation/Performance steps = " + std::to_string(steps) +
+          "|Simulation/Performance summary = " + summary);
+      const Scaling scaling = make_scaling(weak, params.dimension);
+
+      using Clock = std::chrono::steady_clock;
+      const Clock::time_point start = Clock::now();
+      types::global_dof_index n_dofs = 0;
+      if (params.dimension == 2)
+        {
+          n_dofs = run_case<2>(params, scaling);
+        }
+      else if (params.dimension == 3)
+        {
+          n_dofs = run_case<3>(params, scaling);
+        }
+      else
+        {
+          AssertThrow(false, ExcNotImplemented());
+        }
+      const double wall_time =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+      if (root)
+        {
+          const auto phases = read_phases(summary);
+          std::map<std::string, double> throughput;
+          std::cout << std::endl
+                    << (weak ? "Weak" : "Strong") << " scaling on "
+                    << Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD)
+                    << " processes, " << n_dofs << " DoFs, " << steps
+                    << " time steps, " << wall_time << " s" << std::endl
+                    << std::left << std::setw(24) << "Phase" << std::right
+                    << std::setw(14) << "Time (s)" << std::setw(16)
+                    << "DoFs/s" << std::endl;
+          for (const auto &p : phases)
+            {
+              const double items =
+                static_cast<double>(n_dofs) * (p.first == "setup" ? 1 : steps);
+              throughput[p.first] = p.second > 0 ? items / p.second : 0;
+              std::cout << std::left << std::setw(24) << p.first << std::right
+                        << std::setw(14) << std::fixed << std::setprecision(3)
+                        << p.second << std::setw(16) << std::scientific
+                        << std::setprecision(3) << throughput[p.first]
+                        << std::endl;
+            }
+          write_json(output,
+                     argv[0],
+                     infile,
+                     weak,
+                     steps,
+                     n_dofs,
+                     wall_time,
+                     phases,
+                     throughput);
+        }
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
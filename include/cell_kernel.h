@@ -0,0 +1,103 @@
+#ifndef CELL_KERNEL
+#define CELL_KERNEL
+
+#include <deal.II/base/exceptions.h>
+
+#include <array>
+#include <type_traits>
+#include <vector>
+
+namespace Utils
+{
+  /*! \brief An array of a quantity per dof of a cell whose size is known at
+   *  compile time.
+   *
+   *  The common combinations of the dimension and the degrees of the
+   *  elements get an assembly kernel instantiated for their number of dofs
+   *  per cell n, whose arrays live on the stack and whose loops have
+   *  constant bounds. n = 0 is the general fallback, a std::vector of the
+   *  size given at run time.
+   */
+  template <typename T, unsigned int n>
+  class CellArray : public std::array<T, n>
+  {
+  public:
+    explicit CellArray(const unsigned int size)
+    {
+      (void)size;
+      Assert(size == n, dealii::ExcDimensionMismatch(size, n));
+    }
+  };
+
+  template <typename T>
+  class CellArray<T, 0> : public std::vector<T>
+  {
+  public:
+    explicit CellArray(const unsigned int size) : std::vector<T>(size) {}
+  };
+
+  /// The bound of the loops over the dofs of a cell in a kernel for n dofs,
+  /// which is a constant unless n is 0.
+  template <unsigned int n>
+  inline unsigned int cell_size(const unsigned int size)
+  {
+    return n == 0 ? size : n;
+  }
+
+  /// The number of dofs per cell of n_components Lagrange elements of a
+  /// degree.
+  constexpr unsigned int lagrange_dofs_per_cell(const int dim,
+                                                const unsigned int degree,
+                                                const unsigned int n_components)
+  {
+    unsigned int n = n_components;
+    for (int d = 0; d < dim; ++d)
+      {
+        n *= degree + 1;
+      }
+    return n;
+  }
+
+  namespace internal
+  {
+    template <typename Function>
+    void dispatch_dofs_per_cell(const unsigned int, const Function &f)
+    {
+      f(std::integral_constant<unsigned int, 0>());
+    }
+
+    template <unsigned int size, unsigned int... sizes, typename Function>
+    void dispatch_dofs_per_cell(const unsigned int dofs_per_cell,
+                                const Function &f)
+    {
+      if (dofs_per_cell == size)
+        {
+          f(std::integral_constant<unsigned int, size>());
+        }
+      else
+        {
+          dispatch_dofs_per_cell<sizes...>(dofs_per_cell, f);
+        }
+    }
+  } // namespace internal
+
+  /*! \brief Call a generic kernel with the number of dofs per cell as an
+   *  std::integral_constant if it is one of the sizes, or with 0 otherwise.
+   *
+   *  The kernel is instantiated for every size and the fallback, e.g.
+   *  \code
+   *  Utils::dispatch_dofs_per_cell<8, 18>(dofs_per_cell, [&](auto n) {
+   *    Utils::CellArray<double, decltype(n)::value> values(dofs_per_cell);
+   *    ...
+   *  });
+   *  \endcode
+   */
+  template <unsigned int... sizes, typename Function>
+  void dispatch_dofs_per_cell(const unsigned int dofs_per_cell,
+                              const Function &f)
+  {
+    internal::dispatch_dofs_per_cell<sizes...>(dofs_per_cell, f);
+  }
+} // namespace Utils
+
+#endif
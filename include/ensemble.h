@@ -0,0 +1,57 @@
+#ifndef ENSEMBLE
+#define ENSEMBLE
+
+#include <deal.II/base/mpi.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "parameters.h"
+
+namespace Utils
+{
+  using namespace dealii;
+
+  /*! \brief Run the parameter variants of the Ensemble subsection of a
+   * parameter file.
+   *
+   * The processes are split into the ensemble groups, and every group runs
+   * its share of the variants one after another, concurrently with the other
+   * groups. The solvers of a group are built on get_communicator(), so the
+   * driver can build the mesh once per group and hand it to the solver of
+   * every variant, which can take over the setup of the previous one, e.g.
+   * with Fluid::MPI::FluidSolver::reuse_setup. Every variant runs in its own
+   * directory variant-<index> so that the outputs do not collide.
+   */
+  class Ensemble
+  {
+  public:
+    Ensemble(const MPI_Comm &, const std::string &);
+    ~Ensemble();
+
+    /// The communicator of the group of this process.
+    const MPI_Comm &get_communicator() const { return group_communicator; }
+
+    /// The number of variants of all the groups.
+    unsigned int n_variants() const { return variants.size(); }
+
+    /*! \brief Run the variants of the group of this process with their
+     *  parameters and indices, this is collective in the group.
+     *
+     *  A parameter file without variants is one variant run by the first
+     *  group in the current directory.
+     */
+    void run(const std::function<void(const Parameters::AllParameters &,
+                                      const unsigned int)> &) const;
+
+  private:
+    const std::string parameter_file;
+    std::vector<std::string> variants;
+    unsigned int n_groups;
+    unsigned int group;
+    MPI_Comm group_communicator;
+  };
+} // namespace Utils
+
+#endif
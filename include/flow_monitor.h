@@ -0,0 +1,98 @@
+#ifndef FLOW_MONITOR
+#define FLOW_MONITOR
+
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/quadrature.h>
+
+#include <deal.II/dofs/dof_handler.h>
+
+#include <deal.II/lac/petsc_block_vector.h>
+
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "parameters.h"
+#include "utilities.h"
+
+namespace Utils
+{
+  using namespace dealii;
+
+  /*! \brief In-situ monitors of a fluid solution.
+   *
+   * Every time step, the velocity and the pressure are sampled at the probe
+   * points and at the points of the sample lines and planes of the Monitors
+   * subsection, and the force of the fluid on every force boundary is
+   * integrated, so that the time histories of e.g. the drag and the lift do
+   * not need frequent full output. The points are located once by a
+   * PointEvaluator and the locally owned faces of the force boundaries are
+   * collected once, both are reused until the mesh changes.
+   *
+   * The root process writes one row "step,time,<quantities>" per time step
+   * to a CSV file. A time step that is repeated, e.g. in the iterations of an
+   * implicit coupling, replaces the pending row, which is only written when a
+   * later step comes or the monitor is destroyed.
+   *
+   * The solution is a block vector of the PETSc or the Trilinos wrappers.
+   */
+  template <int dim, typename VectorType = PETScWrappers::MPI::BlockVector>
+  class FlowMonitor
+  {
+  public:
+    /*! \brief Set up the monitors of the parameters for the velocity-pressure
+     *  dofs, whose forces are integrated with the given face quadrature.
+     */
+    FlowMonitor(const DoFHandler<dim> &,
+                const Parameters::AllParameters &,
+                const Quadrature<dim - 1> &,
+                const MPI_Comm &);
+    ~FlowMonitor();
+
+    /// Whether there is a monitor file, which is the same on all processes.
+    bool enabled() const { return active; }
+
+    /// Forget the located points and the boundary faces, e.g. when the mesh
+    /// is refined or repartitioned.
+    void clear();
+
+    /*! \brief Sample the ghosted solution and integrate the forces at a time
+     *  step, this is collective.
+     *
+     *  The points that are not in the fluid domain are given zeros.
+     */
+    void monitor(const unsigned int, const double, const VectorType &);
+
+  private:
+    /// Write the pending row.
+    void flush();
+
+    const DoFHandler<dim> &dof_handler;
+    MPI_Comm mpi_communicator;
+    const bool active;
+    const std::string filename; //!< Empty on all but the root process.
+    const double viscosity;
+    const Quadrature<dim - 1> face_quadrature;
+    std::vector<types::boundary_id> force_boundaries;
+    /// All the sample points and their names in the header.
+    std::vector<Point<dim>> points;
+    std::vector<std::string> point_names;
+    PointEvaluator<dim, VectorType> evaluator;
+    bool located;
+    /// The locally owned faces on the force boundaries, as the cells, the
+    /// face numbers and the indices in force_boundaries.
+    std::vector<std::tuple<typename DoFHandler<dim>::active_cell_iterator,
+                           unsigned int,
+                           unsigned int>>
+      force_faces;
+    bool faces_collected;
+    std::ofstream file;
+    bool has_pending;
+    unsigned int pending_step;
+    double pending_time;
+    std::vector<double> pending_values;
+  };
+} // namespace Utils
+
+#endif
@@ -8,6 +8,7 @@
 #include <deal.II/base/tensor.h>
 #include <deal.II/base/timer.h>
 #include <deal.II/base/utilities.h>
+#include <deal.II/base/work_stream.h>
 
 #include <deal.II/lac/affine_constraints.h>
 #include <deal.II/lac/block_sparse_matrix.h>
@@ -45,6 +46,7 @@
 #include <deal.II/numerics/solution_transfer.h>
 
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -86,6 +88,14 @@ namespace Fluid
   protected:
     class BoundaryValues;
     struct CellProperty;
+    struct AssemblyScratchData;
+    struct AssemblyCopyData;
+
+    /// The type of the cell workers in assemble_cells.
+    using CellWorker =
+      std::function<void(const typename DoFHandler<dim>::active_cell_iterator &,
+                         AssemblyScratchData &,
+                         AssemblyCopyData &)>;
 
     //! Pure abstract function to run simulation for one step
     virtual void run_one_step(bool apply_nonzero_constraints,
@@ -113,8 +123,23 @@ namespace Fluid
     /// Update stress to output
     virtual void update_stress();
 
+    /*! \brief Run the cell loop of an assembly on all active cells, in the
+     *  order of assembly_cells.
+     *
+     *  The worker computes the local contributions of a cell, and may run on
+     *  several threads at the same time with their own scratch data, so it
+     *  must only read the shared objects. WorkStream calls the copier on one
+     *  thread at a time, so it can add the copy data to the global matrices
+     *  and vectors.
+     */
+    void assemble_cells(const CellWorker &,
+                        const std::function<void(const AssemblyCopyData &)> &);
+
     std::vector<types::global_dof_index> dofs_per_block;
 
+    /// The active cells sorted by their lowest dof, set up with the dofs.
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> assembly_cells;
+
     Triangulation<dim> &triangulation;
     FESystem<dim> fe;
     FE_Q<dim> scalar_fe;
@@ -168,6 +193,44 @@ namespace Fluid
       Tensor<1, dim> fsi_acceleration; //!< The acceleration term in FSI force.
       SymmetricTensor<2, dim> fsi_stress; //!< The stress term in FSI force.
     };
+
+    /**
+     * The thread-local data of assemble_cells: the FEValues objects, the
+     * shape functions at a quadrature point, and the solution fields at the
+     * quadrature points of a cell.
+     */
+    struct AssemblyScratchData
+    {
+      AssemblyScratchData(const FiniteElement<dim> &,
+                          const Quadrature<dim> &,
+                          const Quadrature<dim - 1> &);
+      AssemblyScratchData(const AssemblyScratchData &);
+
+      FEValues<dim> fe_values;
+      FEFaceValues<dim> fe_face_values;
+
+      std::vector<double> div_phi_u;
+      std::vector<Tensor<1, dim>> phi_u;
+      std::vector<Tensor<2, dim>> grad_phi_u;
+      std::vector<double> phi_p;
+
+      std::vector<Tensor<1, dim>> current_velocity_values;
+      std::vector<Tensor<2, dim>> current_velocity_gradients;
+      std::vector<SymmetricTensor<2, dim>> current_velocity_sym_gradients;
+      std::vector<double> current_pressure_values;
+      std::vector<Tensor<1, dim>> present_velocity_values;
+    };
+
+    /// The local contributions of a cell in assemble_cells.
+    struct AssemblyCopyData
+    {
+      AssemblyCopyData(const unsigned int);
+
+      FullMatrix<double> local_matrix;
+      FullMatrix<double> local_mass_matrix;
+      Vector<double> local_rhs;
+      std::vector<types::global_dof_index> local_dof_indices;
+    };
   };
 } // namespace Fluid
 
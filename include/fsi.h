@@ -18,6 +18,8 @@ extern template class Utils::GridInterpolator<2, Vector<double>>;
 extern template class Utils::GridInterpolator<3, Vector<double>>;
 extern template class Utils::GridInterpolator<2, BlockVector<double>>;
 extern template class Utils::GridInterpolator<3, BlockVector<double>>;
+extern template class Utils::PointEvaluator<2, BlockVector<double>>;
+extern template class Utils::PointEvaluator<3, BlockVector<double>>;
 extern template class Utils::SPHInterpolator<2, Vector<double>>;
 extern template class Utils::SPHInterpolator<3, Vector<double>>;
 
@@ -87,6 +89,14 @@ private:
   /// Mesh adaption.
   void refine_mesh(const unsigned int, const unsigned int);
 
+  /// Save the current solid state as the beginning (0) or the end (1) of the
+  /// coupling time step.
+  void save_solid_state(const unsigned int);
+
+  /// Set the current solid state to the linear interpolation between the
+  /// beginning (0) and the end (1) of the coupling time step.
+  void interpolate_solid_state(const double);
+
   Fluid::FluidSolver<dim> &fluid_solver;
   Solid::SolidSolver<dim> &solid_solver;
   Parameters::AllParameters parameters;
@@ -97,7 +107,26 @@ private:
   // The point stored is in the order of:
   // (x_min, x_max, y_min, y_max, z_min, z_max)
   Vector<double> solid_box;
+
+  // The solid boundary surface for the inside test in 3D.
+  Utils::ClosedSurface solid_surface;
+
+  // The deformed solid cells binned for the inside test in 2D.
+  Utils::CellLinkedList<dim> solid_cells;
+  std::vector<typename DoFHandler<dim>::active_cell_iterator>
+    solid_cell_iterators;
+
   bool use_dirichlet_bc;
+
+  // The solid state at the beginning and the end of the coupling time step,
+  // which are only needed if the fluid takes more than one step in it.
+  struct SolidState
+  {
+    Vector<double> displacement;
+    Vector<double> velocity;
+    Vector<double> acceleration;
+  };
+  SolidState solid_states[2];
 };
 
 #endif
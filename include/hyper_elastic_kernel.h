@@ -0,0 +1,183 @@
+#ifndef HYPER_ELASTIC_KERNEL
+#define HYPER_ELASTIC_KERNEL
+
+#include <deal.II/base/symmetric_tensor.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/base/vectorization.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "neo_hookean.h"
+#include "quadrature_history.h"
+
+namespace Solid
+{
+  /*! \brief Compile-time constitutive kernel of a hyperelastic material.
+   *
+   *  HyperElasticMaterial evaluates one quadrature point at a time through
+   *  virtual calls and assembles the elasticity tensor from the standard
+   *  fourth order tensors. A kernel instead uses the closed form of the
+   *  stress and the tangent of a material, and evaluates them at
+   *  VectorizedArray::n_array_elements quadrature points at once. Every
+   *  material specializes this template.
+   */
+  template <template <int> class MaterialType, int dim>
+  struct HyperElasticKernel;
+
+  /*! \brief The kernel of NeoHookean.
+   *
+   *  With \f$\bar{\tau} = 2C_1\bar{b}\f$ and \f$p = \kappa(J-1)\f$, the
+   *  Kirchhoff stress is \f$\tau = \mathrm{dev}\bar{\tau} + JpI\f$, and the
+   *  tangent is the same as HyperElasticMaterial::get_Jc with a vanishing
+   *  fictitious elasticity tensor.
+   */
+  template <int dim>
+  struct HyperElasticKernel<NeoHookean, dim>
+  {
+    using Number = dealii::VectorizedArray<double>;
+    static constexpr unsigned int n_lanes = Number::n_array_elements;
+
+    /// Evaluate J, tau and Jc at the deformation gradients F.
+    static void evaluate(const Number &c1,
+                         const Number &kappa,
+                         const dealii::Tensor<2, dim, Number> &F,
+                         Number &det_F,
+                         dealii::SymmetricTensor<2, dim, Number> &tau,
+                         dealii::SymmetricTensor<4, dim, Number> &Jc)
+    {
+      const double inv_dim = 1.0 / dim;
+      det_F = dealii::determinant(F);
+      // tau_bar = 2 c1 J^(-2/dim) F F^T
+      const Number factor = 2.0 * c1 * std::pow(det_F, -2.0 * inv_dim);
+      dealii::SymmetricTensor<2, dim, Number> tau_iso;
+      for (unsigned int i = 0; i < dim; ++i)
+        {
+          for (unsigned int j = i; j < dim; ++j)
+            {
+              Number b = F[i][0] * F[j][0];
+              for (unsigned int k = 1; k < dim; ++k)
+                {
+                  b += F[i][k] * F[j][k];
+                }
+              tau_iso[i][j] = factor * b;
+            }
+        }
+      const Number trace_tau_bar = dealii::trace(tau_iso);
+      for (unsigned int i = 0; i < dim; ++i)
+        {
+          tau_iso[i][i] -= inv_dim * trace_tau_bar;
+        }
+
+      const Number p = kappa * (det_F - 1.0);
+      const Number Jp = det_F * p;
+      const Number Jp_tilde = Jp + det_F * det_F * kappa;
+      tau = tau_iso;
+      for (unsigned int i = 0; i < dim; ++i)
+        {
+          tau[i][i] += Jp;
+        }
+
+      // Jc = J(p_tilde IxI - 2pS) + 2/dim tr(tau_bar) dev_P
+      //      - 2/dim (tau_iso x I + I x tau_iso)
+      for (unsigned int i = 0; i < dim; ++i)
+        {
+          for (unsigned int j = i; j < dim; ++j)
+            {
+              const double I_ij = (i == j) ? 1.0 : 0.0;
+              for (unsigned int k = 0; k < dim; ++k)
+                {
+                  for (unsigned int l = k; l < dim; ++l)
+                    {
+                      const double I_kl = (k == l) ? 1.0 : 0.0;
+                      const double S = 0.5 * ((i == k && j == l ? 1.0 : 0.0) +
+                                              (i == l && j == k ? 1.0 : 0.0));
+                      Jc[i][j][k][l] =
+                        I_ij * I_kl * (Jp_tilde - 2.0 * inv_dim * inv_dim *
+                                                    trace_tau_bar) +
+                        S * (2.0 * inv_dim * trace_tau_bar - 2.0 * Jp) -
+                        2.0 * inv_dim * (I_kl * tau_iso[i][j] +
+                                         I_ij * tau_iso[k][l]);
+                    }
+                }
+            }
+        }
+    }
+
+    /*! \brief Update the quadrature point history of a cell with the
+     *  displacement gradients at its quadrature points.
+     *
+     *  The points are evaluated in batches of n_lanes, the last batch is
+     *  padded with the last point of the cell.
+     */
+    static void update(Internal::QuadratureHistory<dim> &history,
+                       const unsigned int first_point,
+                       const std::vector<dealii::Tensor<2, dim>> &grad_u)
+    {
+      const unsigned int n_q_points = grad_u.size();
+      // All points of a cell have the same material.
+      const std::vector<double> &C =
+        history.get_material_parameters(first_point);
+      Assert(C.size() >= 2, dealii::ExcInternalError());
+      Number c1, kappa, det_F;
+      c1 = C[0];
+      kappa = C[1];
+      dealii::Tensor<2, dim, Number> F;
+      dealii::SymmetricTensor<2, dim, Number> tau;
+      dealii::SymmetricTensor<4, dim, Number> Jc;
+      dealii::Tensor<2, dim> F_inv_q;
+      dealii::SymmetricTensor<2, dim> tau_q;
+      dealii::SymmetricTensor<4, dim> Jc_q;
+
+      for (unsigned int q0 = 0; q0 < n_q_points; q0 += n_lanes)
+        {
+          for (unsigned int v = 0; v < n_lanes; ++v)
+            {
+              const unsigned int q = std::min(q0 + v, n_q_points - 1);
+              for (unsigned int i = 0; i < dim; ++i)
+                {
+                  for (unsigned int j = 0; j < dim; ++j)
+                    {
+                      F[i][j][v] = grad_u[q][i][j] + (i == j ? 1.0 : 0.0);
+                    }
+                }
+            }
+
+          evaluate(c1, kappa, F, det_F, tau, Jc);
+          const dealii::Tensor<2, dim, Number> F_inv = dealii::invert(F);
+
+          for (unsigned int v = 0; v < n_lanes && q0 + v < n_q_points; ++v)
+            {
+              for (unsigned int i = 0; i < dim; ++i)
+                {
+                  for (unsigned int j = 0; j < dim; ++j)
+                    {
+                      F_inv_q[i][j] = F_inv[i][j][v];
+                    }
+                }
+              for (unsigned int k = 0; k < tau_q.n_independent_components;
+                   ++k)
+                {
+                  tau_q.access_raw_entry(k) = tau.access_raw_entry(k)[v];
+                }
+              for (unsigned int k = 0; k < Jc_q.n_independent_components;
+                   ++k)
+                {
+                  Jc_q.access_raw_entry(k) = Jc.access_raw_entry(k)[v];
+                }
+              Assert(det_F[v] > 0, dealii::ExcInternalError());
+              history.update(first_point + q0 + v,
+                             F_inv_q,
+                             det_F[v],
+                             tau_q,
+                             Jc_q,
+                             kappa[v] * (det_F[v] - 1.0),
+                             kappa[v]);
+            }
+        }
+    }
+  };
+} // namespace Solid
+
+#endif
@@ -61,6 +61,9 @@ namespace Solid
     /** Return the J. */
     double get_det_F() { return det_F; }
 
+    /** Return the bulk modulus. */
+    double get_kappa() const { return kappa; }
+
     /* Return the derivative of the volumetric part of the energy potential
      * w.r.t the J. */
     virtual double get_dPsi_vol_dJ() const { return kappa * (det_F - 1); }
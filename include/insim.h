@@ -2,6 +2,7 @@
 #define INS_IM
 
 #include "fluid_solver.h"
+#include "solver_wrappers.h"
 
 template <int>
 class FSI;
@@ -58,6 +59,9 @@ namespace Fluid
     using FluidSolver<dim>::refine_mesh;
     using FluidSolver<dim>::output_results;
     using FluidSolver<dim>::update_stress;
+    using FluidSolver<dim>::assemble_cells;
+    using typename FluidSolver<dim>::AssemblyScratchData;
+    using typename FluidSolver<dim>::AssemblyCopyData;
 
     using FluidSolver<dim>::dofs_per_block;
     using FluidSolver<dim>::triangulation;
@@ -133,6 +137,17 @@ namespace Fluid
     /// The BlockSchurPreconditioner for the entire system.
     std::shared_ptr<BlockSchurPreconditioner> preconditioner;
 
+    /**
+     * The factorization of \f$\tilde{A}\f$ used by the
+     * BlockSchurPreconditioner. It outlives the preconditioner so that the
+     * symbolic analysis is only redone when the sparsity pattern changes.
+     */
+    Utils::UMFPACKFactorization A_inverse;
+
+    /// The number of GMRES iterations of the last solve, which decides
+    /// whether a stale A_inverse is good enough.
+    unsigned int last_gmres_iterations;
+
     /*! \brief Block preconditioner for the system
      *
      * A right block preconditioner is defined here:
@@ -180,7 +195,8 @@ namespace Fluid
                                double dt,
                                const BlockSparseMatrix<double> &system,
                                const BlockSparseMatrix<double> &mass,
-                               SparseMatrix<double> &schur);
+                               SparseMatrix<double> &schur,
+                               const Utils::UMFPACKFactorization &A_inverse);
 
       /// The matrix-vector multiplication must be defined.
       void vmult(BlockVector<double> &dst,
@@ -211,10 +227,10 @@ namespace Fluid
        */
       const SmartPointer<SparseMatrix<double>> mass_schur;
 
-      /// The direct solver used for \f$\tilde{A}\f$. We declare it as a member
-      /// so that it can be initialized only once for many applications of the
-      /// preconditioner.
-      SparseDirectUMFPACK A_inverse;
+      /// The direct solver used for \f$\tilde{A}\f$. It is owned by InsIM
+      /// and factorized before the preconditioner is built, so that it is
+      /// only initialized once for many applications of the preconditioner.
+      const SmartPointer<const Utils::UMFPACKFactorization> A_inverse;
     };
   };
 } // namespace Fluid
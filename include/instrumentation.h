@@ -0,0 +1,227 @@
+#ifndef INSTRUMENTATION
+#define INSTRUMENTATION
+
+#include <deal.II/base/conditional_ostream.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/lac/petsc_block_sparse_matrix.h>
+#include <deal.II/lac/petsc_sparse_matrix.h>
+
+#ifdef OPENIFEM_WITH_LIKWID
+#include <likwid.h>
+#endif
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace Utils
+{
+  using namespace dealii;
+
+  /*! \brief Per-step, per-process timings and counters of the FSI coupling.
+   *
+   * The wall times of the phases and the counters are accumulated on every
+   * process during a time step. At the end of the step their minimum, maximum
+   * and average over the processes, and the ranks of the minimum and the
+   * maximum, are appended to a CSV file by the first process, one row per
+   * quantity, so that the stragglers can be identified. Unlike TimerOutput
+   * the processes are not synchronized at the phases. The quantities are
+   * identified by name and given to the constructor, so that every process
+   * reduces the same ones in the same order, a quantity that a process does
+   * not record is zero on it.
+   */
+  class CouplingProfiler
+  {
+  public:
+    /// An empty file name disables the profiler. The names of the phases
+    /// and the counters are the same on all of the processes.
+    CouplingProfiler(const MPI_Comm &,
+                     const std::string &,
+                     const std::vector<std::string> &);
+
+    bool enabled() const { return !filename.empty(); }
+
+    /// Add the wall time of the lifetime of a Scope to a phase.
+    class Scope
+    {
+    public:
+      Scope(CouplingProfiler &, const std::string &);
+      ~Scope();
+
+    private:
+      CouplingProfiler &profiler;
+      const unsigned int index;
+      Timer timer;
+    };
+
+    /// Add to a counter.
+    void add(const std::string &, const double);
+
+    /// Reduce the quantities of a time step over the processes, write them
+    /// and reset them. This is collective.
+    void end_step(const unsigned int, const double);
+
+  private:
+    /// The index of a quantity.
+    unsigned int get_index(const std::string &) const;
+
+    MPI_Comm mpi_communicator;
+    const std::string filename;
+    std::ofstream file;
+    const std::vector<std::string> names;
+    std::vector<double> values;
+  };
+
+  /*! \brief Machine readable summary of a run for the performance tests.
+   *
+   * The root process appends one JSON object per line to the file for every
+   * write(): the total wall times of the sections of a TimerOutput on it, and
+   * the totals of the counters (e.g. the Krylov iterations) added since the
+   * last write(). tests/performance/check_performance.py compares the lines
+   * against a baseline.
+   */
+  class PerformanceSummary
+  {
+  public:
+    /// An empty file name disables the summary.
+    PerformanceSummary(const MPI_Comm &, const std::string &);
+
+    bool enabled() const { return !filename.empty(); }
+
+    /// Add to a counter.
+    void add(const std::string &, const double);
+
+    /// Write the sections of a timer and the counters under a name.
+    void write(const std::string &, const TimerOutput &);
+
+  private:
+    MPI_Comm mpi_communicator;
+    const std::string filename;
+    std::map<std::string, double> counters;
+  };
+
+  /*! \brief A LIKWID marker region around a hot spot of the solvers.
+   *
+   * The regions go along with the timer sections of the same names, e.g.
+   * the assembly, the Schur complement preconditioner and the inside-solid
+   * tests of the FSI, so that likwid-perfctr -m reports the hardware counters
+   * of a performance group per section, e.g. the FLOP rate with FLOPS_DP,
+   * the memory bandwidth with MEM and the cache misses with L2CACHE or
+   * L3CACHE. The spaces of the names are replaced by underscores, which the
+   * marker files cannot hold. The marker API is initialized by the first
+   * region of a process and closed when it exits. Only the thread that opens
+   * a region is measured, so the runs should use one thread per process. The
+   * regions do nothing unless OpenIFEM is configured with
+   * OPENIFEM_WITH_likwid.
+   */
+  class CounterRegion
+  {
+  public:
+    explicit CounterRegion(const std::string &);
+    ~CounterRegion();
+    CounterRegion(const CounterRegion &) = delete;
+    CounterRegion &operator=(const CounterRegion &) = delete;
+
+  private:
+#ifdef OPENIFEM_WITH_LIKWID
+    std::string tag;
+#endif
+  };
+
+  /*! \brief A per time step log of the timers and the solver statistics of a
+   * solver.
+   *
+   * The root process of the communicator writes a CSV file with one row
+   * "step,time,quantity,value" per quantity and time step: the wall time
+   * spent in every section of the watched timers during the step, and the
+   * quantities added or set during the step, e.g. the Newton and Krylov
+   * iterations and the final residuals. A step is written when the next one
+   * begins or the telemetry is destroyed, and the file is flushed after every
+   * step so that slowdowns can be spotted while a run is still going.
+   */
+  class Telemetry
+  {
+  public:
+    /// Log to <prefix>_<solver>.csv, an empty prefix disables the log.
+    Telemetry(const MPI_Comm &, const std::string &, const std::string &);
+    ~Telemetry();
+
+    bool enabled() const { return !filename.empty(); }
+
+    /// Log the sections of a timer, which must outlive the telemetry, with
+    /// a prefix in front of their names.
+    void watch(const TimerOutput &, const std::string & = "");
+
+    /// Write the previous time step and begin a new one.
+    void begin_step(const unsigned int, const double);
+
+    /// Add to a quantity of the current step.
+    void add(const std::string &, const double);
+
+    /// Set a quantity of the current step, e.g. the last residual.
+    void set(const std::string &, const double);
+
+  private:
+    void flush();
+
+    std::string filename; //!< Empty on all but the root process.
+    std::ofstream file;
+    bool in_step;
+    unsigned int step;
+    double time;
+    std::vector<std::pair<const TimerOutput *, std::string>> timers;
+    std::map<std::string, double> last_totals;
+    std::map<std::string, double> values;
+  };
+
+  /*! \brief A report of the memory of the subsystems of a solver.
+   *
+   * The solver adds the bytes of its items, e.g. the triangulation, the
+   * sparsity patterns and the matrices, to subsystems, and print() shows the
+   * minimum, average and maximum of every item and subsystem over the
+   * processes. It also keeps the largest total of every subsystem on every
+   * process over the reports, and shows the maximum of these high-water
+   * marks, along with the peak resident memory of the processes. Every
+   * process must add the same items in the same order.
+   */
+  class MemoryReport
+  {
+  public:
+    MemoryReport(const MPI_Comm &, const std::string &);
+
+    /// Add the bytes of an item to a subsystem.
+    void add(const std::string &, const std::string &, const double);
+
+    /// Add an object with a memory_consumption() function.
+    template <typename T>
+    void add_object(const std::string &subsystem,
+                    const std::string &item,
+                    const T &object)
+    {
+      add(subsystem, item, object.memory_consumption());
+    }
+
+    /// The memory that PETSc allocated for the local part of a matrix.
+    static double matrix_memory(const PETScWrappers::MatrixBase &);
+    static double matrix_memory(const PETScWrappers::MPI::BlockSparseMatrix &);
+
+    /// Whether no item was added since the last report.
+    bool empty() const { return items.empty(); }
+
+    /// Print the items added since the last report, which is collective.
+    void print(ConditionalOStream &, const std::string &);
+
+  private:
+    MPI_Comm mpi_communicator;
+    const std::string name;
+    /// The subsystems, items and bytes of the current report.
+    std::vector<std::tuple<std::string, std::string, double>> items;
+    /// The largest total of every subsystem on this process.
+    std::map<std::string, double> high_water;
+  };
+} // namespace Utils
+
+#endif
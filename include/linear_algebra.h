@@ -0,0 +1,336 @@
+#ifndef LINEAR_ALGEBRA
+#define LINEAR_ALGEBRA
+
+#include <deal.II/base/mpi.h>
+
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/component_mask.h>
+
+#include <deal.II/lac/petsc_block_sparse_matrix.h>
+#include <deal.II/lac/petsc_block_vector.h>
+#include <deal.II/lac/petsc_precondition.h>
+#include <deal.II/lac/petsc_sparse_matrix.h>
+#include <deal.II/lac/petsc_vector.h>
+#include <deal.II/lac/solver_control.h>
+
+#ifdef OPENIFEM_WITH_TRILINOS
+#include <deal.II/lac/trilinos_block_sparse_matrix.h>
+#include <deal.II/lac/trilinos_parallel_block_vector.h>
+#include <deal.II/lac/trilinos_precondition.h>
+#include <deal.II/lac/trilinos_solver.h>
+#include <deal.II/lac/trilinos_sparse_matrix.h>
+#include <deal.II/lac/trilinos_vector.h>
+#endif
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "preconditioner_pilut.h"
+#include "solver_wrappers.h"
+#include "utilities.h"
+
+namespace Utils
+{
+  using namespace dealii;
+
+  /// The tags of the distributed linear algebra backends.
+  struct PETScBackend
+  {
+  };
+  struct TrilinosBackend
+  {
+  };
+
+  /*! \brief The distributed vectors, matrices, solvers and preconditioners
+   *  of a linear algebra backend.
+   *
+   *  The solvers that are templated over the backend use the types and
+   *  functions here rather than PETScWrappers or TrilinosWrappers: the
+   *  Krylov solvers, the preconditioners selected by name, the AMG of the
+   *  elasticity and velocity blocks, which is GAMG or BoomerAMG in PETSc and
+   *  MueLu in Trilinos, the direct solver, and the few vector operations
+   *  that are done on the raw PETSc objects. The rest of the interface of
+   *  the vectors and matrices is the same in deal.II.
+   */
+  template <typename Backend>
+  struct LinearAlgebraTraits;
+
+  /*! \brief GAMG with the rigid body modes of a displacement field as the
+   *  near nullspace, which are computed on the first update.
+   */
+  class PETScElasticAMG : public PreconditionElasticAMG
+  {
+  public:
+    /// Set up the AMG of a matrix on the dofs of dof_handler, see
+    /// PreconditionElasticAMG::update. Returns whether it was rebuilt.
+    template <int dim>
+    bool update(const PETScWrappers::MPI::SparseMatrix &matrix,
+                const DoFHandler<dim> &dof_handler,
+                const MPI_Comm &comm,
+                const bool keep_hierarchy)
+    {
+      if (modes.empty())
+        {
+          modes = rigid_body_modes(
+            dof_handler, dof_handler.locally_owned_dofs(), comm);
+        }
+      return PreconditionElasticAMG::update(matrix, modes, keep_hierarchy);
+    }
+
+    /// Destroy the hierarchy and forget the modes, e.g. for a new mesh.
+    void clear()
+    {
+      modes.clear();
+      PreconditionElasticAMG::clear();
+    }
+
+  private:
+    std::vector<PETScWrappers::MPI::Vector> modes;
+  };
+
+  template <>
+  struct LinearAlgebraTraits<PETScBackend>
+  {
+    using Vector = PETScWrappers::MPI::Vector;
+    using BlockVector = PETScWrappers::MPI::BlockVector;
+    using SparseMatrix = PETScWrappers::MPI::SparseMatrix;
+    using BlockSparseMatrix = PETScWrappers::MPI::BlockSparseMatrix;
+    /// CG and its pipelined variants, see SolverKrylov.
+    using SolverCG = SolverKrylov;
+    /// The preconditioner of the "default" choice of the solid solvers.
+    using DefaultPreconditioner = PETScWrappers::PreconditionBlockJacobi;
+    using PreconditionSelector = ::PreconditionSelector;
+    using ElasticAMG = PETScElasticAMG;
+    /// The MUMPS factorization, which keeps the symbolic analysis.
+    using DirectSolver = PreconditionMUMPS;
+
+    static std::string name() { return "PETSc"; }
+
+    /*! \brief Initialize a preconditioner of the names that
+     *  PreconditionSelector accepts on a block of a vector-valued field.
+     *
+     *  The components of the field are not used by the PETSc
+     *  preconditioners.
+     */
+    template <int dim>
+    static void initialize_preconditioner(PreconditionSelector &selector,
+                                          const std::string &preconditioner,
+                                          const SparseMatrix &matrix,
+                                          const DoFHandler<dim> &,
+                                          const ComponentMask &,
+                                          const bool symmetric = true)
+    {
+      selector.initialize(preconditioner, matrix, symmetric);
+    }
+
+    static double matrix_memory(const SparseMatrix &matrix)
+    {
+      return MemoryReport::matrix_memory(matrix);
+    }
+
+    static double matrix_memory(const BlockSparseMatrix &matrix)
+    {
+      return MemoryReport::matrix_memory(matrix);
+    }
+
+    /*! \brief Copy a non-ghosted vector to a ghosted one, and start the
+     *  exchange of the ghost values, which finish_ghost_update waits for.
+     *
+     *  The owned part of a ghosted PETSc vector is its global form, and the
+     *  ghost part is filled by the scatter of VecGhostUpdate.
+     */
+    static void start_ghost_update(BlockVector &ghosted,
+                                   const BlockVector &owned);
+    static void finish_ghost_update(BlockVector &ghosted);
+  };
+
+#ifdef OPENIFEM_WITH_TRILINOS
+  /*! \brief The Trilinos CG, with the constructor of SolverKrylov.
+   *
+   *  The pipelined variants of PETSc have no counterpart in AztecOO, so only
+   *  "cg" is accepted.
+   */
+  class TrilinosSolverCG : public TrilinosWrappers::SolverCG
+  {
+  public:
+    TrilinosSolverCG(SolverControl &control,
+                     const MPI_Comm &,
+                     const std::string &method)
+      : TrilinosWrappers::SolverCG(control)
+    {
+      AssertThrow(method == "cg",
+                  ExcMessage("Only cg is available with Trilinos!"));
+    }
+  };
+
+  /*! \brief A Trilinos preconditioner chosen by the names of
+   *  PreconditionSelector.
+   *
+   *  amg and gamg are MueLu, whose near nullspace are the constant modes of
+   *  the components if they are given, pilut and euclid the ILU of Ifpack,
+   *  jacobi, sor, chebyshev and none those of Ifpack. sor is symmetric if
+   *  the operator is, so that it can precondition CG.
+   */
+  class TrilinosPreconditionSelector
+    : public TrilinosWrappers::PreconditionBase
+  {
+  public:
+    void initialize(const std::string &name,
+                    const TrilinosWrappers::SparseMatrix &matrix,
+                    const bool symmetric = true,
+                    const std::vector<std::vector<bool>> &constant_modes =
+                      std::vector<std::vector<bool>>());
+
+    void clear();
+
+  private:
+    /// The selected preconditioner, whose operator this one applies.
+    std::unique_ptr<TrilinosWrappers::PreconditionBase> selected;
+  };
+
+  /*! \brief MueLu with the translations of a displacement field as the near
+   *  nullspace.
+   *
+   *  The hierarchy is built by the first update and kept by the later ones
+   *  as long as keep_hierarchy is true. MueLu uses the constant modes of the
+   *  components only, the rotations are not part of the nullspace.
+   */
+  class TrilinosElasticAMG : public TrilinosWrappers::PreconditionAMGMueLu
+  {
+  public:
+    TrilinosElasticAMG() : built(false) {}
+
+    template <int dim>
+    bool update(const TrilinosWrappers::SparseMatrix &matrix,
+                const DoFHandler<dim> &dof_handler,
+                const MPI_Comm &,
+                const bool keep_hierarchy)
+    {
+      if (built && keep_hierarchy)
+        {
+          return false;
+        }
+      AdditionalData data;
+      data.elliptic = true;
+      data.higher_order_elements = dof_handler.get_fe().degree > 1;
+      DoFTools::extract_constant_modes(
+        dof_handler,
+        ComponentMask(dof_handler.get_fe().n_components(), true),
+        data.constant_modes);
+      initialize(matrix, data);
+      built = true;
+      return true;
+    }
+
+    void clear()
+    {
+      built = false;
+      TrilinosWrappers::PreconditionAMGMueLu::clear();
+    }
+
+  private:
+    bool built;
+  };
+
+  /*! \brief The direct solver of Amesos as a preconditioner, with the
+   *  interface of PreconditionMUMPS.
+   *
+   *  Amesos does not keep the symbolic analysis across initializations, so
+   *  the matrix is factorized in full unless the factorization is kept.
+   */
+  class TrilinosDirectSolver
+  {
+  public:
+    TrilinosDirectSolver();
+
+    /// Factorize a matrix unless keep_stale is true and there is a
+    /// factorization already. Returns whether the matrix is factorized.
+    bool update(const TrilinosWrappers::SparseMatrix &,
+                const bool keep_stale = false);
+
+    void clear();
+
+    void vmult(TrilinosWrappers::MPI::Vector &,
+               const TrilinosWrappers::MPI::Vector &) const;
+
+  private:
+    /// SolverDirect keeps a reference to its control.
+    SolverControl control;
+    std::unique_ptr<TrilinosWrappers::SolverDirect> solver;
+  };
+
+  template <>
+  struct LinearAlgebraTraits<TrilinosBackend>
+  {
+    using Vector = TrilinosWrappers::MPI::Vector;
+    using BlockVector = TrilinosWrappers::MPI::BlockVector;
+    using SparseMatrix = TrilinosWrappers::SparseMatrix;
+    using BlockSparseMatrix = TrilinosWrappers::BlockSparseMatrix;
+    using SolverCG = TrilinosSolverCG;
+    /// ILU(0) on the locally owned rows, as the block Jacobi of PETSc.
+    using DefaultPreconditioner = TrilinosWrappers::PreconditionILU;
+    using PreconditionSelector = TrilinosPreconditionSelector;
+    using ElasticAMG = TrilinosElasticAMG;
+    using DirectSolver = TrilinosDirectSolver;
+
+    static std::string name() { return "Trilinos"; }
+
+    /*! \brief Initialize a preconditioner on a block of a vector-valued
+     *  field, whose components are selected by mask.
+     *
+     *  MueLu takes the constant modes of the selected components as the
+     *  near nullspace, so that they are aggregated node by node.
+     */
+    template <int dim>
+    static void initialize_preconditioner(PreconditionSelector &selector,
+                                          const std::string &preconditioner,
+                                          const SparseMatrix &matrix,
+                                          const DoFHandler<dim> &dof_handler,
+                                          const ComponentMask &mask,
+                                          const bool symmetric = true)
+    {
+      std::vector<std::vector<bool>> constant_modes;
+      if (preconditioner == "amg" || preconditioner == "gamg")
+        {
+          // The modes of a block are restricted to its locally owned rows,
+          // which are those of the selected components.
+          DoFTools::extract_constant_modes(dof_handler, mask, constant_modes);
+        }
+      selector.initialize(preconditioner, matrix, symmetric, constant_modes);
+    }
+
+    static double matrix_memory(const SparseMatrix &matrix)
+    {
+      return matrix.memory_consumption();
+    }
+
+    static double matrix_memory(const BlockSparseMatrix &matrix)
+    {
+      double memory = 0;
+      for (unsigned int i = 0; i < matrix.n_block_rows(); ++i)
+        {
+          for (unsigned int j = 0; j < matrix.n_block_cols(); ++j)
+            {
+              memory += matrix.block(i, j).memory_consumption();
+            }
+        }
+      return memory;
+    }
+
+    /// The import of Epetra cannot be split, so the ghost values are
+    /// exchanged at once and finish_ghost_update does nothing.
+    static void start_ghost_update(BlockVector &ghosted,
+                                   const BlockVector &owned)
+    {
+      ghosted = owned;
+    }
+    static void finish_ghost_update(BlockVector &) {}
+  };
+#endif
+} // namespace Utils
+
+#endif
@@ -2,6 +2,7 @@
 #define LINEAR_ELASTICITY
 
 #include "linear_elastic_material.h"
+#include "nodal_projection.h"
 #include "solid_solver.h"
 
 template <int>
@@ -75,7 +76,8 @@ namespace Solid
      * Assembles lhs and rhs. At time step 0, the lhs is the mass matrix;
      * at all the following steps, it is \f$ M + \beta{\Delta{t}}^2K \f$.
      * It can also be used to assemble the RHS only, in case of time-dependent
-     * Neumann boundary conditions.
+     * Neumann boundary conditions. With the explicit integrator the RHS only
+     * assembly also subtracts the internal force.
      */
     void assemble(bool is_initial, bool assemble_matrix);
 
@@ -89,6 +91,17 @@ namespace Solid
      */
     void assemble_rhs();
 
+    /**
+     * Assembles the external minus the internal force.
+     */
+    virtual void assemble_explicit_force() override;
+
+    /**
+     * Matrix-free product with the stiffness matrix, \f$ dst = Ku \f$, in
+     * place of the stored matrix.
+     */
+    void apply_stiffness(const Vector<double> &u, Vector<double> &dst);
+
     /**
      * Update the strain and stress, used in output_results and FSI.
      */
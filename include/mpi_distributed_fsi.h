@@ -0,0 +1,143 @@
+#ifndef MPI_DISTRIBUTED_FSI
+#define MPI_DISTRIBUTED_FSI
+
+#include <deal.II/base/mpi.h>
+#include <deal.II/physics/elasticity/standard_tensors.h>
+
+#include <memory>
+
+#include "mpi_fluid_solver.h"
+#include "mpi_solid_solver.h"
+
+using namespace dealii;
+
+extern template class Fluid::MPI::FluidSolver<2>;
+extern template class Fluid::MPI::FluidSolver<3>;
+extern template class Solid::MPI::SolidSolver<2>;
+extern template class Solid::MPI::SolidSolver<3>;
+extern template class Utils::AABBTree<2>;
+extern template class Utils::AABBTree<3>;
+extern template class Utils::PointEvaluator<2,
+                                            PETScWrappers::MPI::BlockVector>;
+extern template class Utils::PointEvaluator<3,
+                                            PETScWrappers::MPI::BlockVector>;
+
+namespace MPI
+{
+  /*! \brief FSI solver that couples a distributed fluid with a distributed
+   * solid.
+   *
+   * Unlike FSI, where every process stores the entire solid, the solid
+   * triangulation is distributed here as well. At every time step each
+   * process receives a copy of the solid cells that overlap its fluid
+   * subdomain, together with the solid velocity and acceleration on them,
+   * from the processes that own these cells. The copies are stored as a
+   * disconnected serial triangulation, and a fluid point is in the solid if
+   * it is in one of these cells. In the other direction, the fluid stress is
+   * only evaluated at the solid boundary vertices that lie in the local fluid
+   * subdomain, and sent back to the owners of the vertices.
+   *
+   * The solid solver must be one of the Solid::MPI::SolidSolver, which does
+   * not support checkpointing, so the simulation always starts from scratch.
+   */
+  template <int dim>
+  class DistributedFSI
+  {
+  public:
+    DistributedFSI(Fluid::MPI::FluidSolver<dim> &,
+                   Solid::MPI::SolidSolver<dim> &,
+                   const Parameters::AllParameters &,
+                   bool use_dirichlet_bc = false);
+    void run();
+
+    //! Destructor
+    ~DistributedFSI();
+
+  private:
+    using Box = typename Utils::AABBTree<dim>::Box;
+
+    /// Gather the bounding boxes of the fluid subdomains of all processes.
+    void update_fluid_boxes();
+
+    /*! \brief Receive the solid cells that overlap the local fluid subdomain
+     *  in the current configuration, and rebuild the local copy of them.
+     */
+    void update_solid_overlap();
+
+    /*! \brief Find the overlapping solid cell that contains a point.
+     *
+     *  Returns false if the point is not in the solid, otherwise the index of
+     *  the cell in overlap_cells and the unit coordinates of the point.
+     */
+    bool
+    locate_in_solid(const Point<dim> &, unsigned int &, Point<dim> &) const;
+
+    /// Interpolate a field on the overlapping solid cells at a point.
+    Tensor<1, dim> solid_value(const Vector<double> &,
+                               const unsigned int,
+                               const Point<dim> &) const;
+
+    /// Update the indicator field of the fluid solver, see FSI.
+    void update_indicator();
+
+    /// Compute the fluid traction on the locally owned solid boundaries.
+    void find_solid_bc();
+
+    /// Compute the Dirichlet BCs or the FSI acceleration on the artificial
+    /// fluid, see FSI.
+    void find_fluid_bc();
+
+    /// Mesh adaption.
+    void refine_mesh(const unsigned int, const unsigned int);
+
+    /// Adapt the size of the next time step to the stability of both solvers
+    /// and the convergence of the fluid.
+    void adapt_time_step();
+
+    /*! \brief Exchange buffers with the other processes.
+     *
+     *  The keys are the ranks to send to (or received from), the buffer to
+     *  the process itself is moved over without communication.
+     */
+    std::map<unsigned int, std::vector<double>>
+    exchange(const std::map<unsigned int, std::vector<double>> &) const;
+
+    Fluid::MPI::FluidSolver<dim> &fluid_solver;
+    Solid::MPI::SolidSolver<dim> &solid_solver;
+    Parameters::AllParameters parameters;
+    MPI_Comm mpi_communicator;
+    ConditionalOStream pcout;
+    Utils::Time time;
+    mutable TimerOutput timer;
+
+    // The bounding boxes of the fluid cells that are not artificial (i.e.
+    // locally owned or ghost) and the locally owned fluid cells on every
+    // process.
+    std::vector<Box> fluid_boxes;
+    std::vector<Box> owned_fluid_boxes;
+
+    // The local copy of the solid cells that overlap the fluid subdomain, in
+    // the current configuration. The cells are not connected to each other.
+    std::unique_ptr<Triangulation<dim>> overlap_tria;
+    std::unique_ptr<DoFHandler<dim>> overlap_dof_handler;
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> overlap_cells;
+    // The boundary faces of each overlapping cell as a bit mask.
+    std::vector<unsigned int> overlap_boundary_faces;
+    Vector<double> overlap_velocity;
+    Vector<double> overlap_acceleration;
+    Utils::AABBTree<dim> overlap_tree;
+    MappingQ1<dim> mapping;
+
+    // Buffer for the candidates returned by the tree queries.
+    mutable std::vector<unsigned int> candidates;
+
+    // Batched interpolation of the fluid solution at the received solid
+    // boundary vertices.
+    Utils::PointEvaluator<dim, PETScWrappers::MPI::BlockVector>
+      fluid_evaluator;
+
+    bool use_dirichlet_bc;
+  };
+} // namespace MPI
+
+#endif
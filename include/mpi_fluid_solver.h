@@ -3,12 +3,14 @@
 
 #include <deal.II/base/function.h>
 #include <deal.II/base/logstream.h>
+#include <deal.II/base/multithread_info.h>
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/quadrature_point_data.h>
 #include <deal.II/base/tensor.h>
 #include <deal.II/base/tensor_function.h>
 #include <deal.II/base/timer.h>
 #include <deal.II/base/utilities.h>
+#include <deal.II/base/work_stream.h>
 
 #include <deal.II/lac/affine_constraints.h>
 #include <deal.II/lac/block_sparse_matrix.h>
@@ -32,6 +34,7 @@
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/grid/grid_refinement.h>
 #include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/filtered_iterator.h>
 #include <deal.II/grid/manifold_lib.h>
 #include <deal.II/grid/tria.h>
 #include <deal.II/grid/tria_accessor.h>
@@ -55,12 +58,21 @@
 #include <deal.II/distributed/solution_transfer.h>
 #include <deal.II/distributed/tria.h>
 
+#include <deque>
 #include <experimental/filesystem>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
+#include "cell_kernel.h"
+#include "flow_monitor.h"
+#include "instrumentation.h"
+#include "linear_algebra.h"
+#include "output_writers.h"
 #include "parameters.h"
+#include "solver_gcro.h"
+#include "solver_wrappers.h"
 #include "utilities.h"
 
 namespace fs = std::experimental::filesystem;
@@ -69,6 +81,9 @@ namespace MPI
 {
   template <int dim>
   class FSI;
+
+  template <int dim>
+  class DistributedFSI;
 }
 
 namespace Fluid
@@ -77,13 +92,25 @@ namespace Fluid
 
   namespace MPI
   {
-    /// Base class for all mpi fluid solvers.
-    template <int dim>
+    /*! \brief Base class for all mpi fluid solvers.
+     *
+     *  The vectors and matrices are those of the Backend of
+     *  Utils::LinearAlgebraTraits, PETSc by default. Only InsProjection
+     *  derives from the other backends, the FSI solvers and Parareal work
+     *  with PETSc.
+     */
+    template <int dim, typename Backend = Utils::PETScBackend>
     class FluidSolver
     {
     public:
       //! FSI solver need access to the private members of this solver.
       friend ::MPI::FSI<dim>;
+      friend ::MPI::DistributedFSI<dim>;
+
+      using Traits = Utils::LinearAlgebraTraits<Backend>;
+      using VectorType = typename Traits::Vector;
+      using BlockVectorType = typename Traits::BlockVector;
+      using BlockMatrixType = typename Traits::BlockSparseMatrix;
 
       //! Constructor.
       FluidSolver(parallel::distributed::Triangulation<dim> &,
@@ -106,11 +133,49 @@ namespace Fluid
           double(const Point<dim> &, const unsigned int, const double)> &);
 
       //! Return the solution for testing.
-      PETScWrappers::MPI::BlockVector get_current_solution() const;
+      BlockVectorType get_current_solution() const;
+
+      /*! \brief Take over the setup of another solver on the same
+       *  triangulation, e.g. the previous variant of an ensemble.
+       *
+       *  run() does not refine the mesh again, and the sparsity patterns of
+       *  the other solver are used as long as the dofs and the constraints
+       *  are the same, which sparsity_key checks. The dofs and constraints
+       *  are still set up, since the boundary values may differ. The
+       *  preconditioners depend on the parameters and are not shared.
+       */
+      void reuse_setup(const FluidSolver &);
+
+      /*! \brief Set up the mesh, the dofs, the constraints and the system as
+       *  run() does before the time loop, but without a restart, for
+       *  run_time_slice.
+       */
+      void setup_time_slices();
+
+      /*! \brief Run the time steps of a time slice from a solution at a
+       *  state of the time stepping, e.g. for Parareal.
+       *
+       *  The solution of the last step is then get_current_solution(). The
+       *  time steps are those of run(), so they output, save and refine
+       *  whenever it is time to. There is no solution history across slices,
+       *  and the nonzero constraints are only applied at the first time
+       *  step, whose initial solution does not satisfy them.
+       */
+      void run_time_slice(const BlockVectorType &,
+                          const Utils::Time::State &,
+                          const unsigned int);
 
     protected:
       class BoundaryValues;
       struct CellProperty;
+      struct AssemblyScratchData;
+      struct AssemblyCopyData;
+
+      /// The type of the cell workers in assemble_cells.
+      using CellWorker = std::function<void(
+        const typename DoFHandler<dim>::active_cell_iterator &,
+        AssemblyScratchData &,
+        AssemblyCopyData &)>;
 
       //! Pure abstract function to run simulation for one step
       virtual void run_one_step(bool apply_nonzero_constraints,
@@ -119,9 +184,31 @@ namespace Fluid
       //! Set up the dofs based on the finite element and renumber them.
       void setup_dofs();
 
-      //! Set up the nonzero and zero constraints.
+      /*! \brief Set up the nonzero and zero constraints.
+       *
+       *  The hanging node constraints and the Dirichlet dofs come from the
+       *  tables of make_boundary_dof_table, so only the values of the
+       *  hard-coded boundary conditions are evaluated again, at the support
+       *  points of their dofs.
+       */
       void make_constraints();
 
+      /*! \brief Make the hanging node constraints and the table of the
+       *  Dirichlet dofs of fluid_dirichlet_bcs, their components and support
+       *  points, which only change along with the mesh.
+       */
+      void make_boundary_dof_table();
+
+      /*! \brief Reset both constraints to the zero constraints of the last
+       *  make_constraints.
+       *
+       *  This copies the cached hanging node and boundary constraints, rather
+       *  than looping over the mesh and the boundary again, so the FSI can
+       *  drop the artificial fluid constraints of the last step at the cost
+       *  of the number of constraints.
+       */
+      void restore_static_constraints();
+
       //! Initialize the cell properties, which only matters in FSI
       //! applications.
       void setup_cell_property();
@@ -130,6 +217,18 @@ namespace Fluid
       /// the dofs and constraints.
       virtual void initialize_system();
 
+      /*! \brief The key of the sparsity patterns in sparsity_cache.
+       *
+       *  It consists of the sizes of the blocks, the checksum of the mesh,
+       *  and hashes of the locally owned dofs and of the constrained lines
+       *  of nonzero_constraints, which is collective.
+       */
+      std::vector<unsigned long long> sparsity_key() const;
+
+      /// The file that the sparsity cache of this process is saved to along
+      /// with a checkpoint file.
+      std::string sparsity_cache_file(const std::string &) const;
+
       /// Mesh adaption.
       void refine_mesh(const unsigned int, const unsigned int);
 
@@ -145,8 +244,120 @@ namespace Fluid
       /// Load from checkpoint to restart.
       bool load_checkpoint();
 
+      /// Advance the time of a restart to the step of the checkpoint, and
+      /// restore the records of the outputs before it.
+      void restore_time(const int);
+
+      /*! \brief Run the cell loop of an assembly on the locally owned cells.
+       *
+       *  The worker computes the local contributions of a cell, and may run
+       *  on several threads at the same time with their own scratch data.
+       *  WorkStream calls the copier on one thread at a time, so it can add
+       *  the copy data to the matrices and vectors without any lock.
+       *
+       *  The interior cells, whose dofs are all locally owned, are assembled
+       *  first. The ghost updates started by start_ghost_update are then
+       *  finished, before the cells that read ghost values.
+       */
+      void
+      assemble_cells(const CellWorker &,
+                     const std::function<void(const AssemblyCopyData &)> &);
+
+      /*! \brief Copy a non-ghosted vector to a ghosted one, and start the
+       *  exchange of the ghost values.
+       *
+       *  This replaces the assignment of the vectors that the next assembly
+       *  reads, so that the communication overlaps with the interior cells.
+       *  The owned values can be read immediately, the ghost values only
+       *  after finish_ghost_updates, which assemble_cells calls. Trilinos
+       *  exchanges the ghost values at once.
+       */
+      void start_ghost_update(BlockVectorType &ghosted,
+                              const BlockVectorType &owned);
+
+      /// Wait for the ghost updates that have been started.
+      void finish_ghost_updates();
+
+      /*! \brief The largest time step size at the target CFL number with the
+       *  present velocity, or infinity if the CFL number is not limited.
+       *
+       *  This is collective.
+       */
+      double cfl_time_step() const;
+
+      /*! \brief The PSPG and SUPG parameter of the equal-order
+       *  stabilization at a velocity in a cell of diameter h, after Tezduyar:
+       *  \f$\tau = ((2/\Delta{t})^2 + (2|u|/h)^2 + 9(4\nu/h^2)^2)^{-1/2}\f$
+       *  with the kinematic viscosity \f$\nu\f$.
+       */
+      double stabilization_parameter(const Tensor<1, dim> &velocity,
+                                     const double h) const;
+
+      /*! \brief The factor on the time step size from the iteration counts
+       *  of the last time step.
+       *
+       *  It is the smallest ratio of the target and the actual counts, but
+       *  not less than 0.5, or infinity if there is no target.
+       */
+      double iteration_factor() const;
+
+      /*! \brief Add the memory of the mesh, the sparsity patterns, the
+       *  matrices, the vectors and the cell data to a report.
+       *
+       *  The solvers with more data add theirs.
+       */
+      virtual void add_memory(Utils::MemoryReport &) const;
+
+      /// Print the memory report if the system was set up since the last
+      /// one, which is collective.
+      void report_memory();
+
+      /// Adapt the size of the next time step when the fluid runs alone.
+      void adapt_time_step();
+
+      /// Store present_solution as the solution at the current time for the
+      /// extrapolation, before the time is incremented.
+      void update_solution_history();
+
+      /*! \brief Save the solution and the time before a time step, or go
+       *  back to them to repeat it, e.g. in the iterations of an implicit
+       *  coupling.
+       *
+       *  The outputs written since are forgotten, and will be written again.
+       *  Everything that is rebuilt from the solution, or kept across time
+       *  steps anyway, such as the preconditioners, is left alone.
+       */
+      void save_step_state();
+      void restore_step_state();
+
+      /*! \brief Extrapolate the initial guess of Newton's method at the
+       *  current time from the stored solutions.
+       *
+       *  The guess is the Lagrange polynomial through the last
+       *  "Extrapolation order" + 1 solutions, or present_solution if there is
+       *  only one. The extrapolated change is constrained with
+       *  zero_constraints, so the guess takes the Dirichlet values of
+       *  present_solution and the Newton updates apply the BCs as before.
+       */
+      void extrapolate_solution(BlockVectorType &) const;
+
       std::vector<types::global_dof_index> dofs_per_block;
 
+      /// The locally owned cells sorted by their lowest dof, set up with the
+      /// dofs and traversed by assemble_cells.
+      std::vector<typename DoFHandler<dim>::active_cell_iterator>
+        assembly_cells;
+
+      /// The number of interior cells, which come first in assembly_cells.
+      unsigned int n_interior_cells;
+
+      /// The geometry of the locally owned cells, which assemble_cells fills
+      /// on the first assembly after setup_dofs if it fits the budget.
+      Utils::CellGeometryCache<dim> geometry_cache;
+
+      /// The vectors whose ghost updates are started but not finished.
+      std::vector<BlockVectorType *> pending_ghost_updates;
+
       parallel::distributed::Triangulation<dim> &triangulation;
       FESystem<dim> fe;
       FE_Q<dim> scalar_fe;
@@ -157,20 +368,75 @@ namespace Fluid
 
       AffineConstraints<double> zero_constraints;
       AffineConstraints<double> nonzero_constraints;
+      /// The zero_constraints made by make_constraints, which do not change
+      /// until the mesh does.
+      AffineConstraints<double> static_constraints;
+      /// The hanging node constraints of the mesh, not closed.
+      AffineConstraints<double> hanging_node_constraints;
+
+      /// The locally relevant Dirichlet dofs of an entry of
+      /// fluid_dirichlet_bcs.
+      struct DirichletDoFs
+      {
+        types::boundary_id boundary_id;
+        std::vector<types::global_dof_index> dofs;
+        std::vector<unsigned int> components;
+        std::vector<Point<dim>> support_points;
+        /// The values of the input file by component, used unless there is
+        /// a hard-coded condition on the boundary.
+        std::vector<double> constant_values;
+      };
+      /// The Dirichlet dofs of fluid_dirichlet_bcs, in its order.
+      std::vector<DirichletDoFs> dirichlet_dofs;
 
+      /// The pattern before it is distributed, which is only rebuilt along
+      /// with sparsity_cache. It is empty if the patterns were loaded with a
+      /// checkpoint.
       BlockSparsityPattern sparsity_pattern;
-      PETScWrappers::MPI::BlockSparseMatrix system_matrix;
-      PETScWrappers::MPI::BlockSparseMatrix mass_matrix;
-      PETScWrappers::MPI::BlockSparseMatrix mass_schur;
+      /// The distributed patterns of the matrices and of mass_schur.
+      Utils::SparsityCache sparsity_cache;
+      /// Whether the mesh and the sparsity cache are taken over from another
+      /// solver by reuse_setup.
+      bool setup_reused;
+      BlockMatrixType system_matrix;
+      BlockMatrixType mass_matrix;
+      BlockMatrixType mass_schur;
+      /// The pressure convection of the PCD Schur approximation, which
+      /// shares the pattern of mass_schur and is only set up if it is used.
+      BlockMatrixType pressure_convection;
 
       /// The latest known solution.
-      PETScWrappers::MPI::BlockVector present_solution;
-      PETScWrappers::MPI::BlockVector solution_increment;
-      PETScWrappers::MPI::BlockVector system_rhs;
+      BlockVectorType present_solution;
+      BlockVectorType solution_increment;
+      BlockVectorType system_rhs;
+
+      /// The temporary vectors of the preconditioners, in the layout of
+      /// owned_partitioning.
+      Utils::GenericVectorPool<VectorType> workspace;
+
+      /// The directions that the outer solver recycles, if it is GCRO.
+      Utils::KrylovRecycleSpace<BlockVectorType> recycle_space;
+
+      /// The solutions of the last time steps and their times, latest first,
+      /// which are cleared whenever the system is reinitialized.
+      std::deque<BlockVectorType> solution_history;
+      std::deque<double> solution_history_times;
+
+      /// What save_step_state saves.
+      struct StepState
+      {
+        Utils::Time::State time;
+        BlockVectorType present_solution;
+        BlockVectorType solution_increment;
+        std::deque<BlockVectorType> solution_history;
+        std::deque<double> solution_history_times;
+        std::size_t n_outputs;
+      };
+      StepState step_state;
 
       /// FSI acceleration vector, which is attached on the solution dof
       /// handloer
-      PETScWrappers::MPI::BlockVector fsi_acceleration;
+      BlockVectorType fsi_acceleration;
 
       /**
        * Nodal strain and stress obtained by taking the average of surrounding
@@ -178,7 +444,7 @@ namespace Fluid
        * [dim, dim, scalar_dof_handler.n_dofs()], i.e., stress[i][j][k]
        * denotes sigma_{ij} at vertex k.
        */
-      mutable std::vector<std::vector<PETScWrappers::MPI::Vector>> stress;
+      mutable std::vector<std::vector<VectorType>> stress;
 
       Parameters::AllParameters parameters;
 
@@ -204,30 +470,246 @@ namespace Fluid
       /// The vector to store vtu filenames that will be written into pvd file.
       mutable std::vector<std::pair<double, std::string>> times_and_names;
 
+      /// The HDF5 output if the output format is hdf5.
+      mutable Utils::HDF5Output hdf5_output;
+      /// The in-situ pipelines if the output format is ascent.
+      mutable Utils::InSituOutput insitu_output;
+      /// The writer of the vtu and pvd files.
+      mutable Utils::AsyncWriter writer;
+
       Utils::Time time;
       mutable TimerOutput timer;
       mutable TimerOutput timer2;
-
-      CellDataStorage<
-        typename parallel::distributed::Triangulation<dim>::cell_iterator,
-        CellProperty>
-        cell_property;
+      /// The timer sections and the Krylov iterations for the performance
+      /// tests, written when the solver is destroyed.
+      Utils::PerformanceSummary performance;
+      /// The per time step log of the timer sections and the iterations.
+      Utils::Telemetry telemetry;
+      /// The memory of the subsystems, printed if "Memory report" is set.
+      Utils::MemoryReport memory_report;
+      /// The probes and boundary forces written every time step.
+      Utils::FlowMonitor<dim, BlockVectorType> monitor;
+
+      /// The Newton iterations of the last time step, and the most linear
+      /// solver iterations in it, for adaptive time stepping.
+      unsigned int n_newton_iterations;
+      unsigned int n_linear_iterations;
 
       /// Hard-coded boundary values, only used when told so in the input
       /// parameters.
       std::map<int, BoundaryValues> hard_coded_boundary_values;
 
+      /// The PETSc and Trilinos vectors are not thread-safe, so the cell
+      /// workers must hold this lock when they read the solution vectors.
+      std::mutex assembly_mutex;
+
       /// A data structure that caches the real/artificial fluid indicator,
-      /// FSI stress, and FSI acceleration terms at quadrature points, that
-      /// will only be used in FSI simulations.
+      /// FSI stress, and FSI acceleration terms of the cells, that will only
+      /// be used in FSI simulations. Every field is a contiguous array
+      /// indexed by the active cell index, which is rebuilt whenever the
+      /// mesh changes, so the assembly reads it without any lookup.
       struct CellProperty
       {
-        int indicator; //!< Domain indicator: 1 for artificial fluid 0 for real
-                       //! fluid.
-        Tensor<1, dim>
+        std::vector<int> indicator; //!< Domain indicator: 1 for artificial
+                                    //! fluid 0 for real fluid.
+        std::vector<Tensor<1, dim>>
           fsi_acceleration; //!< The acceleration term in FSI force.
-        SymmetricTensor<2, dim> fsi_stress; //!< The stress term in FSI force.
-        int material_id; //!< The material id of the surrounding solid cell.
+        std::vector<SymmetricTensor<2, dim>>
+          fsi_stress; //!< The stress term in FSI force.
+        std::vector<int>
+          material_id; //!< The material id of the surrounding solid cell.
+      };
+      CellProperty cell_property;
+
+      /**
+       * The thread-local data of assemble_cells: the FEValues objects, the
+       * shape functions at a quadrature point, and the solution fields at the
+       * quadrature points of a cell. The fields are the union of those used
+       * by the derived solvers.
+       *
+       * The workers evaluate the volume shape functions and fields through
+       * reinit and the accessors below rather than fe_values: on a cell of
+       * the geometry cache, the shape values and reference gradients are
+       * tabulated once, and the gradients are mapped with the cached inverse
+       * Jacobians, so the mapping is not evaluated. This holds because the
+       * shape values of the Lagrange elements do not depend on the mapping.
+       */
+      struct AssemblyScratchData
+      {
+        AssemblyScratchData(const FiniteElement<dim> &,
+                            const Quadrature<dim> &,
+                            const Quadrature<dim - 1> &,
+                            const Utils::CellGeometryCache<dim> * = nullptr);
+        AssemblyScratchData(const AssemblyScratchData &);
+
+        /// Reinit for a cell, from the geometry cache if it has the cell, or
+        /// with fe_values otherwise.
+        void reinit(const typename DoFHandler<dim>::active_cell_iterator &);
+
+        double JxW(const unsigned int q) const
+        {
+          return cached ? cached_JxW[q] : fe_values.JxW(q);
+        }
+
+        const std::vector<Point<dim>> &get_quadrature_points() const
+        {
+          return cached ? cached_quadrature_points
+                        : fe_values.get_quadrature_points();
+        }
+
+        double shape_value(const unsigned int k, const unsigned int q) const
+        {
+          return cached ? reference_values[q * dofs_per_cell + k]
+                        : fe_values.shape_value(k, q);
+        }
+
+        Tensor<1, dim> shape_grad(const unsigned int k,
+                                  const unsigned int q) const
+        {
+          return cached ? cached_gradients[q * dofs_per_cell + k]
+                        : fe_values.shape_grad(k, q);
+        }
+
+        /// The shape functions of the velocity and pressure components, as
+        /// fe_values[velocities] and fe_values[pressure].
+        Tensor<1, dim> velocity_value(const unsigned int k,
+                                      const unsigned int q) const
+        {
+          if (!cached)
+            {
+              return fe_values[velocities].value(k, q);
+            }
+          Tensor<1, dim> value;
+          if (components[k] < dim)
+            {
+              value[components[k]] = reference_values[q * dofs_per_cell + k];
+            }
+          return value;
+        }
+
+        Tensor<2, dim> velocity_gradient(const unsigned int k,
+                                         const unsigned int q) const
+        {
+          if (!cached)
+            {
+              return fe_values[velocities].gradient(k, q);
+            }
+          Tensor<2, dim> gradient;
+          if (components[k] < dim)
+            {
+              gradient[components[k]] =
+                cached_gradients[q * dofs_per_cell + k];
+            }
+          return gradient;
+        }
+
+        double velocity_divergence(const unsigned int k,
+                                   const unsigned int q) const
+        {
+          if (!cached)
+            {
+              return fe_values[velocities].divergence(k, q);
+            }
+          return components[k] < dim
+                   ? cached_gradients[q * dofs_per_cell + k][components[k]]
+                   : 0.0;
+        }
+
+        double pressure_value(const unsigned int k, const unsigned int q) const
+        {
+          if (!cached)
+            {
+              return fe_values[pressure].value(k, q);
+            }
+          return components[k] == dim
+                   ? reference_values[q * dofs_per_cell + k]
+                   : 0.0;
+        }
+
+        Tensor<1, dim> pressure_gradient(const unsigned int k,
+                                         const unsigned int q) const
+        {
+          if (!cached)
+            {
+              return fe_values[pressure].gradient(k, q);
+            }
+          return components[k] == dim
+                   ? cached_gradients[q * dofs_per_cell + k]
+                   : Tensor<1, dim>();
+        }
+
+        /// The fields of a vector at the quadrature points of the cell, as
+        /// the get_function_* of fe_values.
+        void get_velocity_values(const BlockVectorType &,
+                                 std::vector<Tensor<1, dim>> &);
+        void get_velocity_gradients(const BlockVectorType &,
+                                    std::vector<Tensor<2, dim>> &);
+        void get_velocity_divergences(const BlockVectorType &,
+                                      std::vector<double> &);
+        void get_pressure_values(const BlockVectorType &,
+                                 std::vector<double> &);
+        void get_pressure_gradients(const BlockVectorType &,
+                                    std::vector<Tensor<1, dim>> &);
+
+        FEValues<dim> fe_values;
+        FEFaceValues<dim> fe_face_values;
+
+        const FEValuesExtractors::Vector velocities;
+        const FEValuesExtractors::Scalar pressure;
+        const unsigned int dofs_per_cell;
+        const unsigned int n_q_points;
+        const Utils::CellGeometryCache<dim> *geometry_cache;
+        /// Whether the cell of the last reinit is in the geometry cache.
+        bool cached;
+        typename DoFHandler<dim>::active_cell_iterator cell;
+        /// The component of every shape function, and the shape values and
+        /// reference gradients at q * dofs_per_cell + k.
+        std::vector<unsigned int> components;
+        std::vector<double> reference_values;
+        std::vector<Tensor<1, dim>> reference_gradients;
+        /// The real gradients and the geometry of a cached cell.
+        std::vector<Tensor<1, dim>> cached_gradients;
+        std::vector<Point<dim>> cached_quadrature_points;
+        ArrayView<const double> cached_JxW;
+        /// The dof values of a vector on a cached cell.
+        Vector<double> local_values;
+
+        std::vector<double> div_phi_u;
+        std::vector<Tensor<1, dim>> phi_u;
+        std::vector<Tensor<2, dim>> grad_phi_u;
+        std::vector<double> phi_p;
+        std::vector<Tensor<1, dim>> grad_phi_p;
+        /// The PSPG and SUPG weights of the test functions and the
+        /// linearized momentum residuals of the shape functions in the
+        /// equal-order stabilization.
+        std::vector<Tensor<1, dim>> stabilization_weights;
+        std::vector<Tensor<1, dim>> stabilization_residuals;
+
+        std::vector<Tensor<1, dim>> current_velocity_values;
+        std::vector<Tensor<2, dim>> current_velocity_gradients;
+        std::vector<double> current_velocity_divergences;
+        std::vector<double> current_pressure_values;
+        std::vector<Tensor<1, dim>> current_pressure_gradients;
+        std::vector<Tensor<1, dim>> present_velocity_values;
+        std::vector<double> present_pressure_values;
+        std::vector<Tensor<1, dim>> fsi_acc_values;
+        std::vector<double> sigma_pml;
+        std::vector<Tensor<1, dim>> artificial_bf;
+      };
+
+      /// The local contributions of a cell in assemble_cells.
+      struct AssemblyCopyData
+      {
+        AssemblyCopyData(const unsigned int);
+
+        FullMatrix<double> local_matrix;
+        FullMatrix<double> local_mass_matrix;
+        Vector<double> local_rhs;
+        std::vector<types::global_dof_index> local_dof_indices;
+        /// The pressure-pressure matrix of the PCD Schur approximation and
+        /// its dofs, which are sized by the solvers that assemble it.
+        FullMatrix<double> local_pressure_convection;
+        std::vector<types::global_dof_index> local_pressure_dof_indices;
       };
 
       class BoundaryValues : public Function<dim>
@@ -238,6 +720,7 @@ namespace Fluid
         BoundaryValues(
           const std::function<
             double(const Point<dim> &, const unsigned int, const double)> &);
+        virtual double value(const Point<dim> &, const unsigned int) const;
         virtual void vector_value(const Point<dim> &, Vector<double> &) const;
 
       private:
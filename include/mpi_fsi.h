@@ -1,7 +1,9 @@
 #ifndef MPI_FSI
 #define MPI_FSI
 
+#include <deal.II/base/array_view.h>
 #include <deal.II/base/table_indices.h>
+#include <deal.II/fe/mapping_q_eulerian.h>
 #include <deal.II/physics/elasticity/standard_tensors.h>
 
 #include "mpi_fluid_solver.h"
@@ -25,6 +27,10 @@ extern template class Utils::SPHInterpolator<2,
                                              PETScWrappers::MPI::BlockVector>;
 extern template class Utils::SPHInterpolator<3,
                                              PETScWrappers::MPI::BlockVector>;
+extern template class Utils::PointEvaluator<2,
+                                            PETScWrappers::MPI::BlockVector>;
+extern template class Utils::PointEvaluator<3,
+                                            PETScWrappers::MPI::BlockVector>;
 extern template class Utils::CellLocator<2, DoFHandler<2, 2>>;
 extern template class Utils::CellLocator<3, DoFHandler<3, 3>>;
 
@@ -43,22 +49,80 @@ namespace MPI
     //! Destructor
     ~FSI();
 
+    /*! \brief The communicator to construct the fluid and solid solvers with
+     *  on this process.
+     *
+     *  If "Solid processes" is 0 this is MPI_COMM_WORLD. Otherwise the first
+     *  n processes only run the solid and the others only run the fluid, and
+     *  each group gets a new communicator that should be freed by the caller
+     *  after the simulation. Both solvers on a process must be constructed
+     *  with the same communicator.
+     */
+    static MPI_Comm solver_communicator(const Parameters::AllParameters &);
+
+    /// The largest relative residual of the interface stress at the end of
+    /// the implicit coupling of a time step so far, which is above the
+    /// tolerance if a step ran out of coupling iterations.
+    double get_coupling_residual() const { return coupling_residual; }
+
   private:
-    /// Collect all the boundary lines in solid triangulation.
+    /// Collect all the boundary lines (faces in 3D) and vertices in solid
+    /// triangulation.
     void collect_solid_boundaries();
 
     /// Setup the hints for searching for each fluid cell.
     void setup_cell_hints();
 
-    /// Define a smallest rectangle (or hex in 3d) that contains the solid.
+    /*! \brief Save a hint of every fluid cell before the mesh changes, under
+     * the cell that it will be passed to, according to the refinement flags.
+     */
+    void save_cell_hints();
+
+    /// Define a smallest rectangle (or hex in 3d) that contains the solid,
+    /// and one that contains each of the solid bodies.
     void update_solid_box();
 
+    /// Find the connected components of the solid mesh, and the body of
+    /// every vertex and boundary face.
+    void collect_solid_bodies();
+
+    /// Check if a box is entirely inside the box of one of the solid bodies.
+    bool in_solid_body_box(const typename Utils::AABBTree<dim>::Box &) const;
+
+    /// Check if a box overlaps the box of one of the solid bodies.
+    bool near_solid_body(const typename Utils::AABBTree<dim>::Box &) const;
+
+    /// Copy the current coordinates of solid_boundaries into
+    /// solid_boundary_coords, and return their bounding boxes.
+    std::vector<typename Utils::AABBTree<dim>::Box>
+    update_solid_boundary_coords();
+
     /// Find the vertices that are onwed by the local process.
     void update_vertices_mask();
 
     /// Check if a point is inside a mesh.
     bool point_in_solid(const DoFHandler<dim> &, const Point<dim> &);
 
+    /*! \brief Check if a batch of points are inside the solid.
+     *
+     *  Intended for the points of one fluid cell: the tree is queried only
+     *  once with the bounding box of the points, and in 2D the crossing test
+     *  then loops over the contiguous boundary coordinates for all points.
+     */
+    void points_in_solid(const ArrayView<const Point<dim>> &,
+                         std::vector<bool> &);
+
+    /*! \brief Crossing number test of a point against one solid boundary
+     *  line in 2D.
+     *
+     *  Updates the (half) cross numbers, and returns true if the point is on
+     *  the line.
+     */
+    bool cross_solid_boundary(const unsigned int,
+                              const Point<dim> &,
+                              unsigned int &,
+                              unsigned int &) const;
+
     /*! \brief Update the indicator field of the fluid solver.
      *
      *  Although the indicator field is defined at quadrature points in order
@@ -66,6 +130,9 @@ namespace MPI
      * updated as a whole: they are either all 1 or all 0. The criteria is
      * that whether all of the vertices are in solid mesh (because later on
      * Dirichlet BCs obtained from the solid will be applied).
+     *
+     *  In the incremental mode, only the cells that the solid boundary has
+     *  swept over since the last update are re-tested.
      */
     void update_indicator();
 
@@ -73,6 +140,43 @@ namespace MPI
     /// displacements,
     void move_solid_mesh(bool);
 
+    /// Update the deformed configuration of the Eulerian solid mapping, if
+    /// the displacement has changed since it was last updated.
+    void update_deformed_solid();
+
+    /// The current coordinates of the solid vertices, which are those of the
+    /// triangulation unless the Eulerian solid mapping is used.
+    const std::vector<Point<dim>> &solid_vertices() const;
+
+    /// The entries of the first n of the localized solid displacement,
+    /// velocity and acceleration, either in shared_solid_state or in the
+    /// local vectors.
+    std::vector<ArrayView<const double>>
+    localize_solid_state(std::vector<Vector<double>> &, const unsigned int);
+
+    /*! \brief Gather the solid velocity and acceleration at the dofs that the
+     *  fluid cells of this process can interpolate from in find_fluid_bc.
+     *
+     *  These are the dofs of the solid cells which overlap the bounding box
+     *  of the fluid cells near the solid, intersected with the solid box.
+     *  They are the ghosts of relevant_solid_velocity and
+     *  relevant_solid_acceleration, which are only rebuilt when the set
+     *  changes on some process, so that PETSc reuses their scatters.
+     */
+    void gather_relevant_solid_state();
+
+    /*! \brief Collect the fluid cells that find_fluid_bc works on.
+     *
+     *  The penalty force is only applied on the locally owned artificial
+     *  cells, i.e. the cells with nonzero indicators. The Dirichlet BCs can
+     *  also be set on the support points of the cells that the solid
+     *  boundary goes through, which are the owned cells whose boxes overlap
+     *  the boxes of the solid boundary faces, and on the ghost cells near
+     *  the solid, whose indicators are not known here. Every other cell is
+     *  entirely in or out of the solid, so the lists cover the interface.
+     */
+    void update_coupling_cells();
+
     /*! \brief Compute the fluid traction on solid boundaries.
      *
      *  The implementation is straight-forward: loop over the faces on the
@@ -104,8 +208,111 @@ namespace MPI
      */
     void find_fluid_bc();
 
-    /// Mesh adaption.
-    void refine_mesh(const unsigned int, const unsigned int);
+    /// Mesh adaption, which returns whether the mesh has changed, and only
+    /// then saved the cell hints for setup_cell_hints.
+    bool refine_mesh(const unsigned int, const unsigned int);
+
+    /// Save the current solid state as the beginning (0) or the end (1) of
+    /// the coupling time step.
+    void save_solid_state(const unsigned int);
+
+    /// Set the current solid state to the linear interpolation between the
+    /// beginning (0) and the end (1) of the coupling time step.
+    void interpolate_solid_state(const double);
+
+    /// Copy the fluid stress in fluid_stress_buffer into the fsi_stress_rows
+    /// of the solid solver.
+    void assign_solid_bc();
+
+    /*! \brief Number the solid dofs in the order they first appear in the
+     *  active cells.
+     *
+     *  Unlike the dof indices, this order does not depend on the number of
+     *  processes that the solid is distributed on, so it is used to transfer
+     *  the solid state between the solid and the fluid processes.
+     */
+    void setup_solid_transfer();
+
+    /// Pack the displacement, velocity, acceleration and nodal stress of the
+    /// solid into solid_state_buffer, or unpack them from it.
+    void pack_solid_state();
+    void unpack_solid_state();
+
+    /*! \brief Number the locally owned fluid dofs in the order they first
+     *  appear in the forest.
+     *
+     *  The leaves of the forest are visited along the space filling curve
+     *  that p4est partitions along. Since a dof on the interface of two
+     *  subdomains is owned by the lower one, which comes first along the
+     *  curve, the dofs of each process are a contiguous range of this order,
+     *  starting at canonical_fluid_offset. The order only depends on the
+     *  mesh, not on the number of processes.
+     */
+    void setup_fluid_transfer();
+
+    /*! \brief Save a coupled checkpoint with the current time, the fluid
+     *  solution and the solid state.
+     *
+     *  All of the processes write into one file with collective MPI-IO, in
+     *  the orders of setup_fluid_transfer and setup_solid_transfer. The
+     *  fluid mesh is saved by p4est into a separate snapshot, which is only
+     *  saved again after the mesh has changed. The solid mesh never changes
+     *  and is not saved. Only the latest checkpoint and its mesh are kept.
+     */
+    void save_checkpoint();
+
+    /// Load the latest coupled checkpoint, possibly with a different number
+    /// of processes. Returns false if there is none.
+    bool load_checkpoint();
+
+    /// Whether a fluid cell is close enough to the solid to take part in
+    /// the coupling work.
+    bool near_solid(const typename Triangulation<dim>::cell_iterator &) const;
+
+    /*! \brief Repartition the fluid if the load is imbalanced.
+     *
+     *  Every few steps, the fluid and coupling times of the processes since
+     *  the last check are compared, and if the slowest process is above the
+     *  threshold, the costs of a fluid cell and of the extra coupling work
+     *  of a cell near the solid are estimated from them. The fluid is then
+     *  repartitioned by p4est with these weights, which also apply to the
+     *  later refinements.
+     */
+    void balance_load();
+
+    /*! \brief Advance the fluid over a coupling time step.
+     *
+     *  If the fluid takes more than one step in it, the solid state is
+     *  linearly interpolated in time between solid_states at every step.
+     */
+    void run_fluid_substeps(const bool);
+
+    /*! \brief Check the convergence of an implicit coupling iteration.
+     *
+     *  The fluid stress on the solid boundary is found from the new fluid
+     *  solution and compared to the one the solid was given. If they differ
+     *  by more than the tolerance, the accelerated stress is given to the
+     *  solid for the next iteration, and false is returned.
+     */
+    bool check_coupling(const unsigned int iteration);
+
+    /*! \brief The time loop when the solid has its own processes.
+     *
+     *  The solid processes run step n with the fluid traction of step n - 1,
+     *  while the fluid processes run step n with the solid state of step
+     *  n - 1, so that the two solvers advance at the same time. The coupling
+     *  data are broadcast with non-blocking collectives at the end of every
+     *  step, which are waited for only when they are needed.
+     */
+    void run_concurrently();
+
+    /*! \brief Adapt the size of the next coupling time step, and divide it
+     *  into the steps of the solvers.
+     *
+     *  The step is limited by the stability of both solvers and the
+     *  convergence of the fluid, and all of the processes agree on it.
+     */
+    void adapt_time_step();
 
     // For MPI FSI, the solid solver uses shared trianulation. i.e.,
     // each process has the entire graph, for the ease of looping.
@@ -117,14 +324,65 @@ namespace MPI
     Utils::Time time;
     mutable TimerOutput timer;
 
+    // The timer sections for the performance tests, written when the FSI is
+    // destroyed.
+    Utils::PerformanceSummary performance;
+
     // This vector represents the smallest box that contains the solid.
     // The point stored is in the order of:
     // (x_min, x_max, y_min, y_max, z_min, z_max)
     Vector<double> solid_box;
 
+    // The connected components of the solid mesh, e.g. several leaflets: the
+    // body of every used solid vertex and of every one of solid_boundaries,
+    // and the bounding box of every body in the current configuration. The
+    // inside tests of the points in none of the boxes are culled, and those
+    // in some only go through the boundaries of these bodies.
+    std::vector<unsigned int> solid_vertex_bodies;
+    std::vector<unsigned int> solid_boundary_bodies;
+    std::vector<typename Utils::AABBTree<dim>::Box> solid_body_boxes;
+
     // This vector collects the solid boundaries for computing thw winding
     // number.
-    std::list<typename Triangulation<dim>::face_iterator> solid_boundaries;
+    std::vector<typename Triangulation<dim>::face_iterator> solid_boundaries;
+
+    // The vertices on the solid boundary and the dofs of their components.
+    // They only depend on the topology of the solid mesh so they are cached
+    // in collect_solid_boundaries. fsi_stress_rows are only nonzero on these
+    // dofs.
+    std::vector<unsigned int> solid_boundary_vertices;
+    std::vector<std::array<types::global_dof_index, dim>> solid_boundary_lines;
+
+    // A contiguous copy of the end points of solid_boundaries in 2D, which is
+    // refreshed whenever the solid moves, so that the crossing test does not
+    // go through the triangulation.
+    struct
+    {
+      std::vector<double> x1, y1, x2, y2;
+    } solid_boundary_coords;
+
+    // Bounding volume hierarchy over solid_boundaries. It is built once and
+    // refitted whenever the solid moves. The 2D inside test casts rays through
+    // it, and update_coupling_cells finds the interface band with it.
+    Utils::AABBTree<dim> solid_tree;
+
+    // The solid boundary surface for the inside test in 3D.
+    Utils::ClosedSurface solid_surface;
+
+    // The boxes of solid_boundaries in the current configuration, and in the
+    // configuration where the indicator was last updated.
+    std::vector<typename Utils::AABBTree<dim>::Box> solid_boundary_boxes;
+    std::vector<typename Utils::AABBTree<dim>::Box> indicator_boxes;
+
+    // The regions swept by solid_boundaries since the last indicator update.
+    Utils::AABBTree<dim> solid_band;
+
+    // Whether all of the fluid cells must be re-tested in update_indicator,
+    // e.g. at the first step or after mesh refinement.
+    bool full_indicator_update;
+
+    // Buffer for the candidates returned by the tree queries.
+    std::vector<unsigned int> solid_candidates;
 
     // A mask that marks local fluid vertices for solid bc interpolation
     // searching.
@@ -136,7 +394,114 @@ namespace MPI
       typename DoFHandler<dim>::active_cell_iterator>
       cell_hints;
 
+    // The hints saved by save_cell_hints, indexed by the level and the index
+    // of the cells, which are consumed by setup_cell_hints.
+    std::map<std::pair<int, int>,
+             typename DoFHandler<dim>::active_cell_iterator>
+      saved_cell_hints;
+
+    // Cell locator for the solid mesh, whose topology never changes.
+    Utils::CellLocator<dim, DoFHandler<dim>> solid_locator;
+
+    // Batched interpolation of the fluid solution at solid points, which is
+    // set up once per step since the solid moves.
+    Utils::PointEvaluator<dim, PETScWrappers::MPI::BlockVector>
+      fluid_evaluator;
+
+    // Interpolation of the fluid solution at the solid boundary vertices,
+    // which is only updated for the moved vertices between refinements.
+    Utils::PointEvaluator<dim, PETScWrappers::MPI::BlockVector>
+      boundary_evaluator;
+
     bool use_dirichlet_bc;
+
+    // Whether the solid runs on its own processes, and whether this is one of
+    // them, see solver_communicator.
+    bool split;
+    bool solid_process;
+
+    // The solid dofs and scalar dofs in the order of setup_solid_transfer.
+    std::vector<types::global_dof_index> canonical_solid_dofs;
+    std::vector<types::global_dof_index> canonical_scalar_dofs;
+
+    // The locally owned fluid dofs in the order of setup_fluid_transfer, and
+    // the position of the first of them in the order.
+    std::vector<types::global_dof_index> canonical_fluid_dofs;
+    types::global_dof_index canonical_fluid_offset;
+
+    // The time step of the fluid mesh snapshot of the coupled checkpoints,
+    // or -1 if the mesh has changed since.
+    int checkpoint_mesh_step;
+
+    // The compact fluid stress at solid_boundary_vertices, and the solid state
+    // in the canonical order, which are broadcast between the two groups of
+    // processes in the split mode, together with the pending requests.
+    Vector<double> fluid_stress_buffer;
+    Vector<double> solid_state_buffer;
+    MPI_Request fluid_stress_request;
+    MPI_Request solid_state_request;
+
+    // The solid state at the beginning and the end of the coupling time step,
+    // which are only needed if the fluid takes more than one step in it.
+    struct SolidState
+    {
+      PETScWrappers::MPI::Vector displacement;
+      PETScWrappers::MPI::Vector velocity;
+      PETScWrappers::MPI::Vector acceleration;
+      std::vector<std::vector<PETScWrappers::MPI::Vector>> stress;
+    };
+    SolidState solid_states[2];
+
+    // The acceleration of the implicit coupling iterations.
+    Utils::CouplingAccelerator coupling_accelerator;
+    // The residual of the last coupling iteration, and the largest one at
+    // the end of a time step.
+    double iteration_residual;
+    double coupling_residual;
+
+    // The solid dofs that are not owned but needed by find_fluid_bc on this
+    // process, and the solid velocity and acceleration ghosted on them.
+    IndexSet relevant_solid_dofs;
+    PETScWrappers::MPI::Vector relevant_solid_velocity;
+    PETScWrappers::MPI::Vector relevant_solid_acceleration;
+
+    // The fluid cells of this step that find_fluid_bc works on: the owned
+    // artificial cells, and with Dirichlet BCs these together with the cells
+    // in the interface band.
+    std::vector<typename DoFHandler<dim>::active_cell_iterator>
+      artificial_cells;
+    std::vector<typename DoFHandler<dim>::active_cell_iterator>
+      interface_cells;
+
+    // With the Eulerian solid mapping, the displacement that the mapping is
+    // made from, the deformed vertices, and the PETSc vector and its object
+    // state at the time, to tell whether it has changed since.
+    Vector<double> deformed_displacement;
+    std::unique_ptr<MappingQEulerian<dim, Vector<double>>> solid_mapping;
+    std::vector<Point<dim>> deformed_solid_vertices;
+    Vec deformed_from;
+    PetscObjectState deformed_state;
+
+    // The node shared localized solid state, null unless it is enabled.
+    std::unique_ptr<Utils::NodeSharedVectors> shared_solid_state;
+
+    // Per-step timings and counters of the coupling on every process. In the
+    // split mode the solid processes write to a separate file.
+    Utils::CouplingProfiler profiler;
+
+    // The per time step log of the timer sections of the coupling.
+    Utils::Telemetry telemetry;
+
+    // The wall times of the fluid solver and of the coupling work on this
+    // process over the steps since the last load balance check.
+    double fluid_time;
+    double coupling_time;
+    unsigned int n_balance_steps;
+
+    // The weight of a cell near the solid on top of the default weight of
+    // 1000 per cell, 0 until it is measured.
+    unsigned int near_solid_weight;
+    boost::signals2::connection cell_weight_connection;
   };
 } // namespace MPI
 
@@ -4,68 +4,21 @@
 #include <deal.II/base/symmetric_tensor.h>
 #include <deal.II/base/tensor.h>
 #include <deal.II/fe/mapping_q_eulerian.h>
+#include <deal.II/lac/diagonal_matrix.h>
+#include <deal.II/lac/la_parallel_vector.h>
 #include <deal.II/lac/linear_operator.h>
 #include <deal.II/lac/packaged_operation.h>
+#include <deal.II/lac/precondition.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+#include <deal.II/matrix_free/matrix_free.h>
 #include <deal.II/physics/elasticity/kinematics.h>
 #include <deal.II/physics/elasticity/standard_tensors.h>
 
+#include "cell_kernel.h"
+#include "hyper_elastic_kernel.h"
 #include "mpi_solid_solver.h"
 #include "neo_hookean.h"
 
-namespace Internal
-{
-  using namespace dealii;
-
-  /** \brief Data to store at the quadrature points.
-   *
-   * We cache the kinematics information at quadrature points
-   * by storing a PointHistory at each cell,
-   * so that they can be conveniently accessed in the assembly
-   * or post processing. We also store a material pointer
-   * in case different material properties are used at
-   * different locations.
-   */
-  template <int dim>
-  class PointHistory
-  {
-    using ST = Physics::Elasticity::StandardTensors<dim>;
-
-  public:
-    PointHistory()
-      : F_inv(ST::I),
-        tau(SymmetricTensor<2, dim>()),
-        Jc(SymmetricTensor<4, dim>()),
-        dPsi_vol_dJ(0.0),
-        d2Psi_vol_dJ2(0.0)
-    {
-    }
-    virtual ~PointHistory() {}
-    /** Initialize the members with the input parameters */
-    void setup(const Parameters::AllParameters &, const unsigned int &);
-    /**
-     * Update the state with the displacement gradient
-     * in the reference configuration.
-     */
-    void update(const Parameters::AllParameters &, const Tensor<2, dim> &);
-    double get_det_F() const { return material->get_det_F(); }
-    const Tensor<2, dim> &get_F_inv() const { return F_inv; }
-    const SymmetricTensor<2, dim> &get_tau() const { return tau; }
-    const SymmetricTensor<4, dim> &get_Jc() const { return Jc; }
-    double get_density() const { return material->get_density(); }
-    double get_dPsi_vol_dJ() const { return dPsi_vol_dJ; }
-    double get_d2Psi_vol_dJ2() const { return d2Psi_vol_dJ2; }
-
-  private:
-    /** The specific hyperelastic material to use. */
-    std::shared_ptr<Solid::HyperElasticMaterial<dim>> material;
-    Tensor<2, dim> F_inv;
-    SymmetricTensor<2, dim> tau;
-    SymmetricTensor<4, dim> Jc;
-    double dPsi_vol_dJ;
-    double d2Psi_vol_dJ2;
-  };
-} // namespace Internal
-
 namespace Solid
 {
   extern template class HyperElasticMaterial<2>;
@@ -80,9 +33,9 @@ namespace Solid
 
     /** \brief Parallel solver for hyperelastic materials
      *
-     * The solver sets up a PointHistory object at every quadrature point,
-     * where the material properties, deformation, and even stress state
-     * are cached. Therefore the PointHistory has to be updated whenever
+     * The solver sets up a QuadratureHistory, in which the material
+     * properties, deformation, and even stress state at the quadrature
+     * points are cached. Therefore the history has to be updated whenever
      * the deformation changes.
      *
      * Based on dealii tutorial [step-44]
@@ -115,17 +68,124 @@ namespace Solid
       using SolidSolver<dim>::previous_acceleration;
       using SolidSolver<dim>::previous_velocity;
       using SolidSolver<dim>::previous_displacement;
+      using SolidSolver<dim>::fsi_stress_rows;
       using SolidSolver<dim>::mpi_communicator;
       using SolidSolver<dim>::pcout;
       using SolidSolver<dim>::time;
       using SolidSolver<dim>::timer;
+      using SolidSolver<dim>::telemetry;
+      using SolidSolver<dim>::performance;
+      using SolidSolver<dim>::report_memory;
       using SolidSolver<dim>::locally_owned_dofs;
       using SolidSolver<dim>::locally_relevant_dofs;
 
+      /** \brief Matrix-free operator of the tangent of a Newton iteration
+       *
+       * It applies
+       * \f[
+       *   \frac{\rho}{\beta\Delta{t}^2}M + K_{mat} + K_{geo}
+       * \f]
+       * with sum factorization on vectorized batches of cells, i.e. at a
+       * quadrature point the gradient \f$\nabla_x u = \nabla_X u F^{-1}\f$
+       * is mapped to \f$(Jc:\nabla^s_x u + \nabla_x u\,\tau)F^{-T}\f$,
+       * which is tested with \f$\nabla_X v\f$. This is the same form as the
+       * assembled tangent. The \f$F^{-1}\f$, \f$\tau\f$ and \f$Jc\f$ of
+       * the quadrature point history are copied into the cell batch layout
+       * of MatrixFree by update, so the apply only reads them. The
+       * constrained dofs are mapped to themselves, and CG is preconditioned
+       * with a Chebyshev iteration on the diagonal of the operator.
+       */
+      class TangentOperator : public Subscriptor
+      {
+      public:
+        using VectorType = LinearAlgebra::distributed::Vector<double>;
+
+        /// Constructor.
+        TangentOperator(unsigned int degree, unsigned int chebyshev_degree);
+
+        /// Set up the MatrixFree data after the dofs change.
+        void reinit(const DoFHandler<dim> &,
+                    const AffineConstraints<double> &);
+
+        /*! \brief Copy the state of the quadrature point history, and set
+         *  up the diagonal and the Chebyshev preconditioner of the tangent
+         *  with the mass factor \f$\rho/(\beta\Delta{t}^2)\f$.
+         */
+        void update(const Internal::QuadratureHistory<dim> &,
+                    const double mass_factor);
+
+        /// The matrix-vector multiplication used by CG and Chebyshev.
+        void vmult(VectorType &dst, const VectorType &src) const;
+
+        /// The size of the operator, used by the Chebyshev preconditioner.
+        types::global_dof_index m() const;
+        types::global_dof_index n() const { return m(); }
+
+        /// Initialize a vector with the layout of the operator.
+        void initialize_dof_vector(VectorType &) const;
+
+        /*! \brief Solve \f$Kx = b\f$ up to an absolute tolerance with the
+         *  PETSc vectors, which are copied into and out of the matrix-free
+         *  vectors. Returns the iterations and the last residual.
+         */
+        std::pair<unsigned int, double>
+        solve(PETScWrappers::MPI::Vector &x,
+              const PETScWrappers::MPI::Vector &b,
+              const double tolerance) const;
+
+        std::size_t memory_consumption() const;
+
+      private:
+        /// Apply the tangent at the quadrature points of a cell batch.
+        template <int degree>
+        void quadrature_apply(FEEvaluation<dim, degree, degree + 1, dim> &,
+                              const unsigned int) const;
+
+        template <int degree>
+        void local_apply(const MatrixFree<dim> &,
+                         VectorType &,
+                         const VectorType &,
+                         const std::pair<unsigned int, unsigned int> &) const;
+
+        template <int degree>
+        void
+        local_diagonal(const MatrixFree<dim> &,
+                       VectorType &,
+                       const unsigned int &,
+                       const std::pair<unsigned int, unsigned int> &) const;
+
+        const unsigned int degree;
+        const unsigned int chebyshev_degree;
+        double mass_factor;
+
+        MatrixFree<dim> matrix_free;
+        /// The state at the quadrature points of the cell batches, at
+        /// batch * n_q_points + q.
+        AlignedVector<Tensor<2, dim, VectorizedArray<double>>> F_inv;
+        AlignedVector<SymmetricTensor<2, dim, VectorizedArray<double>>> tau;
+        AlignedVector<SymmetricTensor<4, dim, VectorizedArray<double>>> Jc;
+        PreconditionChebyshev<TangentOperator,
+                              VectorType,
+                              DiagonalMatrix<VectorType>>
+          preconditioner;
+        mutable VectorType x_buffer, b_buffer;
+      };
+
       void initialize_system() override;
 
+      /// Add the quadrature point history.
+      void add_memory(Utils::MemoryReport &) const override;
+
       /** Assemble the lhs and rhs at the same time. */
-      void assemble_system(bool);
+      void assemble_system(bool initial_step) override
+      {
+        assemble_system(initial_step, true);
+      }
+
+      /** Assemble the rhs, and the lhs unless the tangent is kept by the
+       *  modified Newton method.
+       */
+      void assemble_system(bool, bool);
 
       /** Set up the quadrature point history. */
       void setup_qph();
@@ -141,14 +201,22 @@ namespace Solid
       /// Run one time step.
       void run_one_step(bool);
 
+      /// Solve a Newton system with the matrix-free tangent, with the
+      /// tolerance of SolidSolver::solve.
+      std::pair<unsigned int, double>
+      solve_tangent(PETScWrappers::MPI::Vector &,
+                    const PETScWrappers::MPI::Vector &,
+                    const double forcing);
+
+      /// The matrix-free tangent if it is used, the tangent matrix is not
+      /// allocated then.
+      std::unique_ptr<TangentOperator> tangent;
+
       /**
-       * We store a PointHistory structure at every quadrature point,
-       * so that kinematics information like F as well as material properties
-       * can be cached.
+       * We store the kinematics information like F as well as the material
+       * properties at every quadrature point, in one array per quantity.
        */
-      CellDataStorage<typename Triangulation<dim>::cell_iterator,
-                      Internal::PointHistory<dim>>
-        quad_point_history;
+      Internal::QuadratureHistory<dim> quad_point_history;
 
       double error_residual; //!< Norm of the residual at a Newton iteration.
       double initial_error_residual; //!< Norm of the residual at the first
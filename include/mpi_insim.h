@@ -2,6 +2,7 @@
 #define MPI_INSIM
 
 #include "mpi_fluid_solver.h"
+#include "preconditioner_pilut.h"
 
 namespace Fluid
 {
@@ -72,9 +73,12 @@ namespace Fluid
       using FluidSolver<dim>::system_matrix;
       using FluidSolver<dim>::mass_matrix;
       using FluidSolver<dim>::mass_schur;
+      using FluidSolver<dim>::pressure_convection;
       using FluidSolver<dim>::present_solution;
       using FluidSolver<dim>::solution_increment;
       using FluidSolver<dim>::system_rhs;
+      using FluidSolver<dim>::workspace;
+      using FluidSolver<dim>::recycle_space;
       using FluidSolver<dim>::fsi_acceleration;
       using FluidSolver<dim>::stress;
       using FluidSolver<dim>::parameters;
@@ -89,8 +93,23 @@ namespace Fluid
       using FluidSolver<dim>::time;
       using FluidSolver<dim>::timer;
       using FluidSolver<dim>::timer2;
+      using FluidSolver<dim>::performance;
+      using FluidSolver<dim>::telemetry;
+      using FluidSolver<dim>::report_memory;
       using FluidSolver<dim>::cell_property;
       using FluidSolver<dim>::hard_coded_boundary_values;
+      using FluidSolver<dim>::assembly_mutex;
+      using FluidSolver<dim>::assemble_cells;
+      using FluidSolver<dim>::start_ghost_update;
+      using FluidSolver<dim>::finish_ghost_updates;
+      using FluidSolver<dim>::adapt_time_step;
+      using FluidSolver<dim>::stabilization_parameter;
+      using FluidSolver<dim>::update_solution_history;
+      using FluidSolver<dim>::extrapolate_solution;
+      using FluidSolver<dim>::n_newton_iterations;
+      using FluidSolver<dim>::n_linear_iterations;
+      using typename FluidSolver<dim>::AssemblyScratchData;
+      using typename FluidSolver<dim>::AssemblyCopyData;
 
       /// Specify the sparsity pattern and reinit matrices and vectors based on
       /// the dofs and constraints.
@@ -114,9 +133,11 @@ namespace Fluid
        *
        *  After solving the linear system, the same AffineConstraints<double> as
        * used in assembly must be used again, to set the solution to the right
-       * value at the constrained dofs.
+       * value at the constrained dofs. The relative tolerance is the forcing
+       * term of the inexact Newton method, or 1e-4 if that is smaller.
        */
-      std::pair<unsigned int, double> solve(const bool use_nonzero_constraints);
+      std::pair<unsigned int, double> solve(const bool use_nonzero_constraints,
+                                            const double forcing = 0);
 
       /*! \brief Run the simulation for one time step.
        *
@@ -142,6 +163,28 @@ namespace Fluid
       /// The BlockSchurPreconditioner for the entire system.
       std::shared_ptr<BlockSchurPreconditioner> preconditioner;
 
+      /**
+       * The factorization of \f$\tilde{A}\f$ used by the
+       * BlockSchurPreconditioner. It outlives the preconditioner so that the
+       * symbolic analysis is only redone when the sparsity pattern changes.
+       */
+      PreconditionMUMPS A_inverse;
+
+      /// The number of GMRES iterations of the last solve, which decides
+      /// whether a stale A_inverse is good enough.
+      unsigned int last_gmres_iterations;
+
+      /// The Eisenstat-Walker forcing terms of the inexact Newton method.
+      Utils::ForcingTerm forcing;
+
+      /**
+       * The PCFIELDSPLIT solver of the "fieldsplit" block solver, which is
+       * set up lazily for the matrices of every initialize_system. The
+       * velocity split is factorized by MUMPS, and the Schur complement
+       * split applies BlockSchurPreconditioner::schur_vmult.
+       */
+      std::unique_ptr<Utils::FieldSplitSolver> fieldsplit;
+
       /** \brief Block preconditioner for the system
        *
        * A right block preconditioner is defined here:
@@ -171,6 +214,22 @@ namespace Fluid
        * \f${[B(diag(M_u))^{-1}B^T]}\f$ is an approximation to the Schur
        * complement of (velocity) mass matrix \f$BM_u^{-1}B^T\f$.
        *
+       * At higher Reynolds numbers the convection cannot be ignored any
+       * more. The pressure convection-diffusion (PCD) approximation
+       * \f[
+       *   \tilde{S}^{-1} = -M_p^{-1}F_pS_m^{-1}, \quad
+       *   F_p = (\nu + \gamma)S_m + \frac{1}{\Delta{t}}M_p + N_p
+       * \f]
+       * with \f$S_m = B(diag(M_u))^{-1}B^T\f$ and the convection
+       * \f$N_p\f$ of the current velocity on the pressure space is the same
+       * as the one above if \f$N_p\f$ vanishes. It still takes a solve of
+       * \f$M_p\f$ and \f$S_m\f$ each, one after the other.
+       *
+       * With the PSPG/SUPG stabilization of equal-order elements, \f$S_m\f$
+       * is built from the plain divergence in the mass matrix and includes
+       * the pressure block \f$-C\f$ of the system as
+       * \f$S_m - \frac{\rho}{\Delta{t}}(-C)\f$.
+       *
        * In summary, in order to form the BlockSchurPreconditioner for our
        * system, we need to compute \f$M_u^{-1}\f$, \f$M_p^{-1}\f$,
        * \f$\tilde{A}^{-1}\f$ and them operate on them. The first two matrices
@@ -190,19 +249,42 @@ namespace Fluid
           const std::vector<IndexSet> &owned_partitioning,
           const PETScWrappers::MPI::BlockSparseMatrix &system,
           const PETScWrappers::MPI::BlockSparseMatrix &mass,
-          PETScWrappers::MPI::BlockSparseMatrix &schur);
+          PETScWrappers::MPI::BlockSparseMatrix &schur,
+          const PETScWrappers::MPI::BlockSparseMatrix &convection,
+          Utils::VectorPool &workspace,
+          const Parameters::AllParameters &parameters,
+          bool mixed_precision,
+          const PreconditionMUMPS &A_inverse);
 
         /// The matrix-vector multiplication must be defined.
         void vmult(PETScWrappers::MPI::BlockVector &dst,
                    const PETScWrappers::MPI::BlockVector &src) const;
 
+        /// The product with \f$\tilde{S}^{-1}\f$ alone, which is also the
+        /// Schur complement split of the PCFIELDSPLIT solver.
+        void schur_vmult(PETScWrappers::MPI::Vector &dst,
+                         const PETScWrappers::MPI::Vector &src) const;
+
       private:
+        /// The inner solves of \f$M_p\f$ and \f$S_m\f$.
+        void solve_mp(PETScWrappers::MPI::Vector &dst,
+                      const PETScWrappers::MPI::Vector &src) const;
+        void solve_sm(PETScWrappers::MPI::Vector &dst,
+                      const PETScWrappers::MPI::Vector &src) const;
+
         TimerOutput &timer2;
         const double gamma;
         const double viscosity;
         const double rho;
         const double dt;
 
+        /// The relative tolerances of the inner solves of \f$M_p\f$ and
+        /// \f$S_m\f$.
+        const double mass_tolerance;
+        const double schur_tolerance;
+        /// The PETSc CG variant of the inner solves.
+        const std::string krylov_method;
+
         /// dealii smart pointer checks if an object is still being referenced
         /// when it is destructed therefore is safer than plain reference.
         const SmartPointer<const PETScWrappers::MPI::BlockSparseMatrix>
@@ -221,15 +303,32 @@ namespace Fluid
          */
         const SmartPointer<PETScWrappers::MPI::BlockSparseMatrix> mass_schur;
 
-        /// A dummy solver control object for MUMPS solver
-        SolverControl dummy_sc;
+        /// Whether \f$\tilde{S}^{-1}\f$ is the PCD approximation, and the
+        /// pressure convection \f$N_p\f$ in its (1, 1) block.
+        const bool pcd;
+        const SmartPointer<const PETScWrappers::MPI::BlockSparseMatrix>
+          pressure_convection;
+
+        /// The pool that the temporary vectors of vmult are taken from.
+        const SmartPointer<Utils::VectorPool> workspace;
+
         /**
          * Similar to the serial code, reuse the factorization.
-         * Although SparseDirectMUMPS does not have the initialize and vmult
-         * pair like UMFPACK, it reuses the factorization as long as it is not
-         * reset and the matrix does not change.
+         * It is owned by InsIM and updated before every solve, so that it
+         * survives the reset of the preconditioner.
          */
-        mutable PETScWrappers::SparseDirectMUMPS A_inverse;
+        const SmartPointer<const PreconditionMUMPS> A_inverse;
+
+        /// Whether \f$M_p\f$ and \f$S_m\f$ are solved in single precision
+        /// with the float copies below.
+        const bool mixed_precision;
+        Utils::SinglePrecisionCG Mp_single;
+        Utils::SinglePrecisionCG Sm_single;
+
+        /// The preconditioners of the double precision solves of \f$M_p\f$
+        /// and \f$S_m\f$, none by default.
+        PreconditionSelector Mp_preconditioner;
+        PreconditionSelector Sm_preconditioner;
       };
     };
   } // namespace MPI
@@ -1,7 +1,13 @@
 #ifndef MPI_INS_IMEX
 #define MPI_INS_IMEX
 
+#include <deal.II/lac/diagonal_matrix.h>
+#include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+#include <deal.II/matrix_free/matrix_free.h>
+
 #include "mpi_fluid_solver.h"
+#include "preconditioner_pilut.h"
 
 namespace Fluid
 {
@@ -43,6 +49,7 @@ namespace Fluid
 
     private:
       class BlockSchurPreconditioner;
+      class VelocityOperator;
 
       using FluidSolver<dim>::setup_dofs;
       using FluidSolver<dim>::make_constraints;
@@ -70,6 +77,8 @@ namespace Fluid
       using FluidSolver<dim>::mass_schur;
       using FluidSolver<dim>::present_solution;
       using FluidSolver<dim>::system_rhs;
+      using FluidSolver<dim>::workspace;
+      using FluidSolver<dim>::recycle_space;
       using FluidSolver<dim>::fsi_acceleration;
       using FluidSolver<dim>::parameters;
       using FluidSolver<dim>::mpi_communicator;
@@ -83,8 +92,19 @@ namespace Fluid
       using FluidSolver<dim>::time;
       using FluidSolver<dim>::timer;
       using FluidSolver<dim>::timer2;
+      using FluidSolver<dim>::performance;
+      using FluidSolver<dim>::telemetry;
+      using FluidSolver<dim>::report_memory;
       using FluidSolver<dim>::cell_property;
       using FluidSolver<dim>::hard_coded_boundary_values;
+      using FluidSolver<dim>::assembly_mutex;
+      using FluidSolver<dim>::assemble_cells;
+      using FluidSolver<dim>::adapt_time_step;
+      using FluidSolver<dim>::stabilization_parameter;
+      using FluidSolver<dim>::n_newton_iterations;
+      using FluidSolver<dim>::n_linear_iterations;
+      using typename FluidSolver<dim>::AssemblyScratchData;
+      using typename FluidSolver<dim>::AssemblyCopyData;
 
       /// Specify the sparsity pattern and reinit matrices and vectors based on
       /// the dofs and constraints.
@@ -95,8 +115,23 @@ namespace Fluid
        * It can be used to assemble the entire system or only the RHS.
        * An additional option is added to determine whether nonzero
        * constraints or zero constraints should be used.
+       *
+       * Since the convection is explicit, the LHS does not depend on the
+       * solution. So even if assemble_system is true, the system and mass
+       * matrices are only reassembled if update_lhs_record says they change.
+       * Returns whether they are reassembled.
+       */
+      bool assemble(bool use_nonzero_constraints, bool assemble_system);
+
+      /*! \brief Record what the LHS depends on: the time step and the
+       *  constrained dofs, and return whether it differs from the record of
+       *  the last LHS assembly on any process.
+       *
+       *  The values of the inhomogeneities do not matter since they only go
+       *  into the RHS. The mesh does not appear in the record because
+       *  initialize_system invalidates it.
        */
-      void assemble(bool use_nonzero_constraints, bool assemble_system);
+      bool update_lhs_record(const AffineConstraints<double> &);
 
       /*! \brief Solve the linear system using FGMRES solver plus block
        *         preconditioner.
@@ -109,6 +144,18 @@ namespace Fluid
       std::pair<unsigned int, double> solve(bool use_nonzero_constraints,
                                             bool assemble_system);
 
+      /*! \brief Distribute the dofs of velocity_dof_handler.
+       *
+       *  They are numbered as the velocity block of dof_handler, so that the
+       *  velocity block vectors and the matrix-free vectors have the same
+       *  locally owned dofs in the same order.
+       */
+      void setup_velocity_dofs();
+
+      /// Set up the matrix-free velocity operator with the current zero
+      /// constraints.
+      void setup_velocity_operator();
+
       /// Run the simulation for one time step.
       void run_one_step(bool apply_nonzero_constraints,
                         bool assemble_system = true) override;
@@ -116,9 +163,104 @@ namespace Fluid
       /// The increment at a certain time step.
       PETScWrappers::MPI::BlockVector solution_increment;
 
+      /// The velocity-only finite element, dofs, and constraints of the
+      /// matrix-free velocity operator.
+      FESystem<dim> velocity_fe;
+      DoFHandler<dim> velocity_dof_handler;
+      AffineConstraints<double> velocity_constraints;
+
+      /// The matrix-free velocity block, only used if it is selected.
+      std::shared_ptr<VelocityOperator> velocity_operator;
+
       /// The BlockSchurPreconditioner for the entire system.
       std::shared_ptr<BlockSchurPreconditioner> preconditioner;
 
+      /**
+       * The PCFIELDSPLIT solver of the "fieldsplit" block solver, which is
+       * set up lazily for the matrices of every initialize_system. The
+       * velocity split is solved with CG and BoomerAMG, and the Schur
+       * complement split applies BlockSchurPreconditioner::schur_vmult.
+       */
+      std::unique_ptr<Utils::FieldSplitSolver> fieldsplit;
+
+      /// The record of the last LHS assembly, see update_lhs_record.
+      bool lhs_valid;
+      double lhs_delta_t;
+      std::vector<types::global_dof_index> lhs_constrained_dofs;
+
+      /** \brief Matrix-free operator of the velocity block
+       *
+       * It applies
+       * \f[
+       *   \tilde{A} = \frac{\rho}{\Delta{t}}M_u + \mu K_u + \gamma\rho D_u
+       * \f]
+       * where \f$K_u\f$ is the vector Laplacian and \f$D_u\f$ is the
+       * Grad-Div term, on the fly with sum factorization on vectorized batches
+       * of cells, instead of going through the rows of the assembled
+       * system_matrix->block(0, 0). The coefficients are constant so nothing
+       * but the geometry is stored. The constrained dofs are mapped to
+       * themselves, and the operator is inverted with CG preconditioned by
+       * its diagonal.
+       */
+      class VelocityOperator : public Subscriptor
+      {
+      public:
+        using VectorType = LinearAlgebra::distributed::Vector<double>;
+
+        /// Constructor.
+        VelocityOperator(double gamma,
+                         double viscosity,
+                         double rho,
+                         double dt,
+                         unsigned int degree);
+
+        /// Set up the MatrixFree data and the inverse diagonal.
+        void reinit(const DoFHandler<dim> &,
+                    const AffineConstraints<double> &);
+
+        /// The matrix-vector multiplication used by CG.
+        void vmult(VectorType &dst, const VectorType &src) const;
+
+        /*! \brief Solve \f$\tilde{A}x = b\f$ up to an absolute tolerance.
+         *
+         * The vectors are the velocity blocks of the PETSc block vectors,
+         * which are copied into and out of the matrix-free vectors. Returns
+         * the number of CG iterations.
+         */
+        unsigned int solve(PETScWrappers::MPI::Vector &x,
+                           const PETScWrappers::MPI::Vector &b,
+                           const double tolerance) const;
+
+      private:
+        /// Apply the operator at the quadrature points of a cell batch.
+        template <int degree>
+        void
+        quadrature_apply(FEEvaluation<dim, degree, degree + 1, dim> &) const;
+
+        template <int degree>
+        void local_apply(const MatrixFree<dim> &,
+                         VectorType &,
+                         const VectorType &,
+                         const std::pair<unsigned int, unsigned int> &) const;
+
+        template <int degree>
+        void
+        local_diagonal(const MatrixFree<dim> &,
+                       VectorType &,
+                       const unsigned int &,
+                       const std::pair<unsigned int, unsigned int> &) const;
+
+        const double gamma;
+        const double viscosity;
+        const double rho;
+        const double dt;
+        const unsigned int degree;
+
+        MatrixFree<dim> matrix_free;
+        DiagonalMatrix<VectorType> inverse_diagonal;
+        mutable VectorType x_buffer, b_buffer;
+      };
+
       /** \brief Block preconditioner for the system
        *
        * A right block preconditioner is defined here:
@@ -165,12 +307,25 @@ namespace Fluid
           const std::vector<IndexSet> &owned_partitioning,
           const PETScWrappers::MPI::BlockSparseMatrix &system,
           const PETScWrappers::MPI::BlockSparseMatrix &mass,
-          PETScWrappers::MPI::BlockSparseMatrix &schur);
+          PETScWrappers::MPI::BlockSparseMatrix &schur,
+          Utils::VectorPool &workspace,
+          const Parameters::AllParameters &parameters,
+          bool mixed_precision,
+          const std::string &backend,
+          const VelocityOperator *velocity = nullptr,
+          const bool solve_velocity = true);
 
         /// The matrix-vector multiplication must be defined.
         void vmult(PETScWrappers::MPI::BlockVector &dst,
                    const PETScWrappers::MPI::BlockVector &src) const;
 
+        /// The product with \f$\tilde{S}^{-1}\f$ alone, which is also the
+        /// Schur complement split of the PCFIELDSPLIT solver. If the
+        /// velocity is not solved, only this one can be used, and the
+        /// velocity preconditioners are not set up.
+        void schur_vmult(PETScWrappers::MPI::Vector &dst,
+                         const PETScWrappers::MPI::Vector &src) const;
+
       private:
         TimerOutput &timer2;
         const double gamma;
@@ -178,6 +333,14 @@ namespace Fluid
         const double rho;
         const double dt;
 
+        /// The relative tolerances of the inner solves of \f$\tilde{A}\f$,
+        /// \f$M_p\f$ and \f$S_m\f$.
+        const double velocity_tolerance;
+        const double mass_tolerance;
+        const double schur_tolerance;
+        /// The PETSc CG variant of the inner solves.
+        const std::string krylov_method;
+
         /// dealii smart pointer checks if an object is still being referenced
         /// when it is destructed therefore is safer than plain reference.
         const SmartPointer<const PETScWrappers::MPI::BlockSparseMatrix>
@@ -196,6 +359,39 @@ namespace Fluid
          * go with this route.
          */
         const SmartPointer<PETScWrappers::MPI::BlockSparseMatrix> mass_schur;
+
+        /// The pool that the temporary vectors of vmult are taken from.
+        const SmartPointer<Utils::VectorPool> workspace;
+
+        /// If not null, \f$\tilde{A}^{-1}\f$ is computed matrix-free.
+        const SmartPointer<const VelocityOperator> velocity_operator;
+
+        /**
+         * Preconditioners of the inner CG solvers. They are built once in
+         * the constructor, i.e., whenever the system is reassembled, and
+         * reused by all the vmult calls in between. They are chosen in the
+         * parameter file; by default \f$\tilde{A}\f$ is preconditioned with
+         * BoomerAMG, \f$M_p\f$ and \f$S_m\f$ with their diagonals. PETSc
+         * Jacobi replaces zero diagonal entries with 1, so the zero diagonals
+         * of \f$S_m\f$ discussed in vmult are harmless here.
+         */
+        PreconditionSelector A_preconditioner;
+        PreconditionSelector Mp_preconditioner;
+        PreconditionSelector Sm_preconditioner;
+
+        /// Whether \f$M_p\f$ and \f$S_m\f$ are solved in single precision
+        /// with the float copies below instead.
+        const bool mixed_precision;
+        Utils::SinglePrecisionCG Mp_single;
+        Utils::SinglePrecisionCG Sm_single;
+
+        /// Whether the inner CG solves run on the device copies below, which
+        /// take precedence over the other two variants. \f$\tilde{A}\f$ is
+        /// only copied if it is not matrix-free.
+        const bool use_device;
+        Utils::DeviceCG Mp_device;
+        Utils::DeviceCG Sm_device;
+        Utils::DeviceCG A_device;
       };
     };
   } // namespace MPI
@@ -0,0 +1,181 @@
+#ifndef MPI_INS_PROJECTION
+#define MPI_INS_PROJECTION
+
+#include "mpi_fluid_solver.h"
+#include "preconditioner_pilut.h"
+
+namespace Fluid
+{
+  namespace MPI
+  {
+    using namespace dealii;
+
+    extern template class FluidSolver<2>;
+    extern template class FluidSolver<3>;
+
+    /** \brief Parallel incompressible Navier Stokes equation solver
+     *         using a rotational incremental pressure-correction scheme.
+     *
+     * Instead of the saddle point system of InsIM and InsIMEX, every time
+     * step consists of three segregated solves on the blocks of the system:
+     *
+     * 1. The velocity increment \f$\delta u\f$ of the intermediate velocity
+     *    \f$u^* = u^n + \delta u\f$ solves
+     *    \f[
+     *      \left(\frac{\rho}{\Delta{t}}M_u + \mu K_u\right)\delta u =
+     *      -\mu K_u u^n - \rho N(u^n)u^n + B^T p^n + f
+     *    \f]
+     *    with the convection treated explicitly, so the matrix is constant
+     *    and symmetric. It is solved with CG and the velocity preconditioner
+     *    (BoomerAMG by default, MueLu with Trilinos). The velocity boundary
+     *    conditions, including the artificial fluid constraints of the FSI,
+     *    apply to \f$\delta u\f$ as in the other solvers.
+     * 2. The pressure increment \f$\phi\f$ solves the Poisson equation
+     *    \f$K_p\phi = -\frac{\rho}{\Delta{t}}Bu^*\f$ with CG and the Schur
+     *    preconditioner (AMG by default). \f$\phi\f$ is zero on the
+     *    pressure boundaries, or at one dof if there are none.
+     * 3. The cheap update
+     *    \f$u^{n+1} = u^* - \frac{\Delta{t}}{\rho}M_u^{-1}G\phi\f$ and
+     *    \f$p^{n+1} = p^n + \phi - \mu M_p^{-1}Bu^*\f$, where \f$G\f$ is
+     *    the weak gradient, with two mass matrix solves preconditioned with
+     *    their diagonals. The velocity on the constrained dofs stays
+     *    \f$u^*\f$.
+     *
+     * The \f$-\mu\nabla\cdot u^*\f$ term of the rotational form keeps the
+     * pressure free of the artificial boundary layer of the standard
+     * incremental scheme. The matrices only depend on the mesh, the time
+     * step and the constrained dofs, and are stored in the (0, 0) and (1, 1)
+     * blocks of system_matrix and mass_matrix.
+     *
+     * The solver runs on the PETSc or the Trilinos backend of
+     * Utils::LinearAlgebraTraits. With Trilinos the AMG of the velocity and
+     * the pressure blocks is MueLu, whose near nullspace are the constant
+     * modes of the velocity components and of the pressure.
+     */
+    template <int dim, typename Backend = Utils::PETScBackend>
+    class InsProjection : public FluidSolver<dim, Backend>
+    {
+    public:
+      //! Constructor.
+      InsProjection(parallel::distributed::Triangulation<dim> &,
+                    const Parameters::AllParameters &);
+      ~InsProjection(){};
+      //! Run the simulation.
+      void run();
+
+      using FluidSolver<dim, Backend>::add_hard_coded_boundary_condition;
+
+    private:
+      using FluidSolver<dim, Backend>::setup_dofs;
+      using FluidSolver<dim, Backend>::make_constraints;
+      using FluidSolver<dim, Backend>::setup_cell_property;
+      using FluidSolver<dim, Backend>::initialize_system;
+      using FluidSolver<dim, Backend>::refine_mesh;
+      using FluidSolver<dim, Backend>::output_results;
+      using FluidSolver<dim, Backend>::update_stress;
+      using FluidSolver<dim, Backend>::save_checkpoint;
+      using FluidSolver<dim, Backend>::load_checkpoint;
+
+      using FluidSolver<dim, Backend>::dofs_per_block;
+      using FluidSolver<dim, Backend>::triangulation;
+      using FluidSolver<dim, Backend>::fe;
+      using FluidSolver<dim, Backend>::dof_handler;
+      using FluidSolver<dim, Backend>::volume_quad_formula;
+      using FluidSolver<dim, Backend>::face_quad_formula;
+      using FluidSolver<dim, Backend>::zero_constraints;
+      using FluidSolver<dim, Backend>::nonzero_constraints;
+      using FluidSolver<dim, Backend>::system_matrix;
+      using FluidSolver<dim, Backend>::mass_matrix;
+      using FluidSolver<dim, Backend>::present_solution;
+      using FluidSolver<dim, Backend>::system_rhs;
+      using FluidSolver<dim, Backend>::workspace;
+      using FluidSolver<dim, Backend>::setup_reused;
+      using FluidSolver<dim, Backend>::fsi_acceleration;
+      using FluidSolver<dim, Backend>::parameters;
+      using FluidSolver<dim, Backend>::mpi_communicator;
+      using FluidSolver<dim, Backend>::pcout;
+      using FluidSolver<dim, Backend>::owned_partitioning;
+      using FluidSolver<dim, Backend>::relevant_partitioning;
+      using FluidSolver<dim, Backend>::locally_relevant_dofs;
+      using FluidSolver<dim, Backend>::time;
+      using FluidSolver<dim, Backend>::timer;
+      using FluidSolver<dim, Backend>::timer2;
+      using FluidSolver<dim, Backend>::performance;
+      using FluidSolver<dim, Backend>::telemetry;
+      using FluidSolver<dim, Backend>::monitor;
+      using FluidSolver<dim, Backend>::report_memory;
+      using FluidSolver<dim, Backend>::cell_property;
+      using FluidSolver<dim, Backend>::assembly_mutex;
+      using FluidSolver<dim, Backend>::assemble_cells;
+      using FluidSolver<dim, Backend>::adapt_time_step;
+      using FluidSolver<dim, Backend>::n_linear_iterations;
+      using typename FluidSolver<dim, Backend>::Traits;
+      using typename FluidSolver<dim, Backend>::VectorType;
+      using typename FluidSolver<dim, Backend>::BlockVectorType;
+      using typename FluidSolver<dim, Backend>::AssemblyScratchData;
+      using typename FluidSolver<dim, Backend>::AssemblyCopyData;
+
+      /// Specify the sparsity pattern and reinit matrices and vectors based on
+      /// the dofs and constraints, and make the pressure constraints.
+      void initialize_system() override;
+
+      /*! \brief Make the constraints of the pressure increment: the hanging
+       *  nodes, and zero on the pressure boundaries, or at the first
+       *  unconstrained pressure dof if there are none, which fixes the
+       *  constant of the pure Neumann problem.
+       */
+      void make_pressure_constraints();
+
+      /*! \brief Assemble the RHS of the velocity step, and if assemble_system
+       *  is true, the velocity and pressure Laplacian in system_matrix and
+       *  the mass matrices in mass_matrix.
+       *
+       *  The velocity constraints are the nonzero or the zero ones, merged
+       *  with pressure_constraints.
+       */
+      void assemble(bool use_nonzero_constraints, bool assemble_system);
+
+      /*! \brief Assemble the RHS of the pressure Poisson equation from the
+       *  intermediate velocity, or that of the velocity update from the
+       *  pressure increment, in the respective block of system_rhs.
+       *
+       *  The fields are read from intermediate_solution.
+       */
+      void assemble_projection_rhs(bool pressure_poisson);
+
+      /// Solve a block of the system with CG, and record the iterations.
+      unsigned int solve_block(const typename Traits::SparseMatrix &,
+                               VectorType &,
+                               const VectorType &,
+                               const typename Traits::PreconditionSelector &,
+                               const std::string &);
+
+      /// Run the simulation for one time step.
+      void run_one_step(bool apply_nonzero_constraints,
+                        bool assemble_system = true) override;
+
+      /// The constraints of the pressure increment.
+      AffineConstraints<double> pressure_constraints;
+
+      /// The increments of the time step, which are non-ghosted because the
+      /// linear solvers need completely distributed vectors.
+      BlockVectorType increment;
+
+      /// The ghosted intermediate velocity, then the pressure increment, as
+      /// the assembly of the projection reads them.
+      BlockVectorType intermediate_solution;
+
+      /// The preconditioners of the velocity, the pressure Poisson, and the
+      /// two mass matrices, which are rebuilt along with the matrices.
+      typename Traits::PreconditionSelector velocity_preconditioner;
+      typename Traits::PreconditionSelector poisson_preconditioner;
+      typename Traits::PreconditionSelector velocity_mass_preconditioner;
+      typename Traits::PreconditionSelector pressure_mass_preconditioner;
+
+      /// The time step of the last LHS assembly.
+      double lhs_delta_t;
+    };
+  } // namespace MPI
+} // namespace Fluid
+
+#endif
@@ -17,7 +17,8 @@ namespace Solid
      * elasticity.
      *
      * Both the triangulation and the dofs are fully distributed, the algebraic
-     * operations are done using PETSc wrappers offered by deal.II.
+     * operations are done using the PETSc or the Trilinos wrappers offered by
+     * deal.II, as chosen by the Backend.
      * The output is also parallelized: every processor writes its own output,
      * ParaView is able to group them together.
      * The mesh refinement is parallelized too.
@@ -33,8 +34,8 @@ namespace Solid
      * Newmark-beta method is used for time-discretization and
      * displacement-based finite element is used for space-discretization.
      */
-    template <int dim>
-    class LinearElasticity : public SolidSolver<dim>
+    template <int dim, typename Backend = Utils::PETScBackend>
+    class LinearElasticity : public SolidSolver<dim, Backend>
     {
     public:
       /*! \brief Constructor.
@@ -49,30 +50,35 @@ namespace Solid
       ~LinearElasticity() {}
 
     private:
-      using SolidSolver<dim>::triangulation;
-      using SolidSolver<dim>::parameters;
-      using SolidSolver<dim>::dof_handler;
-      using SolidSolver<dim>::dg_dof_handler;
-      using SolidSolver<dim>::fe;
-      using SolidSolver<dim>::dg_fe;
-      using SolidSolver<dim>::volume_quad_formula;
-      using SolidSolver<dim>::face_quad_formula;
-      using SolidSolver<dim>::constraints;
-      using SolidSolver<dim>::system_matrix;
-      using SolidSolver<dim>::stiffness_matrix;
-      using SolidSolver<dim>::system_rhs;
-      using SolidSolver<dim>::current_acceleration;
-      using SolidSolver<dim>::current_velocity;
-      using SolidSolver<dim>::current_displacement;
-      using SolidSolver<dim>::previous_acceleration;
-      using SolidSolver<dim>::previous_velocity;
-      using SolidSolver<dim>::previous_displacement;
-      using SolidSolver<dim>::mpi_communicator;
-      using SolidSolver<dim>::pcout;
-      using SolidSolver<dim>::time;
-      using SolidSolver<dim>::timer;
-      using SolidSolver<dim>::locally_owned_dofs;
-      using SolidSolver<dim>::locally_relevant_dofs;
+      using SolidSolver<dim, Backend>::triangulation;
+      using SolidSolver<dim, Backend>::parameters;
+      using SolidSolver<dim, Backend>::dof_handler;
+      using SolidSolver<dim, Backend>::dg_dof_handler;
+      using SolidSolver<dim, Backend>::fe;
+      using SolidSolver<dim, Backend>::dg_fe;
+      using SolidSolver<dim, Backend>::volume_quad_formula;
+      using SolidSolver<dim, Backend>::face_quad_formula;
+      using SolidSolver<dim, Backend>::constraints;
+      using SolidSolver<dim, Backend>::neumann_faces;
+      using SolidSolver<dim, Backend>::system_matrix;
+      using SolidSolver<dim, Backend>::stiffness_matrix;
+      using SolidSolver<dim, Backend>::system_rhs;
+      using SolidSolver<dim, Backend>::current_acceleration;
+      using SolidSolver<dim, Backend>::current_velocity;
+      using SolidSolver<dim, Backend>::current_displacement;
+      using SolidSolver<dim, Backend>::previous_acceleration;
+      using SolidSolver<dim, Backend>::previous_velocity;
+      using SolidSolver<dim, Backend>::previous_displacement;
+      using SolidSolver<dim, Backend>::fsi_stress_rows;
+      using SolidSolver<dim, Backend>::mpi_communicator;
+      using SolidSolver<dim, Backend>::pcout;
+      using SolidSolver<dim, Backend>::time;
+      using SolidSolver<dim, Backend>::timer;
+      using SolidSolver<dim, Backend>::telemetry;
+      using SolidSolver<dim, Backend>::report_memory;
+      using SolidSolver<dim, Backend>::locally_owned_dofs;
+      using SolidSolver<dim, Backend>::locally_relevant_dofs;
+      using typename SolidSolver<dim, Backend>::VectorType;
 
       /**
        * Assembles lhs and rhs. At time step 0, the lhs is the mass matrix;
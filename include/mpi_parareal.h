@@ -0,0 +1,117 @@
+#ifndef MPI_PARAREAL
+#define MPI_PARAREAL
+
+#include <deal.II/base/conditional_ostream.h>
+#include <deal.II/base/mpi.h>
+
+#include <deal.II/lac/petsc_block_vector.h>
+
+#include <experimental/filesystem>
+#include <vector>
+
+#include "mpi_fluid_solver.h"
+#include "parameters.h"
+
+namespace Fluid
+{
+  using namespace dealii;
+
+  namespace MPI
+  {
+    /*! \brief Run a fluid solver in time slices of the Parareal algorithm,
+     *  which are computed concurrently.
+     *
+     *  The processes are split into the Parareal groups of the same size,
+     *  and the time is split into slices of "Slice steps" fine time steps.
+     *  The groups run a window of consecutive slices, group g the slice g of
+     *  the window, with a fine and a coarse solver on get_communicator().
+     *  The coarse solver is the same solver with get_coarse_parameters(),
+     *  whose time step size is "Coarse step factor" times larger, and takes
+     *  over the setup of the fine one on the same triangulation with
+     *  reuse_setup.
+     *
+     *  In an iteration, every group runs the fine solver from the latest
+     *  solution at the start of its slice, concurrently. The corrections
+     *  \f$U_{g+1} = G(U_g^{new}) + F(U_g^{old}) - G(U_g^{old})\f$ are then
+     *  passed on through the coarse solvers, group after group. The groups
+     *  hold the same mesh and the same partition of the dofs, so the
+     *  solution at the start of a slice is passed on as the locally owned
+     *  dofs of every process to the same process of the next group. The
+     *  iterations of a window stop when the solutions at the starts of the
+     *  slices change by less than the tolerance, or after as many iterations
+     *  as there are groups, with which the result is that of the fine
+     *  solver. The next window starts at the end of the last slice.
+     *
+     *  The fine solvers output, monitor and save as they do in run(), the
+     *  last fine run of every slice overwrites the outputs of the earlier
+     *  iterations. Every group runs in its own directory parareal-<index>,
+     *  which is entered by the constructor and left by the destructor, so
+     *  the solvers are built after and destroyed before the driver.
+     */
+    template <int dim>
+    class Parareal
+    {
+    public:
+      Parareal(const MPI_Comm &, const Parameters::AllParameters &);
+      ~Parareal();
+
+      /// The communicator of the group of this process.
+      const MPI_Comm &get_communicator() const { return group_communicator; }
+
+      /// The group of this process, which runs the slices g, g + n_groups,
+      /// and so on.
+      unsigned int get_group() const { return group; }
+
+      /// The parameters of the fine solver.
+      const Parameters::AllParameters &get_fine_parameters() const
+      {
+        return fine_parameters;
+      }
+
+      /// The parameters of the coarse solver, which do not output, monitor,
+      /// save or log.
+      const Parameters::AllParameters &get_coarse_parameters() const
+      {
+        return coarse_parameters;
+      }
+
+      /*! \brief Run up to the end time with the fine and the coarse solver of
+       *  this group, which are not set up yet, and are only run through
+       *  run_time_slice. This is collective.
+       */
+      void run(FluidSolver<dim> &fine, FluidSolver<dim> &coarse);
+
+    private:
+      /// The state of the time stepping at the start of a slice.
+      Utils::Time::State slice_start(const unsigned int slice,
+                                     const double delta_t,
+                                     const unsigned int n_steps) const;
+
+      /// Send the locally owned dofs of a solution to this process of
+      /// another group, and receive them.
+      void send(const PETScWrappers::MPI::BlockVector &,
+                const unsigned int) const;
+      void receive(PETScWrappers::MPI::BlockVector &,
+                   const unsigned int) const;
+
+      Parameters::AllParameters fine_parameters;
+      Parameters::AllParameters coarse_parameters;
+      unsigned int n_groups;
+      unsigned int group;
+      /// The fine time steps of a slice and the coarse ones.
+      unsigned int n_fine_steps;
+      unsigned int n_coarse_steps;
+      unsigned int n_slices;
+      /// The processes of a group.
+      MPI_Comm group_communicator;
+      /// The processes of the same rank in every group, which are ranked
+      /// by their groups.
+      MPI_Comm slice_communicator;
+      MPI_Comm world_communicator;
+      std::experimental::filesystem::path base_path;
+      ConditionalOStream pcout;
+    };
+  } // namespace MPI
+} // namespace Fluid
+
+#endif
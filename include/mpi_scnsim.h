@@ -30,6 +30,11 @@ namespace Fluid
      * SUPG incomplete Schur complement right preconditioner is applied, which
      * does modify the linear system a little bit, and requires the velocity
      * shape functions to be one order higher than that of the pressure.
+     *
+     * Alternatively, a fluid simulation can be advanced with the explicit
+     * low-storage Runge-Kutta method of Carpenter and Kennedy and a lumped
+     * mass matrix, which needs no linear solve at all and is suitable for
+     * acoustic problems whose time step is limited by the sound speed anyway.
      */
     template <int dim>
     class SCnsIM : public FluidSolver<dim>
@@ -77,6 +82,8 @@ namespace Fluid
       using FluidSolver<dim>::present_solution;
       using FluidSolver<dim>::solution_increment;
       using FluidSolver<dim>::system_rhs;
+      using FluidSolver<dim>::workspace;
+      using FluidSolver<dim>::recycle_space;
       using FluidSolver<dim>::fsi_acceleration;
       using FluidSolver<dim>::stress;
       using FluidSolver<dim>::parameters;
@@ -91,13 +98,32 @@ namespace Fluid
       using FluidSolver<dim>::time;
       using FluidSolver<dim>::timer;
       using FluidSolver<dim>::timer2;
+      using FluidSolver<dim>::performance;
+      using FluidSolver<dim>::telemetry;
+      using FluidSolver<dim>::report_memory;
+      using FluidSolver<dim>::memory_report;
       using FluidSolver<dim>::cell_property;
       using FluidSolver<dim>::hard_coded_boundary_values;
+      using FluidSolver<dim>::assembly_mutex;
+      using FluidSolver<dim>::assemble_cells;
+      using FluidSolver<dim>::start_ghost_update;
+      using FluidSolver<dim>::finish_ghost_updates;
+      using FluidSolver<dim>::adapt_time_step;
+      using FluidSolver<dim>::update_solution_history;
+      using FluidSolver<dim>::extrapolate_solution;
+      using FluidSolver<dim>::n_newton_iterations;
+      using FluidSolver<dim>::n_linear_iterations;
+      using typename FluidSolver<dim>::AssemblyScratchData;
+      using typename FluidSolver<dim>::AssemblyCopyData;
 
       /// Specify the sparsity pattern and reinit matrices and vectors based on
       /// the dofs and constraints.
       virtual void initialize_system() override;
 
+      /// Add the matrices and vectors of the Schur preconditioner and the
+      /// Newton iteration.
+      void add_memory(Utils::MemoryReport &) const override;
+
       /*! \brief Assemble the system matrix, mass mass matrix, and the RHS.
        *
        *  Since backward Euler method is used, the linear system must be
@@ -111,14 +137,25 @@ namespace Fluid
        */
       void assemble(const bool use_nonzero_constraints);
 
+      /*! \brief Evaluate sigma_pml_field at the quadrature points of the
+       *  locally owned cells, and flag the cells where it is nonzero.
+       *
+       *  The field does not change in time, so this is only done when the
+       *  mesh changes, and the assembly skips the PML terms outside of the
+       *  absorbing layer.
+       */
+      void setup_pml_cache();
+
       /*! \brief Solve the linear system using FGMRES solver plus block
        * preconditioner.
        *
        *  After solving the linear system, the same AffineConstraints<double> as
        * used in assembly must be used again, to set the solution to the right
-       * value at the constrained dofs.
+       * value at the constrained dofs. The relative tolerance is the forcing
+       * term of the inexact Newton method, or 1e-6 if that is smaller.
        */
-      std::pair<unsigned int, double> solve(const bool use_nonzero_constraints);
+      std::pair<unsigned int, double> solve(const bool use_nonzero_constraints,
+                                            const double forcing = 0);
 
       /*! \brief Run the simulation for one time step.
        *
@@ -132,6 +169,30 @@ namespace Fluid
       void run_one_step(bool apply_nonzero_constraints,
                         bool assemble_system = true) override;
 
+      /*! \brief Advance evaluation_point over one time step with backward
+       *  Euler and Newton's method.
+       */
+      void implicit_step(const bool apply_nonzero_constraints);
+
+      /*! \brief Advance evaluation_point over one time step with the
+       *  five-stage fourth order 2N-storage Runge-Kutta method of Carpenter
+       *  and Kennedy.
+       *
+       *  The Dirichlet values are applied once at the beginning of the step
+       *  and are kept by all stages, whose increments vanish at the
+       *  constrained dofs.
+       */
+      void explicit_step(const bool apply_nonzero_constraints);
+
+      /*! \brief Assemble the Galerkin residual of the semi-discrete equations
+       *  at evaluation_point into system_rhs, and the row-sum lumped mass
+       *  matrix into lumped_mass.
+       *
+       *  There is no SUPG stabilization, and the pressure dependent density
+       *  is evaluated at evaluation_point.
+       */
+      void assemble_explicit_residual();
+
       /*! \brief Apply the initial condition
        *
        * This is a hard-coded function that is only used for VF cases where an
@@ -152,9 +213,36 @@ namespace Fluid
        */
       PETScWrappers::MPI::BlockVector evaluation_point;
 
-      /// The BlockIncompSchurPreconditioner for the entire system.
+      /// The lumped mass matrix of the explicit time integration.
+      PETScWrappers::MPI::BlockVector lumped_mass;
+
+      /// The two registers of the low-storage Runge-Kutta method: the stage
+      /// increment and the solution being advanced.
+      PETScWrappers::MPI::BlockVector rk_update;
+      PETScWrappers::MPI::BlockVector rk_solution;
+
+      /**
+       * The BlockIncompSchurPreconditioner for the entire system. It is built
+       * lazily and reused across Newton iterations and time steps, until the
+       * last solve exceeds the rebuild limits in the parameters.
+       */
       std::shared_ptr<BlockIncompSchurPreconditioner> preconditioner;
 
+      /// The number of GMRES iterations of the last solve.
+      unsigned int last_gmres_iterations;
+
+      /// The Eisenstat-Walker forcing terms of the inexact Newton method.
+      Utils::ForcingTerm forcing;
+
+      /**
+       * The PCFIELDSPLIT solver of the "fieldsplit" block solver, which is
+       * set up lazily for the matrices of every initialize_system. Its
+       * Schur complement split is preconditioned with B2pp, so the
+       * BlockIncompSchurPreconditioner is still built, only without its
+       * inverses, and the PETSc preconditioner is rebuilt along with it.
+       */
+      std::unique_ptr<Utils::FieldSplitSolver> fieldsplit;
+
       /** \brief sigma_pml_field
        * the sigma_pml_field is predefined outside the class. It specifies
        * the sigma PML field to determine where and how sigma pml is
@@ -163,6 +251,13 @@ namespace Fluid
        */
       std::shared_ptr<Function<dim>> sigma_pml_field;
 
+      /// sigma_pml_field at the quadrature points of every locally owned
+      /// cell, n_q_points per active cell index.
+      std::vector<double> pml_sigma_values;
+
+      /// Whether sigma_pml_field is nonzero anywhere in an active cell.
+      std::vector<bool> pml_cells;
+
       /// Hard-coded body force. It will be added onto gravity.
       std::shared_ptr<TensorFunction<1, dim>> body_force;
 
@@ -186,14 +281,18 @@ namespace Fluid
       class BlockIncompSchurPreconditioner : public Subscriptor
       {
       public:
-        /// Constructor.
+        /// Constructor. Without build_inverses, only B2pp is computed and
+        /// vmult cannot be used.
         BlockIncompSchurPreconditioner(
           TimerOutput &timer2,
           const std::vector<IndexSet> &owned_partitioning,
           const PETScWrappers::MPI::BlockSparseMatrix &system,
           PETScWrappers::MPI::SparseMatrix &absA,
           PETScWrappers::MPI::SparseMatrix &schur,
-          PETScWrappers::MPI::SparseMatrix &B2pp);
+          PETScWrappers::MPI::SparseMatrix &B2pp,
+          Utils::VectorPool &workspace,
+          const Parameters::AllParameters &parameters,
+          const bool build_inverses = true);
 
         /// The matrix-vector multiplication must be defined.
         void vmult(PETScWrappers::MPI::BlockVector &dst,
@@ -233,8 +332,15 @@ namespace Fluid
         const SmartPointer<PETScWrappers::MPI::SparseMatrix> schur_matrix;
         const SmartPointer<PETScWrappers::MPI::SparseMatrix> B2pp_matrix;
 
-        PreconditionEuclid Pvv_inverse;
-        PreconditionEuclid B2pp_inverse;
+        /// The pool that the temporary vectors of vmult are taken from.
+        const SmartPointer<Utils::VectorPool> workspace;
+
+        /// The preconditioners of Avv and B2pp, Euclid by default.
+        PreconditionSelector Pvv_inverse;
+        PreconditionSelector B2pp_inverse;
+
+        /// The relative tolerance of the GMRES solve of Tpp.
+        const double schur_tolerance;
 
         std::shared_ptr<SchurComplementTpp> Tpp;
         // iteration counter for solving Tpp
@@ -244,9 +350,9 @@ namespace Fluid
         public:
           SchurComplementTpp(
             TimerOutput &timer2,
-            const std::vector<IndexSet> &owned_partitioning,
             const PETScWrappers::MPI::BlockSparseMatrix &system,
-            const PETScWrappers::PreconditionerBase &Pvvinv);
+            const PETScWrappers::PreconditionerBase &Pvvinv,
+            Utils::VectorPool &workspace);
           void vmult(PETScWrappers::MPI::Vector &dst,
                      const PETScWrappers::MPI::Vector &src) const;
 
@@ -255,7 +361,7 @@ namespace Fluid
           const SmartPointer<const PETScWrappers::MPI::BlockSparseMatrix>
             system_matrix;
           const PETScWrappers::PreconditionerBase *Pvv_inverse;
-          PETScWrappers::MPI::BlockVector dumb_vector;
+          const SmartPointer<Utils::VectorPool> workspace;
         };
       };
     };
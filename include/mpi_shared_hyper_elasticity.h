@@ -4,67 +4,16 @@
 #include <deal.II/base/symmetric_tensor.h>
 #include <deal.II/base/tensor.h>
 #include <deal.II/fe/mapping_q_eulerian.h>
+#include <deal.II/grid/grid_tools.h>
 #include <deal.II/lac/linear_operator.h>
 #include <deal.II/lac/packaged_operation.h>
 #include <deal.II/physics/elasticity/kinematics.h>
 #include <deal.II/physics/elasticity/standard_tensors.h>
 
+#include "hyper_elastic_kernel.h"
 #include "mpi_shared_solid_solver.h"
 #include "neo_hookean.h"
-
-namespace Internal
-{
-  using namespace dealii;
-
-  /** \brief Data to store at the quadrature points.
-   *
-   * We cache the kinematics information at quadrature points
-   * by storing a PointHistory at each cell,
-   * so that they can be conveniently accessed in the assembly
-   * or post processing. We also store a material pointer
-   * in case different material properties are used at
-   * different locations.
-   */
-  template <int dim>
-  class PointHistory
-  {
-    using ST = Physics::Elasticity::StandardTensors<dim>;
-
-  public:
-    PointHistory()
-      : F_inv(ST::I),
-        tau(SymmetricTensor<2, dim>()),
-        Jc(SymmetricTensor<4, dim>()),
-        dPsi_vol_dJ(0.0),
-        d2Psi_vol_dJ2(0.0)
-    {
-    }
-    virtual ~PointHistory() {}
-    /** Initialize the members with the input parameters */
-    void setup(const Parameters::AllParameters &, const unsigned int &);
-    /**
-     * Update the state with the displacement gradient
-     * in the reference configuration.
-     */
-    void update(const Parameters::AllParameters &, const Tensor<2, dim> &);
-    double get_det_F() const { return material->get_det_F(); }
-    const Tensor<2, dim> &get_F_inv() const { return F_inv; }
-    const SymmetricTensor<2, dim> &get_tau() const { return tau; }
-    const SymmetricTensor<4, dim> &get_Jc() const { return Jc; }
-    double get_density() const { return material->get_density(); }
-    double get_dPsi_vol_dJ() const { return dPsi_vol_dJ; }
-    double get_d2Psi_vol_dJ2() const { return d2Psi_vol_dJ2; }
-
-  private:
-    /** The specific hyperelastic material to use. */
-    std::shared_ptr<Solid::HyperElasticMaterial<dim>> material;
-    Tensor<2, dim> F_inv;
-    SymmetricTensor<2, dim> tau;
-    SymmetricTensor<4, dim> Jc;
-    double dPsi_vol_dJ;
-    double d2Psi_vol_dJ2;
-  };
-} // namespace Internal
+#include "nodal_projection.h"
 
 namespace Solid
 {
@@ -80,9 +29,9 @@ namespace Solid
 
     /** \brief Parallel solver for hyperelastic materials
      *
-     * The solver sets up a PointHistory object at every quadrature point,
-     * where the material properties, deformation, and even stress state
-     * are cached. Therefore the PointHistory has to be updated whenever
+     * The solver sets up a QuadratureHistory, in which the material
+     * properties, deformation, and even stress state at the quadrature
+     * points are cached. Therefore the history has to be updated whenever
      * the deformation changes.
      *
      * Based on dealii tutorial [step-44]
@@ -93,7 +42,8 @@ namespace Solid
     {
     public:
       SharedHyperElasticity(Triangulation<dim> &,
-                            const Parameters::AllParameters &);
+                            const Parameters::AllParameters &,
+                            const MPI_Comm &mpi_comm = MPI_COMM_WORLD);
       ~SharedHyperElasticity() {}
 
     private:
@@ -124,6 +74,8 @@ namespace Solid
       using SharedSolidSolver<dim>::pcout;
       using SharedSolidSolver<dim>::time;
       using SharedSolidSolver<dim>::timer;
+      using SharedSolidSolver<dim>::telemetry;
+      using SharedSolidSolver<dim>::report_memory;
       using SharedSolidSolver<dim>::locally_owned_dofs;
       using SharedSolidSolver<dim>::locally_owned_scalar_dofs;
       using SharedSolidSolver<dim>::locally_relevant_dofs;
@@ -131,10 +83,24 @@ namespace Solid
 
       void initialize_system() override;
 
+      /// Add the quadrature point history.
+      void add_memory(Utils::MemoryReport &) const override;
+
       virtual void update_strain_and_stress() override;
 
       /** Assemble the lhs and rhs at the same time. */
-      void assemble_system(bool);
+      void assemble_system(bool initial_step) override
+      {
+        assemble_system(initial_step, true);
+      }
+
+      /** Assemble the rhs, and the lhs unless the tangent is kept by the
+       *  modified Newton method.
+       */
+      void assemble_system(bool, bool);
+
+      /// Assemble the rhs at the current displacement.
+      virtual void assemble_explicit_force() override;
 
       /** Set up the quadrature point history. */
       void setup_qph();
@@ -151,13 +117,10 @@ namespace Solid
       void run_one_step(bool);
 
       /**
-       * We store a PointHistory structure at every quadrature point,
-       * so that kinematics information like F as well as material properties
-       * can be cached.
+       * We store the kinematics information like F as well as the material
+       * properties at every quadrature point, in one array per quantity.
        */
-      CellDataStorage<typename Triangulation<dim>::cell_iterator,
-                      Internal::PointHistory<dim>>
-        quad_point_history;
+      Internal::QuadratureHistory<dim> quad_point_history;
 
       double error_residual; //!< Norm of the residual at a Newton iteration.
       double initial_error_residual; //!< Norm of the residual at the first
@@ -1,11 +1,14 @@
 #ifndef SHARED_HYPOELASTIC_SOLVER
 #define SHARED_HYPOELASTIC_SOLVER
 
+#include <map>
 #include <memory>
 
+#include <deal.II/base/mpi.h>
 #include <deal.II/base/symmetric_tensor.h>
 #include <deal.II/base/tensor.h>
 #include <deal.II/fe/mapping_q_eulerian.h>
+#include <deal.II/grid/grid_tools.h>
 #include <deal.II/lac/linear_operator.h>
 #include <deal.II/lac/packaged_operation.h>
 #include <deal.II/physics/elasticity/kinematics.h>
@@ -25,6 +28,16 @@ namespace Solid
     extern template class SharedSolidSolver<2>;
     extern template class SharedSolidSolver<3>;
 
+    /*! \brief The RKPM particle solver on a shared triangulation.
+     *
+     * Every process builds the body of the particles and the quadrature
+     * points of the cells of its subdomain, plus a halo of cells around it
+     * that is wide enough for the owned particles to be stepped as if the
+     * whole body was on this process. After every step, the ghost particles
+     * and volume quadrature points in the halo are updated from the
+     * processes that own them, and every process only sets the owned
+     * vertex dofs of the displacement, velocity and acceleration.
+     */
     template <int dim>
     class SharedHypoElasticity : public SharedSolidSolver<dim>
     {
@@ -32,7 +45,8 @@ namespace Solid
       SharedHypoElasticity(Triangulation<dim> &,
                            const Parameters::AllParameters &,
                            double dx,
-                           double hdx);
+                           double hdx,
+                           const MPI_Comm &mpi_comm = MPI_COMM_WORLD);
       ~SharedHypoElasticity() {}
 
     private:
@@ -63,13 +77,13 @@ namespace Solid
       using SharedSolidSolver<dim>::pcout;
       using SharedSolidSolver<dim>::time;
       using SharedSolidSolver<dim>::timer;
+      using SharedSolidSolver<dim>::telemetry;
+      using SharedSolidSolver<dim>::report_memory;
       using SharedSolidSolver<dim>::locally_owned_dofs;
       using SharedSolidSolver<dim>::locally_owned_scalar_dofs;
       using SharedSolidSolver<dim>::locally_relevant_dofs;
       using SharedSolidSolver<dim>::times_and_names;
 
-      void initialize_system() override;
-
       virtual void update_strain_and_stress() override;
 
       /** Assemble the lhs and rhs at the same time. */
@@ -82,23 +96,45 @@ namespace Solid
 
       virtual bool load_checkpoint() override;
 
+      /// The particles cannot go back, so this throws.
+      virtual void save_step_state() override;
+
       std::unique_ptr<body<dim>> m_body;
 
+      /// The local particle of every vertex, -1 if the vertex is not in the
+      /// body of this process.
       std::vector<int> vertex_mapping;
 
+      /// The owned cells then the halo cells, in the order of their volume
+      /// and face quadrature points in the body.
+      std::vector<typename DoFHandler<dim>::active_cell_iterator> local_cells;
+
+      /// Whether every local particle is owned by this process.
+      std::vector<bool> owned_particles;
+
+      /// The local particles and volume quadrature points whose states are
+      /// sent to, or received from, every other process after a step.
+      std::map<unsigned int, std::vector<unsigned int>> particles_to_send;
+      std::map<unsigned int, std::vector<unsigned int>> particles_to_receive;
+      std::map<unsigned int, std::vector<unsigned int>> quad_points_to_send;
+      std::map<unsigned int, std::vector<unsigned int>> quad_points_to_receive;
+
+      /// Build the body of the local cells and the ghost lists.
       void construct_particles();
 
+      /// Copy the ghost states from the processes that own them.
+      void update_ghosts();
+
+      /// Set the owned vertex dofs from the particles, and the tractions of
+      /// the local face quadrature points from the FSI stress.
       void synchronize();
 
+      /// Write the owned particles of this process.
+      void write_particles() const;
+
       double dx;
 
       double hdx;
-
-      Vector<double> serialized_displacement;
-
-      Vector<double> serialized_velocity;
-
-      Vector<double> serialized_acceleration;
     };
   } // namespace MPI
 } // namespace Solid
@@ -1,8 +1,11 @@
 #ifndef MPI_SHARED_LINEAR_ELASTICITY
 #define MPI_SHARED_LINEAR_ELASTICITY
 
+#include <algorithm>
+
 #include "linear_elastic_material.h"
 #include "mpi_shared_solid_solver.h"
+#include "nodal_projection.h"
 
 namespace Solid
 {
@@ -44,7 +47,8 @@ namespace Solid
        * Also we use a parameter handler to specify all the input parameters.
        */
       SharedLinearElasticity(Triangulation<dim> &,
-                             const Parameters::AllParameters &);
+                             const Parameters::AllParameters &,
+                             const MPI_Comm &mpi_comm = MPI_COMM_WORLD);
       /*! \brief Destructor. */
       ~SharedLinearElasticity() {}
 
@@ -77,6 +81,8 @@ namespace Solid
       using SharedSolidSolver<dim>::pcout;
       using SharedSolidSolver<dim>::time;
       using SharedSolidSolver<dim>::timer;
+      using SharedSolidSolver<dim>::telemetry;
+      using SharedSolidSolver<dim>::report_memory;
       using SharedSolidSolver<dim>::locally_owned_dofs;
       using SharedSolidSolver<dim>::locally_owned_scalar_dofs;
       using SharedSolidSolver<dim>::locally_relevant_dofs;
@@ -85,8 +91,31 @@ namespace Solid
       /**
        * Assembles lhs and rhs. At time step 0, the lhs is the mass matrix;
        * at all the following steps, it is \f$ M + \beta{\Delta{t}}^2K \f$.
+       * Without the matrices, the rhs is the external minus the internal
+       * force of the explicit integrator.
+       */
+      void assemble(bool is_initial, bool assemble_matrix);
+
+      /**
+       * Assembles both the LHS and RHS of the system.
+       */
+      void assemble_system(bool is_initial) { assemble(is_initial, true); }
+
+      /**
+       * Assembles the external minus the internal force.
+       */
+      virtual void assemble_explicit_force() override
+      {
+        assemble(false, false);
+      }
+
+      /**
+       * Matrix-free product with the stiffness and the damping matrices,
+       * \f$ dst = Ku + Cv \f$, in place of the stored matrices.
        */
-      void assemble_system(bool is_initial);
+      void apply_stiffness_and_damping(const PETScWrappers::MPI::Vector &u,
+                                       const PETScWrappers::MPI::Vector &v,
+                                       PETScWrappers::MPI::Vector &dst);
 
       /**
        * Update the strain and stress, used in output_results and FSI.
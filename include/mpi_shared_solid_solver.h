@@ -59,7 +59,11 @@
 #include <fstream>
 #include <iostream>
 
+#include "instrumentation.h"
+#include "output_writers.h"
 #include "parameters.h"
+#include "preconditioner_pilut.h"
+#include "solver_wrappers.h"
 #include "utilities.h"
 
 namespace fs = std::experimental::filesystem;
@@ -85,7 +89,8 @@ namespace Solid
       friend ::MPI::FSI<spacedim>;
 
       SharedSolidSolver(Triangulation<dim, spacedim> &,
-                        const Parameters::AllParameters &);
+                        const Parameters::AllParameters &,
+                        const MPI_Comm &mpi_comm = MPI_COMM_WORLD);
       ~SharedSolidSolver();
       void run();
       PETScWrappers::MPI::Vector get_current_solution() const;
@@ -121,12 +126,46 @@ namespace Solid
 
       /**
        * Solve the linear system. Returns the number of
-       * CG iterations and the final residual.
+       * CG iterations and the final residual. The relative tolerance is the
+       * forcing term of the inexact Newton method if it is larger than the
+       * one of the parameters.
        */
       std::pair<unsigned int, double>
       solve(const PETScWrappers::MPI::SparseMatrix &,
             PETScWrappers::MPI::Vector &,
-            const PETScWrappers::MPI::Vector &);
+            const PETScWrappers::MPI::Vector &,
+            const double forcing = 0);
+
+      /**
+       * Solve \f$Ax = b\f$ with the factorization of system_matrix, and
+       * return 0 iterations and the residual. The matrix is only factorized
+       * again when the mesh or the time step size has changed, so this is for
+       * the solvers whose system matrix is constant otherwise.
+       */
+      std::pair<unsigned int, double>
+      solve_factorized(PETScWrappers::MPI::Vector &,
+                       const PETScWrappers::MPI::Vector &);
+
+      /**
+       * Assemble inverse_lumped_mass from the row sums of the consistent
+       * mass matrix.
+       */
+      void assemble_lumped_mass();
+
+      /**
+       * Assemble the external minus the internal force at
+       * current_displacement and current_velocity into system_rhs. This is
+       * all the explicit integrator needs from a material, the default
+       * throws.
+       */
+      virtual void assemble_explicit_force();
+
+      /**
+       * Run one time step of the central difference method in its velocity
+       * Verlet form, which only takes a force evaluation and no linear solve.
+       * The time step size must not exceed get_stable_time_step.
+       */
+      void run_one_explicit_step(bool first_step);
 
       /**
        * Output the time-dependent solution in vtu format.
@@ -149,6 +188,38 @@ namespace Solid
        */
       virtual bool load_checkpoint();
 
+      /// Advance the time of a restart to the step of the checkpoint, and
+      /// restore the records of the outputs before it.
+      void restore_time(const int);
+
+      /*! \brief Save the displacement, velocity, acceleration and the time
+       *  before a time step, or go back to them to repeat it, e.g. in the
+       *  iterations of an implicit coupling.
+       *
+       *  The outputs written since are forgotten, and will be written again.
+       *  The solvers with more state across time steps save theirs.
+       */
+      virtual void save_step_state();
+      virtual void restore_step_state();
+
+      /*! \brief The largest time step size at the solid Courant number in the
+       *  current configuration, or infinity if it is not limited. The
+       *  explicit integrator is always limited, at Courant number 1 unless
+       *  it is set.
+       */
+      double get_stable_time_step() const;
+
+      /*! \brief Add the memory of the mesh, the sparsity patterns, the
+       *  matrices, the vectors and the cell data to a report.
+       *
+       *  The solvers with more data add theirs.
+       */
+      virtual void add_memory(Utils::MemoryReport &) const;
+
+      /// Print the memory report if the system was set up since the last
+      /// one, which is collective.
+      void report_memory();
+
       Triangulation<dim, spacedim> &triangulation;
       Parameters::AllParameters parameters;
       DoFHandler<dim, spacedim> dof_handler;
@@ -167,6 +238,16 @@ namespace Solid
        */
       AffineConstraints<double> constraints;
 
+      /// The boundary faces of the Neumann conditions, or of the FSI
+      /// traction, which are listed again along with the dofs.
+      Utils::BoundaryFaceList neumann_faces;
+
+      /// Which of the matrices below initialize_system allocates, set by the
+      /// constructors of the solvers. The others are left empty.
+      bool use_system_matrix;
+      bool use_mass_matrix;
+      bool use_stiffness_matrix;
+      bool use_damping_matrix;
       PETScWrappers::MPI::SparseMatrix
         system_matrix; //!< \f$ M + \beta{\Delta{t}}^2K \f$.
       PETScWrappers::MPI::SparseMatrix
@@ -176,6 +257,9 @@ namespace Solid
       PETScWrappers::MPI::SparseMatrix
         damping_matrix; //!< The damping matrix for visco-linearelastic solver.
       PETScWrappers::MPI::Vector system_rhs;
+      /// The inverse of the lumped mass matrix of the explicit integrator,
+      /// 0 at the constrained dofs, and empty until it is assembled.
+      PETScWrappers::MPI::Vector inverse_lumped_mass;
 
       /**
        * In the Newmark-beta method, acceleration is the variable to solve at
@@ -192,6 +276,20 @@ namespace Solid
       PETScWrappers::MPI::Vector previous_displacement;
       std::vector<Vector<double>> fsi_stress_rows;
 
+      /// What save_step_state saves.
+      struct StepState
+      {
+        Utils::Time::State time;
+        PETScWrappers::MPI::Vector current_acceleration;
+        PETScWrappers::MPI::Vector current_velocity;
+        PETScWrappers::MPI::Vector current_displacement;
+        PETScWrappers::MPI::Vector previous_acceleration;
+        PETScWrappers::MPI::Vector previous_velocity;
+        PETScWrappers::MPI::Vector previous_displacement;
+        std::size_t n_outputs;
+      };
+      StepState step_state;
+
       /**
        * Nodal strain and stress obtained by taking the average of surrounding
        * cell-averaged strains and stresses. Their sizes are
@@ -207,10 +305,32 @@ namespace Solid
       ConditionalOStream pcout;
       Utils::Time time;
       mutable TimerOutput timer;
+      /// The timer sections and the Krylov iterations for the performance
+      /// tests, written when the solver is destroyed.
+      Utils::PerformanceSummary performance;
+      /// The per time step log of the timer sections and the iterations.
+      Utils::Telemetry telemetry;
+      /// The memory of the subsystems, printed if "Memory report" is set.
+      Utils::MemoryReport memory_report;
       IndexSet locally_owned_dofs;
       IndexSet locally_owned_scalar_dofs;
       IndexSet locally_relevant_dofs;
       mutable std::vector<std::pair<double, std::string>> times_and_names;
+      /// The writer of the vtu, pvd and checkpoint files.
+      mutable Utils::AsyncWriter writer;
+
+      /// The AMG of solve, and the near nullspace it is built with.
+      PreconditionElasticAMG amg;
+      std::vector<PETScWrappers::MPI::Vector> rigid_modes;
+      /// The CG iterations of the first solve with the current hierarchy, and
+      /// of the last solve.
+      unsigned int amg_setup_iterations;
+      unsigned int amg_last_iterations;
+
+      /// The MUMPS factorization of solve_factorized, and the time step size
+      /// it was computed with, 0 if there is none.
+      PreconditionMUMPS system_factor;
+      double factorized_delta_t;
 
       /**
        * The fluid traction in FSI simulation, which should be set by the FSI.
@@ -58,25 +58,48 @@
 #include <fstream>
 #include <iostream>
 
+#include "instrumentation.h"
+#include "linear_algebra.h"
+#include "output_writers.h"
 #include "parameters.h"
+#include "preconditioner_pilut.h"
+#include "solver_wrappers.h"
 #include "utilities.h"
 
+namespace MPI
+{
+  template <int dim>
+  class DistributedFSI;
+}
+
 namespace Solid
 {
   namespace MPI
   {
     using namespace dealii;
 
-    /// Base class for all parallel solid solvers.
-    template <int dim>
+    /*! \brief Base class for all parallel solid solvers.
+     *
+     *  The vectors, matrices and linear solvers are those of the Backend of
+     *  Utils::LinearAlgebraTraits, PETSc by default. The FSI solvers only
+     *  work with PETSc.
+     */
+    template <int dim, typename Backend = Utils::PETScBackend>
     class SolidSolver
     {
     public:
+      //! FSI solver need access to the private members of this solver.
+      friend ::MPI::DistributedFSI<dim>;
+
+      using Traits = Utils::LinearAlgebraTraits<Backend>;
+      using VectorType = typename Traits::Vector;
+      using MatrixType = typename Traits::SparseMatrix;
+
       SolidSolver(parallel::distributed::Triangulation<dim> &,
                   const Parameters::AllParameters &);
       ~SolidSolver();
       void run();
-      PETScWrappers::MPI::Vector get_current_solution() const;
+      VectorType get_current_solution() const;
 
     protected:
       /**
@@ -103,12 +126,23 @@ namespace Solid
 
       /**
        * Solve the linear system. Returns the number of
-       * CG iterations and the final residual.
+       * CG iterations and the final residual. The relative tolerance is the
+       * forcing term of the inexact Newton method if it is larger than the
+       * one of the parameters.
        */
-      std::pair<unsigned int, double>
-      solve(const PETScWrappers::MPI::SparseMatrix &,
-            PETScWrappers::MPI::Vector &,
-            const PETScWrappers::MPI::Vector &);
+      std::pair<unsigned int, double> solve(const MatrixType &,
+                                            VectorType &,
+                                            const VectorType &,
+                                            const double forcing = 0);
+
+      /**
+       * Solve \f$Ax = b\f$ with the factorization of system_matrix, and
+       * return 0 iterations and the residual. The matrix is only factorized
+       * again when the mesh or the time step size has changed, so this is for
+       * the solvers whose system matrix is constant otherwise.
+       */
+      std::pair<unsigned int, double> solve_factorized(VectorType &,
+                                                       const VectorType &);
 
       /**
        * Output the time-dependent solution in vtu format.
@@ -120,6 +154,22 @@ namespace Solid
        */
       void refine_mesh(const unsigned int, const unsigned int);
 
+      /*! \brief The largest time step size at the solid Courant number in the
+       *  current configuration, or infinity if it is not limited.
+       */
+      double get_stable_time_step() const;
+
+      /*! \brief Add the memory of the mesh, the sparsity patterns, the
+       *  matrices, the vectors and the cell data to a report.
+       *
+       *  The solvers with more data add theirs.
+       */
+      virtual void add_memory(Utils::MemoryReport &) const;
+
+      /// Print the memory report if the system was set up since the last
+      /// one, which is collective.
+      void report_memory();
+
       parallel::distributed::Triangulation<dim> &triangulation;
       Parameters::AllParameters parameters;
       DoFHandler<dim> dof_handler;
@@ -139,13 +189,14 @@ namespace Solid
        */
       AffineConstraints<double> constraints;
 
-      PETScWrappers::MPI::SparseMatrix
-        system_matrix; //!< \f$ M + \beta{\Delta{t}}^2K \f$.
-      PETScWrappers::MPI::SparseMatrix
-        mass_matrix; //!< Required by hyperelastic solver.
-      PETScWrappers::MPI::SparseMatrix
-        stiffness_matrix; //!< The stiffness is used in the rhs.
-      PETScWrappers::MPI::Vector system_rhs;
+      /// The boundary faces of the Neumann conditions, or of the FSI
+      /// traction, which are listed again along with the dofs.
+      Utils::BoundaryFaceList neumann_faces;
+
+      MatrixType system_matrix;    //!< \f$ M + \beta{\Delta{t}}^2K \f$.
+      MatrixType mass_matrix;      //!< Required by hyperelastic solver.
+      MatrixType stiffness_matrix; //!< The stiffness is used in the rhs.
+      VectorType system_rhs;
 
       /**
        * In the Newmark-beta method, acceleration is the variable to solve at
@@ -154,19 +205,52 @@ namespace Solid
        * the equation. For the sake of clarity, we explicitly store two sets of
        * accleration, velocity and displacement.
        */
-      PETScWrappers::MPI::Vector current_acceleration;
-      PETScWrappers::MPI::Vector current_velocity;
-      PETScWrappers::MPI::Vector current_displacement;
-      PETScWrappers::MPI::Vector previous_acceleration;
-      PETScWrappers::MPI::Vector previous_velocity;
-      PETScWrappers::MPI::Vector previous_displacement;
+      VectorType current_acceleration;
+      VectorType current_velocity;
+      VectorType current_displacement;
+      VectorType previous_acceleration;
+      VectorType previous_velocity;
+      VectorType previous_displacement;
+
+      /**
+       * The fluid stress on the solid boundary in FSI simulation, which is
+       * set by the FSI. fsi_stress_rows[i] stores the i-th row of the stress
+       * as a vector field, it is ghosted so that it can be evaluated on the
+       * boundary faces of the locally owned cells.
+       */
+      std::vector<VectorType> fsi_stress_rows;
 
       MPI_Comm mpi_communicator;
       ConditionalOStream pcout;
+      /// The HDF5 output if the output format is hdf5.
+      mutable Utils::HDF5Output hdf5_output;
+      /// The in-situ pipelines if the output format is ascent.
+      mutable Utils::InSituOutput insitu_output;
+      /// The writer of the vtu and pvd files.
+      mutable Utils::AsyncWriter writer;
       Utils::Time time;
       mutable TimerOutput timer;
+      /// The timer sections and the Krylov iterations for the performance
+      /// tests, written when the solver is destroyed.
+      Utils::PerformanceSummary performance;
+      /// The per time step log of the timer sections and the iterations.
+      Utils::Telemetry telemetry;
+      /// The memory of the subsystems, printed if "Memory report" is set.
+      Utils::MemoryReport memory_report;
       IndexSet locally_owned_dofs;
       IndexSet locally_relevant_dofs;
+
+      /// The AMG of solve, which holds the near nullspace it is built with.
+      typename Traits::ElasticAMG amg;
+      /// The CG iterations of the first solve with the current hierarchy, and
+      /// of the last solve.
+      unsigned int amg_setup_iterations;
+      unsigned int amg_last_iterations;
+
+      /// The factorization of solve_factorized, MUMPS in PETSc, and the time
+      /// step size it was computed with, 0 if there is none.
+      typename Traits::DirectSolver system_factor;
+      double factorized_delta_t;
     };
   } // namespace MPI
 } // namespace Solid
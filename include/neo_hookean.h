@@ -23,6 +23,8 @@ namespace Solid
     {
     }
 
+    double get_c1() const { return c1; }
+
     virtual dealii::SymmetricTensor<2, dim> get_tau_bar() const override
     {
       return 2 * this->c1 * this->b_bar;
@@ -0,0 +1,154 @@
+#ifndef NODAL_PROJECTION
+#define NODAL_PROJECTION
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/quadrature.h>
+#include <deal.II/base/types.h>
+
+#include <deal.II/fe/fe.h>
+#include <deal.II/fe/fe_tools.h>
+
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace Utils
+{
+  using namespace dealii;
+
+  /** \brief Projection of quadrature point values to nodal averages.
+   *
+   * Every cell projects its quadrature point values of several components
+   * to the dofs of a scalar element, and a dof takes the average of the
+   * projections of its surrounding cells. Rather than one matrix-vector
+   * product per component and cell, the values of a block of cells are
+   * stacked as the columns of a matrix and projected with one matrix-matrix
+   * product, and the results are summed into local arrays. add_to then adds
+   * the sums, and the numbers of surrounding cells, to the global vectors
+   * at once.
+   */
+  template <int dim, int spacedim = dim>
+  class NodalProjection
+  {
+  public:
+    NodalProjection(const FiniteElement<dim, spacedim> &scalar_fe,
+                    const Quadrature<dim> &quadrature,
+                    const unsigned int n_components,
+                    const types::global_dof_index n_dofs,
+                    const unsigned int block_size = 64)
+      : n_components(n_components),
+        block_size(block_size),
+        n_block_cells(0),
+        qpt_to_dof(scalar_fe.dofs_per_cell, quadrature.size()),
+        quad_values(quadrature.size(), n_components * block_size),
+        cell_values(scalar_fe.dofs_per_cell, n_components * block_size),
+        block_dof_indices(block_size * scalar_fe.dofs_per_cell),
+        sums(n_components, Vector<double>(n_dofs)),
+        counts(n_dofs)
+    {
+      FETools::compute_projection_from_quadrature_points_matrix(
+        scalar_fe, quadrature, quadrature, qpt_to_dof);
+    }
+
+    /** The value of a component at a quadrature point of the next cell. */
+    double &value(const unsigned int q, const unsigned int component)
+    {
+      AssertIndexRange(component, n_components);
+      return quad_values(q, n_block_cells * n_components + component);
+    }
+
+    /**
+     * Add the next cell with the scalar dofs dof_indices, after all its
+     * values are set.
+     */
+    void add_cell(const std::vector<types::global_dof_index> &dof_indices)
+    {
+      const unsigned int dofs_per_cell = qpt_to_dof.m();
+      AssertDimension(dof_indices.size(), dofs_per_cell);
+      std::copy(dof_indices.begin(),
+                dof_indices.end(),
+                block_dof_indices.begin() + n_block_cells * dofs_per_cell);
+      if (++n_block_cells == block_size)
+        {
+          flush();
+        }
+    }
+
+    /**
+     * Add the sums of a component at the dofs of the added cells to a vector,
+     * which still has to be compressed.
+     */
+    template <typename VectorType>
+    void add_to(const unsigned int component, VectorType &vector)
+    {
+      AssertIndexRange(component, n_components);
+      add_local_to(sums[component], vector);
+    }
+
+    /** Add the numbers of the surrounding cells of the dofs to a vector. */
+    template <typename VectorType>
+    void add_counts_to(VectorType &vector)
+    {
+      add_local_to(counts, vector);
+    }
+
+  private:
+    template <typename VectorType>
+    void add_local_to(const Vector<double> &local, VectorType &vector)
+    {
+      flush();
+      std::vector<types::global_dof_index> indices;
+      std::vector<double> values;
+      for (types::global_dof_index i = 0; i < counts.size(); ++i)
+        {
+          if (counts[i] != 0)
+            {
+              indices.push_back(i);
+              values.push_back(local[i]);
+            }
+        }
+      vector.add(indices, values);
+    }
+
+    /** Project the values of the cells in the block. */
+    void flush()
+    {
+      if (n_block_cells == 0)
+        {
+          return;
+        }
+      // The columns of the cells that are not in the block are zero or stale,
+      // and are not used.
+      qpt_to_dof.mmult(cell_values, quad_values);
+      const unsigned int dofs_per_cell = qpt_to_dof.m();
+      for (unsigned int c = 0; c < n_block_cells; ++c)
+        {
+          for (unsigned int i = 0; i < dofs_per_cell; ++i)
+            {
+              const types::global_dof_index dof =
+                block_dof_indices[c * dofs_per_cell + i];
+              for (unsigned int k = 0; k < n_components; ++k)
+                {
+                  sums[k][dof] += cell_values(i, c * n_components + k);
+                }
+              counts[dof] += 1;
+            }
+        }
+      n_block_cells = 0;
+    }
+
+    const unsigned int n_components;
+    const unsigned int block_size;
+    unsigned int n_block_cells;
+    FullMatrix<double> qpt_to_dof;
+    FullMatrix<double> quad_values; //!< [q, cell * n_components + component]
+    FullMatrix<double> cell_values; //!< [dof, cell * n_components + component]
+    std::vector<types::global_dof_index> block_dof_indices;
+    std::vector<Vector<double>> sums;
+    Vector<double> counts;
+  };
+} // namespace Utils
+
+#endif
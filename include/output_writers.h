@@ -0,0 +1,147 @@
+#ifndef OUTPUT_WRITERS
+#define OUTPUT_WRITERS
+
+#include <deal.II/base/mpi.h>
+#include <deal.II/numerics/data_out.h>
+
+#ifdef OPENIFEM_WITH_ASCENT
+#include <ascent.hpp>
+#endif
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+  using namespace dealii;
+
+  /*! \brief Only write the active cells of this process whose centers are in
+   *  a box, given by its lower and upper corners, or all of them if the box
+   *  is empty.
+   */
+  template <int dim, typename DoFHandlerType>
+  void select_output_cells(DataOut<dim, DoFHandlerType> &,
+                           const std::vector<double> &);
+
+  /// The flags of the vtu output with a compression level of the parameters.
+  DataOutBase::VtkFlags vtk_flags(const std::string &);
+
+  /*! \brief Collective output of a distributed solver in HDF5 and XDMF.
+   *
+   * Every output is written into one HDF5 file by all of the processes, and
+   * an XDMF file that indexes all of the outputs so far is rewritten by the
+   * first process. The coordinates and connectivity are written into a
+   * separate HDF5 file which is shared by the outputs until the mesh changes,
+   * so only the fields are written at every output.
+   */
+  class HDF5Output
+  {
+  public:
+    /// The files are named after the basename.
+    HDF5Output(const MPI_Comm &, const std::string &);
+
+    /// Write the mesh again with the next output, e.g. after refinement.
+    void mesh_changed() { write_mesh = true; }
+
+    /// Write the patches built by a DataOut as the output with an index at
+    /// a time. This is collective.
+    template <int dim>
+    void write(const DataOut<dim> &, const unsigned int, const double);
+
+  private:
+    MPI_Comm mpi_communicator;
+    const std::string basename;
+    bool write_mesh;
+    std::string mesh_filename;
+    std::vector<XDMFEntry> entries;
+  };
+
+  /*! \brief In-situ visualization of a distributed solver with Ascent.
+   *
+   * Instead of writing files, every output is handed to the pipelines of
+   * Ascent, which render the images and write the extracts that an actions
+   * file describes while the simulation runs. Every process publishes its
+   * patches as one domain of a Conduit Blueprint mesh: the duplicated
+   * vertices are merged as in the HDF5 output, and the coordinates and the
+   * fields are passed to Conduit as strided views of the merged data rather
+   * than copied again. Ascent is opened on the first output, and writes
+   * into a directory of its own, so that the fluid and the solid of an FSI
+   * can run the same actions.
+   */
+  class InSituOutput
+  {
+  public:
+    /// The images and extracts are written into the directory of the name,
+    /// with the pipelines of an actions file, e.g. ascent_actions.yaml.
+    InSituOutput(const MPI_Comm &, const std::string &, const std::string &);
+    InSituOutput(const InSituOutput &) = delete;
+    InSituOutput &operator=(const InSituOutput &) = delete;
+    ~InSituOutput();
+
+    /// Run the pipelines on the patches built by a DataOut, the output with
+    /// an index at a time. This is collective.
+    template <int dim>
+    void publish(const DataOut<dim> &, const unsigned int, const double);
+
+  private:
+    MPI_Comm mpi_communicator;
+    const std::string directory;
+    const std::string actions_file;
+    /// The merged patches of the last output, which the published mesh
+    /// points to.
+    DataOutBase::DataOutFilter data_filter;
+    std::vector<double> node_data;
+    std::vector<unsigned int> cell_data;
+#ifdef OPENIFEM_WITH_ASCENT
+    bool opened;
+    ascent::Ascent ascent;
+#endif
+  };
+
+  /*! \brief Writes files of one process on a background thread.
+   *
+   * The contents of a file are formatted into memory when it is written, so
+   * the data can change right after, and a thread writes the files to disk in
+   * the order they are written while the caller goes on. In the synchronous
+   * mode the contents are formatted directly into the file instead. The
+   * destructor waits for all of the files.
+   */
+  class AsyncWriter
+  {
+  public:
+    AsyncWriter(const bool asynchronous);
+
+    ~AsyncWriter();
+
+    /// Write a file with the contents that a function formats.
+    void write(const std::string &,
+               const std::function<void(std::ostream &)> &);
+
+    /// Wait until all of the files are on disk.
+    void wait();
+
+  private:
+    /// The loop of the thread.
+    void run();
+
+    /// Throw the error of the thread if there is one.
+    void check_error();
+
+    const bool asynchronous;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    // The files that are not written yet, the first of which may be in
+    // progress.
+    std::deque<std::pair<std::string, std::string>> queue;
+    bool stop;
+    std::string error;
+  };
+} // namespace Utils
+
+#endif
@@ -3,7 +3,9 @@
 
 #include <deal.II/base/exceptions.h>
 #include <deal.II/base/parameter_handler.h>
+#include <deal.II/base/point.h>
 
+#include <array>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -20,9 +22,32 @@ namespace Parameters
     double end_time;
     double time_step;
     double output_interval;
+    std::string output_format; //!< vtu, or hdf5 or ascent for MPI solvers.
+    std::string insitu_actions; //!< The actions file of the ascent output.
+    bool async_output; //!< Write the files on a background thread.
+    std::vector<std::string> output_fields; //!< "all" or the field names.
+    unsigned int output_subdivisions; //!< 0 for the default of the solver.
+    std::vector<double> output_region; //!< Lower and upper corners, or empty.
+    std::string output_compression; //!< zlib level of the vtu files.
+    /// Whether a field is in the output fields.
+    bool output_field(const std::string &) const;
+    std::string checkpoint_format; //!< separate, or coupled for MPI::FSI.
     double refinement_interval;
     double save_interval;
     std::vector<double> gravity;
+    bool adaptive_time_stepping; //!< Time step size is the initial one if set.
+    double min_time_step;
+    double max_time_step;
+    double max_time_step_growth;
+    double target_cfl; //!< 0 if the fluid CFL number is not limited.
+    unsigned int target_newton_iterations; //!< 0 if not used.
+    unsigned int target_linear_iterations; //!< 0 if not used.
+    double solid_courant; //!< 0 if the solid step size is not limited.
+    std::string performance_summary; //!< Empty if not written.
+    std::string telemetry_prefix; //!< Empty if no telemetry is logged.
+    bool memory_report;
+    /// default, cuthill_mckee, hierarchical or none.
+    std::string dof_renumbering;
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
@@ -31,6 +56,8 @@ namespace Parameters
   {
     unsigned int fluid_pressure_degree;
     unsigned int fluid_velocity_degree;
+    //! PSPG/SUPG stabilization of equal-order elements.
+    bool fluid_stabilization;
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
@@ -48,6 +75,48 @@ namespace Parameters
     double grad_div;
     unsigned int fluid_max_iterations;
     double fluid_tolerance;
+    bool fluid_matrix_free; //!< Apply the velocity block matrix-free.
+    //! Keep a stale factor while GMRES takes fewer iterations than this.
+    unsigned int fluid_stale_factor_iterations;
+    //! Rebuild the SCnsIM preconditioner after GMRES takes this many
+    //! iterations, or the inner Tpp solves this many in total.
+    unsigned int fluid_rebuild_iterations;
+    unsigned int fluid_rebuild_tpp_iterations;
+    unsigned int fluid_n_threads; //!< Threads of the assembly, 0 to keep.
+    //! Directions that the outer Krylov solver recycles, 0 for FGMRES.
+    unsigned int fluid_recycled_vectors;
+    //! Order of the initial guess extrapolation in time, 0 to disable.
+    unsigned int fluid_extrapolation_order;
+    //! Solve the inner pressure systems of the preconditioner in float.
+    bool fluid_mixed_precision;
+    //! PETSc backend of the inner solves: cpu, cuda or kokkos.
+    std::string fluid_backend;
+    //! implicit, or explicit (low-storage Runge-Kutta) for MPI SCnsIM.
+    std::string fluid_time_integration;
+    //! dealii, or fieldsplit for the PETSc PCFIELDSPLIT solver.
+    std::string fluid_block_solver;
+    //! Preconditioners of the inner solves of the block preconditioners,
+    //! "default" for the choice of the solver.
+    std::string fluid_velocity_preconditioner;
+    std::string fluid_mass_preconditioner;
+    std::string fluid_schur_preconditioner;
+    //! Relative tolerances of the inner solves.
+    double fluid_velocity_tolerance;
+    double fluid_mass_tolerance;
+    double fluid_schur_tolerance;
+    //! mass, or pcd for the pressure convection-diffusion preconditioner.
+    std::string fluid_schur_approximation;
+    //! cg, or the pipelined pipecg, groppcg or pipecr for the inner CGs.
+    std::string fluid_inner_krylov;
+    //! Solve the Newton systems of MPI InsIM and SCnsIM to Eisenstat-Walker
+    //! tolerances up to the maximum forcing term.
+    bool fluid_inexact_newton;
+    double fluid_max_forcing;
+    //! Halvings of the backtracking line search, 0 for the full steps.
+    unsigned int fluid_line_search_steps;
+    //! The budget in MB of the per-cell geometry cache of the MPI fluid
+    //! assembly, which is disabled by 0 or if it does not fit.
+    double fluid_geometry_cache_memory;
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
@@ -99,6 +168,9 @@ namespace Parameters
     std::vector<double> nu;  //!< Poisson's ratio, linear elastic material only.
     std::vector<double> eta; //!< Viscosity, linear elastic material only.
     std::vector<std::vector<double>> C; //!< Hyperelastic material constants.
+    /// The speed of the longitudinal elastic waves in a solid part, at small
+    /// strains.
+    double wave_speed(const unsigned int) const;
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
@@ -110,6 +182,27 @@ namespace Parameters
                                        //! hyperelastic only.
     double tol_f;                      //!< Force tolerance
     double tol_d; //!< Displacement tolerance, hyperelastic only.
+    std::string solid_preconditioner; //!< default, amg, jacobi, etc.
+    //! Relative tolerance of the linear solver, 0 for the solver default.
+    double solid_linear_tolerance;
+    //! cg, or the pipelined pipecg, groppcg or pipecr, MPI only.
+    std::string solid_krylov;
+    //! Solve the Newton systems of the hyperelastic solvers to
+    //! Eisenstat-Walker tolerances up to the maximum forcing term.
+    bool solid_inexact_newton;
+    double solid_max_forcing;
+    //! Factorize the constant linear elastic system matrix once.
+    bool solid_cached_factorization;
+    //! Newton iterations that reuse the last tangent, hyperelastic only.
+    unsigned int solid_tangent_reuse;
+    //! implicit (Newmark) or explicit (central difference with lumped mass).
+    std::string solid_integrator;
+    //! Apply the linear elastic stiffness cell by cell rather than storing it.
+    bool solid_matrix_free;
+    //! Apply the hyperelastic tangent matrix-free with a Chebyshev
+    //! preconditioner of the degree.
+    bool solid_matrix_free_tangent;
+    unsigned int solid_chebyshev_degree;
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
@@ -152,6 +245,77 @@ namespace Parameters
     void parseParameters(ParameterHandler &);
   };
 
+  struct FSIControl
+  {
+    bool incremental_indicator; //!< Only re-test the fluid cells that the
+                                //! solid boundary has swept over.
+    unsigned int n_solid_processes; //!< Number of processes that only run
+                                    //! the solid in MPI::FSI, 0 to share all.
+    unsigned int solid_substeps; //!< Solid steps per coupling time step.
+    unsigned int fluid_substeps; //!< Fluid steps per coupling time step.
+    std::string coupling_profile; //!< CSV file of the per-step coupling
+                                  //! profile, empty to disable.
+    double load_imbalance_threshold; //!< Max over average time per step
+                                     //! that triggers repartitioning.
+    bool node_shared_solid_state; //!< Localize the solid state once per node.
+    bool eulerian_solid_mapping; //!< Map the solid mesh to its deformed
+                                 //! configuration instead of moving it.
+    unsigned int coupling_iterations; //!< Most iterations per coupling step,
+                                      //! 1 for the staggered coupling.
+    double coupling_tolerance; //!< Relative interface residual to converge.
+    std::string coupling_acceleration; //!< aitken or iqn-ils.
+    double coupling_relaxation; //!< Relaxation of the first iteration.
+    double refinement_distance; //!< Refine the fluid cells this many
+                                //! diameters from the solid boundary.
+    double coarsening_distance; //!< Coarsen the fluid cells this many
+                                //! diameters from the solid boundary.
+    static void declareParameters(ParameterHandler &);
+    void parseParameters(ParameterHandler &);
+  };
+
+  struct Monitors
+  {
+    std::string monitor_file; //!< Empty if the flow is not monitored.
+    std::vector<Point<3>> probe_points;
+    /// The start and end points of the lines and their numbers of samples.
+    std::vector<std::pair<std::array<Point<3>, 2>, unsigned int>> sample_lines;
+    /// The origin and the two other corners of the planes, and their numbers
+    /// of samples in the two directions.
+    std::vector<
+      std::pair<std::array<Point<3>, 3>, std::array<unsigned int, 2>>>
+      sample_planes;
+    std::vector<unsigned int> force_boundaries;
+    /**
+     * The points are given with the dimension of the Simulation subsection,
+     * which is copied here to parse them, the unused coordinates are zero.
+     */
+    int monitor_dim;
+    static void declareParameters(ParameterHandler &);
+    void parseParameters(ParameterHandler &);
+  };
+
+  struct EnsembleControl
+  {
+    unsigned int ensemble_groups; //!< Groups of processes run concurrently.
+    /// The overrides of every variant, "Subsection/Entry = value" separated
+    /// by "|".
+    std::vector<std::string> ensemble_variants;
+    static void declareParameters(ParameterHandler &);
+    void parseParameters(ParameterHandler &);
+  };
+
+  struct PararealControl
+  {
+    unsigned int parareal_groups; //!< Time slices run concurrently.
+    unsigned int parareal_slice_steps; //!< Fine time steps per slice.
+    /// The coarse time step size is this many fine ones.
+    unsigned int parareal_coarse_factor;
+    unsigned int parareal_max_iterations;
+    double parareal_tolerance; //!< Relative change of the slice solutions.
+    static void declareParameters(ParameterHandler &);
+    void parseParameters(ParameterHandler &);
+  };
+
   struct AllParameters : public Simulation,
                          public FluidFESystem,
                          public FluidMaterial,
@@ -162,9 +326,15 @@ namespace Parameters
                          public SolidMaterial,
                          public SolidSolver,
                          public SolidDirichlet,
-                         public SolidNeumann
+                         public SolidNeumann,
+                         public FSIControl,
+                         public Monitors,
+                         public EnsembleControl,
+                         public PararealControl
   {
-    AllParameters(const std::string &);
+    /// Read a parameter file, and set the entries of the overrides, given
+    /// like the ensemble variants, on top of it.
+    AllParameters(const std::string &, const std::string & = "");
     static void declareParameters(ParameterHandler &);
     void parseParameters(ParameterHandler &);
   };
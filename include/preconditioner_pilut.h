@@ -8,10 +8,13 @@
 #include <deal.II/lac/petsc_matrix_base.h>
 #include <deal.II/lac/petsc_precondition.h>
 #include <deal.II/lac/petsc_solver.h>
+#include <deal.II/lac/petsc_vector.h>
 #include <deal.II/lac/petsc_vector_base.h>
 #include <petscconf.h>
 #include <petscpc.h>
 
+#include <vector>
+
 using namespace dealii;
 
 class PreconditionPilut : public PETScWrappers::PreconditionerBase
@@ -97,6 +100,128 @@ public:
    */
   void initialize(const PETScWrappers::MatrixBase &matrix);
 
+  /**
+   * Keep the current factorization when the matrix is modified afterwards.
+   * By default PETSc redoes the setup at the next application.
+   */
+  void keep_factorization();
+
+  friend PETScWrappers::MatrixBase;
+};
+
+/**
+ * MUMPS LU factorization used as a preconditioner, which is therefore an
+ * exact solve as long as the factor is up to date.
+ *
+ * Unlike PETScWrappers::SparseDirectMUMPS, which redoes the symbolic analysis
+ * whenever it is reset, the PETSc PC object is kept until clear() is called.
+ * So the analysis is done once per sparsity pattern, and later updates only
+ * redo the numerical factorization.
+ */
+class PreconditionMUMPS : public PETScWrappers::PreconditionerBase
+{
+public:
+  /**
+   * Empty Constructor. You need to call update() before using this object.
+   */
+  PreconditionMUMPS() = default;
+
+  /**
+   * Factorize the matrix if this object is empty, or if the matrix has been
+   * modified since the last factorization and keep_stale is false. The
+   * matrix must have the same sparsity pattern as in the last call, otherwise
+   * clear() must be called first. Returns whether the matrix is factorized.
+   */
+  bool update(const PETScWrappers::MatrixBase &matrix,
+              const bool keep_stale = false);
+
+  friend PETScWrappers::MatrixBase;
+
+private:
+  /**
+   * The state of the matrix when it was last factorized.
+   */
+  PetscObjectState factorized_state;
+};
+
+/**
+ * Smoothed aggregation AMG (PETSc GAMG) for elasticity, which is given the
+ * rigid body modes as the near nullspace of the matrix so that the coarse
+ * spaces can represent them.
+ *
+ * The hierarchy is built by the first update and kept by the later ones for
+ * as long as the caller allows, even if the matrix is modified in between.
+ * Building it is much more expensive than a V-cycle, and a stale hierarchy
+ * is still a good preconditioner for a slowly changing matrix.
+ */
+class PreconditionElasticAMG : public PETScWrappers::PreconditionerBase
+{
+public:
+  /**
+   * Empty Constructor. You need to call update() before using this object.
+   */
+  PreconditionElasticAMG() = default;
+
+  /**
+   * Build the hierarchy if this object is empty or another matrix is given,
+   * or if keep_hierarchy is false. The modes span the near nullspace, they
+   * are orthonormalized here. Returns whether the hierarchy is rebuilt.
+   */
+  bool update(const PETScWrappers::MatrixBase &matrix,
+              const std::vector<PETScWrappers::MPI::Vector> &modes,
+              const bool keep_hierarchy = true);
+
+  friend PETScWrappers::MatrixBase;
+};
+
+/**
+ * A preconditioner that is selected by its name in the parameter file:
+ * "amg" (BoomerAMG), "gamg" (a smoothed aggregation V-cycle with Chebyshev
+ * smoothers, whose iterations do not grow with the refinement of the mesh),
+ * "pilut", "euclid", "jacobi", "sor" (symmetric local SOR for a symmetric
+ * matrix), "chebyshev" (a fixed number of Chebyshev iterations on the Jacobi
+ * preconditioned matrix, which is a symmetric polynomial preconditioner for
+ * CG) or "none".
+ *
+ * The solvers map "default" to their own choice before calling initialize.
+ */
+class PreconditionSelector : public PETScWrappers::PreconditionerBase
+{
+public:
+  /**
+   * The names that initialize accepts, as a Patterns::Selection.
+   */
+  static std::string names();
+
+  /**
+   * The name from the parameter file, or the fallback if it is "default".
+   */
+  static std::string choose(const std::string &name,
+                            const std::string &fallback)
+  {
+    return name == "default" ? fallback : name;
+  }
+
+  /**
+   * Empty Constructor. You need to call initialize() before using this
+   * object.
+   */
+  PreconditionSelector() = default;
+
+  /**
+   * Set up the named preconditioner for a matrix. Whether the matrix is
+   * symmetric decides the sweeps of sor.
+   */
+  void initialize(const std::string &name,
+                  const PETScWrappers::MatrixBase &matrix,
+                  const bool symmetric = true);
+
+  /**
+   * Keep the current setup when the matrix is modified afterwards.
+   * By default PETSc redoes the setup at the next application.
+   */
+  void keep_factorization();
+
   friend PETScWrappers::MatrixBase;
 };
 
@@ -0,0 +1,174 @@
+#ifndef QUADRATURE_HISTORY
+#define QUADRATURE_HISTORY
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/symmetric_tensor.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/base/types.h>
+
+#include <vector>
+
+#include "parameters.h"
+
+namespace Internal
+{
+  using namespace dealii;
+
+  /** \brief Data to store at the quadrature points of a hyperelastic solid.
+   *
+   * We cache the kinematics information and the stress at the quadrature
+   * points, so that they can be conveniently accessed in the assembly or
+   * post processing. Rather than an object per quadrature point, every
+   * quantity is stored in one contiguous array over the quadrature points of
+   * all the stored cells, in which the points of a cell are consecutive.
+   * The cells are addressed by their active cell indices, and the material
+   * of a cell is stored as an index into Parameters::AllParameters::C.
+   */
+  template <int dim>
+  class QuadratureHistory
+  {
+  public:
+    QuadratureHistory() : n_q_points(0), density(0.0) {}
+
+    /**
+     * Remove all cells, and reserve the storage for n_stored_cells of the
+     * n_active_cells of a triangulation.
+     */
+    void reinit(const Parameters::AllParameters &parameters,
+                const unsigned int n_active_cells,
+                const unsigned int n_stored_cells,
+                const unsigned int n_q_points_)
+    {
+      n_q_points = n_q_points_;
+      density = parameters.solid_rho;
+      material_parameters = parameters.C;
+      cell_offsets.assign(n_active_cells, numbers::invalid_unsigned_int);
+      cell_materials.clear();
+      cell_materials.reserve(n_stored_cells);
+
+      const unsigned int n_points = n_stored_cells * n_q_points;
+      F_inv.clear();
+      F_inv.reserve(n_points);
+      det_F.clear();
+      det_F.reserve(n_points);
+      tau.clear();
+      tau.reserve(n_points);
+      Jc.clear();
+      Jc.reserve(n_points);
+      dPsi_vol_dJ.clear();
+      dPsi_vol_dJ.reserve(n_points);
+      d2Psi_vol_dJ2.clear();
+      d2Psi_vol_dJ2.reserve(n_points);
+    }
+
+    /**
+     * Add the quadrature points of a cell with the material id mat_id. Their
+     * state has to be set with update before it is used.
+     */
+    void add_cell(const unsigned int cell_index, const unsigned int mat_id)
+    {
+      AssertIndexRange(cell_index, cell_offsets.size());
+      Assert(mat_id >= 1 && mat_id <= material_parameters.size(),
+             ExcInternalError());
+      cell_offsets[cell_index] = det_F.size();
+      cell_materials.push_back(mat_id - 1);
+
+      const unsigned int n_points = det_F.size() + n_q_points;
+      F_inv.resize(n_points);
+      det_F.resize(n_points, 1.0);
+      tau.resize(n_points);
+      Jc.resize(n_points);
+      dPsi_vol_dJ.resize(n_points, 0.0);
+      d2Psi_vol_dJ2.resize(n_points, 0.0);
+    }
+
+    /** Return the index of the first quadrature point of a cell. */
+    unsigned int begin(const unsigned int cell_index) const
+    {
+      AssertIndexRange(cell_index, cell_offsets.size());
+      Assert(cell_offsets[cell_index] != numbers::invalid_unsigned_int,
+             ExcMessage("The cell is not stored!"));
+      return cell_offsets[cell_index];
+    }
+
+    /** Store the state evaluated by a Solid::HyperElasticKernel. */
+    void update(const unsigned int point,
+                const Tensor<2, dim> &F_inv_,
+                const double det_F_,
+                const SymmetricTensor<2, dim> &tau_,
+                const SymmetricTensor<4, dim> &Jc_,
+                const double dPsi_vol_dJ_,
+                const double d2Psi_vol_dJ2_)
+    {
+      AssertIndexRange(point, det_F.size());
+      F_inv[point] = F_inv_;
+      det_F[point] = det_F_;
+      tau[point] = tau_;
+      Jc[point] = Jc_;
+      dPsi_vol_dJ[point] = dPsi_vol_dJ_;
+      d2Psi_vol_dJ2[point] = d2Psi_vol_dJ2_;
+    }
+
+    /** Return the material constants at a quadrature point. */
+    const std::vector<double> &
+    get_material_parameters(const unsigned int point) const
+    {
+      return material_parameters[cell_materials[point / n_q_points]];
+    }
+    double get_density() const { return density; }
+    double get_det_F(const unsigned int point) const { return det_F[point]; }
+    const Tensor<2, dim> &get_F_inv(const unsigned int point) const
+    {
+      return F_inv[point];
+    }
+    const SymmetricTensor<2, dim> &get_tau(const unsigned int point) const
+    {
+      return tau[point];
+    }
+    const SymmetricTensor<4, dim> &get_Jc(const unsigned int point) const
+    {
+      return Jc[point];
+    }
+    double get_dPsi_vol_dJ(const unsigned int point) const
+    {
+      return dPsi_vol_dJ[point];
+    }
+    double get_d2Psi_vol_dJ2(const unsigned int point) const
+    {
+      return d2Psi_vol_dJ2[point];
+    }
+
+    /** The memory of the stored arrays in bytes. */
+    std::size_t memory_consumption() const
+    {
+      return MemoryConsumption::memory_consumption(material_parameters) +
+             MemoryConsumption::memory_consumption(cell_offsets) +
+             MemoryConsumption::memory_consumption(cell_materials) +
+             MemoryConsumption::memory_consumption(F_inv) +
+             MemoryConsumption::memory_consumption(det_F) +
+             MemoryConsumption::memory_consumption(tau) +
+             MemoryConsumption::memory_consumption(Jc) +
+             MemoryConsumption::memory_consumption(dPsi_vol_dJ) +
+             MemoryConsumption::memory_consumption(d2Psi_vol_dJ2);
+    }
+
+  private:
+    unsigned int n_q_points;
+    double density;
+    std::vector<std::vector<double>> material_parameters;
+    /** The first quadrature point of every active cell. */
+    std::vector<unsigned int> cell_offsets;
+    /** The index of the material parameters of every stored cell. */
+    std::vector<unsigned int> cell_materials;
+
+    std::vector<Tensor<2, dim>> F_inv;
+    std::vector<double> det_F;
+    std::vector<SymmetricTensor<2, dim>> tau;
+    std::vector<SymmetricTensor<4, dim>> Jc;
+    std::vector<double> dPsi_vol_dJ;
+    std::vector<double> d2Psi_vol_dJ2;
+  };
+} // namespace Internal
+
+#endif
@@ -95,6 +95,12 @@ namespace Solid
 
     Vector<double> current_drilling;
 
+    /// The dofs of the 3 displacement components, and the scalar dof, at
+    /// every vertex, in the vertex order of m_mesh. Computed in
+    /// construct_mesh, invalid at the unused vertices.
+    std::vector<types::global_dof_index> vertex_dofs;
+    std::vector<types::global_dof_index> vertex_scalar_dofs;
+
     std::unique_ptr<ShellSolid::shellsolid> m_shell;
   };
 } // namespace Solid
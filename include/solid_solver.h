@@ -6,6 +6,7 @@
 #include <deal.II/base/quadrature_point_data.h>
 #include <deal.II/base/tensor.h>
 #include <deal.II/base/timer.h>
+#include <deal.II/base/work_stream.h>
 
 #include <deal.II/dofs/dof_accessor.h>
 #include <deal.II/dofs/dof_handler.h>
@@ -32,6 +33,7 @@
 #include <deal.II/lac/full_matrix.h>
 #include <deal.II/lac/precondition.h>
 #include <deal.II/lac/solver_cg.h>
+#include <deal.II/lac/sparse_direct.h>
 #include <deal.II/lac/sparse_matrix.h>
 #include <deal.II/lac/vector.h>
 
@@ -99,11 +101,49 @@ namespace Solid
 
     /**
      * Solve the linear system. Returns the number of
-     * CG iterations and the final residual.
+     * CG iterations and the final residual. The relative tolerance is the
+     * forcing term of the inexact Newton method if it is larger than the one
+     * of the parameters.
      */
     std::pair<unsigned int, double> solve(const SparseMatrix<double> &,
                                           Vector<double> &,
-                                          const Vector<double> &);
+                                          const Vector<double> &,
+                                          const double forcing = 0);
+
+    /**
+     * Solve \f$Ax = b\f$ with the factorization of system_matrix, and return
+     * 0 iterations and the residual. The matrix is only factorized again when
+     * the mesh or the time step size has changed, so this is for the solvers
+     * whose system matrix is constant otherwise.
+     */
+    std::pair<unsigned int, double> solve_factorized(Vector<double> &,
+                                                     const Vector<double> &);
+
+    /**
+     * Assemble inverse_lumped_mass from the row sums of the consistent mass
+     * matrix.
+     */
+    void assemble_lumped_mass();
+
+    /**
+     * Assemble the external minus the internal force at current_displacement
+     * and current_velocity into system_rhs. This is all the explicit
+     * integrator needs from a material, the default throws.
+     */
+    virtual void assemble_explicit_force();
+
+    /**
+     * Run one time step of the central difference method in its velocity
+     * Verlet form, which only takes a force evaluation and no linear solve.
+     * The time step size must not exceed get_stable_time_step.
+     */
+    void run_one_explicit_step(bool first_step);
+
+    /*! \brief The largest time step size at the solid Courant number, or
+     *  infinity if it is not limited. The explicit integrator is always
+     *  limited, at Courant number 1 unless it is set.
+     */
+    double get_stable_time_step() const;
 
     /**
      * Output the time-dependent solution in vtu format.
@@ -132,12 +172,24 @@ namespace Solid
      */
     AffineConstraints<double> constraints;
 
+    /// The boundary faces of the Neumann conditions, or of the FSI
+    /// traction, which are listed again along with the dofs.
+    Utils::BoundaryFaceList neumann_faces;
+
     SparsityPattern pattern;
+    /// Which of the matrices below initialize_system allocates, set by the
+    /// constructors of the solvers. The others are left empty.
+    bool use_system_matrix;
+    bool use_mass_matrix;
+    bool use_stiffness_matrix;
     SparseMatrix<double> system_matrix; //!< \f$ M + \beta{\Delta{t}}^2K \f$.
     SparseMatrix<double> mass_matrix;   //!< Required by hyperelastic solver.
     SparseMatrix<double>
       stiffness_matrix; //!< The stiffness is used in the rhs.
     Vector<double> system_rhs;
+    /// The inverse of the lumped mass matrix of the explicit integrator, 0 at
+    /// the constrained dofs, and empty until it is assembled.
+    Vector<double> inverse_lumped_mass;
 
     /**
      * In the Newmark-beta method, acceleration is the variable to solve at
@@ -166,6 +218,11 @@ namespace Solid
     Utils::Time time;
     mutable TimerOutput timer;
 
+    /// The factorization of solve_factorized, and the time step size it was
+    /// computed with, 0 if there is none.
+    SparseDirectUMFPACK system_factor;
+    double factorized_delta_t;
+
     CellDataStorage<typename Triangulation<dim, spacedim>::cell_iterator,
                     CellProperty>
       cell_property;
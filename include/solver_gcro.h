@@ -0,0 +1,230 @@
+#ifndef SOLVER_GCRO
+#define SOLVER_GCRO
+
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/lac/solver_control.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace Utils
+{
+  using namespace dealii;
+
+  /*! \brief The Krylov directions that SolverGCRO keeps between solves.
+   *
+   * The space stores the directions \f$u_i\f$ and the orthonormal
+   * \f$c_i = Au_i\f$, the first n_recycled of which are recycled by the next
+   * solve, and the others are the workspace of a solve. It must be cleared
+   * whenever the layout of the vectors changes.
+   */
+  template <typename VectorType>
+  class KrylovRecycleSpace : public Subscriptor
+  {
+  public:
+    KrylovRecycleSpace() : n_recycled(0) {}
+
+    /// Forget all of the directions.
+    void clear()
+    {
+      u.clear();
+      c.clear();
+      n_recycled = 0;
+    }
+
+  private:
+    template <typename>
+    friend class SolverGCRO;
+
+    std::vector<std::unique_ptr<VectorType>> u;
+    std::vector<std::unique_ptr<VectorType>> c;
+    unsigned int n_recycled;
+  };
+
+  /*! \brief Flexible GCR with a recycled Krylov subspace (GCRO).
+   *
+   * The solver minimizes the residual over the span of the preconditioned
+   * residuals like FGMRES, so the preconditioner may change between
+   * iterations, but it also minimizes over the directions recycled from the
+   * previous solves. Since \f$A\f$ changes between the solves, the recycled
+   * \f$c_i\f$ are first recomputed with the current matrix and
+   * orthonormalized, which costs one matrix-vector product per direction.
+   * After the solve, the directions that reduced the residual the most
+   * (including the recycled ones) are kept for the next solve. This pays off
+   * when the systems of consecutive time steps and Newton iterations are
+   * close to each other.
+   *
+   * When the basis is full, the solver restarts but keeps the recycled
+   * directions in the basis. A solve needs two vectors per direction, twice
+   * as many as FGMRES.
+   */
+  template <typename VectorType>
+  class SolverGCRO
+  {
+  public:
+    struct AdditionalData
+    {
+      AdditionalData(const unsigned int max_basis_size = 30,
+                     const unsigned int n_recycled = 5)
+        : max_basis_size(max_basis_size), n_recycled(n_recycled)
+      {
+      }
+      unsigned int max_basis_size; //!< New directions before restarting.
+      unsigned int n_recycled; //!< Directions kept for the next solve.
+    };
+
+    SolverGCRO(SolverControl &control,
+               KrylovRecycleSpace<VectorType> &space,
+               const AdditionalData &data = AdditionalData())
+      : control(control), space(space), data(data)
+    {
+    }
+
+    /// Solve \f$Ax = b\f$ with the initial guess x.
+    template <typename MatrixType, typename PreconditionerType>
+    void solve(const MatrixType &A,
+               VectorType &x,
+               const VectorType &b,
+               const PreconditionerType &preconditioner)
+    {
+      VectorType r(b);
+      A.vmult(r, x);
+      r.sadd(-1.0, 1.0, b);
+
+      // The absolute contribution of every direction to the solution.
+      std::vector<double> weights;
+      unsigned int n = 0;
+      // Refresh the recycled directions with the current matrix, and
+      // project the residual onto their orthogonal complement.
+      for (unsigned int i = 0; i < space.n_recycled; ++i)
+        {
+          A.vmult(*space.c[i], *space.u[i]);
+          if (!orthonormalize(n, *space.u[i], *space.c[i]))
+            {
+              continue;
+            }
+          if (n != i)
+            {
+              std::swap(space.u[n], space.u[i]);
+              std::swap(space.c[n], space.c[i]);
+            }
+          weights.push_back(add_direction(n, x, r));
+          ++n;
+        }
+      const unsigned int n_kept = n;
+
+      unsigned int step = 0;
+      SolverControl::State state = control.check(step, r.l2_norm());
+      while (state == SolverControl::iterate)
+        {
+          if (n == n_kept + data.max_basis_size)
+            {
+              // Restart, but keep minimizing over the recycled directions.
+              n = n_kept;
+              weights.resize(n_kept);
+            }
+          if (space.u.size() == n)
+            {
+              space.u.emplace_back(new VectorType(x));
+              space.c.emplace_back(new VectorType(x));
+            }
+          preconditioner.vmult(*space.u[n], r);
+          A.vmult(*space.c[n], *space.u[n]);
+          if (!orthonormalize(n, *space.u[n], *space.c[n]))
+            {
+              // Breakdown: the residual cannot be reduced any further.
+              break;
+            }
+          weights.push_back(add_direction(n, x, r));
+          ++n;
+          ++step;
+          state = control.check(step, r.l2_norm());
+        }
+
+      keep_directions(n, weights);
+      AssertThrow(state == SolverControl::success,
+                  SolverControl::NoConvergence(control.last_step(),
+                                               control.last_value()));
+    }
+
+  private:
+    /// Orthonormalize c against the first n directions, and apply the same
+    /// operations to u. Returns false if c is linearly dependent on them.
+    bool orthonormalize(const unsigned int n, VectorType &u, VectorType &c)
+    {
+      const double initial_norm = c.l2_norm();
+      for (unsigned int j = 0; j < n; ++j)
+        {
+          const double h = (*space.c[j]) * c;
+          c.add(-h, *space.c[j]);
+          u.add(-h, *space.u[j]);
+        }
+      const double norm = c.l2_norm();
+      if (norm <= 1e-12 * initial_norm || norm == 0)
+        {
+          return false;
+        }
+      c /= norm;
+      u /= norm;
+      return true;
+    }
+
+    /// Minimize the residual along the n-th direction, and return the
+    /// absolute value of the step.
+    double add_direction(const unsigned int n, VectorType &x, VectorType &r)
+    {
+      const double alpha = (*space.c[n]) * r;
+      x.add(alpha, *space.u[n]);
+      r.add(-alpha, *space.c[n]);
+      return std::abs(alpha);
+    }
+
+    /// Move the directions with the largest weights to the front of the
+    /// space to be recycled.
+    void keep_directions(const unsigned int n,
+                         const std::vector<double> &weights)
+    {
+      std::vector<unsigned int> order(n);
+      std::iota(order.begin(), order.end(), 0);
+      const unsigned int n_kept = std::min(data.n_recycled, n);
+      std::partial_sort(order.begin(),
+                        order.begin() + n_kept,
+                        order.end(),
+                        [&weights](const unsigned int i, const unsigned int j) {
+                          return weights[i] > weights[j];
+                        });
+      std::vector<std::unique_ptr<VectorType>> u(space.u.size()),
+        c(space.c.size());
+      std::vector<bool> moved(space.u.size(), false);
+      for (unsigned int i = 0; i < n_kept; ++i)
+        {
+          u[i] = std::move(space.u[order[i]]);
+          c[i] = std::move(space.c[order[i]]);
+          moved[order[i]] = true;
+        }
+      // The rest of the vectors are the workspace of the next solve.
+      unsigned int k = n_kept;
+      for (unsigned int i = 0; i < space.u.size(); ++i)
+        {
+          if (!moved[i])
+            {
+              u[k] = std::move(space.u[i]);
+              c[k] = std::move(space.c[i]);
+              ++k;
+            }
+        }
+      space.u.swap(u);
+      space.c.swap(c);
+      space.n_recycled = n_kept;
+    }
+
+    SolverControl &control;
+    KrylovRecycleSpace<VectorType> &space;
+    const AdditionalData data;
+  };
+} // namespace Utils
+
+#endif
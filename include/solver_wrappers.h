@@ -0,0 +1,255 @@
+#ifndef SOLVER_WRAPPERS
+#define SOLVER_WRAPPERS
+
+#include <deal.II/base/index_set.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/lac/diagonal_matrix.h>
+#include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/lac/petsc_block_sparse_matrix.h>
+#include <deal.II/lac/petsc_block_vector.h>
+#include <deal.II/lac/petsc_solver.h>
+#include <deal.II/lac/petsc_sparse_matrix.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <petscksp.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+  using namespace dealii;
+
+  /*! \brief PETSc CG for the inner solves, with the variant chosen at run
+   * time.
+   *
+   * cg is the standard method, with two blocking global reductions per
+   * iteration. pipecg is the pipelined CG of P. Ghysels and W. Vanroose,
+   * Parallel Comput. 40 (2014) 224-238, whose single reduction per iteration
+   * is overlapped with the matrix-vector product and the preconditioner.
+   * groppcg is Gropp's asynchronous CG, which overlaps its two reductions,
+   * and pipecr the pipelined conjugate residual method. The pipelined
+   * variants do a few more vector updates per iteration and reach a
+   * somewhat lower accuracy, so they only pay off when the latency of the
+   * reductions dominates, at large numbers of processes.
+   */
+  class SolverKrylov : public PETScWrappers::SolverBase
+  {
+  public:
+    SolverKrylov(SolverControl &control,
+                 const MPI_Comm &communicator,
+                 const std::string &method);
+
+  protected:
+    virtual void set_solver_type(KSP &ksp) const override;
+
+  private:
+    const std::string method;
+  };
+
+  /*! \brief Jacobi preconditioned CG on a single-precision copy of a PETSc
+   * matrix.
+   *
+   * The inner solves of the block preconditioners only need a loose
+   * accuracy, and they are bound by the memory traffic of the matrix. PETSc
+   * is built with double scalars, so the locally owned rows are copied into
+   * a float CSR matrix instead, and the right hand side and the solution are
+   * converted from and into the PETSc vectors around every solve. The
+   * tolerance is limited to 1e-5 of the right hand side, which is about what
+   * float can reach. The copy has to be redone whenever the values of the
+   * matrix change.
+   */
+  class SinglePrecisionCG : public Subscriptor
+  {
+  public:
+    using VectorType = LinearAlgebra::distributed::Vector<float>;
+
+    /// Copy a square matrix whose rows and columns are partitioned alike.
+    void reinit(const PETScWrappers::MPI::SparseMatrix &);
+
+    /// Solve with a zero initial guess, and return the number of iterations.
+    unsigned int solve(PETScWrappers::MPI::Vector &,
+                       const PETScWrappers::MPI::Vector &,
+                       const double) const;
+
+    /// The product with the float matrix, which is used by the CG solver.
+    void vmult(VectorType &, const VectorType &) const;
+
+  private:
+    // The locally owned rows in CSR format. The columns are the local indices
+    // of the partitioner of the vectors, i.e. the ghosts follow the owned.
+    std::vector<unsigned int> row_starts;
+    std::vector<unsigned int> columns;
+    std::vector<float> values;
+    DiagonalMatrix<VectorType> inverse_diagonal;
+    mutable VectorType x_buffer;
+    mutable VectorType b_buffer;
+  };
+
+  /*! \brief PETSc CG on a device copy of a matrix.
+   *
+   * The matrix is copied into the AIJ type of a PETSc device backend, "cuda"
+   * (MATAIJCUSPARSE) or "kokkos" (MATAIJKOKKOS), and the work vectors of the
+   * solver are device vectors, so the SpMVs and the vector operations of the
+   * iterations run on the device. The deal.II PETSc vectors live on the host,
+   * so the right hand side and the solution are copied to and from the
+   * device around every solve. PETSc must be configured with the backend,
+   * and the copy has to be redone whenever the values of the matrix change.
+   */
+  class DeviceCG : public Subscriptor
+  {
+  public:
+    DeviceCG();
+    DeviceCG(const DeviceCG &) = delete;
+    DeviceCG &operator=(const DeviceCG &) = delete;
+    ~DeviceCG();
+
+    /// Copy a matrix to the device, and precondition it with its diagonal
+    /// ("jacobi") or with BoomerAMG ("boomeramg").
+    void reinit(const PETScWrappers::MatrixBase &,
+                const std::string &,
+                const std::string &);
+
+    /// Solve with a zero initial guess, and return the number of iterations.
+    unsigned int solve(PETScWrappers::MPI::Vector &,
+                       const PETScWrappers::MPI::Vector &,
+                       const double) const;
+
+  private:
+    void clear();
+
+    Mat matrix;
+    Vec x;
+    Vec b;
+    KSP ksp;
+  };
+
+  /*! \brief FGMRES with a PCFIELDSPLIT Schur complement preconditioner on a
+   * 2x2 PETSc block matrix.
+   *
+   * The blocks are wrapped in a MatNest, and the vectors in VecNests of their
+   * blocks, so nothing is copied and the whole solve runs in PETSc. The
+   * factorization is the upper triangular one of the block preconditioners
+   * of the fluid solvers. The Schur complement split is either
+   * preconditioned with a user matrix, or its inverse is replaced by a
+   * function through a PCSHELL, so the existing approximations can be used.
+   *
+   * The sub-solvers are configured with default options under the prefix,
+   * e.g. fieldsplit_0_pc_type, which are only set if they are not given on
+   * the command line. So any of them can be changed at run time, e.g. with
+   * -fluid_fieldsplit_0_pc_type gamg.
+   */
+  class FieldSplitSolver
+  {
+  public:
+    /// The approximate inverse of the Schur complement, dst = S^{-1} src.
+    using SchurInverse =
+      std::function<void(PETScWrappers::MPI::Vector &,
+                         const PETScWrappers::MPI::Vector &)>;
+
+    FieldSplitSolver(const std::string &,
+                     const std::map<std::string, std::string> &);
+    FieldSplitSolver(const FieldSplitSolver &) = delete;
+    FieldSplitSolver &operator=(const FieldSplitSolver &) = delete;
+    ~FieldSplitSolver();
+
+    /*! \brief Set up the solver for a matrix.
+     *
+     * The Schur complement split is preconditioned with schur_matrix if it
+     * is not null, or with schur_inverse if it is set, otherwise with the
+     * (1, 1) block. The matrices must stay alive, and are used with their
+     * values at the time of every solve.
+     */
+    void initialize(const PETScWrappers::MPI::BlockSparseMatrix &,
+                    const std::vector<IndexSet> &,
+                    const PETScWrappers::MPI::SparseMatrix *,
+                    const SchurInverse &schur_inverse = SchurInverse());
+
+    /*! \brief Solve with a zero initial guess to an absolute tolerance, and
+     *  return the number of iterations and the residual.
+     *
+     *  If the preconditioner is reused, the one set up in an earlier solve
+     *  is applied, even if the values of the matrices have changed since.
+     */
+    std::pair<unsigned int, double>
+    solve(PETScWrappers::MPI::BlockVector &,
+          const PETScWrappers::MPI::BlockVector &,
+          const double,
+          const bool reuse_preconditioner);
+
+  private:
+    void clear();
+
+    static PetscErrorCode apply_schur_inverse(PC, Vec, Vec);
+
+    const std::string prefix;
+    const std::map<std::string, std::string> default_options;
+    Mat matrix;
+    KSP ksp;
+    SchurInverse schur_inverse;
+    PETScWrappers::MPI::Vector schur_src;
+    PETScWrappers::MPI::Vector schur_dst;
+    /// Whether the shell has to be installed after the next setup.
+    bool shell_pending;
+  };
+
+  /*! \brief UMFPACK LU factorization that keeps the symbolic analysis.
+   *
+   * SparseDirectUMFPACK redoes the column ordering and the symbolic
+   * factorization every time it is initialized, although they only depend on
+   * the sparsity pattern. This class does them at the first update after
+   * clear(), and the later updates with a matrix of the same sparsity pattern
+   * only redo the numerical factorization, or keep the stale one if asked to.
+   */
+  class UMFPACKFactorization : public Subscriptor
+  {
+  public:
+    UMFPACKFactorization();
+    ~UMFPACKFactorization();
+    UMFPACKFactorization(const UMFPACKFactorization &) = delete;
+    UMFPACKFactorization &operator=(const UMFPACKFactorization &) = delete;
+
+    /**
+     * Factorize the matrix, unless there is a factorization already and
+     * keep_stale is true. The matrix must have the same sparsity pattern as
+     * in the last call, otherwise clear() must be called first. Returns
+     * whether the matrix is factorized.
+     */
+    bool update(const SparseMatrix<double> &matrix,
+                const bool keep_stale = false);
+
+    /// Free the factorization and the symbolic analysis.
+    void clear();
+
+    /// Whether there is no factorization.
+    bool empty() const { return numeric == nullptr; }
+
+    /// Solve with the factorized matrix, dst = A^{-1} src.
+    void vmult(Vector<double> &dst, const Vector<double> &src) const;
+
+  private:
+    /// The opaque symbolic and numeric objects of UMFPACK.
+    void *symbolic;
+    void *numeric;
+
+    /**
+     * The matrix in compressed row storage with sorted column indices, which
+     * UMFPACK is given as the compressed column storage of the transpose.
+     */
+    std::vector<long int> Ap;
+    std::vector<long int> Ai;
+    std::vector<double> Ax;
+
+    /// The position in Ax of every entry of the matrix in the order of the
+    /// matrix iterators, so that the values are copied without sorting.
+    std::vector<long int> positions;
+
+    std::vector<double> control;
+  };
+} // namespace Utils
+
+#endif
@@ -1,26 +1,260 @@
 #ifndef UTILITIES
 #define UTILITIES
 
+#include <deal.II/base/array_view.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/thread_local_storage.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/dofs/dof_renumbering.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/grid/grid_refinement.h>
 #include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/grid_tools_cache.h>
 #include <deal.II/grid/manifold_lib.h>
 #include <deal.II/grid/tria.h>
 #include <deal.II/grid/tria_accessor.h>
 #include <deal.II/grid/tria_iterator.h>
+#include <deal.II/lac/block_sparsity_pattern.h>
 #include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/full_matrix.h>
 #include <deal.II/lac/petsc_block_vector.h>
+#include <deal.II/lac/vector.h>
+#ifdef OPENIFEM_WITH_TRILINOS
+#include <deal.II/lac/trilinos_parallel_block_vector.h>
+#include <deal.II/lac/trilinos_vector.h>
+#endif
 #include <deal.II/numerics/vector_tools.h>
 
-#include <queue>
-#include <unordered_set>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
 
 namespace Utils
 {
   using namespace dealii;
 
-  /// This class manages simulation time and output frequency.
+  /*! \brief Renumber the dofs for locality, before the block or subdomain
+   *  renumbering which keeps the order within the blocks or subdomains.
+   *
+   *  cuthill_mckee minimizes the bandwidth, hierarchical follows the order of
+   *  the cells on the space filling curve of the mesh, and none keeps the
+   *  order of distribute_dofs. With a distributed mesh, only the dofs of
+   *  every process are renumbered among themselves. default is the ordering
+   *  that the dof handler had before the option, the last argument.
+   */
+  template <typename DoFHandlerType>
+  void renumber_dofs(DoFHandlerType &dof_handler,
+                     const std::string &option,
+                     const std::string &default_method = "cuthill_mckee")
+  {
+    const std::string &method = option == "default" ? default_method : option;
+    if (method == "cuthill_mckee")
+      {
+        DoFRenumbering::Cuthill_McKee(dof_handler);
+      }
+    else if (method == "hierarchical")
+      {
+        DoFRenumbering::hierarchical(dof_handler);
+      }
+    else
+      {
+        AssertThrow(method == "none", ExcNotImplemented());
+      }
+  }
+
+  /*! \brief The locally owned active cells sorted by their lowest dof, so
+   *  that the assembly loops visit the rows of the matrices in order.
+   */
+  template <typename DoFHandlerType>
+  std::vector<typename DoFHandlerType::active_cell_iterator>
+  cells_in_dof_order(const DoFHandlerType &dof_handler)
+  {
+    using Iterator = typename DoFHandlerType::active_cell_iterator;
+    std::vector<std::pair<types::global_dof_index, Iterator>> keyed;
+    std::vector<types::global_dof_index> dof_indices;
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        if (!cell->is_locally_owned())
+          {
+            continue;
+          }
+        dof_indices.resize(cell->get_fe().dofs_per_cell);
+        cell->get_dof_indices(dof_indices);
+        keyed.emplace_back(
+          *std::min_element(dof_indices.begin(), dof_indices.end()), cell);
+      }
+    // Stable, so that the cells with the same lowest dof stay in mesh order.
+    std::stable_sort(keyed.begin(),
+                     keyed.end(),
+                     [](const std::pair<types::global_dof_index, Iterator> &a,
+                        const std::pair<types::global_dof_index, Iterator> &b) {
+                       return a.first < b.first;
+                     });
+    std::vector<Iterator> cells;
+    cells.reserve(keyed.size());
+    for (const auto &k : keyed)
+      {
+        cells.push_back(k.second);
+      }
+    return cells;
+  }
+
+  /*! \brief The boundary faces that an assembly integrates over, listed by
+   *  active cell.
+   *
+   *  The faces of all the active cells are tested once per mesh, so that the
+   *  assembly loops go straight to the selected faces of a cell instead of
+   *  testing all of its faces in every assembly. The list must be made again
+   *  whenever the mesh changes.
+   */
+  class BoundaryFaceList
+  {
+  public:
+    struct Face
+    {
+      unsigned int face;
+      types::boundary_id boundary_id;
+    };
+
+    /// List the boundary faces for which select(boundary id) is true.
+    template <int dim, int spacedim>
+    void reinit(const Triangulation<dim, spacedim> &triangulation,
+                const std::function<bool(const types::boundary_id)> &select)
+    {
+      offsets.assign(1, 0);
+      offsets.reserve(triangulation.n_active_cells() + 1);
+      faces.clear();
+      for (const auto &cell : triangulation.active_cell_iterators())
+        {
+          if (cell->at_boundary())
+            {
+              for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell;
+                   ++f)
+                {
+                  if (cell->face(f)->at_boundary() &&
+                      select(cell->face(f)->boundary_id()))
+                    {
+                      faces.push_back({f, cell->face(f)->boundary_id()});
+                    }
+                }
+            }
+          offsets.push_back(faces.size());
+        }
+    }
+
+    /// The selected faces of the active cell with the index.
+    ArrayView<const Face> operator()(const unsigned int active_cell_index) const
+    {
+      AssertIndexRange(active_cell_index + 1, offsets.size());
+      return ArrayView<const Face>(faces.data() + offsets[active_cell_index],
+                                   offsets[active_cell_index + 1] -
+                                     offsets[active_cell_index]);
+    }
+
+  private:
+    /// The faces of the active cell i are faces[offsets[i], offsets[i + 1]).
+    std::vector<unsigned int> offsets;
+    std::vector<Face> faces;
+  };
+
+  /*! \brief The inverse Jacobians, JxW values and quadrature points of the
+   *  locally owned cells, for the assembly on a fixed mesh.
+   *
+   *  The MappingQ1 is evaluated at the quadrature points of every locally
+   *  owned cell once, and the results are stored in flat arrays, so that an
+   *  assembly only maps the reference shape gradients with the stored
+   *  inverse Jacobians instead of evaluating the mapping again in every
+   *  reinit. The cache is only filled if it fits the memory budget on every
+   *  process, and it must be cleared whenever the mesh changes.
+   */
+  template <int dim>
+  class CellGeometryCache
+  {
+  public:
+    /*! \brief Fill the cache for the locally owned cells at the quadrature
+     *  points if it takes at most budget MB on every process, otherwise
+     *  leave it empty. This is collective.
+     */
+    void reinit(const DoFHandler<dim> &,
+                const Quadrature<dim> &,
+                const double budget,
+                const MPI_Comm &);
+
+    /// Drop the cache, so that reinit has to be called again.
+    void clear();
+
+    /// Whether reinit has been called since the last clear.
+    bool is_initialized() const { return initialized; }
+
+    /// Whether the cell with the active cell index is cached.
+    bool is_cached(const unsigned int active_cell_index) const
+    {
+      return active_cell_index < positions.size() &&
+             positions[active_cell_index] != numbers::invalid_unsigned_int;
+    }
+
+    /// The inverse Jacobians \f$\partial\xi_e/\partial{x_d}\f$ of a
+    /// cached cell at its quadrature points.
+    ArrayView<const Tensor<2, dim>>
+    inverse_jacobians(const unsigned int active_cell_index) const
+    {
+      return make_array_view(inverse_jacobian_values, active_cell_index);
+    }
+
+    /// The JxW values of a cached cell.
+    ArrayView<const double> JxW(const unsigned int active_cell_index) const
+    {
+      return make_array_view(JxW_values, active_cell_index);
+    }
+
+    /// The quadrature points of a cached cell.
+    ArrayView<const Point<dim>>
+    quadrature_points(const unsigned int active_cell_index) const
+    {
+      return make_array_view(quadrature_point_values, active_cell_index);
+    }
+
+    std::size_t memory_consumption() const;
+
+  private:
+    template <typename T>
+    ArrayView<const T> make_array_view(const std::vector<T> &values,
+                                       const unsigned int index) const
+    {
+      Assert(is_cached(index), ExcMessage("The cell is not cached!"));
+      return ArrayView<const T>(values.data() + positions[index] * n_q_points,
+                                n_q_points);
+    }
+
+    bool initialized = false;
+    unsigned int n_q_points = 0;
+    /// The position of every active cell in the arrays, invalid if it is
+    /// not cached.
+    std::vector<unsigned int> positions;
+    std::vector<Tensor<2, dim>> inverse_jacobian_values;
+    std::vector<double> JxW_values;
+    std::vector<Point<dim>> quadrature_point_values;
+  };
+
+  /*! \brief This class manages simulation time and output frequency.
+   *
+   * By default the time step size is fixed, and the output, refinement and
+   * save times are counted in steps. With adaptive time stepping the step
+   * sizes are set by adapt_delta_t, and these times are found from the
+   * current time instead: a step is shortened so that it ends exactly at the
+   * next output, refinement or save time, or at the end time, and it is time
+   * to output, for instance, if the last step has reached a multiple of the
+   * output interval.
+   */
   class Time
   {
   public:
@@ -31,11 +265,17 @@ namespace Utils
          const double save_interval)
       : timestep(0),
         time_current(0.0),
+        time_previous(0.0),
         delta_t(delta_t),
         time_end(time_end),
         output_interval(output_interval),
         refinement_interval(refinement_interval),
-        save_interval(save_interval)
+        save_interval(save_interval),
+        is_adaptive(false),
+        min_delta_t(delta_t),
+        max_delta_t(delta_t),
+        max_growth(1.0),
+        nominal_delta_t(delta_t)
     {
     }
     double current() const { return time_current; }
@@ -48,16 +288,410 @@ namespace Utils
     void increment();
     void set_delta_t(double delta);
 
+    /// The position of the time stepping, which rewind goes back to.
+    struct State
+    {
+      unsigned int timestep;
+      double time_current;
+      double time_previous;
+      double delta_t;
+      double nominal_delta_t;
+    };
+    State state() const;
+
+    /// Go back to a state, e.g. to repeat the steps taken since.
+    void rewind(const State &);
+
+    /// Move to a state, which may also be later than the current one, e.g.
+    /// the start of a time slice of Parareal.
+    void set_state(const State &);
+
+    /*! \brief Switch to adaptive time stepping.
+     *
+     *  The step sizes are bounded by the minimum and the maximum, and a step
+     *  can be at most the growth factor times larger than the previous one.
+     *  The current step size is the initial one, which is shortened if it
+     *  goes over the first output, refinement or save time.
+     */
+    void set_adaptive(const double min_delta,
+                      const double max_delta,
+                      const double growth);
+    bool adaptive() const { return is_adaptive; }
+
+    /*! \brief Set the size of the next step with adaptive time stepping.
+     *
+     *  The first argument is an upper limit of the step size, e.g. from the
+     *  stability of the solvers, and the second one is a factor on the
+     *  previous (not shortened) step size, e.g. from the convergence of the
+     *  solvers. Both of them are ignored if they are infinite. The step is
+     *  then shortened to end at the next output, refinement or save time if
+     *  needed, and split in two equal steps if it would otherwise leave a
+     *  sliver before this time. Returns the new step size.
+     */
+    double
+    adapt_delta_t(const double limit,
+                  const double factor = std::numeric_limits<double>::max());
+
   private:
+    /// Whether the last step has reached a multiple of an interval.
+    bool reached(const double interval) const;
+
+    /// The earliest output, refinement, save or end time after the current
+    /// time.
+    double next_event() const;
+
+    /// Shorten delta_t so that it does not go over next_event.
+    void land_on_event();
+
     unsigned int timestep;
     double time_current;
+    double time_previous;
     double delta_t;
     const double time_end;
     const double output_interval;
     const double refinement_interval;
     const double save_interval;
+    bool is_adaptive;
+    double min_delta_t;
+    double max_delta_t;
+    double max_growth;
+    // The step size before it is shortened by land_on_event, which the next
+    // step sizes are relative to.
+    double nominal_delta_t;
+  };
+
+  /*! \brief The Eisenstat-Walker forcing terms of an inexact Newton method.
+   *
+   * The linear system of a Newton iteration is solved to the relative
+   * tolerance \f$\eta_k\f$ rather than a fixed one. The first forcing term of
+   * a nonlinear solve is the maximum, and the next ones follow the
+   * convergence of the nonlinear residual, choice 2 of S. C. Eisenstat and
+   * H. F. Walker, Choosing the forcing terms in an inexact Newton method,
+   * SIAM J. Sci. Comput. 17 (1996) 16-32:
+   * \f$\eta_k = \gamma (\|F_k\| / \|F_{k-1}\|)^\alpha\f$, which is not
+   * allowed to drop much faster than the previous one. The solvers keep
+   * their fixed tolerance as the lower bound.
+   */
+  class ForcingTerm
+  {
+  public:
+    ForcingTerm(const double eta_max,
+                const double gamma = 0.9,
+                const double alpha = 2.0)
+      : eta_max(eta_max),
+        gamma(gamma),
+        alpha(alpha),
+        eta(eta_max),
+        previous_residual(0)
+    {
+    }
+
+    /// Start a new nonlinear solve.
+    void reset() { previous_residual = 0; }
+
+    /// The forcing term of the iteration with the residual norm.
+    double next(const double residual);
+
+  private:
+    const double eta_max;
+    const double gamma;
+    const double alpha;
+    double eta;
+    double previous_residual; //!< 0 at the first iteration.
   };
 
+  /*! \brief Backtracking line search on the residual norm.
+   *
+   * residual(step) moves the iterate to the last one plus step times the
+   * Newton update, and returns the residual norm there. The step is halved,
+   * at most max_steps times, until the residual decreases sufficiently
+   * compared to initial_residual, the last one, and the linear system was
+   * solved to the relative tolerance eta. Returns the accepted step, the
+   * iterate is left at it.
+   */
+  double line_search(const std::function<double(const double)> &residual,
+                     const double initial_residual,
+                     const double eta,
+                     const unsigned int max_steps);
+
+  /*! \brief Single-pass Newmark updates of the solid solvers.
+   *
+   * The predictors and correctors of the Newmark method combine up to four
+   * vectors entry by entry. Each function here computes all of its outputs
+   * in one pass over the locally owned entries, instead of one pass per
+   * vector operation, and the correctors copy the new state into the
+   * previous one in the same pass. The vectors are Vector<double> or
+   * PETScWrappers::MPI::Vector without ghosts, all of the same partitioning.
+   */
+  class NewmarkUpdate
+  {
+  public:
+    NewmarkUpdate(const double beta, const double gamma, const double dt)
+      : beta(beta), gamma(gamma), dt(dt)
+    {
+    }
+
+    /// The displacement predictor
+    /// \f$d_n + \Delta{t}v_n + (\frac{1}{2}-\beta)\Delta{t}^2a_n\f$.
+    template <typename VectorType>
+    void predict(VectorType &predicted_displacement,
+                 const VectorType &previous_displacement,
+                 const VectorType &previous_velocity,
+                 const VectorType &previous_acceleration) const;
+
+    /*! \brief The displacement and velocity predictors of the HHT-alpha
+     *  method, whose velocity and acceleration terms are scaled by
+     *  factor = 1 + alpha: \f$d_n + f\Delta{t}v_n +
+     *  f(\frac{1}{2}-\beta)\Delta{t}^2a_n\f$ and
+     *  \f$v_n + f(1-\gamma)\Delta{t}a_n\f$.
+     */
+    template <typename VectorType>
+    void predict(VectorType &predicted_displacement,
+                 VectorType &predicted_velocity,
+                 const VectorType &previous_displacement,
+                 const VectorType &previous_velocity,
+                 const VectorType &previous_acceleration,
+                 const double factor) const;
+
+    /*! \brief Given the new acceleration, compute the new velocity
+     *  \f$v_n + (1-\gamma)\Delta{t}a_n + \gamma\Delta{t}a\f$ and
+     *  displacement \f$d_n + \Delta{t}v_n +
+     *  (\frac{1}{2}-\beta)\Delta{t}^2a_n + \beta\Delta{t}^2a\f$, and
+     *  make them and the acceleration the previous state.
+     */
+    template <typename VectorType>
+    void correct(const VectorType &acceleration,
+                 VectorType &velocity,
+                 VectorType &displacement,
+                 VectorType &previous_acceleration,
+                 VectorType &previous_velocity,
+                 VectorType &previous_displacement) const;
+
+    /// Given the displacement and its predictor, compute the acceleration
+    /// \f$(d - \tilde{d})/(\beta\Delta{t}^2)\f$ and the velocity.
+    template <typename VectorType>
+    void correct_from_displacement(const VectorType &displacement,
+                                   const VectorType &predicted_displacement,
+                                   VectorType &acceleration,
+                                   VectorType &velocity,
+                                   const VectorType &previous_acceleration,
+                                   const VectorType &previous_velocity) const;
+
+    /// The same as above, and make the new state the previous one.
+    template <typename VectorType>
+    void correct_from_displacement(const VectorType &displacement,
+                                   const VectorType &predicted_displacement,
+                                   VectorType &acceleration,
+                                   VectorType &velocity,
+                                   VectorType &previous_acceleration,
+                                   VectorType &previous_velocity,
+                                   VectorType &previous_displacement) const;
+
+  private:
+    const double beta;
+    const double gamma;
+    const double dt;
+  };
+
+  /*! \brief Acceleration of the fixed-point iterations of a partitioned
+   *  coupling.
+   *
+   * A coupling iteration maps an interface quantity \f$x\f$, e.g. the fluid
+   * traction given to the solid, to \f$H(x)\f$, the one that the fluid
+   * returns. The next input is found from the residuals \f$r = H(x) - x\f$
+   * with either the dynamic Aitken relaxation of U. Kuttler and W. A. Wall,
+   * Fixed-point fluid-structure interaction solvers with dynamic relaxation,
+   * Comput. Mech. 43 (2008) 61-72, or the interface quasi-Newton method
+   * with a least-squares model of the inverse Jacobian (IQN-ILS) of J.
+   * Degroote et al., Comput. Struct. 87 (2009) 793-801, which is built from
+   * the differences of the residuals and the outputs since the first
+   * iteration of the time step. The vectors are replicated on every
+   * process, and so is the work.
+   */
+  class CouplingAccelerator
+  {
+  public:
+    /// The method is aitken or iqn-ils, and the first iteration of a time
+    /// step is relaxed with the initial relaxation either way.
+    CouplingAccelerator(const std::string &method,
+                        const double initial_relaxation,
+                        const unsigned int max_columns = 20);
+
+    /// Start the iterations of a new time step.
+    void reset();
+
+    /// Set the next input from the input and the output of an iteration,
+    /// and return the residual norm relative to the output.
+    double next(const Vector<double> &input,
+                const Vector<double> &output,
+                Vector<double> &next_input);
+
+  private:
+    const std::string method;
+    const double initial_relaxation;
+    const unsigned int max_columns;
+    unsigned int iteration;
+    double relaxation;
+    Vector<double> previous_residual;
+    Vector<double> previous_output;
+    /// The differences of the residuals and of the outputs of IQN-ILS,
+    /// latest first.
+    std::deque<Vector<double>> residual_differences;
+    std::deque<Vector<double>> output_differences;
+  };
+
+  /*! \brief A cache of the distributed sparsity patterns of a block system.
+   *
+   * Building the sparsity patterns, distributing them and computing the mmult
+   * patterns are expensive in 3D, although they only depend on the mesh, the
+   * partitioning and the constraints. The cache keeps the locally owned rows
+   * of the patterns along with a key of that state, which the caller
+   * computes, so that a system which is set up again for the same key only
+   * copies the rows back. The rows can be saved with a checkpoint and loaded
+   * when restarting from it on the same number of processes.
+   */
+  class SparsityCache
+  {
+  public:
+    /// Whether the cache holds the patterns of this key.
+    bool matches(const std::vector<unsigned long long> &) const;
+
+    /**
+     * Store the locally owned rows of the patterns, which have the blocks of
+     * the partitioning, for a key. The rows are given in the numbering of
+     * the blocks.
+     */
+    void store(const std::vector<unsigned long long> &,
+               const std::vector<IndexSet> &,
+               const std::vector<const BlockDynamicSparsityPattern *> &);
+
+    /// Add the stored rows of a pattern to a pattern of the same blocks.
+    void restore(const unsigned int,
+                 const std::vector<IndexSet> &,
+                 BlockDynamicSparsityPattern &) const;
+
+    /// Write the key and the rows to a file of this process.
+    void save(const std::string &) const;
+
+    /// Read a file written by save(), or clear the cache if there is none.
+    void load(const std::string &);
+
+    void clear();
+
+    std::size_t memory_consumption() const;
+
+  private:
+    std::vector<unsigned long long> key;
+    unsigned int n_patterns = 0;
+    unsigned int n_blocks = 0;
+    /// The row offsets and the column indices of every block of every
+    /// pattern, in the order of the pattern, the block row and the block
+    /// column.
+    std::vector<std::vector<types::global_dof_index>> row_offsets;
+    std::vector<std::vector<types::global_dof_index>> columns;
+  };
+
+  /*! \brief A pool of preallocated distributed vectors with the layouts of
+   * the blocks of a partitioning.
+   *
+   * The preconditioners take their temporary vectors from the pool, so that
+   * no vector is created in the inner loops of the Krylov solvers, which is
+   * collective in PETSc and Trilinos. The vectors of a block are only
+   * allocated when more of them are in use at the same time than ever
+   * before, so all of the processes must take and release them in the same
+   * order. The vectors are not zeroed when they are taken.
+   */
+  template <typename VectorType>
+  class GenericVectorPool : public Subscriptor
+  {
+  public:
+    /// Take a vector of a block from the pool for the lifetime of a Handle.
+    class Handle
+    {
+    public:
+      Handle(GenericVectorPool &, const unsigned int);
+      Handle(const Handle &) = delete;
+      Handle &operator=(const Handle &) = delete;
+      ~Handle();
+
+      VectorType &operator*() const { return *vector; }
+      VectorType *operator->() const { return vector; }
+
+    private:
+      GenericVectorPool &pool;
+      const unsigned int block;
+      VectorType *vector;
+    };
+
+    /// Free all of the vectors and set the layouts of the blocks.
+    void reinit(const std::vector<IndexSet> &, const MPI_Comm &);
+
+  private:
+    std::vector<IndexSet> partitioning;
+    MPI_Comm mpi_communicator;
+    // The vectors of every block, and the ones that are not in use.
+    std::vector<std::vector<std::unique_ptr<VectorType>>> vectors;
+    std::vector<std::vector<VectorType *>> available;
+  };
+
+  /// The pool of the PETSc solvers.
+  using VectorPool = GenericVectorPool<PETScWrappers::MPI::Vector>;
+
+  /*! \brief Localized copies of PETSc vectors, kept once per node.
+   *
+   * Rather than every process localizing the vectors in full, the processes
+   * of a node share one copy in an MPI-3 shared memory window: every process
+   * writes its locally owned entries to it, and the first process of every
+   * node then sums the windows of all of the nodes, whose entries are zero
+   * except for the ones owned on the node. The vectors are only localized
+   * again if one of them has changed since the last time.
+   */
+  class NodeSharedVectors
+  {
+  public:
+    NodeSharedVectors(const MPI_Comm &);
+    NodeSharedVectors(const NodeSharedVectors &) = delete;
+    NodeSharedVectors &operator=(const NodeSharedVectors &) = delete;
+    ~NodeSharedVectors();
+
+    /// Localize vectors of the same layout, this is collective.
+    void localize(const std::vector<const PETScWrappers::MPI::Vector *> &);
+
+    /// The entries of a vector of the last localize.
+    ArrayView<const double> operator[](const unsigned int) const;
+
+  private:
+    /// Free the window, and allocate one for n_vectors of the size.
+    void allocate(const unsigned int n_vectors, const std::size_t size);
+
+    /// Make the writes of all the processes of the node visible.
+    void synchronize() const;
+
+    const MPI_Comm mpi_communicator;
+    MPI_Comm node_communicator;
+    MPI_Comm leader_communicator; //!< MPI_COMM_NULL except on the leaders.
+    MPI_Win window;
+    double *data;
+    unsigned int n_vectors;
+    std::size_t vector_size;
+    // The vectors of the last localize and their PETSc object states.
+    std::vector<Vec> last_vectors;
+    std::vector<PetscObjectState> last_states;
+  };
+
+  /*! \brief The rigid body modes of a vector-valued FE_Q field, i.e. the
+   * spacedim translations and the rotations about the coordinate axes at the
+   * support points, on the locally owned dofs.
+   *
+   * They span the nullspace of the elastic stiffness without boundary
+   * conditions, and are used as the near nullspace of the solid AMG.
+   */
+  template <int dim, int spacedim>
+  std::vector<PETScWrappers::MPI::Vector>
+  rigid_body_modes(const DoFHandler<dim, spacedim> &,
+                   const IndexSet &,
+                   const MPI_Comm &);
+
   /*! \brief A helper class to generate triangulations and specify boundary ids.
    *
    *  dealii::GridGenerator can be used to generate a few standard grids such as
@@ -83,6 +717,26 @@ namespace Utils
      *  the cylindrical surface is marked with boundary id 4 in 2d and 6 in 3d.
      */
     static void flow_around_cylinder(Triangulation<dim> &);
+    /*! \brief The same mesh for a distributed triangulation.
+     *
+     *  The coarse mesh is only generated on the root process, which is the
+     *  expensive part because of the removal and merging of the cells, and
+     *  broadcast to the others. The manifolds and boundary ids are then set
+     *  on every process, which gives the same mesh as the serial version.
+     */
+    static void
+    flow_around_cylinder(parallel::distributed::Triangulation<dim> &);
+    /*! \brief Read a Gmsh mesh into a distributed triangulation.
+     *
+     *  Only the root process parses the file, and broadcasts the vertices,
+     *  the cells with their material ids and the boundary faces with their
+     *  ids in binary, so the other processes skip the text parsing and the
+     *  consistent orientation of the cells, which dominate the startup with
+     *  large meshes. p4est keeps the coarse mesh on every process, so it is
+     *  still replicated there. Manifolds have to be attached by the caller.
+     */
+    static void read_msh(parallel::distributed::Triangulation<dim> &,
+                         const std::string &);
     /*! \brief Generate a nice mesh for a sphere.
      *
      * Adapted from [dealii tutorials step-6]
@@ -100,6 +754,20 @@ namespace Utils
     /// A helper function used by flow_around_cylinder.
     static void flow_around_cylinder_2d(Triangulation<2> &,
                                         bool compute_in_2d = true);
+    /// The cells of flow_around_cylinder_2d without the manifolds.
+    static void flow_around_cylinder_2d_cells(Triangulation<2> &,
+                                              bool compute_in_2d);
+    /// The manifolds of flow_around_cylinder_2d.
+    static void flow_around_cylinder_2d_manifolds(Triangulation<2> &);
+    /// Set the boundary ids of flow_around_cylinder.
+    static void flow_around_cylinder_boundary_ids(Triangulation<dim> &);
+    /*! \brief Create a triangulation from the coarse cells of another one on
+     *  the root process, only the vertices, the cells and their material ids
+     *  and the boundary ids of the faces are copied.
+     */
+    static void broadcast_coarse_mesh(const Triangulation<dim> &,
+                                      Triangulation<dim> &,
+                                      const MPI_Comm &);
   };
 
   /*! \brief Interpolate the solution value or gradient at an arbitrary point.
@@ -123,9 +791,13 @@ namespace Utils
                      const Point<dim> &,
                      const std::vector<bool> &mask = {},
                      const typename DoFHandler<dim>::active_cell_iterator &
-                       cell = typename DoFHandler<dim>::active_cell_iterator());
+                       cell = typename DoFHandler<dim>::active_cell_iterator(),
+                     const Mapping<dim> *deformed_mapping = nullptr);
     void point_value(const VectorType &,
                      Vector<typename VectorType::value_type> &);
+    /// The same with the entries of a localized vector, e.g. a shared one.
+    void point_value(const ArrayView<const typename VectorType::value_type> &,
+                     Vector<typename VectorType::value_type> &);
     void point_gradient(
       const VectorType &,
       std::vector<Tensor<1, dim, typename VectorType::value_type>> &);
@@ -137,16 +809,134 @@ namespace Utils
     const DoFHandler<dim> &dof_handler;
     const Point<dim> &point;
     bool cell_found;
-    MappingQ1<dim> mapping;
+    MappingQ1<dim> q1_mapping;
+    /// The mapping of a deformed configuration, nullptr to use q1_mapping.
+    const Mapping<dim> *deformed_mapping;
     std::pair<typename DoFHandler<dim>::active_cell_iterator, Point<dim>>
       cell_point;
+
+    const Mapping<dim> &mapping() const
+    {
+      return deformed_mapping ? *deformed_mapping : q1_mapping;
+    }
+  };
+
+  /*! \brief Evaluate a distributed finite element field at many points.
+   *
+   * Interpolating at every point with a GridInterpolator means one global
+   * search of the mesh per point. This class instead locates all the points
+   * once in reinit(), then values and gradients can be evaluated in bulk as
+   * many times as needed.
+   *
+   * Every process is expected to pass the same list of points (e.g. the
+   * vertices of the shared solid mesh). Each process only searches its
+   * locally owned cells, in the Morton order of the points and starting from
+   * the cell of the previous point, and
+   * the points are grouped by cells so that one FEValues evaluates all of
+   * the points in a cell. A point that is found by more than one process
+   * (e.g. on the interface between subdomains) is assigned to the lowest
+   * rank through a single reduction, so the evaluated values can be simply
+   * summed up over the processes.
+   *
+   * If the mesh does not change but the points move, update() can be used
+   * instead of reinit(): a point that stays in its cell only gets new unit
+   * coordinates, and only the points that left their cells are searched
+   * again, starting from the cells they were in. clear() must be called
+   * when the mesh changes.
+   */
+  template <int dim, typename VectorType>
+  class PointEvaluator
+  {
+  public:
+    typedef typename VectorType::value_type Number;
+
+    PointEvaluator(const DoFHandler<dim> &);
+
+    /// Locate the points, this is collective.
+    void reinit(const std::vector<Point<dim>> &, const MPI_Comm &);
+
+    /*! \brief Relocate the moved points, this is collective.
+     *
+     * The number and the order of the points must be the same as in the last
+     * reinit(), which is called instead if there was none after clear().
+     */
+    void update(const std::vector<Point<dim>> &, const MPI_Comm &);
+
+    /// Forget the located points, e.g. when the mesh is refined.
+    void clear();
+
+    /*! \brief Evaluate the values and gradients of all the components at the
+     * points owned by this process, zeros are given at the other points.
+     */
+    void evaluate(const VectorType &,
+                  std::vector<Vector<Number>> &,
+                  std::vector<std::vector<Tensor<1, dim, Number>>> &) const;
+
+    /// Evaluate the values only.
+    void evaluate(const VectorType &, std::vector<Vector<Number>> &) const;
+
+    /// Whether a point is owned by this process.
+    bool is_owned(const unsigned int i) const { return owned[i]; }
+
+    /// Number of points that are not found by any process.
+    unsigned int n_missing_points() const { return n_missing; }
+
+  private:
+    void evaluate(const VectorType &,
+                  std::vector<Vector<Number>> *,
+                  std::vector<std::vector<Tensor<1, dim, Number>>> *) const;
+
+    /// Mark the locally owned vertices and compute their bounding box.
+    void setup_search();
+
+    /// Search a point in the locally owned cells, return whether it is found.
+    bool locate(const Point<dim> &,
+                typename Triangulation<dim>::active_cell_iterator &hint,
+                typename DoFHandler<dim>::active_cell_iterator &,
+                Point<dim> &) const;
+
+    /*! \brief Reduce the owners of the points, where n_ranks means not found,
+     * and group the owned points by their cells.
+     */
+    void assign(std::vector<unsigned int> &, const MPI_Comm &);
+
+    const DoFHandler<dim> &dof_handler;
+    MappingQ1<dim> mapping;
+    /// Accelerates the search and gets updated when the mesh changes.
+    GridTools::Cache<dim> cache;
+    unsigned int n_points;
+    unsigned int n_missing;
+    std::vector<bool> owned;
+    /// Vertices of the locally owned cells and their bounding box
+    std::vector<bool> marked_vertices;
+    Point<dim> lower, upper;
+    bool has_owned_cells;
+    /// The cell and the unit coordinates of every point found locally
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> point_cells;
+    std::vector<Point<dim>> point_unit_points;
+    /// Locally owned cells that contain at least one owned point
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+    /// Indices and the unit coordinates of the points in each of the cells
+    std::vector<std::vector<unsigned int>> cell_point_indices;
+    std::vector<std::vector<Point<dim>>> cell_unit_points;
   };
 
+  template <int dim>
+  class SPHSourceCells;
+
+  template <int dim, typename VectorType>
+  class SPHPointEvaluator;
+
   template <int dim, typename VectorType>
   class SPHInterpolator
   {
   public:
+    /// Collect the sources by looping over all of the locally owned cells.
     SPHInterpolator(const DoFHandler<dim> &, const Point<dim> &);
+    /// Collect the sources from the cells binned near the target point.
+    SPHInterpolator(const DoFHandler<dim> &,
+                    const Point<dim> &,
+                    const SPHSourceCells<dim> &);
     void point_value(const VectorType &,
                      Vector<typename VectorType::value_type> &);
     void point_gradient(
@@ -167,26 +957,376 @@ namespace Utils
       std::pair<typename DoFHandler<dim>::active_cell_iterator, double>>
       sources;
 
-    double cubic_spline(const Point<dim> &, const Point<dim> &, double);
+    static double cubic_spline(const Point<dim> &, const Point<dim> &, double);
+
+    friend class SPHPointEvaluator<dim, VectorType>;
   };
 
+  /*! \brief The order of points along a Morton (Z-order) curve through their
+   * bounding box.
+   *
+   * The coordinates are quantized to 64 / dim bits, whose interleaved bits
+   * give the position along the curve. Consecutive points in this order are
+   * mostly close to each other, so a search that starts from the cell of the
+   * previous point takes a step or two, and touches the cells that the
+   * previous searches just brought into cache.
+   */
+  template <int dim>
+  std::vector<unsigned int> morton_order(const std::vector<Point<dim>> &);
+
+  /*! \brief Locate the cells that contain arbitrary points.
+   *
+   * The search is a breadth first search from a hint cell, typically the cell
+   * found for the same point in the last time step. The active neighbors of
+   * all cells are precomputed into an adjacency table indexed by
+   * active_cell_index(), and the visited cells are marked with an epoch
+   * counter, so a search does not allocate. One instance is meant to be
+   * reused for many points as long as the topology of the mesh does not
+   * change, reinit() must be called otherwise. Moving the vertices is fine.
+   */
   template <int dim, typename MeshType>
   class CellLocator
   {
   public:
-    CellLocator(DoFHandler<dim> &,
-                const Point<dim> &,
-                const typename MeshType::active_cell_iterator &);
-    // Use breadth first search from the hint to find and return the iterator
-    // of the cell where the point is inside.
-    const typename MeshType::active_cell_iterator search();
+    CellLocator(const MeshType &);
+
+    /// Rebuild the adjacency table.
+    void reinit();
+
+    /*! \brief Search in a deformed configuration of the mesh, given by a
+     * mapping such as MappingQEulerian, instead of its vertices.
+     */
+    void set_mapping(const Mapping<dim> &);
+
+    /*! \brief Return the iterator of the cell where the point is inside.
+     *
+     * If the hint is the begin iterator, a global search is done instead of
+     * BFS. If the point is not found, an invalid iterator is returned and
+     * found_cell() returns false.
+     */
+    const typename MeshType::active_cell_iterator
+    search(const Point<dim> &,
+           const typename MeshType::active_cell_iterator &);
+
     bool found_cell() const { return cell_found; };
 
+    /// The number of searches, and of the cells tested by them, since the
+    /// last call to reset_statistics().
+    unsigned long n_searches() const { return searches; };
+    unsigned long n_bfs_steps() const { return bfs_steps; };
+    void reset_statistics()
+    {
+      searches = 0;
+      bfs_steps = 0;
+    };
+
   private:
-    DoFHandler<dim> &dof_handler;
-    const Point<dim> &point;
-    const typename MeshType::active_cell_iterator hint;
+    const MeshType &mesh;
+    MappingQ1<dim> mapping;
+    const Mapping<dim> *deformed_mapping; //!< nullptr unless it is set.
     bool cell_found;
+    unsigned long searches;
+    unsigned long bfs_steps;
+
+    /// Active cells ordered by active_cell_index()
+    std::vector<typename MeshType::active_cell_iterator> cells;
+
+    /// Compressed adjacency table: the active neighbors of cell i are
+    /// neighbors[neighbor_offsets[i]] to neighbors[neighbor_offsets[i+1]-1].
+    std::vector<unsigned int> neighbor_offsets;
+    std::vector<unsigned int> neighbors;
+
+    /// A cell is visited in the current search if visited[i] == epoch.
+    std::vector<unsigned int> visited;
+    unsigned int epoch;
+
+    /// Reusable BFS queue
+    std::vector<unsigned int> queue;
+
+    /// Check if a point is inside a cell with the deformed mapping.
+    bool inside_deformed(const typename MeshType::active_cell_iterator &,
+                         const Point<dim> &) const;
+  };
+
+  /*! \brief A bounding volume hierarchy of axis-aligned boxes.
+   *
+   * The tree is built once from the bounding boxes of a set of primitives
+   * (e.g. the boundary faces or the cells of the solid mesh) and is refitted
+   * bottom-up whenever the primitives move. Refitting keeps the topology,
+   * which is fine since the solid mesh deforms but is not re-meshed. Queries
+   * return the indices of the primitives whose boxes contain a point, so that
+   * the exact geometric test is only done on a few candidates.
+   */
+  template <int dim>
+  class AABBTree
+  {
+  public:
+    /// A box is represented by its lower and upper corners.
+    using Box = std::pair<Point<dim>, Point<dim>>;
+
+    /// Build the tree from the boxes of the primitives.
+    void build(const std::vector<Box> &);
+
+    /// Update the node boxes without changing the topology of the tree.
+    void refit(const std::vector<Box> &);
+
+    /// Collect the primitives whose boxes contain the point.
+    void point_query(const Point<dim> &, std::vector<unsigned int> &) const;
+
+    /*! \brief Collect the primitives whose boxes intersect the ray which
+     * starts at the given point and goes in the positive direction of the
+     * given axis.
+     */
+    void ray_query(const Point<dim> &,
+                   const unsigned int,
+                   std::vector<unsigned int> &) const;
+
+    /*! \brief Collect the primitives whose boxes intersect the region swept
+     * by the given box moving in the positive direction of the given axis.
+     *
+     * This is the union of the ray queries of all the points in the box,
+     * used to test a batch of nearby points at once.
+     */
+    void ray_query(const Box &,
+                   const unsigned int,
+                   std::vector<unsigned int> &) const;
+
+    /// Check if any of the primitive boxes overlaps the given box.
+    bool intersects(const Box &) const;
+
+    bool empty() const { return nodes.empty(); }
+
+    /// Compute the bounding box of a list of points.
+    static Box bounding_box(const std::vector<Point<dim>> &);
+
+    /// Check if a point is inside a box, ignoring the given axis if any.
+    static bool contains(const Box &,
+                         const Point<dim> &,
+                         const unsigned int skip_axis = dim);
+
+    /// Check if two boxes overlap, ignoring the given axis if any.
+    static bool overlap(const Box &,
+                        const Box &,
+                        const unsigned int skip_axis = dim);
+
+  private:
+    struct Node
+    {
+      Box box;
+      // Children of an internal node, invalid_unsigned_int for leaves.
+      unsigned int left;
+      unsigned int right;
+      // Range of the primitives that belong to this node in indices.
+      unsigned int begin;
+      unsigned int end;
+    };
+
+    unsigned int build_node(const unsigned int,
+                            const unsigned int,
+                            const std::vector<Box> &,
+                            const std::vector<Point<dim>> &);
+
+    static Box merge(const Box &, const Box &);
+
+    /// Maximum number of primitives in a leaf.
+    static const unsigned int leaf_size = 4;
+
+    /// The nodes are stored in pre-order, so children come after parents.
+    std::vector<Node> nodes;
+
+    /// Permutation of the primitives such that each leaf is contiguous.
+    std::vector<unsigned int> indices;
+
+    /// The boxes of the primitives in the permuted order.
+    std::vector<Box> leaf_boxes;
+  };
+
+  /*! \brief A uniform grid of buckets over a set of boxes, i.e., a cell-linked
+   * list.
+   *
+   * Every item (a cell, or a particle with its support) is stored in all the
+   * buckets that its box overlaps, and a query returns the items in the
+   * buckets that the query box overlaps, so the exact test is only done on
+   * candidates nearby. The extent of the grid is fixed by build(); items and
+   * queries outside of it are clamped to the border buckets, which keeps the
+   * results complete. When the items move, update() only moves the items
+   * that change buckets, which are few in a time step.
+   */
+  template <int dim>
+  class CellLinkedList
+  {
+  public:
+    /// A box is represented by its lower and upper corners.
+    using Box = std::pair<Point<dim>, Point<dim>>;
+
+    /*! \brief Build the grid over the boxes of the items.
+     *
+     * The bucket size defaults to the mean extent of the boxes, and is
+     * enlarged if there would be more buckets than 4 per item.
+     */
+    void build(const std::vector<Box> &, double bucket_size = 0);
+
+    /// Move the items to the buckets of their new boxes.
+    void update(const std::vector<Box> &);
+
+    /// Collect the candidate items for a box, each one once.
+    void query(const Box &, std::vector<unsigned int> &) const;
+
+    /// Collect the candidate items for a point, each one once.
+    void point_query(const Point<dim> &, std::vector<unsigned int> &) const;
+
+    bool empty() const { return ranges.empty(); }
+
+  private:
+    /// The first and the last buckets along each axis.
+    using Range = std::array<unsigned int, 2 * dim>;
+
+    Range bucket_range(const Box &) const;
+
+    unsigned int bucket_index(const std::array<unsigned int, dim> &) const;
+
+    void insert(const unsigned int, const Range &);
+
+    void remove(const unsigned int, const Range &);
+
+    Point<dim> origin;
+    double size;
+    std::array<unsigned int, dim> n_buckets;
+    /// The items in every bucket.
+    std::vector<std::vector<unsigned int>> buckets;
+    /// The buckets of every item.
+    std::vector<Range> ranges;
+  };
+
+  /*! \brief The locally owned cells binned by the supports of their kernels.
+   *
+   * The support of the kernel of a cell is a ball of radius 2h around its
+   * center, where h is its diameter. Shared by the SPHInterpolators of a
+   * mesh, reinit() has to be called whenever the mesh changes or moves.
+   */
+  template <int dim>
+  class SPHSourceCells
+  {
+  public:
+    void reinit(const DoFHandler<dim> &);
+
+    /// The cells whose kernel supports may contain a point.
+    void candidates(const Point<dim> &, std::vector<unsigned int> &) const;
+
+    const typename DoFHandler<dim>::active_cell_iterator &
+    cell(const unsigned int i) const
+    {
+      return cells[i];
+    }
+
+  private:
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+    CellLinkedList<dim> buckets;
+  };
+
+  /*! \brief SPH interpolation at many points.
+   *
+   * The batch counterpart of SPHInterpolator: reinit() collects the sources
+   * of all the points and groups them by the source cells, so that evaluate()
+   * reinitializes one FEValues per source cell and adds its value at the
+   * center to all the points it contributes to.
+   */
+  template <int dim, typename VectorType>
+  class SPHPointEvaluator
+  {
+  public:
+    typedef typename VectorType::value_type Number;
+
+    SPHPointEvaluator(const DoFHandler<dim> &);
+
+    void reinit(const std::vector<Point<dim>> &, const SPHSourceCells<dim> &);
+
+    /// Evaluate the values and gradients of all the components at the points.
+    void evaluate(const VectorType &,
+                  std::vector<Vector<Number>> &,
+                  std::vector<std::vector<Tensor<1, dim, Number>>> &) const;
+
+    /// Evaluate the values only.
+    void evaluate(const VectorType &, std::vector<Vector<Number>> &) const;
+
+  private:
+    void evaluate(const VectorType &,
+                  std::vector<Vector<Number>> *,
+                  std::vector<std::vector<Tensor<1, dim, Number>>> *) const;
+
+    const DoFHandler<dim> &dof_handler;
+    MappingQGeneric<dim> mapping;
+    unsigned int n_points;
+    /// Source cells that contribute to at least one point
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+    /// The points of every source cell, with the kernel value times volume
+    std::vector<std::vector<std::pair<unsigned int, double>>> cell_weights;
+  };
+
+  /*! \brief Inside/outside test against the boundary of a 3D mesh.
+   *
+   * The boundary quads of the triangulation are split into two triangles
+   * each. A point is tested by casting a ray along a coordinate axis and
+   * counting the crossings, where only the triangles returned by an AABBTree
+   * are visited, so the cost scales with the surface rather than the volume.
+   * If the ray grazes an edge or a vertex, the next axis is tried. If all of
+   * the axes are ambiguous, the generalized winding number (the sum of the
+   * solid angles of the triangles over \f$4\pi\f$) is used instead, which is
+   * robust but visits every triangle.
+   *
+   * Only the topology is stored: update() reads the current coordinates from
+   * the triangulation, which should be called whenever it is moved.
+   */
+  class ClosedSurface
+  {
+  public:
+    /// Collect the boundary faces of a 3D triangulation and build the tree.
+    template <int dim>
+    void reinit(const Triangulation<dim> &);
+
+    /// Refresh the triangles and refit the tree with the current vertices.
+    template <int dim>
+    void update(const Triangulation<dim> &);
+
+    /// The same with the vertices of a deformed configuration.
+    template <int dim>
+    void update(const std::vector<Point<dim>> &);
+
+    /// Check if a point is inside or on the surface.
+    template <int dim>
+    bool point_inside(const Point<dim> &) const;
+
+    /// Generalized winding number of the point, 1 inside and 0 outside.
+    double winding_number(const Point<3> &) const;
+
+    bool empty() const { return triangles.empty(); }
+
+  private:
+    /// Possible outcomes of a ray casting.
+    enum RayResult
+    {
+      even,
+      odd,
+      ambiguous,
+      on_surface
+    };
+
+    RayResult cast_ray(const Point<3> &, const unsigned int) const;
+
+    /// Global vertex indices of the triangles, oriented outward.
+    std::vector<std::array<unsigned int, 3>> triangle_vertices;
+
+    /// Current coordinates of the triangles.
+    std::vector<std::array<Point<3>, 3>> triangles;
+
+    /// A length scale of the surface used in the tolerances.
+    double diameter;
+
+    AABBTree<3> tree;
+
+    /// Buffer for the candidates returned by the tree queries, one per
+    /// thread so that points can be tested concurrently.
+    mutable Threads::ThreadLocalStorage<std::vector<unsigned int>> candidates;
   };
 } // namespace Utils
 
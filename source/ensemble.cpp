@@ -0,0 +1,64 @@
+#include "ensemble.h"
+
+#include <algorithm>
+#include <experimental/filesystem>
+
+namespace fs = std::experimental::filesystem;
+
+namespace Utils
+{
+  Ensemble::Ensemble(const MPI_Comm &comm, const std::string &infile)
+    : parameter_file(infile)
+  {
+    const Parameters::AllParameters parameters(parameter_file);
+    variants = parameters.ensemble_variants;
+    const unsigned int n_ranks = Utilities::MPI::n_mpi_processes(comm);
+    const unsigned int rank = Utilities::MPI::this_mpi_process(comm);
+    n_groups = std::min(parameters.ensemble_groups, n_ranks);
+    if (!variants.empty())
+      {
+        n_groups = std::min<unsigned int>(n_groups, variants.size());
+      }
+    else
+      {
+        n_groups = 1;
+      }
+    // The groups are contiguous blocks of ranks of about the same size.
+    group = static_cast<unsigned long>(rank) * n_groups / n_ranks;
+    int ierr = MPI_Comm_split(comm, group, rank, &group_communicator);
+    AssertThrowMPI(ierr);
+  }
+
+  Ensemble::~Ensemble()
+  {
+    MPI_Comm_free(&group_communicator);
+  }
+
+  void Ensemble::run(
+    const std::function<void(const Parameters::AllParameters &,
+                             const unsigned int)> &run_variant) const
+  {
+    if (variants.empty())
+      {
+        run_variant(Parameters::AllParameters(parameter_file), 0);
+        return;
+      }
+    const fs::path base_path = fs::current_path();
+    for (unsigned int v = group; v < variants.size(); v += n_groups)
+      {
+        const Parameters::AllParameters parameters(parameter_file,
+                                                   variants[v]);
+        const fs::path path =
+          base_path / ("variant-" + Utilities::int_to_string(v, 3));
+        if (Utilities::MPI::this_mpi_process(group_communicator) == 0)
+          {
+            fs::create_directories(path);
+          }
+        int ierr = MPI_Barrier(group_communicator);
+        AssertThrowMPI(ierr);
+        fs::current_path(path);
+        run_variant(parameters, v);
+        fs::current_path(base_path);
+      }
+  }
+} // namespace Utils
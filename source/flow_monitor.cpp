@@ -0,0 +1,250 @@
+#include "flow_monitor.h"
+
+#include <deal.II/fe/fe_values.h>
+
+#include <deal.II/physics/elasticity/standard_tensors.h>
+
+#include <iomanip>
+
+namespace Utils
+{
+  template <int dim, typename VectorType>
+  FlowMonitor<dim, VectorType>::FlowMonitor(
+    const DoFHandler<dim> &dof_handler,
+    const Parameters::AllParameters &parameters,
+    const Quadrature<dim - 1> &face_quadrature,
+    const MPI_Comm &comm)
+    : dof_handler(dof_handler),
+      mpi_communicator(comm),
+      active(!parameters.monitor_file.empty()),
+      filename(Utilities::MPI::this_mpi_process(comm) == 0
+                 ? parameters.monitor_file
+                 : ""),
+      viscosity(parameters.viscosity),
+      face_quadrature(face_quadrature),
+      force_boundaries(parameters.force_boundaries.begin(),
+                       parameters.force_boundaries.end()),
+      evaluator(dof_handler),
+      located(false),
+      faces_collected(false),
+      has_pending(false),
+      pending_step(0),
+      pending_time(0)
+  {
+    auto to_dim = [](const Point<3> &p) {
+      Point<dim> q;
+      for (unsigned int d = 0; d < dim; ++d)
+        {
+          q[d] = p[d];
+        }
+      return q;
+    };
+    for (unsigned int i = 0; i < parameters.probe_points.size(); ++i)
+      {
+        points.push_back(to_dim(parameters.probe_points[i]));
+        point_names.push_back("probe" + std::to_string(i));
+      }
+    for (unsigned int l = 0; l < parameters.sample_lines.size(); ++l)
+      {
+        const auto &ends = parameters.sample_lines[l].first;
+        const unsigned int n = parameters.sample_lines[l].second;
+        for (unsigned int k = 0; k < n; ++k)
+          {
+            const double s = static_cast<double>(k) / (n - 1);
+            points.push_back(to_dim(ends[0] + s * (ends[1] - ends[0])));
+            point_names.push_back("line" + std::to_string(l) + "_" +
+                                  std::to_string(k));
+          }
+      }
+    for (unsigned int p = 0; p < parameters.sample_planes.size(); ++p)
+      {
+        const auto &corners = parameters.sample_planes[p].first;
+        const auto &n = parameters.sample_planes[p].second;
+        for (unsigned int i = 0; i < n[0]; ++i)
+          {
+            for (unsigned int j = 0; j < n[1]; ++j)
+              {
+                const double s = static_cast<double>(i) / (n[0] - 1);
+                const double t = static_cast<double>(j) / (n[1] - 1);
+                points.push_back(to_dim(corners[0] +
+                                        s * (corners[1] - corners[0]) +
+                                        t * (corners[2] - corners[0])));
+                point_names.push_back("plane" + std::to_string(p) + "_" +
+                                      std::to_string(i) + "_" +
+                                      std::to_string(j));
+              }
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  FlowMonitor<dim, VectorType>::~FlowMonitor()
+  {
+    flush();
+  }
+
+  template <int dim, typename VectorType>
+  void FlowMonitor<dim, VectorType>::clear()
+  {
+    evaluator.clear();
+    located = false;
+    force_faces.clear();
+    faces_collected = false;
+  }
+
+  template <int dim, typename VectorType>
+  void
+  FlowMonitor<dim, VectorType>::monitor(const unsigned int step,
+                                        const double time,
+                                        const VectorType &solution)
+  {
+    if (!active)
+      {
+        return;
+      }
+    // The velocity and the pressure at the points come first, then the
+    // forces on the boundaries.
+    const unsigned int n_components = dim + 1;
+    const unsigned int force_offset = points.size() * n_components;
+    std::vector<double> values(force_offset + force_boundaries.size() * dim,
+                               0.0);
+
+    if (!points.empty())
+      {
+        if (!located)
+          {
+            evaluator.reinit(points, mpi_communicator);
+            located = true;
+          }
+        std::vector<Vector<double>> point_values;
+        evaluator.evaluate(solution, point_values);
+        for (unsigned int i = 0; i < points.size(); ++i)
+          {
+            if (!evaluator.is_owned(i))
+              continue;
+            for (unsigned int c = 0; c < n_components; ++c)
+              {
+                values[i * n_components + c] = point_values[i][c];
+              }
+          }
+      }
+
+    if (!faces_collected)
+      {
+        for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+             ++cell)
+          {
+            if (!cell->is_locally_owned() || !cell->at_boundary())
+              continue;
+            for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell;
+                 ++f)
+              {
+                if (!cell->face(f)->at_boundary())
+                  continue;
+                for (unsigned int b = 0; b < force_boundaries.size(); ++b)
+                  {
+                    if (cell->face(f)->boundary_id() == force_boundaries[b])
+                      force_faces.emplace_back(cell, f, b);
+                  }
+              }
+          }
+        faces_collected = true;
+      }
+    if (!force_faces.empty())
+      {
+        FEFaceValues<dim> fe_face_values(dof_handler.get_fe(),
+                                         face_quadrature,
+                                         update_values | update_gradients |
+                                           update_normal_vectors |
+                                           update_JxW_values);
+        const FEValuesExtractors::Vector velocities(0);
+        const FEValuesExtractors::Scalar pressure(dim);
+        const unsigned int n_q_points = face_quadrature.size();
+        std::vector<SymmetricTensor<2, dim>> sym_grad_v(n_q_points);
+        std::vector<double> p(n_q_points);
+        for (const auto &face : force_faces)
+          {
+            fe_face_values.reinit(std::get<0>(face), std::get<1>(face));
+            fe_face_values[velocities].get_function_symmetric_gradients(
+              solution, sym_grad_v);
+            fe_face_values[pressure].get_function_values(solution, p);
+            const unsigned int offset = force_offset + std::get<2>(face) * dim;
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              {
+                const SymmetricTensor<2, dim> sigma =
+                  -p[q] * Physics::Elasticity::StandardTensors<dim>::I +
+                  2 * viscosity * sym_grad_v[q];
+                // The normal points out of the fluid, the force on the
+                // boundary is the opposite of the traction on the fluid.
+                const Tensor<1, dim> traction =
+                  sigma * fe_face_values.normal_vector(q);
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    values[offset + d] -= traction[d] * fe_face_values.JxW(q);
+                  }
+              }
+          }
+      }
+
+    Utilities::MPI::sum(values, mpi_communicator, values);
+    if (filename.empty())
+      {
+        return;
+      }
+    if (has_pending && pending_step != step)
+      {
+        flush();
+      }
+    has_pending = true;
+    pending_step = step;
+    pending_time = time;
+    pending_values = values;
+  }
+
+  template <int dim, typename VectorType>
+  void FlowMonitor<dim, VectorType>::flush()
+  {
+    if (!has_pending)
+      {
+        return;
+      }
+    // The file is only created by a solver that runs, e.g. not by the fluid
+    // solver on the solid processes of a split FSI.
+    if (!file.is_open())
+      {
+        file.open(filename);
+        AssertThrow(file, ExcFileNotOpen(filename));
+        file << std::setprecision(10) << "step,time";
+        for (const auto &name : point_names)
+          {
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                file << "," << name << "_u" << d;
+              }
+            file << "," << name << "_p";
+          }
+        for (const auto id : force_boundaries)
+          {
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                file << ",force" << static_cast<unsigned int>(id) << "_" << d;
+              }
+          }
+        file << std::endl;
+      }
+    file << pending_step << "," << pending_time;
+    for (const double value : pending_values)
+      {
+        file << "," << value;
+      }
+    file << std::endl;
+    has_pending = false;
+  }
+
+  template class FlowMonitor<2>;
+  template class FlowMonitor<3>;
+#ifdef OPENIFEM_WITH_TRILINOS
+  template class FlowMonitor<2, TrilinosWrappers::MPI::BlockVector>;
+  template class FlowMonitor<3, TrilinosWrappers::MPI::BlockVector>;
+#endif
+} // namespace Utils
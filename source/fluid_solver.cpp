@@ -45,10 +45,15 @@ namespace Fluid
     // We renumber the components to have all velocity DoFs come before
     // the pressure DoFs to be able to split the solution vector in two blocks
     // which are separately accessed in the block preconditioner.
-    DoFRenumbering::Cuthill_McKee(dof_handler);
+    // The locality ordering within the blocks comes first, component_wise
+    // keeps it.
+    Utils::renumber_dofs(dof_handler, parameters.dof_renumbering);
     std::vector<unsigned int> block_component(dim + 1, 0);
     block_component[dim] = 1;
     DoFRenumbering::component_wise(dof_handler, block_component);
+    Utils::renumber_dofs(
+      scalar_dof_handler, parameters.dof_renumbering, "none");
+    assembly_cells = Utils::cells_in_dof_order(dof_handler);
 
     dofs_per_block.resize(2);
     DoFTools::count_dofs_per_block(
@@ -331,16 +336,6 @@ namespace Fluid
           }
       }
     std::vector<int> surrounding_cells(scalar_dof_handler.n_dofs(), 0);
-    // The stress tensors are stored as 2D vectors of shape dim*dim
-    // at cell and quadrature point level.
-    std::vector<std::vector<Vector<double>>> cell_stress(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(scalar_fe.dofs_per_cell)));
-    std::vector<std::vector<Vector<double>>> quad_stress(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(volume_quad_formula.size())));
 
     // The projection matrix from quadrature points to the dofs.
     FullMatrix<double> qpt_to_dof(scalar_fe.dofs_per_cell,
@@ -348,23 +343,30 @@ namespace Fluid
     FETools::compute_projection_from_quadrature_points_matrix(
       scalar_fe, volume_quad_formula, volume_quad_formula, qpt_to_dof);
 
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_gradients |
-                              update_quadrature_points | update_JxW_values);
     const unsigned int n_q_points = volume_quad_formula.size();
     const FEValuesExtractors::Vector velocities(0);
     const FEValuesExtractors::Scalar pressure(dim);
-    std::vector<SymmetricTensor<2, dim>> sym_grad_v(n_q_points);
-    std::vector<double> p(n_q_points);
 
-    auto cell = dof_handler.begin_active();
-    auto scalar_cell = scalar_dof_handler.begin_active();
-    std::vector<types::global_dof_index> dof_indices(scalar_fe.dofs_per_cell);
-    for (; cell != dof_handler.end(); ++cell, ++scalar_cell)
-      {
-        scalar_cell->get_dof_indices(dof_indices);
+    // The projections of the stress components of a cell, which the copier
+    // adds up, and the components at the quadrature points.
+    struct StressCopyData
+    {
+      std::vector<types::global_dof_index> dof_indices;
+      std::vector<std::vector<Vector<double>>> cell_stress;
+      Vector<double> quad_stress;
+    };
+
+    auto local_stress =
+      [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+          AssemblyScratchData &scratch,
+          StressCopyData &data) {
+        const typename DoFHandler<dim>::active_cell_iterator scalar_cell(
+          &triangulation, cell->level(), cell->index(), &scalar_dof_handler);
+        scalar_cell->get_dof_indices(data.dof_indices);
+        FEValues<dim> &fe_values = scratch.fe_values;
         fe_values.reinit(cell);
+        auto &sym_grad_v = scratch.current_velocity_sym_gradients;
+        auto &p = scratch.current_pressure_values;
 
         // Fluid symmetric velocity gradient
         fe_values[velocities].get_function_symmetric_gradients(present_solution,
@@ -372,35 +374,54 @@ namespace Fluid
         // Fluid pressure
         fe_values[pressure].get_function_values(present_solution, p);
 
-        // Loop over all quadrature points to set FSI forces.
-        for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
-          {
-            SymmetricTensor<2, dim> sigma =
-              -p[q] * Physics::Elasticity::StandardTensors<dim>::I +
-              2 * parameters.viscosity * sym_grad_v[q];
-            for (unsigned int i = 0; i < dim; ++i)
-              {
-                for (unsigned int j = 0; j < dim; ++j)
-                  {
-                    quad_stress[i][j][q] = sigma[i][j];
-                  }
-              }
-          }
-
+        Vector<double> &quad_stress = data.quad_stress;
         for (unsigned int i = 0; i < dim; ++i)
           {
             for (unsigned int j = 0; j < dim; ++j)
               {
-                qpt_to_dof.vmult(cell_stress[i][j], quad_stress[i][j]);
-                for (unsigned int k = 0; k < scalar_fe.dofs_per_cell; ++k)
+                for (unsigned int q = 0; q < n_q_points; ++q)
                   {
-                    stress[i][j][dof_indices[k]] += cell_stress[i][j][k];
-                    if (i == 0 && j == 0)
-                      surrounding_cells[dof_indices[k]]++;
+                    quad_stress[q] =
+                      2 * parameters.viscosity * sym_grad_v[q][i][j];
+                    if (i == j)
+                      {
+                        quad_stress[q] -= p[q];
+                      }
                   }
+                qpt_to_dof.vmult(data.cell_stress[i][j], quad_stress);
               }
           }
-      }
+      };
+
+    auto copy_local_to_global = [&](const StressCopyData &data) {
+      for (unsigned int k = 0; k < scalar_fe.dofs_per_cell; ++k)
+        {
+          for (unsigned int i = 0; i < dim; ++i)
+            {
+              for (unsigned int j = 0; j < dim; ++j)
+                {
+                  stress[i][j][data.dof_indices[k]] +=
+                    data.cell_stress[i][j][k];
+                }
+            }
+          surrounding_cells[data.dof_indices[k]]++;
+        }
+    };
+
+    StressCopyData sample;
+    sample.dof_indices.resize(scalar_fe.dofs_per_cell);
+    sample.cell_stress.assign(
+      dim,
+      std::vector<Vector<double>>(dim,
+                                  Vector<double>(scalar_fe.dofs_per_cell)));
+    sample.quad_stress.reinit(n_q_points);
+    WorkStream::run(
+      dof_handler.begin_active(),
+      dof_handler.end(),
+      local_stress,
+      copy_local_to_global,
+      AssemblyScratchData(fe, volume_quad_formula, face_quad_formula),
+      sample);
 
     for (unsigned int i = 0; i < dim; ++i)
       {
@@ -414,6 +435,80 @@ namespace Fluid
       }
   }
 
+  template <int dim>
+  void FluidSolver<dim>::assemble_cells(
+    const CellWorker &worker,
+    const std::function<void(const AssemblyCopyData &)> &copier)
+  {
+    using Iterator = typename std::vector<
+      typename DoFHandler<dim>::active_cell_iterator>::const_iterator;
+    WorkStream::run(
+      assembly_cells.cbegin(),
+      assembly_cells.cend(),
+      [&worker](const Iterator &cell,
+                AssemblyScratchData &scratch,
+                AssemblyCopyData &data) { worker(*cell, scratch, data); },
+      copier,
+      AssemblyScratchData(fe, volume_quad_formula, face_quad_formula),
+      AssemblyCopyData(fe.dofs_per_cell));
+  }
+
+  template <int dim>
+  FluidSolver<dim>::AssemblyScratchData::AssemblyScratchData(
+    const FiniteElement<dim> &fe,
+    const Quadrature<dim> &volume_quad_formula,
+    const Quadrature<dim - 1> &face_quad_formula)
+    : fe_values(fe,
+                volume_quad_formula,
+                update_values | update_quadrature_points | update_JxW_values |
+                  update_gradients),
+      fe_face_values(fe,
+                     face_quad_formula,
+                     update_values | update_normal_vectors |
+                       update_quadrature_points | update_JxW_values),
+      div_phi_u(fe.dofs_per_cell),
+      phi_u(fe.dofs_per_cell),
+      grad_phi_u(fe.dofs_per_cell),
+      phi_p(fe.dofs_per_cell),
+      current_velocity_values(volume_quad_formula.size()),
+      current_velocity_gradients(volume_quad_formula.size()),
+      current_velocity_sym_gradients(volume_quad_formula.size()),
+      current_pressure_values(volume_quad_formula.size()),
+      present_velocity_values(volume_quad_formula.size())
+  {
+  }
+
+  template <int dim>
+  FluidSolver<dim>::AssemblyScratchData::AssemblyScratchData(
+    const AssemblyScratchData &scratch)
+    : fe_values(scratch.fe_values.get_fe(),
+                scratch.fe_values.get_quadrature(),
+                scratch.fe_values.get_update_flags()),
+      fe_face_values(scratch.fe_face_values.get_fe(),
+                     scratch.fe_face_values.get_quadrature(),
+                     scratch.fe_face_values.get_update_flags()),
+      div_phi_u(scratch.div_phi_u),
+      phi_u(scratch.phi_u),
+      grad_phi_u(scratch.grad_phi_u),
+      phi_p(scratch.phi_p),
+      current_velocity_values(scratch.current_velocity_values),
+      current_velocity_gradients(scratch.current_velocity_gradients),
+      current_velocity_sym_gradients(scratch.current_velocity_sym_gradients),
+      current_pressure_values(scratch.current_pressure_values),
+      present_velocity_values(scratch.present_velocity_values)
+  {
+  }
+
+  template <int dim>
+  FluidSolver<dim>::AssemblyCopyData::AssemblyCopyData(
+    const unsigned int dofs_per_cell)
+    : local_matrix(dofs_per_cell, dofs_per_cell),
+      local_mass_matrix(dofs_per_cell, dofs_per_cell),
+      local_rhs(dofs_per_cell),
+      local_dof_indices(dofs_per_cell)
+  {
+  }
+
   template class FluidSolver<2>;
   template class FluidSolver<3>;
 } // namespace Fluid
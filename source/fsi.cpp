@@ -85,6 +85,51 @@ void FSI<dim>::update_solid_box()
             solid_box(2 * i + 1) = (*v)(i);
         }
     }
+  if (dim == 3)
+    {
+      solid_surface.update(solid_solver.triangulation);
+    }
+  else
+    {
+      // Bin the deformed solid cells, only the cells that moved to other
+      // buckets are moved in the list.
+      if (solid_cell_iterators.empty())
+        {
+          for (auto cell = solid_solver.dof_handler.begin_active();
+               cell != solid_solver.dof_handler.end();
+               ++cell)
+            {
+              solid_cell_iterators.push_back(cell);
+            }
+        }
+      std::vector<typename Utils::CellLinkedList<dim>::Box> boxes(
+        solid_cell_iterators.size());
+      for (unsigned int c = 0; c < solid_cell_iterators.size(); ++c)
+        {
+          const auto &cell = solid_cell_iterators[c];
+          boxes[c].first = cell->vertex(0);
+          boxes[c].second = cell->vertex(0);
+          for (unsigned int v = 1; v < GeometryInfo<dim>::vertices_per_cell;
+               ++v)
+            {
+              for (unsigned int i = 0; i < dim; ++i)
+                {
+                  boxes[c].first[i] =
+                    std::min(boxes[c].first[i], cell->vertex(v)[i]);
+                  boxes[c].second[i] =
+                    std::max(boxes[c].second[i], cell->vertex(v)[i]);
+                }
+            }
+        }
+      if (solid_cells.empty())
+        {
+          solid_cells.build(boxes);
+        }
+      else
+        {
+          solid_cells.update(boxes);
+        }
+    }
   move_solid_mesh(false);
 }
 
@@ -98,6 +143,26 @@ bool FSI<dim>::point_in_solid(const DoFHandler<dim> &df,
       if (point(i) < solid_box(2 * i) || point(i) > solid_box(2 * i + 1))
         return false;
     }
+  // In 3D, cast rays against the boundary surface instead of looping over
+  // all the solid cells.
+  if (dim == 3)
+    {
+      return solid_surface.point_inside(point);
+    }
+  // In 2D, only test the cells binned near the point.
+  if (!solid_cells.empty())
+    {
+      std::vector<unsigned int> candidates;
+      solid_cells.point_query(point, candidates);
+      for (auto c : candidates)
+        {
+          if (solid_cell_iterators[c]->point_inside(point))
+            {
+              return true;
+            }
+        }
+      return false;
+    }
   for (auto cell = df.begin_active(); cell != df.end(); ++cell)
     {
       if (cell->point_inside(point))
@@ -151,14 +216,26 @@ void FSI<dim>::update_indicator()
 {
   TimerOutput::Scope timer_section(timer, "Update indicator");
   move_solid_mesh(true);
-  for (auto f_cell = fluid_solver.dof_handler.begin_active();
-       f_cell != fluid_solver.dof_handler.end();
-       ++f_cell)
-    {
+  // Every cell only writes its own indicator, so there is nothing to copy.
+  struct ScratchData
+  {
+  };
+  struct CopyData
+  {
+  };
+  WorkStream::run(
+    fluid_solver.dof_handler.begin_active(),
+    fluid_solver.dof_handler.end(),
+    [this](const typename DoFHandler<dim>::active_cell_iterator &f_cell,
+           ScratchData &,
+           CopyData &) {
       auto p = fluid_solver.cell_property.get_data(f_cell);
       auto center = f_cell->center();
       p[0]->indicator = point_in_solid(solid_solver.dof_handler, center);
-    }
+    },
+    [](const CopyData &) {},
+    ScratchData(),
+    CopyData());
   move_solid_mesh(false);
 }
 
@@ -178,11 +255,6 @@ void FSI<dim>::find_fluid_bc()
 
   const FEValuesExtractors::Vector velocities(0);
   const FEValuesExtractors::Scalar pressure(dim);
-  std::vector<SymmetricTensor<2, dim>> sym_grad_v(1);
-  std::vector<double> p(1);
-  std::vector<Tensor<2, dim>> grad_v(1);
-  std::vector<Tensor<1, dim>> v(1);
-  std::vector<Tensor<1, dim>> dv(1);
 
   // Cell center in unit coordinate system
   Point<dim> unit_center;
@@ -192,110 +264,173 @@ void FSI<dim>::find_fluid_bc()
     }
   Quadrature<dim> quad(unit_center);
   MappingQGeneric<dim> mapping(parameters.fluid_velocity_degree);
-  FEValues<dim> fe_values(mapping,
-                          fluid_solver.fe,
-                          quad,
-                          update_quadrature_points | update_values |
-                            update_gradients);
 
   const std::vector<Point<dim>> &unit_points =
     fluid_solver.fe.get_unit_support_points();
   Quadrature<dim> dummy_q(unit_points);
-  FEValues<dim> dummy_fe_values(
-    mapping, fluid_solver.fe, dummy_q, update_quadrature_points);
-  std::vector<types::global_dof_index> dof_indices(
-    fluid_solver.fe.dofs_per_cell);
-
-  for (auto f_cell = fluid_solver.dof_handler.begin_active();
-       f_cell != fluid_solver.dof_handler.end();
-       ++f_cell)
+
+  // The FEValues at the cell center and at the support points of a thread.
+  struct ScratchData
+  {
+    ScratchData(const Mapping<dim> &mapping,
+                const FiniteElement<dim> &fe,
+                const Quadrature<dim> &quad,
+                const Quadrature<dim> &dummy_q)
+      : fe_values(mapping,
+                  fe,
+                  quad,
+                  update_quadrature_points | update_values | update_gradients),
+        dummy_fe_values(mapping, fe, dummy_q, update_quadrature_points),
+        dof_indices(fe.dofs_per_cell),
+        sym_grad_v(1),
+        p(1),
+        grad_v(1),
+        v(1),
+        dv(1)
     {
-      auto ptr = fluid_solver.cell_property.get_data(f_cell);
-      ptr[0]->fsi_acceleration = 0;
-      ptr[0]->fsi_stress = 0;
-      if (!use_dirichlet_bc && ptr[0]->indicator == 1)
-        {
-          fe_values.reinit(f_cell);
-          // Fluid velocity increment at cell center
-          fe_values[velocities].get_function_values(
-            fluid_solver.solution_increment, dv);
-          // Fluid velocity gradient at cell center
-          fe_values[velocities].get_function_gradients(
-            fluid_solver.present_solution, grad_v);
-          // Fluid symmetric velocity gradient at cell center
-          fe_values[velocities].get_function_symmetric_gradients(
-            fluid_solver.present_solution, sym_grad_v);
-          // Fluid pressure at cell center
-          fe_values[pressure].get_function_values(fluid_solver.present_solution,
-                                                  p);
-          // Real coordinates of fluid cell center
-          auto point = fe_values.get_quadrature_points()[0];
-          // Solid acceleration at fluid cell center
-          Vector<double> solid_acc(dim);
-          VectorTools::point_value(solid_solver.dof_handler,
-                                   solid_solver.current_acceleration,
-                                   point,
-                                   solid_acc);
-          // Fluid total acceleration at cell center
-          Tensor<1, dim> fluid_acc =
-            dv[0] / time.get_delta_t() + grad_v[0] * v[0];
-          (void)fluid_acc;
-          // FSI acceleration term:
-          for (unsigned int i = 0; i < dim; ++i)
-            {
-              ptr[0]->fsi_acceleration[i] =
-                (parameters.solid_rho - parameters.fluid_rho) *
-                (parameters.gravity[i] - solid_acc[i]);
-            }
-        }
-      // Dirichlet BCs
-      if (use_dirichlet_bc)
-        {
-          dummy_fe_values.reinit(f_cell);
-          f_cell->get_dof_indices(dof_indices);
-          auto support_points = dummy_fe_values.get_quadrature_points();
-          // Loop over the support points to set Dirichlet BCs.
-          for (unsigned int i = 0; i < unit_points.size(); ++i)
-            {
-              auto base_index = fluid_solver.fe.system_to_base_index(i);
-              const unsigned int i_group = base_index.first.first;
-              Assert(
-                i_group < 2,
-                ExcMessage("There should be only 2 groups of finite element!"));
-              if (i_group == 1)
-                continue; // skip the pressure dofs
-              bool inside = true;
-              for (unsigned int d = 0; d < dim; ++d)
-                if (std::abs(unit_points[i][d]) < 1e-5)
-                  {
-                    inside = false;
-                    break;
-                  }
-              if (inside)
-                continue; // skip the in-cell support point
-              // Same as fluid_solver.fe.system_to_base_index(i).first.second;
-              const unsigned int index =
-                fluid_solver.fe.system_to_component_index(i).first;
-              Assert(index < dim,
-                     ExcMessage("Vector component should be less than dim!"));
-              if (!point_in_solid(solid_solver.dof_handler, support_points[i]))
-                continue;
-              Vector<double> fluid_velocity(dim);
-              VectorTools::point_value(solid_solver.dof_handler,
-                                       solid_solver.current_velocity,
-                                       support_points[i],
-                                       fluid_velocity);
-              auto line = dof_indices[i];
-              inner_nonzero.add_line(line);
-              inner_zero.add_line(line);
-              // Note that we are setting the value of the constraint to the
-              // velocity delta!
-              inner_nonzero.set_inhomogeneity(
-                line,
-                fluid_velocity[index] - fluid_solver.present_solution(line));
-            }
-        }
     }
+    ScratchData(const ScratchData &scratch)
+      : fe_values(scratch.fe_values.get_mapping(),
+                  scratch.fe_values.get_fe(),
+                  scratch.fe_values.get_quadrature(),
+                  scratch.fe_values.get_update_flags()),
+        dummy_fe_values(scratch.dummy_fe_values.get_mapping(),
+                        scratch.dummy_fe_values.get_fe(),
+                        scratch.dummy_fe_values.get_quadrature(),
+                        scratch.dummy_fe_values.get_update_flags()),
+        dof_indices(scratch.dof_indices),
+        sym_grad_v(scratch.sym_grad_v),
+        p(scratch.p),
+        grad_v(scratch.grad_v),
+        v(scratch.v),
+        dv(scratch.dv)
+    {
+    }
+    FEValues<dim> fe_values;
+    FEValues<dim> dummy_fe_values;
+    std::vector<types::global_dof_index> dof_indices;
+    std::vector<SymmetricTensor<2, dim>> sym_grad_v;
+    std::vector<double> p;
+    std::vector<Tensor<2, dim>> grad_v;
+    std::vector<Tensor<1, dim>> v;
+    std::vector<Tensor<1, dim>> dv;
+  };
+
+  // The constrained lines of a cell and their inhomogeneities, which the
+  // copier adds to the constraints.
+  struct CopyData
+  {
+    std::vector<std::pair<types::global_dof_index, double>> lines;
+  };
+
+  // Every cell writes its own FSI acceleration and stress, and reads the
+  // solid solution, which is not modified.
+  auto local_find_bc = [&](const typename DoFHandler<dim>::active_cell_iterator
+                             &f_cell,
+                           ScratchData &scratch,
+                           CopyData &data) {
+    data.lines.clear();
+    auto ptr = fluid_solver.cell_property.get_data(f_cell);
+    ptr[0]->fsi_acceleration = 0;
+    ptr[0]->fsi_stress = 0;
+    if (!use_dirichlet_bc && ptr[0]->indicator == 1)
+      {
+        FEValues<dim> &fe_values = scratch.fe_values;
+        fe_values.reinit(f_cell);
+        // Fluid velocity increment at cell center
+        fe_values[velocities].get_function_values(
+          fluid_solver.solution_increment, scratch.dv);
+        // Fluid velocity gradient at cell center
+        fe_values[velocities].get_function_gradients(
+          fluid_solver.present_solution, scratch.grad_v);
+        // Fluid symmetric velocity gradient at cell center
+        fe_values[velocities].get_function_symmetric_gradients(
+          fluid_solver.present_solution, scratch.sym_grad_v);
+        // Fluid pressure at cell center
+        fe_values[pressure].get_function_values(fluid_solver.present_solution,
+                                                scratch.p);
+        // Real coordinates of fluid cell center
+        auto point = fe_values.get_quadrature_points()[0];
+        // Solid acceleration at fluid cell center
+        Vector<double> solid_acc(dim);
+        VectorTools::point_value(solid_solver.dof_handler,
+                                 solid_solver.current_acceleration,
+                                 point,
+                                 solid_acc);
+        // Fluid total acceleration at cell center
+        Tensor<1, dim> fluid_acc =
+          scratch.dv[0] / time.get_delta_t() + scratch.grad_v[0] * scratch.v[0];
+        (void)fluid_acc;
+        // FSI acceleration term:
+        for (unsigned int i = 0; i < dim; ++i)
+          {
+            ptr[0]->fsi_acceleration[i] =
+              (parameters.solid_rho - parameters.fluid_rho) *
+              (parameters.gravity[i] - solid_acc[i]);
+          }
+      }
+    // Dirichlet BCs
+    if (use_dirichlet_bc)
+      {
+        scratch.dummy_fe_values.reinit(f_cell);
+        f_cell->get_dof_indices(scratch.dof_indices);
+        auto support_points = scratch.dummy_fe_values.get_quadrature_points();
+        // Loop over the support points to set Dirichlet BCs.
+        for (unsigned int i = 0; i < unit_points.size(); ++i)
+          {
+            auto base_index = fluid_solver.fe.system_to_base_index(i);
+            const unsigned int i_group = base_index.first.first;
+            Assert(
+              i_group < 2,
+              ExcMessage("There should be only 2 groups of finite element!"));
+            if (i_group == 1)
+              continue; // skip the pressure dofs
+            bool inside = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              if (std::abs(unit_points[i][d]) < 1e-5)
+                {
+                  inside = false;
+                  break;
+                }
+            if (inside)
+              continue; // skip the in-cell support point
+            // Same as fluid_solver.fe.system_to_base_index(i).first.second;
+            const unsigned int index =
+              fluid_solver.fe.system_to_component_index(i).first;
+            Assert(index < dim,
+                   ExcMessage("Vector component should be less than dim!"));
+            if (!point_in_solid(solid_solver.dof_handler, support_points[i]))
+              continue;
+            Vector<double> fluid_velocity(dim);
+            VectorTools::point_value(solid_solver.dof_handler,
+                                     solid_solver.current_velocity,
+                                     support_points[i],
+                                     fluid_velocity);
+            auto line = scratch.dof_indices[i];
+            // Note that we are setting the value of the constraint to the
+            // velocity delta!
+            data.lines.emplace_back(
+              line,
+              fluid_velocity[index] - fluid_solver.present_solution(line));
+          }
+      }
+  };
+
+  auto copy_local_to_global = [&](const CopyData &data) {
+    for (const auto &line : data.lines)
+      {
+        inner_nonzero.add_line(line.first);
+        inner_zero.add_line(line.first);
+        inner_nonzero.set_inhomogeneity(line.first, line.second);
+      }
+  };
+
+  WorkStream::run(fluid_solver.dof_handler.begin_active(),
+                  fluid_solver.dof_handler.end(),
+                  local_find_bc,
+                  copy_local_to_global,
+                  ScratchData(mapping, fluid_solver.fe, quad, dummy_q),
+                  CopyData());
   if (use_dirichlet_bc)
     {
       inner_nonzero.close();
@@ -316,9 +451,6 @@ void FSI<dim>::find_solid_bc()
   TimerOutput::Scope timer_section(timer, "Find solid BC");
   // Must use the updated solid coordinates
   move_solid_mesh(true);
-  // Fluid FEValues to do interpolation
-  FEValues<dim> fe_values(
-    fluid_solver.fe, fluid_solver.volume_quad_formula, update_values);
   // Solid FEFaceValues to get the normal at face center
   Point<dim - 1> unit_face_center;
   for (unsigned int i = 0; i < dim - 1; ++i)
@@ -331,26 +463,44 @@ void FSI<dim>::find_solid_bc()
                                    update_quadrature_points |
                                      update_normal_vectors);
 
+  // Collect the boundary face centers first, so that the fluid solution is
+  // interpolated at all of them at once.
+  std::vector<Point<dim>> points;
+  std::vector<Tensor<1, dim>> normals;
   for (auto s_cell = solid_solver.dof_handler.begin_active();
        s_cell != solid_solver.dof_handler.end();
        ++s_cell)
     {
-      auto ptr = solid_solver.cell_property.get_data(s_cell);
       for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
         {
           // Current face is at boundary and without Dirichlet bc.
           if (s_cell->face(f)->at_boundary())
             {
               fe_face_values.reinit(s_cell, f);
-              Point<dim> q_point = fe_face_values.quadrature_point(0);
-              Tensor<1, dim> normal = fe_face_values.normal_vector(0);
-              Vector<double> value(dim + 1);
-              Utils::GridInterpolator<dim, BlockVector<double>> interpolator(
-                fluid_solver.dof_handler, q_point);
-              interpolator.point_value(fluid_solver.present_solution, value);
-              std::vector<Tensor<1, dim>> gradient(dim + 1, Tensor<1, dim>());
-              interpolator.point_gradient(fluid_solver.present_solution,
-                                          gradient);
+              points.push_back(fe_face_values.quadrature_point(0));
+              normals.push_back(fe_face_values.normal_vector(0));
+            }
+        }
+    }
+  Utils::PointEvaluator<dim, BlockVector<double>> evaluator(
+    fluid_solver.dof_handler);
+  evaluator.reinit(points, MPI_COMM_SELF);
+  std::vector<Vector<double>> values;
+  std::vector<std::vector<Tensor<1, dim>>> gradients;
+  evaluator.evaluate(fluid_solver.present_solution, values, gradients);
+
+  unsigned int n = 0;
+  for (auto s_cell = solid_solver.dof_handler.begin_active();
+       s_cell != solid_solver.dof_handler.end();
+       ++s_cell)
+    {
+      auto ptr = solid_solver.cell_property.get_data(s_cell);
+      for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+        {
+          if (s_cell->face(f)->at_boundary())
+            {
+              const auto &value = values[n];
+              const auto &gradient = gradients[n];
               SymmetricTensor<2, dim> sym_deformation;
               for (unsigned int i = 0; i < dim; ++i)
                 {
@@ -364,7 +514,8 @@ void FSI<dim>::find_solid_bc()
               SymmetricTensor<2, dim> stress =
                 -value[dim] * Physics::Elasticity::StandardTensors<dim>::I +
                 2 * parameters.viscosity * sym_deformation;
-              ptr[f]->fsi_traction = stress * normal;
+              ptr[f]->fsi_traction = stress * normals[n];
+              ++n;
             }
         }
     }
@@ -445,17 +596,50 @@ void FSI<dim>::refine_mesh(const unsigned int min_grid_level,
   fluid_solver.nonzero_constraints.distribute(fluid_solver.present_solution);
 }
 
+template <int dim>
+void FSI<dim>::save_solid_state(const unsigned int level)
+{
+  solid_states[level].displacement = solid_solver.current_displacement;
+  solid_states[level].velocity = solid_solver.current_velocity;
+  solid_states[level].acceleration = solid_solver.current_acceleration;
+}
+
+template <int dim>
+void FSI<dim>::interpolate_solid_state(const double alpha)
+{
+  solid_solver.current_displacement = solid_states[0].displacement;
+  solid_solver.current_displacement.sadd(
+    1 - alpha, alpha, solid_states[1].displacement);
+  solid_solver.current_velocity = solid_states[0].velocity;
+  solid_solver.current_velocity.sadd(
+    1 - alpha, alpha, solid_states[1].velocity);
+  solid_solver.current_acceleration = solid_states[0].acceleration;
+  solid_solver.current_acceleration.sadd(
+    1 - alpha, alpha, solid_states[1].acceleration);
+}
+
 template <int dim>
 void FSI<dim>::run()
 {
   solid_solver.triangulation.refine_global(parameters.global_refinements[1]);
   solid_solver.setup_dofs();
   solid_solver.initialize_system();
+  if (dim == 3)
+    {
+      solid_surface.reinit(solid_solver.triangulation);
+    }
   fluid_solver.triangulation.refine_global(parameters.global_refinements[0]);
   fluid_solver.setup_dofs();
   fluid_solver.make_constraints();
   fluid_solver.initialize_system();
 
+  // The time step of the FSI is the coupling time step, which the solvers
+  // may divide into smaller steps.
+  const unsigned int n_solid_steps = parameters.solid_substeps;
+  const unsigned int n_fluid_steps = parameters.fluid_substeps;
+  solid_solver.time.set_delta_t(parameters.time_step / n_solid_steps);
+  fluid_solver.time.set_delta_t(parameters.time_step / n_fluid_steps);
+
   std::cout << "Number of fluid active cells and dofs: ["
             << fluid_solver.triangulation.n_active_cells() << ", "
             << fluid_solver.dof_handler.n_dofs() << "]" << std::endl
@@ -473,25 +657,46 @@ void FSI<dim>::run()
     }
   while (time.end() - time.current() > 1e-12)
     {
+      // The fluid traction is held over the solid steps.
       find_solid_bc();
+      if (n_fluid_steps > 1)
+        {
+          save_solid_state(0);
+        }
       {
         TimerOutput::Scope timer_section(timer, "Run solid solver");
-        solid_solver.run_one_step(first_step);
+        for (unsigned int i = 0; i < n_solid_steps; ++i)
+          {
+            solid_solver.run_one_step(first_step && i == 0);
+          }
       }
-      update_solid_box();
-      update_indicator();
-      fluid_solver.make_constraints();
-      if (!first_step)
+      if (n_fluid_steps > 1)
         {
-          fluid_solver.nonzero_constraints.clear();
-          fluid_solver.nonzero_constraints.copy_from(
-            fluid_solver.zero_constraints);
+          save_solid_state(1);
+        }
+      for (unsigned int i = 1; i <= n_fluid_steps; ++i)
+        {
+          // The fluid steps see the solid state interpolated in time, which
+          // ends up at the end of the coupling step.
+          if (n_fluid_steps > 1)
+            {
+              interpolate_solid_state(static_cast<double>(i) / n_fluid_steps);
+            }
+          update_solid_box();
+          update_indicator();
+          fluid_solver.make_constraints();
+          if (!first_step || i > 1)
+            {
+              fluid_solver.nonzero_constraints.clear();
+              fluid_solver.nonzero_constraints.copy_from(
+                fluid_solver.zero_constraints);
+            }
+          find_fluid_bc();
+          {
+            TimerOutput::Scope timer_section(timer, "Run fluid solver");
+            fluid_solver.run_one_step(true);
+          }
         }
-      find_fluid_bc();
-      {
-        TimerOutput::Scope timer_section(timer, "Run fluid solver");
-        fluid_solver.run_one_step(true);
-      }
       first_step = false;
       time.increment();
       if (time.time_to_refine())
@@ -1,50 +1,5 @@
 #include "hyper_elasticity.h"
 
-namespace Internal
-{
-  using namespace dealii;
-
-  template <int dim>
-  void PointHistory<dim>::setup(const Parameters::AllParameters &parameters,
-                                const unsigned int &mat_id)
-  {
-    if (parameters.solid_type == "NeoHookean")
-      {
-        Assert(parameters.C[mat_id - 1].size() >= 2, ExcInternalError());
-        material.reset(new Solid::NeoHookean<dim>(parameters.C[mat_id - 1][0],
-                                                  parameters.C[mat_id - 1][1],
-                                                  parameters.solid_rho));
-        update(parameters, Tensor<2, dim>());
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-  }
-
-  template <int dim>
-  void PointHistory<dim>::update(const Parameters::AllParameters &parameters,
-                                 const Tensor<2, dim> &Grad_u)
-  {
-    const Tensor<2, dim> F = Physics::Elasticity::Kinematics::F(Grad_u);
-    material->update_data(F);
-    F_inv = invert(F);
-    if (parameters.solid_type == "NeoHookean")
-      {
-        auto nh = std::dynamic_pointer_cast<Solid::NeoHookean<dim>>(material);
-        Assert(nh, ExcInternalError());
-        tau = nh->get_tau();
-        Jc = nh->get_Jc();
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-    dPsi_vol_dJ = material->get_dPsi_vol_dJ();
-    d2Psi_vol_dJ2 = material->get_d2Psi_vol_dJ2();
-  }
-} // namespace Internal
-
 namespace Solid
 {
   using namespace dealii;
@@ -54,11 +9,27 @@ namespace Solid
                                         const Parameters::AllParameters &params)
     : SolidSolver<dim>(tria, params)
   {
+    this->use_system_matrix = params.solid_integrator == "implicit";
+    this->use_mass_matrix = params.solid_integrator == "implicit";
+  }
+
+  template <int dim>
+  void HyperElasticity<dim>::assemble_explicit_force()
+  {
+    // The residual is the external minus the internal force.
+    update_qph(current_displacement);
+    assemble_system(false, false);
   }
 
   template <int dim>
   void HyperElasticity<dim>::run_one_step(bool first_step)
   {
+    if (parameters.solid_integrator == "explicit")
+      {
+        this->run_one_explicit_step(first_step);
+        return;
+      }
+
     double gamma = 0.5 + parameters.damping;
     double beta = gamma / 2;
 
@@ -93,12 +64,21 @@ namespace Solid
 
     // The prediction of the current displacement,
     // which is what we want to solve.
-    predicted_displacement = previous_displacement;
-    predicted_displacement.add(
-      dt, previous_velocity, (0.5 - beta) * dt * dt, previous_acceleration);
+    const Utils::NewmarkUpdate newmark(beta, gamma, dt);
+    newmark.predict(predicted_displacement,
+                    previous_displacement,
+                    previous_velocity,
+                    previous_acceleration);
 
     std::cout << std::string(100, '_') << std::endl;
 
+    // The tangent is always assembled at the first iteration, the modified
+    // Newton method then keeps it while it is recent and converges well.
+    bool assemble_tangent = true;
+    unsigned int tangent_age = 0;
+    double previous_error_residual = 0;
+    Utils::ForcingTerm forcing(parameters.solid_max_forcing);
+
     while ((normalized_error_update > parameters.tol_d ||
             normalized_error_residual > parameters.tol_f) &&
            error_residual > 1e-12 && error_update > 1e-12)
@@ -107,24 +87,36 @@ namespace Solid
                     ExcMessage("Too many Newton iterations!"));
 
         // Compute the displacement, velocity and acceleration
-        current_acceleration = current_displacement;
-        current_acceleration -= predicted_displacement;
-        current_acceleration /= (beta * dt * dt);
-        current_velocity = previous_velocity;
-        current_velocity.add(dt * (1 - gamma),
-                             previous_acceleration,
-                             dt * gamma,
-                             current_acceleration);
+        newmark.correct_from_displacement(current_displacement,
+                                          predicted_displacement,
+                                          current_acceleration,
+                                          current_velocity,
+                                          previous_acceleration,
+                                          previous_velocity);
 
         // Assemble the system, and modify the RHS to account for
         // the time-discretization.
-        assemble_system(false);
+        assemble_system(false, assemble_tangent);
         mass_matrix.vmult(tmp, current_acceleration);
         system_rhs -= tmp;
+        if (assemble_tangent)
+          {
+            tangent_age = 0;
+            // Make solve_factorized factorize the new tangent.
+            this->factorized_delta_t = 0;
+          }
 
+        // The forcing term of the inexact Newton method, which is ignored by
+        // the direct solver.
+        const double eta = parameters.solid_inexact_newton
+                             ? forcing.next(system_rhs.l2_norm())
+                             : 0;
         // Solve linear system
         const std::pair<unsigned int, double> lin_solver_output =
-          this->solve(system_matrix, newton_update, system_rhs);
+          parameters.solid_tangent_reuse > 0 &&
+              parameters.solid_cached_factorization
+            ? this->solve_factorized(newton_update, system_rhs)
+            : this->solve(system_matrix, newton_update, system_rhs, eta);
 
         // Error evaluation
         {
@@ -143,6 +135,15 @@ namespace Solid
           normalized_error_update = error_update / initial_error_update;
         }
 
+        // Reassemble the tangent if it is too old, or if it has not halved
+        // the residual.
+        ++tangent_age;
+        assemble_tangent =
+          tangent_age > parameters.solid_tangent_reuse ||
+          (newton_iteration > 0 &&
+           error_residual > 0.5 * previous_error_residual);
+        previous_error_residual = error_residual;
+
         current_displacement += newton_update;
         // Update the quadrature point history with the newest displacement
         update_qph(current_displacement);
@@ -157,19 +158,15 @@ namespace Solid
         newton_iteration++;
       }
 
-    // Once converged, update current acceleration and velocity again.
-    current_acceleration = current_displacement;
-    current_acceleration -= predicted_displacement;
-    current_acceleration /= (beta * dt * dt);
-    current_velocity = previous_velocity;
-    current_velocity.add(dt * (1 - gamma),
-                         previous_acceleration,
-                         dt * gamma,
-                         current_acceleration);
-    // Update the previous values
-    previous_acceleration = current_acceleration;
-    previous_velocity = current_velocity;
-    previous_displacement = current_displacement;
+    // Once converged, update current acceleration and velocity again, and
+    // the previous values in the same pass.
+    newmark.correct_from_displacement(current_displacement,
+                                      predicted_displacement,
+                                      current_acceleration,
+                                      current_velocity,
+                                      previous_acceleration,
+                                      previous_velocity,
+                                      previous_displacement);
 
     std::cout << std::string(100, '_') << std::endl
               << "Relative errors:" << std::endl
@@ -194,22 +191,25 @@ namespace Solid
   template <int dim>
   void HyperElasticity<dim>::setup_qph()
   {
+    Assert(parameters.solid_type == "NeoHookean", ExcNotImplemented());
     const unsigned int n_q_points = volume_quad_formula.size();
-    quad_point_history.initialize(
-      triangulation.begin_active(), triangulation.end(), n_q_points);
+    quad_point_history.reinit(parameters,
+                              triangulation.n_active_cells(),
+                              triangulation.n_active_cells(),
+                              n_q_points);
+    // Start from the undeformed configuration.
+    const std::vector<Tensor<2, dim>> grad_u(n_q_points);
     for (auto cell = triangulation.begin_active(); cell != triangulation.end();
          ++cell)
       {
         unsigned int mat_id = cell->material_id();
         if (parameters.n_solid_parts == 1)
           mat_id = 1;
-        const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-          quad_point_history.get_data(cell);
-        Assert(lqph.size() == n_q_points, ExcInternalError());
-        for (unsigned int q = 0; q < n_q_points; ++q)
-          {
-            lqph[q]->setup(parameters, mat_id);
-          }
+        quad_point_history.add_cell(cell->active_cell_index(), mat_id);
+        HyperElasticKernel<NeoHookean, dim>::update(
+          quad_point_history,
+          quad_point_history.begin(cell->active_cell_index()),
+          grad_u);
       }
   }
 
@@ -221,25 +221,23 @@ namespace Solid
     // displacement gradient at quad points
     const unsigned int n_q_points = volume_quad_formula.size();
     FEValuesExtractors::Vector displacement(0);
-    std::vector<Tensor<2, dim>> grad_u(volume_quad_formula.size());
+    std::vector<Tensor<2, dim>> grad_u(n_q_points);
     FEValues<dim> fe_values(
       fe, volume_quad_formula, update_values | update_gradients);
 
     for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
          ++cell)
       {
-        const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-          quad_point_history.get_data(cell);
-        Assert(lqph.size() == n_q_points, ExcInternalError());
+        const unsigned int first_point =
+          quad_point_history.begin(cell->active_cell_index());
 
         fe_values.reinit(cell);
         fe_values[displacement].get_function_gradients(evaluation_point,
                                                        grad_u);
 
-        for (unsigned int q = 0; q < n_q_points; ++q)
-          {
-            lqph[q]->update(parameters, grad_u[q]);
-          }
+        // NeoHookean is the only material, see setup_qph.
+        HyperElasticKernel<NeoHookean, dim>::update(
+          quad_point_history, first_point, grad_u);
       }
     timer.leave_subsection();
   }
@@ -254,12 +252,12 @@ namespace Solid
          ++cell)
       {
         fe_values.reinit(cell);
-        const std::vector<std::shared_ptr<const Internal::PointHistory<dim>>>
-          lqph = quad_point_history.get_data(cell);
-        Assert(lqph.size() == n_q_points, ExcInternalError());
+        const unsigned int first_point =
+          quad_point_history.begin(cell->active_cell_index());
         for (unsigned int q = 0; q < n_q_points; ++q)
           {
-            const double det = lqph[q]->get_det_F();
+            const unsigned int point = first_point + q;
+            const double det = quad_point_history.get_det_F(point);
             const double JxW = fe_values.JxW(q);
             volume += det * JxW;
           }
@@ -299,7 +297,8 @@ namespace Solid
   }
 
   template <int dim>
-  void HyperElasticity<dim>::assemble_system(bool initial_step)
+  void HyperElasticity<dim>::assemble_system(bool initial_step,
+                                             bool assemble_matrix)
   {
     timer.enter_subsection("Assemble tangent matrix");
 
@@ -314,29 +313,61 @@ namespace Solid
       {
         mass_matrix = 0.0;
       }
-    system_matrix = 0.0;
+    if (assemble_matrix)
+      {
+        system_matrix = 0.0;
+      }
     system_rhs = 0.0;
 
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_gradients |
-                              update_JxW_values);
-    FEFaceValues<dim> fe_face_values(fe,
-                                     face_quad_formula,
-                                     update_values | update_normal_vectors |
-                                       update_JxW_values);
-
-    std::vector<std::vector<Tensor<1, dim>>> phi(
-      n_q_points, std::vector<Tensor<1, dim>>(dofs_per_cell));
-    std::vector<std::vector<Tensor<2, dim>>> grad_phi(
-      n_q_points, std::vector<Tensor<2, dim>>(dofs_per_cell));
-    std::vector<std::vector<SymmetricTensor<2, dim>>> sym_grad_phi(
-      n_q_points, std::vector<SymmetricTensor<2, dim>>(dofs_per_cell));
-
-    FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-    FullMatrix<double> local_mass(dofs_per_cell, dofs_per_cell);
-    Vector<double> local_rhs(dofs_per_cell);
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    // The FEValues and the shape function arrays of a thread.
+    struct ScratchData
+    {
+      ScratchData(const FESystem<dim> &fe,
+                  const QGauss<dim> &quad,
+                  const QGauss<dim - 1> &face_quad)
+        : fe_values(fe,
+                    quad,
+                    update_values | update_gradients | update_JxW_values),
+          fe_face_values(fe,
+                         face_quad,
+                         update_values | update_normal_vectors |
+                           update_JxW_values),
+          phi(quad.size(), std::vector<Tensor<1, dim>>(fe.dofs_per_cell)),
+          grad_phi(quad.size(), std::vector<Tensor<2, dim>>(fe.dofs_per_cell)),
+          sym_grad_phi(quad.size(),
+                       std::vector<SymmetricTensor<2, dim>>(fe.dofs_per_cell)),
+          Jc_sym_grad_phi(fe.dofs_per_cell)
+      {
+      }
+      ScratchData(const ScratchData &scratch)
+        : fe_values(scratch.fe_values.get_fe(),
+                    scratch.fe_values.get_quadrature(),
+                    scratch.fe_values.get_update_flags()),
+          fe_face_values(scratch.fe_face_values.get_fe(),
+                         scratch.fe_face_values.get_quadrature(),
+                         scratch.fe_face_values.get_update_flags()),
+          phi(scratch.phi),
+          grad_phi(scratch.grad_phi),
+          sym_grad_phi(scratch.sym_grad_phi),
+          Jc_sym_grad_phi(scratch.Jc_sym_grad_phi)
+      {
+      }
+      FEValues<dim> fe_values;
+      FEFaceValues<dim> fe_face_values;
+      std::vector<std::vector<Tensor<1, dim>>> phi;
+      std::vector<std::vector<Tensor<2, dim>>> grad_phi;
+      std::vector<std::vector<SymmetricTensor<2, dim>>> sym_grad_phi;
+      std::vector<SymmetricTensor<2, dim>> Jc_sym_grad_phi;
+    };
+
+    // The local contributions of a cell.
+    struct CopyData
+    {
+      FullMatrix<double> local_matrix;
+      FullMatrix<double> local_mass;
+      Vector<double> local_rhs;
+      std::vector<types::global_dof_index> local_dof_indices;
+    };
 
     Tensor<1, dim> gravity;
     for (unsigned int i = 0; i < dim; ++i)
@@ -344,26 +375,39 @@ namespace Solid
         gravity[i] = parameters.gravity[i];
       }
 
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
-      {
+    // The cells only read the history, the solution and the cell data, the
+    // global matrices and the rhs are only written by the copier.
+    auto local_assemble =
+      [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+          ScratchData &scratch,
+          CopyData &data) {
+        FEValues<dim> &fe_values = scratch.fe_values;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        auto &phi = scratch.phi;
+        auto &grad_phi = scratch.grad_phi;
+        auto &sym_grad_phi = scratch.sym_grad_phi;
+        auto &Jc_sym_grad_phi = scratch.Jc_sym_grad_phi;
+        FullMatrix<double> &local_matrix = data.local_matrix;
+        FullMatrix<double> &local_mass = data.local_mass;
+        Vector<double> &local_rhs = data.local_rhs;
+
         auto p = cell_property.get_data(cell);
         Assert(p.size() == GeometryInfo<dim>::faces_per_cell,
                ExcMessage("Wrong number of cell data!"));
         fe_values.reinit(cell);
-        cell->get_dof_indices(local_dof_indices);
+        cell->get_dof_indices(data.local_dof_indices);
 
         local_mass = 0;
         local_matrix = 0;
         local_rhs = 0;
 
-        const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-          quad_point_history.get_data(cell);
-        Assert(lqph.size() == n_q_points, ExcInternalError());
+        const unsigned int first_point =
+          quad_point_history.begin(cell->active_cell_index());
 
         for (unsigned int q = 0; q < n_q_points; ++q)
           {
-            const Tensor<2, dim> F_inv = lqph[q]->get_F_inv();
+            const unsigned int point = first_point + q;
+            const Tensor<2, dim> F_inv = quad_point_history.get_F_inv(point);
             for (unsigned int k = 0; k < dofs_per_cell; ++k)
               {
                 phi[q][k] = fe_values[displacement].value(k, q);
@@ -371,12 +415,24 @@ namespace Solid
                 sym_grad_phi[q][k] = symmetrize(grad_phi[q][k]);
               }
 
-            const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-            const SymmetricTensor<4, dim> Jc = lqph[q]->get_Jc();
-            const double rho = lqph[q]->get_density();
+            const SymmetricTensor<2, dim> tau =
+              quad_point_history.get_tau(point);
+            const SymmetricTensor<4, dim> &Jc =
+              quad_point_history.get_Jc(point);
+            const double rho = quad_point_history.get_density();
             const double dt = time.get_delta_t();
             const double JxW = fe_values.JxW(q);
 
+            if (!initial_step && assemble_matrix)
+              {
+                // Contract the tangent once per shape function rather
+                // than once per pair of them.
+                for (unsigned int k = 0; k < dofs_per_cell; ++k)
+                  {
+                    Jc_sym_grad_phi[k] = Jc * sym_grad_phi[q][k];
+                  }
+              }
+
             for (unsigned int i = 0; i < dofs_per_cell; ++i)
               {
                 const unsigned int component_i =
@@ -387,13 +443,13 @@ namespace Solid
                       {
                         local_mass(i, j) += rho * phi[q][i] * phi[q][j] * JxW;
                       }
-                    else
+                    else if (assemble_matrix)
                       {
                         const unsigned int component_j =
                           fe.system_to_component_index(j).first;
                         local_matrix(i, j) +=
                           (phi[q][i] * phi[q][j] * rho / (beta * dt * dt) +
-                           sym_grad_phi[q][i] * Jc * sym_grad_phi[q][j]) *
+                           sym_grad_phi[q][i] * Jc_sym_grad_phi[j]) *
                           JxW;
                         if (component_i == component_j)
                           {
@@ -423,28 +479,16 @@ namespace Solid
           }
 
         // Neumann boundary conditions
-        // If this is a stand-alone solid simulation, the Neumann boundary type
-        // should be either Traction or Pressure;
-        // it this is a FSI simulation, the Neumann boundary type must be FSI.
+        // If this is a stand-alone solid simulation, the Neumann boundary
+        // type should be either Traction or Pressure;
+        // it this is a FSI simulation, the Neumann boundary type must be
+        // FSI.
 
-        for (unsigned int face = 0; face < GeometryInfo<dim>::faces_per_cell;
-             ++face)
+        for (const auto &neumann_face :
+             neumann_faces(cell->active_cell_index()))
           {
-            unsigned int id = cell->face(face)->boundary_id();
-
-            if (!cell->face(face)->at_boundary())
-              {
-                // Not a boundary
-                continue;
-              }
-
-            if (parameters.simulation_type != "FSI" &&
-                parameters.solid_neumann_bcs.find(id) ==
-                  parameters.solid_neumann_bcs.end())
-              {
-                // Traction-free boundary, do nothing
-                continue;
-              }
+            const unsigned int face = neumann_face.face;
+            unsigned int id = neumann_face.boundary_id;
 
             fe_face_values.reinit(cell, face);
 
@@ -454,7 +498,7 @@ namespace Solid
               {
                 // In stand-alone simulation, the boundary value is prescribed
                 // by the user.
-                prescribed_value = parameters.solid_neumann_bcs[id];
+                prescribed_value = parameters.solid_neumann_bcs.at(id);
               }
 
             if (parameters.simulation_type != "FSI" &&
@@ -490,25 +534,45 @@ namespace Solid
                                     fe_face_values.JxW(q);
                   }
               }
-          }
+            }
+      };
 
-        if (initial_step)
-          {
-            constraints.distribute_local_to_global(local_mass,
-                                                   local_rhs,
-                                                   local_dof_indices,
-                                                   mass_matrix,
-                                                   system_rhs);
-          }
-        else
-          {
-            constraints.distribute_local_to_global(local_matrix,
-                                                   local_rhs,
-                                                   local_dof_indices,
-                                                   system_matrix,
-                                                   system_rhs);
-          }
-      }
+    auto copy_local_to_global = [&](const CopyData &data) {
+      if (initial_step)
+        {
+          constraints.distribute_local_to_global(data.local_mass,
+                                                 data.local_rhs,
+                                                 data.local_dof_indices,
+                                                 mass_matrix,
+                                                 system_rhs);
+        }
+      else if (assemble_matrix)
+        {
+          constraints.distribute_local_to_global(data.local_matrix,
+                                                 data.local_rhs,
+                                                 data.local_dof_indices,
+                                                 system_matrix,
+                                                 system_rhs);
+        }
+      else
+        {
+          constraints.distribute_local_to_global(
+            data.local_rhs, data.local_dof_indices, system_rhs);
+        }
+    };
+
+    CopyData sample;
+    sample.local_matrix.reinit(dofs_per_cell, dofs_per_cell);
+    sample.local_mass.reinit(dofs_per_cell, dofs_per_cell);
+    sample.local_rhs.reinit(dofs_per_cell);
+    sample.local_dof_indices.resize(dofs_per_cell);
+    WorkStream::run(
+      dof_handler.begin_active(),
+      dof_handler.end(),
+      local_assemble,
+      copy_local_to_global,
+      ScratchData(fe, volume_quad_formula, face_quad_formula),
+      sample);
 
     timer.leave_subsection();
   }
@@ -524,82 +588,51 @@ namespace Solid
             stress[i][j] = 0.0;
           }
       }
-    std::vector<int> surrounding_cells(scalar_dof_handler.n_dofs(), 0);
-    // The strain and stress tensors are stored as 2D vectors of shape dim*dim
-    // at cell and quadrature point level.
-    std::vector<std::vector<Vector<double>>> cell_strain(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(scalar_fe.dofs_per_cell)));
-    std::vector<std::vector<Vector<double>>> cell_stress(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(scalar_fe.dofs_per_cell)));
-    std::vector<std::vector<Vector<double>>> quad_strain(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(volume_quad_formula.size())));
-    std::vector<std::vector<Vector<double>>> quad_stress(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(volume_quad_formula.size())));
-
-    // The projection matrix from quadrature points to the dofs.
-    FullMatrix<double> qpt_to_dof(scalar_fe.dofs_per_cell,
-                                  volume_quad_formula.size());
-    FETools::compute_projection_from_quadrature_points_matrix(
-      scalar_fe, volume_quad_formula, volume_quad_formula, qpt_to_dof);
-
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_gradients |
-                              update_quadrature_points | update_JxW_values);
+    // The deformation gradient and the Cauchy stress are projected as the
+    // components i * dim + j and dim * dim + i * dim + j.
+    Utils::NodalProjection<dim> projection(scalar_fe,
+                                           volume_quad_formula,
+                                           2 * dim * dim,
+                                           scalar_dof_handler.n_dofs());
+
     auto cell = dof_handler.begin_active();
     auto scalar_cell = scalar_dof_handler.begin_active();
     std::vector<types::global_dof_index> dof_indices(scalar_fe.dofs_per_cell);
     for (; cell != dof_handler.end(); ++cell, ++scalar_cell)
       {
-        scalar_cell->get_dof_indices(dof_indices);
-        fe_values.reinit(cell);
-        const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-          quad_point_history.get_data(cell);
+        const unsigned int first_point =
+          quad_point_history.begin(cell->active_cell_index());
 
         for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
           {
-            const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-            const Tensor<2, dim> F = invert(lqph[q]->get_F_inv());
-            const double J = lqph[q]->get_det_F();
+            const unsigned int point = first_point + q;
+            const SymmetricTensor<2, dim> tau =
+              quad_point_history.get_tau(point);
+            const Tensor<2, dim> F =
+              invert(quad_point_history.get_F_inv(point));
+            const double J = quad_point_history.get_det_F(point);
             for (unsigned int i = 0; i < dim; ++i)
               {
                 for (unsigned int j = 0; j < dim; ++j)
                   {
-                    quad_strain[i][j][q] = F[i][j];
-                    quad_stress[i][j][q] = tau[i][j] / J;
-                  }
-              }
-          }
-
-        for (unsigned int i = 0; i < dim; ++i)
-          {
-            for (unsigned int j = 0; j < dim; ++j)
-              {
-                qpt_to_dof.vmult(cell_strain[i][j], quad_strain[i][j]);
-                qpt_to_dof.vmult(cell_stress[i][j], quad_stress[i][j]);
-                for (unsigned int k = 0; k < scalar_fe.dofs_per_cell; ++k)
-                  {
-                    strain[i][j][dof_indices[k]] += cell_strain[i][j][k];
-                    stress[i][j][dof_indices[k]] += cell_stress[i][j][k];
-                    if (i == 0 && j == 0)
-                      surrounding_cells[dof_indices[k]]++;
+                    projection.value(q, i * dim + j) = F[i][j];
+                    projection.value(q, dim * dim + i * dim + j) =
+                      tau[i][j] / J;
                   }
               }
           }
+        scalar_cell->get_dof_indices(dof_indices);
+        projection.add_cell(dof_indices);
       }
 
+    Vector<double> surrounding_cells(scalar_dof_handler.n_dofs());
+    projection.add_counts_to(surrounding_cells);
     for (unsigned int i = 0; i < dim; ++i)
       {
         for (unsigned int j = 0; j < dim; ++j)
           {
+            projection.add_to(i * dim + j, strain[i][j]);
+            projection.add_to(dim * dim + i * dim + j, stress[i][j]);
             for (unsigned int k = 0; k < scalar_dof_handler.n_dofs(); ++k)
               {
                 strain[i][j][k] /= surrounding_cells[k];
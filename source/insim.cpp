@@ -5,9 +5,9 @@ namespace Fluid
   /**
    * The initialization of the direct solver is expensive as it allocates
    * a lot of memory. The preconditioner is going to be applied several
-   * times before it is re-initialized. Therefore initializing the direct
-   * solver in the constructor saves time. However, it is pointless to do
-   * this to iterative solvers.
+   * times before it is re-initialized. Therefore the direct solver is
+   * factorized before the preconditioner is constructed, and kept by InsIM.
+   * However, it is pointless to do this to iterative solvers.
    */
   template <int dim>
   InsIM<dim>::BlockSchurPreconditioner::BlockSchurPreconditioner(
@@ -18,7 +18,8 @@ namespace Fluid
     double dt,
     const BlockSparseMatrix<double> &system,
     const BlockSparseMatrix<double> &mass,
-    SparseMatrix<double> &schur)
+    SparseMatrix<double> &schur,
+    const Utils::UMFPACKFactorization &A_inverse)
     : timer(timer),
       gamma(gamma),
       viscosity(viscosity),
@@ -26,13 +27,9 @@ namespace Fluid
       dt(dt),
       system_matrix(&system),
       mass_matrix(&mass),
-      mass_schur(&schur)
+      mass_schur(&schur),
+      A_inverse(&A_inverse)
   {
-    {
-      // Factoring A is also part of the direct solver.
-      TimerOutput::Scope timer_section(timer, "UMFPACK for A_inv");
-      A_inverse.initialize(system_matrix->block(0, 0));
-    }
     {
       TimerOutput::Scope timer_section(timer, "CG for Sm");
       Vector<double> tmp1(mass_matrix->block(0, 0).m()), tmp2(tmp1);
@@ -113,7 +110,7 @@ namespace Fluid
     // the direct solver.
     {
       TimerOutput::Scope timer_section(timer, "UMFPACK for A_inv");
-      A_inverse.vmult(dst.block(0), utmp);
+      A_inverse->vmult(dst.block(0), utmp);
     }
   }
 
@@ -121,7 +118,7 @@ namespace Fluid
   InsIM<dim>::InsIM(Triangulation<dim> &tria,
                     const Parameters::AllParameters &parameters,
                     std::shared_ptr<Function<dim>> bc)
-    : FluidSolver<dim>(tria, parameters, bc)
+    : FluidSolver<dim>(tria, parameters, bc), last_gmres_iterations(0)
   {
     Assert(
       parameters.fluid_velocity_degree - parameters.fluid_pressure_degree == 1,
@@ -134,6 +131,9 @@ namespace Fluid
   {
     FluidSolver<dim>::initialize_system();
     preconditioner.reset();
+    // The sparsity pattern may have changed.
+    A_inverse.clear();
+    last_gmres_iterations = 0;
     newton_update.reinit(dofs_per_block);
     evaluation_point.reinit(dofs_per_block);
   }
@@ -153,16 +153,6 @@ namespace Fluid
     mass_matrix = 0;
     system_rhs = 0;
 
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_quadrature_points |
-                              update_JxW_values | update_gradients);
-    FEFaceValues<dim> fe_face_values(fe,
-                                     face_quad_formula,
-                                     update_values | update_normal_vectors |
-                                       update_quadrature_points |
-                                       update_JxW_values);
-
     const unsigned int dofs_per_cell = fe.dofs_per_cell;
     const unsigned int u_dofs = fe.base_element(0).dofs_per_cell;
     const unsigned int p_dofs = fe.base_element(1).dofs_per_cell;
@@ -175,26 +165,26 @@ namespace Fluid
     const FEValuesExtractors::Vector velocities(0);
     const FEValuesExtractors::Scalar pressure(dim);
 
-    FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-    FullMatrix<double> local_mass_matrix(dofs_per_cell, dofs_per_cell);
-    Vector<double> local_rhs(dofs_per_cell);
-
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-    std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-    std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-    std::vector<double> current_pressure_values(n_q_points);
-    std::vector<Tensor<1, dim>> present_velocity_values(n_q_points);
-
-    std::vector<double> div_phi_u(dofs_per_cell);
-    std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-    std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-    std::vector<double> phi_p(dofs_per_cell);
-
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
-      {
-        auto p = cell_property.get_data(cell);
+    // The cell loop runs on WorkStream, see assemble_cells.
+    auto local_assemble =
+      [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+          AssemblyScratchData &scratch,
+          AssemblyCopyData &data) {
+        FEValues<dim> &fe_values = scratch.fe_values;
+        FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+        auto &local_matrix = data.local_matrix;
+        auto &local_mass_matrix = data.local_mass_matrix;
+        auto &local_rhs = data.local_rhs;
+        auto &current_velocity_values = scratch.current_velocity_values;
+        auto &current_velocity_gradients = scratch.current_velocity_gradients;
+        auto &current_pressure_values = scratch.current_pressure_values;
+        auto &present_velocity_values = scratch.present_velocity_values;
+        auto &div_phi_u = scratch.div_phi_u;
+        auto &phi_u = scratch.phi_u;
+        auto &grad_phi_u = scratch.grad_phi_u;
+        auto &phi_p = scratch.phi_p;
+
+        const auto p = cell_property.get_data(cell);
         const int ind = p[0]->indicator;
         const double rho = parameters.fluid_rho;
 
@@ -302,7 +292,7 @@ namespace Fluid
                     fe_face_values.reinit(cell, face_n);
                     unsigned int p_bc_id = cell->face(face_n)->boundary_id();
                     double boundary_values_p =
-                      parameters.fluid_neumann_bcs[p_bc_id];
+                      parameters.fluid_neumann_bcs.at(p_bc_id);
                     for (unsigned int q = 0; q < n_face_q_points; ++q)
                       {
                         for (unsigned int i = 0; i < dofs_per_cell; ++i)
@@ -317,19 +307,23 @@ namespace Fluid
               }
           }
 
-        cell->get_dof_indices(local_dof_indices);
-
-        const AffineConstraints<double> &constraints_used =
-          use_nonzero_constraints ? nonzero_constraints : zero_constraints;
-        constraints_used.distribute_local_to_global(local_matrix,
-                                                    local_rhs,
-                                                    local_dof_indices,
-                                                    system_matrix,
-                                                    system_rhs,
-                                                    true);
-        constraints_used.distribute_local_to_global(
-          local_mass_matrix, local_dof_indices, mass_matrix);
-      }
+        cell->get_dof_indices(data.local_dof_indices);
+      };
+
+    const AffineConstraints<double> &constraints_used =
+      use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+    auto copy_local_to_global = [&](const AssemblyCopyData &data) {
+      constraints_used.distribute_local_to_global(data.local_matrix,
+                                                  data.local_rhs,
+                                                  data.local_dof_indices,
+                                                  system_matrix,
+                                                  system_rhs,
+                                                  true);
+      constraints_used.distribute_local_to_global(
+        data.local_mass_matrix, data.local_dof_indices, mass_matrix);
+    };
+
+    assemble_cells(local_assemble, copy_local_to_global);
   }
 
   template <int dim>
@@ -338,6 +332,15 @@ namespace Fluid
   {
     TimerOutput::Scope timer_section(timer, "Solve linear system");
 
+    // Factoring A is also part of the direct solver. Only the numerical
+    // factorization is redone, and the stale one is kept if the last solve
+    // converged fast enough.
+    {
+      TimerOutput::Scope timer_section(timer, "UMFPACK for A_inv");
+      A_inverse.update(system_matrix.block(0, 0),
+                       last_gmres_iterations <
+                         parameters.fluid_stale_factor_iterations);
+    }
     preconditioner.reset(new BlockSchurPreconditioner(timer,
                                                       parameters.grad_div,
                                                       parameters.viscosity,
@@ -345,7 +348,8 @@ namespace Fluid
                                                       time.get_delta_t(),
                                                       system_matrix,
                                                       mass_matrix,
-                                                      mass_schur));
+                                                      mass_schur,
+                                                      A_inverse));
 
     // NOTE: SolverFGMRES only applies the preconditioner from the right,
     // as opposed to SolverGMRES which allows both left and right
@@ -361,6 +365,7 @@ namespace Fluid
       use_nonzero_constraints ? nonzero_constraints : zero_constraints;
     constraints_used.distribute(newton_update);
 
+    last_gmres_iterations = solver_control.last_step();
     return {solver_control.last_step(), solver_control.last_value()};
   }
 
@@ -432,11 +437,11 @@ namespace Fluid
     solution_increment -= present_solution;
     // Newton iteration converges, update time and solution
     present_solution = evaluation_point;
-    // Update stress for output
-    update_stress();
     // Output
     if (time.time_to_output())
       {
+        // The stress is only needed by the output.
+        update_stress();
         output_results(time.get_timestep());
       }
     if (parameters.simulation_type == "Fluid" && time.time_to_refine())
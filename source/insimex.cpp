@@ -374,11 +374,11 @@ namespace Fluid
 
     std::cout << std::scientific << std::left << " GMRES_ITR = " << std::setw(3)
               << state.first << " GMRES_RES = " << state.second << std::endl;
-    // Update stress for output
-    update_stress();
     // Output
     if (time.time_to_output())
       {
+        // The stress is only needed by the output.
+        update_stress();
         output_results(time.get_timestep());
       }
     if (parameters.simulation_type == "Fluid" && time.time_to_refine())
@@ -0,0 +1,344 @@
+#include "instrumentation.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace Utils
+{
+  CouplingProfiler::CouplingProfiler(const MPI_Comm &comm,
+                                     const std::string &name,
+                                     const std::vector<std::string> &quantities)
+    : mpi_communicator(comm),
+      filename(name),
+      names(quantities),
+      values(quantities.size(), 0)
+  {
+    if (enabled() && Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      {
+        file.open(filename);
+        AssertThrow(file, ExcFileNotOpen(filename));
+        file << "step,time,quantity,min,max,avg,min_rank,max_rank"
+             << std::endl;
+      }
+  }
+
+  CouplingProfiler::Scope::Scope(CouplingProfiler &p, const std::string &name)
+    : profiler(p),
+      index(profiler.enabled() ? profiler.get_index(name)
+                               : numbers::invalid_unsigned_int)
+  {
+  }
+
+  CouplingProfiler::Scope::~Scope()
+  {
+    if (index != numbers::invalid_unsigned_int)
+      {
+        profiler.values[index] += timer.wall_time();
+      }
+  }
+
+  unsigned int CouplingProfiler::get_index(const std::string &name) const
+  {
+    auto it = std::find(names.begin(), names.end(), name);
+    Assert(it != names.end(),
+           ExcMessage("The quantity " + name + " is not profiled!"));
+    return it - names.begin();
+  }
+
+  void CouplingProfiler::add(const std::string &name, const double value)
+  {
+    if (enabled())
+      {
+        values[get_index(name)] += value;
+      }
+  }
+
+  void CouplingProfiler::end_step(const unsigned int step, const double time)
+  {
+    if (!enabled())
+      {
+        return;
+      }
+    const bool root = Utilities::MPI::this_mpi_process(mpi_communicator) == 0;
+    for (unsigned int i = 0; i < names.size(); ++i)
+      {
+        const auto data =
+          Utilities::MPI::min_max_avg(values[i], mpi_communicator);
+        if (root)
+          {
+            file << step << "," << time << "," << names[i] << "," << data.min
+                 << "," << data.max << "," << data.avg << "," << data.min_index
+                 << "," << data.max_index << "\n";
+          }
+        values[i] = 0;
+      }
+    if (root)
+      {
+        file.flush();
+      }
+  }
+
+  PerformanceSummary::PerformanceSummary(const MPI_Comm &comm,
+                                         const std::string &name)
+    : mpi_communicator(comm), filename(name)
+  {
+  }
+
+  void PerformanceSummary::add(const std::string &name, const double value)
+  {
+    if (enabled())
+      {
+        counters[name] += value;
+      }
+  }
+
+  void PerformanceSummary::write(const std::string &name,
+                                 const TimerOutput &timer)
+  {
+    if (!enabled() || Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+      {
+        counters.clear();
+        return;
+      }
+    std::ofstream file(filename, std::ios::app);
+    AssertThrow(file, ExcFileNotOpen(filename));
+    auto write_map = [&file](const std::map<std::string, double> &data) {
+      file << "{";
+      for (auto it = data.begin(); it != data.end(); ++it)
+        {
+          file << (it == data.begin() ? "" : ", ") << "\"" << it->first
+               << "\": " << it->second;
+        }
+      file << "}";
+    };
+    file << std::setprecision(10) << "{\"name\": \"" << name
+         << "\", \"sections\": ";
+    write_map(timer.get_summary_data(TimerOutput::total_wall_time));
+    file << ", \"counters\": ";
+    write_map(counters);
+    file << "}" << std::endl;
+    counters.clear();
+  }
+
+#ifdef OPENIFEM_WITH_LIKWID
+  namespace
+  {
+    // Initializes the marker API of the process and writes the counts of the
+    // regions at exit.
+    struct LikwidMarkers
+    {
+      LikwidMarkers()
+      {
+        likwid_markerInit();
+        likwid_markerThreadInit();
+      }
+      ~LikwidMarkers() { likwid_markerClose(); }
+    };
+  } // namespace
+#endif
+
+  CounterRegion::CounterRegion(const std::string &name)
+  {
+#ifdef OPENIFEM_WITH_LIKWID
+    static LikwidMarkers markers;
+    tag = name;
+    std::replace(tag.begin(), tag.end(), ' ', '_');
+    likwid_markerStartRegion(tag.c_str());
+#else
+    (void)name;
+#endif
+  }
+
+  CounterRegion::~CounterRegion()
+  {
+#ifdef OPENIFEM_WITH_LIKWID
+    likwid_markerStopRegion(tag.c_str());
+#endif
+  }
+
+  Telemetry::Telemetry(const MPI_Comm &comm,
+                       const std::string &prefix,
+                       const std::string &solver)
+    : in_step(false), step(0), time(0)
+  {
+    if (!prefix.empty() && Utilities::MPI::this_mpi_process(comm) == 0)
+      {
+        filename = prefix + "_" + solver + ".csv";
+      }
+  }
+
+  Telemetry::~Telemetry() { flush(); }
+
+  void Telemetry::watch(const TimerOutput &timer, const std::string &prefix)
+  {
+    timers.emplace_back(&timer, prefix);
+  }
+
+  void Telemetry::begin_step(const unsigned int new_step,
+                             const double new_time)
+  {
+    if (!enabled())
+      {
+        return;
+      }
+    flush();
+    // The file is only created by a solver that runs, e.g. not by the fluid
+    // solver on the solid processes of a split FSI.
+    if (!file.is_open())
+      {
+        file.open(filename);
+        AssertThrow(file, ExcFileNotOpen(filename));
+        file << std::setprecision(10) << "step,time,quantity,value"
+             << std::endl;
+        // Leave the setup before the first step out of it.
+        for (const auto &timer : timers)
+          {
+            for (const auto &section : timer.first->get_summary_data(
+                   TimerOutput::total_wall_time))
+              {
+                last_totals[timer.second + section.first] = section.second;
+              }
+          }
+      }
+    in_step = true;
+    step = new_step;
+    time = new_time;
+  }
+
+  void Telemetry::add(const std::string &name, const double value)
+  {
+    if (in_step)
+      {
+        values[name] += value;
+      }
+  }
+
+  void Telemetry::set(const std::string &name, const double value)
+  {
+    if (in_step)
+      {
+        values[name] = value;
+      }
+  }
+
+  void Telemetry::flush()
+  {
+    if (!in_step)
+      {
+        return;
+      }
+    // The timers only keep the totals, so the time of a step is the
+    // difference to the totals at the end of the previous one.
+    for (const auto &timer : timers)
+      {
+        for (const auto &section :
+             timer.first->get_summary_data(TimerOutput::total_wall_time))
+          {
+            const std::string name = timer.second + section.first;
+            const double elapsed = section.second - last_totals[name];
+            last_totals[name] = section.second;
+            if (elapsed > 0)
+              {
+                file << step << "," << time << ",\"" << name << "\","
+                     << elapsed << "\n";
+              }
+          }
+      }
+    for (const auto &value : values)
+      {
+        file << step << "," << time << ",\"" << value.first << "\","
+             << value.second << "\n";
+      }
+    file.flush();
+    values.clear();
+    in_step = false;
+  }
+
+  MemoryReport::MemoryReport(const MPI_Comm &comm, const std::string &n)
+    : mpi_communicator(comm), name(n)
+  {
+  }
+
+  void MemoryReport::add(const std::string &subsystem,
+                         const std::string &item,
+                         const double bytes)
+  {
+    items.emplace_back(subsystem, item, bytes);
+  }
+
+  double MemoryReport::matrix_memory(const PETScWrappers::MatrixBase &matrix)
+  {
+    MatInfo info;
+    const PetscErrorCode ierr =
+      MatGetInfo(static_cast<Mat>(matrix), MAT_LOCAL, &info);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    // The memory is only counted by some matrix types, the others are
+    // estimated from the allocated nonzeros.
+    if (info.memory > 0)
+      {
+        return info.memory;
+      }
+    return info.nz_allocated * (sizeof(PetscScalar) + sizeof(PetscInt));
+  }
+
+  double MemoryReport::matrix_memory(
+    const PETScWrappers::MPI::BlockSparseMatrix &matrix)
+  {
+    double bytes = 0;
+    for (unsigned int i = 0; i < matrix.n_block_rows(); ++i)
+      {
+        for (unsigned int j = 0; j < matrix.n_block_cols(); ++j)
+          {
+            bytes += matrix_memory(matrix.block(i, j));
+          }
+      }
+    return bytes;
+  }
+
+  void MemoryReport::print(ConditionalOStream &pcout,
+                           const std::string &stage)
+  {
+    const double MB = 1024.0 * 1024.0;
+    auto print_row = [&pcout, this, MB](const std::string &label,
+                                        const double bytes) {
+      const auto stats = Utilities::MPI::min_max_avg(bytes, mpi_communicator);
+      pcout << "  " << std::left << std::setw(40) << label << std::right
+            << std::fixed << std::setprecision(1) << std::setw(10)
+            << stats.min / MB << std::setw(10) << stats.avg / MB
+            << std::setw(10) << stats.max / MB << std::endl;
+    };
+
+    pcout << "Memory of the " << name << " " << stage
+          << " (MB per process):" << std::endl
+          << "  " << std::left << std::setw(40) << "" << std::right
+          << std::setw(10) << "min" << std::setw(10) << "avg" << std::setw(10)
+          << "max" << std::endl;
+    // The subsystems in the order they were added.
+    std::vector<std::string> subsystems;
+    std::map<std::string, double> totals;
+    for (const auto &item : items)
+      {
+        const std::string &subsystem = std::get<0>(item);
+        if (totals.find(subsystem) == totals.end())
+          {
+            subsystems.push_back(subsystem);
+          }
+        totals[subsystem] += std::get<2>(item);
+        print_row(subsystem + ": " + std::get<1>(item), std::get<2>(item));
+      }
+    for (const auto &subsystem : subsystems)
+      {
+        high_water[subsystem] =
+          std::max(high_water[subsystem], totals[subsystem]);
+        print_row(subsystem + " total", totals[subsystem]);
+      }
+    for (const auto &subsystem : subsystems)
+      {
+        print_row(subsystem + " high-water", high_water[subsystem]);
+      }
+    Utilities::System::MemoryStats stats;
+    Utilities::System::get_memory_stats(stats);
+    print_row("Process peak (VmHWM)", stats.VmHWM * 1024.0);
+    pcout << std::defaultfloat;
+    items.clear();
+  }
+} // namespace Utils
@@ -0,0 +1,134 @@
+#include "linear_algebra.h"
+
+namespace Utils
+{
+  void LinearAlgebraTraits<PETScBackend>::start_ghost_update(
+    BlockVector &ghosted, const BlockVector &owned)
+  {
+    Assert(ghosted.has_ghost_elements(),
+           ExcMessage("The target vector must be ghosted!"));
+    Assert(!owned.has_ghost_elements(),
+           ExcMessage("The source vector must not be ghosted!"));
+    for (unsigned int b = 0; b < ghosted.n_blocks(); ++b)
+      {
+        PetscErrorCode ierr = VecCopy(owned.block(b), ghosted.block(b));
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        ierr = VecGhostUpdateBegin(
+          ghosted.block(b), INSERT_VALUES, SCATTER_FORWARD);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+  }
+
+  void LinearAlgebraTraits<PETScBackend>::finish_ghost_update(
+    BlockVector &ghosted)
+  {
+    for (unsigned int b = 0; b < ghosted.n_blocks(); ++b)
+      {
+        PetscErrorCode ierr =
+          VecGhostUpdateEnd(ghosted.block(b), INSERT_VALUES, SCATTER_FORWARD);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+  }
+
+#ifdef OPENIFEM_WITH_TRILINOS
+  /* ----------------- TrilinosPreconditionSelector ------------------- */
+
+  void TrilinosPreconditionSelector::initialize(
+    const std::string &name,
+    const TrilinosWrappers::SparseMatrix &matrix,
+    const bool symmetric,
+    const std::vector<std::vector<bool>> &constant_modes)
+  {
+    clear();
+
+    if (name == "amg" || name == "gamg")
+      {
+        auto amg = new TrilinosWrappers::PreconditionAMGMueLu;
+        selected.reset(amg);
+        TrilinosWrappers::PreconditionAMGMueLu::AdditionalData data;
+        data.elliptic = symmetric;
+        data.constant_modes = constant_modes;
+        amg->initialize(matrix, data);
+      }
+    else if (name == "pilut" || name == "euclid")
+      {
+        auto ilu = new TrilinosWrappers::PreconditionILU;
+        selected.reset(ilu);
+        ilu->initialize(matrix);
+      }
+    else if (name == "jacobi")
+      {
+        auto jacobi = new TrilinosWrappers::PreconditionJacobi;
+        selected.reset(jacobi);
+        jacobi->initialize(matrix);
+      }
+    else if (name == "sor")
+      {
+        if (symmetric)
+          {
+            auto ssor = new TrilinosWrappers::PreconditionSSOR;
+            selected.reset(ssor);
+            ssor->initialize(matrix);
+          }
+        else
+          {
+            auto sor = new TrilinosWrappers::PreconditionSOR;
+            selected.reset(sor);
+            sor->initialize(matrix);
+          }
+      }
+    else if (name == "chebyshev")
+      {
+        // 5 iterations with Jacobi, as the inner solver of PETSc.
+        auto chebyshev = new TrilinosWrappers::PreconditionChebyshev;
+        selected.reset(chebyshev);
+        TrilinosWrappers::PreconditionChebyshev::AdditionalData data(5);
+        chebyshev->initialize(matrix, data);
+      }
+    else
+      {
+        AssertThrow(name == "none",
+                    ExcMessage("Unknown preconditioner " + name + "!"));
+        auto identity = new TrilinosWrappers::PreconditionIdentity;
+        selected.reset(identity);
+        identity->initialize(matrix);
+      }
+
+    // The operator is owned by the selected preconditioner.
+    preconditioner = Teuchos::rcp(&selected->trilinos_operator(), false);
+  }
+
+  void TrilinosPreconditionSelector::clear()
+  {
+    TrilinosWrappers::PreconditionBase::clear();
+    selected.reset();
+  }
+
+  /* ----------------- TrilinosDirectSolver ------------------- */
+
+  TrilinosDirectSolver::TrilinosDirectSolver() : control(1, 0) {}
+
+  bool
+  TrilinosDirectSolver::update(const TrilinosWrappers::SparseMatrix &matrix,
+                               const bool keep_stale)
+  {
+    if (solver && keep_stale)
+      {
+        return false;
+      }
+    solver.reset(new TrilinosWrappers::SolverDirect(control));
+    solver->initialize(matrix);
+    return true;
+  }
+
+  void TrilinosDirectSolver::clear() { solver.reset(); }
+
+  void
+  TrilinosDirectSolver::vmult(TrilinosWrappers::MPI::Vector &dst,
+                              const TrilinosWrappers::MPI::Vector &src) const
+  {
+    Assert(solver, ExcMessage("The matrix is not factorized!"));
+    solver->solve(dst, src);
+  }
+#endif
+} // namespace Utils
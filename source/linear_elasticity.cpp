@@ -18,6 +18,11 @@ namespace Solid
                                        parameters.eta[i]);
         material[i] = tmp;
       }
+    if (parameters.solid_integrator == "implicit")
+      {
+        this->use_system_matrix = true;
+        this->use_stiffness_matrix = !parameters.solid_matrix_free;
+      }
   }
 
   template <int dim>
@@ -31,7 +36,8 @@ namespace Solid
     if (assemble_matrix)
       {
         system_matrix = 0;
-        stiffness_matrix = 0;
+        if (this->use_stiffness_matrix)
+          stiffness_matrix = 0;
       }
     system_rhs = 0;
 
@@ -60,6 +66,11 @@ namespace Solid
 
     std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
 
+    // The explicit integrator needs the total force on the rhs.
+    const bool internal_force =
+      !assemble_matrix && parameters.solid_integrator == "explicit";
+    std::vector<SymmetricTensor<2, dim>> symmetric_grad_u(n_q_points);
+
     // The symmetric gradients of the displacement shape functions at a certain
     // point.
     // There are dofs_per_cell shape functions so the size is dofs_per_cell.
@@ -85,10 +96,18 @@ namespace Solid
         local_rhs = 0;
 
         fe_values.reinit(cell);
+        if (internal_force)
+          {
+            fe_values[displacements].get_function_symmetric_gradients(
+              current_displacement, symmetric_grad_u);
+          }
 
         // Loop over quadrature points
         for (unsigned int q = 0; q < n_q_points; ++q)
           {
+            const SymmetricTensor<2, dim> sigma =
+              internal_force ? elasticity * symmetric_grad_u[q]
+                             : SymmetricTensor<2, dim>();
             // Loop over the dofs once, to calculate the grad_ph_u
             for (unsigned int k = 0; k < dofs_per_cell; ++k)
               {
@@ -128,6 +147,9 @@ namespace Solid
                     gravity[i] = parameters.gravity[i];
                   }
                 local_rhs[i] += phi[i] * gravity * rho * fe_values.JxW(q);
+                // -internal force
+                local_rhs[i] -=
+                  symmetric_grad_phi[i] * sigma * fe_values.JxW(q);
               }
           }
 
@@ -138,27 +160,19 @@ namespace Solid
         // should be either Traction or Pressure;
         // it this is a FSI simulation, the Neumann boundary type must be FSI.
 
-        for (unsigned int face = 0; face < GeometryInfo<dim>::faces_per_cell;
-             ++face)
+        for (const auto &neumann_face :
+             neumann_faces(cell->active_cell_index()))
           {
-            unsigned int id = cell->face(face)->boundary_id();
+            const unsigned int face = neumann_face.face;
+            unsigned int id = neumann_face.boundary_id;
 
-            if (!cell->face(face)->at_boundary() ||
-                parameters.solid_dirichlet_bcs.find(id) !=
-                  parameters.solid_dirichlet_bcs.end())
+            if (parameters.solid_dirichlet_bcs.find(id) !=
+                parameters.solid_dirichlet_bcs.end())
               {
                 // Not a Neumann boundary
                 continue;
               }
 
-            if (parameters.simulation_type != "FSI" &&
-                parameters.solid_neumann_bcs.find(id) ==
-                  parameters.solid_neumann_bcs.end())
-              {
-                // Traction-free boundary, do nothing
-                continue;
-              }
-
             fe_face_values.reinit(cell, face);
 
             Tensor<1, dim> traction;
@@ -217,8 +231,9 @@ namespace Solid
                                                    local_dof_indices,
                                                    system_matrix,
                                                    system_rhs);
-            constraints.distribute_local_to_global(
-              local_stiffness, local_dof_indices, stiffness_matrix);
+            if (this->use_stiffness_matrix)
+              constraints.distribute_local_to_global(
+                local_stiffness, local_dof_indices, stiffness_matrix);
           }
         else
           {
@@ -241,9 +256,69 @@ namespace Solid
     assemble(false, false);
   }
 
+  template <int dim>
+  void LinearElasticity<dim>::assemble_explicit_force()
+  {
+    Assert(parameters.solid_integrator == "explicit", ExcInternalError());
+    assemble(false, false);
+  }
+
+  template <int dim>
+  void LinearElasticity<dim>::apply_stiffness(const Vector<double> &u,
+                                              Vector<double> &dst)
+  {
+    TimerOutput::Scope timer_section(timer, "Apply stiffness");
+
+    FEValues<dim> fe_values(
+      fe, volume_quad_formula, update_gradients | update_JxW_values);
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    const unsigned int n_q_points = volume_quad_formula.size();
+    Vector<double> local_dst(dofs_per_cell);
+    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    std::vector<SymmetricTensor<2, dim>> symmetric_grad_u(n_q_points);
+    const FEValuesExtractors::Vector displacements(0);
+
+    dst = 0;
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        int mat_id = cell->material_id();
+        if (material.size() == 1)
+          mat_id = 1;
+        const SymmetricTensor<4, dim> elasticity =
+          material[mat_id - 1].get_elasticity();
+
+        fe_values.reinit(cell);
+        fe_values[displacements].get_function_symmetric_gradients(
+          u, symmetric_grad_u);
+        local_dst = 0;
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            const SymmetricTensor<2, dim> sigma =
+              elasticity * symmetric_grad_u[q];
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                local_dst[i] +=
+                  fe_values[displacements].symmetric_gradient(i, q) * sigma *
+                  fe_values.JxW(q);
+              }
+          }
+        cell->get_dof_indices(local_dof_indices);
+        // The same condensation as the one of the matrix.
+        constraints.distribute_local_to_global(
+          local_dst, local_dof_indices, dst);
+      }
+  }
+
   template <int dim>
   void LinearElasticity<dim>::run_one_step(bool first_step)
   {
+    if (parameters.solid_integrator == "explicit")
+      {
+        this->run_one_explicit_step(first_step);
+        return;
+      }
+
     std::cout.precision(6);
     std::cout.width(12);
 
@@ -276,32 +351,31 @@ namespace Solid
       }
     // Modify the RHS
     Vector<double> tmp1(system_rhs);
-    auto tmp2 = previous_displacement;
-    tmp2.add(
-      dt, previous_velocity, (0.5 - beta) * dt * dt, previous_acceleration);
+    const Utils::NewmarkUpdate newmark(beta, gamma, dt);
+    Vector<double> tmp2(dof_handler.n_dofs());
+    newmark.predict(
+      tmp2, previous_displacement, previous_velocity, previous_acceleration);
     Vector<double> tmp3(dof_handler.n_dofs());
-    stiffness_matrix.vmult(tmp3, tmp2);
+    if (parameters.solid_matrix_free)
+      apply_stiffness(tmp2, tmp3);
+    else
+      stiffness_matrix.vmult(tmp3, tmp2);
     tmp1 -= tmp3;
 
-    auto state = this->solve(system_matrix, current_acceleration, tmp1);
+    auto state =
+      parameters.solid_cached_factorization
+        ? this->solve_factorized(current_acceleration, tmp1)
+        : this->solve(system_matrix, current_acceleration, tmp1);
 
     // update the current velocity
     // \f$ v_{n+1} = v_n + (1-\gamma)\Delta{t}a_n + \gamma\Delta{t}a_{n+1}
-    // \f$
-    current_velocity = previous_velocity;
-    current_velocity.add(dt * (1 - gamma), previous_acceleration);
-    current_velocity.add(dt * gamma, current_acceleration);
-
-    // update the current displacement
-    current_displacement = previous_displacement;
-    current_displacement.add(dt, previous_velocity);
-    current_displacement.add(dt * dt * (0.5 - beta), previous_acceleration);
-    current_displacement.add(dt * dt * beta, current_acceleration);
-
-    // update the previous values
-    previous_acceleration = current_acceleration;
-    previous_velocity = current_velocity;
-    previous_displacement = current_displacement;
+    // \f$ and displacement, and the previous values, in one pass
+    newmark.correct(current_acceleration,
+                    current_velocity,
+                    current_displacement,
+                    previous_acceleration,
+                    previous_velocity,
+                    previous_displacement);
 
     std::cout << std::scientific << std::left
               << " CG iteration: " << std::setw(3) << state.first
@@ -332,49 +406,26 @@ namespace Solid
             stress[i][j] = 0.0;
           }
       }
-    std::vector<int> surrounding_cells(scalar_dof_handler.n_dofs(), 0);
-    // The strain and stress tensors are stored as 2D vectors of shape dim*dim
-    // at cell and quadrature point level.
-    std::vector<std::vector<Vector<double>>> cell_strain(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(scalar_fe.dofs_per_cell)));
-    std::vector<std::vector<Vector<double>>> cell_stress(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(scalar_fe.dofs_per_cell)));
-    std::vector<std::vector<Vector<double>>> quad_strain(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(volume_quad_formula.size())));
-    std::vector<std::vector<Vector<double>>> quad_stress(
-      dim,
-      std::vector<Vector<double>>(dim,
-                                  Vector<double>(volume_quad_formula.size())));
+    // The strain and the stress are projected as the components i * dim + j
+    // and dim * dim + i * dim + j.
+    Utils::NodalProjection<dim> projection(scalar_fe,
+                                           volume_quad_formula,
+                                           2 * dim * dim,
+                                           scalar_dof_handler.n_dofs());
 
     // Displacement gradients at quadrature points.
     std::vector<Tensor<2, dim>> current_displacement_gradients(
       volume_quad_formula.size());
 
-    // The projection matrix from quadrature points to the dofs.
-    FullMatrix<double> qpt_to_dof(scalar_fe.dofs_per_cell,
-                                  volume_quad_formula.size());
-    FETools::compute_projection_from_quadrature_points_matrix(
-      scalar_fe, volume_quad_formula, volume_quad_formula, qpt_to_dof);
-
     SymmetricTensor<4, dim> elasticity;
     const FEValuesExtractors::Vector displacements(0);
 
-    FEValues<dim> fe_values(fe,
-                            volume_quad_formula,
-                            update_values | update_gradients |
-                              update_quadrature_points | update_JxW_values);
+    FEValues<dim> fe_values(fe, volume_quad_formula, update_gradients);
     auto cell = dof_handler.begin_active();
     auto scalar_cell = scalar_dof_handler.begin_active();
     std::vector<types::global_dof_index> dof_indices(scalar_fe.dofs_per_cell);
     for (; cell != dof_handler.end(); ++cell, ++scalar_cell)
       {
-        scalar_cell->get_dof_indices(dof_indices);
         fe_values.reinit(cell);
         fe_values[displacements].get_function_gradients(
           current_displacement, current_displacement_gradients);
@@ -394,7 +445,6 @@ namespace Solid
                       (current_displacement_gradients[q][i][j] +
                        current_displacement_gradients[q][j][i]) /
                       2;
-                    quad_strain[i][j][q] = tmp_strain[i][j];
                   }
               }
             tmp_stress = elasticity * tmp_strain;
@@ -402,32 +452,24 @@ namespace Solid
               {
                 for (unsigned int j = 0; j < dim; ++j)
                   {
-                    quad_stress[i][j][q] = tmp_stress[i][j];
-                  }
-              }
-          }
-
-        for (unsigned int i = 0; i < dim; ++i)
-          {
-            for (unsigned int j = 0; j < dim; ++j)
-              {
-                qpt_to_dof.vmult(cell_strain[i][j], quad_strain[i][j]);
-                qpt_to_dof.vmult(cell_stress[i][j], quad_stress[i][j]);
-                for (unsigned int k = 0; k < scalar_fe.dofs_per_cell; ++k)
-                  {
-                    strain[i][j][dof_indices[k]] += cell_strain[i][j][k];
-                    stress[i][j][dof_indices[k]] += cell_stress[i][j][k];
-                    if (i == 0 && j == 0)
-                      surrounding_cells[dof_indices[k]]++;
+                    projection.value(q, i * dim + j) = tmp_strain[i][j];
+                    projection.value(q, dim * dim + i * dim + j) =
+                      tmp_stress[i][j];
                   }
               }
           }
+        scalar_cell->get_dof_indices(dof_indices);
+        projection.add_cell(dof_indices);
       }
 
+    Vector<double> surrounding_cells(scalar_dof_handler.n_dofs());
+    projection.add_counts_to(surrounding_cells);
     for (unsigned int i = 0; i < dim; ++i)
       {
         for (unsigned int j = 0; j < dim; ++j)
           {
+            projection.add_to(i * dim + j, strain[i][j]);
+            projection.add_to(dim * dim + i * dim + j, stress[i][j]);
             for (unsigned int k = 0; k < scalar_dof_handler.n_dofs(); ++k)
               {
                 strain[i][j][k] /= surrounding_cells[k];
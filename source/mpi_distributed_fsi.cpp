@@ -0,0 +1,828 @@
+#include "mpi_distributed_fsi.h"
+#include <array>
+#include <iostream>
+#include <limits>
+
+namespace MPI
+{
+  namespace
+  {
+    // Check if two boxes overlap, an inverted box overlaps nothing.
+    template <int dim>
+    bool boxes_overlap(const std::pair<Point<dim>, Point<dim>> &a,
+                       const std::pair<Point<dim>, Point<dim>> &b)
+    {
+      for (unsigned int d = 0; d < dim; ++d)
+        {
+          if (a.second[d] < b.first[d] || a.first[d] > b.second[d])
+            return false;
+        }
+      return true;
+    }
+  } // namespace
+
+  template <int dim>
+  DistributedFSI<dim>::~DistributedFSI()
+  {
+    timer.print_summary();
+  }
+
+  template <int dim>
+  DistributedFSI<dim>::DistributedFSI(Fluid::MPI::FluidSolver<dim> &f,
+                                      Solid::MPI::SolidSolver<dim> &s,
+                                      const Parameters::AllParameters &p,
+                                      bool use_dirichlet_bc)
+    : fluid_solver(f),
+      solid_solver(s),
+      parameters(p),
+      mpi_communicator(MPI_COMM_WORLD),
+      pcout(std::cout, Utilities::MPI::this_mpi_process(mpi_communicator) == 0),
+      time(parameters.end_time,
+           parameters.time_step,
+           parameters.output_interval,
+           parameters.refinement_interval,
+           parameters.save_interval),
+      timer(
+        mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+      fluid_evaluator(fluid_solver.dof_handler),
+      use_dirichlet_bc(use_dirichlet_bc)
+  {
+    if (parameters.adaptive_time_stepping)
+      {
+        time.set_adaptive(parameters.min_time_step,
+                          parameters.max_time_step,
+                          parameters.max_time_step_growth);
+      }
+  }
+
+  template <int dim>
+  std::map<unsigned int, std::vector<double>> DistributedFSI<dim>::exchange(
+    const std::map<unsigned int, std::vector<double>> &buffers) const
+  {
+    const unsigned int this_rank =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    std::map<unsigned int, std::vector<double>> remote_buffers(buffers);
+    std::vector<double> local_buffer;
+    auto local = remote_buffers.find(this_rank);
+    const bool has_local = (local != remote_buffers.end());
+    if (has_local)
+      {
+        local_buffer.swap(local->second);
+        remote_buffers.erase(local);
+      }
+    auto received = Utilities::MPI::some_to_some(mpi_communicator,
+                                                 remote_buffers);
+    if (has_local)
+      {
+        received[this_rank].swap(local_buffer);
+      }
+    return received;
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::update_fluid_boxes()
+  {
+    // Lower and upper corners of the relevant box, then the owned box.
+    // A process without any cells keeps the inverted boxes.
+    std::vector<double> local(4 * dim);
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        local[d] = local[2 * dim + d] = std::numeric_limits<double>::max();
+        local[dim + d] = local[3 * dim + d] =
+          std::numeric_limits<double>::lowest();
+      }
+    for (auto cell = fluid_solver.triangulation.begin_active();
+         cell != fluid_solver.triangulation.end();
+         ++cell)
+      {
+        if (cell->is_artificial())
+          continue;
+        const unsigned int offset = cell->is_locally_owned() ? 2 * dim : 0;
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                local[d] = std::min(local[d], cell->vertex(v)[d]);
+                local[dim + d] = std::max(local[dim + d], cell->vertex(v)[d]);
+                local[offset + d] =
+                  std::min(local[offset + d], cell->vertex(v)[d]);
+                local[offset + dim + d] =
+                  std::max(local[offset + dim + d], cell->vertex(v)[d]);
+              }
+          }
+      }
+    const unsigned int n_ranks =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    std::vector<double> all(4 * dim * n_ranks);
+    MPI_Allgather(local.data(),
+                  4 * dim,
+                  MPI_DOUBLE,
+                  all.data(),
+                  4 * dim,
+                  MPI_DOUBLE,
+                  mpi_communicator);
+    fluid_boxes.resize(n_ranks);
+    owned_fluid_boxes.resize(n_ranks);
+    for (unsigned int r = 0; r < n_ranks; ++r)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            fluid_boxes[r].first[d] = all[4 * dim * r + d];
+            fluid_boxes[r].second[d] = all[4 * dim * r + dim + d];
+            owned_fluid_boxes[r].first[d] = all[4 * dim * r + 2 * dim + d];
+            owned_fluid_boxes[r].second[d] = all[4 * dim * r + 3 * dim + d];
+          }
+      }
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::update_solid_overlap()
+  {
+    TimerOutput::Scope timer_section(timer, "Update solid overlap");
+    // The solid vertices and dofs of the locally owned cells may belong to
+    // other processes, so ghosted copies are needed.
+    PETScWrappers::MPI::Vector displacement(solid_solver.locally_owned_dofs,
+                                            solid_solver.locally_relevant_dofs,
+                                            mpi_communicator);
+    PETScWrappers::MPI::Vector velocity(displacement);
+    PETScWrappers::MPI::Vector acceleration(displacement);
+    displacement = solid_solver.current_displacement;
+    velocity = solid_solver.current_velocity;
+    acceleration = solid_solver.current_acceleration;
+
+    // Every cell is packed as its boundary face mask, the current coordinates
+    // of its vertices, and the local velocity and acceleration.
+    const unsigned int dofs_per_cell = solid_solver.fe.dofs_per_cell;
+    const unsigned int n_vertices = GeometryInfo<dim>::vertices_per_cell;
+    const unsigned int cell_size = 1 + n_vertices * dim + 2 * dofs_per_cell;
+    std::map<unsigned int, std::vector<double>> send_buffers;
+    std::vector<types::global_dof_index> dof_indices(dofs_per_cell);
+    std::vector<Point<dim>> vertices(n_vertices);
+    for (auto cell = solid_solver.dof_handler.begin_active();
+         cell != solid_solver.dof_handler.end();
+         ++cell)
+      {
+        if (!cell->is_locally_owned())
+          continue;
+        for (unsigned int v = 0; v < n_vertices; ++v)
+          {
+            vertices[v] = cell->vertex(v);
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                vertices[v][d] += displacement(cell->vertex_dof_index(v, d));
+              }
+          }
+        const Box cell_box = Utils::AABBTree<dim>::bounding_box(vertices);
+        unsigned int boundary_faces = 0;
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+          {
+            if (cell->face(f)->at_boundary())
+              boundary_faces |= (1u << f);
+          }
+        cell->get_dof_indices(dof_indices);
+        for (unsigned int r = 0; r < fluid_boxes.size(); ++r)
+          {
+            if (!boxes_overlap<dim>(cell_box, fluid_boxes[r]))
+              continue;
+            std::vector<double> &buffer = send_buffers[r];
+            buffer.push_back(boundary_faces);
+            for (unsigned int v = 0; v < n_vertices; ++v)
+              {
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    buffer.push_back(vertices[v][d]);
+                  }
+              }
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                buffer.push_back(velocity(dof_indices[i]));
+              }
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                buffer.push_back(acceleration(dof_indices[i]));
+              }
+          }
+      }
+    const auto received = exchange(send_buffers);
+
+    // Rebuild the local copy from scratch, the cells are not connected so
+    // that the vertices are simply numbered cell by cell.
+    overlap_cells.clear();
+    overlap_boundary_faces.clear();
+    overlap_dof_handler.reset();
+    overlap_tria.reset(new Triangulation<dim>);
+    std::vector<Point<dim>> overlap_vertices;
+    std::vector<CellData<dim>> cell_data;
+    std::vector<double> cell_values;
+    for (const auto &item : received)
+      {
+        const std::vector<double> &buffer = item.second;
+        Assert(buffer.size() % cell_size == 0, ExcInternalError());
+        for (unsigned int k = 0; k < buffer.size(); k += cell_size)
+          {
+            overlap_boundary_faces.push_back(
+              static_cast<unsigned int>(buffer[k]));
+            CellData<dim> data;
+            for (unsigned int v = 0; v < n_vertices; ++v)
+              {
+                Point<dim> vertex;
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    vertex[d] = buffer[k + 1 + v * dim + d];
+                  }
+                data.vertices[v] = overlap_vertices.size();
+                overlap_vertices.push_back(vertex);
+              }
+            cell_data.push_back(data);
+            cell_values.insert(cell_values.end(),
+                               buffer.begin() + k + 1 + n_vertices * dim,
+                               buffer.begin() + k + cell_size);
+          }
+      }
+    if (cell_data.empty())
+      {
+        overlap_tree.build({});
+        return;
+      }
+    overlap_tria->create_triangulation(
+      overlap_vertices, cell_data, SubCellData());
+    overlap_dof_handler.reset(new DoFHandler<dim>(*overlap_tria));
+    overlap_dof_handler->distribute_dofs(solid_solver.fe);
+    overlap_velocity.reinit(overlap_dof_handler->n_dofs());
+    overlap_acceleration.reinit(overlap_dof_handler->n_dofs());
+
+    // The cells of a coarse mesh are in the order of the cell data.
+    std::vector<Box> boxes;
+    Vector<double> local_values(dofs_per_cell);
+    unsigned int i = 0;
+    for (auto cell = overlap_dof_handler->begin_active();
+         cell != overlap_dof_handler->end();
+         ++cell, ++i)
+      {
+        overlap_cells.push_back(cell);
+        for (unsigned int v = 0; v < n_vertices; ++v)
+          {
+            vertices[v] = cell->vertex(v);
+          }
+        boxes.push_back(Utils::AABBTree<dim>::bounding_box(vertices));
+        const unsigned int offset = 2 * dofs_per_cell * i;
+        for (unsigned int j = 0; j < dofs_per_cell; ++j)
+          {
+            local_values[j] = cell_values[offset + j];
+          }
+        cell->set_dof_values(local_values, overlap_velocity);
+        for (unsigned int j = 0; j < dofs_per_cell; ++j)
+          {
+            local_values[j] = cell_values[offset + dofs_per_cell + j];
+          }
+        cell->set_dof_values(local_values, overlap_acceleration);
+      }
+    overlap_tree.build(boxes);
+  }
+
+  template <int dim>
+  bool DistributedFSI<dim>::locate_in_solid(const Point<dim> &point,
+                                            unsigned int &index,
+                                            Point<dim> &unit_point) const
+  {
+    if (overlap_tree.empty())
+      return false;
+    overlap_tree.point_query(point, candidates);
+    for (auto i : candidates)
+      {
+        Point<dim> p_unit;
+        try
+          {
+            p_unit = mapping.transform_real_to_unit_cell(overlap_cells[i],
+                                                         point);
+          }
+        catch (typename Mapping<dim>::ExcTransformationFailed &)
+          {
+            continue;
+          }
+        if (GeometryInfo<dim>::is_inside_unit_cell(p_unit, 1e-10))
+          {
+            index = i;
+            unit_point = GeometryInfo<dim>::project_to_unit_cell(p_unit);
+            return true;
+          }
+      }
+    return false;
+  }
+
+  template <int dim>
+  Tensor<1, dim>
+  DistributedFSI<dim>::solid_value(const Vector<double> &field,
+                                   const unsigned int index,
+                                   const Point<dim> &unit_point) const
+  {
+    const FiniteElement<dim> &fe = solid_solver.fe;
+    Vector<double> local_values(fe.dofs_per_cell);
+    overlap_cells[index]->get_dof_values(field, local_values);
+    Tensor<1, dim> value;
+    for (unsigned int j = 0; j < fe.dofs_per_cell; ++j)
+      {
+        value[fe.system_to_component_index(j).first] +=
+          local_values[j] * fe.shape_value(j, unit_point);
+      }
+    return value;
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::update_indicator()
+  {
+    TimerOutput::Scope timer_section(timer, "Update indicator");
+    Utils::CounterRegion counter_region("Update indicator");
+    unsigned int index;
+    Point<dim> unit_point;
+    for (auto f_cell = fluid_solver.dof_handler.begin_active();
+         f_cell != fluid_solver.dof_handler.end();
+         ++f_cell)
+      {
+        if (!f_cell->is_locally_owned())
+          {
+            continue;
+          }
+        int inside = 1;
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            if (!locate_in_solid(f_cell->vertex(v), index, unit_point))
+              {
+                inside = 0;
+                break;
+              }
+          }
+        fluid_solver.cell_property.indicator[f_cell->active_cell_index()] =
+          inside;
+      }
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::find_fluid_bc()
+  {
+    TimerOutput::Scope timer_section(timer, "Find fluid BC");
+    Utils::CounterRegion counter_region("Find fluid BC");
+
+    // The nonzero Dirichlet BCs (to set the velocity) and zero Dirichlet
+    // BCs (to set the velocity increment) for the artificial fluid domain.
+    AffineConstraints<double> inner_nonzero, inner_zero;
+    inner_nonzero.clear();
+    inner_zero.clear();
+    inner_nonzero.reinit(fluid_solver.locally_relevant_dofs);
+    inner_zero.reinit(fluid_solver.locally_relevant_dofs);
+    PETScWrappers::MPI::BlockVector tmp_fsi_acceleration;
+    tmp_fsi_acceleration.reinit(fluid_solver.owned_partitioning,
+                                fluid_solver.mpi_communicator);
+
+    const std::vector<Point<dim>> &unit_points =
+      fluid_solver.fe.get_unit_support_points();
+
+    const FEValuesExtractors::Vector velocities(0);
+    std::vector<Tensor<2, dim>> grad_v(unit_points.size());
+    std::vector<Tensor<1, dim>> v(unit_points.size());
+
+    MappingQGeneric<dim> fluid_mapping(parameters.fluid_velocity_degree);
+    Quadrature<dim> dummy_q(unit_points);
+    FEValues<dim> dummy_fe_values(fluid_mapping,
+                                  fluid_solver.fe,
+                                  dummy_q,
+                                  update_quadrature_points | update_values |
+                                    update_gradients);
+    std::vector<types::global_dof_index> dof_indices(
+      fluid_solver.fe.dofs_per_cell);
+    std::vector<unsigned int> dof_touched(fluid_solver.dof_handler.n_dofs(), 0);
+    unsigned int index;
+    Point<dim> solid_unit_point;
+
+    for (auto f_cell = fluid_solver.dof_handler.begin_active();
+         f_cell != fluid_solver.dof_handler.end();
+         ++f_cell)
+      {
+        // Use is_artificial() instead of !is_locally_owned() because ghost
+        // elements must be taken care of to set correct Dirichlet BCs!
+        if (f_cell->is_artificial())
+          {
+            continue;
+          }
+        // The FSI acceleration is only cached on the locally owned cells.
+        const bool set_acceleration =
+          !use_dirichlet_bc && f_cell->is_locally_owned();
+        if (!use_dirichlet_bc && !set_acceleration)
+          {
+            continue;
+          }
+        if (set_acceleration &&
+            fluid_solver.cell_property
+                .indicator[f_cell->active_cell_index()] == 0)
+          {
+            continue;
+          }
+        dummy_fe_values.reinit(f_cell);
+        f_cell->get_dof_indices(dof_indices);
+        auto support_points = dummy_fe_values.get_quadrature_points();
+        if (set_acceleration)
+          {
+            dummy_fe_values[velocities].get_function_values(
+              fluid_solver.present_solution, v);
+            dummy_fe_values[velocities].get_function_gradients(
+              fluid_solver.present_solution, grad_v);
+          }
+        for (unsigned int i = 0; i < unit_points.size(); ++i)
+          {
+            // Skip the already-set dofs.
+            if (dof_touched[dof_indices[i]] != 0)
+              continue;
+            auto base_index = fluid_solver.fe.system_to_base_index(i);
+            const unsigned int i_group = base_index.first.first;
+            Assert(
+              i_group < 2,
+              ExcMessage("There should be only 2 groups of finite element!"));
+            if (i_group == 1)
+              continue; // skip the pressure dofs
+            bool inside = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              if (std::abs(unit_points[i][d]) < 1e-5)
+                {
+                  inside = false;
+                  break;
+                }
+            if (inside)
+              continue; // skip the in-cell support point
+            dof_touched[dof_indices[i]] = 1;
+            if (!locate_in_solid(support_points[i], index, solid_unit_point))
+              continue;
+            const unsigned int component =
+              fluid_solver.fe.system_to_component_index(i).first;
+            Assert(component < dim,
+                   ExcMessage("Vector component should be less than dim!"));
+            const Tensor<1, dim> vs =
+              solid_value(overlap_velocity, index, solid_unit_point);
+            auto line = dof_indices[i];
+            if (set_acceleration)
+              {
+                const Tensor<1, dim> solid_acc =
+                  solid_value(overlap_acceleration, index, solid_unit_point);
+                // Fluid total acceleration at support points
+                Tensor<1, dim> fluid_acc =
+                  (vs - v[i]) / time.get_delta_t() + grad_v[i] * v[i];
+                tmp_fsi_acceleration(line) =
+                  fluid_acc[component] - solid_acc[component];
+              }
+            else
+              {
+                inner_nonzero.add_line(line);
+                inner_zero.add_line(line);
+                // Note that we are setting the value of the constraint to
+                // the velocity delta!
+                inner_nonzero.set_inhomogeneity(
+                  line, vs[component] - fluid_solver.present_solution(line));
+              }
+          }
+      }
+    tmp_fsi_acceleration.compress(VectorOperation::insert);
+    fluid_solver.fsi_acceleration = tmp_fsi_acceleration;
+    if (use_dirichlet_bc)
+      {
+        inner_nonzero.close();
+        inner_zero.close();
+        fluid_solver.nonzero_constraints.merge(
+          inner_nonzero,
+          AffineConstraints<double>::MergeConflictBehavior::left_object_wins);
+        fluid_solver.zero_constraints.merge(
+          inner_zero,
+          AffineConstraints<double>::MergeConflictBehavior::left_object_wins);
+      }
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::find_solid_bc()
+  {
+    TimerOutput::Scope timer_section(timer, "Find solid BC");
+    PETScWrappers::MPI::Vector displacement(solid_solver.locally_owned_dofs,
+                                            solid_solver.locally_relevant_dofs,
+                                            mpi_communicator);
+    displacement = solid_solver.current_displacement;
+
+    // Collect the solid boundary vertices with locally owned dofs, in the
+    // current configuration. Ghost cells are visited as well because an
+    // owned vertex may only be on the boundary faces of the ghost cells. The
+    // dofs of the components of a vertex are not contiguous after the
+    // renumbering, so each of them is looked up and checked.
+    std::vector<bool> vertex_touched(solid_solver.triangulation.n_vertices(),
+                                     false);
+    std::vector<std::array<types::global_dof_index, dim>> lines;
+    std::vector<Point<dim>> points;
+    for (auto s_cell = solid_solver.dof_handler.begin_active();
+         s_cell != solid_solver.dof_handler.end();
+         ++s_cell)
+      {
+        if (s_cell->is_artificial())
+          continue;
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+          {
+            if (!s_cell->face(f)->at_boundary())
+              continue;
+            for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_face;
+                 ++v)
+              {
+                const unsigned int vertex = s_cell->face(f)->vertex_index(v);
+                if (vertex_touched[vertex])
+                  continue;
+                vertex_touched[vertex] = true;
+                std::array<types::global_dof_index, dim> line;
+                bool owned = false;
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    line[d] = s_cell->face(f)->vertex_dof_index(v, d);
+                    owned = owned ||
+                            solid_solver.locally_owned_dofs.is_element(line[d]);
+                  }
+                if (!owned)
+                  continue;
+                Point<dim> point = s_cell->face(f)->vertex(v);
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    point[d] += displacement(line[d]);
+                  }
+                lines.push_back(line);
+                points.push_back(point);
+              }
+          }
+      }
+
+    // Send the points to the processes whose fluid subdomains contain them,
+    // as the index and the coordinates.
+    std::map<unsigned int, std::vector<double>> send_buffers;
+    for (unsigned int i = 0; i < points.size(); ++i)
+      {
+        for (unsigned int r = 0; r < owned_fluid_boxes.size(); ++r)
+          {
+            if (!boxes_overlap<dim>({points[i], points[i]},
+                                    owned_fluid_boxes[r]))
+              continue;
+            std::vector<double> &buffer = send_buffers[r];
+            buffer.push_back(i);
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                buffer.push_back(points[i][d]);
+              }
+          }
+      }
+    const auto requests = exchange(send_buffers);
+
+    // Evaluate the fluid stress at all of the received points at once, only
+    // the points in the locally owned fluid cells are answered.
+    std::vector<Point<dim>> query_points;
+    for (const auto &item : requests)
+      {
+        for (unsigned int k = 0; k < item.second.size(); k += dim + 1)
+          {
+            Point<dim> point;
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                point[d] = item.second[k + 1 + d];
+              }
+            query_points.push_back(point);
+          }
+      }
+    fluid_evaluator.reinit(query_points, MPI_COMM_SELF);
+    std::vector<Vector<double>> values;
+    std::vector<std::vector<Tensor<1, dim>>> gradients;
+    fluid_evaluator.evaluate(fluid_solver.present_solution, values, gradients);
+    std::map<unsigned int, std::vector<double>> reply_buffers;
+    unsigned int n = 0;
+    for (const auto &item : requests)
+      {
+        std::vector<double> &buffer = reply_buffers[item.first];
+        for (unsigned int k = 0; k < item.second.size(); k += dim + 1, ++n)
+          {
+            if (!fluid_evaluator.is_owned(n))
+              continue;
+            SymmetricTensor<2, dim> sym_deformation;
+            for (unsigned int j = 0; j < dim; ++j)
+              {
+                for (unsigned int l = 0; l < dim; ++l)
+                  {
+                    sym_deformation[j][l] =
+                      (gradients[n][j][l] + gradients[n][l][j]) / 2;
+                  }
+              }
+            // \f$ \sigma = -p\bold{I} + \mu\nabla^S v\f$
+            SymmetricTensor<2, dim> stress =
+              -values[n][dim] * Physics::Elasticity::StandardTensors<dim>::I +
+              2 * parameters.viscosity * sym_deformation;
+            buffer.push_back(item.second[k]);
+            for (unsigned int d1 = 0; d1 < dim; ++d1)
+              {
+                for (unsigned int d2 = 0; d2 < dim; ++d2)
+                  {
+                    buffer.push_back(stress[d1][d2]);
+                  }
+              }
+          }
+      }
+    const auto replies = exchange(reply_buffers);
+
+    // A point on the interface of fluid subdomains may be answered more than
+    // once, the first answer is taken.
+    std::vector<PETScWrappers::MPI::Vector> rows(
+      dim,
+      PETScWrappers::MPI::Vector(solid_solver.locally_owned_dofs,
+                                 mpi_communicator));
+    std::vector<bool> point_set(points.size(), false);
+    for (const auto &item : replies)
+      {
+        for (unsigned int k = 0; k < item.second.size(); k += dim * dim + 1)
+          {
+            const unsigned int i = static_cast<unsigned int>(item.second[k]);
+            if (point_set[i])
+              continue;
+            point_set[i] = true;
+            for (unsigned int d1 = 0; d1 < dim; ++d1)
+              {
+                for (unsigned int d2 = 0; d2 < dim; ++d2)
+                  {
+                    if (solid_solver.locally_owned_dofs.is_element(
+                          lines[i][d2]))
+                      {
+                        rows[d1](lines[i][d2]) =
+                          item.second[k + 1 + d1 * dim + d2];
+                      }
+                  }
+              }
+          }
+      }
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        rows[d].compress(VectorOperation::insert);
+        solid_solver.fsi_stress_rows[d] = rows[d];
+      }
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::refine_mesh(const unsigned int min_grid_level,
+                                        const unsigned int max_grid_level)
+  {
+    TimerOutput::Scope timer_section(timer, "Refine mesh");
+    // Refine the fluid cells close to the boundaries of the overlapping
+    // solid cells.
+    std::vector<Point<dim>> solid_boundary_points;
+    for (unsigned int i = 0; i < overlap_cells.size(); ++i)
+      {
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+          {
+            if (overlap_boundary_faces[i] & (1u << f))
+              {
+                solid_boundary_points.push_back(
+                  overlap_cells[i]->face(f)->center());
+                break;
+              }
+          }
+      }
+    for (auto f_cell : fluid_solver.dof_handler.active_cell_iterators())
+      {
+        if (!f_cell->is_locally_owned())
+          continue;
+        auto center = f_cell->center();
+        double dist = 1000;
+        for (auto point : solid_boundary_points)
+          {
+            dist = std::min(center.distance(point), dist);
+          }
+        if (dist < f_cell->diameter())
+          f_cell->set_refine_flag();
+        else
+          f_cell->set_coarsen_flag();
+      }
+    if (fluid_solver.triangulation.n_levels() > max_grid_level)
+      {
+        for (auto cell =
+               fluid_solver.triangulation.begin_active(max_grid_level);
+             cell != fluid_solver.triangulation.end();
+             ++cell)
+          {
+            cell->clear_refine_flag();
+          }
+      }
+
+    for (auto cell = fluid_solver.triangulation.begin_active(min_grid_level);
+         cell != fluid_solver.triangulation.end_active(min_grid_level);
+         ++cell)
+      {
+        cell->clear_coarsen_flag();
+      }
+
+    parallel::distributed::SolutionTransfer<dim,
+                                            PETScWrappers::MPI::BlockVector>
+      solution_transfer(fluid_solver.dof_handler);
+
+    fluid_solver.triangulation.prepare_coarsening_and_refinement();
+    solution_transfer.prepare_for_coarsening_and_refinement(
+      fluid_solver.present_solution);
+
+    fluid_solver.triangulation.execute_coarsening_and_refinement();
+
+    fluid_solver.setup_dofs();
+    fluid_solver.make_constraints();
+    fluid_solver.initialize_system();
+
+    PETScWrappers::MPI::BlockVector buffer;
+    buffer.reinit(fluid_solver.owned_partitioning,
+                  fluid_solver.mpi_communicator);
+    buffer = 0;
+    solution_transfer.interpolate(buffer);
+    fluid_solver.nonzero_constraints.distribute(buffer);
+    fluid_solver.present_solution = buffer;
+    // The fluid subdomains have changed.
+    update_fluid_boxes();
+    update_solid_overlap();
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::adapt_time_step()
+  {
+    // The first step takes the initial size.
+    if (!time.adaptive() || time.get_timestep() == 0)
+      {
+        return;
+      }
+    const double delta_t = time.adapt_delta_t(
+      std::min(solid_solver.get_stable_time_step(),
+               fluid_solver.cfl_time_step()),
+      fluid_solver.iteration_factor());
+    solid_solver.time.set_delta_t(delta_t);
+    fluid_solver.time.set_delta_t(delta_t);
+    pcout << "Adapted time step size = " << std::scientific << delta_t
+          << std::endl;
+  }
+
+  template <int dim>
+  void DistributedFSI<dim>::run()
+  {
+    pcout << "Running with PETSc on "
+          << Utilities::MPI::n_mpi_processes(mpi_communicator)
+          << " MPI rank(s)..." << std::endl;
+
+    solid_solver.triangulation.refine_global(parameters.global_refinements[1]);
+    solid_solver.setup_dofs();
+    solid_solver.initialize_system();
+    fluid_solver.triangulation.refine_global(parameters.global_refinements[0]);
+    fluid_solver.setup_dofs();
+    fluid_solver.make_constraints();
+    fluid_solver.initialize_system();
+
+    update_fluid_boxes();
+    update_solid_overlap();
+
+    pcout << "Number of fluid active cells and dofs: ["
+          << fluid_solver.triangulation.n_global_active_cells() << ", "
+          << fluid_solver.dof_handler.n_dofs() << "]" << std::endl
+          << "Number of solid active cells and dofs: ["
+          << solid_solver.triangulation.n_global_active_cells() << ", "
+          << solid_solver.dof_handler.n_dofs() << "]" << std::endl;
+    bool first_step = true;
+    if (parameters.refinement_interval < parameters.end_time)
+      {
+        refine_mesh(parameters.global_refinements[0],
+                    parameters.global_refinements[0] + 3);
+        refine_mesh(parameters.global_refinements[0],
+                    parameters.global_refinements[0] + 3);
+      }
+    while (time.end() - time.current() > 1e-12)
+      {
+        adapt_time_step();
+        find_solid_bc();
+        {
+          TimerOutput::Scope timer_section(timer, "Run solid solver");
+          solid_solver.run_one_step(first_step);
+        }
+        update_solid_overlap();
+        update_indicator();
+        // Only the first step applies the inhomogeneous BCs, the others start
+        // from the cached static constraints.
+        if (first_step)
+          {
+            fluid_solver.make_constraints();
+          }
+        else
+          {
+            fluid_solver.restore_static_constraints();
+          }
+        find_fluid_bc();
+        {
+          TimerOutput::Scope timer_section(timer, "Run fluid solver");
+          fluid_solver.run_one_step(true);
+        }
+        first_step = false;
+        time.increment();
+        if (time.time_to_refine())
+          {
+            refine_mesh(parameters.global_refinements[0],
+                        parameters.global_refinements[0] + 3);
+          }
+      }
+  }
+
+  template class DistributedFSI<2>;
+  template class DistributedFSI<3>;
+} // namespace MPI
@@ -1,28 +1,135 @@
 #include "mpi_fluid_solver.h"
 
+#include <deal.II/numerics/data_postprocessor.h>
+
+namespace
+{
+  using namespace dealii;
+
+  /// Output some of the components of a vector valued solution.
+  template <int dim>
+  class SelectedComponents : public DataPostprocessor<dim>
+  {
+  public:
+    /// The names and the interpretations of all the components, and the
+    /// components to output.
+    SelectedComponents(
+      const std::vector<std::string> &all_names,
+      const std::vector<
+        DataComponentInterpretation::DataComponentInterpretation>
+        &all_interpretation,
+      const std::vector<unsigned int> &components)
+      : components(components)
+    {
+      for (auto c : components)
+        {
+          names.push_back(all_names[c]);
+          interpretation.push_back(all_interpretation[c]);
+        }
+    }
+
+    void
+    evaluate_vector_field(const DataPostprocessorInputs::Vector<dim> &input,
+                          std::vector<Vector<double>> &computed_quantities)
+      const override
+    {
+      for (unsigned int q = 0; q < input.solution_values.size(); ++q)
+        {
+          for (unsigned int i = 0; i < components.size(); ++i)
+            {
+              computed_quantities[q][i] =
+                input.solution_values[q][components[i]];
+            }
+        }
+    }
+
+    std::vector<std::string> get_names() const override { return names; }
+
+    std::vector<DataComponentInterpretation::DataComponentInterpretation>
+    get_data_component_interpretation() const override
+    {
+      return interpretation;
+    }
+
+    UpdateFlags get_needed_update_flags() const override
+    {
+      return update_values;
+    }
+
+  private:
+    const std::vector<unsigned int> components;
+    std::vector<std::string> names;
+    std::vector<DataComponentInterpretation::DataComponentInterpretation>
+      interpretation;
+  };
+} // namespace
+
 namespace Fluid
 {
   namespace MPI
   {
-    template <int dim>
-    FluidSolver<dim>::~FluidSolver()
+    template <int dim, typename Backend>
+    FluidSolver<dim, Backend>::~FluidSolver()
     {
       timer.print_summary();
       timer2.print_summary();
+      performance.write("fluid", timer);
+      performance.write("fluid preconditioner", timer2);
     }
 
-    template <int dim>
-    PETScWrappers::MPI::BlockVector
-    FluidSolver<dim>::get_current_solution() const
+    template <int dim, typename Backend>
+    typename FluidSolver<dim, Backend>::BlockVectorType
+    FluidSolver<dim, Backend>::get_current_solution() const
     {
       return present_solution;
     }
 
-    template <int dim>
-    FluidSolver<dim>::FluidSolver(
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::reuse_setup(const FluidSolver &other)
+    {
+      AssertThrow(&other.triangulation == &triangulation,
+                  ExcMessage("The setup can only be reused on the same "
+                             "triangulation!"));
+      sparsity_cache = other.sparsity_cache;
+      setup_reused = true;
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::setup_time_slices()
+    {
+      if (!setup_reused)
+        triangulation.refine_global(parameters.global_refinements[0]);
+      setup_dofs();
+      make_constraints();
+      initialize_system();
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::run_time_slice(
+      const BlockVectorType &initial_solution,
+      const Utils::Time::State &start,
+      const unsigned int n_steps)
+    {
+      time.set_state(start);
+      present_solution = initial_solution;
+      solution_increment = 0;
+      solution_history.clear();
+      solution_history_times.clear();
+      for (unsigned int step = 0; step < n_steps; ++step)
+        {
+          // InsIMEX keeps its LHS across time steps, which is assembled with
+          // the nonzero constraints at the first step, and again with the
+          // zero ones at the second.
+          run_one_step(time.get_timestep() == 0, step < 2);
+        }
+    }
+
+    template <int dim, typename Backend>
+    FluidSolver<dim, Backend>::FluidSolver(
       parallel::distributed::Triangulation<dim> &tria,
       const Parameters::AllParameters &parameters)
-      : triangulation(tria),
+      : n_interior_cells(0),
+        triangulation(tria),
         fe(FE_Q<dim>(parameters.fluid_velocity_degree),
            dim,
            FE_Q<dim>(parameters.fluid_pressure_degree),
@@ -32,10 +139,15 @@ namespace Fluid
         scalar_dof_handler(triangulation),
         volume_quad_formula(parameters.fluid_velocity_degree + 1),
         face_quad_formula(parameters.fluid_velocity_degree + 1),
+        setup_reused(false),
         parameters(parameters),
-        mpi_communicator(MPI_COMM_WORLD),
+        mpi_communicator(tria.get_communicator()),
         pcout(std::cout,
               Utilities::MPI::this_mpi_process(mpi_communicator) == 0),
+        hdf5_output(mpi_communicator, "fluid"),
+        insitu_output(
+          mpi_communicator, "fluid-insitu", parameters.insitu_actions),
+        writer(parameters.async_output),
         time(parameters.end_time,
              parameters.time_step,
              parameters.output_interval,
@@ -44,12 +156,30 @@ namespace Fluid
         timer(
           mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
         timer2(
-          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times)
+          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+        performance(mpi_communicator, parameters.performance_summary),
+        telemetry(mpi_communicator, parameters.telemetry_prefix, "fluid"),
+        memory_report(mpi_communicator, "fluid solver"),
+        monitor(dof_handler, parameters, face_quad_formula, mpi_communicator),
+        n_newton_iterations(0),
+        n_linear_iterations(0)
     {
+      telemetry.watch(timer);
+      telemetry.watch(timer2, "Preconditioner: ");
+      if (parameters.adaptive_time_stepping)
+        {
+          time.set_adaptive(parameters.min_time_step,
+                            parameters.max_time_step,
+                            parameters.max_time_step_growth);
+        }
+      if (parameters.fluid_n_threads > 0)
+        {
+          MultithreadInfo::set_thread_limit(parameters.fluid_n_threads);
+        }
     }
 
-    template <int dim>
-    void FluidSolver<dim>::add_hard_coded_boundary_condition(
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::add_hard_coded_boundary_condition(
       const int id,
       const std::function<double(
         const Point<dim> &, const unsigned int, const double)> &value_function)
@@ -64,21 +194,47 @@ namespace Fluid
                   ExcMessage("Duplicated hard coded boundary conditions!"));
     }
 
-    template <int dim>
-    void FluidSolver<dim>::setup_dofs()
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::setup_dofs()
     {
+      TimerOutput::Scope timer_section(timer, "Setup system");
+
       // The first step is to associate DoFs with a given mesh.
       dof_handler.distribute_dofs(fe);
+      monitor.clear();
       scalar_dof_handler.distribute_dofs(scalar_fe);
 
       // We renumber the components to have all velocity DoFs come before
       // the pressure DoFs to be able to split the solution vector in two blocks
       // which are separately accessed in the block preconditioner.
-      DoFRenumbering::Cuthill_McKee(dof_handler);
+      // The locality ordering within the blocks comes first, component_wise
+      // keeps it.
+      Utils::renumber_dofs(dof_handler, parameters.dof_renumbering);
       std::vector<unsigned int> block_component(dim + 1, 0);
       block_component[dim] = 1;
       DoFRenumbering::component_wise(dof_handler, block_component);
+      Utils::renumber_dofs(
+        scalar_dof_handler, parameters.dof_renumbering, "none");
       DoFRenumbering::component_wise(scalar_dof_handler);
+      assembly_cells = Utils::cells_in_dof_order(dof_handler);
+      geometry_cache.clear();
+      // The interior cells go first, still in dof order among themselves.
+      {
+        const IndexSet &owned_dofs = dof_handler.locally_owned_dofs();
+        std::vector<types::global_dof_index> dof_indices(fe.dofs_per_cell);
+        const auto interior_end = std::stable_partition(
+          assembly_cells.begin(),
+          assembly_cells.end(),
+          [&](const typename DoFHandler<dim>::active_cell_iterator &cell) {
+            cell->get_dof_indices(dof_indices);
+            return std::all_of(dof_indices.begin(),
+                               dof_indices.end(),
+                               [&](const types::global_dof_index i) {
+                                 return owned_dofs.is_element(i);
+                               });
+          });
+        n_interior_cells = interior_end - assembly_cells.begin();
+      }
 
       dofs_per_block.resize(2);
       DoFTools::count_dofs_per_block(
@@ -106,6 +262,7 @@ namespace Fluid
       locally_owned_scalar_dofs = scalar_dof_handler.locally_owned_dofs();
       DoFTools::extract_locally_relevant_dofs(scalar_dof_handler,
                                               locally_relevant_scalar_dofs);
+      make_boundary_dof_table();
 
       pcout << "   Number of active fluid cells: "
             << triangulation.n_global_active_cells() << std::endl
@@ -113,8 +270,120 @@ namespace Fluid
             << " (" << dof_u << '+' << dof_p << ')' << std::endl;
     }
 
-    template <int dim>
-    void FluidSolver<dim>::make_constraints()
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::make_boundary_dof_table()
+    {
+      hanging_node_constraints.clear();
+      hanging_node_constraints.reinit(locally_relevant_dofs);
+      DoFTools::make_hanging_node_constraints(dof_handler,
+                                              hanging_node_constraints);
+
+      // For inhomogeneous BC, only constant input values can be read from
+      // the input file. If time or space dependent Dirichlet BCs are
+      // desired, they must be implemented in BoundaryValues.
+      dirichlet_dofs.clear();
+      if (parameters.fluid_dirichlet_bcs.empty())
+        {
+          return;
+        }
+      const MappingQGeneric<dim> mapping(parameters.fluid_velocity_degree);
+      std::map<types::global_dof_index, Point<dim>> support_points;
+      DoFTools::map_dofs_to_support_points(
+        mapping, dof_handler, support_points);
+      for (auto itr = parameters.fluid_dirichlet_bcs.begin();
+           itr != parameters.fluid_dirichlet_bcs.end();
+           ++itr)
+        {
+          // First get the id, flag and value from the input file
+          unsigned int id = itr->first;
+          unsigned int flag = itr->second.first;
+          std::vector<double> value = itr->second.second;
+
+          // The constrained components and their values, which are of size
+          // dim + 1 as VectorTools::interpolate_boundary_values wants them.
+          std::vector<bool> mask(dim + 1, false);
+          std::vector<double> augmented_value(dim + 1, 0.0);
+          // 1-x, 2-y, 3-xy, 4-z, 5-xz, 6-yz, 7-xyz
+          switch (flag)
+            {
+            case 1:
+              mask[0] = true;
+              augmented_value[0] = value[0];
+              break;
+            case 2:
+              mask[1] = true;
+              augmented_value[1] = value[0];
+              break;
+            case 3:
+              mask[0] = true;
+              mask[1] = true;
+              augmented_value[0] = value[0];
+              augmented_value[1] = value[1];
+              break;
+            case 4:
+              mask[2] = true;
+              augmented_value[2] = value[0];
+              break;
+            case 5:
+              mask[0] = true;
+              mask[2] = true;
+              augmented_value[0] = value[0];
+              augmented_value[2] = value[1];
+              break;
+            case 6:
+              mask[1] = true;
+              mask[2] = true;
+              augmented_value[1] = value[0];
+              augmented_value[2] = value[1];
+              break;
+            case 7:
+              mask[0] = true;
+              mask[1] = true;
+              mask[2] = true;
+              augmented_value[0] = value[0];
+              augmented_value[1] = value[1];
+              augmented_value[2] = value[2];
+              break;
+            default:
+              AssertThrow(false, ExcMessage("Unrecogonized component flag!"));
+              break;
+            }
+
+          DirichletDoFs bc;
+          bc.boundary_id = id;
+          bc.constant_values = augmented_value;
+          // One component at a time, so that the dofs come with their
+          // components. These are the dofs interpolate_boundary_values
+          // constrains.
+          for (unsigned int c = 0; c < dim; ++c)
+            {
+              if (!mask[c])
+                {
+                  continue;
+                }
+              std::map<types::global_dof_index, double> boundary_values;
+              VectorTools::interpolate_boundary_values(
+                mapping,
+                dof_handler,
+                id,
+                Functions::ZeroFunction<dim>(dim + 1),
+                boundary_values,
+                fe.component_mask(FEValuesExtractors::Scalar(c)));
+              for (const auto &entry : boundary_values)
+                {
+                  auto point = support_points.find(entry.first);
+                  Assert(point != support_points.end(), ExcInternalError());
+                  bc.dofs.push_back(entry.first);
+                  bc.components.push_back(c);
+                  bc.support_points.push_back(point->second);
+                }
+            }
+          dirichlet_dofs.push_back(std::move(bc));
+        }
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::make_constraints()
     {
       // In Newton's scheme, we first apply the boundary condition on the
       // solution obtained from the initial step. To make sure the boundary
@@ -122,157 +391,117 @@ namespace Fluid
       // conditions are used for the update \f$\delta u^k\f$. Therefore we set
       // up two different constraint objects. Dirichlet boundary conditions are
       // applied to both boundaries 0 and 1.
-
-      // For inhomogeneous BC, only constant input values can be read from
-      // the input file. If time or space dependent Dirichlet BCs are
-      // desired, they must be implemented in BoundaryValues.
-      {
-        nonzero_constraints.clear();
-        zero_constraints.clear();
-        nonzero_constraints.reinit(locally_relevant_dofs);
-        zero_constraints.reinit(locally_relevant_dofs);
-        DoFTools::make_hanging_node_constraints(dof_handler,
-                                                nonzero_constraints);
-        DoFTools::make_hanging_node_constraints(dof_handler, zero_constraints);
-        for (auto itr = parameters.fluid_dirichlet_bcs.begin();
-             itr != parameters.fluid_dirichlet_bcs.end();
-             ++itr)
-          {
-            // First get the id, flag and value from the input file
-            unsigned int id = itr->first;
-            unsigned int flag = itr->second.first;
-            std::vector<double> value = itr->second.second;
-
-            // To make VectorTools::interpolate_boundary_values happy,
-            // a vector of bool and a vector of double which are of size
-            // dim + 1 are required.
-            std::vector<bool> mask(dim + 1, false);
-            std::vector<double> augmented_value(dim + 1, 0.0);
-            // 1-x, 2-y, 3-xy, 4-z, 5-xz, 6-yz, 7-xyz
-            switch (flag)
-              {
-              case 1:
-                mask[0] = true;
-                augmented_value[0] = value[0];
-                break;
-              case 2:
-                mask[1] = true;
-                augmented_value[1] = value[0];
-                break;
-              case 3:
-                mask[0] = true;
-                mask[1] = true;
-                augmented_value[0] = value[0];
-                augmented_value[1] = value[1];
-                break;
-              case 4:
-                mask[2] = true;
-                augmented_value[2] = value[0];
-                break;
-              case 5:
-                mask[0] = true;
-                mask[2] = true;
-                augmented_value[0] = value[0];
-                augmented_value[2] = value[1];
-                break;
-              case 6:
-                mask[1] = true;
-                mask[2] = true;
-                augmented_value[1] = value[0];
-                augmented_value[2] = value[1];
-                break;
-              case 7:
-                mask[0] = true;
-                mask[1] = true;
-                mask[2] = true;
-                augmented_value[0] = value[0];
-                augmented_value[1] = value[1];
-                augmented_value[2] = value[2];
-                break;
-              default:
-                AssertThrow(false, ExcMessage("Unrecogonized component flag!"));
-                break;
-              }
-            auto hbc = hard_coded_boundary_values.find(id);
-            if (hbc != hard_coded_boundary_values.end())
-              {
-                VectorTools::interpolate_boundary_values(
-                  MappingQGeneric<dim>(parameters.fluid_velocity_degree),
-                  dof_handler,
-                  id,
-                  hbc->second,
-                  nonzero_constraints,
-                  ComponentMask(mask));
-              }
-            else
-              {
-                VectorTools::interpolate_boundary_values(
-                  MappingQGeneric<dim>(parameters.fluid_velocity_degree),
-                  dof_handler,
-                  id,
-                  Functions::ConstantFunction<dim>(augmented_value),
-                  nonzero_constraints,
-                  ComponentMask(mask));
-              }
-            VectorTools::interpolate_boundary_values(
-              MappingQGeneric<dim>(parameters.fluid_velocity_degree),
-              dof_handler,
-              id,
-              Functions::ZeroFunction<dim>(dim + 1),
-              zero_constraints,
-              ComponentMask(mask));
-          }
-      }
+      nonzero_constraints.clear();
+      zero_constraints.clear();
+      nonzero_constraints.copy_from(hanging_node_constraints);
+      zero_constraints.copy_from(hanging_node_constraints);
+      // The dofs that are constrained already, by the hanging nodes or an
+      // earlier entry, are skipped as in interpolate_boundary_values.
+      for (const DirichletDoFs &bc : dirichlet_dofs)
+        {
+          auto hbc = hard_coded_boundary_values.find(bc.boundary_id);
+          const bool hard_coded = hbc != hard_coded_boundary_values.end();
+          for (unsigned int k = 0; k < bc.dofs.size(); ++k)
+            {
+              const types::global_dof_index dof = bc.dofs[k];
+              if (!nonzero_constraints.can_store_line(dof) ||
+                  nonzero_constraints.is_constrained(dof))
+                {
+                  continue;
+                }
+              const double value =
+                hard_coded
+                  ? hbc->second.value(bc.support_points[k], bc.components[k])
+                  : bc.constant_values[bc.components[k]];
+              nonzero_constraints.add_line(dof);
+              nonzero_constraints.set_inhomogeneity(dof, value);
+              zero_constraints.add_line(dof);
+            }
+        }
       nonzero_constraints.close();
       zero_constraints.close();
+      static_constraints.clear();
+      static_constraints.copy_from(zero_constraints);
     }
 
-    template <int dim>
-    void FluidSolver<dim>::setup_cell_property()
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::restore_static_constraints()
+    {
+      zero_constraints.clear();
+      zero_constraints.copy_from(static_constraints);
+      nonzero_constraints.clear();
+      nonzero_constraints.copy_from(static_constraints);
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::setup_cell_property()
     {
       pcout << "   Setting up cell property..." << std::endl;
-      for (auto cell = triangulation.begin_active();
-           cell != triangulation.end();
-           ++cell)
-        {
-          if (cell->is_locally_owned())
-            {
-              cell_property.initialize(cell, 1);
-              const std::vector<std::shared_ptr<CellProperty>> p =
-                cell_property.get_data(cell);
-              p[0]->indicator = 0;
-              p[0]->fsi_acceleration = 0;
-              p[0]->fsi_stress = 0;
-              p[0]->material_id = 1;
-            }
-        }
+      // Only the entries of the locally owned cells are used.
+      const unsigned int n_cells = triangulation.n_active_cells();
+      cell_property.indicator.assign(n_cells, 0);
+      cell_property.fsi_acceleration.assign(n_cells, Tensor<1, dim>());
+      cell_property.fsi_stress.assign(n_cells, SymmetricTensor<2, dim>());
+      cell_property.material_id.assign(n_cells, 1);
     }
 
-    template <int dim>
-    void FluidSolver<dim>::initialize_system()
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::initialize_system()
     {
+      TimerOutput::Scope timer_section(timer, "Setup system");
+
       system_matrix.clear();
       mass_matrix.clear();
       mass_schur.clear();
+      pressure_convection.clear();
 
       BlockDynamicSparsityPattern dsp(dofs_per_block, dofs_per_block);
-      DoFTools::make_sparsity_pattern(dof_handler, dsp, nonzero_constraints);
-      sparsity_pattern.copy_from(dsp);
-      SparsityTools::distribute_sparsity_pattern(
-        dsp,
-        dof_handler.locally_owned_dofs_per_processor(),
-        mpi_communicator,
-        locally_relevant_dofs);
+      BlockDynamicSparsityPattern schur_dsp(dofs_per_block, dofs_per_block);
+      // Distributing the patterns is collective, so either every process
+      // takes them from the cache or none does.
+      const auto key = sparsity_key();
+      if (Utilities::MPI::min(sparsity_cache.matches(key) ? 1 : 0,
+                              mpi_communicator) == 1)
+        {
+          sparsity_cache.restore(0, owned_partitioning, dsp);
+          sparsity_cache.restore(1, owned_partitioning, schur_dsp);
+        }
+      else
+        {
+          DoFTools::make_sparsity_pattern(
+            dof_handler, dsp, nonzero_constraints);
+          sparsity_pattern.copy_from(dsp);
+          SparsityTools::distribute_sparsity_pattern(
+            dsp,
+            dof_handler.locally_owned_dofs_per_processor(),
+            mpi_communicator,
+            locally_relevant_dofs);
+
+          // Compute the sparsity pattern for mass schur in advance.
+          // The only nonzero block is (1, 1), which is the same as
+          // \f$BB^T\f$.
+          schur_dsp.block(1, 1).compute_mmult_pattern(
+            sparsity_pattern.block(1, 0), sparsity_pattern.block(0, 1));
+          sparsity_cache.store(key, owned_partitioning, {&dsp, &schur_dsp});
+        }
 
       system_matrix.reinit(owned_partitioning, dsp, mpi_communicator);
       mass_matrix.reinit(owned_partitioning, dsp, mpi_communicator);
-
-      // Compute the sparsity pattern for mass schur in advance.
-      // The only nonzero block is (1, 1), which is the same as \f$BB^T\f$.
-      BlockDynamicSparsityPattern schur_dsp(dofs_per_block, dofs_per_block);
-      schur_dsp.block(1, 1).compute_mmult_pattern(sparsity_pattern.block(1, 0),
-                                                  sparsity_pattern.block(0, 1));
       mass_schur.reinit(owned_partitioning, schur_dsp, mpi_communicator);
+      // The pattern of BB^T contains the pressure couplings of every cell.
+      if (parameters.fluid_schur_approximation == "pcd")
+        {
+          pressure_convection.reinit(
+            owned_partitioning, schur_dsp, mpi_communicator);
+        }
+      if (parameters.memory_report)
+        {
+          // The dynamic patterns only live during the setup.
+          memory_report.add("Sparsity",
+                            "Dynamic patterns at setup",
+                            dsp.memory_consumption() +
+                              schur_dsp.memory_consumption());
+        }
 
       // present_solution is ghosted because it is used in the
       // output and mesh refinement functions.
@@ -285,24 +514,75 @@ namespace Fluid
       // system_rhs is non-ghosted because it is only used in the linear
       // solver and residual evaluation.
       system_rhs.reinit(owned_partitioning, mpi_communicator);
+      workspace.reinit(owned_partitioning, mpi_communicator);
+      recycle_space.clear();
+      solution_history.clear();
+      solution_history_times.clear();
 
       // Cell property
       setup_cell_property();
 
-      stress = std::vector<std::vector<PETScWrappers::MPI::Vector>>(
+      stress = std::vector<std::vector<VectorType>>(
         dim,
-        std::vector<PETScWrappers::MPI::Vector>(
-          dim,
-          PETScWrappers::MPI::Vector(locally_owned_scalar_dofs,
-                                     mpi_communicator)));
+        std::vector<VectorType>(
+          dim, VectorType(locally_owned_scalar_dofs, mpi_communicator)));
     }
 
-    template <int dim>
-    void FluidSolver<dim>::refine_mesh(const unsigned int min_grid_level,
-                                       const unsigned int max_grid_level)
+    template <int dim, typename Backend>
+    std::vector<unsigned long long>
+    FluidSolver<dim, Backend>::sparsity_key() const
+    {
+      // FNV-1a
+      auto combine = [](unsigned long long &hash, const unsigned long long v) {
+        hash = (hash ^ v) * 1099511628211ULL;
+      };
+      std::vector<unsigned long long> key(dofs_per_block.begin(),
+                                          dofs_per_block.end());
+      key.push_back(triangulation.get_checksum());
+
+      unsigned long long owned_hash = 14695981039346656037ULL;
+      for (const auto &owned : owned_partitioning)
+        {
+          combine(owned_hash, owned.n_elements());
+          for (const auto i : owned)
+            {
+              combine(owned_hash, i);
+            }
+        }
+      key.push_back(owned_hash);
+
+      unsigned long long constraint_hash = 14695981039346656037ULL;
+      for (const auto &line : nonzero_constraints.get_lines())
+        {
+          combine(constraint_hash, line.index);
+          for (const auto &entry : line.entries)
+            {
+              combine(constraint_hash, entry.first);
+            }
+        }
+      key.push_back(constraint_hash);
+      key.push_back(nonzero_constraints.n_constraints());
+      return key;
+    }
+
+    template <int dim, typename Backend>
+    std::string
+    FluidSolver<dim, Backend>::sparsity_cache_file(
+      const std::string &checkpoint) const
+    {
+      return checkpoint + ".pattern." +
+             Utilities::int_to_string(
+               Utilities::MPI::this_mpi_process(mpi_communicator), 4);
+    }
+
+    template <int dim, typename Backend>
+    void
+    FluidSolver<dim, Backend>::refine_mesh(const unsigned int min_grid_level,
+                                           const unsigned int max_grid_level)
     {
       TimerOutput::Scope timer_section(timer, "Refine mesh");
 
+      hdf5_output.mesh_changed();
       Vector<float> estimated_error_per_cell(triangulation.n_active_cells());
       FEValuesExtractors::Vector velocity(0);
       using type = std::map<types::boundary_id, const Function<dim, double> *>;
@@ -331,9 +611,8 @@ namespace Fluid
         }
 
       // Prepare to transfer
-      parallel::distributed::SolutionTransfer<dim,
-                                              PETScWrappers::MPI::BlockVector>
-        trans(dof_handler);
+      parallel::distributed::SolutionTransfer<dim, BlockVectorType> trans(
+        dof_handler);
 
       triangulation.prepare_coarsening_and_refinement();
 
@@ -349,7 +628,7 @@ namespace Fluid
 
       // Transfer solution
       // Need a non-ghosted vector for interpolation
-      PETScWrappers::MPI::BlockVector tmp;
+      BlockVectorType tmp;
       tmp.reinit(owned_partitioning, mpi_communicator);
       tmp = 0;
       trans.interpolate(tmp);
@@ -357,8 +636,9 @@ namespace Fluid
       present_solution = tmp;
     }
 
-    template <int dim>
-    void FluidSolver<dim>::output_results(const unsigned int output_index) const
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::output_results(
+      const unsigned int output_index) const
     {
       TimerOutput::Scope timer_section(timer, "Output results");
 
@@ -369,72 +649,78 @@ namespace Fluid
       std::vector<std::string> fsi_force_names(dim, "fsi_force");
       fsi_force_names.push_back("dummy_fsi_force");
 
-      std::vector<std::vector<PETScWrappers::MPI::Vector>> tmp_stress =
-        std::vector<std::vector<PETScWrappers::MPI::Vector>>(
-          dim,
-          std::vector<PETScWrappers::MPI::Vector>(
-            dim,
-            PETScWrappers::MPI::Vector(locally_owned_scalar_dofs,
-                                       locally_relevant_scalar_dofs,
-                                       mpi_communicator)));
-      tmp_stress = stress;
-
       std::vector<DataComponentInterpretation::DataComponentInterpretation>
         data_component_interpretation(
           dim, DataComponentInterpretation::component_is_part_of_vector);
       data_component_interpretation.push_back(
         DataComponentInterpretation::component_is_scalar);
+      // If only the velocity or the pressure is selected, the components
+      // of the solution are picked by a postprocessor, which must outlive
+      // data_out.
+      const bool output_velocity = parameters.output_field("velocity");
+      const bool output_pressure = parameters.output_field("pressure");
+      std::vector<unsigned int> selected_components;
+      for (unsigned int c = 0; c <= dim; ++c)
+        {
+          if (c < dim ? output_velocity : output_pressure)
+            selected_components.push_back(c);
+        }
+      SelectedComponents<dim> selection(
+        solution_names, data_component_interpretation, selected_components);
       DataOut<dim> data_out;
       data_out.attach_dof_handler(dof_handler);
       // vector to be output must be ghosted
-      data_out.add_data_vector(present_solution,
-                               solution_names,
-                               DataOut<dim>::type_dof_data,
-                               data_component_interpretation);
-      data_out.add_data_vector(fsi_acceleration,
-                               fsi_force_names,
-                               DataOut<dim>::type_dof_data,
-                               data_component_interpretation);
+      if (output_velocity && output_pressure)
+        {
+          data_out.add_data_vector(present_solution,
+                                   solution_names,
+                                   DataOut<dim>::type_dof_data,
+                                   data_component_interpretation);
+        }
+      else if (output_velocity || output_pressure)
+        {
+          data_out.add_data_vector(present_solution, selection);
+        }
+      if (parameters.output_field("fsi_force"))
+        {
+          data_out.add_data_vector(fsi_acceleration,
+                                   fsi_force_names,
+                                   DataOut<dim>::type_dof_data,
+                                   data_component_interpretation);
+        }
 
       // Partition
       Vector<float> subdomain(triangulation.n_active_cells());
-      for (unsigned int i = 0; i < subdomain.size(); ++i)
+      if (parameters.output_field("subdomain"))
         {
-          subdomain(i) = triangulation.locally_owned_subdomain();
+          for (unsigned int i = 0; i < subdomain.size(); ++i)
+            {
+              subdomain(i) = triangulation.locally_owned_subdomain();
+            }
+          data_out.add_data_vector(subdomain, "subdomain");
         }
-      data_out.add_data_vector(subdomain, "subdomain");
 
       // Indicator
       Vector<float> ind(triangulation.n_active_cells());
-      for (auto cell = triangulation.begin_active();
-           cell != triangulation.end();
-           ++cell)
-        {
-          if (cell->is_locally_owned())
-            {
-              auto p = cell_property.get_data(cell);
-              ind[cell->active_cell_index()] = p[0]->indicator;
-            }
-        }
-      data_out.add_data_vector(ind, "Indicator");
-      // FSI acceleration
       Vector<float> fsi_acc_x(triangulation.n_active_cells());
       Vector<float> fsi_acc_y(triangulation.n_active_cells());
       Vector<float> fsi_acc_z(triangulation.n_active_cells());
-      for (auto cell = triangulation.begin_active();
-           cell != triangulation.end();
-           ++cell)
+      if (parameters.output_field("indicator"))
         {
-          if (cell->is_locally_owned())
+          for (auto cell = triangulation.begin_active();
+               cell != triangulation.end();
+               ++cell)
             {
-              auto p = cell_property.get_data(cell);
-              fsi_acc_x[cell->active_cell_index()] = p[0]->fsi_acceleration[0];
-              fsi_acc_y[cell->active_cell_index()] = p[0]->fsi_acceleration[1];
+              if (cell->is_locally_owned())
+                {
+                  ind[cell->active_cell_index()] =
+                    cell_property.indicator[cell->active_cell_index()];
+                }
             }
+          data_out.add_data_vector(ind, "Indicator");
         }
-      data_out.add_data_vector(fsi_acc_x, "fsi_force_x");
-      data_out.add_data_vector(fsi_acc_y, "fsi_force_y");
-      if (dim == 3)
+      // FSI acceleration
+      if (parameters.output_field("fsi_force"))
         {
           for (auto cell = triangulation.begin_active();
                cell != triangulation.end();
@@ -442,26 +728,66 @@ namespace Fluid
             {
               if (cell->is_locally_owned())
                 {
-                  auto p = cell_property.get_data(cell);
-                  fsi_acc_z[cell->active_cell_index()] =
-                    p[0]->fsi_acceleration[2];
+                  const auto &fsi_acc =
+                    cell_property.fsi_acceleration[cell->active_cell_index()];
+                  fsi_acc_x[cell->active_cell_index()] = fsi_acc[0];
+                  fsi_acc_y[cell->active_cell_index()] = fsi_acc[1];
+                  if (dim == 3)
+                    fsi_acc_z[cell->active_cell_index()] = fsi_acc[dim - 1];
                 }
             }
-          data_out.add_data_vector(fsi_acc_z, "fsi_force_z");
+          data_out.add_data_vector(fsi_acc_x, "fsi_force_x");
+          data_out.add_data_vector(fsi_acc_y, "fsi_force_y");
+          if (dim == 3)
+            {
+              data_out.add_data_vector(fsi_acc_z, "fsi_force_z");
+            }
         }
 
       // stress
-      data_out.add_data_vector(scalar_dof_handler, tmp_stress[0][0], "Sxx");
-      data_out.add_data_vector(scalar_dof_handler, tmp_stress[0][1], "Sxy");
-      data_out.add_data_vector(scalar_dof_handler, tmp_stress[1][1], "Syy");
-      if (dim == 3)
+      std::vector<std::vector<VectorType>> tmp_stress;
+      if (parameters.output_field("stress"))
         {
-          data_out.add_data_vector(scalar_dof_handler, tmp_stress[0][2], "Sxz");
-          data_out.add_data_vector(scalar_dof_handler, tmp_stress[1][2], "Syz");
-          data_out.add_data_vector(scalar_dof_handler, tmp_stress[2][2], "Szz");
+          tmp_stress = std::vector<std::vector<VectorType>>(
+            dim,
+            std::vector<VectorType>(dim,
+                                    VectorType(locally_owned_scalar_dofs,
+                                               locally_relevant_scalar_dofs,
+                                               mpi_communicator)));
+          tmp_stress = stress;
+          data_out.add_data_vector(
+            scalar_dof_handler, tmp_stress[0][0], "Sxx");
+          data_out.add_data_vector(
+            scalar_dof_handler, tmp_stress[0][1], "Sxy");
+          data_out.add_data_vector(
+            scalar_dof_handler, tmp_stress[1][1], "Syy");
+          if (dim == 3)
+            {
+              data_out.add_data_vector(
+                scalar_dof_handler, tmp_stress[0][2], "Sxz");
+              data_out.add_data_vector(
+                scalar_dof_handler, tmp_stress[1][2], "Syz");
+              data_out.add_data_vector(
+                scalar_dof_handler, tmp_stress[2][2], "Szz");
+            }
         }
 
-      data_out.build_patches(parameters.fluid_pressure_degree);
+      Utils::select_output_cells(data_out, parameters.output_region);
+      data_out.build_patches(parameters.output_subdivisions > 0
+                               ? parameters.output_subdivisions
+                               : parameters.fluid_pressure_degree);
+      data_out.set_flags(Utils::vtk_flags(parameters.output_compression));
+
+      if (parameters.output_format == "hdf5")
+        {
+          hdf5_output.write(data_out, output_index, time.current());
+          return;
+        }
+      if (parameters.output_format == "ascent")
+        {
+          insitu_output.publish(data_out, output_index, time.current());
+          return;
+        }
 
       std::string basename =
         "fluid" + Utilities::int_to_string(output_index, 6) + "-";
@@ -471,8 +797,8 @@ namespace Fluid
         Utilities::int_to_string(triangulation.locally_owned_subdomain(), 4) +
         ".vtu";
 
-      std::ofstream output(filename);
-      data_out.write_vtu(output);
+      writer.write(filename,
+                   [&data_out](std::ostream &out) { data_out.write_vtu(out); });
 
       if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
         {
@@ -484,13 +810,14 @@ namespace Fluid
                 {time.current(),
                  basename + Utilities::int_to_string(i, 4) + ".vtu"});
             }
-          std::ofstream pvd_output("fluid.pvd");
-          DataOutBase::write_pvd_record(pvd_output, times_and_names);
+          writer.write("fluid.pvd", [this](std::ostream &out) {
+            DataOutBase::write_pvd_record(out, times_and_names);
+          });
         }
     }
 
-    template <int dim>
-    void FluidSolver<dim>::save_checkpoint(const int output_index)
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::save_checkpoint(const int output_index)
     {
       if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
         {
@@ -512,6 +839,13 @@ namespace Fluid
               pcout << "Removing " << *checkpoints.begin() << std::endl;
               fs::path to_be_removed(*checkpoints.begin());
               fs::remove(to_be_removed);
+              for (unsigned int i = 0;
+                   i < Utilities::MPI::n_mpi_processes(mpi_communicator);
+                   ++i)
+                {
+                  fs::remove(to_be_removed.string() + ".pattern." +
+                             Utilities::int_to_string(i, 4));
+                }
               to_be_removed.replace_extension(".fluid_checkpoint.info");
               fs::remove(to_be_removed);
               checkpoints.erase(checkpoints.begin());
@@ -521,17 +855,18 @@ namespace Fluid
       std::string checkpoint_file = Utilities::int_to_string(output_index, 6);
       checkpoint_file.append(".fluid_checkpoint");
       // Save the solution
-      parallel::distributed::SolutionTransfer<dim,
-                                              PETScWrappers::MPI::BlockVector>
-        sol_trans(dof_handler);
+      parallel::distributed::SolutionTransfer<dim, BlockVectorType> sol_trans(
+        dof_handler);
       sol_trans.prepare_serialization(present_solution);
       triangulation.save(checkpoint_file.c_str());
+      // So that a restart on the same processes skips the sparsity patterns.
+      sparsity_cache.save(sparsity_cache_file(checkpoint_file));
       pcout << "Checkpoint file successfully saved at time step "
             << output_index << "!" << std::endl;
     }
 
-    template <int dim>
-    bool FluidSolver<dim>::load_checkpoint()
+    template <int dim, typename Backend>
+    bool FluidSolver<dim, Backend>::load_checkpoint()
     {
       // Specify the current working path
       fs::path local_path = fs::current_path();
@@ -555,25 +890,37 @@ namespace Fluid
             << std::endl;
           return false;
         }
+      AssertThrow(!time.adaptive(),
+                  ExcMessage("Restarting is not supported with adaptive time "
+                             "stepping!"));
       // set time step load the checkpoint file
       pcout << "Loading checkpoint file " << checkpoint_file.filename().c_str()
             << "!" << std::endl;
       triangulation.load(checkpoint_file.filename().c_str());
+      sparsity_cache.load(
+        sparsity_cache_file(checkpoint_file.filename().string()));
       setup_dofs();
       make_constraints();
       initialize_system();
-      parallel::distributed::SolutionTransfer<dim,
-                                              PETScWrappers::MPI::BlockVector>
-        sol_trans(dof_handler);
-      PETScWrappers::MPI::BlockVector tmp;
+      parallel::distributed::SolutionTransfer<dim, BlockVectorType> sol_trans(
+        dof_handler);
+      BlockVectorType tmp;
       tmp.reinit(owned_partitioning, mpi_communicator);
       sol_trans.deserialize(tmp);
       present_solution = tmp;
+      restore_time(Utilities::string_to_int(checkpoint_file.stem()));
+
+      pcout << "Checkpoint file successfully loaded from time step "
+            << time.get_timestep() << "!" << std::endl;
+      return true;
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::restore_time(const int timestep)
+    {
       // Update the time and names to set the current time and write
       // correct .pvd file.
-
-      for (int i = 0; i <= Utilities::string_to_int(checkpoint_file.stem());
-           ++i)
+      for (int i = 0; i <= timestep; ++i)
         {
           if ((time.current() == 0 || time.time_to_output()) &&
               Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
@@ -590,7 +937,7 @@ namespace Fluid
                      basename + Utilities::int_to_string(j, 4) + ".vtu"});
                 }
             }
-          if (i == Utilities::string_to_int(checkpoint_file.stem()))
+          if (i == timestep)
             break;
           time.increment();
           // Update the time for hard coded boundary conditions
@@ -602,14 +949,10 @@ namespace Fluid
                 }
             }
         }
-
-      pcout << "Checkpoint file successfully loaded from time step "
-            << time.get_timestep() << "!" << std::endl;
-      return true;
     }
 
-    template <int dim>
-    void FluidSolver<dim>::update_stress()
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::update_stress()
     {
       for (unsigned int i = 0; i < dim; ++i)
         {
@@ -618,8 +961,7 @@ namespace Fluid
               stress[i][j] = 0;
             }
         }
-      PETScWrappers::MPI::Vector surrounding_cells(locally_owned_scalar_dofs,
-                                                   mpi_communicator);
+      VectorType surrounding_cells(locally_owned_scalar_dofs, mpi_communicator);
       surrounding_cells = 0.0;
       // The stress tensors are stored as 2D vectors of shape dim*dim
       // at cell and quadrature point level.
@@ -711,31 +1053,609 @@ namespace Fluid
         }
     }
 
-    template <int dim>
-    FluidSolver<dim>::BoundaryValues::BoundaryValues(
+    template <int dim, typename Backend>
+    FluidSolver<dim, Backend>::BoundaryValues::BoundaryValues(
       const BoundaryValues &source)
       : Function<dim>(dim + 1), value_function(source.value_function)
     {
     }
 
-    template <int dim>
-    FluidSolver<dim>::BoundaryValues::BoundaryValues(
+    template <int dim, typename Backend>
+    FluidSolver<dim, Backend>::BoundaryValues::BoundaryValues(
       const std::function<double(
         const Point<dim> &, const unsigned int, const double)> &value_function)
       : Function<dim>(dim + 1), value_function(value_function)
     {
     }
 
-    template <int dim>
+    template <int dim, typename Backend>
+    double
+    FluidSolver<dim, Backend>::BoundaryValues::value(
+      const Point<dim> &p, const unsigned int component) const
+    {
+      return value_function(p, component, this->get_time());
+    }
+
+    template <int dim, typename Backend>
     void
-    FluidSolver<dim>::BoundaryValues::vector_value(const Point<dim> &p,
-                                                   Vector<double> &values) const
+    FluidSolver<dim, Backend>::BoundaryValues::vector_value(
+      const Point<dim> &p, Vector<double> &values) const
     {
       for (unsigned int c = 0; c < this->n_components; ++c)
         values(c) = value_function(p, c, this->get_time());
     }
 
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::assemble_cells(
+      const CellWorker &worker,
+      const std::function<void(const AssemblyCopyData &)> &copier)
+    {
+      if (parameters.fluid_geometry_cache_memory > 0 &&
+          !geometry_cache.is_initialized())
+        {
+          geometry_cache.reinit(dof_handler,
+                                volume_quad_formula,
+                                parameters.fluid_geometry_cache_memory,
+                                mpi_communicator);
+        }
+      using Iterator = typename std::vector<
+        typename DoFHandler<dim>::active_cell_iterator>::const_iterator;
+      auto run = [&](const Iterator &begin, const Iterator &end) {
+        WorkStream::run(
+          begin,
+          end,
+          [&worker](const Iterator &cell,
+                    AssemblyScratchData &scratch,
+                    AssemblyCopyData &data) { worker(*cell, scratch, data); },
+          copier,
+          AssemblyScratchData(
+            fe, volume_quad_formula, face_quad_formula, &geometry_cache),
+          AssemblyCopyData(fe.dofs_per_cell));
+      };
+      const Iterator interior_end = assembly_cells.cbegin() + n_interior_cells;
+      run(assembly_cells.cbegin(), interior_end);
+      finish_ghost_updates();
+      run(interior_end, assembly_cells.cend());
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::start_ghost_update(
+      BlockVectorType &ghosted, const BlockVectorType &owned)
+    {
+      Traits::start_ghost_update(ghosted, owned);
+      pending_ghost_updates.push_back(&ghosted);
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::finish_ghost_updates()
+    {
+      for (auto vector : pending_ghost_updates)
+        {
+          Traits::finish_ghost_update(*vector);
+        }
+      pending_ghost_updates.clear();
+    }
+
+    template <int dim, typename Backend>
+    double FluidSolver<dim, Backend>::cfl_time_step() const
+    {
+      double delta_t = std::numeric_limits<double>::max();
+      if (parameters.target_cfl == 0)
+        {
+          return delta_t;
+        }
+      FEValues<dim> fe_values(fe, volume_quad_formula, update_values);
+      const FEValuesExtractors::Vector velocities(0);
+      std::vector<Tensor<1, dim>> velocity(volume_quad_formula.size());
+      // The nodes of a higher order element are closer than its vertices.
+      const double degree = parameters.fluid_velocity_degree;
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (!cell->is_locally_owned())
+            {
+              continue;
+            }
+          fe_values.reinit(cell);
+          fe_values[velocities].get_function_values(present_solution,
+                                                    velocity);
+          double speed = 0;
+          for (const auto &v : velocity)
+            {
+              speed = std::max(speed, v.norm());
+            }
+          if (speed > 0)
+            {
+              delta_t =
+                std::min(delta_t,
+                         parameters.target_cfl *
+                           cell->minimum_vertex_distance() / (degree * speed));
+            }
+        }
+      return Utilities::MPI::min(delta_t, mpi_communicator);
+    }
+
+    template <int dim, typename Backend>
+    double
+    FluidSolver<dim, Backend>::stabilization_parameter(
+      const Tensor<1, dim> &velocity, const double h) const
+    {
+      const double nu = parameters.viscosity / parameters.fluid_rho;
+      const double transient = 2.0 / time.get_delta_t();
+      const double convection = 2.0 * velocity.norm() / h;
+      const double diffusion = 4.0 * nu / (h * h);
+      return 1.0 / std::sqrt(transient * transient + convection * convection +
+                             9.0 * diffusion * diffusion);
+    }
+
+    template <int dim, typename Backend>
+    double FluidSolver<dim, Backend>::iteration_factor() const
+    {
+      double factor = std::numeric_limits<double>::max();
+      if (parameters.target_newton_iterations > 0 && n_newton_iterations > 0)
+        {
+          factor = std::min(factor,
+                            static_cast<double>(
+                              parameters.target_newton_iterations) /
+                              n_newton_iterations);
+        }
+      if (parameters.target_linear_iterations > 0 && n_linear_iterations > 0)
+        {
+          factor = std::min(factor,
+                            static_cast<double>(
+                              parameters.target_linear_iterations) /
+                              n_linear_iterations);
+        }
+      return std::max(factor, 0.5);
+    }
+
+    template <int dim, typename Backend>
+    void
+    FluidSolver<dim, Backend>::add_memory(Utils::MemoryReport &report) const
+    {
+      report.add_object("Mesh", "Triangulation", triangulation);
+      report.add_object("Mesh", "DoFHandler", dof_handler);
+      report.add_object("Mesh", "Scalar DoFHandler", scalar_dof_handler);
+      report.add_object("Sparsity", "Sparsity pattern", sparsity_pattern);
+      report.add_object("Sparsity", "Sparsity cache", sparsity_cache);
+      report.add("Sparsity",
+                 "Constraints",
+                 zero_constraints.memory_consumption() +
+                   nonzero_constraints.memory_consumption());
+      report.add("Matrices",
+                 "System matrix",
+                 Traits::matrix_memory(system_matrix));
+      report.add("Matrices",
+                 "Mass matrix",
+                 Traits::matrix_memory(mass_matrix));
+      report.add("Matrices",
+                 "Mass Schur matrix",
+                 Traits::matrix_memory(mass_schur));
+      if (parameters.fluid_schur_approximation == "pcd")
+        {
+          report.add("Matrices",
+                     "Pressure convection matrix",
+                     Traits::matrix_memory(pressure_convection));
+        }
+      report.add("Vectors",
+                 "Solution and rhs",
+                 present_solution.memory_consumption() +
+                   solution_increment.memory_consumption() +
+                   fsi_acceleration.memory_consumption() +
+                   system_rhs.memory_consumption());
+      double history = 0;
+      for (const auto &solution : solution_history)
+        {
+          history += solution.memory_consumption();
+        }
+      report.add("Vectors", "Solution history", history);
+      double nodal_stress = 0;
+      for (const auto &row : stress)
+        {
+          for (const auto &component : row)
+            {
+              nodal_stress += component.memory_consumption();
+            }
+        }
+      report.add("Vectors", "Nodal stress", nodal_stress);
+      report.add("Cell data",
+                 "Cell properties",
+                 MemoryConsumption::memory_consumption(
+                   cell_property.indicator) +
+                   MemoryConsumption::memory_consumption(
+                     cell_property.fsi_acceleration) +
+                   MemoryConsumption::memory_consumption(
+                     cell_property.fsi_stress) +
+                   MemoryConsumption::memory_consumption(
+                     cell_property.material_id));
+      report.add_object("Cell data", "Geometry cache", geometry_cache);
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::report_memory()
+    {
+      if (!parameters.memory_report || memory_report.empty())
+        {
+          return;
+        }
+      add_memory(memory_report);
+      memory_report.print(pcout,
+                          "at time step " +
+                            Utilities::int_to_string(time.get_timestep()));
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::adapt_time_step()
+    {
+      // The first step takes the initial size.
+      if (!time.adaptive() || time.get_timestep() == 0)
+        {
+          return;
+        }
+      time.adapt_delta_t(cfl_time_step(), iteration_factor());
+      pcout << "Adapted time step size = " << std::scientific
+            << time.get_delta_t() << std::endl;
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::update_solution_history()
+    {
+      if (parameters.fluid_extrapolation_order == 0)
+        {
+          return;
+        }
+      // Keep one more solution than the order, and reuse the oldest one.
+      BlockVectorType latest;
+      if (solution_history.size() > parameters.fluid_extrapolation_order)
+        {
+          latest.swap(solution_history.back());
+          solution_history.pop_back();
+          solution_history_times.pop_back();
+        }
+      else
+        {
+          latest.reinit(owned_partitioning, mpi_communicator);
+        }
+      latest = present_solution;
+      solution_history.emplace_front();
+      solution_history.front().swap(latest);
+      solution_history_times.push_front(time.current());
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::save_step_state()
+    {
+      step_state.time = time.state();
+      step_state.present_solution.reinit(present_solution);
+      step_state.present_solution = present_solution;
+      step_state.solution_increment.reinit(solution_increment);
+      step_state.solution_increment = solution_increment;
+      step_state.solution_history = solution_history;
+      step_state.solution_history_times = solution_history_times;
+      step_state.n_outputs = times_and_names.size();
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::restore_step_state()
+    {
+      time.rewind(step_state.time);
+      present_solution = step_state.present_solution;
+      solution_increment = step_state.solution_increment;
+      solution_history = step_state.solution_history;
+      solution_history_times = step_state.solution_history_times;
+      times_and_names.resize(step_state.n_outputs);
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::extrapolate_solution(
+      BlockVectorType &prediction) const
+    {
+      const unsigned int n = solution_history.size();
+      if (n < 2)
+        {
+          prediction = present_solution;
+          return;
+        }
+      // The change from present_solution, which is solution_history[0].
+      BlockVectorType change;
+      change.reinit(owned_partitioning, mpi_communicator);
+      change = 0;
+      const double t = time.current();
+      for (unsigned int i = 0; i < n; ++i)
+        {
+          double weight = 1.0;
+          for (unsigned int j = 0; j < n; ++j)
+            {
+              if (j != i)
+                {
+                  weight *= (t - solution_history_times[j]) /
+                            (solution_history_times[i] -
+                             solution_history_times[j]);
+                }
+            }
+          change.add(i == 0 ? weight - 1.0 : weight, solution_history[i]);
+        }
+      zero_constraints.distribute(change);
+      change += solution_history[0];
+      prediction = change;
+    }
+
+    template <int dim, typename Backend>
+    FluidSolver<dim, Backend>::AssemblyScratchData::AssemblyScratchData(
+      const FiniteElement<dim> &fe,
+      const Quadrature<dim> &volume_quad_formula,
+      const Quadrature<dim - 1> &face_quad_formula,
+      const Utils::CellGeometryCache<dim> *cache)
+      : fe_values(fe,
+                  volume_quad_formula,
+                  update_values | update_quadrature_points |
+                    update_JxW_values | update_gradients),
+        fe_face_values(fe,
+                       face_quad_formula,
+                       update_values | update_normal_vectors |
+                         update_quadrature_points | update_JxW_values),
+        velocities(0),
+        pressure(dim),
+        dofs_per_cell(fe.dofs_per_cell),
+        n_q_points(volume_quad_formula.size()),
+        geometry_cache(cache),
+        cached(false),
+        components(fe.dofs_per_cell),
+        reference_values(fe.dofs_per_cell * volume_quad_formula.size()),
+        reference_gradients(fe.dofs_per_cell * volume_quad_formula.size()),
+        cached_gradients(fe.dofs_per_cell * volume_quad_formula.size()),
+        cached_quadrature_points(volume_quad_formula.size()),
+        local_values(fe.dofs_per_cell),
+        div_phi_u(fe.dofs_per_cell),
+        phi_u(fe.dofs_per_cell),
+        grad_phi_u(fe.dofs_per_cell),
+        phi_p(fe.dofs_per_cell),
+        grad_phi_p(fe.dofs_per_cell),
+        stabilization_weights(fe.dofs_per_cell),
+        stabilization_residuals(fe.dofs_per_cell),
+        current_velocity_values(volume_quad_formula.size()),
+        current_velocity_gradients(volume_quad_formula.size()),
+        current_velocity_divergences(volume_quad_formula.size()),
+        current_pressure_values(volume_quad_formula.size()),
+        current_pressure_gradients(volume_quad_formula.size()),
+        present_velocity_values(volume_quad_formula.size()),
+        present_pressure_values(volume_quad_formula.size()),
+        fsi_acc_values(volume_quad_formula.size()),
+        sigma_pml(volume_quad_formula.size()),
+        artificial_bf(volume_quad_formula.size())
+    {
+      Assert(fe.is_primitive(),
+             ExcMessage("The geometry cache needs a primitive element!"));
+      for (unsigned int k = 0; k < dofs_per_cell; ++k)
+        {
+          components[k] = fe.system_to_component_index(k).first;
+        }
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        {
+          const Point<dim> &point = volume_quad_formula.point(q);
+          for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            {
+              reference_values[q * dofs_per_cell + k] =
+                fe.shape_value(k, point);
+              reference_gradients[q * dofs_per_cell + k] =
+                fe.shape_grad(k, point);
+            }
+        }
+    }
+
+    template <int dim, typename Backend>
+    FluidSolver<dim, Backend>::AssemblyScratchData::AssemblyScratchData(
+      const AssemblyScratchData &scratch)
+      : fe_values(scratch.fe_values.get_fe(),
+                  scratch.fe_values.get_quadrature(),
+                  scratch.fe_values.get_update_flags()),
+        fe_face_values(scratch.fe_face_values.get_fe(),
+                       scratch.fe_face_values.get_quadrature(),
+                       scratch.fe_face_values.get_update_flags()),
+        velocities(scratch.velocities),
+        pressure(scratch.pressure),
+        dofs_per_cell(scratch.dofs_per_cell),
+        n_q_points(scratch.n_q_points),
+        geometry_cache(scratch.geometry_cache),
+        cached(false),
+        components(scratch.components),
+        reference_values(scratch.reference_values),
+        reference_gradients(scratch.reference_gradients),
+        cached_gradients(scratch.cached_gradients),
+        cached_quadrature_points(scratch.cached_quadrature_points),
+        local_values(scratch.local_values),
+        div_phi_u(scratch.div_phi_u),
+        phi_u(scratch.phi_u),
+        grad_phi_u(scratch.grad_phi_u),
+        phi_p(scratch.phi_p),
+        grad_phi_p(scratch.grad_phi_p),
+        stabilization_weights(scratch.stabilization_weights),
+        stabilization_residuals(scratch.stabilization_residuals),
+        current_velocity_values(scratch.current_velocity_values),
+        current_velocity_gradients(scratch.current_velocity_gradients),
+        current_velocity_divergences(scratch.current_velocity_divergences),
+        current_pressure_values(scratch.current_pressure_values),
+        current_pressure_gradients(scratch.current_pressure_gradients),
+        present_velocity_values(scratch.present_velocity_values),
+        present_pressure_values(scratch.present_pressure_values),
+        fsi_acc_values(scratch.fsi_acc_values),
+        sigma_pml(scratch.sigma_pml),
+        artificial_bf(scratch.artificial_bf)
+    {
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::AssemblyScratchData::reinit(
+      const typename DoFHandler<dim>::active_cell_iterator &new_cell)
+    {
+      cell = new_cell;
+      cached = geometry_cache != nullptr &&
+               geometry_cache->is_cached(cell->active_cell_index());
+      if (!cached)
+        {
+          fe_values.reinit(cell);
+          return;
+        }
+      const unsigned int index = cell->active_cell_index();
+      const auto inverse_jacobians = geometry_cache->inverse_jacobians(index);
+      const auto quadrature_points = geometry_cache->quadrature_points(index);
+      cached_JxW = geometry_cache->JxW(index);
+      // The covariant transformation of the reference gradients:
+      // \f$\partial_d\phi = \sum_e \hat\partial_e\phi\,J^{-1}_{ed}\f$.
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        {
+          cached_quadrature_points[q] = quadrature_points[q];
+          for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            {
+              cached_gradients[q * dofs_per_cell + k] =
+                reference_gradients[q * dofs_per_cell + k] *
+                inverse_jacobians[q];
+            }
+        }
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::AssemblyScratchData::get_velocity_values(
+      const BlockVectorType &vector,
+      std::vector<Tensor<1, dim>> &values)
+    {
+      if (!cached)
+        {
+          fe_values[velocities].get_function_values(vector, values);
+          return;
+        }
+      cell->get_dof_values(vector, local_values);
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        {
+          values[q] = 0;
+          for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            {
+              if (components[k] < dim)
+                {
+                  values[q][components[k]] +=
+                    local_values[k] * reference_values[q * dofs_per_cell + k];
+                }
+            }
+        }
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::AssemblyScratchData::get_velocity_gradients(
+      const BlockVectorType &vector,
+      std::vector<Tensor<2, dim>> &gradients)
+    {
+      if (!cached)
+        {
+          fe_values[velocities].get_function_gradients(vector, gradients);
+          return;
+        }
+      cell->get_dof_values(vector, local_values);
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        {
+          gradients[q] = 0;
+          for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            {
+              if (components[k] < dim)
+                {
+                  gradients[q][components[k]] +=
+                    local_values[k] * cached_gradients[q * dofs_per_cell + k];
+                }
+            }
+        }
+    }
+
+    template <int dim, typename Backend>
+    void
+    FluidSolver<dim, Backend>::AssemblyScratchData::get_velocity_divergences(
+      const BlockVectorType &vector,
+      std::vector<double> &divergences)
+    {
+      if (!cached)
+        {
+          fe_values[velocities].get_function_divergences(vector, divergences);
+          return;
+        }
+      cell->get_dof_values(vector, local_values);
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        {
+          divergences[q] = 0;
+          for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            {
+              if (components[k] < dim)
+                {
+                  divergences[q] +=
+                    local_values[k] *
+                    cached_gradients[q * dofs_per_cell + k][components[k]];
+                }
+            }
+        }
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::AssemblyScratchData::get_pressure_values(
+      const BlockVectorType &vector,
+      std::vector<double> &values)
+    {
+      if (!cached)
+        {
+          fe_values[pressure].get_function_values(vector, values);
+          return;
+        }
+      cell->get_dof_values(vector, local_values);
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        {
+          values[q] = 0;
+          for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            {
+              if (components[k] == dim)
+                {
+                  values[q] +=
+                    local_values[k] * reference_values[q * dofs_per_cell + k];
+                }
+            }
+        }
+    }
+
+    template <int dim, typename Backend>
+    void FluidSolver<dim, Backend>::AssemblyScratchData::get_pressure_gradients(
+      const BlockVectorType &vector,
+      std::vector<Tensor<1, dim>> &gradients)
+    {
+      if (!cached)
+        {
+          fe_values[pressure].get_function_gradients(vector, gradients);
+          return;
+        }
+      cell->get_dof_values(vector, local_values);
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        {
+          gradients[q] = 0;
+          for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            {
+              if (components[k] == dim)
+                {
+                  gradients[q] +=
+                    local_values[k] * cached_gradients[q * dofs_per_cell + k];
+                }
+            }
+        }
+    }
+
+    template <int dim, typename Backend>
+    FluidSolver<dim, Backend>::AssemblyCopyData::AssemblyCopyData(
+      const unsigned int dofs_per_cell)
+      : local_matrix(dofs_per_cell, dofs_per_cell),
+        local_mass_matrix(dofs_per_cell, dofs_per_cell),
+        local_rhs(dofs_per_cell),
+        local_dof_indices(dofs_per_cell)
+    {
+    }
+
     template class FluidSolver<2>;
     template class FluidSolver<3>;
+#ifdef OPENIFEM_WITH_TRILINOS
+    template class FluidSolver<2, Utils::TrilinosBackend>;
+    template class FluidSolver<3, Utils::TrilinosBackend>;
+#endif
   } // namespace MPI
 } // namespace Fluid
@@ -1,12 +1,16 @@
 #include "mpi_fsi.h"
 #include <iostream>
+#include <numeric>
+#include <unordered_set>
 
 namespace MPI
 {
   template <int dim>
   FSI<dim>::~FSI()
   {
+    cell_weight_connection.disconnect();
     timer.print_summary();
+    performance.write("fsi", timer);
   }
 
   template <int dim>
@@ -18,25 +22,302 @@ namespace MPI
       solid_solver(s),
       parameters(p),
       mpi_communicator(MPI_COMM_WORLD),
-      pcout(std::cout, Utilities::MPI::this_mpi_process(mpi_communicator) == 0),
+      // In the split mode the first process of each group reports on its own
+      // solver, and the timer only synchronizes within the group.
+      pcout(std::cout,
+            Utilities::MPI::this_mpi_process(fluid_solver.mpi_communicator) ==
+              0),
       time(parameters.end_time,
            parameters.time_step,
            parameters.output_interval,
            parameters.refinement_interval,
            parameters.save_interval),
-      timer(
-        mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
-      use_dirichlet_bc(use_dirichlet_bc)
+      timer(fluid_solver.mpi_communicator,
+            pcout,
+            TimerOutput::never,
+            TimerOutput::wall_times),
+      performance(fluid_solver.mpi_communicator,
+                  parameters.performance_summary),
+      solid_locator(solid_solver.dof_handler),
+      fluid_evaluator(fluid_solver.dof_handler),
+      boundary_evaluator(fluid_solver.dof_handler),
+      use_dirichlet_bc(use_dirichlet_bc),
+      split(parameters.n_solid_processes > 0),
+      solid_process(Utilities::MPI::this_mpi_process(mpi_communicator) <
+                    parameters.n_solid_processes),
+      canonical_fluid_offset(0),
+      checkpoint_mesh_step(-1),
+      coupling_accelerator(parameters.coupling_acceleration,
+                           parameters.coupling_relaxation),
+      iteration_residual(0),
+      coupling_residual(0),
+      deformed_from(nullptr),
+      deformed_state(0),
+      profiler(fluid_solver.mpi_communicator,
+               solid_process && !parameters.coupling_profile.empty()
+                 ? "solid-" + parameters.coupling_profile
+                 : parameters.coupling_profile,
+               {"Run fluid solver",
+                "Wait for fluid",
+                "Run solid solver",
+                "Wait for solid",
+                "Coupling iteration",
+                "Coupling iterations",
+                "Pack solid state",
+                "Unpack solid state",
+                "Move solid mesh",
+                "Update solid box",
+                "Update indicator",
+                "Interface cells",
+                "Points tested",
+                "Cells tested",
+                "Gathered solid dofs",
+                "Find fluid BC",
+                "Find solid BC",
+                "Locator searches",
+                "Locator BFS steps",
+                "Refine mesh",
+                "Cells flagged"}),
+      telemetry(fluid_solver.mpi_communicator,
+                parameters.telemetry_prefix,
+                split && solid_process ? "fsi_solid" : "fsi"),
+      fluid_time(0),
+      coupling_time(0),
+      n_balance_steps(0),
+      near_solid_weight(0)
   {
+    telemetry.watch(timer);
+    if (parameters.node_shared_solid_state)
+      {
+        shared_solid_state.reset(
+          new Utils::NodeSharedVectors(solid_solver.mpi_communicator));
+      }
     solid_box.reinit(2 * dim);
+    full_indicator_update = true;
+    if (parameters.adaptive_time_stepping)
+      {
+        time.set_adaptive(parameters.min_time_step,
+                          parameters.max_time_step,
+                          parameters.max_time_step_growth);
+      }
+    const unsigned int n_processes =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    AssertThrow(parameters.n_solid_processes < n_processes,
+                ExcMessage("At least one process must run the fluid!"));
+    AssertThrow(!split || parameters.coupling_iterations == 1,
+                ExcMessage("The split mode only supports the staggered "
+                           "coupling!"));
+    const unsigned int n_group_processes =
+      split ? (solid_process ? parameters.n_solid_processes
+                             : n_processes - parameters.n_solid_processes)
+            : n_processes;
+    AssertThrow(
+      Utilities::MPI::n_mpi_processes(fluid_solver.mpi_communicator) ==
+          n_group_processes &&
+        Utilities::MPI::n_mpi_processes(solid_solver.mpi_communicator) ==
+          n_group_processes,
+      ExcMessage("The solvers must be constructed with the communicator "
+                 "returned by FSI::solver_communicator!"));
+  }
+
+  template <int dim>
+  MPI_Comm
+  FSI<dim>::solver_communicator(const Parameters::AllParameters &parameters)
+  {
+    if (parameters.n_solid_processes == 0)
+      {
+        return MPI_COMM_WORLD;
+      }
+    const unsigned int rank = Utilities::MPI::this_mpi_process(MPI_COMM_WORLD);
+    const int color = rank < parameters.n_solid_processes ? 0 : 1;
+    MPI_Comm comm;
+    int ierr = MPI_Comm_split(MPI_COMM_WORLD, color, rank, &comm);
+    AssertThrowMPI(ierr);
+    return comm;
+  }
+
+  template <int dim>
+  std::vector<ArrayView<const double>>
+  FSI<dim>::localize_solid_state(std::vector<Vector<double>> &localized,
+                                 const unsigned int n_vectors)
+  {
+    const std::vector<const PETScWrappers::MPI::Vector *> vectors{
+      &solid_solver.current_displacement,
+      &solid_solver.current_velocity,
+      &solid_solver.current_acceleration};
+    AssertIndexRange(n_vectors - 1, vectors.size());
+    std::vector<ArrayView<const double>> views;
+    if (shared_solid_state)
+      {
+        // All of them are localized, so that the shared copy of the ones
+        // that have not changed can be reused by the next call.
+        shared_solid_state->localize(vectors);
+        for (unsigned int k = 0; k < n_vectors; ++k)
+          {
+            views.push_back((*shared_solid_state)[k]);
+          }
+        return views;
+      }
+    localized.resize(n_vectors);
+    for (unsigned int k = 0; k < n_vectors; ++k)
+      {
+        localized[k] = *vectors[k];
+        views.emplace_back(localized[k].begin(), localized[k].size());
+      }
+    return views;
+  }
+
+  template <int dim>
+  void FSI<dim>::update_coupling_cells()
+  {
+    artificial_cells.clear();
+    interface_cells.clear();
+    std::vector<Point<dim>> vertices(GeometryInfo<dim>::vertices_per_cell);
+    for (auto f_cell = fluid_solver.dof_handler.begin_active();
+         f_cell != fluid_solver.dof_handler.end();
+         ++f_cell)
+      {
+        if (f_cell->is_artificial())
+          {
+            continue;
+          }
+        if (f_cell->is_locally_owned() &&
+            fluid_solver.cell_property.indicator[f_cell->active_cell_index()] !=
+              0)
+          {
+            artificial_cells.push_back(f_cell);
+            if (use_dirichlet_bc)
+              interface_cells.push_back(f_cell);
+            continue;
+          }
+        if (!use_dirichlet_bc || !near_solid(f_cell))
+          {
+            continue;
+          }
+        if (f_cell->is_locally_owned())
+          {
+            for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+                 ++v)
+              {
+                vertices[v] = f_cell->vertex(v);
+              }
+            if (!solid_tree.intersects(
+                  Utils::AABBTree<dim>::bounding_box(vertices)))
+              continue;
+          }
+        interface_cells.push_back(f_cell);
+      }
+    profiler.add("Interface cells", interface_cells.size());
+  }
+
+  template <int dim>
+  void FSI<dim>::gather_relevant_solid_state()
+  {
+    // The fluid cells near the solid are the ones find_fluid_bc loops over.
+    Point<dim> lower, upper;
+    bool empty = true;
+    for (const auto &f_cell :
+         use_dirichlet_bc ? interface_cells : artificial_cells)
+      {
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            const Point<dim> &vertex = f_cell->vertex(v);
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                lower[d] = empty ? vertex[d] : std::min(lower[d], vertex[d]);
+                upper[d] = empty ? vertex[d] : std::max(upper[d], vertex[d]);
+              }
+            empty = false;
+          }
+      }
+    for (unsigned int d = 0; d < dim && !empty; ++d)
+      {
+        lower[d] = std::max(lower[d], solid_box(2 * d));
+        upper[d] = std::min(upper[d], solid_box(2 * d + 1));
+        empty = lower[d] > upper[d];
+      }
+
+    const types::global_dof_index n_dofs = solid_solver.dof_handler.n_dofs();
+    IndexSet needed_dofs(n_dofs);
+    if (!empty)
+      {
+        // The support points on the faces of the box must not be missed.
+        const double tolerance = 1e-6 * lower.distance(upper) + 1e-12;
+        std::vector<types::global_dof_index> dof_indices(
+          solid_solver.fe.dofs_per_cell);
+        std::vector<types::global_dof_index> needed;
+        std::vector<Point<dim>> vertices(GeometryInfo<dim>::vertices_per_cell);
+        for (auto s_cell = solid_solver.dof_handler.begin_active();
+             s_cell != solid_solver.dof_handler.end();
+             ++s_cell)
+          {
+            for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+                 ++v)
+              {
+                vertices[v] = solid_vertices()[s_cell->vertex_index(v)];
+              }
+            const auto cell_box = Utils::AABBTree<dim>::bounding_box(vertices);
+            bool overlaps = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                if (cell_box.first[d] > upper[d] + tolerance ||
+                    cell_box.second[d] < lower[d] - tolerance)
+                  {
+                    overlaps = false;
+                  }
+              }
+            if (overlaps)
+              {
+                s_cell->get_dof_indices(dof_indices);
+                needed.insert(
+                  needed.end(), dof_indices.begin(), dof_indices.end());
+              }
+          }
+        std::sort(needed.begin(), needed.end());
+        needed.erase(std::unique(needed.begin(), needed.end()), needed.end());
+        needed_dofs.add_indices(needed.begin(), needed.end());
+      }
+    needed_dofs.subtract_set(solid_solver.locally_owned_dofs);
+    needed_dofs.compress();
+
+    const bool changed = relevant_solid_velocity.size() != n_dofs ||
+                         needed_dofs != relevant_solid_dofs;
+    if (Utilities::MPI::max(static_cast<int>(changed),
+                            solid_solver.mpi_communicator) != 0)
+      {
+        relevant_solid_dofs = needed_dofs;
+        relevant_solid_velocity.reinit(solid_solver.locally_owned_dofs,
+                                       relevant_solid_dofs,
+                                       solid_solver.mpi_communicator);
+        relevant_solid_acceleration.reinit(solid_solver.locally_owned_dofs,
+                                           relevant_solid_dofs,
+                                           solid_solver.mpi_communicator);
+      }
+    // The copies update the ghosts.
+    relevant_solid_velocity = solid_solver.current_velocity;
+    relevant_solid_acceleration = solid_solver.current_acceleration;
+    profiler.add("Gathered solid dofs", relevant_solid_dofs.n_elements());
   }
 
   template <int dim>
   void FSI<dim>::move_solid_mesh(bool move_forward)
   {
     TimerOutput::Scope timer_section(timer, "Move solid mesh");
+    Utils::CouplingProfiler::Scope profiler_section(profiler,
+                                                    "Move solid mesh");
+    // The Eulerian mapping leaves the mesh alone, and has nothing to undo.
+    if (parameters.eulerian_solid_mapping)
+      {
+        if (move_forward)
+          {
+            update_deformed_solid();
+          }
+        return;
+      }
     // All gather the information so each process has the entire solution.
-    Vector<double> localized_displacement(solid_solver.current_displacement);
+    std::vector<Vector<double>> localized;
+    const ArrayView<const double> localized_displacement =
+      localize_solid_state(localized, 1)[0];
     // Exactly the same as the serial version, since we must update the
     // entire graph on every process.
     std::vector<bool> vertex_touched(solid_solver.triangulation.n_vertices(),
@@ -54,7 +335,7 @@ namespace MPI
                 for (unsigned int d = 0; d < dim; ++d)
                   {
                     vertex_displacement[d] =
-                      localized_displacement(cell->vertex_dof_index(v, d));
+                      localized_displacement[cell->vertex_dof_index(v, d)];
                   }
                 if (move_forward)
                   {
@@ -69,39 +350,232 @@ namespace MPI
       }
   }
 
+  template <int dim>
+  void FSI<dim>::update_deformed_solid()
+  {
+    Vec displacement = solid_solver.current_displacement;
+    PetscObjectState state;
+    PetscErrorCode ierr =
+      PetscObjectStateGet(reinterpret_cast<PetscObject>(displacement), &state);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    const bool changed = !solid_mapping || displacement != deformed_from ||
+                         state != deformed_state;
+    // The localization is collective.
+    if (Utilities::MPI::max(static_cast<int>(changed),
+                            solid_solver.mpi_communicator) == 0)
+      {
+        return;
+      }
+    deformed_displacement = solid_solver.current_displacement;
+    deformed_from = displacement;
+    deformed_state = state;
+    if (!solid_mapping)
+      {
+        // The mapping reads the displacement whenever it is used.
+        solid_mapping.reset(new MappingQEulerian<dim, Vector<double>>(
+          parameters.solid_degree,
+          solid_solver.dof_handler,
+          deformed_displacement));
+        solid_locator.set_mapping(*solid_mapping);
+      }
+    deformed_solid_vertices = solid_solver.triangulation.get_vertices();
+    std::vector<bool> vertex_touched(solid_solver.triangulation.n_vertices(),
+                                     false);
+    for (auto cell = solid_solver.dof_handler.begin_active();
+         cell != solid_solver.dof_handler.end();
+         ++cell)
+      {
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            if (vertex_touched[cell->vertex_index(v)])
+              continue;
+            vertex_touched[cell->vertex_index(v)] = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                deformed_solid_vertices[cell->vertex_index(v)][d] +=
+                  deformed_displacement(cell->vertex_dof_index(v, d));
+              }
+          }
+      }
+  }
+
+  template <int dim>
+  const std::vector<Point<dim>> &FSI<dim>::solid_vertices() const
+  {
+    return solid_mapping ? deformed_solid_vertices
+                         : solid_solver.triangulation.get_vertices();
+  }
+
   template <int dim>
   void FSI<dim>::collect_solid_boundaries()
   {
+    solid_boundaries.clear();
+    for (auto cell = solid_solver.triangulation.begin_active();
+         cell != solid_solver.triangulation.end();
+         ++cell)
+      {
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+          {
+            if (cell->face(f)->at_boundary())
+              {
+                solid_boundaries.push_back(cell->face(f));
+              }
+          }
+      }
+    // Collect the vertices on the solid boundary, each of which only appears
+    // once even if it is shared by multiple faces.
+    solid_boundary_vertices.clear();
+    solid_boundary_lines.clear();
+    std::vector<bool> vertex_touched(solid_solver.triangulation.n_vertices(),
+                                     false);
+    for (auto s_cell = solid_solver.dof_handler.begin_active();
+         s_cell != solid_solver.dof_handler.end();
+         ++s_cell)
+      {
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+          {
+            if (!s_cell->face(f)->at_boundary())
+              continue;
+            for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_face;
+                 ++v)
+              {
+                if (vertex_touched[s_cell->face(f)->vertex_index(v)])
+                  continue;
+                vertex_touched[s_cell->face(f)->vertex_index(v)] = true;
+                solid_boundary_vertices.push_back(
+                  s_cell->face(f)->vertex_index(v));
+                std::array<types::global_dof_index, dim> lines;
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    lines[d] = s_cell->face(f)->vertex_dof_index(v, d);
+                  }
+                solid_boundary_lines.push_back(lines);
+              }
+          }
+      }
+    collect_solid_bodies();
     if (dim == 2)
-      for (auto cell = solid_solver.triangulation.begin_active();
-           cell != solid_solver.triangulation.end();
-           ++cell)
+      solid_tree.build(update_solid_boundary_coords());
+    else
+      solid_surface.reinit(solid_solver.triangulation);
+  }
+
+  template <int dim>
+  void FSI<dim>::collect_solid_bodies()
+  {
+    // Union-find of the vertices over the cells.
+    const unsigned int n_vertices = solid_solver.triangulation.n_vertices();
+    std::vector<unsigned int> parent(n_vertices);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](unsigned int v) {
+      while (parent[v] != v)
         {
-          for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
-            {
-              if (cell->face(f)->at_boundary())
-                {
-                  solid_boundaries.push_back(cell->face(f));
-                }
-            }
+          parent[v] = parent[parent[v]];
+          v = parent[v];
         }
+      return v;
+    };
+    for (auto cell = solid_solver.triangulation.begin_active();
+         cell != solid_solver.triangulation.end();
+         ++cell)
+      {
+        const unsigned int root = find(cell->vertex_index(0));
+        for (unsigned int v = 1; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            parent[find(cell->vertex_index(v))] = root;
+          }
+      }
+    // Number the bodies in the order of their first vertices.
+    const std::vector<bool> &used =
+      solid_solver.triangulation.get_used_vertices();
+    std::vector<unsigned int> body_of_root(n_vertices,
+                                           numbers::invalid_unsigned_int);
+    solid_vertex_bodies.assign(n_vertices, numbers::invalid_unsigned_int);
+    unsigned int n_bodies = 0;
+    for (unsigned int v = 0; v < n_vertices; ++v)
+      {
+        if (!used[v])
+          continue;
+        const unsigned int root = find(v);
+        if (body_of_root[root] == numbers::invalid_unsigned_int)
+          {
+            body_of_root[root] = n_bodies++;
+          }
+        solid_vertex_bodies[v] = body_of_root[root];
+      }
+    solid_body_boxes.resize(n_bodies);
+    solid_boundary_bodies.resize(solid_boundaries.size());
+    for (unsigned int i = 0; i < solid_boundaries.size(); ++i)
+      {
+        solid_boundary_bodies[i] =
+          solid_vertex_bodies[solid_boundaries[i]->vertex_index(0)];
+      }
+  }
+
+  template <int dim>
+  bool FSI<dim>::in_solid_body_box(
+    const typename Utils::AABBTree<dim>::Box &box) const
+  {
+    for (const auto &body_box : solid_body_boxes)
+      {
+        if (Utils::AABBTree<dim>::contains(body_box, box.first) &&
+            Utils::AABBTree<dim>::contains(body_box, box.second))
+          return true;
+      }
+    return false;
+  }
+
+  template <int dim>
+  bool FSI<dim>::near_solid_body(
+    const typename Utils::AABBTree<dim>::Box &box) const
+  {
+    for (const auto &body_box : solid_body_boxes)
+      {
+        if (Utils::AABBTree<dim>::overlap(body_box, box))
+          return true;
+      }
+    return false;
+  }
+
+  template <int dim>
+  std::vector<typename Utils::AABBTree<dim>::Box>
+  FSI<dim>::update_solid_boundary_coords()
+  {
+    const unsigned int n = solid_boundaries.size();
+    solid_boundary_coords.x1.resize(n);
+    solid_boundary_coords.y1.resize(n);
+    solid_boundary_coords.x2.resize(n);
+    solid_boundary_coords.y2.resize(n);
+    std::vector<typename Utils::AABBTree<dim>::Box> boxes(n);
+    for (unsigned int i = 0; i < n; ++i)
+      {
+        const Point<dim> &p1 =
+          solid_vertices()[solid_boundaries[i]->vertex_index(0)];
+        const Point<dim> &p2 =
+          solid_vertices()[solid_boundaries[i]->vertex_index(1)];
+        solid_boundary_coords.x1[i] = p1(0);
+        solid_boundary_coords.y1[i] = p1(1);
+        solid_boundary_coords.x2[i] = p2(0);
+        solid_boundary_coords.y2[i] = p2(1);
+        boxes[i] = Utils::AABBTree<dim>::bounding_box({p1, p2});
+      }
+    return boxes;
   }
 
   template <int dim>
   void FSI<dim>::update_solid_box()
   {
+    Utils::CouplingProfiler::Scope profiler_section(profiler,
+                                                    "Update solid box");
     move_solid_mesh(true);
+    const std::vector<Point<dim>> &vertices = solid_vertices();
     solid_box = 0;
     for (unsigned int i = 0; i < dim; ++i)
       {
-        solid_box(2 * i) =
-          solid_solver.triangulation.get_vertices().begin()->operator()(i);
-        solid_box(2 * i + 1) =
-          solid_solver.triangulation.get_vertices().begin()->operator()(i);
+        solid_box(2 * i) = vertices.begin()->operator()(i);
+        solid_box(2 * i + 1) = vertices.begin()->operator()(i);
       }
-    for (auto v = solid_solver.triangulation.get_vertices().begin();
-         v != solid_solver.triangulation.get_vertices().end();
-         ++v)
+    for (auto v = vertices.begin(); v != vertices.end(); ++v)
       {
         for (unsigned int i = 0; i < dim; ++i)
           {
@@ -111,6 +585,51 @@ namespace MPI
               solid_box(2 * i + 1) = (*v)(i);
           }
       }
+    std::vector<bool> box_started(solid_body_boxes.size(), false);
+    for (unsigned int v = 0; v < vertices.size(); ++v)
+      {
+        const unsigned int body = solid_vertex_bodies[v];
+        if (body == numbers::invalid_unsigned_int)
+          continue;
+        auto &box = solid_body_boxes[body];
+        if (!box_started[body])
+          {
+            box = {vertices[v], vertices[v]};
+            box_started[body] = true;
+          }
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            box.first[d] = std::min(box.first[d], vertices[v][d]);
+            box.second[d] = std::max(box.second[d], vertices[v][d]);
+          }
+      }
+    // The solid has moved, refit the trees to the current configuration.
+    if (dim == 2)
+      {
+        solid_boundary_boxes = update_solid_boundary_coords();
+      }
+    else
+      {
+        solid_surface.update(vertices);
+        solid_boundary_boxes.resize(solid_boundaries.size());
+        std::vector<Point<dim>> face_vertices(
+          GeometryInfo<dim>::vertices_per_face);
+        for (unsigned int i = 0; i < solid_boundaries.size(); ++i)
+          {
+            for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_face;
+                 ++v)
+              {
+                face_vertices[v] =
+                  vertices[solid_boundaries[i]->vertex_index(v)];
+              }
+            solid_boundary_boxes[i] =
+              Utils::AABBTree<dim>::bounding_box(face_vertices);
+          }
+      }
+    if (solid_tree.empty())
+      solid_tree.build(solid_boundary_boxes);
+    else
+      solid_tree.refit(solid_boundary_boxes);
     move_solid_mesh(false);
   }
 
@@ -145,73 +664,95 @@ namespace MPI
         if (point(i) < solid_box(2 * i) || point(i) > solid_box(2 * i + 1))
           return false;
       }
+    const bool several_bodies = solid_body_boxes.size() > 1;
+    if (several_bodies && !in_solid_body_box({point, point}))
+      return false;
 
     // Compute its angle to each boundary face
     if (dim == 2)
       {
         unsigned int cross_number = 0;
         unsigned int half_cross_number = 0;
-        for (auto f = solid_boundaries.begin(); f != solid_boundaries.end();
-             ++f)
-          {
-            Point<dim> p1 = (*f)->vertex(0), p2 = (*f)->vertex(1);
-            double y_diff1 = p1(1) - point(1);
-            double y_diff2 = p2(1) - point(1);
-            double x_diff1 = p1(0) - point(0);
-            double x_diff2 = p2(0) - point(0);
-            Tensor<1, dim> r1 = p1 - p2;
-            Tensor<1, dim> r2;
-            // r1[1] == 0 if the boundary is horizontal
-            if (r1[1] != 0.0)
-              r2 = r1 * (point(1) - p2(1)) / r1[1];
-            if (y_diff1 * y_diff2 < 0)
-              {
-                // Point is on the left of the boundary
-                if (r2[0] + p2(0) > point(0))
-                  {
-                    ++cross_number;
-                  }
-                // Point is on the boundary
-                else if (r2[0] + p2(0) == point(0))
-                  {
-                    return true;
-                  }
-              }
-            // Point is on the same horizontal line with one of the vertices
-            else if (y_diff1 * y_diff2 == 0)
-              {
-                // The boundary is horizontal
-                if (y_diff1 == 0 && y_diff2 == 0)
-                  // The point is on it
-                  if (x_diff1 * x_diff2 < 0)
-                    {
-                      return true;
-                    }
-                  // The point is not on it
-                  else
-                    continue;
-                // On the left of the boundary
-                else if (r2[0] + p2(0) > point(0))
-                  { // The point must not be on the top or bottom of the box
-                    // (because it can be tangential)
-                    if (point(1) != solid_box(2) && point(1) != solid_box(3))
-                      ++half_cross_number;
-                  }
-                // Point overlaps with the vertex
-                else if (point == p1 || point == p2)
-                  {
-                    return true;
-                  }
-              }
+        // Only the faces whose boxes intersect the ray casted from the point
+        // in +x direction can be crossed or contain the point.
+        solid_tree.ray_query(point, 0, solid_candidates);
+        for (auto i : solid_candidates)
+          {
+            // The point can only be inside the bodies whose boxes contain
+            // it, and the others are crossed an even number of times.
+            if (several_bodies &&
+                !Utils::AABBTree<dim>::contains(
+                  solid_body_boxes[solid_boundary_bodies[i]], point))
+              continue;
+            if (cross_solid_boundary(
+                  i, point, cross_number, half_cross_number))
+              return true;
           }
         cross_number += half_cross_number / 2;
         if (cross_number % 2 == 0)
           return false;
         return true;
       }
-    for (auto cell = df.begin_active(); cell != df.end(); ++cell)
+    (void)df;
+    // In 3D, cast rays against the boundary surface.
+    return solid_surface.point_inside(point);
+  }
+
+  template <int dim>
+  bool FSI<dim>::cross_solid_boundary(const unsigned int i,
+                                      const Point<dim> &point,
+                                      unsigned int &cross_number,
+                                      unsigned int &half_cross_number) const
+  {
+    const double x1 = solid_boundary_coords.x1[i];
+    const double y1 = solid_boundary_coords.y1[i];
+    const double x2 = solid_boundary_coords.x2[i];
+    const double y2 = solid_boundary_coords.y2[i];
+    double y_diff1 = y1 - point(1);
+    double y_diff2 = y2 - point(1);
+    double x_diff1 = x1 - point(0);
+    double x_diff2 = x2 - point(0);
+    // The x coordinate of the intersection with the horizontal line through
+    // the point, (y1 - y2) == 0 if the boundary is horizontal
+    double x_cross = x2;
+    if (y1 - y2 != 0.0)
+      x_cross += (x1 - x2) * (point(1) - y2) / (y1 - y2);
+    if (y_diff1 * y_diff2 < 0)
+      {
+        // Point is on the left of the boundary
+        if (x_cross > point(0))
+          {
+            ++cross_number;
+          }
+        // Point is on the boundary
+        else if (x_cross == point(0))
+          {
+            return true;
+          }
+      }
+    // Point is on the same horizontal line with one of the vertices
+    else if (y_diff1 * y_diff2 == 0)
       {
-        if (cell->point_inside(point))
+        // The boundary is horizontal
+        if (y_diff1 == 0 && y_diff2 == 0)
+          {
+            // The point is on it
+            if (x_diff1 * x_diff2 < 0)
+              {
+                return true;
+              }
+          }
+        // On the left of the boundary
+        else if (x_cross > point(0))
+          { // The point must not be on the top or bottom of the box
+            // (because it can be tangential)
+            const auto &body_box = solid_body_boxes[solid_boundary_bodies[i]];
+            if (point(1) != body_box.first[1] && point(1) != body_box.second[1])
+              ++half_cross_number;
+          }
+        // Point overlaps with the vertex
+        else if ((x_diff1 == 0 && y_diff1 == 0) ||
+                 (x_diff2 == 0 && y_diff2 == 0))
           {
             return true;
           }
@@ -219,6 +760,87 @@ namespace MPI
     return false;
   }
 
+  template <int dim>
+  void FSI<dim>::points_in_solid(const ArrayView<const Point<dim>> &points,
+                                 std::vector<bool> &inside)
+  {
+    profiler.add("Points tested", points.size());
+    inside.assign(points.size(), false);
+    if (points.size() == 0)
+      return;
+    // Check whether the points are in the solid box first, and compute the
+    // bounding box of the remaining ones.
+    const bool several_bodies = solid_body_boxes.size() > 1;
+    std::vector<unsigned int> candidates;
+    candidates.reserve(points.size());
+    typename Utils::AABBTree<dim>::Box box;
+    for (unsigned int k = 0; k < points.size(); ++k)
+      {
+        bool in_box = true;
+        for (unsigned int i = 0; i < dim; ++i)
+          {
+            if (points[k](i) < solid_box(2 * i) ||
+                points[k](i) > solid_box(2 * i + 1))
+              {
+                in_box = false;
+                break;
+              }
+          }
+        if (!in_box)
+          continue;
+        if (several_bodies && !in_solid_body_box({points[k], points[k]}))
+          continue;
+        if (candidates.empty())
+          box = {points[k], points[k]};
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            box.first[d] = std::min(box.first[d], points[k][d]);
+            box.second[d] = std::max(box.second[d], points[k][d]);
+          }
+        candidates.push_back(k);
+      }
+    if (candidates.empty())
+      return;
+
+    if (dim == 3)
+      {
+        for (auto k : candidates)
+          {
+            inside[k] = solid_surface.point_inside(points[k]);
+          }
+        return;
+      }
+
+    // One tree query for all the points, then loop over the boundary lines
+    // and test every point against each of them.
+    solid_tree.ray_query(box, 0, solid_candidates);
+    std::vector<unsigned int> cross_number(candidates.size(), 0);
+    std::vector<unsigned int> half_cross_number(candidates.size(), 0);
+    std::vector<bool> on_boundary(candidates.size(), false);
+    for (auto i : solid_candidates)
+      {
+        const auto &body_box = solid_body_boxes[solid_boundary_bodies[i]];
+        for (unsigned int k = 0; k < candidates.size(); ++k)
+          {
+            if (several_bodies &&
+                !Utils::AABBTree<dim>::contains(body_box,
+                                                points[candidates[k]]))
+              continue;
+            if (!on_boundary[k] && cross_solid_boundary(i,
+                                                        points[candidates[k]],
+                                                        cross_number[k],
+                                                        half_cross_number[k]))
+              on_boundary[k] = true;
+          }
+      }
+    for (unsigned int k = 0; k < candidates.size(); ++k)
+      {
+        inside[candidates[k]] =
+          on_boundary[k] ||
+          (cross_number[k] + half_cross_number[k] / 2) % 2 == 1;
+      }
+  }
+
   template <int dim>
   void FSI<dim>::setup_cell_hints()
   {
@@ -236,13 +858,50 @@ namespace MPI
               hints = cell_hints.get_data(cell);
             Assert(hints.size() == n_unit_points,
                    ExcMessage("Wrong number of cell hints!"));
+            // A refined cell inherits the hint of its parent, and the begin
+            // iterator means no hint.
+            auto saved = saved_cell_hints.find({cell->level(), cell->index()});
+            if (saved == saved_cell_hints.end() && cell->level() > 0)
+              {
+                saved = saved_cell_hints.find(
+                  {cell->parent()->level(), cell->parent()->index()});
+              }
+            const auto hint = (saved == saved_cell_hints.end()
+                                 ? solid_solver.dof_handler.begin_active()
+                                 : saved->second);
             for (unsigned int v = 0; v < n_unit_points; ++v)
               {
-                // Initialize the hints with the begin iterators!
-                *(hints[v]) = solid_solver.dof_handler.begin_active();
+                *(hints[v]) = hint;
               }
           }
       }
+    saved_cell_hints.clear();
+  }
+
+  template <int dim>
+  void FSI<dim>::save_cell_hints()
+  {
+    saved_cell_hints.clear();
+    const auto no_hint = solid_solver.dof_handler.begin_active();
+    for (auto cell = fluid_solver.triangulation.begin_active();
+         cell != fluid_solver.triangulation.end();
+         ++cell)
+      {
+        if (cell->is_artificial())
+          continue;
+        const auto hints = cell_hints.get_data(cell);
+        auto hint = std::find_if(
+          hints.begin(), hints.end(), [&no_hint](const auto &h) {
+            return *h != no_hint;
+          });
+        if (hint == hints.end())
+          continue;
+        // A cell to be coarsened passes its hint to the parent, the first
+        // child wins. The refined cells find the hints of their parents.
+        const typename Triangulation<dim>::cell_iterator owner =
+          (cell->coarsen_flag_set() ? cell->parent() : cell);
+        saved_cell_hints.insert({{owner->level(), owner->index()}, **hint});
+      }
   }
 
   template <int dim>
@@ -251,6 +910,10 @@ namespace MPI
     move_solid_mesh(true);
     Vector<double> localized_solid_displacement(
       solid_solver.current_displacement);
+    // Collect the unconstrained solid vertices
+    std::vector<Point<dim>> points;
+    std::vector<unsigned int> vertex_indices;
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
     std::vector<bool> vertex_touched(solid_solver.dof_handler.n_dofs(), false);
     for (auto cell : solid_solver.dof_handler.active_cell_iterators())
       {
@@ -260,22 +923,30 @@ namespace MPI
                 !solid_solver.constraints.is_constrained(cell->vertex_index(v)))
               {
                 vertex_touched[cell->vertex_index(v)] = true;
-                Point<dim> point = cell->vertex(v);
-                Vector<double> tmp(dim + 1);
-                VectorTools::point_value(fluid_solver.dof_handler,
-                                         fluid_solver.present_solution,
-                                         point,
-                                         tmp);
-                for (unsigned int d = 0; d < dim; ++d)
-                  {
-                    localized_solid_displacement[cell->vertex_dof_index(
-                      v, d)] += tmp[d] * time.get_delta_t();
-                  }
+                points.push_back(solid_vertices()[cell->vertex_index(v)]);
+                cells.push_back(cell);
+                vertex_indices.push_back(v);
               }
           }
       }
-    move_solid_mesh(false);
-    solid_solver.current_displacement = localized_solid_displacement;
+    // Interpolate the fluid velocity at all the points at once, the values
+    // are nonzero only on the owner processes.
+    fluid_evaluator.reinit(points, mpi_communicator);
+    std::vector<Vector<double>> values;
+    fluid_evaluator.evaluate(fluid_solver.present_solution, values);
+    Vector<double> velocity(solid_solver.dof_handler.n_dofs());
+    for (unsigned int i = 0; i < points.size(); ++i)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            velocity[cells[i]->vertex_dof_index(vertex_indices[i], d)] =
+              values[i][d];
+          }
+      }
+    Utilities::MPI::sum(velocity, mpi_communicator, velocity);
+    localized_solid_displacement.add(time.get_delta_t(), velocity);
+    move_solid_mesh(false);
+    solid_solver.current_displacement = localized_solid_displacement;
   }
 
   // Dirichlet bcs are applied to artificial fluid cells, so fluid nodes
@@ -288,7 +959,40 @@ namespace MPI
   void FSI<dim>::update_indicator()
   {
     TimerOutput::Scope timer_section(timer, "Update indicator");
+    Utils::CounterRegion counter_region("Update indicator");
+    Utils::CouplingProfiler::Scope profiler_section(profiler,
+                                                    "Update indicator");
+    // A vertex can only enter or leave the solid if the solid boundary has
+    // swept over it since the last update. Each boundary face moves within
+    // the union of its old and new boxes, so only the cells that overlap
+    // these bands are re-tested, the others keep their indicators.
+    const bool incremental =
+      parameters.incremental_indicator && !full_indicator_update &&
+      indicator_boxes.size() == solid_boundary_boxes.size();
+    if (incremental)
+      {
+        std::vector<typename Utils::AABBTree<dim>::Box> band(
+          solid_boundary_boxes.size());
+        for (unsigned int i = 0; i < band.size(); ++i)
+          {
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                band[i].first[d] = std::min(indicator_boxes[i].first[d],
+                                            solid_boundary_boxes[i].first[d]);
+                band[i].second[d] =
+                  std::max(indicator_boxes[i].second[d],
+                           solid_boundary_boxes[i].second[d]);
+              }
+          }
+        if (solid_band.empty())
+          solid_band.build(band);
+        else
+          solid_band.refit(band);
+      }
     move_solid_mesh(true);
+    std::vector<Point<dim>> vertices(GeometryInfo<dim>::vertices_per_cell);
+    std::vector<bool> inside;
+    unsigned int n_tested_cells = 0;
     for (auto f_cell = fluid_solver.dof_handler.begin_active();
          f_cell != fluid_solver.dof_handler.end();
          ++f_cell)
@@ -297,20 +1001,45 @@ namespace MPI
           {
             continue;
           }
-        auto p = fluid_solver.cell_property.get_data(f_cell);
-        int inside_count = 0;
+        int &indicator =
+          fluid_solver.cell_property.indicator[f_cell->active_cell_index()];
         for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
           {
-            if (!point_in_solid(solid_solver.dof_handler, f_cell->vertex(v)))
-              {
-                break;
-              }
-            ++inside_count;
+            vertices[v] = f_cell->vertex(v);
+          }
+        // Cells that are not entirely in the solid box, or in the box of one
+        // of the solid bodies, are trivially out.
+        const auto cell_box = Utils::AABBTree<dim>::bounding_box(vertices);
+        bool outside_box = false;
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            if (cell_box.first[d] < solid_box(2 * d) ||
+                cell_box.second[d] > solid_box(2 * d + 1))
+              outside_box = true;
+          }
+        if (!outside_box && solid_body_boxes.size() > 1)
+          {
+            outside_box = !in_solid_body_box(cell_box);
+          }
+        if (outside_box)
+          {
+            indicator = 0;
+            continue;
+          }
+        if (incremental && !solid_band.intersects(cell_box))
+          {
+            continue;
           }
-        p[0]->indicator =
-          (inside_count == GeometryInfo<dim>::vertices_per_cell ? 1 : 0);
+        ++n_tested_cells;
+        points_in_solid(make_array_view(vertices), inside);
+        indicator =
+          (std::find(inside.begin(), inside.end(), false) == inside.end() ? 1
+                                                                          : 0);
       }
     move_solid_mesh(false);
+    profiler.add("Cells tested", n_tested_cells);
+    indicator_boxes = solid_boundary_boxes;
+    full_indicator_update = false;
   }
 
   // This function interpolates the solid velocity into the fluid solver,
@@ -319,7 +1048,10 @@ namespace MPI
   void FSI<dim>::find_fluid_bc()
   {
     TimerOutput::Scope timer_section(timer, "Find fluid BC");
+    Utils::CounterRegion counter_region("Find fluid BC");
+    Utils::CouplingProfiler::Scope profiler_section(profiler, "Find fluid BC");
     move_solid_mesh(true);
+    update_coupling_cells();
 
     // The nonzero Dirichlet BCs (to set the velocity) and zero Dirichlet
     // BCs (to set the velocity increment) for the artificial fluid domain.
@@ -332,26 +1064,39 @@ namespace MPI
     tmp_fsi_acceleration.reinit(fluid_solver.owned_partitioning,
                                 fluid_solver.mpi_communicator);
 
-    Vector<double> localized_solid_velocity(solid_solver.current_velocity);
-    Vector<double> localized_solid_acceleration(
-      solid_solver.current_acceleration);
-    std::vector<std::vector<Vector<double>>> localized_stress(
-      dim, std::vector<Vector<double>>(dim));
-    for (unsigned int i = 0; i < dim; ++i)
+    // Either the node shared copies of the entire solid state, or only the
+    // entries that the fluid cells of this process can interpolate from.
+    using SolidInterpolator =
+      Utils::GridInterpolator<dim, PETScWrappers::MPI::Vector>;
+    std::vector<Vector<double>> localized;
+    std::vector<ArrayView<const double>> localized_state;
+    if (shared_solid_state)
       {
-        for (unsigned int j = 0; j < dim; ++j)
-          {
-            localized_stress[i][j] = solid_solver.stress[i][j];
-          }
+        localized_state = localize_solid_state(localized, 3);
+      }
+    else
+      {
+        gather_relevant_solid_state();
       }
+    auto solid_velocity = [&](SolidInterpolator &interpolator,
+                              Vector<double> &value) {
+      if (shared_solid_state)
+        interpolator.point_value(localized_state[1], value);
+      else
+        interpolator.point_value(relevant_solid_velocity, value);
+    };
+    auto solid_acceleration = [&](SolidInterpolator &interpolator,
+                                  Vector<double> &value) {
+      if (shared_solid_state)
+        interpolator.point_value(localized_state[2], value);
+      else
+        interpolator.point_value(relevant_solid_acceleration, value);
+    };
 
     const std::vector<Point<dim>> &unit_points =
       fluid_solver.fe.get_unit_support_points();
 
     const FEValuesExtractors::Vector velocities(0);
-    const FEValuesExtractors::Scalar pressure(dim);
-    std::vector<SymmetricTensor<2, dim>> sym_grad_v(unit_points.size());
-    std::vector<double> p(unit_points.size());
     std::vector<Tensor<2, dim>> grad_v(unit_points.size());
     std::vector<Tensor<1, dim>> v(unit_points.size());
 
@@ -364,172 +1109,151 @@ namespace MPI
                                     update_gradients);
     std::vector<types::global_dof_index> dof_indices(
       fluid_solver.fe.dofs_per_cell);
-    std::vector<unsigned int> dof_touched(fluid_solver.dof_handler.n_dofs(), 0);
+    // The dofs that have been set, only the ones on the interface cells.
+    std::unordered_set<types::global_dof_index> dof_touched;
+    dof_touched.reserve(interface_cells.size() * fluid_solver.fe.dofs_per_cell);
+    // Buffers for the batched inside test of the support points of a cell
+    std::vector<unsigned int> query_indices;
+    std::vector<Point<dim>> query_points;
+    std::vector<bool> query_inside;
 
-    for (auto f_cell = fluid_solver.dof_handler.begin_active();
-         f_cell != fluid_solver.dof_handler.end();
-         ++f_cell)
+    // A velocity support point in the solid, with the fluid velocity and its
+    // gradient there if the FSI acceleration is computed.
+    struct SolidQuery
+    {
+      std::shared_ptr<typename DoFHandler<dim>::active_cell_iterator> hint;
+      types::global_dof_index line;
+      unsigned int component;
+      Tensor<1, dim> v;
+      Tensor<2, dim> grad_v;
+    };
+    std::vector<SolidQuery> queries;
+    std::vector<Point<dim>> solid_points;
+
+    // The ghost cells are in interface_cells because they must be taken care
+    // of to set correct Dirichlet BCs!
+    for (const auto &f_cell :
+         use_dirichlet_bc ? interface_cells : artificial_cells)
       {
-        // Use is_artificial() instead of !is_locally_owned() because ghost
-        // elements must be taken care of to set correct Dirichlet BCs!
-        if (f_cell->is_artificial())
+        auto hints = cell_hints.get_data(f_cell);
+        dummy_fe_values.reinit(f_cell);
+        f_cell->get_dof_indices(dof_indices);
+        const auto &support_points = dummy_fe_values.get_quadrature_points();
+        if (!use_dirichlet_bc)
           {
-            continue;
-          }
-        // Now skip the ghost elements because it's not store in cell property.
-        if (!use_dirichlet_bc && f_cell->is_locally_owned())
-          {
-            auto ptr = fluid_solver.cell_property.get_data(f_cell);
-            if (ptr[0]->indicator == 0)
-              continue;
-
-            auto hints = cell_hints.get_data(f_cell);
-            dummy_fe_values.reinit(f_cell);
-            f_cell->get_dof_indices(dof_indices);
-            auto support_points = dummy_fe_values.get_quadrature_points();
-            // Fluid velocity at support points
+            // Fluid velocity and its gradient at support points
             dummy_fe_values[velocities].get_function_values(
               fluid_solver.present_solution, v);
-            // Fluid velocity gradient at support points
             dummy_fe_values[velocities].get_function_gradients(
               fluid_solver.present_solution, grad_v);
-            // Fluid symmetric velocity gradient at support points
-            dummy_fe_values[velocities].get_function_symmetric_gradients(
-              fluid_solver.present_solution, sym_grad_v);
-            // Fluid pressure at support points
-            dummy_fe_values[pressure].get_function_values(
-              fluid_solver.present_solution, p);
-            // Loop over the support points to calculate fsi acceleration.
-            for (unsigned int i = 0; i < unit_points.size(); ++i)
-              {
-                // Skip the already-set dofs.
-                if (dof_touched[dof_indices[i]] != 0)
-                  continue;
-                auto base_index = fluid_solver.fe.system_to_base_index(i);
-                const unsigned int i_group = base_index.first.first;
-                Assert(i_group < 2,
-                       ExcMessage(
-                         "There should be only 2 groups of finite element!"));
-                if (i_group == 1)
-                  continue; // skip the pressure dofs
-                bool inside = true;
-                for (unsigned int d = 0; d < dim; ++d)
-                  if (std::abs(unit_points[i][d]) < 1e-5)
-                    {
-                      inside = false;
-                      break;
-                    }
-                if (inside)
-                  continue; // skip the in-cell support point
-                // Same as fluid_solver.fe.system_to_base_index(i).first.second;
-                const unsigned int index =
-                  fluid_solver.fe.system_to_component_index(i).first;
-                Assert(index < dim,
-                       ExcMessage("Vector component should be less than dim!"));
-                dof_touched[dof_indices[i]] = 1;
-                if (!point_in_solid(solid_solver.dof_handler,
-                                    support_points[i]))
-                  continue;
-                Utils::CellLocator<dim, DoFHandler<dim>> locator(
-                  solid_solver.dof_handler, support_points[i], *(hints[i]));
-                *(hints[i]) = locator.search();
-                Utils::GridInterpolator<dim, Vector<double>> interpolator(
-                  solid_solver.dof_handler, support_points[i], {}, *(hints[i]));
-                if (!interpolator.found_cell())
-                  {
-                    std::stringstream message;
-                    message
-                      << "Cannot find point in solid: " << support_points[i]
-                      << std::endl;
-                    AssertThrow(interpolator.found_cell(),
-                                ExcMessage(message.str()));
-                  }
-                // Solid acceleration at fluid unit point
-                Vector<double> solid_acc(dim);
-                Vector<double> solid_vel(dim);
-                interpolator.point_value(localized_solid_acceleration,
-                                         solid_acc);
-                interpolator.point_value(localized_solid_velocity, solid_vel);
-                Tensor<1, dim> vs;
-                for (int j = 0; j < dim; ++j)
-                  {
-                    vs[j] = solid_vel[j];
-                  }
-                // Fluid total acceleration at support points
-                Tensor<1, dim> fluid_acc =
-                  (vs - v[i]) / time.get_delta_t() + grad_v[i] * v[i];
-                auto line = dof_indices[i];
-                // Note that we are setting the value of the constraint to the
-                // velocity delta!
-                tmp_fsi_acceleration(line) =
-                  fluid_acc[index] - solid_acc[index];
+          }
+        // Collect the support points to be set first, so that they are
+        // tested against the solid in one batch.
+        query_indices.clear();
+        query_points.clear();
+        for (unsigned int i = 0; i < unit_points.size(); ++i)
+          {
+            // Skip the already-set dofs.
+            if (dof_touched.count(dof_indices[i]) != 0)
+              continue;
+            auto base_index = fluid_solver.fe.system_to_base_index(i);
+            const unsigned int i_group = base_index.first.first;
+            Assert(i_group < 2,
+                   ExcMessage(
+                     "There should be only 2 groups of finite element!"));
+            if (i_group == 1)
+              continue; // skip the pressure dofs
+            bool inside = true;
+            for (unsigned int d = 0; d < dim; ++d)
+              if (std::abs(unit_points[i][d]) < 1e-5)
+                {
+                  inside = false;
+                  break;
+                }
+            if (inside)
+              continue; // skip the in-cell support point
+            dof_touched.insert(dof_indices[i]);
+            query_indices.push_back(i);
+            query_points.push_back(support_points[i]);
+          }
+        points_in_solid(make_array_view(query_points), query_inside);
+        for (unsigned int k = 0; k < query_indices.size(); ++k)
+          {
+            if (!query_inside[k])
+              continue;
+            const unsigned int i = query_indices[k];
+            // Same as fluid_solver.fe.system_to_base_index(i).first.second;
+            const unsigned int index =
+              fluid_solver.fe.system_to_component_index(i).first;
+            Assert(index < dim,
+                   ExcMessage("Vector component should be less than dim!"));
+            queries.push_back(
+              {hints[i], dof_indices[i], index, v[i], grad_v[i]});
+            solid_points.push_back(support_points[i]);
+          }
+      }
+
+    // The points in the solid are located along a Morton curve rather than
+    // cell by cell, every search starts from the cell found for the previous
+    // point, or from the hint of the point for the first one, so that the
+    // searches are short and the solid data stays in cache.
+    typename DoFHandler<dim>::active_cell_iterator previous;
+    for (const unsigned int k : Utils::morton_order(solid_points))
+      {
+        const SolidQuery &query = queries[k];
+        const Point<dim> &point = solid_points[k];
+        *(query.hint) = solid_locator.search(
+          point,
+          previous.state() == IteratorState::valid ? previous : *(query.hint));
+        if (solid_locator.found_cell())
+          {
+            previous = *(query.hint);
+          }
+        SolidInterpolator interpolator(solid_solver.dof_handler,
+                                       point,
+                                       {},
+                                       *(query.hint),
+                                       solid_mapping.get());
+        if (!interpolator.found_cell())
+          {
+            std::stringstream message;
+            message << "Cannot find point in solid: " << point << std::endl;
+            AssertThrow(interpolator.found_cell(), ExcMessage(message.str()));
+          }
+        const unsigned int index = query.component;
+        auto line = query.line;
+        if (!use_dirichlet_bc)
+          {
+            // Solid acceleration at fluid unit point
+            Vector<double> solid_acc(dim);
+            Vector<double> solid_vel(dim);
+            solid_acceleration(interpolator, solid_acc);
+            solid_velocity(interpolator, solid_vel);
+            Tensor<1, dim> vs;
+            for (int j = 0; j < dim; ++j)
+              {
+                vs[j] = solid_vel[j];
               }
+            // Fluid total acceleration at support points
+            Tensor<1, dim> fluid_acc = (vs - query.v) / time.get_delta_t() +
+                                       query.grad_v * query.v;
+            // Note that we are setting the value of the constraint to the
+            // velocity delta!
+            tmp_fsi_acceleration(line) = fluid_acc[index] - solid_acc[index];
           }
         // Dirichlet BCs
-        if (use_dirichlet_bc)
+        else
           {
-            dummy_fe_values.reinit(f_cell);
-            f_cell->get_dof_indices(dof_indices);
-            auto support_points = dummy_fe_values.get_quadrature_points();
-            auto hints = cell_hints.get_data(f_cell);
             // Declare the fluid velocity for interpolating BC
             Vector<double> fluid_velocity(dim);
-            // Loop over the support points to set Dirichlet BCs.
-            for (unsigned int i = 0; i < unit_points.size(); ++i)
-              {
-                // Skip the already-set dofs.
-                if (dof_touched[dof_indices[i]] != 0)
-                  continue;
-                auto base_index = fluid_solver.fe.system_to_base_index(i);
-                const unsigned int i_group = base_index.first.first;
-                Assert(i_group < 2,
-                       ExcMessage(
-                         "There should be only 2 groups of finite element!"));
-                if (i_group == 1)
-                  continue; // skip the pressure dofs
-                bool inside = true;
-                for (unsigned int d = 0; d < dim; ++d)
-                  if (std::abs(unit_points[i][d]) < 1e-5)
-                    {
-                      inside = false;
-                      break;
-                    }
-                if (inside)
-                  continue; // skip the in-cell support point
-                // Same as fluid_solver.fe.system_to_base_index(i).first.second;
-                const unsigned int index =
-                  fluid_solver.fe.system_to_component_index(i).first;
-                Assert(index < dim,
-                       ExcMessage("Vector component should be less than dim!"));
-                dof_touched[dof_indices[i]] = 1;
-                if (!point_in_solid(solid_solver.dof_handler,
-                                    support_points[i]))
-                  continue;
-                Utils::CellLocator<dim, DoFHandler<dim>> locator(
-                  solid_solver.dof_handler, support_points[i], *(hints[i]));
-                *(hints[i]) = locator.search();
-                Utils::GridInterpolator<dim, Vector<double>> interpolator(
-                  solid_solver.dof_handler, support_points[i], {}, *(hints[i]));
-                if (!interpolator.found_cell())
-                  {
-                    std::stringstream message;
-                    message
-                      << "Cannot find point in solid: " << support_points[i]
-                      << std::endl;
-                    AssertThrow(interpolator.found_cell(),
-                                ExcMessage(message.str()));
-                  }
-                interpolator.point_value(localized_solid_velocity,
-                                         fluid_velocity);
-                auto line = dof_indices[i];
-                inner_nonzero.add_line(line);
-                inner_zero.add_line(line);
-                // Note that we are setting the value of the constraint to the
-                // velocity delta!
-                inner_nonzero.set_inhomogeneity(
-                  line,
-                  fluid_velocity[index] - fluid_solver.present_solution(line));
-              }
+            solid_velocity(interpolator, fluid_velocity);
+            inner_nonzero.add_line(line);
+            inner_zero.add_line(line);
+            // Note that we are setting the value of the constraint to the
+            // velocity delta!
+            inner_nonzero.set_inhomogeneity(
+              line,
+              fluid_velocity[index] - fluid_solver.present_solution(line));
           }
       }
     tmp_fsi_acceleration.compress(VectorOperation::insert);
@@ -546,129 +1270,182 @@ namespace MPI
           AffineConstraints<double>::MergeConflictBehavior::left_object_wins);
       }
     move_solid_mesh(false);
+    profiler.add("Locator searches", solid_locator.n_searches());
+    profiler.add("Locator BFS steps", solid_locator.n_bfs_steps());
+    solid_locator.reset_statistics();
   }
 
   template <int dim>
   void FSI<dim>::find_solid_bc()
   {
     TimerOutput::Scope timer_section(timer, "Find solid BC");
+    Utils::CouplingProfiler::Scope profiler_section(profiler, "Find solid BC");
     // Must use the updated solid coordinates
     move_solid_mesh(true);
-    // Fluid FEValues to do interpolation
-    FEValues<dim> fe_values(
-      fluid_solver.fe, fluid_solver.volume_quad_formula, update_values);
 
-    for (unsigned int d = 0; d < dim; ++d)
+    // The current coordinates of the solid boundary vertices
+    const unsigned int n_points = solid_boundary_vertices.size();
+    std::vector<Point<dim>> points(n_points);
+    for (unsigned int i = 0; i < n_points; ++i)
       {
-        solid_solver.fsi_stress_rows[d] = 0;
+        points[i] = solid_vertices()[solid_boundary_vertices[i]];
       }
 
-    for (auto s_cell = solid_solver.dof_handler.begin_active();
-         s_cell != solid_solver.dof_handler.end();
-         ++s_cell)
+    // Relocate the points that left their fluid cells since the last step
+    // and interpolate the fluid solution in bulk.
+    boundary_evaluator.update(points, fluid_solver.mpi_communicator);
+    std::vector<Vector<double>> values;
+    std::vector<std::vector<Tensor<1, dim>>> gradients;
+    boundary_evaluator.evaluate(
+      fluid_solver.present_solution, values, gradients);
+
+    // Only the boundary dofs are nonzero, so the stress is packed into a
+    // compact buffer of n_points * dim * dim to be reduced.
+    Vector<double> &buffer = fluid_stress_buffer;
+    buffer.reinit(n_points * dim * dim);
+    for (unsigned int i = 0; i < n_points; ++i)
       {
-        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+        if (!boundary_evaluator.is_owned(i))
+          continue;
+        // Compute stress
+        SymmetricTensor<2, dim> sym_deformation;
+        for (unsigned int j = 0; j < dim; ++j)
           {
-            // Current face is at boundary and without Dirichlet bc.
-            if (s_cell->face(f)->at_boundary())
+            for (unsigned int k = 0; k < dim; ++k)
               {
-                for (unsigned int v = 0;
-                     v < GeometryInfo<dim>::vertices_per_face;
-                     ++v)
-                  {
-                    auto line = s_cell->face(f)->vertex_dof_index(v, 0);
-                    // Get interpolated solution from the fluid
-                    Vector<double> value(dim + 1);
-                    Utils::GridInterpolator<dim,
-                                            PETScWrappers::MPI::BlockVector>
-                      interpolator(fluid_solver.dof_handler,
-                                   s_cell->face(f)->vertex(v),
-                                   vertices_mask);
-                    interpolator.point_value(fluid_solver.present_solution,
-                                             value);
-                    std::vector<Tensor<1, dim>> gradient(dim + 1,
-                                                         Tensor<1, dim>());
-                    interpolator.point_gradient(fluid_solver.present_solution,
-                                                gradient);
-                    // Compute stress
-                    SymmetricTensor<2, dim> sym_deformation;
-                    for (unsigned int i = 0; i < dim; ++i)
-                      {
-                        for (unsigned int j = 0; j < dim; ++j)
-                          {
-                            sym_deformation[i][j] =
-                              (gradient[i][j] + gradient[j][i]) / 2;
-                          }
-                      }
-                    // \f$ \sigma = -p\bold{I} + \mu\nabla^S v\f$
-                    SymmetricTensor<2, dim> stress =
-                      -value[dim] *
-                        Physics::Elasticity::StandardTensors<dim>::I +
-                      2 * parameters.viscosity * sym_deformation;
-                    // Assign the cell stress to local row vectors
-                    for (unsigned int d1 = 0; d1 < dim; ++d1)
-                      {
-                        for (unsigned int d2 = 0; d2 < dim; ++d2)
-                          {
-                            solid_solver.fsi_stress_rows[d1][line + d2] =
-                              stress[d1][d2];
-                          }
-                      }
-                    // End assigning local fluid stress values
-                  } // End looping support points
-              }
-          } // End looping cell faces
-      }     // End looping solid cells
-    // Add up the local vectors
-    for (unsigned int d = 0; d < dim; ++d)
-      {
-        Utilities::MPI::sum(solid_solver.fsi_stress_rows[d],
-                            solid_solver.mpi_communicator,
-                            solid_solver.fsi_stress_rows[d]);
+                sym_deformation[j][k] =
+                  (gradients[i][j][k] + gradients[i][k][j]) / 2;
+              }
+          }
+        // \f$ \sigma = -p\bold{I} + \mu\nabla^S v\f$
+        SymmetricTensor<2, dim> stress =
+          -values[i][dim] * Physics::Elasticity::StandardTensors<dim>::I +
+          2 * parameters.viscosity * sym_deformation;
+        for (unsigned int d1 = 0; d1 < dim; ++d1)
+          {
+            for (unsigned int d2 = 0; d2 < dim; ++d2)
+              {
+                buffer[(i * dim + d1) * dim + d2] = stress[d1][d2];
+              }
+          }
+      }
+    // Add up the local buffers, every point has a single owner.
+    Utilities::MPI::sum(buffer, fluid_solver.mpi_communicator, buffer);
+    // In the split mode the buffer is sent to the solid processes instead.
+    if (!split)
+      {
+        assign_solid_bc();
       }
     move_solid_mesh(false);
   }
 
   template <int dim>
-  void FSI<dim>::refine_mesh(const unsigned int min_grid_level,
-                             const unsigned int max_grid_level)
+  void FSI<dim>::save_solid_state(const unsigned int level)
   {
-    TimerOutput::Scope timer_section(timer, "Refine mesh");
-    move_solid_mesh(true);
-    std::vector<Point<dim>> solid_boundary_points;
-    for (auto s_cell : solid_solver.dof_handler.active_cell_iterators())
+    SolidState &state = solid_states[level];
+    state.displacement = solid_solver.current_displacement;
+    state.velocity = solid_solver.current_velocity;
+    state.acceleration = solid_solver.current_acceleration;
+    state.stress = solid_solver.stress;
+  }
+
+  template <int dim>
+  void FSI<dim>::interpolate_solid_state(const double alpha)
+  {
+    auto interpolate = [alpha](PETScWrappers::MPI::Vector &v,
+                               const PETScWrappers::MPI::Vector &v0,
+                               const PETScWrappers::MPI::Vector &v1) {
+      v = v0;
+      v.sadd(1 - alpha, alpha, v1);
+    };
+    const SolidState &s0 = solid_states[0];
+    const SolidState &s1 = solid_states[1];
+    interpolate(
+      solid_solver.current_displacement, s0.displacement, s1.displacement);
+    interpolate(solid_solver.current_velocity, s0.velocity, s1.velocity);
+    interpolate(
+      solid_solver.current_acceleration, s0.acceleration, s1.acceleration);
+    for (unsigned int i = 0; i < dim; ++i)
       {
-        bool is_boundary = false;
-        Point<dim> point;
-        for (unsigned int face = 0; face < GeometryInfo<dim>::faces_per_cell;
-             ++face)
+        for (unsigned int j = 0; j < dim; ++j)
           {
-            if (s_cell->face(face)->at_boundary())
-              {
-                point = s_cell->face(face)->center();
-                is_boundary = true;
-                break;
-              }
+            interpolate(
+              solid_solver.stress[i][j], s0.stress[i][j], s1.stress[i][j]);
           }
-        if (is_boundary)
+      }
+  }
+
+  template <int dim>
+  void FSI<dim>::assign_solid_bc()
+  {
+    // Assign the stress to the row vectors
+    for (unsigned int i = 0; i < solid_boundary_vertices.size(); ++i)
+      {
+        for (unsigned int d1 = 0; d1 < dim; ++d1)
           {
-            solid_boundary_points.push_back(point);
+            for (unsigned int d2 = 0; d2 < dim; ++d2)
+              {
+                solid_solver.fsi_stress_rows[d1][solid_boundary_lines[i][d2]] =
+                  fluid_stress_buffer[(i * dim + d1) * dim + d2];
+              }
           }
       }
+  }
+
+  template <int dim>
+  bool FSI<dim>::refine_mesh(const unsigned int min_grid_level,
+                             const unsigned int max_grid_level)
+  {
+    TimerOutput::Scope timer_section(timer, "Refine mesh");
+    Utils::CouplingProfiler::Scope profiler_section(profiler, "Refine mesh");
+    // The boxes of the solid boundary faces in the current configuration.
+    update_solid_box();
+    // A cell is refined if the solid boundary is closer than the refinement
+    // distance, and coarsened if it is farther than the coarsening distance.
+    // The distance is measured between the cell box and the boxes of the
+    // boundary faces, which only overestimates the proximity.
+    std::vector<Point<dim>> vertices(GeometryInfo<dim>::vertices_per_cell);
+    auto within = [&](const typename Utils::AABBTree<dim>::Box &cell_box,
+                      const double distance) {
+      auto box = cell_box;
+      for (unsigned int d = 0; d < dim; ++d)
+        {
+          box.first[d] -= distance;
+          box.second[d] += distance;
+        }
+      return solid_tree.intersects(box);
+    };
     for (auto f_cell : fluid_solver.dof_handler.active_cell_iterators())
       {
-        auto center = f_cell->center();
-        double dist = 1000;
-        for (auto point : solid_boundary_points)
+        if (!f_cell->is_locally_owned())
+          continue;
+        const double diameter = f_cell->diameter();
+        // A cell only has to be tested if its extended box overlaps the
+        // solid box.
+        bool near = true;
+        const Point<dim> center = f_cell->center();
+        const double margin = parameters.coarsening_distance * diameter +
+                              diameter;
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            near = near && center[d] > solid_box(2 * d) - margin &&
+                   center[d] < solid_box(2 * d + 1) + margin;
+          }
+        if (!near)
+          {
+            f_cell->set_coarsen_flag();
+            continue;
+          }
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
           {
-            dist = std::min(center.distance(point), dist);
+            vertices[v] = f_cell->vertex(v);
           }
-        if (dist < f_cell->diameter())
+        const auto cell_box = Utils::AABBTree<dim>::bounding_box(vertices);
+        if (within(cell_box, parameters.refinement_distance * diameter))
           f_cell->set_refine_flag();
-        else
+        else if (!within(cell_box, parameters.coarsening_distance * diameter))
           f_cell->set_coarsen_flag();
       }
-    move_solid_mesh(false);
     if (fluid_solver.triangulation.n_levels() > max_grid_level)
       {
         for (auto cell =
@@ -687,15 +1464,33 @@ namespace MPI
         cell->clear_coarsen_flag();
       }
 
+    // The mesh and everything on it are only rebuilt if some cell changes.
+    fluid_solver.triangulation.prepare_coarsening_and_refinement();
+    unsigned int n_flagged = 0;
+    for (auto cell : fluid_solver.triangulation.active_cell_iterators())
+      {
+        if (cell->is_locally_owned() &&
+            (cell->refine_flag_set() || cell->coarsen_flag_set()))
+          ++n_flagged;
+      }
+    n_flagged = Utilities::MPI::sum(n_flagged, fluid_solver.mpi_communicator);
+    profiler.add("Cells flagged", n_flagged);
+    if (n_flagged == 0)
+      {
+        return false;
+      }
+    checkpoint_mesh_step = -1;
+
     parallel::distributed::SolutionTransfer<dim,
                                             PETScWrappers::MPI::BlockVector>
       solution_transfer(fluid_solver.dof_handler);
 
-    fluid_solver.triangulation.prepare_coarsening_and_refinement();
     solution_transfer.prepare_for_coarsening_and_refinement(
       fluid_solver.present_solution);
+    save_cell_hints();
 
     fluid_solver.triangulation.execute_coarsening_and_refinement();
+    boundary_evaluator.clear();
 
     fluid_solver.setup_dofs();
     fluid_solver.make_constraints();
@@ -709,6 +1504,697 @@ namespace MPI
     fluid_solver.nonzero_constraints.distribute(buffer);
     fluid_solver.present_solution = buffer;
     update_vertices_mask();
+    // The cell properties of the new cells are not initialized.
+    full_indicator_update = true;
+    return true;
+  }
+
+  template <int dim>
+  bool FSI<dim>::near_solid(
+    const typename Triangulation<dim>::cell_iterator &cell) const
+  {
+    const Point<dim> center = cell->center();
+    const double margin = cell->diameter();
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+        if (center(i) < solid_box(2 * i) - margin ||
+            center(i) > solid_box(2 * i + 1) + margin)
+          {
+            return false;
+          }
+      }
+    if (solid_body_boxes.size() > 1)
+      {
+        Point<dim> lower(center), upper(center);
+        for (unsigned int i = 0; i < dim; ++i)
+          {
+            lower[i] -= margin;
+            upper[i] += margin;
+          }
+        return near_solid_body({lower, upper});
+      }
+    return true;
+  }
+
+  template <int dim>
+  void FSI<dim>::balance_load()
+  {
+    // The number of steps that the times are measured over.
+    const unsigned int n_measured_steps = 10;
+    if (parameters.load_imbalance_threshold <= 1 ||
+        n_balance_steps < n_measured_steps)
+      {
+        return;
+      }
+    const MPI_Comm &fluid_communicator = fluid_solver.mpi_communicator;
+    const auto total_time = Utilities::MPI::min_max_avg(
+      fluid_time + coupling_time, fluid_communicator);
+    const double imbalance =
+      total_time.avg > 0 ? total_time.max / total_time.avg : 1;
+    if (imbalance > parameters.load_imbalance_threshold)
+      {
+        TimerOutput::Scope timer_section(timer, "Balance load");
+        // The solid box is up to date after the fluid steps.
+        double local_counts[2] = {0, 0};
+        for (auto cell : fluid_solver.triangulation.active_cell_iterators())
+          {
+            if (cell->is_locally_owned())
+              {
+                local_counts[0] += 1;
+                local_counts[1] += near_solid(cell);
+              }
+          }
+        double counts[2];
+        Utilities::MPI::sum(
+          ArrayView<const double>(local_counts, 2),
+          fluid_communicator,
+          ArrayView<double>(counts, 2));
+        const double total_fluid_time =
+          Utilities::MPI::sum(fluid_time, fluid_communicator);
+        const double total_coupling_time =
+          Utilities::MPI::sum(coupling_time, fluid_communicator);
+        // The costs per cell of the fluid, and of the extra coupling work of
+        // a cell near the solid, relative to the default weight.
+        if (counts[1] > 0 && total_fluid_time > 0)
+          {
+            const double cost = (total_coupling_time / counts[1]) /
+                                (total_fluid_time / counts[0]);
+            near_solid_weight =
+              static_cast<unsigned int>(std::min(1000 * cost, 1e6));
+          }
+        pcout << "Load imbalance " << imbalance
+              << ", repartitioning with a weight of " << near_solid_weight
+              << " on the cells near the solid..." << std::endl;
+        if (!cell_weight_connection.connected())
+          {
+            cell_weight_connection =
+              fluid_solver.triangulation.signals.cell_weight.connect(
+                [this](
+                  const typename Triangulation<dim>::cell_iterator &cell,
+                  const typename Triangulation<dim>::CellStatus) {
+                  return near_solid(cell) ? near_solid_weight : 0u;
+                });
+          }
+
+        parallel::distributed::SolutionTransfer<
+          dim,
+          PETScWrappers::MPI::BlockVector>
+          solution_transfer(fluid_solver.dof_handler);
+        solution_transfer.prepare_for_coarsening_and_refinement(
+          fluid_solver.present_solution);
+        save_cell_hints();
+        fluid_solver.triangulation.repartition();
+        boundary_evaluator.clear();
+
+        fluid_solver.setup_dofs();
+        fluid_solver.make_constraints();
+        fluid_solver.initialize_system();
+        PETScWrappers::MPI::BlockVector buffer;
+        buffer.reinit(fluid_solver.owned_partitioning, fluid_communicator);
+        buffer = 0;
+        solution_transfer.interpolate(buffer);
+        fluid_solver.nonzero_constraints.distribute(buffer);
+        fluid_solver.present_solution = buffer;
+        update_vertices_mask();
+        setup_cell_hints();
+        // The cells of the processes have changed, but not the mesh.
+        full_indicator_update = true;
+        if (checkpoint_mesh_step >= 0)
+          {
+            setup_fluid_transfer();
+          }
+      }
+    fluid_time = 0;
+    coupling_time = 0;
+    n_balance_steps = 0;
+  }
+
+  template <int dim>
+  void FSI<dim>::setup_solid_transfer()
+  {
+    auto renumber = [](const DoFHandler<dim> &dof_handler,
+                       std::vector<types::global_dof_index> &dofs) {
+      std::vector<bool> dof_touched(dof_handler.n_dofs(), false);
+      std::vector<types::global_dof_index> dof_indices(
+        dof_handler.get_fe().dofs_per_cell);
+      dofs.clear();
+      dofs.reserve(dof_handler.n_dofs());
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          cell->get_dof_indices(dof_indices);
+          for (auto index : dof_indices)
+            {
+              if (!dof_touched[index])
+                {
+                  dof_touched[index] = true;
+                  dofs.push_back(index);
+                }
+            }
+        }
+    };
+    renumber(solid_solver.dof_handler, canonical_solid_dofs);
+    renumber(solid_solver.scalar_dof_handler, canonical_scalar_dofs);
+    solid_state_buffer.reinit(3 * canonical_solid_dofs.size() +
+                              dim * dim * canonical_scalar_dofs.size());
+    fluid_stress_buffer.reinit(solid_boundary_vertices.size() * dim * dim);
+  }
+
+  template <int dim>
+  void FSI<dim>::pack_solid_state()
+  {
+    TimerOutput::Scope timer_section(timer, "Pack solid state");
+    Utils::CouplingProfiler::Scope profiler_section(profiler,
+                                                    "Pack solid state");
+    std::vector<Vector<double>> localized;
+    const std::vector<ArrayView<const double>> localized_state =
+      localize_solid_state(localized, 3);
+    const ArrayView<const double> &localized_displacement = localized_state[0];
+    const ArrayView<const double> &localized_velocity = localized_state[1];
+    const ArrayView<const double> &localized_acceleration = localized_state[2];
+    const unsigned int n_dofs = canonical_solid_dofs.size();
+    for (unsigned int k = 0; k < n_dofs; ++k)
+      {
+        const auto index = canonical_solid_dofs[k];
+        solid_state_buffer[3 * k] = localized_displacement[index];
+        solid_state_buffer[3 * k + 1] = localized_velocity[index];
+        solid_state_buffer[3 * k + 2] = localized_acceleration[index];
+      }
+    const unsigned int n_scalar_dofs = canonical_scalar_dofs.size();
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+        for (unsigned int j = 0; j < dim; ++j)
+          {
+            Vector<double> localized_stress(solid_solver.stress[i][j]);
+            const unsigned int offset =
+              3 * n_dofs + (i * dim + j) * n_scalar_dofs;
+            for (unsigned int k = 0; k < n_scalar_dofs; ++k)
+              {
+                solid_state_buffer[offset + k] =
+                  localized_stress[canonical_scalar_dofs[k]];
+              }
+          }
+      }
+  }
+
+  template <int dim>
+  void FSI<dim>::unpack_solid_state()
+  {
+    TimerOutput::Scope timer_section(timer, "Unpack solid state");
+    Utils::CouplingProfiler::Scope profiler_section(profiler,
+                                                    "Unpack solid state");
+    const unsigned int n_dofs = canonical_solid_dofs.size();
+    for (unsigned int k = 0; k < n_dofs; ++k)
+      {
+        const auto index = canonical_solid_dofs[k];
+        if (!solid_solver.locally_owned_dofs.is_element(index))
+          continue;
+        solid_solver.current_displacement(index) = solid_state_buffer[3 * k];
+        solid_solver.current_velocity(index) = solid_state_buffer[3 * k + 1];
+        solid_solver.current_acceleration(index) =
+          solid_state_buffer[3 * k + 2];
+      }
+    solid_solver.current_displacement.compress(VectorOperation::insert);
+    solid_solver.current_velocity.compress(VectorOperation::insert);
+    solid_solver.current_acceleration.compress(VectorOperation::insert);
+    const unsigned int n_scalar_dofs = canonical_scalar_dofs.size();
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+        for (unsigned int j = 0; j < dim; ++j)
+          {
+            const unsigned int offset =
+              3 * n_dofs + (i * dim + j) * n_scalar_dofs;
+            for (unsigned int k = 0; k < n_scalar_dofs; ++k)
+              {
+                const auto index = canonical_scalar_dofs[k];
+                if (solid_solver.locally_owned_scalar_dofs.is_element(index))
+                  {
+                    solid_solver.stress[i][j](index) =
+                      solid_state_buffer[offset + k];
+                  }
+              }
+            solid_solver.stress[i][j].compress(VectorOperation::insert);
+          }
+      }
+  }
+
+  template <int dim>
+  void FSI<dim>::setup_fluid_transfer()
+  {
+    const DoFHandler<dim> &dof_handler = fluid_solver.dof_handler;
+    const IndexSet &owned_dofs = dof_handler.locally_owned_dofs();
+    std::vector<bool> dof_touched(owned_dofs.n_elements(), false);
+    std::vector<types::global_dof_index> dof_indices(
+      dof_handler.get_fe().dofs_per_cell);
+    canonical_fluid_dofs.clear();
+    canonical_fluid_dofs.reserve(owned_dofs.n_elements());
+    // The ghost cells are visited as well, since a locally owned dof may
+    // first appear in one of them.
+    std::function<void(const typename DoFHandler<dim>::cell_iterator &)>
+      visit = [&](const typename DoFHandler<dim>::cell_iterator &cell) {
+        if (cell->has_children())
+          {
+            for (unsigned int i = 0; i < cell->n_children(); ++i)
+              {
+                visit(cell->child(i));
+              }
+            return;
+          }
+        if (cell->is_artificial())
+          {
+            return;
+          }
+        cell->get_dof_indices(dof_indices);
+        for (auto index : dof_indices)
+          {
+            if (!owned_dofs.is_element(index))
+              continue;
+            const auto k = owned_dofs.index_within_set(index);
+            if (!dof_touched[k])
+              {
+                dof_touched[k] = true;
+                canonical_fluid_dofs.push_back(index);
+              }
+          }
+      };
+    // The trees of p4est are a permutation of the coarse cells, and the
+    // children of a cell are in the same order in both.
+    for (auto coarse_cell : fluid_solver.triangulation
+                              .get_p4est_tree_to_coarse_cell_permutation())
+      {
+        visit(typename DoFHandler<dim>::cell_iterator(
+          &fluid_solver.triangulation, 0, coarse_cell, &dof_handler));
+      }
+    AssertThrow(canonical_fluid_dofs.size() == owned_dofs.n_elements(),
+                ExcMessage("Some locally owned fluid dofs are not found!"));
+    types::global_dof_index n_owned_dofs = canonical_fluid_dofs.size();
+    canonical_fluid_offset = 0;
+    int ierr = MPI_Exscan(&n_owned_dofs,
+                          &canonical_fluid_offset,
+                          1,
+                          DEAL_II_DOF_INDEX_MPI_TYPE,
+                          MPI_SUM,
+                          mpi_communicator);
+    AssertThrowMPI(ierr);
+    // MPI_Exscan leaves the result on the first process undefined.
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      {
+        canonical_fluid_offset = 0;
+      }
+  }
+
+  template <int dim>
+  void FSI<dim>::save_checkpoint()
+  {
+    TimerOutput::Scope timer_section(timer, "Save checkpoint");
+    const int timestep = time.get_timestep();
+    if (checkpoint_mesh_step < 0)
+      {
+        fluid_solver.triangulation.save(Utilities::int_to_string(timestep, 6) +
+                                        ".fsi_mesh");
+        checkpoint_mesh_step = timestep;
+        setup_fluid_transfer();
+      }
+    if (canonical_solid_dofs.empty())
+      {
+        setup_solid_transfer();
+      }
+    pack_solid_state();
+    std::vector<double> fluid_values(canonical_fluid_dofs.size());
+    for (unsigned int k = 0; k < canonical_fluid_dofs.size(); ++k)
+      {
+        fluid_values[k] =
+          fluid_solver.present_solution(canonical_fluid_dofs[k]);
+      }
+
+    // The file starts with a header, followed by the fluid solution and the
+    // solid state.
+    const unsigned int n_header = 5;
+    const double header[n_header] = {
+      static_cast<double>(timestep),
+      time.current(),
+      static_cast<double>(checkpoint_mesh_step),
+      static_cast<double>(fluid_solver.dof_handler.n_dofs()),
+      static_cast<double>(solid_state_buffer.size())};
+    const unsigned int rank =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    const unsigned int n_processes =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    // Every process has the entire solid state, and writes a slice of it.
+    const auto solid_begin = solid_state_buffer.size() * rank / n_processes;
+    const auto solid_end = solid_state_buffer.size() * (rank + 1) / n_processes;
+
+    const std::string filename =
+      Utilities::int_to_string(timestep, 6) + ".fsi_checkpoint";
+    MPI_File file;
+    int ierr = MPI_File_open(mpi_communicator,
+                             filename.c_str(),
+                             MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                             MPI_INFO_NULL,
+                             &file);
+    AssertThrowMPI(ierr);
+    ierr = MPI_File_set_size(file, 0);
+    AssertThrowMPI(ierr);
+    ierr = MPI_File_write_at_all(file,
+                                 0,
+                                 header,
+                                 rank == 0 ? n_header : 0,
+                                 MPI_DOUBLE,
+                                 MPI_STATUS_IGNORE);
+    AssertThrowMPI(ierr);
+    ierr = MPI_File_write_at_all(
+      file,
+      (n_header + canonical_fluid_offset) * sizeof(double),
+      fluid_values.data(),
+      static_cast<int>(fluid_values.size()),
+      MPI_DOUBLE,
+      MPI_STATUS_IGNORE);
+    AssertThrowMPI(ierr);
+    ierr = MPI_File_write_at_all(
+      file,
+      (n_header + fluid_solver.dof_handler.n_dofs() + solid_begin) *
+        sizeof(double),
+      solid_state_buffer.begin() + solid_begin,
+      static_cast<int>(solid_end - solid_begin),
+      MPI_DOUBLE,
+      MPI_STATUS_IGNORE);
+    AssertThrowMPI(ierr);
+    ierr = MPI_File_close(&file);
+    AssertThrowMPI(ierr);
+
+    // Remove the previous checkpoints, and the meshes that they need.
+    if (rank == 0)
+      {
+        const std::string mesh_stem =
+          Utilities::int_to_string(checkpoint_mesh_step, 6);
+        for (const auto &p : fs::directory_iterator(fs::current_path()))
+          {
+            const std::string name = p.path().filename().string();
+            if ((p.path().extension() == ".fsi_checkpoint" &&
+                 name != filename) ||
+                (name.find(".fsi_mesh") != std::string::npos &&
+                 name.compare(0, mesh_stem.size(), mesh_stem) != 0))
+              {
+                pcout << "Removing " << p.path() << std::endl;
+                fs::remove(p.path());
+              }
+          }
+      }
+    pcout << "Checkpoint file successfully saved at time step " << timestep
+          << "!" << std::endl;
+  }
+
+  template <int dim>
+  bool FSI<dim>::load_checkpoint()
+  {
+    // Find the latest checkpoint
+    fs::path local_path = fs::current_path();
+    fs::path checkpoint_file(local_path);
+    for (const auto &p : fs::directory_iterator(local_path))
+      {
+        if (p.path().extension() == ".fsi_checkpoint" &&
+            (std::string(p.path().stem()) >
+               std::string(checkpoint_file.stem()) ||
+             checkpoint_file == local_path))
+          {
+            checkpoint_file = p.path();
+          }
+      }
+    if (checkpoint_file == local_path)
+      {
+        pcout << "Did not find FSI checkpoint files. Start from the beginning !"
+              << std::endl;
+        return false;
+      }
+    AssertThrow(!time.adaptive(),
+                ExcMessage("Restarting is not supported with adaptive time "
+                           "stepping!"));
+    pcout << "Loading checkpoint file " << checkpoint_file.filename().c_str()
+          << "!" << std::endl;
+
+    MPI_File file;
+    int ierr = MPI_File_open(mpi_communicator,
+                             checkpoint_file.filename().c_str(),
+                             MPI_MODE_RDONLY,
+                             MPI_INFO_NULL,
+                             &file);
+    AssertThrowMPI(ierr);
+    const unsigned int n_header = 5;
+    double header[n_header];
+    ierr = MPI_File_read_at_all(
+      file, 0, header, n_header, MPI_DOUBLE, MPI_STATUS_IGNORE);
+    AssertThrowMPI(ierr);
+    const int timestep = static_cast<int>(header[0]);
+    checkpoint_mesh_step = static_cast<int>(header[2]);
+
+    // The fluid, whose mesh is repartitioned over the current processes.
+    fluid_solver.triangulation.load(
+      Utilities::int_to_string(checkpoint_mesh_step, 6) + ".fsi_mesh");
+    boundary_evaluator.clear();
+    fluid_solver.setup_dofs();
+    fluid_solver.make_constraints();
+    fluid_solver.initialize_system();
+    AssertThrow(fluid_solver.dof_handler.n_dofs() ==
+                  static_cast<types::global_dof_index>(header[3]),
+                ExcMessage("The fluid checkpoint does not match its mesh!"));
+    setup_fluid_transfer();
+    std::vector<double> fluid_values(canonical_fluid_dofs.size());
+    ierr = MPI_File_read_at_all(
+      file,
+      (n_header + canonical_fluid_offset) * sizeof(double),
+      fluid_values.data(),
+      static_cast<int>(fluid_values.size()),
+      MPI_DOUBLE,
+      MPI_STATUS_IGNORE);
+    AssertThrowMPI(ierr);
+    PETScWrappers::MPI::BlockVector tmp;
+    tmp.reinit(fluid_solver.owned_partitioning, mpi_communicator);
+    for (unsigned int k = 0; k < canonical_fluid_dofs.size(); ++k)
+      {
+        tmp(canonical_fluid_dofs[k]) = fluid_values[k];
+      }
+    tmp.compress(VectorOperation::insert);
+    fluid_solver.present_solution = tmp;
+
+    // The solid, whose mesh is the input one. The buffer of the fluid
+    // stress is not used outside of the split mode.
+    solid_solver.setup_dofs();
+    solid_solver.initialize_system();
+    setup_solid_transfer();
+    AssertThrow(solid_state_buffer.size() ==
+                  static_cast<unsigned int>(header[4]),
+                ExcMessage("The solid checkpoint does not match the mesh!"));
+    ierr = MPI_File_read_at_all(
+      file,
+      (n_header + fluid_solver.dof_handler.n_dofs()) * sizeof(double),
+      solid_state_buffer.begin(),
+      static_cast<int>(solid_state_buffer.size()),
+      MPI_DOUBLE,
+      MPI_STATUS_IGNORE);
+    AssertThrowMPI(ierr);
+    ierr = MPI_File_close(&file);
+    AssertThrowMPI(ierr);
+    unpack_solid_state();
+    solid_solver.previous_displacement = solid_solver.current_displacement;
+    solid_solver.previous_velocity = solid_solver.current_velocity;
+    solid_solver.previous_acceleration = solid_solver.current_acceleration;
+
+    fluid_solver.restore_time(timestep);
+    solid_solver.restore_time(timestep);
+    pcout << "Checkpoint file successfully loaded from time step " << timestep
+          << "!" << std::endl;
+    return true;
+  }
+
+  template <int dim>
+  void FSI<dim>::run_fluid_substeps(const bool first_step)
+  {
+    const unsigned int n_steps = parameters.fluid_substeps;
+    for (unsigned int i = 1; i <= n_steps; ++i)
+      {
+        // The fluid steps see the solid state interpolated in time, which
+        // ends up at the end of the coupling step.
+        if (n_steps > 1)
+          {
+            interpolate_solid_state(static_cast<double>(i) / n_steps);
+          }
+        Timer step_timer;
+        update_solid_box();
+        update_indicator();
+        // The inhomogeneous BCs are only applied in the first step, after
+        // which both constraints start from the cached static ones, and only
+        // the artificial fluid constraints near the solid are made again.
+        if (first_step && i == 1)
+          {
+            fluid_solver.make_constraints();
+          }
+        else
+          {
+            fluid_solver.restore_static_constraints();
+          }
+        find_fluid_bc();
+        coupling_time += step_timer.wall_time();
+        step_timer.restart();
+        {
+          TimerOutput::Scope timer_section(timer, "Run fluid solver");
+          Utils::CouplingProfiler::Scope profiler_section(profiler,
+                                                          "Run fluid solver");
+          fluid_solver.run_one_step(true);
+        }
+        fluid_time += step_timer.wall_time();
+      }
+    ++n_balance_steps;
+  }
+
+  template <int dim>
+  bool FSI<dim>::check_coupling(const unsigned int iteration)
+  {
+    // find_solid_bc overwrites the stress that the solid was given.
+    const Vector<double> input(fluid_stress_buffer);
+    find_solid_bc();
+    TimerOutput::Scope timer_section(timer, "Coupling iteration");
+    Utils::CouplingProfiler::Scope profiler_section(profiler,
+                                                    "Coupling iteration");
+    Vector<double> next_input;
+    const double residual =
+      coupling_accelerator.next(input, fluid_stress_buffer, next_input);
+    iteration_residual = residual;
+    pcout << "Coupling iteration = " << iteration
+          << ", relative residual = " << std::scientific << residual
+          << std::endl;
+    profiler.add("Coupling iterations", 1);
+    if (residual <= parameters.coupling_tolerance)
+      {
+        return true;
+      }
+    fluid_stress_buffer = next_input;
+    assign_solid_bc();
+    return false;
+  }
+
+  template <int dim>
+  void FSI<dim>::adapt_time_step()
+  {
+    // The first step takes the initial size.
+    if (!time.adaptive() || time.get_timestep() == 0)
+      {
+        return;
+      }
+    // The limits of the solvers are on their own steps. In the split mode
+    // only the fluid processes know about the fluid.
+    double limit =
+      solid_solver.get_stable_time_step() * parameters.solid_substeps;
+    double factor = std::numeric_limits<double>::max();
+    if (!solid_process)
+      {
+        limit = std::min(limit,
+                         fluid_solver.cfl_time_step() *
+                           parameters.fluid_substeps);
+        factor = fluid_solver.iteration_factor();
+      }
+    limit = Utilities::MPI::min(limit, mpi_communicator);
+    factor = Utilities::MPI::min(factor, mpi_communicator);
+    const double delta_t = time.adapt_delta_t(limit, factor);
+    solid_solver.time.set_delta_t(delta_t / parameters.solid_substeps);
+    fluid_solver.time.set_delta_t(delta_t / parameters.fluid_substeps);
+    pcout << "Adapted coupling time step size = " << std::scientific
+          << delta_t << std::endl;
+  }
+
+  template <int dim>
+  void FSI<dim>::run_concurrently()
+  {
+    setup_solid_transfer();
+    const unsigned int fluid_root = parameters.n_solid_processes;
+    bool first_step = true;
+    while (time.end() - time.current() > 1e-12)
+      {
+        adapt_time_step();
+        telemetry.begin_step(time.get_timestep() + 1,
+                             time.current() + time.get_delta_t());
+        if (solid_process)
+          {
+            if (!first_step)
+              {
+                {
+                  TimerOutput::Scope timer_section(timer, "Wait for fluid");
+                  Utils::CouplingProfiler::Scope profiler_section(
+                    profiler, "Wait for fluid");
+                  MPI_Wait(&fluid_stress_request, MPI_STATUS_IGNORE);
+                  // The previous state must be sent before it is overwritten.
+                  MPI_Wait(&solid_state_request, MPI_STATUS_IGNORE);
+                }
+                assign_solid_bc();
+              }
+            {
+              TimerOutput::Scope timer_section(timer, "Run solid solver");
+              Utils::CouplingProfiler::Scope profiler_section(
+                profiler, "Run solid solver");
+              for (unsigned int i = 0; i < parameters.solid_substeps; ++i)
+                {
+                  solid_solver.run_one_step(first_step && i == 0);
+                }
+            }
+            pack_solid_state();
+          }
+        else
+          {
+            if (parameters.fluid_substeps > 1)
+              {
+                save_solid_state(0);
+              }
+            if (!first_step)
+              {
+                {
+                  TimerOutput::Scope timer_section(timer, "Wait for solid");
+                  Utils::CouplingProfiler::Scope profiler_section(
+                    profiler, "Wait for solid");
+                  MPI_Wait(&solid_state_request, MPI_STATUS_IGNORE);
+                }
+                unpack_solid_state();
+              }
+            if (parameters.fluid_substeps > 1)
+              {
+                save_solid_state(1);
+              }
+            run_fluid_substeps(first_step);
+            if (!first_step)
+              {
+                MPI_Wait(&fluid_stress_request, MPI_STATUS_IGNORE);
+              }
+            find_solid_bc();
+          }
+        // Both groups must start the broadcasts in the same order.
+        int ierr = MPI_Ibcast(solid_state_buffer.begin(),
+                              solid_state_buffer.size(),
+                              MPI_DOUBLE,
+                              0,
+                              mpi_communicator,
+                              &solid_state_request);
+        AssertThrowMPI(ierr);
+        ierr = MPI_Ibcast(fluid_stress_buffer.begin(),
+                          fluid_stress_buffer.size(),
+                          MPI_DOUBLE,
+                          fluid_root,
+                          mpi_communicator,
+                          &fluid_stress_request);
+        AssertThrowMPI(ierr);
+        first_step = false;
+        time.increment();
+        if (time.time_to_refine() && !solid_process &&
+            refine_mesh(parameters.global_refinements[0],
+                        parameters.global_refinements[0] + 3))
+          {
+            setup_cell_hints();
+          }
+        if (!solid_process)
+          {
+            balance_load();
+          }
+        profiler.end_step(time.get_timestep(), time.current());
+      }
+    MPI_Wait(&solid_state_request, MPI_STATUS_IGNORE);
+    MPI_Wait(&fluid_stress_request, MPI_STATUS_IGNORE);
   }
 
   template <int dim>
@@ -717,24 +2203,39 @@ namespace MPI
     pcout << "Running with PETSc on "
           << Utilities::MPI::n_mpi_processes(mpi_communicator)
           << " MPI rank(s)..." << std::endl;
+    if (split)
+      {
+        pcout << "Solid processes: " << parameters.n_solid_processes
+              << std::endl;
+      }
 
     solid_solver.triangulation.refine_global(parameters.global_refinements[1]);
-    // Try load from previous computation.
+    // Try load from previous computation. Checkpointing is not supported in
+    // the split mode, where the fluid and the solid are one step apart.
     bool success_load =
-      solid_solver.load_checkpoint() && fluid_solver.load_checkpoint();
+      !split && (parameters.checkpoint_format == "coupled"
+                   ? load_checkpoint()
+                   : solid_solver.load_checkpoint() &&
+                       fluid_solver.load_checkpoint());
     AssertThrow(
       solid_solver.time.current() == fluid_solver.time.current(),
       ExcMessage("Solid and fluid restart files have different time steps. "
                  "Check and remove inconsistent restart files!"));
     if (!success_load)
       {
+        // The fluid processes also need the solid dofs and vectors to
+        // receive the solid state, but the solid processes never touch the
+        // fluid.
         solid_solver.setup_dofs();
         solid_solver.initialize_system();
-        fluid_solver.triangulation.refine_global(
-          parameters.global_refinements[0]);
-        fluid_solver.setup_dofs();
-        fluid_solver.make_constraints();
-        fluid_solver.initialize_system();
+        if (!solid_process)
+          {
+            fluid_solver.triangulation.refine_global(
+              parameters.global_refinements[0]);
+            fluid_solver.setup_dofs();
+            fluid_solver.make_constraints();
+            fluid_solver.initialize_system();
+          }
       }
     else
       {
@@ -744,63 +2245,129 @@ namespace MPI
           }
       }
 
-    collect_solid_boundaries();
-    setup_cell_hints();
-    update_vertices_mask();
+    // The time step of the FSI is the coupling time step, which the solvers
+    // may divide into smaller steps. This is done after loading the
+    // checkpoints, which count the coupling steps.
+    solid_solver.time.set_delta_t(time.get_delta_t() /
+                                  parameters.solid_substeps);
+    fluid_solver.time.set_delta_t(time.get_delta_t() /
+                                  parameters.fluid_substeps);
 
-    pcout << "Number of fluid active cells and dofs: ["
-          << fluid_solver.triangulation.n_active_cells() << ", "
-          << fluid_solver.dof_handler.n_dofs() << "]" << std::endl
-          << "Number of solid active cells and dofs: ["
-          << solid_solver.triangulation.n_active_cells() << ", "
-          << solid_solver.dof_handler.n_dofs() << "]" << std::endl;
-    bool first_step = !success_load;
-    if (parameters.refinement_interval < parameters.end_time)
+    collect_solid_boundaries();
+    solid_locator.reinit();
+    if (!solid_process)
       {
-        refine_mesh(parameters.global_refinements[0],
-                    parameters.global_refinements[0] + 3);
-        refine_mesh(parameters.global_refinements[0],
-                    parameters.global_refinements[0] + 3);
         setup_cell_hints();
+        update_vertices_mask();
+        pcout << "Number of fluid active cells and dofs: ["
+              << fluid_solver.triangulation.n_active_cells() << ", "
+              << fluid_solver.dof_handler.n_dofs() << "]" << std::endl;
+      }
+    if (!split || solid_process)
+      {
+        pcout << "Number of solid active cells and dofs: ["
+              << solid_solver.triangulation.n_active_cells() << ", "
+              << solid_solver.dof_handler.n_dofs() << "]" << std::endl;
+      }
+    bool first_step = !success_load;
+    if (parameters.refinement_interval < parameters.end_time && !solid_process)
+      {
+        // The hints are restored after every refinement that changes the
+        // mesh, before the next one saves them again.
+        for (unsigned int i = 0; i < 2; ++i)
+          {
+            if (refine_mesh(parameters.global_refinements[0],
+                            parameters.global_refinements[0] + 3))
+              {
+                setup_cell_hints();
+              }
+          }
+      }
+    if (split)
+      {
+        run_concurrently();
+        return;
       }
     while (time.end() - time.current() > 1e-12)
       {
+        adapt_time_step();
+        telemetry.begin_step(time.get_timestep() + 1,
+                             time.current() + time.get_delta_t());
+        // The fluid traction is held over the solid steps.
         find_solid_bc();
         if (success_load)
           {
             solid_solver.assemble_system(true);
           }
-        {
-          TimerOutput::Scope timer_section(timer, "Run solid solver");
-          solid_solver.run_one_step(first_step);
-        }
-        update_solid_box();
-        update_indicator();
-        fluid_solver.make_constraints();
-        if (!first_step)
+        // The implicit coupling repeats the time step with the accelerated
+        // stress until the stress the fluid returns agrees with it. The
+        // solvers keep their preconditioners over the iterations.
+        const bool implicit = parameters.coupling_iterations > 1;
+        if (implicit)
           {
-            fluid_solver.nonzero_constraints.clear();
-            fluid_solver.nonzero_constraints.copy_from(
-              fluid_solver.zero_constraints);
+            solid_solver.save_step_state();
+            fluid_solver.save_step_state();
+            coupling_accelerator.reset();
+          }
+        for (unsigned int iteration = 0;; ++iteration)
+          {
+            if (iteration > 0)
+              {
+                solid_solver.restore_step_state();
+                fluid_solver.restore_step_state();
+              }
+            if (parameters.fluid_substeps > 1)
+              {
+                save_solid_state(0);
+              }
+            {
+              TimerOutput::Scope timer_section(timer, "Run solid solver");
+              Utils::CouplingProfiler::Scope profiler_section(
+                profiler, "Run solid solver");
+              for (unsigned int i = 0; i < parameters.solid_substeps; ++i)
+                {
+                  solid_solver.run_one_step(first_step && i == 0);
+                }
+            }
+            if (parameters.fluid_substeps > 1)
+              {
+                save_solid_state(1);
+              }
+            run_fluid_substeps(first_step);
+            if (!implicit || iteration + 1 == parameters.coupling_iterations ||
+                check_coupling(iteration))
+              {
+                break;
+              }
+          }
+        if (implicit)
+          {
+            // Without a check at the last iteration the residual is the one
+            // of the iteration before, which did not converge.
+            coupling_residual = std::max(coupling_residual, iteration_residual);
           }
-        find_fluid_bc();
-        {
-          TimerOutput::Scope timer_section(timer, "Run fluid solver");
-          fluid_solver.run_one_step(true);
-        }
         first_step = false;
         time.increment();
-        if (time.time_to_refine())
-          {
+        if (time.time_to_refine() &&
             refine_mesh(parameters.global_refinements[0],
-                        parameters.global_refinements[0] + 3);
+                        parameters.global_refinements[0] + 3))
+          {
             setup_cell_hints();
           }
+        balance_load();
         if (time.time_to_save())
           {
-            solid_solver.save_checkpoint(time.get_timestep());
-            fluid_solver.save_checkpoint(time.get_timestep());
+            if (parameters.checkpoint_format == "coupled")
+              {
+                save_checkpoint();
+              }
+            else
+              {
+                solid_solver.save_checkpoint(time.get_timestep());
+                fluid_solver.save_checkpoint(time.get_timestep());
+              }
           }
+        profiler.end_step(time.get_timestep(), time.current());
       }
   }
 
@@ -1,55 +1,301 @@
 #include "mpi_hyper_elasticity.h"
 
-namespace Internal
+namespace Solid
 {
-  using namespace dealii;
-
-  template <int dim>
-  void PointHistory<dim>::setup(const Parameters::AllParameters &parameters,
-                                const unsigned int &mat_id)
+  namespace MPI
   {
-    if (parameters.solid_type == "NeoHookean")
-      {
-        Assert(parameters.C[mat_id - 1].size() >= 2, ExcInternalError());
-        material.reset(new Solid::NeoHookean<dim>(parameters.C[mat_id - 1][0],
-                                                  parameters.C[mat_id - 1][1],
-                                                  parameters.solid_rho));
-        update(parameters, Tensor<2, dim>());
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-  }
+    using namespace dealii;
 
-  template <int dim>
-  void PointHistory<dim>::update(const Parameters::AllParameters &parameters,
-                                 const Tensor<2, dim> &Grad_u)
-  {
-    const Tensor<2, dim> F = Physics::Elasticity::Kinematics::F(Grad_u);
-    material->update_data(F);
-    F_inv = invert(F);
-    if (parameters.solid_type == "NeoHookean")
+    namespace
+    {
+      // The PETSc vectors and the matrix-free vectors have the same locally
+      // owned dofs in the same order, so the local arrays are simply copied.
+      void copy_vector(LinearAlgebra::distributed::Vector<double> &dst,
+                       const PETScWrappers::MPI::Vector &src)
       {
-        auto nh = std::dynamic_pointer_cast<Solid::NeoHookean<dim>>(material);
-        Assert(nh, ExcInternalError());
-        tau = nh->get_tau();
-        Jc = nh->get_Jc();
+        const PetscScalar *values;
+        PetscErrorCode ierr = VecGetArrayRead(src, &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        std::copy(values, values + dst.local_size(), dst.begin());
+        ierr = VecRestoreArrayRead(src, &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
       }
-    else
+
+      void copy_vector(PETScWrappers::MPI::Vector &dst,
+                       const LinearAlgebra::distributed::Vector<double> &src)
       {
-        Assert(false, ExcNotImplemented());
+        PetscScalar *values;
+        PetscErrorCode ierr = VecGetArray(dst, &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        std::copy(src.begin(), src.begin() + src.local_size(), values);
+        ierr = VecRestoreArray(dst, &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
       }
-    dPsi_vol_dJ = material->get_dPsi_vol_dJ();
-    d2Psi_vol_dJ2 = material->get_d2Psi_vol_dJ2();
-  }
-} // namespace Internal
+    } // namespace
 
-namespace Solid
-{
-  namespace MPI
-  {
-    using namespace dealii;
+    template <int dim>
+    HyperElasticity<dim>::TangentOperator::TangentOperator(
+      unsigned int degree, unsigned int chebyshev_degree)
+      : degree(degree), chebyshev_degree(chebyshev_degree), mass_factor(0)
+    {
+      AssertThrow(degree == 1 || degree == 2,
+                  ExcMessage("The matrix-free tangent is only implemented "
+                             "for solid degree 1 and 2!"));
+    }
+
+    template <int dim>
+    void HyperElasticity<dim>::TangentOperator::reinit(
+      const DoFHandler<dim> &dof_handler,
+      const AffineConstraints<double> &constraints)
+    {
+      typename MatrixFree<dim>::AdditionalData data;
+      data.tasks_parallel_scheme = MatrixFree<dim>::AdditionalData::none;
+      data.mapping_update_flags =
+        update_values | update_gradients | update_JxW_values;
+      matrix_free.reinit(dof_handler, constraints, QGauss<1>(degree + 1), data);
+      matrix_free.initialize_dof_vector(x_buffer);
+      matrix_free.initialize_dof_vector(b_buffer);
+      F_inv.clear();
+      tau.clear();
+      Jc.clear();
+    }
+
+    template <int dim>
+    void HyperElasticity<dim>::TangentOperator::update(
+      const Internal::QuadratureHistory<dim> &history, const double factor)
+    {
+      mass_factor = factor;
+      const unsigned int n_q_points = Utilities::fixed_power<dim>(degree + 1);
+      const unsigned int n_batches = matrix_free.n_macro_cells();
+      F_inv.resize(n_batches * n_q_points);
+      tau.resize(n_batches * n_q_points);
+      Jc.resize(n_batches * n_q_points);
+      for (unsigned int batch = 0; batch < n_batches; ++batch)
+        {
+          const unsigned int n_filled = matrix_free.n_components_filled(batch);
+          // The empty lanes of the last batch repeat the last cell, so that
+          // they hold a valid state.
+          const unsigned int n_lanes =
+            VectorizedArray<double>::n_array_elements;
+          for (unsigned int v = 0; v < n_lanes; ++v)
+            {
+              const auto cell =
+                matrix_free.get_cell_iterator(batch, std::min(v, n_filled - 1));
+              const unsigned int first_point =
+                history.begin(cell->active_cell_index());
+              for (unsigned int q = 0; q < n_q_points; ++q)
+                {
+                  const unsigned int point = first_point + q;
+                  const unsigned int index = batch * n_q_points + q;
+                  const Tensor<2, dim> &F_inv_q = history.get_F_inv(point);
+                  const SymmetricTensor<2, dim> &tau_q = history.get_tau(point);
+                  const SymmetricTensor<4, dim> &Jc_q = history.get_Jc(point);
+                  for (unsigned int i = 0; i < dim; ++i)
+                    {
+                      for (unsigned int j = 0; j < dim; ++j)
+                        {
+                          F_inv[index][i][j][v] = F_inv_q[i][j];
+                          tau[index][i][j][v] = tau_q[i][j];
+                          for (unsigned int k = 0; k < dim; ++k)
+                            {
+                              for (unsigned int l = 0; l < dim; ++l)
+                                {
+                                  Jc[index][i][j][k][l][v] = Jc_q[i][j][k][l];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+      // The diagonal is computed cell by cell, the constrained entries are
+      // set to 1 as the operator maps them to themselves.
+      auto jacobi = std::make_shared<DiagonalMatrix<VectorType>>();
+      VectorType &diagonal = jacobi->get_vector();
+      matrix_free.initialize_dof_vector(diagonal);
+      unsigned int dummy = 0;
+      switch (degree)
+        {
+        case 1:
+          matrix_free.cell_loop(
+            &TangentOperator::template local_diagonal<1>,
+            this,
+            diagonal,
+            dummy);
+          break;
+        case 2:
+          matrix_free.cell_loop(
+            &TangentOperator::template local_diagonal<2>,
+            this,
+            diagonal,
+            dummy);
+          break;
+        }
+      for (auto i : matrix_free.get_constrained_dofs())
+        {
+          diagonal.local_element(i) = 1;
+        }
+      for (unsigned int i = 0; i < diagonal.local_size(); ++i)
+        {
+          Assert(diagonal.local_element(i) > 0,
+                 ExcMessage("The tangent must be positive definite!"));
+          diagonal.local_element(i) = 1 / diagonal.local_element(i);
+        }
+
+      // The eigenvalues are estimated with a few CG iterations on every
+      // update, the polynomial then targets the upper part of the spectrum
+      // and CG takes care of the rest.
+      typename PreconditionChebyshev<TangentOperator,
+                                     VectorType,
+                                     DiagonalMatrix<VectorType>>::AdditionalData
+        data;
+      data.degree = chebyshev_degree;
+      data.smoothing_range = 20;
+      data.eig_cg_n_iterations = 20;
+      data.preconditioner = jacobi;
+      preconditioner.initialize(*this, data);
+    }
+
+    template <int dim>
+    template <int degree>
+    void HyperElasticity<dim>::TangentOperator::quadrature_apply(
+      FEEvaluation<dim, degree, degree + 1, dim> &phi,
+      const unsigned int batch) const
+    {
+      const VectorizedArray<double> factor = make_vectorized_array(mass_factor);
+      for (unsigned int q = 0; q < phi.n_q_points; ++q)
+        {
+          const unsigned int index = batch * phi.n_q_points + q;
+          // The spatial gradient, and the first Piola-Kirchhoff like flux
+          // that is tested with the material gradient.
+          const Tensor<2, dim, VectorizedArray<double>> grad_u =
+            phi.get_gradient(q) * F_inv[index];
+          const Tensor<2, dim, VectorizedArray<double>> flux =
+            Tensor<2, dim, VectorizedArray<double>>(Jc[index] *
+                                                    symmetrize(grad_u)) +
+            grad_u * Tensor<2, dim, VectorizedArray<double>>(tau[index]);
+          phi.submit_gradient(flux * transpose(F_inv[index]), q);
+          phi.submit_value(phi.get_value(q) * factor, q);
+        }
+    }
+
+    template <int dim>
+    template <int degree>
+    void HyperElasticity<dim>::TangentOperator::local_apply(
+      const MatrixFree<dim> &data,
+      VectorType &dst,
+      const VectorType &src,
+      const std::pair<unsigned int, unsigned int> &cell_range) const
+    {
+      FEEvaluation<dim, degree, degree + 1, dim> phi(data);
+      for (unsigned int cell = cell_range.first; cell < cell_range.second;
+           ++cell)
+        {
+          phi.reinit(cell);
+          phi.read_dof_values(src);
+          phi.evaluate(true, true);
+          quadrature_apply(phi, cell);
+          phi.integrate(true, true);
+          phi.distribute_local_to_global(dst);
+        }
+    }
+
+    template <int dim>
+    template <int degree>
+    void HyperElasticity<dim>::TangentOperator::local_diagonal(
+      const MatrixFree<dim> &data,
+      VectorType &dst,
+      const unsigned int &,
+      const std::pair<unsigned int, unsigned int> &cell_range) const
+    {
+      FEEvaluation<dim, degree, degree + 1, dim> phi(data);
+      AlignedVector<VectorizedArray<double>> diagonal(phi.dofs_per_cell);
+      for (unsigned int cell = cell_range.first; cell < cell_range.second;
+           ++cell)
+        {
+          phi.reinit(cell);
+          // Apply the operator to the unit vectors of the cell.
+          for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+            {
+              for (unsigned int j = 0; j < phi.dofs_per_cell; ++j)
+                {
+                  phi.begin_dof_values()[j] = make_vectorized_array(0.0);
+                }
+              phi.begin_dof_values()[i] = make_vectorized_array(1.0);
+              phi.evaluate(true, true);
+              quadrature_apply(phi, cell);
+              phi.integrate(true, true);
+              diagonal[i] = phi.begin_dof_values()[i];
+            }
+          for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+            {
+              phi.begin_dof_values()[i] = diagonal[i];
+            }
+          phi.distribute_local_to_global(dst);
+        }
+    }
+
+    template <int dim>
+    void HyperElasticity<dim>::TangentOperator::vmult(
+      VectorType &dst, const VectorType &src) const
+    {
+      switch (degree)
+        {
+        case 1:
+          matrix_free.cell_loop(
+            &TangentOperator::template local_apply<1>, this, dst, src, true);
+          break;
+        case 2:
+          matrix_free.cell_loop(
+            &TangentOperator::template local_apply<2>, this, dst, src, true);
+          break;
+        }
+      for (auto i : matrix_free.get_constrained_dofs())
+        {
+          dst.local_element(i) = src.local_element(i);
+        }
+    }
+
+    template <int dim>
+    types::global_dof_index HyperElasticity<dim>::TangentOperator::m() const
+    {
+      return matrix_free.get_vector_partitioner()->size();
+    }
+
+    template <int dim>
+    void HyperElasticity<dim>::TangentOperator::initialize_dof_vector(
+      VectorType &vector) const
+    {
+      matrix_free.initialize_dof_vector(vector);
+    }
+
+    template <int dim>
+    std::pair<unsigned int, double>
+    HyperElasticity<dim>::TangentOperator::solve(
+      PETScWrappers::MPI::Vector &x,
+      const PETScWrappers::MPI::Vector &b,
+      const double tolerance) const
+    {
+      copy_vector(b_buffer, b);
+      x_buffer = 0;
+      SolverControl control(b.size(), tolerance);
+      SolverCG<VectorType> cg(control);
+      cg.solve(*this, x_buffer, b_buffer, preconditioner);
+      copy_vector(x, x_buffer);
+      return {control.last_step(), control.last_value()};
+    }
+
+    template <int dim>
+    std::size_t
+    HyperElasticity<dim>::TangentOperator::memory_consumption() const
+    {
+      return matrix_free.memory_consumption() +
+             MemoryConsumption::memory_consumption(F_inv) +
+             MemoryConsumption::memory_consumption(tau) +
+             MemoryConsumption::memory_consumption(Jc) +
+             x_buffer.memory_consumption() + b_buffer.memory_consumption();
+    }
 
     template <int dim>
     HyperElasticity<dim>::HyperElasticity(
@@ -57,6 +303,11 @@ namespace Solid
       const Parameters::AllParameters &params)
       : SolidSolver<dim>(tria, params)
     {
+      if (parameters.solid_matrix_free_tangent)
+        {
+          tangent.reset(new TangentOperator(parameters.solid_degree,
+                                            parameters.solid_chebyshev_degree));
+        }
     }
 
     template <int dim>
@@ -78,6 +329,8 @@ namespace Solid
       PETScWrappers::MPI::Vector tmp(current_displacement);
 
       time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
 
       pcout << std::endl
             << "Timestep " << time.get_timestep() << " @ " << time.current()
@@ -96,12 +349,21 @@ namespace Solid
 
       // The prediction of the current displacement,
       // which is what we want to solve.
-      predicted_displacement = previous_displacement;
-      predicted_displacement.add(
-        dt, previous_velocity, (0.5 - beta) * dt * dt, previous_acceleration);
+      const Utils::NewmarkUpdate newmark(beta, gamma, dt);
+      newmark.predict(predicted_displacement,
+                      previous_displacement,
+                      previous_velocity,
+                      previous_acceleration);
 
       pcout << std::string(100, '_') << std::endl;
 
+      // The tangent is always assembled at the first iteration, the modified
+      // Newton method then keeps it while it is recent and converges well.
+      bool assemble_tangent = true;
+      unsigned int tangent_age = 0;
+      double previous_error_residual = 0;
+      Utils::ForcingTerm forcing(parameters.solid_max_forcing);
+
       while (normalized_error_update > parameters.tol_d ||
              normalized_error_residual > parameters.tol_f)
         {
@@ -109,24 +371,46 @@ namespace Solid
                       ExcMessage("Too many Newton iterations!"));
 
           // Compute the displacement, velocity and acceleration
-          current_acceleration = current_displacement;
-          current_acceleration -= predicted_displacement;
-          current_acceleration /= (beta * dt * dt);
-          current_velocity = previous_velocity;
-          current_velocity.add(dt * (1 - gamma),
-                               previous_acceleration,
-                               dt * gamma,
-                               current_acceleration);
+          newmark.correct_from_displacement(current_displacement,
+                                            predicted_displacement,
+                                            current_acceleration,
+                                            current_velocity,
+                                            previous_acceleration,
+                                            previous_velocity);
 
           // Assemble the system, and modify the RHS to account for
           // the time-discretization.
-          assemble_system(false);
+          assemble_system(false, assemble_tangent && !tangent);
           mass_matrix.vmult(tmp, current_acceleration);
           system_rhs -= tmp;
+          if (assemble_tangent)
+            {
+              tangent_age = 0;
+              // Make solve_factorized factorize the new tangent.
+              this->factorized_delta_t = 0;
+              if (tangent)
+                {
+                  TimerOutput::Scope timer_section(
+                    timer, "Update matrix-free tangent");
+                  tangent->update(quad_point_history,
+                                  quad_point_history.get_density() /
+                                    (beta * dt * dt));
+                }
+            }
 
+          // The forcing term of the inexact Newton method, which is ignored by
+          // the direct solver.
+          const double eta = parameters.solid_inexact_newton
+                               ? forcing.next(system_rhs.l2_norm())
+                               : 0;
           // Solve linear system
           const std::pair<unsigned int, double> lin_solver_output =
-            this->solve(system_matrix, newton_update, system_rhs);
+            tangent ? solve_tangent(newton_update, system_rhs, eta)
+                    : parameters.solid_tangent_reuse > 0 &&
+                          parameters.solid_cached_factorization
+                        ? this->solve_factorized(newton_update, system_rhs)
+                        : this->solve(
+                            system_matrix, newton_update, system_rhs, eta);
 
           // Error evaluation
           {
@@ -146,6 +430,17 @@ namespace Solid
               }
             normalized_error_update = error_update / initial_error_update;
           }
+          telemetry.add("Newton iterations", 1);
+          telemetry.set("Newton residual", error_residual);
+
+          // Reassemble the tangent if it is too old, or if it has not halved
+          // the residual.
+          ++tangent_age;
+          assemble_tangent =
+            tangent_age > parameters.solid_tangent_reuse ||
+            (newton_iteration > 0 &&
+             error_residual > 0.5 * previous_error_residual);
+          previous_error_residual = error_residual;
 
           current_displacement += newton_update;
           // Update the quadrature point history with the newest displacement
@@ -161,19 +456,15 @@ namespace Solid
           newton_iteration++;
         }
 
-      // Once converged, update current acceleration and velocity again.
-      current_acceleration = current_displacement;
-      current_acceleration -= predicted_displacement;
-      current_acceleration /= (beta * dt * dt);
-      current_velocity = previous_velocity;
-      current_velocity.add(dt * (1 - gamma),
-                           previous_acceleration,
-                           dt * gamma,
-                           current_acceleration);
-      // Update the previous values
-      previous_acceleration = current_acceleration;
-      previous_velocity = current_velocity;
-      previous_displacement = current_displacement;
+      // Once converged, update current acceleration and velocity again, and
+      // the previous values in the same pass.
+      newmark.correct_from_displacement(current_displacement,
+                                        predicted_displacement,
+                                        current_acceleration,
+                                        current_velocity,
+                                        previous_acceleration,
+                                        previous_velocity,
+                                        previous_displacement);
 
       pcout << std::string(100, '_') << std::endl
             << "Relative errors:" << std::endl
@@ -190,13 +481,62 @@ namespace Solid
     void HyperElasticity<dim>::initialize_system()
     {
       SolidSolver<dim>::initialize_system();
+      if (tangent)
+        {
+          // Only the mass matrix is assembled then.
+          system_matrix.clear();
+          tangent->reinit(dof_handler, constraints);
+        }
       setup_qph();
     }
 
+    template <int dim>
+    std::pair<unsigned int, double>
+    HyperElasticity<dim>::solve_tangent(PETScWrappers::MPI::Vector &x,
+                                        const PETScWrappers::MPI::Vector &b,
+                                        const double forcing)
+    {
+      TimerOutput::Scope timer_section(timer, "Solve linear system");
+
+      const double tolerance = parameters.solid_linear_tolerance > 0
+                                 ? parameters.solid_linear_tolerance
+                                 : 1e-8;
+      const std::pair<unsigned int, double> output =
+        tangent->solve(x, b, std::max(tolerance, forcing) * b.l2_norm());
+      constraints.distribute(x);
+
+      performance.add("Krylov iterations", output.first);
+      performance.add("Linear solves", 1);
+      telemetry.add("Krylov iterations", output.first);
+      telemetry.set("Krylov residual", output.second);
+      return output;
+    }
+
+    template <int dim>
+    void HyperElasticity<dim>::add_memory(Utils::MemoryReport &report) const
+    {
+      SolidSolver<dim>::add_memory(report);
+      report.add_object(
+        "Cell data", "Quadrature point history", quad_point_history);
+      if (tangent)
+        {
+          report.add("Matrices",
+                     "Matrix-free tangent",
+                     tangent->memory_consumption());
+        }
+    }
+
     template <int dim>
     void HyperElasticity<dim>::setup_qph()
     {
+      Assert(parameters.solid_type == "NeoHookean", ExcNotImplemented());
       const unsigned int n_q_points = volume_quad_formula.size();
+      quad_point_history.reinit(parameters,
+                                triangulation.n_active_cells(),
+                                triangulation.n_locally_owned_active_cells(),
+                                n_q_points);
+      // Start from the undeformed configuration.
+      const std::vector<Tensor<2, dim>> grad_u(n_q_points);
       for (auto cell = triangulation.begin_active();
            cell != triangulation.end();
            ++cell)
@@ -206,14 +546,11 @@ namespace Solid
           unsigned int mat_id = cell->material_id();
           if (parameters.n_solid_parts == 1)
             mat_id = 1;
-          quad_point_history.initialize(cell, n_q_points);
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
-          for (unsigned int q = 0; q < n_q_points; ++q)
-            {
-              lqph[q]->setup(parameters, mat_id);
-            }
+          quad_point_history.add_cell(cell->active_cell_index(), mat_id);
+          HyperElasticKernel<NeoHookean, dim>::update(
+            quad_point_history,
+            quad_point_history.begin(cell->active_cell_index()),
+            grad_u);
         }
     }
 
@@ -222,11 +559,12 @@ namespace Solid
       const PETScWrappers::MPI::Vector &evaluation_point)
     {
       timer.enter_subsection("Update QPH data");
+      Utils::CounterRegion counter_region("Update QPH data");
 
       // displacement gradient at quad points
       const unsigned int n_q_points = volume_quad_formula.size();
       FEValuesExtractors::Vector displacement(0);
-      std::vector<Tensor<2, dim>> grad_u(volume_quad_formula.size());
+      std::vector<Tensor<2, dim>> grad_u(n_q_points);
       FEValues<dim> fe_values(
         fe, volume_quad_formula, update_values | update_gradients);
 
@@ -239,17 +577,15 @@ namespace Solid
         {
           if (!cell->is_locally_owned())
             continue;
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first_point =
+            quad_point_history.begin(cell->active_cell_index());
 
           fe_values.reinit(cell);
           fe_values[displacement].get_function_gradients(tmp, grad_u);
 
-          for (unsigned int q = 0; q < n_q_points; ++q)
-            {
-              lqph[q]->update(parameters, grad_u[q]);
-            }
+          // NeoHookean is the only material, see setup_qph.
+          HyperElasticKernel<NeoHookean, dim>::update(
+            quad_point_history, first_point, grad_u);
         }
       timer.leave_subsection();
     }
@@ -267,12 +603,12 @@ namespace Solid
           if (!cell->is_locally_owned())
             continue;
           fe_values.reinit(cell);
-          const std::vector<std::shared_ptr<const Internal::PointHistory<dim>>>
-            lqph = quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first_point =
+            quad_point_history.begin(cell->active_cell_index());
           for (unsigned int q = 0; q < n_q_points; ++q)
             {
-              const double det = lqph[q]->get_det_F();
+              const unsigned int point = first_point + q;
+              const double det = quad_point_history.get_det_F(point);
               const double JxW = fe_values.JxW(q);
               volume += det * JxW;
             }
@@ -294,9 +630,11 @@ namespace Solid
     }
 
     template <int dim>
-    void HyperElasticity<dim>::assemble_system(bool initial_step)
+    void HyperElasticity<dim>::assemble_system(bool initial_step,
+                                               bool assemble_matrix)
     {
       timer.enter_subsection("Assemble tangent matrix");
+      Utils::CounterRegion counter_region("Assemble tangent matrix");
 
       const unsigned int n_q_points = volume_quad_formula.size();
       const unsigned int n_f_q_points = face_quad_formula.size();
@@ -309,7 +647,10 @@ namespace Solid
         {
           mass_matrix = 0.0;
         }
-      system_matrix = 0.0;
+      if (assemble_matrix)
+        {
+          system_matrix = 0.0;
+        }
       system_rhs = 0.0;
 
       FEValues<dim> fe_values(fe,
@@ -321,13 +662,6 @@ namespace Solid
                                        update_values | update_normal_vectors |
                                          update_JxW_values);
 
-      std::vector<std::vector<Tensor<1, dim>>> phi(
-        n_q_points, std::vector<Tensor<1, dim>>(dofs_per_cell));
-      std::vector<std::vector<Tensor<2, dim>>> grad_phi(
-        n_q_points, std::vector<Tensor<2, dim>>(dofs_per_cell));
-      std::vector<std::vector<SymmetricTensor<2, dim>>> sym_grad_phi(
-        n_q_points, std::vector<SymmetricTensor<2, dim>>(dofs_per_cell));
-
       FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
       FullMatrix<double> local_mass(dofs_per_cell, dofs_per_cell);
       Vector<double> local_rhs(dofs_per_cell);
@@ -339,6 +673,110 @@ namespace Solid
           gravity[i] = parameters.gravity[i];
         }
 
+      // The volume terms of a cell in a kernel for n dofs per cell, whose
+      // arrays are on the stack and whose loops have constant bounds unless
+      // n is 0, see Utils::dispatch_dofs_per_cell.
+      auto assemble_volume = [&](auto n_dofs, const unsigned int first_point) {
+        constexpr unsigned int n = decltype(n_dofs)::value;
+        const unsigned int n_cell_dofs = Utils::cell_size<n>(dofs_per_cell);
+        Utils::CellArray<Tensor<1, dim>, n> phi(dofs_per_cell);
+        Utils::CellArray<Tensor<2, dim>, n> grad_phi(dofs_per_cell);
+        Utils::CellArray<SymmetricTensor<2, dim>, n> sym_grad_phi(
+          dofs_per_cell);
+        Utils::CellArray<SymmetricTensor<2, dim>, n> Jc_sym_grad_phi(
+          dofs_per_cell);
+        Utils::CellArray<unsigned int, n> components(dofs_per_cell);
+        Utils::CellArray<double, n * n> matrix(dofs_per_cell * dofs_per_cell);
+        std::fill(matrix.begin(), matrix.end(), 0.0);
+        for (unsigned int k = 0; k < n_cell_dofs; ++k)
+          {
+            components[k] = fe.system_to_component_index(k).first;
+          }
+
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            const unsigned int point = first_point + q;
+            const Tensor<2, dim> F_inv = quad_point_history.get_F_inv(point);
+            for (unsigned int k = 0; k < n_cell_dofs; ++k)
+              {
+                phi[k] = fe_values[displacement].value(k, q);
+                grad_phi[k] = fe_values[displacement].gradient(k, q) * F_inv;
+                sym_grad_phi[k] = symmetrize(grad_phi[k]);
+              }
+
+            const SymmetricTensor<2, dim> tau =
+              quad_point_history.get_tau(point);
+            const SymmetricTensor<4, dim> &Jc =
+              quad_point_history.get_Jc(point);
+            const double rho = quad_point_history.get_density();
+            const double dt = time.get_delta_t();
+            const double JxW = fe_values.JxW(q);
+
+            if (!initial_step && assemble_matrix)
+              {
+                // Contract the tangent once per shape function rather
+                // than once per pair of them.
+                for (unsigned int k = 0; k < n_cell_dofs; ++k)
+                  {
+                    Jc_sym_grad_phi[k] = Jc * sym_grad_phi[k];
+                  }
+              }
+
+            for (unsigned int i = 0; i < n_cell_dofs; ++i)
+              {
+                double *row = &matrix[i * n_cell_dofs];
+                for (unsigned int j = 0; j <= i; ++j)
+                  {
+                    if (initial_step)
+                      {
+                        row[j] += rho * phi[i] * phi[j] * JxW;
+                      }
+                    else if (assemble_matrix)
+                      {
+                        row[j] += (phi[i] * phi[j] * rho / (beta * dt * dt) +
+                                   sym_grad_phi[i] * Jc_sym_grad_phi[j]) *
+                                  JxW;
+                        if (components[i] == components[j])
+                          {
+                            row[j] += grad_phi[i][components[i]] * tau *
+                                      grad_phi[j][components[j]] * JxW;
+                          }
+                      }
+                  }
+                local_rhs(i) -= sym_grad_phi[i] * tau * JxW; // -internal force
+                // body force
+                local_rhs(i) += phi[i] * gravity * rho * JxW;
+              }
+          }
+
+        // Only the lower triangle has been assembled.
+        FullMatrix<double> &cell_matrix =
+          initial_step ? local_mass : local_matrix;
+        for (unsigned int i = 0; i < n_cell_dofs; ++i)
+          {
+            for (unsigned int j = 0; j <= i; ++j)
+              {
+                cell_matrix(i, j) = matrix[i * n_cell_dofs + j];
+                cell_matrix(j, i) = matrix[i * n_cell_dofs + j];
+              }
+          }
+      };
+
+      std::vector<std::vector<Tensor<1, dim>>> fsi_stress_rows_values(dim);
+      for (unsigned int d = 0; d < dim; ++d)
+        {
+          fsi_stress_rows_values[d].resize(n_f_q_points);
+        }
+      // The FSI traction is evaluated in the current configuration, which
+      // needs the displacement of the vertices on the ghost dofs too.
+      PETScWrappers::MPI::Vector relevant_displacement;
+      if (parameters.simulation_type == "FSI")
+        {
+          relevant_displacement.reinit(
+            locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
+          relevant_displacement = current_displacement;
+        }
+
       for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
            ++cell)
         {
@@ -351,100 +789,32 @@ namespace Solid
           local_matrix = 0;
           local_rhs = 0;
 
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
-
-          for (unsigned int q = 0; q < n_q_points; ++q)
-            {
-              const Tensor<2, dim> F_inv = lqph[q]->get_F_inv();
-              for (unsigned int k = 0; k < dofs_per_cell; ++k)
-                {
-                  phi[q][k] = fe_values[displacement].value(k, q);
-                  grad_phi[q][k] =
-                    fe_values[displacement].gradient(k, q) * F_inv;
-                  sym_grad_phi[q][k] = symmetrize(grad_phi[q][k]);
-                }
-
-              const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-              const SymmetricTensor<4, dim> Jc = lqph[q]->get_Jc();
-              const double rho = lqph[q]->get_density();
-              const double dt = time.get_delta_t();
-              const double JxW = fe_values.JxW(q);
-
-              for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                {
-                  const unsigned int component_i =
-                    fe.system_to_component_index(i).first;
-                  for (unsigned int j = 0; j <= i; ++j)
-                    {
-                      if (initial_step)
-                        {
-                          local_mass(i, j) += rho * phi[q][i] * phi[q][j] * JxW;
-                        }
-                      else
-                        {
-                          const unsigned int component_j =
-                            fe.system_to_component_index(j).first;
-                          local_matrix(i, j) +=
-                            (phi[q][i] * phi[q][j] * rho / (beta * dt * dt) +
-                             sym_grad_phi[q][i] * Jc * sym_grad_phi[q][j]) *
-                            JxW;
-                          if (component_i == component_j)
-                            {
-                              local_matrix(i, j) +=
-                                grad_phi[q][i][component_i] * tau *
-                                grad_phi[q][j][component_j] * JxW;
-                            }
-                        }
-                    }
-                  local_rhs(i) -=
-                    sym_grad_phi[q][i] * tau * JxW; // -internal force
-                  // body force
-                  local_rhs[i] += phi[q][i] * gravity * rho * fe_values.JxW(q);
-                }
-            }
-
-          for (unsigned int i = 0; i < dofs_per_cell; ++i)
-            {
-              for (unsigned int j = i + 1; j < dofs_per_cell; ++j)
-                {
-                  local_matrix(i, j) = local_matrix(j, i);
-                  if (initial_step)
-                    {
-                      local_mass(i, j) = local_mass(j, i);
-                    }
-                }
-            }
+          const unsigned int first_point =
+            quad_point_history.begin(cell->active_cell_index());
+          Utils::dispatch_dofs_per_cell<
+            Utils::lagrange_dofs_per_cell(dim, 1, dim),
+            Utils::lagrange_dofs_per_cell(dim, 2, dim)>(
+            dofs_per_cell,
+            [&](auto n_dofs) { assemble_volume(n_dofs, first_point); });
 
           // Neumann boundary conditions
           // If this is a stand-alone solid simulation, the Neumann boundary
           // type should be either Traction or Pressure; it this is a FSI
           // simulation, the Neumann boundary type must be FSI.
 
-          for (unsigned int face = 0; face < GeometryInfo<dim>::faces_per_cell;
-               ++face)
+          for (const auto &neumann_face :
+               neumann_faces(cell->active_cell_index()))
             {
-              unsigned int id = cell->face(face)->boundary_id();
+              const unsigned int face = neumann_face.face;
+              unsigned int id = neumann_face.boundary_id;
 
-              if (!cell->face(face)->at_boundary() ||
-                  parameters.solid_dirichlet_bcs.find(id) !=
-                    parameters.solid_dirichlet_bcs.end())
+              if (parameters.solid_dirichlet_bcs.find(id) !=
+                  parameters.solid_dirichlet_bcs.end())
                 {
                   // Not a Neumann boundary
                   continue;
                 }
 
-              if (parameters.simulation_type != "FSI" &&
-                  parameters.solid_neumann_bcs.find(id) ==
-                    parameters.solid_neumann_bcs.end())
-                {
-                  // Traction-free boundary, do nothing
-                  continue;
-                }
-
-              fe_face_values.reinit(cell, face);
-
               Tensor<1, dim> traction;
               std::vector<double> prescribed_value;
               if (parameters.simulation_type != "FSI")
@@ -463,6 +833,52 @@ namespace Solid
                     }
                 }
 
+              // Get FSI stress values on face quadrature points
+              std::vector<Tensor<2, dim>> fsi_stress(n_f_q_points);
+              if (parameters.simulation_type == "FSI")
+                {
+                  std::vector<Point<dim>> vertex_displacement(
+                    GeometryInfo<dim>::vertices_per_face);
+                  for (unsigned int v = 0;
+                       v < GeometryInfo<dim>::vertices_per_face;
+                       ++v)
+                    {
+                      for (unsigned int d = 0; d < dim; ++d)
+                        {
+                          vertex_displacement[v][d] = relevant_displacement(
+                            cell->face(face)->vertex_dof_index(v, d));
+                        }
+                      cell->face(face)->vertex(v) += vertex_displacement[v];
+                    }
+                  fe_face_values.reinit(cell, face);
+                  for (unsigned int d = 0; d < dim; ++d)
+                    {
+                      fe_face_values[displacement].get_function_values(
+                        fsi_stress_rows[d], fsi_stress_rows_values[d]);
+                    }
+                  for (unsigned int v = 0;
+                       v < GeometryInfo<dim>::vertices_per_face;
+                       ++v)
+                    {
+                      cell->face(face)->vertex(v) -= vertex_displacement[v];
+                    }
+                  for (unsigned int q = 0; q < n_f_q_points; ++q)
+                    {
+                      for (unsigned int d1 = 0; d1 < dim; ++d1)
+                        {
+                          for (unsigned int d2 = 0; d2 < dim; ++d2)
+                            {
+                              fsi_stress[q][d1][d2] =
+                                fsi_stress_rows_values[d1][q][d2];
+                            }
+                        }
+                    } // End looping quadrature points
+                }
+              else
+                {
+                  fe_face_values.reinit(cell, face);
+                }
+
               for (unsigned int q = 0; q < n_f_q_points; ++q)
                 {
                   if (parameters.simulation_type != "FSI" &&
@@ -472,6 +888,11 @@ namespace Solid
                       traction = fe_face_values.normal_vector(q);
                       traction *= prescribed_value[0];
                     }
+                  else if (parameters.simulation_type == "FSI")
+                    {
+                      traction =
+                        fsi_stress[q] * fe_face_values.normal_vector(q);
+                    }
                   for (unsigned int j = 0; j < dofs_per_cell; ++j)
                     {
                       const unsigned int component_j =
@@ -492,7 +913,7 @@ namespace Solid
                                                      mass_matrix,
                                                      system_rhs);
             }
-          else
+          else if (assemble_matrix)
             {
               constraints.distribute_local_to_global(local_matrix,
                                                      local_rhs,
@@ -500,13 +921,18 @@ namespace Solid
                                                      system_matrix,
                                                      system_rhs);
             }
+          else
+            {
+              constraints.distribute_local_to_global(
+                local_rhs, local_dof_indices, system_rhs);
+            }
         }
 
       if (initial_step)
         {
           mass_matrix.compress(VectorOperation::add);
         }
-      else
+      else if (assemble_matrix)
         {
           system_matrix.compress(VectorOperation::add);
         }
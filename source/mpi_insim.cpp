@@ -6,8 +6,8 @@ namespace Fluid
   {
     /**
      * In serial code, we initialize the direct solver in the constructor
-     * to avoid repeatedly allocating memory. However it seems we can't
-     * do the same thing to the PETSc direct solver.
+     * to avoid repeatedly allocating memory. Here the factorization is
+     * passed in instead, because it is kept across the preconditioners.
      */
     template <int dim>
     InsIM<dim>::BlockSchurPreconditioner::BlockSchurPreconditioner(
@@ -19,16 +19,28 @@ namespace Fluid
       const std::vector<IndexSet> &owned_partitioning,
       const PETScWrappers::MPI::BlockSparseMatrix &system,
       const PETScWrappers::MPI::BlockSparseMatrix &mass,
-      PETScWrappers::MPI::BlockSparseMatrix &schur)
+      PETScWrappers::MPI::BlockSparseMatrix &schur,
+      const PETScWrappers::MPI::BlockSparseMatrix &convection,
+      Utils::VectorPool &workspace,
+      const Parameters::AllParameters &parameters,
+      bool mixed_precision,
+      const PreconditionMUMPS &A_inverse)
       : timer2(timer2),
         gamma(gamma),
         viscosity(viscosity),
         rho(rho),
         dt(dt),
+        mass_tolerance(parameters.fluid_mass_tolerance),
+        schur_tolerance(parameters.fluid_schur_tolerance),
+        krylov_method(parameters.fluid_inner_krylov),
         system_matrix(&system),
         mass_matrix(&mass),
         mass_schur(&schur),
-        A_inverse(dummy_sc, system_matrix->get_mpi_communicator())
+        pcd(parameters.fluid_schur_approximation == "pcd"),
+        pressure_convection(&convection),
+        workspace(&workspace),
+        A_inverse(&A_inverse),
+        mixed_precision(mixed_precision)
     {
       TimerOutput::Scope timer_section(timer2, "CG for Sm");
       // The sparsity pattern of mass_schur is already set,
@@ -45,8 +57,37 @@ namespace Fluid
       jacobi.vmult(tmp2.block(0), tmp1.block(0));
       // The sparsity pattern has already been set correctly, so explicitly
       // tell mmult not to rebuild the sparsity pattern.
-      system_matrix->block(1, 0).mmult(
-        mass_schur->block(1, 1), system_matrix->block(0, 1), tmp2.block(0));
+      if (!parameters.fluid_stabilization)
+        {
+          system_matrix->block(1, 0).mmult(
+            mass_schur->block(1, 1), system_matrix->block(0, 1), tmp2.block(0));
+        }
+      else
+        {
+          // The stabilization terms make the off-diagonal blocks differ, so
+          // the plain divergence is taken from the mass matrix. The pressure
+          // block \f$-C\f$ of the system adds \f$\frac{\rho}{\Delta{t}}C\f$
+          // to \f$S_m\f$, as \f$S \approx -\frac{\Delta{t}}{\rho}S_m - C\f$.
+          mass_matrix->block(1, 0).mmult(
+            mass_schur->block(1, 1), mass_matrix->block(0, 1), tmp2.block(0));
+          mass_schur->block(1, 1).add(-rho / dt, system_matrix->block(1, 1));
+        }
+      if (mixed_precision)
+        {
+          Mp_single.reinit(mass_matrix->block(1, 1));
+          Sm_single.reinit(mass_schur->block(1, 1));
+        }
+      else
+        {
+          Mp_preconditioner.initialize(
+            PreconditionSelector::choose(
+              parameters.fluid_mass_preconditioner, "none"),
+            mass_matrix->block(1, 1));
+          Sm_preconditioner.initialize(
+            PreconditionSelector::choose(
+              parameters.fluid_schur_preconditioner, "none"),
+            mass_schur->block(1, 1));
+        }
     }
 
     /**
@@ -58,85 +99,132 @@ namespace Fluid
       PETScWrappers::MPI::BlockVector &dst,
       const PETScWrappers::MPI::BlockVector &src) const
     {
-      // First, buffer the velocity block of src vector (\f$v_0\f$).
-      PETScWrappers::MPI::Vector utmp(src.block(0));
-      PETScWrappers::MPI::Vector tmp(src.block(1));
-      tmp = 0;
       // This function is part of "solve linear system", but it
       // is further profiled to get a better idea of how time
       // is spent on different solvers.
-      // The next two blocks computes \f$u_1 = \tilde{S}^{-1} v_1\f$.
-      {
-        TimerOutput::Scope timer_section(timer2, "CG for Mp");
-
-        // CG solver used for \f$M_p^{-1}\f$ and \f$S_m^{-1}\f$.
-        SolverControl solver_control(
-          src.block(1).size(), std::max(1e-10, 1e-6 * src.block(1).l2_norm()));
-        PETScWrappers::SolverCG cg_mp(solver_control,
-                                      mass_schur->get_mpi_communicator());
-
-        // \f$-(\mu + \gamma\rho)M_p^{-1}v_1\f$
-        PETScWrappers::PreconditionNone Mp_preconditioner;
-        Mp_preconditioner.initialize(mass_matrix->block(1, 1));
-        cg_mp.solve(
-          mass_matrix->block(1, 1), tmp, src.block(1), Mp_preconditioner);
-        tmp *= -(viscosity + gamma * rho);
-      }
-
-      {
-        TimerOutput::Scope timer_section(timer2, "CG for Sm");
-        SolverControl solver_control(
-          src.block(1).size(), std::max(1e-10, 1e-3 * src.block(1).l2_norm()));
-        // FIXME: There is a mysterious bug here. After refine_mesh is called,
-        // the initialization of Sm_preconditioner will complain about zero
-        // entries on the diagonal which causes division by 0 since
-        // PreconditionBlockJacobi uses ILU(0) underneath. This is similar to
-        // the serial code where SparseILU is used. However, 1. if we do not use
-        // a preconditioner here, the code runs fine, suggesting that mass_schur
-        // is correct; 2. if we do not call refine_mesh, the code also runs
-        // fine. So the question is, why would refine_mesh generate diagonal
-        // zeros?
-        //
-        // \f$-\frac{1}{dt}S_m^{-1}v_1\f$
-        PETScWrappers::PreconditionNone Sm_preconditioner;
-        Sm_preconditioner.initialize(mass_schur->block(1, 1));
-        PETScWrappers::SolverCG cg_sm(solver_control,
-                                      mass_schur->get_mpi_communicator());
-        cg_sm.solve(mass_schur->block(1, 1),
-                    dst.block(1),
-                    src.block(1),
-                    Sm_preconditioner);
-        dst.block(1) *= -rho / dt;
-        // Adding up these two, we get \f$\tilde{S}^{-1}v_1\f$.
-        dst.block(1) += tmp;
-      }
+      Utils::CounterRegion counter_region("Block Schur vmult");
+      schur_vmult(dst.block(1), src.block(1));
 
       // This block computes \f$v_0 - B^T\tilde{S}^{-1}v_1\f$ based on
       // \f$u_1\f$.
+      Utils::VectorPool::Handle utmp(*workspace, 0);
       {
-        system_matrix->block(0, 1).vmult(utmp, dst.block(1));
-        utmp *= -1.0;
-        utmp += src.block(0);
+        system_matrix->block(0, 1).vmult(*utmp, dst.block(1));
+        *utmp *= -1.0;
+        *utmp += src.block(0);
       }
 
       // Finally, compute the product of \f$\tilde{A}^{-1}\f$ and utmp with
       // the direct solver.
       {
         TimerOutput::Scope timer_section(timer2, "MUMPS for A_inv");
-        A_inverse.solve(system_matrix->block(0, 0), dst.block(0), utmp);
+        A_inverse->vmult(dst.block(0), *utmp);
       }
     }
 
+    template <int dim>
+    void InsIM<dim>::BlockSchurPreconditioner::schur_vmult(
+      PETScWrappers::MPI::Vector &dst,
+      const PETScWrappers::MPI::Vector &src) const
+    {
+      Utils::VectorPool::Handle tmp(*workspace, 1);
+      *tmp = 0;
+      if (pcd)
+        {
+          // \f$y = S_m^{-1}v_1\f$ first, as \f$F_p\f$ is applied to it.
+          solve_sm(dst, src);
+          // \f$-M_p^{-1}((\mu + \gamma\rho)v_1 + N_py)\f$, since
+          // \f$M_p^{-1}(\mu + \gamma\rho)S_my\f$ is just the first term.
+          Utils::VectorPool::Handle rhs(*workspace, 1);
+          pressure_convection->block(1, 1).vmult(*rhs, dst);
+          rhs->add(viscosity + gamma * rho, src);
+          solve_mp(*tmp, *rhs);
+          // Adding \f$-\frac{\rho}{\Delta{t}}y\f$, we get
+          // \f$\tilde{S}^{-1}v_1\f$.
+          dst.sadd(-rho / dt, -1.0, *tmp);
+          return;
+        }
+
+      // The next two blocks computes \f$u_1 = \tilde{S}^{-1} v_1\f$.
+      // \f$-(\mu + \gamma\rho)M_p^{-1}v_1\f$
+      solve_mp(*tmp, src);
+      *tmp *= -(viscosity + gamma * rho);
+
+      // \f$-\frac{1}{dt}S_m^{-1}v_1\f$
+      solve_sm(dst, src);
+      dst *= -rho / dt;
+      // Adding up these two, we get \f$\tilde{S}^{-1}v_1\f$.
+      dst += *tmp;
+    }
+
+    template <int dim>
+    void InsIM<dim>::BlockSchurPreconditioner::solve_mp(
+      PETScWrappers::MPI::Vector &dst,
+      const PETScWrappers::MPI::Vector &src) const
+    {
+      TimerOutput::Scope timer_section(timer2, "CG for Mp");
+
+      // CG solver used for \f$M_p^{-1}\f$ and \f$S_m^{-1}\f$.
+      const double mp_tolerance =
+        std::max(1e-10, mass_tolerance * src.l2_norm());
+      if (mixed_precision)
+        {
+          Mp_single.solve(dst, src, mp_tolerance);
+        }
+      else
+        {
+          SolverControl solver_control(src.size(), mp_tolerance);
+          Utils::SolverKrylov cg_mp(
+            solver_control, mass_schur->get_mpi_communicator(), krylov_method);
+          cg_mp.solve(mass_matrix->block(1, 1), dst, src, Mp_preconditioner);
+        }
+    }
+
+    template <int dim>
+    void InsIM<dim>::BlockSchurPreconditioner::solve_sm(
+      PETScWrappers::MPI::Vector &dst,
+      const PETScWrappers::MPI::Vector &src) const
+    {
+      TimerOutput::Scope timer_section(timer2, "CG for Sm");
+      SolverControl solver_control(
+        src.size(), std::max(1e-10, schur_tolerance * src.l2_norm()));
+      // FIXME: There is a mysterious bug here. After refine_mesh is called,
+      // the initialization of Sm_preconditioner will complain about zero
+      // entries on the diagonal which causes division by 0 since
+      // PreconditionBlockJacobi uses ILU(0) underneath. This is similar to
+      // the serial code where SparseILU is used. However, 1. if we do not use
+      // a preconditioner here, the code runs fine, suggesting that mass_schur
+      // is correct; 2. if we do not call refine_mesh, the code also runs
+      // fine. So the question is, why would refine_mesh generate diagonal
+      // zeros?
+      if (mixed_precision)
+        {
+          Sm_single.solve(dst, src, solver_control.tolerance());
+        }
+      else
+        {
+          Utils::SolverKrylov cg_sm(
+            solver_control, mass_schur->get_mpi_communicator(), krylov_method);
+          cg_sm.solve(mass_schur->block(1, 1), dst, src, Sm_preconditioner);
+        }
+    }
+
     template <int dim>
     InsIM<dim>::InsIM(parallel::distributed::Triangulation<dim> &tria,
                       const Parameters::AllParameters &parameters)
-      : FluidSolver<dim>(tria, parameters)
+      : FluidSolver<dim>(tria, parameters),
+        last_gmres_iterations(0),
+        forcing(parameters.fluid_max_forcing)
     {
-      Assert(
-        parameters.fluid_velocity_degree - parameters.fluid_pressure_degree ==
-          1,
-        ExcMessage(
-          "Velocity finite element should be one order higher than pressure!"));
+      Assert(parameters.fluid_stabilization
+               ? parameters.fluid_velocity_degree ==
+                   parameters.fluid_pressure_degree
+               : parameters.fluid_velocity_degree -
+                     parameters.fluid_pressure_degree ==
+                   1,
+             ExcMessage("Velocity finite element should be one order higher "
+                        "than pressure, or of the same order with the "
+                        "equal-order stabilization!"));
     }
 
     template <int dim>
@@ -144,6 +232,9 @@ namespace Fluid
     {
       FluidSolver<dim>::initialize_system();
       preconditioner.reset();
+      // The sparsity pattern has changed.
+      A_inverse.clear();
+      fieldsplit.reset();
       newton_update.reinit(owned_partitioning, mpi_communicator);
       evaluation_point.reinit(
         owned_partitioning, relevant_partitioning, mpi_communicator);
@@ -153,6 +244,7 @@ namespace Fluid
     void InsIM<dim>::assemble(const bool use_nonzero_constraints)
     {
       TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::CounterRegion counter_region("Assemble system");
 
       const double viscosity = parameters.viscosity;
       const double gamma = parameters.grad_div;
@@ -163,16 +255,12 @@ namespace Fluid
       system_matrix = 0;
       mass_matrix = 0;
       system_rhs = 0;
-
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_quadrature_points |
-                                update_JxW_values | update_gradients);
-      FEFaceValues<dim> fe_face_values(fe,
-                                       face_quad_formula,
-                                       update_values | update_normal_vectors |
-                                         update_quadrature_points |
-                                         update_JxW_values);
+      const bool assemble_pcd = parameters.fluid_schur_approximation == "pcd";
+      if (assemble_pcd)
+        {
+          pressure_convection = 0;
+        }
+      const bool stabilized = parameters.fluid_stabilization;
 
       const unsigned int dofs_per_cell = fe.dofs_per_cell;
       const unsigned int u_dofs = fe.base_element(0).dofs_per_cell;
@@ -183,214 +271,417 @@ namespace Fluid
       AssertThrow(u_dofs * dim + p_dofs == dofs_per_cell,
                   ExcMessage("Wrong partitioning of dofs!"));
 
-      const FEValuesExtractors::Vector velocities(0);
-      const FEValuesExtractors::Scalar pressure(dim);
-
-      FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-      FullMatrix<double> local_mass_matrix(dofs_per_cell, dofs_per_cell);
-      Vector<double> local_rhs(dofs_per_cell);
-
-      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-      std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-      std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-      std::vector<double> current_pressure_values(n_q_points);
-      std::vector<Tensor<1, dim>> present_velocity_values(n_q_points);
-      std::vector<Tensor<1, dim>> fsi_acc_values(n_q_points);
-
-      std::vector<double> div_phi_u(dofs_per_cell);
-      std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-      std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-      std::vector<double> phi_p(dofs_per_cell);
-
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
+      // The cell dofs of the pressure in the order of its element, which
+      // index the local matrix of the pressure convection.
+      std::vector<unsigned int> pressure_dofs(p_dofs);
+      for (unsigned int k = 0; k < dofs_per_cell; ++k)
         {
-          if (cell->is_locally_owned())
+          const auto base = fe.system_to_base_index(k);
+          if (base.first.first == 1)
             {
-              auto p = cell_property.get_data(cell);
-
-              fe_values.reinit(cell);
-
-              local_matrix = 0;
-              local_mass_matrix = 0;
-              local_rhs = 0;
-
-              fe_values[velocities].get_function_values(
-                evaluation_point, current_velocity_values);
-
-              fe_values[velocities].get_function_gradients(
-                evaluation_point, current_velocity_gradients);
-
-              fe_values[pressure].get_function_values(evaluation_point,
-                                                      current_pressure_values);
-
-              fe_values[velocities].get_function_values(
-                present_solution, present_velocity_values);
-
-              fe_values[velocities].get_function_values(fsi_acceleration,
-                                                        fsi_acc_values);
-
-              // Assemble the system matrix and mass matrix simultaneouly.
-              // The mass matrix only uses the (0, 0) and (1, 1) blocks.
-              //
-              for (unsigned int q = 0; q < n_q_points; ++q)
-                {
-                  const int ind = p[0]->indicator;
-                  const double rho = parameters.fluid_rho;
-                  for (unsigned int k = 0; k < dofs_per_cell; ++k)
-                    {
-                      div_phi_u[k] = fe_values[velocities].divergence(k, q);
-                      grad_phi_u[k] = fe_values[velocities].gradient(k, q);
-                      phi_u[k] = fe_values[velocities].value(k, q);
-                      phi_p[k] = fe_values[pressure].value(k, q);
-                    }
+              pressure_dofs[base.second] = k;
+            }
+        }
 
-                  for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                    {
-                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                        {
-                          // Let the linearized diffusion, continuity and
-                          // Grad-Div
-                          // term be written as
-                          // the bilinear operator: \f$A = a((\delta{u},
-                          // \delta{p}), (\delta{v}, \delta{q}))\f$,
-                          // the linearized convection term be: \f$C =
-                          // c(u;\delta{u}, \delta{v})\f$,
-                          // and the linearized inertial term be:
-                          // \f$M = m(\delta{u}, \delta{v})$, then LHS is: $(A +
-                          // C) + M/{\Delta{t}}\f$
-                          local_matrix(i, j) +=
-                            (viscosity *
-                               scalar_product(grad_phi_u[j], grad_phi_u[i]) +
-                             current_velocity_gradients[q] * phi_u[j] *
-                               phi_u[i] * rho +
-                             grad_phi_u[j] * current_velocity_values[q] *
-                               phi_u[i] * rho -
-                             div_phi_u[i] * phi_p[j] - phi_p[i] * div_phi_u[j] +
-                             gamma * div_phi_u[j] * div_phi_u[i] * rho +
-                             phi_u[i] * phi_u[j] / time.get_delta_t() * rho) *
-                            fe_values.JxW(q);
-                          local_mass_matrix(i, j) +=
-                            (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
-                            fe_values.JxW(q);
-                        }
+      const FEValuesExtractors::Vector velocities(0);
 
-                      // RHS is \f$-(A_{current} + C_{current}) -
-                      // M_{present-current}/\Delta{t}\f$.
-                      double current_velocity_divergence =
-                        trace(current_velocity_gradients[q]);
-                      local_rhs(i) +=
-                        ((-viscosity *
-                            scalar_product(current_velocity_gradients[q],
-                                           grad_phi_u[i]) -
-                          current_velocity_gradients[q] *
-                            current_velocity_values[q] * phi_u[i] * rho +
-                          current_pressure_values[q] * div_phi_u[i] +
-                          current_velocity_divergence * phi_p[i] -
-                          gamma * current_velocity_divergence * div_phi_u[i] *
-                            rho) -
-                         (current_velocity_values[q] -
-                          present_velocity_values[q]) *
-                           phi_u[i] / time.get_delta_t() * rho +
-                         gravity * phi_u[i] * rho) *
-                        fe_values.JxW(q);
-                      if (ind == 1)
-                        {
-                          local_rhs(i) +=
-                            (scalar_product(grad_phi_u[i], p[0]->fsi_stress) +
-                             (fsi_acc_values[q] * rho * phi_u[i])) *
-                            fe_values.JxW(q);
-                        }
-                    }
-                }
+      // The cell loop runs on WorkStream, see assemble_cells.
+      auto local_assemble =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            AssemblyScratchData &scratch,
+            AssemblyCopyData &data) {
+          FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+          auto &local_matrix = data.local_matrix;
+          auto &local_mass_matrix = data.local_mass_matrix;
+          auto &local_rhs = data.local_rhs;
+          auto &current_velocity_values = scratch.current_velocity_values;
+          auto &current_velocity_gradients = scratch.current_velocity_gradients;
+          auto &current_pressure_values = scratch.current_pressure_values;
+          auto &present_velocity_values = scratch.present_velocity_values;
+          auto &fsi_acc_values = scratch.fsi_acc_values;
+          auto &div_phi_u = scratch.div_phi_u;
+          auto &phi_u = scratch.phi_u;
+          auto &grad_phi_u = scratch.grad_phi_u;
+          auto &phi_p = scratch.phi_p;
+          auto &grad_phi_p = scratch.grad_phi_p;
+          auto &current_pressure_gradients = scratch.current_pressure_gradients;
+          auto &weights = scratch.stabilization_weights;
+          auto &residuals = scratch.stabilization_residuals;
+          auto &local_pressure_convection = data.local_pressure_convection;
+
+          const unsigned int cell_index = cell->active_cell_index();
+          const SymmetricTensor<2, dim> &fsi_stress =
+            cell_property.fsi_stress[cell_index];
+
+          scratch.reinit(cell);
+
+          local_matrix = 0;
+          local_mass_matrix = 0;
+          local_rhs = 0;
+          if (assemble_pcd)
+            {
+              local_pressure_convection.reinit(p_dofs, p_dofs);
+              data.local_pressure_dof_indices.resize(p_dofs);
+            }
 
-              // Impose pressure boundary here if specified, loop over faces on
-              // the
-              // cell
-              // and apply pressure boundary conditions:
-              // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
-              if (parameters.n_fluid_neumann_bcs != 0)
+          {
+            std::lock_guard<std::mutex> lock(assembly_mutex);
+            scratch.get_velocity_values(
+              evaluation_point, current_velocity_values);
+
+            scratch.get_velocity_gradients(
+              evaluation_point, current_velocity_gradients);
+
+            scratch.get_pressure_values(
+              evaluation_point, current_pressure_values);
+
+            if (stabilized)
+              {
+                scratch.get_pressure_gradients(evaluation_point,
+                                               current_pressure_gradients);
+              }
+
+            scratch.get_velocity_values(
+              present_solution, present_velocity_values);
+
+            scratch.get_velocity_values(fsi_acceleration, fsi_acc_values);
+          }
+
+          const double h = stabilized ? cell->diameter() : 0.0;
+
+          // The volume terms in a kernel for n dofs per cell, whose loops
+          // have constant bounds unless n is 0, see
+          // Utils::dispatch_dofs_per_cell.
+          auto assemble_volume = [&](auto n_dofs) {
+            const unsigned int n_cell_dofs =
+              Utils::cell_size<decltype(n_dofs)::value>(dofs_per_cell);
+            // Assemble the system matrix and mass matrix simultaneouly.
+            // The mass matrix only uses the (0, 0) and (1, 1) blocks, and
+            // the divergence in the (0, 1) and (1, 0) blocks if it is
+            // stabilized.
+            //
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              {
+                const int ind = cell_property.indicator[cell_index];
+                const double rho = parameters.fluid_rho;
+                for (unsigned int k = 0; k < n_cell_dofs; ++k)
+                  {
+                    div_phi_u[k] = scratch.velocity_divergence(k, q);
+                    grad_phi_u[k] = scratch.velocity_gradient(k, q);
+                    phi_u[k] = scratch.velocity_value(k, q);
+                    phi_p[k] = scratch.pressure_value(k, q);
+                    if (assemble_pcd || stabilized)
+                      {
+                        grad_phi_p[k] = scratch.pressure_gradient(k, q);
+                      }
+                  }
+
+                // The momentum residual of the PSPG and SUPG terms
+                // \f$\sum_K(\tau(\rho u\cdot\nabla{v} -
+                // \frac{1}{\rho}\nabla{q}), R_m)_K\f$ with
+                // \f$R_m = \rho\frac{u - u^n}{\Delta{t}} +
+                // \rho(u\cdot\nabla)u + \nabla{p} - \rho g - \rho a_{fsi}\f$,
+                // whose viscous term vanishes with linear elements.
+                // \f$\tau\f$ and the SUPG velocity are not linearized.
+                Tensor<1, dim> momentum_residual;
+                if (stabilized)
+                  {
+                    const Tensor<1, dim> &u = current_velocity_values[q];
+                    const double tau = stabilization_parameter(u, h);
+                    momentum_residual =
+                      (u - present_velocity_values[q]) * rho /
+                        time.get_delta_t() +
+                      current_velocity_gradients[q] * u * rho +
+                      current_pressure_gradients[q] - gravity * rho;
+                    if (ind == 1)
+                      {
+                        momentum_residual -= fsi_acc_values[q] * rho;
+                      }
+                    for (unsigned int k = 0; k < n_cell_dofs; ++k)
+                      {
+                        weights[k] =
+                          tau * (grad_phi_u[k] * u * rho - grad_phi_p[k] / rho);
+                        residuals[k] =
+                          phi_u[k] * rho / time.get_delta_t() +
+                          grad_phi_u[k] * u * rho +
+                          current_velocity_gradients[q] * phi_u[k] * rho +
+                          grad_phi_p[k];
+                      }
+                  }
+
+                // The pressure convection \f$N_p\f$ of the PCD Schur
+                // approximation, with the convection term of the velocity
+                // block.
+                if (assemble_pcd)
+                  {
+                    for (unsigned int i = 0; i < p_dofs; ++i)
+                      {
+                        for (unsigned int j = 0; j < p_dofs; ++j)
+                          {
+                            local_pressure_convection(i, j) +=
+                              grad_phi_p[pressure_dofs[j]] *
+                              current_velocity_values[q] *
+                              phi_p[pressure_dofs[i]] * rho * scratch.JxW(q);
+                          }
+                      }
+                  }
+
+                for (unsigned int i = 0; i < n_cell_dofs; ++i)
+                  {
+                    for (unsigned int j = 0; j < n_cell_dofs; ++j)
+                      {
+                        // Let the linearized diffusion, continuity and
+                        // Grad-Div
+                        // term be written as
+                        // the bilinear operator: \f$A = a((\delta{u},
+                        // \delta{p}), (\delta{v}, \delta{q}))\f$,
+                        // the linearized convection term be: \f$C =
+                        // c(u;\delta{u}, \delta{v})\f$,
+                        // and the linearized inertial term be:
+                        // \f$M = m(\delta{u}, \delta{v})$, then LHS is: $(A +
+                        // C) + M/{\Delta{t}}\f$
+                        local_matrix(i, j) +=
+                          (viscosity *
+                             scalar_product(grad_phi_u[j], grad_phi_u[i]) +
+                           current_velocity_gradients[q] * phi_u[j] *
+                             phi_u[i] * rho +
+                           grad_phi_u[j] * current_velocity_values[q] *
+                             phi_u[i] * rho -
+                           div_phi_u[i] * phi_p[j] - phi_p[i] * div_phi_u[j] +
+                           gamma * div_phi_u[j] * div_phi_u[i] * rho +
+                           phi_u[i] * phi_u[j] / time.get_delta_t() * rho) *
+                          scratch.JxW(q);
+                        local_mass_matrix(i, j) +=
+                          (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
+                          scratch.JxW(q);
+                        if (stabilized)
+                          {
+                            local_matrix(i, j) +=
+                              weights[i] * residuals[j] * scratch.JxW(q);
+                            // The unstabilized \f$B\f$ for \f$S_m\f$.
+                            local_mass_matrix(i, j) -=
+                              (div_phi_u[i] * phi_p[j] +
+                               phi_p[i] * div_phi_u[j]) *
+                              scratch.JxW(q);
+                          }
+                      }
+                    if (stabilized)
+                      {
+                        local_rhs(i) -=
+                          weights[i] * momentum_residual * scratch.JxW(q);
+                      }
+
+                    // RHS is \f$-(A_{current} + C_{current}) -
+                    // M_{present-current}/\Delta{t}\f$.
+                    double current_velocity_divergence =
+                      trace(current_velocity_gradients[q]);
+                    local_rhs(i) +=
+                      ((-viscosity *
+                          scalar_product(current_velocity_gradients[q],
+                                         grad_phi_u[i]) -
+                        current_velocity_gradients[q] *
+                          current_velocity_values[q] * phi_u[i] * rho +
+                        current_pressure_values[q] * div_phi_u[i] +
+                        current_velocity_divergence * phi_p[i] -
+                        gamma * current_velocity_divergence * div_phi_u[i] *
+                          rho) -
+                       (current_velocity_values[q] -
+                        present_velocity_values[q]) *
+                         phi_u[i] / time.get_delta_t() * rho +
+                       gravity * phi_u[i] * rho) *
+                      scratch.JxW(q);
+                    if (ind == 1)
+                      {
+                        local_rhs(i) +=
+                          (scalar_product(grad_phi_u[i], fsi_stress) +
+                           (fsi_acc_values[q] * rho * phi_u[i])) *
+                          scratch.JxW(q);
+                      }
+                  }
+              }
+          };
+          Utils::dispatch_dofs_per_cell<
+            Utils::lagrange_dofs_per_cell(dim, 2, dim) +
+              Utils::lagrange_dofs_per_cell(dim, 1, 1),
+            Utils::lagrange_dofs_per_cell(dim, 1, dim) +
+              Utils::lagrange_dofs_per_cell(dim, 1, 1)>(dofs_per_cell,
+                                                        assemble_volume);
+
+          // Impose pressure boundary here if specified, loop over faces on
+          // the
+          // cell
+          // and apply pressure boundary conditions:
+          // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
+          if (parameters.n_fluid_neumann_bcs != 0)
+            {
+              for (unsigned int face_n = 0;
+                   face_n < GeometryInfo<dim>::faces_per_cell;
+                   ++face_n)
                 {
-                  for (unsigned int face_n = 0;
-                       face_n < GeometryInfo<dim>::faces_per_cell;
-                       ++face_n)
+                  if (cell->at_boundary(face_n) &&
+                      parameters.fluid_neumann_bcs.find(
+                        cell->face(face_n)->boundary_id()) !=
+                        parameters.fluid_neumann_bcs.end())
                     {
-                      if (cell->at_boundary(face_n) &&
-                          parameters.fluid_neumann_bcs.find(
-                            cell->face(face_n)->boundary_id()) !=
-                            parameters.fluid_neumann_bcs.end())
+                      fe_face_values.reinit(cell, face_n);
+                      unsigned int p_bc_id =
+                        cell->face(face_n)->boundary_id();
+                      double boundary_values_p =
+                        parameters.fluid_neumann_bcs.at(p_bc_id);
+                      for (unsigned int q = 0; q < n_face_q_points; ++q)
                         {
-                          fe_face_values.reinit(cell, face_n);
-                          unsigned int p_bc_id =
-                            cell->face(face_n)->boundary_id();
-                          double boundary_values_p =
-                            parameters.fluid_neumann_bcs[p_bc_id];
-                          for (unsigned int q = 0; q < n_face_q_points; ++q)
+                          for (unsigned int i = 0; i < dofs_per_cell; ++i)
                             {
-                              for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                                {
-                                  local_rhs(i) += -(
-                                    fe_face_values[velocities].value(i, q) *
-                                    fe_face_values.normal_vector(q) *
-                                    boundary_values_p * fe_face_values.JxW(q));
-                                }
+                              local_rhs(i) += -(
+                                fe_face_values[velocities].value(i, q) *
+                                fe_face_values.normal_vector(q) *
+                                boundary_values_p * fe_face_values.JxW(q));
                             }
                         }
                     }
                 }
+            }
 
-              cell->get_dof_indices(local_dof_indices);
-
-              const AffineConstraints<double> &constraints_used =
-                use_nonzero_constraints ? nonzero_constraints
-                                        : zero_constraints;
-              constraints_used.distribute_local_to_global(local_matrix,
-                                                          local_rhs,
-                                                          local_dof_indices,
-                                                          system_matrix,
-                                                          system_rhs,
-                                                          true);
-              constraints_used.distribute_local_to_global(
-                local_mass_matrix, local_dof_indices, mass_matrix);
+          cell->get_dof_indices(data.local_dof_indices);
+          if (assemble_pcd)
+            {
+              for (unsigned int i = 0; i < p_dofs; ++i)
+                {
+                  data.local_pressure_dof_indices[i] =
+                    data.local_dof_indices[pressure_dofs[i]];
+                }
             }
-        }
+        };
+
+      const AffineConstraints<double> &constraints_used =
+        use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+      auto copy_local_to_global = [&](const AssemblyCopyData &data) {
+        constraints_used.distribute_local_to_global(data.local_matrix,
+                                                    data.local_rhs,
+                                                    data.local_dof_indices,
+                                                    system_matrix,
+                                                    system_rhs,
+                                                    true);
+        constraints_used.distribute_local_to_global(
+          data.local_mass_matrix, data.local_dof_indices, mass_matrix);
+        // With separate row and column dofs, no diagonal entries are added
+        // for the constrained dofs, which may be outside the pattern.
+        if (assemble_pcd)
+          {
+            constraints_used.distribute_local_to_global(
+              data.local_pressure_convection,
+              data.local_pressure_dof_indices,
+              data.local_pressure_dof_indices,
+              pressure_convection);
+          }
+      };
+
+      assemble_cells(local_assemble, copy_local_to_global);
 
       system_matrix.compress(VectorOperation::add);
       mass_matrix.compress(VectorOperation::add);
       system_rhs.compress(VectorOperation::add);
+      if (assemble_pcd)
+        {
+          pressure_convection.compress(VectorOperation::add);
+        }
     }
 
     template <int dim>
     std::pair<unsigned int, double>
-    InsIM<dim>::solve(const bool use_nonzero_constraints)
+    InsIM<dim>::solve(const bool use_nonzero_constraints, const double forcing)
     {
       TimerOutput::Scope timer_section(timer, "Solve linear system");
-      preconditioner.reset(new BlockSchurPreconditioner(timer2,
-                                                        parameters.grad_div,
-                                                        parameters.viscosity,
-                                                        parameters.fluid_rho,
-                                                        time.get_delta_t(),
-                                                        owned_partitioning,
-                                                        system_matrix,
-                                                        mass_matrix,
-                                                        mass_schur));
+      const bool keep_stale_factor =
+        last_gmres_iterations < parameters.fluid_stale_factor_iterations;
+      const bool use_fieldsplit = parameters.fluid_block_solver == "fieldsplit";
+      // A_inverse is refactorized only if the system has been reassembled,
+      // and the stale factor is kept if the last solve converged fast enough.
+      // PCFIELDSPLIT factorizes the velocity block itself.
+      if (!use_fieldsplit)
+        {
+          TimerOutput::Scope timer_section(timer2, "MUMPS factorization");
+          A_inverse.update(system_matrix.block(0, 0), keep_stale_factor);
+        }
+      preconditioner.reset(
+        new BlockSchurPreconditioner(timer2,
+                                     parameters.grad_div,
+                                     parameters.viscosity,
+                                     parameters.fluid_rho,
+                                     time.get_delta_t(),
+                                     owned_partitioning,
+                                     system_matrix,
+                                     mass_matrix,
+                                     mass_schur,
+                                     pressure_convection,
+                                     workspace,
+                                     parameters,
+                                     parameters.fluid_mixed_precision,
+                                     A_inverse));
 
       SolverControl solver_control(
-        system_matrix.m(), std::max(1e-12, 1e-4 * system_rhs.l2_norm()), true);
-      // Because PETScWrappers::SolverGMRES requires preconditioner derived
-      // from PETScWrappers::PreconditionBase, we use dealii SolverFGMRES.
-      GrowingVectorMemory<PETScWrappers::MPI::BlockVector> vector_memory;
-      SolverFGMRES<PETScWrappers::MPI::BlockVector> gmres(solver_control,
-                                                          vector_memory);
-
+        system_matrix.m(),
+        std::max(1e-12, std::max(1e-4, forcing) * system_rhs.l2_norm()),
+        true);
       // The solution vector must be non-ghosted
-      gmres.solve(system_matrix, newton_update, system_rhs, *preconditioner);
+      if (use_fieldsplit)
+        {
+          if (!fieldsplit)
+            {
+              fieldsplit.reset(new Utils::FieldSplitSolver(
+                "fluid_",
+                {{"fieldsplit_0_ksp_type", "preonly"},
+                 {"fieldsplit_0_pc_type", "lu"},
+                 {"fieldsplit_0_pc_factor_mat_solver_type", "mumps"},
+                 {"fieldsplit_1_ksp_type", "preonly"}}));
+              fieldsplit->initialize(
+                system_matrix,
+                owned_partitioning,
+                nullptr,
+                [this](PETScWrappers::MPI::Vector &dst,
+                       const PETScWrappers::MPI::Vector &src) {
+                  preconditioner->schur_vmult(dst, src);
+                });
+            }
+          // Like A_inverse, the factorization of the velocity block is kept
+          // if the last solve converged fast enough.
+          auto state = fieldsplit->solve(newton_update,
+                                         system_rhs,
+                                         solver_control.tolerance(),
+                                         keep_stale_factor);
+          solver_control.check(state.first, state.second);
+        }
+      else if (parameters.fluid_recycled_vectors > 0)
+        {
+          Utils::SolverGCRO<PETScWrappers::MPI::BlockVector> gcro(
+            solver_control,
+            recycle_space,
+            Utils::SolverGCRO<PETScWrappers::MPI::BlockVector>::AdditionalData(
+              30, parameters.fluid_recycled_vectors));
+          gcro.solve(
+            system_matrix, newton_update, system_rhs, *preconditioner);
+        }
+      else
+        {
+          // Because PETScWrappers::SolverGMRES requires preconditioner
+          // derived from PETScWrappers::PreconditionBase, we use dealii
+          // SolverFGMRES.
+          GrowingVectorMemory<PETScWrappers::MPI::BlockVector> vector_memory;
+          SolverFGMRES<PETScWrappers::MPI::BlockVector> gmres(solver_control,
+                                                              vector_memory);
+          gmres.solve(
+            system_matrix, newton_update, system_rhs, *preconditioner);
+        }
 
       const AffineConstraints<double> &constraints_used =
         use_nonzero_constraints ? nonzero_constraints : zero_constraints;
       constraints_used.distribute(newton_update);
 
+      last_gmres_iterations = solver_control.last_step();
+      performance.add("Krylov iterations", solver_control.last_step());
+      performance.add("Linear solves", 1);
+      telemetry.add("Krylov iterations", solver_control.last_step());
+      telemetry.set("Krylov residual", solver_control.last_value());
       return {solver_control.last_step(), solver_control.last_value()};
     }
 
@@ -407,7 +698,10 @@ namespace Fluid
           output_results(0);
         }
 
+      update_solution_history();
       time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
       pcout << std::string(96, '*') << std::endl
             << "Time step = " << time.get_timestep()
             << ", at t = " << std::scientific << time.current() << std::endl;
@@ -417,7 +711,12 @@ namespace Fluid
       double initial_residual = 1.0;
       double relative_residual = 1.0;
       unsigned int outer_iteration = 0;
-      evaluation_point = present_solution;
+      n_linear_iterations = 0;
+      extrapolate_solution(evaluation_point);
+      forcing.reset();
+      // Whether the line search of the last iteration has already assembled
+      // the system at evaluation_point.
+      bool assembled = false;
       while (relative_residual > parameters.fluid_tolerance &&
              current_residual > 1e-11)
         {
@@ -433,9 +732,18 @@ namespace Fluid
           // should be applied at the first iteration of every time step;
           // if they are time-independent, nonzero_constraints should be
           // applied only at the first iteration of the first time step.
-          assemble(apply_nonzero_constraints && outer_iteration == 0);
-          auto state = solve(apply_nonzero_constraints && outer_iteration == 0);
+          const bool use_nonzero_constraints =
+            apply_nonzero_constraints && outer_iteration == 0;
+          if (!assembled)
+            {
+              assemble(use_nonzero_constraints);
+            }
           current_residual = system_rhs.l2_norm();
+          const double eta = parameters.fluid_inexact_newton
+                               ? forcing.next(current_residual)
+                               : 0;
+          auto state = solve(use_nonzero_constraints, eta);
+          n_linear_iterations = std::max(n_linear_iterations, state.first);
 
           // Update evaluation_point. Since newton_update has been set to
           // the correct bc values, there is no need to distribute the
@@ -444,23 +752,58 @@ namespace Fluid
           PETScWrappers::MPI::BlockVector tmp;
           tmp.reinit(owned_partitioning, mpi_communicator);
           tmp = evaluation_point;
-          tmp += newton_update;
-          evaluation_point = tmp;
+          double step = 1;
+          assembled = false;
+          // The step that applies the Dirichlet values is always taken in
+          // full. Every trial point is assembled, so the next iteration
+          // starts from the system at the accepted one.
+          if (parameters.fluid_line_search_steps > 0 &&
+              !use_nonzero_constraints)
+            {
+              const PETScWrappers::MPI::BlockVector base(tmp);
+              step = Utils::line_search(
+                [&](const double s) {
+                  tmp = base;
+                  tmp.add(s, newton_update);
+                  start_ghost_update(evaluation_point, tmp);
+                  assemble(false);
+                  return system_rhs.l2_norm();
+                },
+                current_residual,
+                std::max(1e-4, eta),
+                parameters.fluid_line_search_steps);
+              assembled = true;
+            }
+          else
+            {
+              // The ghost values are exchanged during the next assembly.
+              tmp += newton_update;
+              start_ghost_update(evaluation_point, tmp);
+            }
 
           if (outer_iteration == 0)
             {
               initial_residual = current_residual;
             }
           relative_residual = current_residual / initial_residual;
+          telemetry.add("Newton iterations", 1);
+          telemetry.set("Newton residual", current_residual);
 
           pcout << std::scientific << std::left << " ITR = " << std::setw(2)
                 << outer_iteration << " ABS_RES = " << current_residual
                 << " REL_RES = " << relative_residual
                 << " GMRES_ITR = " << std::setw(3) << state.first
-                << " GMRES_RES = " << state.second << std::endl;
+                << " GMRES_RES = " << state.second;
+          if (parameters.fluid_line_search_steps > 0)
+            {
+              pcout << " STEP = " << step;
+            }
+          pcout << std::endl;
 
           outer_iteration++;
         }
+      finish_ghost_updates();
+      n_newton_iterations = outer_iteration;
       // Update solution increment, which is used in FSI application.
       PETScWrappers::MPI::BlockVector tmp1, tmp2;
       tmp1.reinit(owned_partitioning, mpi_communicator);
@@ -471,15 +814,17 @@ namespace Fluid
       solution_increment = tmp2;
       // Newton iteration converges, update time and solution
       present_solution = evaluation_point;
-      // Update stress for output
-      update_stress();
       // Output
       if (parameters.simulation_type == "Fluid" && time.time_to_save())
         {
           save_checkpoint(time.get_timestep());
         }
+      monitor.monitor(time.get_timestep(), time.current(), present_solution);
       if (time.time_to_output())
         {
+          // The stress is only needed by the output.
+          if (parameters.output_field("stress"))
+            update_stress();
           output_results(time.get_timestep());
         }
       if (parameters.simulation_type == "Fluid" && time.time_to_refine())
@@ -500,7 +845,9 @@ namespace Fluid
       bool success_load = load_checkpoint();
       if (!success_load)
         {
-          triangulation.refine_global(parameters.global_refinements[0]);
+          // The mesh of a reused setup is refined already.
+          if (!setup_reused)
+            triangulation.refine_global(parameters.global_refinements[0]);
           setup_dofs();
           make_constraints();
           initialize_system();
@@ -514,6 +861,7 @@ namespace Fluid
       run_one_step(true);
       while (time.end() - time.current() > 1e-12)
         {
+          adapt_time_step();
           run_one_step(false);
         }
     }
@@ -4,6 +4,213 @@ namespace Fluid
 {
   namespace MPI
   {
+    namespace
+    {
+      // The velocity block of the PETSc vectors and the matrix-free vectors
+      // have the same locally owned dofs in the same order, so the local
+      // arrays are simply copied.
+      void copy_vector(LinearAlgebra::distributed::Vector<double> &dst,
+                       const PETScWrappers::MPI::Vector &src)
+      {
+        const PetscScalar *values;
+        PetscErrorCode ierr = VecGetArrayRead(src, &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        std::copy(values, values + dst.local_size(), dst.begin());
+        ierr = VecRestoreArrayRead(src, &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+
+      void copy_vector(PETScWrappers::MPI::Vector &dst,
+                       const LinearAlgebra::distributed::Vector<double> &src)
+      {
+        PetscScalar *values;
+        PetscErrorCode ierr = VecGetArray(dst, &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        std::copy(src.begin(), src.begin() + src.local_size(), values);
+        ierr = VecRestoreArray(dst, &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+    } // namespace
+
+    template <int dim>
+    InsIMEX<dim>::VelocityOperator::VelocityOperator(double gamma,
+                                                     double viscosity,
+                                                     double rho,
+                                                     double dt,
+                                                     unsigned int degree)
+      : gamma(gamma), viscosity(viscosity), rho(rho), dt(dt), degree(degree)
+    {
+      AssertThrow(degree == 2 || degree == 3,
+                  ExcMessage("The matrix-free velocity block is only "
+                             "implemented for velocity degree 2 and 3!"));
+    }
+
+    template <int dim>
+    void InsIMEX<dim>::VelocityOperator::reinit(
+      const DoFHandler<dim> &dof_handler,
+      const AffineConstraints<double> &constraints)
+    {
+      typename MatrixFree<dim>::AdditionalData data;
+      data.tasks_parallel_scheme = MatrixFree<dim>::AdditionalData::none;
+      data.mapping_update_flags =
+        update_values | update_gradients | update_JxW_values;
+      matrix_free.reinit(dof_handler, constraints, QGauss<1>(degree + 1), data);
+      matrix_free.initialize_dof_vector(x_buffer);
+      matrix_free.initialize_dof_vector(b_buffer);
+
+      // The diagonal is computed cell by cell, the constrained entries are
+      // set to 1 as the operator maps them to themselves.
+      VectorType &diagonal = inverse_diagonal.get_vector();
+      matrix_free.initialize_dof_vector(diagonal);
+      unsigned int dummy = 0;
+      switch (degree)
+        {
+        case 2:
+          matrix_free.cell_loop(
+            &VelocityOperator::template local_diagonal<2>,
+            this,
+            diagonal,
+            dummy);
+          break;
+        case 3:
+          matrix_free.cell_loop(
+            &VelocityOperator::template local_diagonal<3>,
+            this,
+            diagonal,
+            dummy);
+          break;
+        }
+      for (auto i : matrix_free.get_constrained_dofs())
+        {
+          diagonal.local_element(i) = 1;
+        }
+      for (unsigned int i = 0; i < diagonal.local_size(); ++i)
+        {
+          Assert(diagonal.local_element(i) > 0,
+                 ExcMessage("The velocity block must be positive definite!"));
+          diagonal.local_element(i) = 1 / diagonal.local_element(i);
+        }
+    }
+
+    template <int dim>
+    template <int degree>
+    void InsIMEX<dim>::VelocityOperator::quadrature_apply(
+      FEEvaluation<dim, degree, degree + 1, dim> &phi) const
+    {
+      const VectorizedArray<double> mass_factor =
+        make_vectorized_array(rho / dt);
+      const VectorizedArray<double> viscous_factor =
+        make_vectorized_array(viscosity);
+      const VectorizedArray<double> grad_div_factor =
+        make_vectorized_array(gamma * rho);
+      for (unsigned int q = 0; q < phi.n_q_points; ++q)
+        {
+          // \f$\mu\nabla u + \gamma\rho(\nabla\cdot u)I\f$ is tested
+          // with \f$\nabla v\f$.
+          auto gradient = phi.get_gradient(q);
+          const auto divergence = phi.get_divergence(q);
+          gradient *= viscous_factor;
+          for (unsigned int d = 0; d < dim; ++d)
+            {
+              gradient[d][d] += grad_div_factor * divergence;
+            }
+          phi.submit_value(phi.get_value(q) * mass_factor, q);
+          phi.submit_gradient(gradient, q);
+        }
+    }
+
+    template <int dim>
+    template <int degree>
+    void InsIMEX<dim>::VelocityOperator::local_apply(
+      const MatrixFree<dim> &data,
+      VectorType &dst,
+      const VectorType &src,
+      const std::pair<unsigned int, unsigned int> &cell_range) const
+    {
+      FEEvaluation<dim, degree, degree + 1, dim> phi(data);
+      for (unsigned int cell = cell_range.first; cell < cell_range.second;
+           ++cell)
+        {
+          phi.reinit(cell);
+          phi.read_dof_values(src);
+          phi.evaluate(true, true);
+          quadrature_apply(phi);
+          phi.integrate(true, true);
+          phi.distribute_local_to_global(dst);
+        }
+    }
+
+    template <int dim>
+    template <int degree>
+    void InsIMEX<dim>::VelocityOperator::local_diagonal(
+      const MatrixFree<dim> &data,
+      VectorType &dst,
+      const unsigned int &,
+      const std::pair<unsigned int, unsigned int> &cell_range) const
+    {
+      FEEvaluation<dim, degree, degree + 1, dim> phi(data);
+      AlignedVector<VectorizedArray<double>> diagonal(phi.dofs_per_cell);
+      for (unsigned int cell = cell_range.first; cell < cell_range.second;
+           ++cell)
+        {
+          phi.reinit(cell);
+          // Apply the operator to the unit vectors of the cell.
+          for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+            {
+              for (unsigned int j = 0; j < phi.dofs_per_cell; ++j)
+                {
+                  phi.begin_dof_values()[j] = make_vectorized_array(0.0);
+                }
+              phi.begin_dof_values()[i] = make_vectorized_array(1.0);
+              phi.evaluate(true, true);
+              quadrature_apply(phi);
+              phi.integrate(true, true);
+              diagonal[i] = phi.begin_dof_values()[i];
+            }
+          for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+            {
+              phi.begin_dof_values()[i] = diagonal[i];
+            }
+          phi.distribute_local_to_global(dst);
+        }
+    }
+
+    template <int dim>
+    void InsIMEX<dim>::VelocityOperator::vmult(VectorType &dst,
+                                               const VectorType &src) const
+    {
+      switch (degree)
+        {
+        case 2:
+          matrix_free.cell_loop(
+            &VelocityOperator::template local_apply<2>, this, dst, src, true);
+          break;
+        case 3:
+          matrix_free.cell_loop(
+            &VelocityOperator::template local_apply<3>, this, dst, src, true);
+          break;
+        }
+      for (auto i : matrix_free.get_constrained_dofs())
+        {
+          dst.local_element(i) = src.local_element(i);
+        }
+    }
+
+    template <int dim>
+    unsigned int InsIMEX<dim>::VelocityOperator::solve(
+      PETScWrappers::MPI::Vector &x,
+      const PETScWrappers::MPI::Vector &b,
+      const double tolerance) const
+    {
+      copy_vector(b_buffer, b);
+      x_buffer = 0;
+      SolverControl control(b.size(), tolerance);
+      SolverCG<VectorType> cg(control);
+      cg.solve(*this, x_buffer, b_buffer, inverse_diagonal);
+      copy_vector(x, x_buffer);
+      return control.last_step();
+    }
+
     template <int dim>
     InsIMEX<dim>::BlockSchurPreconditioner::BlockSchurPreconditioner(
       TimerOutput &timer2,
@@ -14,15 +221,29 @@ namespace Fluid
       const std::vector<IndexSet> &owned_partitioning,
       const PETScWrappers::MPI::BlockSparseMatrix &system,
       const PETScWrappers::MPI::BlockSparseMatrix &mass,
-      PETScWrappers::MPI::BlockSparseMatrix &schur)
+      PETScWrappers::MPI::BlockSparseMatrix &schur,
+      Utils::VectorPool &workspace,
+      const Parameters::AllParameters &parameters,
+      bool mixed_precision,
+      const std::string &backend,
+      const VelocityOperator *velocity,
+      const bool solve_velocity)
       : timer2(timer2),
         gamma(gamma),
         viscosity(viscosity),
         rho(rho),
         dt(dt),
+        velocity_tolerance(parameters.fluid_velocity_tolerance),
+        mass_tolerance(parameters.fluid_mass_tolerance),
+        schur_tolerance(parameters.fluid_schur_tolerance),
+        krylov_method(parameters.fluid_inner_krylov),
         system_matrix(&system),
         mass_matrix(&mass),
-        mass_schur(&schur)
+        mass_schur(&schur),
+        workspace(&workspace),
+        velocity_operator(velocity),
+        mixed_precision(mixed_precision),
+        use_device(backend != "cpu")
     {
       TimerOutput::Scope timer_section(timer2, "CG for Sm");
       // The sparsity pattern of mass_schur is already set,
@@ -39,8 +260,56 @@ namespace Fluid
       jacobi.vmult(tmp2.block(0), tmp1.block(0));
       // The sparsity pattern has already been set correctly, so explicitly
       // tell mmult not to rebuild the sparsity pattern.
-      system_matrix->block(1, 0).mmult(
-        mass_schur->block(1, 1), system_matrix->block(0, 1), tmp2.block(0));
+      if (!parameters.fluid_stabilization)
+        {
+          system_matrix->block(1, 0).mmult(
+            mass_schur->block(1, 1), system_matrix->block(0, 1), tmp2.block(0));
+        }
+      else
+        {
+          // The stabilization terms make the off-diagonal blocks differ, so
+          // the plain divergence is taken from the mass matrix. The pressure
+          // block \f$-C\f$ of the system adds \f$\frac{\rho}{\Delta{t}}C\f$
+          // to \f$S_m\f$, as \f$S \approx -\frac{\Delta{t}}{\rho}S_m - C\f$.
+          mass_matrix->block(1, 0).mmult(
+            mass_schur->block(1, 1), mass_matrix->block(0, 1), tmp2.block(0));
+          mass_schur->block(1, 1).add(-rho / dt, system_matrix->block(1, 1));
+        }
+
+      if (use_device)
+        {
+          TimerOutput::Scope timer_section(timer2, "Device copies");
+          Mp_device.reinit(mass_matrix->block(1, 1), backend, "jacobi");
+          Sm_device.reinit(mass_schur->block(1, 1), backend, "jacobi");
+          if (!velocity_operator && solve_velocity)
+            {
+              A_device.reinit(system_matrix->block(0, 0), backend, "boomeramg");
+            }
+        }
+      else if (mixed_precision)
+        {
+          Mp_single.reinit(mass_matrix->block(1, 1));
+          Sm_single.reinit(mass_schur->block(1, 1));
+        }
+      else
+        {
+          Mp_preconditioner.initialize(
+            PreconditionSelector::choose(
+              parameters.fluid_mass_preconditioner, "jacobi"),
+            mass_matrix->block(1, 1));
+          Sm_preconditioner.initialize(
+            PreconditionSelector::choose(
+              parameters.fluid_schur_preconditioner, "jacobi"),
+            mass_schur->block(1, 1));
+        }
+      if (!velocity_operator && !use_device && solve_velocity)
+        {
+          TimerOutput::Scope timer_section(timer2, "AMG setup");
+          A_preconditioner.initialize(
+            PreconditionSelector::choose(
+              parameters.fluid_velocity_preconditioner, "amg"),
+            system_matrix->block(0, 0));
+        }
     }
 
     /**
@@ -52,29 +321,77 @@ namespace Fluid
       PETScWrappers::MPI::BlockVector &dst,
       const PETScWrappers::MPI::BlockVector &src) const
     {
-      // Temporary vectors
-      PETScWrappers::MPI::Vector utmp(src.block(0));
-      PETScWrappers::MPI::Vector tmp(src.block(1));
-      tmp = 0;
-
       // This function is part of "solve linear system", but it
       // is further profiled to get a better idea of how time
       // is spent on different solvers.
+      Utils::CounterRegion counter_region("Block Schur vmult");
+      schur_vmult(dst.block(1), src.block(1));
+
+      // Compute \f$v_0 - B^T\tilde{S}^{-1}v_1\f$ based on \f$u_1\f$.
+      Utils::VectorPool::Handle utmp(*workspace, 0);
+      system_matrix->block(0, 1).vmult(*utmp, dst.block(1));
+      *utmp *= -1.0;
+      *utmp += src.block(0);
+
+      // Finally, compute the product of \f$\tilde{A}^{-1}\f$ and utmp
+      // using another CG solver.
+      {
+        TimerOutput::Scope timer_section(timer2, "CG for A");
+        const double a_tolerance =
+          std::max(1e-12, velocity_tolerance * src.block(0).l2_norm());
+        if (velocity_operator)
+          {
+            velocity_operator->solve(dst.block(0), *utmp, a_tolerance);
+          }
+        else if (use_device)
+          {
+            A_device.solve(dst.block(0), *utmp, a_tolerance);
+          }
+        else
+          {
+            SolverControl a_control(src.block(0).size(), a_tolerance);
+            Utils::SolverKrylov cg_a(
+              a_control, mass_schur->get_mpi_communicator(), krylov_method);
+            cg_a.solve(system_matrix->block(0, 0),
+                       dst.block(0),
+                       *utmp,
+                       A_preconditioner);
+          }
+      }
+    }
+
+    template <int dim>
+    void InsIMEX<dim>::BlockSchurPreconditioner::schur_vmult(
+      PETScWrappers::MPI::Vector &dst,
+      const PETScWrappers::MPI::Vector &src) const
+    {
+      Utils::VectorPool::Handle tmp(*workspace, 1);
+      *tmp = 0;
 
       // This block computes \f$u_1 = \tilde{S}^{-1} v_1\f$,
       // where CG solvers are used for \f$M_p^{-1}\f$ and \f$S_m^{-1}\f$.
       {
         TimerOutput::Scope timer_section(timer2, "CG for Mp");
         SolverControl mp_control(
-          src.block(1).size(), std::max(1e-10, 1e-6 * src.block(1).l2_norm()));
-        PETScWrappers::SolverCG cg_mp(mp_control,
-                                      mass_schur->get_mpi_communicator());
+          src.size(), std::max(1e-10, mass_tolerance * src.l2_norm()));
         // \f$-(\mu + \gamma\rho)M_p^{-1}v_1\f$
-        PETScWrappers::PreconditionNone Mp_preconditioner;
-        Mp_preconditioner.initialize(mass_matrix->block(1, 1));
-        cg_mp.solve(
-          mass_matrix->block(1, 1), tmp, src.block(1), Mp_preconditioner);
-        tmp *= -(viscosity + gamma * rho);
+        if (use_device)
+          {
+            Mp_device.solve(*tmp, src, mp_control.tolerance());
+          }
+        else if (mixed_precision)
+          {
+            Mp_single.solve(*tmp, src, mp_control.tolerance());
+          }
+        else
+          {
+            Utils::SolverKrylov cg_mp(mp_control,
+                                      mass_schur->get_mpi_communicator(),
+                                      krylov_method);
+            cg_mp.solve(
+              mass_matrix->block(1, 1), *tmp, src, Mp_preconditioner);
+          }
+        *tmp *= -(viscosity + gamma * rho);
       }
 
       // FIXME: There is a mysterious bug here. After refine_mesh is called,
@@ -90,50 +407,46 @@ namespace Fluid
       {
         TimerOutput::Scope timer_section(timer2, "CG for Sm");
         SolverControl sm_control(
-          src.block(1).size(), std::max(1e-10, 1e-3 * src.block(1).l2_norm()));
-        PETScWrappers::SolverCG cg_sm(sm_control,
-                                      mass_schur->get_mpi_communicator());
-        PETScWrappers::PreconditionNone Sm_preconditioner;
-        Sm_preconditioner.initialize(mass_schur->block(1, 1));
-        cg_sm.solve(mass_schur->block(1, 1),
-                    dst.block(1),
-                    src.block(1),
-                    Sm_preconditioner);
-        dst.block(1) *= -rho / dt;
+          src.size(), std::max(1e-10, schur_tolerance * src.l2_norm()));
+        if (use_device)
+          {
+            Sm_device.solve(dst, src, sm_control.tolerance());
+          }
+        else if (mixed_precision)
+          {
+            Sm_single.solve(dst, src, sm_control.tolerance());
+          }
+        else
+          {
+            Utils::SolverKrylov cg_sm(sm_control,
+                                      mass_schur->get_mpi_communicator(),
+                                      krylov_method);
+            cg_sm.solve(mass_schur->block(1, 1), dst, src, Sm_preconditioner);
+          }
+        dst *= -rho / dt;
         // Adding up these two, we get \f$\tilde{S}^{-1}v_1\f$.
-        dst.block(1) += tmp;
-      }
-
-      // Compute \f$v_0 - B^T\tilde{S}^{-1}v_1\f$ based on \f$u_1\f$.
-      system_matrix->block(0, 1).vmult(utmp, dst.block(1));
-      utmp *= -1.0;
-      utmp += src.block(0);
-
-      // Finally, compute the product of \f$\tilde{A}^{-1}\f$ and utmp
-      // using another CG solver.
-      {
-        TimerOutput::Scope timer_section(timer2, "CG for A");
-        SolverControl a_control(src.block(0).size(),
-                                std::max(1e-12, 1e-4 * src.block(0).l2_norm()));
-        PETScWrappers::SolverCG cg_a(a_control,
-                                     mass_schur->get_mpi_communicator());
-        PETScWrappers::PreconditionNone A_preconditioner;
-        A_preconditioner.initialize(system_matrix->block(0, 0));
-        cg_a.solve(
-          system_matrix->block(0, 0), dst.block(0), utmp, A_preconditioner);
+        dst += *tmp;
       }
     }
 
     template <int dim>
     InsIMEX<dim>::InsIMEX(parallel::distributed::Triangulation<dim> &tria,
                           const Parameters::AllParameters &parameters)
-      : FluidSolver<dim>(tria, parameters)
+      : FluidSolver<dim>(tria, parameters),
+        velocity_fe(FE_Q<dim>(parameters.fluid_velocity_degree), dim),
+        velocity_dof_handler(tria),
+        lhs_valid(false),
+        lhs_delta_t(0)
     {
-      Assert(
-        parameters.fluid_velocity_degree - parameters.fluid_pressure_degree ==
-          1,
-        ExcMessage(
-          "Velocity finite element should be one order higher than pressure!"));
+      Assert(parameters.fluid_stabilization
+               ? parameters.fluid_velocity_degree ==
+                   parameters.fluid_pressure_degree
+               : parameters.fluid_velocity_degree -
+                     parameters.fluid_pressure_degree ==
+                   1,
+             ExcMessage("Velocity finite element should be one order higher "
+                        "than pressure, or of the same order with the "
+                        "equal-order stabilization!"));
     }
 
     template <int dim>
@@ -141,16 +454,115 @@ namespace Fluid
     {
       FluidSolver<dim>::initialize_system();
       preconditioner.reset();
+      fieldsplit.reset();
+      velocity_operator.reset();
+      lhs_valid = false;
+      if (parameters.fluid_matrix_free)
+        {
+          setup_velocity_dofs();
+        }
       // newton_update is non-ghosted because the linear solver needs
       // a completely distributed vector.
       solution_increment.reinit(owned_partitioning, mpi_communicator);
     }
 
     template <int dim>
-    void InsIMEX<dim>::assemble(bool use_nonzero_constraints,
+    void InsIMEX<dim>::setup_velocity_dofs()
+    {
+      velocity_dof_handler.distribute_dofs(velocity_fe);
+      // Map every locally owned velocity dof to the index of the same dof in
+      // dof_handler, which is in the velocity block.
+      const IndexSet &owned = velocity_dof_handler.locally_owned_dofs();
+      std::vector<types::global_dof_index> new_numbers(owned.n_elements());
+      std::vector<types::global_dof_index> dof_indices(fe.dofs_per_cell);
+      std::vector<types::global_dof_index> velocity_dof_indices(
+        velocity_fe.dofs_per_cell);
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (!cell->is_locally_owned())
+            continue;
+          typename DoFHandler<dim>::active_cell_iterator velocity_cell(
+            &triangulation,
+            cell->level(),
+            cell->index(),
+            &velocity_dof_handler);
+          cell->get_dof_indices(dof_indices);
+          velocity_cell->get_dof_indices(velocity_dof_indices);
+          for (unsigned int i = 0; i < velocity_fe.dofs_per_cell; ++i)
+            {
+              if (!owned.is_element(velocity_dof_indices[i]))
+                continue;
+              const auto component = velocity_fe.system_to_component_index(i);
+              new_numbers[owned.index_within_set(velocity_dof_indices[i])] =
+                dof_indices[fe.component_to_system_index(component.first,
+                                                         component.second)];
+            }
+        }
+      velocity_dof_handler.renumber_dofs(new_numbers);
+      AssertThrow(velocity_dof_handler.locally_owned_dofs() ==
+                    owned_partitioning[0],
+                  ExcMessage("Velocity dofs are partitioned differently!"));
+    }
+
+    template <int dim>
+    void InsIMEX<dim>::setup_velocity_operator()
+    {
+      // The velocity constraints are extracted from the zero constraints,
+      // which may include the artificial fluid constraints in FSI.
+      velocity_constraints.clear();
+      velocity_constraints.reinit(relevant_partitioning[0]);
+      for (auto index : relevant_partitioning[0])
+        {
+          if (zero_constraints.is_constrained(index))
+            {
+              velocity_constraints.add_line(index);
+              velocity_constraints.add_entries(
+                index, *zero_constraints.get_constraint_entries(index));
+            }
+        }
+      velocity_constraints.close();
+      velocity_operator.reset(
+        new VelocityOperator(parameters.grad_div,
+                             parameters.viscosity,
+                             parameters.fluid_rho,
+                             time.get_delta_t(),
+                             parameters.fluid_velocity_degree));
+      velocity_operator->reinit(velocity_dof_handler, velocity_constraints);
+    }
+
+    template <int dim>
+    bool InsIMEX<dim>::update_lhs_record(
+      const AffineConstraints<double> &constraints)
+    {
+      std::vector<types::global_dof_index> constrained_dofs;
+      for (auto dof = locally_relevant_dofs.begin();
+           dof != locally_relevant_dofs.end();
+           ++dof)
+        {
+          if (constraints.is_constrained(*dof))
+            constrained_dofs.push_back(*dof);
+        }
+      const bool changed = !lhs_valid ||
+                           lhs_delta_t != time.get_delta_t() ||
+                           constrained_dofs != lhs_constrained_dofs;
+      lhs_valid = true;
+      lhs_delta_t = time.get_delta_t();
+      lhs_constrained_dofs.swap(constrained_dofs);
+      return Utilities::MPI::max(changed ? 1 : 0, mpi_communicator) == 1;
+    }
+
+    template <int dim>
+    bool InsIMEX<dim>::assemble(bool use_nonzero_constraints,
                                 bool assemble_system)
     {
       TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::CounterRegion counter_region("Assemble system");
+
+      const AffineConstraints<double> &constraints_used =
+        use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+      assemble_system =
+        (assemble_system || !lhs_valid) && update_lhs_record(constraints_used);
 
       const double viscosity = parameters.viscosity;
       const double gamma = parameters.grad_div;
@@ -164,187 +576,242 @@ namespace Fluid
           mass_matrix = 0;
         }
       system_rhs = 0;
-
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_quadrature_points |
-                                update_JxW_values | update_gradients);
-      FEFaceValues<dim> fe_face_values(fe,
-                                       face_quad_formula,
-                                       update_values | update_normal_vectors |
-                                         update_quadrature_points |
-                                         update_JxW_values);
+      const bool stabilized = parameters.fluid_stabilization;
 
       const unsigned int dofs_per_cell = fe.dofs_per_cell;
       const unsigned int n_q_points = volume_quad_formula.size();
       const unsigned int n_face_q_points = face_quad_formula.size();
 
       const FEValuesExtractors::Vector velocities(0);
-      const FEValuesExtractors::Scalar pressure(dim);
-
-      FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-      FullMatrix<double> local_mass_matrix(dofs_per_cell, dofs_per_cell);
-      Vector<double> local_rhs(dofs_per_cell);
-
-      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
 
-      std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-      std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-      std::vector<double> current_velocity_divergences(n_q_points);
-      std::vector<double> current_pressure_values(n_q_points);
-      std::vector<Tensor<1, dim>> fsi_acc_values(n_q_points);
-
-      std::vector<double> div_phi_u(dofs_per_cell);
-      std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-      std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-      std::vector<double> phi_p(dofs_per_cell);
-
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
-        {
-          if (cell->is_locally_owned())
+      // The cell loop runs on WorkStream, see assemble_cells.
+      auto local_assemble =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            AssemblyScratchData &scratch,
+            AssemblyCopyData &data) {
+          FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+          auto &local_matrix = data.local_matrix;
+          auto &local_mass_matrix = data.local_mass_matrix;
+          auto &local_rhs = data.local_rhs;
+          auto &current_velocity_values = scratch.current_velocity_values;
+          auto &current_velocity_gradients = scratch.current_velocity_gradients;
+          auto &current_velocity_divergences =
+            scratch.current_velocity_divergences;
+          auto &current_pressure_values = scratch.current_pressure_values;
+          auto &fsi_acc_values = scratch.fsi_acc_values;
+          auto &div_phi_u = scratch.div_phi_u;
+          auto &phi_u = scratch.phi_u;
+          auto &grad_phi_u = scratch.grad_phi_u;
+          auto &phi_p = scratch.phi_p;
+          auto &grad_phi_p = scratch.grad_phi_p;
+          auto &current_pressure_gradients = scratch.current_pressure_gradients;
+
+          const unsigned int cell_index = cell->active_cell_index();
+          const SymmetricTensor<2, dim> &fsi_stress =
+            cell_property.fsi_stress[cell_index];
+          const int ind = cell_property.indicator[cell_index];
+          const double rho = parameters.fluid_rho;
+          // PSPG only, with the convection and its SUPG term explicit. The
+          // parameter leaves out the velocity, so that the LHS still only
+          // depends on the time step and the constraints.
+          const double tau =
+            stabilized
+              ? stabilization_parameter(Tensor<1, dim>(), cell->diameter())
+              : 0.0;
+
+          scratch.reinit(cell);
+          cell->get_dof_indices(data.local_dof_indices);
+
+          // Even without the LHS, the local matrix is needed to take the
+          // inhomogeneous constraints into account in the RHS.
+          bool local_lhs = assemble_system;
+          for (auto dof : data.local_dof_indices)
             {
-              auto p = cell_property.get_data(cell);
-              const int ind = p[0]->indicator;
-              const double rho = parameters.fluid_rho;
+              local_lhs = local_lhs ||
+                          constraints_used.is_inhomogeneously_constrained(dof);
+            }
 
-              fe_values.reinit(cell);
+          local_matrix = 0;
+          local_mass_matrix = 0;
+          local_rhs = 0;
 
-              if (assemble_system)
-                {
-                  local_matrix = 0;
-                  local_mass_matrix = 0;
-                }
-              local_rhs = 0;
+          {
+            std::lock_guard<std::mutex> lock(assembly_mutex);
+            scratch.get_velocity_values(
+              present_solution, current_velocity_values);
+
+            scratch.get_velocity_gradients(
+              present_solution, current_velocity_gradients);
 
-              fe_values[velocities].get_function_values(
-                present_solution, current_velocity_values);
+            scratch.get_velocity_divergences(
+              present_solution, current_velocity_divergences);
 
-              fe_values[velocities].get_function_gradients(
-                present_solution, current_velocity_gradients);
+            scratch.get_pressure_values(
+              present_solution, current_pressure_values);
 
-              fe_values[velocities].get_function_divergences(
-                present_solution, current_velocity_divergences);
+            if (stabilized)
+              {
+                scratch.get_pressure_gradients(present_solution,
+                                               current_pressure_gradients);
+              }
 
-              fe_values[pressure].get_function_values(present_solution,
-                                                      current_pressure_values);
+            scratch.get_velocity_values(fsi_acceleration, fsi_acc_values);
+          }
 
-              fe_values[velocities].get_function_values(fsi_acceleration,
-                                                        fsi_acc_values);
+          // Assemble the system matrix and mass matrix simultaneouly.
+          // The mass matrix only uses the (0, 0) and (1, 1) blocks, and the
+          // divergence in the (0, 1) and (1, 0) blocks if it is stabilized.
+          //
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              for (unsigned int k = 0; k < dofs_per_cell; ++k)
+                {
+                  div_phi_u[k] = scratch.velocity_divergence(k, q);
+                  grad_phi_u[k] = scratch.velocity_gradient(k, q);
+                  phi_u[k] = scratch.velocity_value(k, q);
+                  phi_p[k] = scratch.pressure_value(k, q);
+                  if (stabilized)
+                    {
+                      grad_phi_p[k] = scratch.pressure_gradient(k, q);
+                    }
+                }
 
-              // Assemble the system matrix and mass matrix simultaneouly.
-              // The mass matrix only uses the (0, 0) and (1, 1) blocks.
-              //
-              for (unsigned int q = 0; q < n_q_points; ++q)
+              // The PSPG term \f$-\sum_K(\frac{\tau}{\rho}\nabla{q},
+              // R_m)_K\f$ of the continuity equation with the momentum
+              // residual \f$R_m = \rho\frac{\delta{u}}{\Delta{t}} +
+              // \rho(u^n\cdot\nabla)u^n + \nabla{p} - \rho g - \rho a_{fsi}\f$,
+              // whose viscous term vanishes with linear elements.
+              Tensor<1, dim> momentum_residual;
+              if (stabilized)
                 {
-                  for (unsigned int k = 0; k < dofs_per_cell; ++k)
+                  momentum_residual =
+                    current_velocity_gradients[q] * current_velocity_values[q] *
+                      rho +
+                    current_pressure_gradients[q] - gravity * rho;
+                  if (ind == 1)
                     {
-                      div_phi_u[k] = fe_values[velocities].divergence(k, q);
-                      grad_phi_u[k] = fe_values[velocities].gradient(k, q);
-                      phi_u[k] = fe_values[velocities].value(k, q);
-                      phi_p[k] = fe_values[pressure].value(k, q);
+                      momentum_residual -= fsi_acc_values[q] * rho;
                     }
+                }
 
-                  for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                {
+                  if (local_lhs)
                     {
-                      if (assemble_system)
+                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
                         {
-                          for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                          local_matrix(i, j) +=
+                            (viscosity * scalar_product(grad_phi_u[j],
+                                                        grad_phi_u[i]) -
+                             div_phi_u[i] * phi_p[j] -
+                             phi_p[i] * div_phi_u[j] +
+                             gamma * div_phi_u[j] * div_phi_u[i] * rho +
+                             phi_u[i] * phi_u[j] / time.get_delta_t() *
+                               rho) *
+                            scratch.JxW(q);
+                          local_mass_matrix(i, j) +=
+                            (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
+                            scratch.JxW(q);
+                          if (stabilized)
                             {
-                              local_matrix(i, j) +=
-                                (viscosity * scalar_product(grad_phi_u[j],
-                                                            grad_phi_u[i]) -
-                                 div_phi_u[i] * phi_p[j] -
-                                 phi_p[i] * div_phi_u[j] +
-                                 gamma * div_phi_u[j] * div_phi_u[i] * rho +
-                                 phi_u[i] * phi_u[j] / time.get_delta_t() *
-                                   rho) *
-                                fe_values.JxW(q);
-                              local_mass_matrix(i, j) +=
-                                (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
-                                fe_values.JxW(q);
+                              local_matrix(i, j) -=
+                                tau / rho * grad_phi_p[i] *
+                                (phi_u[j] * rho / time.get_delta_t() +
+                                 grad_phi_p[j]) *
+                                scratch.JxW(q);
+                              // The unstabilized \f$B\f$ for \f$S_m\f$.
+                              local_mass_matrix(i, j) -=
+                                (div_phi_u[i] * phi_p[j] +
+                                 phi_p[i] * div_phi_u[j]) *
+                                scratch.JxW(q);
                             }
                         }
-                      local_rhs(i) -=
-                        (viscosity *
-                           scalar_product(current_velocity_gradients[q],
-                                          grad_phi_u[i]) -
-                         current_velocity_divergences[q] * phi_p[i] -
-                         current_pressure_values[q] * div_phi_u[i] +
-                         gamma * current_velocity_divergences[q] *
-                           div_phi_u[i] * rho +
-                         current_velocity_gradients[q] *
-                           current_velocity_values[q] * phi_u[i] * rho -
-                         gravity * phi_u[i] * rho) *
-                        fe_values.JxW(q);
-                      if (ind == 1)
-                        {
-                          local_rhs(i) +=
-                            (scalar_product(grad_phi_u[i], p[0]->fsi_stress) +
-                             (fsi_acc_values[q] * rho * phi_u[i])) *
-                            fe_values.JxW(q);
-                        }
+                    }
+                  if (stabilized)
+                    {
+                      local_rhs(i) += tau / rho * grad_phi_p[i] *
+                                      momentum_residual * scratch.JxW(q);
+                    }
+                  local_rhs(i) -=
+                    (viscosity *
+                       scalar_product(current_velocity_gradients[q],
+                                      grad_phi_u[i]) -
+                     current_velocity_divergences[q] * phi_p[i] -
+                     current_pressure_values[q] * div_phi_u[i] +
+                     gamma * current_velocity_divergences[q] *
+                       div_phi_u[i] * rho +
+                     current_velocity_gradients[q] *
+                       current_velocity_values[q] * phi_u[i] * rho -
+                     gravity * phi_u[i] * rho) *
+                    scratch.JxW(q);
+                  if (ind == 1)
+                    {
+                      local_rhs(i) +=
+                        (scalar_product(grad_phi_u[i], fsi_stress) +
+                         (fsi_acc_values[q] * rho * phi_u[i])) *
+                        scratch.JxW(q);
                     }
                 }
+            }
 
-              // Impose pressure boundary here if specified, loop over faces on
-              // the
-              // cell
-              // and apply pressure boundary conditions:
-              // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
-              if (parameters.n_fluid_neumann_bcs != 0)
+          // Impose pressure boundary here if specified, loop over faces on
+          // the
+          // cell
+          // and apply pressure boundary conditions:
+          // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
+          if (parameters.n_fluid_neumann_bcs != 0)
+            {
+              for (unsigned int face_n = 0;
+                   face_n < GeometryInfo<dim>::faces_per_cell;
+                   ++face_n)
                 {
-                  for (unsigned int face_n = 0;
-                       face_n < GeometryInfo<dim>::faces_per_cell;
-                       ++face_n)
+                  if (cell->at_boundary(face_n) &&
+                      parameters.fluid_neumann_bcs.find(
+                        cell->face(face_n)->boundary_id()) !=
+                        parameters.fluid_neumann_bcs.end())
                     {
-                      if (cell->at_boundary(face_n) &&
-                          parameters.fluid_neumann_bcs.find(
-                            cell->face(face_n)->boundary_id()) !=
-                            parameters.fluid_neumann_bcs.end())
+                      fe_face_values.reinit(cell, face_n);
+                      unsigned int p_bc_id =
+                        cell->face(face_n)->boundary_id();
+                      double boundary_values_p =
+                        parameters.fluid_neumann_bcs.at(p_bc_id);
+                      for (unsigned int q = 0; q < n_face_q_points; ++q)
                         {
-                          fe_face_values.reinit(cell, face_n);
-                          unsigned int p_bc_id =
-                            cell->face(face_n)->boundary_id();
-                          double boundary_values_p =
-                            parameters.fluid_neumann_bcs[p_bc_id];
-                          for (unsigned int q = 0; q < n_face_q_points; ++q)
+                          for (unsigned int i = 0; i < dofs_per_cell; ++i)
                             {
-                              for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                                {
-                                  local_rhs(i) += -(
-                                    fe_face_values[velocities].value(i, q) *
-                                    fe_face_values.normal_vector(q) *
-                                    boundary_values_p * fe_face_values.JxW(q));
-                                }
+                              local_rhs(i) += -(
+                                fe_face_values[velocities].value(i, q) *
+                                fe_face_values.normal_vector(q) *
+                                boundary_values_p * fe_face_values.JxW(q));
                             }
                         }
                     }
                 }
-
-              cell->get_dof_indices(local_dof_indices);
-
-              const AffineConstraints<double> &constraints_used =
-                use_nonzero_constraints ? nonzero_constraints
-                                        : zero_constraints;
-              if (assemble_system)
-                {
-                  constraints_used.distribute_local_to_global(local_matrix,
-                                                              local_rhs,
-                                                              local_dof_indices,
-                                                              system_matrix,
-                                                              system_rhs,
-                                                              true);
-                  constraints_used.distribute_local_to_global(
-                    local_mass_matrix, local_dof_indices, mass_matrix);
-                }
-              else
-                {
-                  constraints_used.distribute_local_to_global(
-                    local_rhs, local_dof_indices, system_rhs);
-                }
             }
-        }
+        };
+
+      auto copy_local_to_global = [&](const AssemblyCopyData &data) {
+        if (assemble_system)
+          {
+            constraints_used.distribute_local_to_global(data.local_matrix,
+                                                        data.local_rhs,
+                                                        data.local_dof_indices,
+                                                        system_matrix,
+                                                        system_rhs,
+                                                        true);
+            constraints_used.distribute_local_to_global(
+              data.local_mass_matrix, data.local_dof_indices, mass_matrix);
+          }
+        else
+          {
+            constraints_used.distribute_local_to_global(data.local_rhs,
+                                                        data.local_dof_indices,
+                                                        system_rhs,
+                                                        data.local_matrix);
+          }
+      };
+
+      assemble_cells(local_assemble, copy_local_to_global);
 
       if (assemble_system)
         {
@@ -352,6 +819,7 @@ namespace Fluid
           mass_matrix.compress(VectorOperation::add);
         }
       system_rhs.compress(VectorOperation::add);
+      return assemble_system;
     }
 
     template <int dim>
@@ -359,8 +827,16 @@ namespace Fluid
     InsIMEX<dim>::solve(bool use_nonzero_constraints, bool assemble_system)
     {
       TimerOutput::Scope timer_section(timer, "Solve linear system");
+      const bool use_fieldsplit = parameters.fluid_block_solver == "fieldsplit";
       if (assemble_system)
         {
+          // The preconditioner refers to the velocity operator.
+          preconditioner.reset();
+          if (parameters.fluid_matrix_free && !use_fieldsplit)
+            {
+              TimerOutput::Scope timer_section(timer2, "Matrix-free setup");
+              setup_velocity_operator();
+            }
           preconditioner.reset(
             new BlockSchurPreconditioner(timer2,
                                          parameters.grad_div,
@@ -370,25 +846,76 @@ namespace Fluid
                                          owned_partitioning,
                                          system_matrix,
                                          mass_matrix,
-                                         mass_schur));
+                                         mass_schur,
+                                         workspace,
+                                         parameters,
+                                         parameters.fluid_mixed_precision,
+                                         parameters.fluid_backend,
+                                         velocity_operator.get(),
+                                         !use_fieldsplit));
         }
 
       SolverControl solver_control(
         system_matrix.m(), std::min(1e-9, 1e-8 * system_rhs.l2_norm()), true);
-      // Because PETScWrappers::SolverGMRES requires preconditioner derived
-      // from PETScWrappers::PreconditionBase, we use dealii SolverFGMRES.
-      GrowingVectorMemory<PETScWrappers::MPI::BlockVector> vector_memory;
-      SolverFGMRES<PETScWrappers::MPI::BlockVector> gmres(solver_control,
-                                                          vector_memory);
-
       // The solution vector must be non-ghosted
-      gmres.solve(
-        system_matrix, solution_increment, system_rhs, *preconditioner);
+      if (use_fieldsplit)
+        {
+          if (!fieldsplit)
+            {
+              fieldsplit.reset(new Utils::FieldSplitSolver(
+                "fluid_",
+                {{"fieldsplit_0_ksp_type", "cg"},
+                 {"fieldsplit_0_ksp_rtol",
+                  Utilities::to_string(parameters.fluid_velocity_tolerance)},
+                 {"fieldsplit_0_pc_type", "hypre"},
+                 {"fieldsplit_0_pc_hypre_type", "boomeramg"},
+                 {"fieldsplit_1_ksp_type", "preonly"}}));
+              fieldsplit->initialize(
+                system_matrix,
+                owned_partitioning,
+                nullptr,
+                [this](PETScWrappers::MPI::Vector &dst,
+                       const PETScWrappers::MPI::Vector &src) {
+                  preconditioner->schur_vmult(dst, src);
+                });
+            }
+          // The AMG of the velocity block is only rebuilt with the system.
+          auto state = fieldsplit->solve(solution_increment,
+                                         system_rhs,
+                                         solver_control.tolerance(),
+                                         !assemble_system);
+          solver_control.check(state.first, state.second);
+        }
+      else if (parameters.fluid_recycled_vectors > 0)
+        {
+          Utils::SolverGCRO<PETScWrappers::MPI::BlockVector> gcro(
+            solver_control,
+            recycle_space,
+            Utils::SolverGCRO<PETScWrappers::MPI::BlockVector>::AdditionalData(
+              30, parameters.fluid_recycled_vectors));
+          gcro.solve(
+            system_matrix, solution_increment, system_rhs, *preconditioner);
+        }
+      else
+        {
+          // Because PETScWrappers::SolverGMRES requires preconditioner
+          // derived from PETScWrappers::PreconditionBase, we use dealii
+          // SolverFGMRES.
+          GrowingVectorMemory<PETScWrappers::MPI::BlockVector> vector_memory;
+          SolverFGMRES<PETScWrappers::MPI::BlockVector> gmres(solver_control,
+                                                              vector_memory);
+          gmres.solve(
+            system_matrix, solution_increment, system_rhs, *preconditioner);
+        }
 
       const AffineConstraints<double> &constraints_used =
         use_nonzero_constraints ? nonzero_constraints : zero_constraints;
       constraints_used.distribute(solution_increment);
 
+      performance.add("Krylov iterations", solver_control.last_step());
+      performance.add("Linear solves", 1);
+      telemetry.add("Krylov iterations", solver_control.last_step());
+      telemetry.set("Krylov residual", solver_control.last_value());
       return {solver_control.last_step(), solver_control.last_value()};
     }
 
@@ -405,16 +932,20 @@ namespace Fluid
         }
 
       time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
       pcout << std::string(96, '*') << std::endl
             << "Time step = " << time.get_timestep()
             << ", at t = " << std::scientific << time.current() << std::endl;
 
       // Resetting
       solution_increment = 0;
-      assemble(apply_nonzero_constraints,
-               assemble_system || (parameters.simulation_type == "Fluid" &&
-                                   time.time_to_refine()));
-      auto state = solve(apply_nonzero_constraints, assemble_system);
+      const bool lhs_assembled =
+        assemble(apply_nonzero_constraints,
+                 assemble_system || (parameters.simulation_type == "Fluid" &&
+                                     time.time_to_refine()));
+      auto state = solve(apply_nonzero_constraints, lhs_assembled);
+      n_linear_iterations = state.first;
 
       // Note we have to use a non-ghosted vector in order to do addition.
       PETScWrappers::MPI::BlockVector tmp;
@@ -426,16 +957,17 @@ namespace Fluid
       pcout << std::scientific << std::left << " GMRES_ITR = " << std::setw(3)
             << state.first << " GMRES_RES = " << state.second << std::endl;
 
-      // Update stress for output
-      update_stress();
-
       // Output
       if (parameters.simulation_type == "Fluid" && time.time_to_save())
         {
           save_checkpoint(time.get_timestep());
         }
+      monitor.monitor(time.get_timestep(), time.current(), present_solution);
       if (time.time_to_output())
         {
+          // The stress is only needed by the output.
+          if (parameters.output_field("stress"))
+            update_stress();
           output_results(time.get_timestep());
         }
       if (parameters.simulation_type == "Fluid" && time.time_to_refine())
@@ -456,7 +988,9 @@ namespace Fluid
       bool success_load = load_checkpoint();
       if (!success_load)
         {
-          triangulation.refine_global(parameters.global_refinements[0]);
+          // The mesh of a reused setup is refined already.
+          if (!setup_reused)
+            triangulation.refine_global(parameters.global_refinements[0]);
           setup_dofs();
           make_constraints();
           initialize_system();
@@ -465,6 +999,7 @@ namespace Fluid
       // Time loop.
       while (time.end() - time.current() > 1e-12)
         {
+          adapt_time_step();
           // Only use nonzero constraints at the very first time step
           // We have to assemble the LHS twice: once using nonzero_constraints,
           // once using zero_constraints.
@@ -0,0 +1,552 @@
+#include "mpi_insprojection.h"
+
+namespace Fluid
+{
+  namespace MPI
+  {
+    template <int dim, typename Backend>
+    InsProjection<dim, Backend>::InsProjection(
+      parallel::distributed::Triangulation<dim> &tria,
+      const Parameters::AllParameters &parameters)
+      : FluidSolver<dim, Backend>(tria, parameters), lhs_delta_t(0)
+    {
+      Assert(
+        parameters.fluid_velocity_degree - parameters.fluid_pressure_degree ==
+          1,
+        ExcMessage(
+          "Velocity finite element should be one order higher than pressure!"));
+    }
+
+    template <int dim, typename Backend>
+    void InsProjection<dim, Backend>::initialize_system()
+    {
+      FluidSolver<dim, Backend>::initialize_system();
+      make_pressure_constraints();
+      increment.reinit(owned_partitioning, mpi_communicator);
+      intermediate_solution.reinit(
+        owned_partitioning, relevant_partitioning, mpi_communicator);
+      lhs_delta_t = 0;
+    }
+
+    template <int dim, typename Backend>
+    void InsProjection<dim, Backend>::make_pressure_constraints()
+    {
+      pressure_constraints.clear();
+      pressure_constraints.reinit(locally_relevant_dofs);
+      DoFTools::make_hanging_node_constraints(dof_handler,
+                                              pressure_constraints);
+      std::vector<bool> mask(dim + 1, false);
+      mask[dim] = true;
+      for (const auto &bc : parameters.fluid_neumann_bcs)
+        {
+          VectorTools::interpolate_boundary_values(
+            MappingQGeneric<dim>(parameters.fluid_velocity_degree),
+            dof_handler,
+            bc.first,
+            Functions::ZeroFunction<dim>(dim + 1),
+            pressure_constraints,
+            ComponentMask(mask));
+        }
+      if (parameters.n_fluid_neumann_bcs == 0)
+        {
+          // Every process proposes its first unconstrained pressure dof.
+          types::global_dof_index pinned = dof_handler.n_dofs();
+          for (const auto i : owned_partitioning[1])
+            {
+              const types::global_dof_index dof = dofs_per_block[0] + i;
+              if (!pressure_constraints.is_constrained(dof))
+                {
+                  pinned = dof;
+                  break;
+                }
+            }
+          pinned = Utilities::MPI::min(pinned, mpi_communicator);
+          if (locally_relevant_dofs.is_element(pinned))
+            {
+              pressure_constraints.add_line(pinned);
+            }
+        }
+      pressure_constraints.close();
+    }
+
+    template <int dim, typename Backend>
+    void
+    InsProjection<dim, Backend>::assemble(bool use_nonzero_constraints,
+                                          bool assemble_system)
+    {
+      TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::CounterRegion counter_region("Assemble system");
+
+      AffineConstraints<double> constraints_used;
+      constraints_used.copy_from(use_nonzero_constraints ? nonzero_constraints
+                                                         : zero_constraints);
+      constraints_used.merge(
+        pressure_constraints,
+        AffineConstraints<double>::MergeConflictBehavior::left_object_wins);
+
+      const double viscosity = parameters.viscosity;
+      Tensor<1, dim> gravity;
+      for (unsigned int i = 0; i < dim; ++i)
+        gravity[i] = parameters.gravity[i];
+
+      if (assemble_system)
+        {
+          system_matrix = 0;
+          mass_matrix = 0;
+        }
+      system_rhs = 0;
+
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      const unsigned int n_q_points = volume_quad_formula.size();
+      const unsigned int n_face_q_points = face_quad_formula.size();
+
+      const FEValuesExtractors::Vector velocities(0);
+
+      // The cell loop runs on WorkStream, see assemble_cells.
+      auto local_assemble =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            AssemblyScratchData &scratch,
+            AssemblyCopyData &data) {
+          FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+          auto &local_matrix = data.local_matrix;
+          auto &local_mass_matrix = data.local_mass_matrix;
+          auto &local_rhs = data.local_rhs;
+          auto &current_velocity_values = scratch.current_velocity_values;
+          auto &current_velocity_gradients = scratch.current_velocity_gradients;
+          auto &current_pressure_values = scratch.current_pressure_values;
+          auto &fsi_acc_values = scratch.fsi_acc_values;
+          auto &div_phi_u = scratch.div_phi_u;
+          auto &phi_u = scratch.phi_u;
+          auto &grad_phi_u = scratch.grad_phi_u;
+          auto &phi_p = scratch.phi_p;
+          auto &grad_phi_p = scratch.grad_phi_p;
+
+          const unsigned int cell_index = cell->active_cell_index();
+          const SymmetricTensor<2, dim> &fsi_stress =
+            cell_property.fsi_stress[cell_index];
+          const int ind = cell_property.indicator[cell_index];
+          const double rho = parameters.fluid_rho;
+
+          scratch.reinit(cell);
+          cell->get_dof_indices(data.local_dof_indices);
+
+          // Even without the LHS, the local matrix is needed to take the
+          // inhomogeneous constraints into account in the RHS.
+          bool local_lhs = assemble_system;
+          for (auto dof : data.local_dof_indices)
+            {
+              local_lhs = local_lhs ||
+                          constraints_used.is_inhomogeneously_constrained(dof);
+            }
+
+          local_matrix = 0;
+          local_mass_matrix = 0;
+          local_rhs = 0;
+
+          {
+            std::lock_guard<std::mutex> lock(assembly_mutex);
+            scratch.get_velocity_values(
+              present_solution, current_velocity_values);
+
+            scratch.get_velocity_gradients(
+              present_solution, current_velocity_gradients);
+
+            scratch.get_pressure_values(
+              present_solution, current_pressure_values);
+
+            scratch.get_velocity_values(fsi_acceleration, fsi_acc_values);
+          }
+
+          // The system matrix has the velocity operator in the (0, 0) block
+          // and the pressure Laplacian in the (1, 1) block, the mass matrix
+          // the two mass matrices.
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              for (unsigned int k = 0; k < dofs_per_cell; ++k)
+                {
+                  div_phi_u[k] = scratch.velocity_divergence(k, q);
+                  grad_phi_u[k] = scratch.velocity_gradient(k, q);
+                  phi_u[k] = scratch.velocity_value(k, q);
+                  phi_p[k] = scratch.pressure_value(k, q);
+                  grad_phi_p[k] = scratch.pressure_gradient(k, q);
+                }
+
+              for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                {
+                  if (local_lhs)
+                    {
+                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                        {
+                          local_matrix(i, j) +=
+                            (viscosity * scalar_product(grad_phi_u[j],
+                                                        grad_phi_u[i]) +
+                             phi_u[i] * phi_u[j] / time.get_delta_t() * rho +
+                             grad_phi_p[i] * grad_phi_p[j]) *
+                            scratch.JxW(q);
+                          local_mass_matrix(i, j) +=
+                            (phi_u[i] * phi_u[j] + phi_p[i] * phi_p[j]) *
+                            scratch.JxW(q);
+                        }
+                    }
+                  local_rhs(i) -=
+                    (viscosity * scalar_product(current_velocity_gradients[q],
+                                                grad_phi_u[i]) -
+                     current_pressure_values[q] * div_phi_u[i] +
+                     current_velocity_gradients[q] *
+                       current_velocity_values[q] * phi_u[i] * rho -
+                     gravity * phi_u[i] * rho) *
+                    scratch.JxW(q);
+                  if (ind == 1)
+                    {
+                      local_rhs(i) +=
+                        (scalar_product(grad_phi_u[i], fsi_stress) +
+                         (fsi_acc_values[q] * rho * phi_u[i])) *
+                        scratch.JxW(q);
+                    }
+                }
+            }
+
+          // Impose pressure boundary here if specified, loop over faces on
+          // the cell and apply pressure boundary conditions:
+          // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
+          if (parameters.n_fluid_neumann_bcs != 0)
+            {
+              for (unsigned int face_n = 0;
+                   face_n < GeometryInfo<dim>::faces_per_cell;
+                   ++face_n)
+                {
+                  if (cell->at_boundary(face_n) &&
+                      parameters.fluid_neumann_bcs.find(
+                        cell->face(face_n)->boundary_id()) !=
+                        parameters.fluid_neumann_bcs.end())
+                    {
+                      fe_face_values.reinit(cell, face_n);
+                      unsigned int p_bc_id =
+                        cell->face(face_n)->boundary_id();
+                      double boundary_values_p =
+                        parameters.fluid_neumann_bcs.at(p_bc_id);
+                      for (unsigned int q = 0; q < n_face_q_points; ++q)
+                        {
+                          for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                            {
+                              local_rhs(i) += -(
+                                fe_face_values[velocities].value(i, q) *
+                                fe_face_values.normal_vector(q) *
+                                boundary_values_p * fe_face_values.JxW(q));
+                            }
+                        }
+                    }
+                }
+            }
+        };
+
+      auto copy_local_to_global = [&](const AssemblyCopyData &data) {
+        if (assemble_system)
+          {
+            constraints_used.distribute_local_to_global(data.local_matrix,
+                                                        data.local_rhs,
+                                                        data.local_dof_indices,
+                                                        system_matrix,
+                                                        system_rhs,
+                                                        true);
+            constraints_used.distribute_local_to_global(
+              data.local_mass_matrix, data.local_dof_indices, mass_matrix);
+          }
+        else
+          {
+            constraints_used.distribute_local_to_global(data.local_rhs,
+                                                        data.local_dof_indices,
+                                                        system_rhs,
+                                                        data.local_matrix);
+          }
+      };
+
+      assemble_cells(local_assemble, copy_local_to_global);
+
+      if (assemble_system)
+        {
+          system_matrix.compress(VectorOperation::add);
+          mass_matrix.compress(VectorOperation::add);
+        }
+      system_rhs.compress(VectorOperation::add);
+    }
+
+    template <int dim, typename Backend>
+    void InsProjection<dim, Backend>::assemble_projection_rhs(
+      bool pressure_poisson)
+    {
+      TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::CounterRegion counter_region("Assemble system");
+
+      // The Poisson RHS is zero on the pressure boundaries, and the velocity
+      // update on the constrained velocity dofs.
+      const AffineConstraints<double> &constraints_used =
+        pressure_poisson ? pressure_constraints : zero_constraints;
+      const double rho = parameters.fluid_rho;
+      const double dt = time.get_delta_t();
+      system_rhs = 0;
+
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      const unsigned int n_q_points = volume_quad_formula.size();
+
+      auto local_assemble =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            AssemblyScratchData &scratch,
+            AssemblyCopyData &data) {
+          auto &local_rhs = data.local_rhs;
+          auto &current_velocity_divergences =
+            scratch.current_velocity_divergences;
+          auto &current_pressure_gradients = scratch.current_pressure_gradients;
+
+          scratch.reinit(cell);
+          cell->get_dof_indices(data.local_dof_indices);
+          local_rhs = 0;
+
+          {
+            std::lock_guard<std::mutex> lock(assembly_mutex);
+            if (pressure_poisson)
+              {
+                scratch.get_velocity_divergences(
+                  intermediate_solution, current_velocity_divergences);
+              }
+            else
+              {
+                scratch.get_pressure_gradients(
+                  intermediate_solution, current_pressure_gradients);
+              }
+          }
+
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                {
+                  if (pressure_poisson)
+                    {
+                      local_rhs(i) -= rho / dt *
+                                      current_velocity_divergences[q] *
+                                      scratch.pressure_value(i, q) *
+                                      scratch.JxW(q);
+                    }
+                  else
+                    {
+                      local_rhs(i) -= dt / rho *
+                                      current_pressure_gradients[q] *
+                                      scratch.velocity_value(i, q) *
+                                      scratch.JxW(q);
+                    }
+                }
+            }
+        };
+
+      auto copy_local_to_global = [&](const AssemblyCopyData &data) {
+        constraints_used.distribute_local_to_global(
+          data.local_rhs, data.local_dof_indices, system_rhs);
+      };
+
+      assemble_cells(local_assemble, copy_local_to_global);
+      system_rhs.compress(VectorOperation::add);
+    }
+
+    template <int dim, typename Backend>
+    unsigned int InsProjection<dim, Backend>::solve_block(
+      const typename Traits::SparseMatrix &matrix,
+      VectorType &x,
+      const VectorType &b,
+      const typename Traits::PreconditionSelector &preconditioner,
+      const std::string &section)
+    {
+      TimerOutput::Scope timer_section(timer2, section);
+      SolverControl solver_control(
+        b.size(), std::max(1e-12, 1e-8 * b.l2_norm()), true);
+      typename Traits::SolverCG cg(
+        solver_control, mpi_communicator, parameters.fluid_inner_krylov);
+      x = 0;
+      cg.solve(matrix, x, b, preconditioner);
+      performance.add("Krylov iterations", solver_control.last_step());
+      performance.add("Linear solves", 1);
+      telemetry.add("Krylov iterations", solver_control.last_step());
+      return solver_control.last_step();
+    }
+
+    template <int dim, typename Backend>
+    void
+    InsProjection<dim, Backend>::run_one_step(bool apply_nonzero_constraints,
+                                              bool assemble_system)
+    {
+      std::cout.precision(6);
+      std::cout.width(12);
+
+      if (time.get_timestep() == 0)
+        {
+          output_results(0);
+        }
+
+      time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
+      pcout << std::string(96, '*') << std::endl
+            << "Time step = " << time.get_timestep()
+            << ", at t = " << std::scientific << time.current() << std::endl;
+
+      // The matrices only change with the time step and the constrained
+      // dofs, which the callers flag with assemble_system.
+      const bool lhs = assemble_system || !(lhs_delta_t > 0) ||
+                       lhs_delta_t != time.get_delta_t() ||
+                       (parameters.simulation_type == "Fluid" &&
+                        time.time_to_refine());
+      assemble(apply_nonzero_constraints, lhs);
+      if (lhs)
+        {
+          lhs_delta_t = time.get_delta_t();
+          // The AMG of Trilinos aggregates the velocity node by node with
+          // the constant modes of its components.
+          Traits::initialize_preconditioner(
+            velocity_preconditioner,
+            PreconditionSelector::choose(
+              parameters.fluid_velocity_preconditioner, "amg"),
+            system_matrix.block(0, 0),
+            dof_handler,
+            fe.component_mask(FEValuesExtractors::Vector(0)));
+          Traits::initialize_preconditioner(
+            poisson_preconditioner,
+            PreconditionSelector::choose(parameters.fluid_schur_preconditioner,
+                                         "amg"),
+            system_matrix.block(1, 1),
+            dof_handler,
+            fe.component_mask(FEValuesExtractors::Scalar(dim)));
+          velocity_mass_preconditioner.initialize("jacobi",
+                                                  mass_matrix.block(0, 0));
+          pressure_mass_preconditioner.initialize(
+            PreconditionSelector::choose(parameters.fluid_mass_preconditioner,
+                                         "jacobi"),
+            mass_matrix.block(1, 1));
+        }
+
+      const AffineConstraints<double> &velocity_constraints =
+        apply_nonzero_constraints ? nonzero_constraints : zero_constraints;
+      unsigned int iterations = 0;
+      {
+        TimerOutput::Scope timer_section(timer, "Solve linear system");
+        increment = 0;
+        iterations = solve_block(system_matrix.block(0, 0),
+                                 increment.block(0),
+                                 system_rhs.block(0),
+                                 velocity_preconditioner,
+                                 "CG for velocity");
+        velocity_constraints.distribute(increment);
+      }
+
+      // The intermediate velocity with the old pressure.
+      BlockVectorType tmp;
+      tmp.reinit(owned_partitioning, mpi_communicator);
+      tmp = present_solution;
+      tmp.block(0) += increment.block(0);
+      intermediate_solution = tmp;
+
+      assemble_projection_rhs(true);
+      typename Utils::GenericVectorPool<VectorType>::Handle rotational(
+        workspace, 1);
+      {
+        TimerOutput::Scope timer_section(timer, "Solve linear system");
+        iterations = std::max(iterations,
+                              solve_block(system_matrix.block(1, 1),
+                                          increment.block(1),
+                                          system_rhs.block(1),
+                                          poisson_preconditioner,
+                                          "CG for pressure Poisson"));
+        pressure_constraints.distribute(increment);
+        // The Poisson RHS is the divergence of the intermediate velocity
+        // scaled by -rho/dt, so it gives the rotational term as well.
+        solve_block(mass_matrix.block(1, 1),
+                    *rotational,
+                    system_rhs.block(1),
+                    pressure_mass_preconditioner,
+                    "CG for Mp");
+      }
+
+      // The velocity update only reads the pressure increment.
+      intermediate_solution = increment;
+      assemble_projection_rhs(false);
+      {
+        TimerOutput::Scope timer_section(timer, "Solve linear system");
+        typename Utils::GenericVectorPool<VectorType>::Handle correction(
+          workspace, 0);
+        solve_block(mass_matrix.block(0, 0),
+                    *correction,
+                    system_rhs.block(0),
+                    velocity_mass_preconditioner,
+                    "CG for Mu");
+        increment.block(0) += *correction;
+        increment.block(1).add(
+          parameters.viscosity * time.get_delta_t() / parameters.fluid_rho,
+          *rotational);
+        // The correction is zero on the constrained velocity dofs, which
+        // keep the values of the velocity step.
+        velocity_constraints.distribute(increment);
+      }
+      n_linear_iterations = iterations;
+
+      tmp = present_solution;
+      tmp += increment;
+      present_solution = tmp;
+
+      pcout << std::scientific << std::left << " CG_ITR = " << std::setw(3)
+            << iterations << std::endl;
+
+      // Output
+      if (parameters.simulation_type == "Fluid" && time.time_to_save())
+        {
+          save_checkpoint(time.get_timestep());
+        }
+      monitor.monitor(time.get_timestep(), time.current(), present_solution);
+      if (time.time_to_output())
+        {
+          // The stress is only needed by the output.
+          if (parameters.output_field("stress"))
+            update_stress();
+          output_results(time.get_timestep());
+        }
+      if (parameters.simulation_type == "Fluid" && time.time_to_refine())
+        {
+          refine_mesh(parameters.global_refinements[0],
+                      parameters.global_refinements[0] + 3);
+        }
+    }
+
+    template <int dim, typename Backend>
+    void InsProjection<dim, Backend>::run()
+    {
+      pcout << "Running with " << Traits::name() << " on "
+            << Utilities::MPI::n_mpi_processes(mpi_communicator)
+            << " MPI rank(s)..." << std::endl;
+
+      // Try load from previous computation
+      bool success_load = load_checkpoint();
+      if (!success_load)
+        {
+          // The mesh of a reused setup is refined already.
+          if (!setup_reused)
+            triangulation.refine_global(parameters.global_refinements[0]);
+          setup_dofs();
+          make_constraints();
+          initialize_system();
+        }
+
+      // Time loop.
+      while (time.end() - time.current() > 1e-12)
+        {
+          adapt_time_step();
+          // Only use nonzero constraints at the very first time step
+          run_one_step(time.get_timestep() == 0,
+                       time.get_timestep() < 2 || success_load);
+        }
+    }
+
+    template class InsProjection<2>;
+    template class InsProjection<3>;
+#ifdef OPENIFEM_WITH_TRILINOS
+    template class InsProjection<2, Utils::TrilinosBackend>;
+    template class InsProjection<3, Utils::TrilinosBackend>;
+#endif
+  } // namespace MPI
+} // namespace Fluid
@@ -6,11 +6,11 @@ namespace Solid
   {
     using namespace dealii;
 
-    template <int dim>
-    LinearElasticity<dim>::LinearElasticity(
+    template <int dim, typename Backend>
+    LinearElasticity<dim, Backend>::LinearElasticity(
       parallel::distributed::Triangulation<dim> &tria,
       const Parameters::AllParameters &parameters)
-      : SolidSolver<dim>(tria, parameters)
+      : SolidSolver<dim, Backend>(tria, parameters)
     {
       material.resize(parameters.n_solid_parts, LinearElasticMaterial<dim>());
       for (unsigned int i = 0; i < parameters.n_solid_parts; ++i)
@@ -23,10 +23,11 @@ namespace Solid
         }
     }
 
-    template <int dim>
-    void LinearElasticity<dim>::assemble_system(const bool is_initial)
+    template <int dim, typename Backend>
+    void LinearElasticity<dim, Backend>::assemble_system(const bool is_initial)
     {
       TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::CounterRegion counter_region("Assemble system");
 
       double gamma = 0.5 + parameters.damping;
       double beta = gamma / 2;
@@ -69,6 +70,21 @@ namespace Solid
       // A "viewer" to describe the nodal dofs as a vector.
       FEValuesExtractors::Vector displacements(0);
 
+      std::vector<std::vector<Tensor<1, dim>>> fsi_stress_rows_values(dim);
+      for (unsigned int d = 0; d < dim; ++d)
+        {
+          fsi_stress_rows_values[d].resize(n_f_q_points);
+        }
+      // The FSI traction is evaluated in the current configuration, which
+      // needs the displacement of the vertices on the ghost dofs too.
+      VectorType relevant_displacement;
+      if (parameters.simulation_type == "FSI")
+        {
+          relevant_displacement.reinit(
+            locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
+          relevant_displacement = current_displacement;
+        }
+
       // Loop over cells
       for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
            ++cell)
@@ -131,51 +147,97 @@ namespace Solid
               cell->get_dof_indices(local_dof_indices);
 
               // Traction or Pressure
-              for (unsigned int face = 0;
-                   face < GeometryInfo<dim>::faces_per_cell;
-                   ++face)
+              for (const auto &neumann_face :
+                   neumann_faces(cell->active_cell_index()))
                 {
-                  if (cell->face(face)->at_boundary())
+                  const unsigned int face = neumann_face.face;
+                  unsigned int id = neumann_face.boundary_id;
+                  std::vector<double> value;
+                  Tensor<1, dim> traction;
+                  if (parameters.simulation_type != "FSI")
                     {
-                      unsigned int id = cell->face(face)->boundary_id();
-                      if (parameters.solid_neumann_bcs.find(id) !=
-                          parameters.solid_neumann_bcs.end())
+                      value = parameters.solid_neumann_bcs[id];
+                      if (parameters.solid_neumann_bc_type == "Traction")
                         {
-                          std::vector<double> value =
-                            parameters.solid_neumann_bcs[id];
-                          Tensor<1, dim> traction;
-                          if (parameters.solid_neumann_bc_type == "Traction")
+                          for (unsigned int i = 0; i < dim; ++i)
                             {
-                              for (unsigned int i = 0; i < dim; ++i)
-                                {
-                                  traction[i] = value[i];
-                                }
+                              traction[i] = value[i];
                             }
+                        }
+                    }
 
-                          fe_face_values.reinit(cell, face);
-                          for (unsigned int q = 0; q < n_f_q_points; ++q)
+                  // Get FSI stress values on face quadrature points
+                  std::vector<Tensor<2, dim>> fsi_stress(n_f_q_points);
+                  if (parameters.simulation_type == "FSI")
+                    {
+                      std::vector<Point<dim>> vertex_displacement(
+                        GeometryInfo<dim>::vertices_per_face);
+                      for (unsigned int v = 0;
+                           v < GeometryInfo<dim>::vertices_per_face;
+                           ++v)
+                        {
+                          for (unsigned int d = 0; d < dim; ++d)
                             {
-                              if (parameters.solid_neumann_bc_type ==
-                                  "Pressure")
-                                {
-                                  // The normal is w.r.t. reference
-                                  // configuration!
-                                  traction = fe_face_values.normal_vector(q);
-                                  traction *= value[0];
-                                }
-                              for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                              vertex_displacement[v][d] =
+                                relevant_displacement(
+                                  cell->face(face)->vertex_dof_index(v, d));
+                            }
+                          cell->face(face)->vertex(v) += vertex_displacement[v];
+                        }
+                      fe_face_values.reinit(cell, face);
+                      for (unsigned int d = 0; d < dim; ++d)
+                        {
+                          fe_face_values[displacements].get_function_values(
+                            fsi_stress_rows[d], fsi_stress_rows_values[d]);
+                        }
+                      for (unsigned int v = 0;
+                           v < GeometryInfo<dim>::vertices_per_face;
+                           ++v)
+                        {
+                          cell->face(face)->vertex(v) -= vertex_displacement[v];
+                        }
+                      for (unsigned int q = 0; q < n_f_q_points; ++q)
+                        {
+                          for (unsigned int d1 = 0; d1 < dim; ++d1)
+                            {
+                              for (unsigned int d2 = 0; d2 < dim; ++d2)
                                 {
-                                  const unsigned int component_j =
-                                    fe.system_to_component_index(j).first;
-                                  // +external force
-                                  local_rhs(j) +=
-                                    fe_face_values.shape_value(j, q) *
-                                    traction[component_j] *
-                                    fe_face_values.JxW(q);
+                                  fsi_stress[q][d1][d2] =
+                                    fsi_stress_rows_values[d1][q][d2];
                                 }
                             }
                         }
                     }
+                  else
+                    {
+                      fe_face_values.reinit(cell, face);
+                    }
+
+                  for (unsigned int q = 0; q < n_f_q_points; ++q)
+                    {
+                      if (parameters.simulation_type != "FSI" &&
+                          parameters.solid_neumann_bc_type == "Pressure")
+                        {
+                          // The normal is w.r.t. reference
+                          // configuration!
+                          traction = fe_face_values.normal_vector(q);
+                          traction *= value[0];
+                        }
+                      else if (parameters.simulation_type == "FSI")
+                        {
+                          traction =
+                            fsi_stress[q] * fe_face_values.normal_vector(q);
+                        }
+                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                        {
+                          const unsigned int component_j =
+                            fe.system_to_component_index(j).first;
+                          // +external force
+                          local_rhs(j) += fe_face_values.shape_value(j, q) *
+                                          traction[component_j] *
+                                          fe_face_values.JxW(q);
+                        }
+                    }
                 }
 
               // Now distribute local data to the system, and apply the
@@ -195,8 +257,8 @@ namespace Solid
       stiffness_matrix.compress(VectorOperation::add);
     }
 
-    template <int dim>
-    void LinearElasticity<dim>::run_one_step(bool first_step)
+    template <int dim, typename Backend>
+    void LinearElasticity<dim, Backend>::run_one_step(bool first_step)
     {
       std::cout.precision(6);
       std::cout.width(12);
@@ -215,49 +277,46 @@ namespace Solid
           this->output_results(time.get_timestep());
         }
 
+      else if (parameters.simulation_type == "FSI" || time.adaptive())
+        // The system matrix depends on the time step size.
+        assemble_system(false);
+
       const double dt = time.get_delta_t();
+      const Utils::NewmarkUpdate newmark(beta, gamma, dt);
 
-      PETScWrappers::MPI::Vector tmp1(locally_owned_dofs, mpi_communicator);
-      PETScWrappers::MPI::Vector tmp2(locally_owned_dofs, mpi_communicator);
+      VectorType tmp1(locally_owned_dofs, mpi_communicator);
+      VectorType tmp2(locally_owned_dofs, mpi_communicator);
 
-      PETScWrappers::MPI::Vector tmp3(locally_owned_dofs, mpi_communicator);
+      VectorType tmp3(locally_owned_dofs, mpi_communicator);
 
       time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
       pcout << std::string(91, '*') << std::endl
             << "Time step = " << time.get_timestep()
             << ", at t = " << std::scientific << time.current() << std::endl;
 
       // Modify the RHS
       tmp1 = system_rhs;
-      tmp2 = previous_displacement;
-      tmp2.add(
-        dt, previous_velocity, (0.5 - beta) * dt * dt, previous_acceleration);
+      newmark.predict(
+        tmp2, previous_displacement, previous_velocity, previous_acceleration);
       stiffness_matrix.vmult(tmp3, tmp2);
       tmp1 -= tmp3;
 
-      auto state = this->solve(system_matrix, current_acceleration, tmp1);
+      auto state =
+        parameters.solid_cached_factorization
+          ? this->solve_factorized(current_acceleration, tmp1)
+          : this->solve(system_matrix, current_acceleration, tmp1);
 
       // update the current velocity
       // \f$ v_{n+1} = v_n + (1-\gamma)\Delta{t}a_n + \gamma\Delta{t}a_{n+1}
-      // \f$
-      current_velocity = previous_velocity;
-      current_velocity.add(dt * (1 - gamma),
-                           previous_acceleration,
-                           dt * gamma,
-                           current_acceleration);
-
-      // update the current displacement
-      current_displacement = previous_displacement;
-      current_displacement.add(dt, previous_velocity);
-      current_displacement.add(dt * dt * (0.5 - beta),
-                               previous_acceleration,
-                               dt * dt * beta,
-                               current_acceleration);
-
-      // update the previous values
-      previous_acceleration = current_acceleration;
-      previous_velocity = current_velocity;
-      previous_displacement = current_displacement;
+      // \f$ and displacement, and the previous values, in one pass
+      newmark.correct(current_acceleration,
+                      current_velocity,
+                      current_displacement,
+                      previous_acceleration,
+                      previous_velocity,
+                      previous_displacement);
 
       pcout << std::scientific << std::left << " CG iteration: " << std::setw(3)
             << state.first << " CG residual: " << state.second << std::endl;
@@ -279,5 +338,9 @@ namespace Solid
 
     template class LinearElasticity<2>;
     template class LinearElasticity<3>;
+#ifdef OPENIFEM_WITH_TRILINOS
+    template class LinearElasticity<2, Utils::TrilinosBackend>;
+    template class LinearElasticity<3, Utils::TrilinosBackend>;
+#endif
   } // namespace MPI
 } // namespace Solid
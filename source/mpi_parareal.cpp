@@ -0,0 +1,299 @@
+#include "mpi_parareal.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace fs = std::experimental::filesystem;
+
+namespace Fluid
+{
+  namespace MPI
+  {
+    namespace
+    {
+      /// A copy of a solution without the ghost entries.
+      PETScWrappers::MPI::BlockVector
+      owned_copy(const PETScWrappers::MPI::BlockVector &solution,
+                 const MPI_Comm &comm)
+      {
+        std::vector<IndexSet> owned;
+        for (unsigned int b = 0; b < solution.n_blocks(); ++b)
+          {
+            owned.push_back(solution.block(b).locally_owned_elements());
+          }
+        PETScWrappers::MPI::BlockVector result(owned, comm);
+        result = solution;
+        return result;
+      }
+
+      const int parareal_tag = 8102;
+    } // namespace
+
+    template <int dim>
+    Parareal<dim>::Parareal(const MPI_Comm &comm,
+                            const Parameters::AllParameters &parameters)
+      : fine_parameters(parameters),
+        coarse_parameters(parameters),
+        n_groups(parameters.parareal_groups),
+        world_communicator(comm),
+        pcout(std::cout, Utilities::MPI::this_mpi_process(comm) == 0)
+    {
+      const unsigned int n_ranks = Utilities::MPI::n_mpi_processes(comm);
+      const unsigned int rank = Utilities::MPI::this_mpi_process(comm);
+      AssertThrow(n_ranks % n_groups == 0,
+                  ExcMessage("The processes must split into Parareal groups "
+                             "of the same size!"));
+      AssertThrow(!parameters.adaptive_time_stepping,
+                  ExcMessage("Parareal needs a constant time step size!"));
+      AssertThrow(parameters.refinement_interval >= parameters.end_time,
+                  ExcMessage("The mesh cannot be refined in Parareal!"));
+      AssertThrow(parameters.parareal_slice_steps %
+                      parameters.parareal_coarse_factor ==
+                    0,
+                  ExcMessage("Slice steps must be a multiple of Coarse step "
+                             "factor!"));
+      n_fine_steps = parameters.parareal_slice_steps;
+      n_coarse_steps = n_fine_steps / parameters.parareal_coarse_factor;
+      const double slice_length = n_fine_steps * parameters.time_step;
+      n_slices = static_cast<unsigned int>(
+        std::round(parameters.end_time / slice_length));
+      AssertThrow(n_slices > 0 &&
+                    std::abs(n_slices * slice_length - parameters.end_time) <
+                      1e-9 * parameters.end_time,
+                  ExcMessage("End time must be a multiple of the length of "
+                             "the Parareal slices!"));
+
+      // The coarse solver only propagates the solution.
+      coarse_parameters.time_step *= parameters.parareal_coarse_factor;
+      coarse_parameters.output_interval = 2 * parameters.end_time;
+      coarse_parameters.save_interval = 2 * parameters.end_time;
+      coarse_parameters.refinement_interval = 2 * parameters.end_time;
+      coarse_parameters.performance_summary = "";
+      coarse_parameters.telemetry_prefix = "";
+      coarse_parameters.monitor_file = "";
+      coarse_parameters.memory_report = false;
+
+      // The groups are contiguous blocks of ranks, so that the processes of
+      // the same rank in their groups own the same dofs.
+      const unsigned int group_size = n_ranks / n_groups;
+      group = rank / group_size;
+      int ierr = MPI_Comm_split(comm, group, rank, &group_communicator);
+      AssertThrowMPI(ierr);
+      ierr =
+        MPI_Comm_split(comm, rank % group_size, group, &slice_communicator);
+      AssertThrowMPI(ierr);
+
+      base_path = fs::current_path();
+      const fs::path path =
+        base_path / ("parareal-" + Utilities::int_to_string(group, 3));
+      if (Utilities::MPI::this_mpi_process(group_communicator) == 0)
+        {
+          fs::create_directories(path);
+        }
+      ierr = MPI_Barrier(group_communicator);
+      AssertThrowMPI(ierr);
+      fs::current_path(path);
+    }
+
+    template <int dim>
+    Parareal<dim>::~Parareal()
+    {
+      fs::current_path(base_path);
+      MPI_Comm_free(&slice_communicator);
+      MPI_Comm_free(&group_communicator);
+    }
+
+    template <int dim>
+    Utils::Time::State Parareal<dim>::slice_start(
+      const unsigned int slice,
+      const double delta_t,
+      const unsigned int n_steps) const
+    {
+      const double begin = slice * n_steps * delta_t;
+      return {slice * n_steps,
+              begin,
+              slice == 0 ? 0.0 : begin - delta_t,
+              delta_t,
+              delta_t};
+    }
+
+    template <int dim>
+    void Parareal<dim>::send(const PETScWrappers::MPI::BlockVector &solution,
+                             const unsigned int target) const
+    {
+      std::vector<double> buffer;
+      for (unsigned int b = 0; b < solution.n_blocks(); ++b)
+        {
+          std::vector<types::global_dof_index> indices;
+          solution.block(b).locally_owned_elements().fill_index_vector(
+            indices);
+          std::vector<double> values(indices.size());
+          solution.block(b).extract_subvector_to(indices, values);
+          buffer.insert(buffer.end(), values.begin(), values.end());
+        }
+      const int ierr = MPI_Send(buffer.data(),
+                                buffer.size(),
+                                MPI_DOUBLE,
+                                target,
+                                parareal_tag,
+                                slice_communicator);
+      AssertThrowMPI(ierr);
+    }
+
+    template <int dim>
+    void Parareal<dim>::receive(PETScWrappers::MPI::BlockVector &solution,
+                                const unsigned int source) const
+    {
+      std::vector<std::vector<types::global_dof_index>> indices(
+        solution.n_blocks());
+      std::size_t size = 0;
+      for (unsigned int b = 0; b < solution.n_blocks(); ++b)
+        {
+          solution.block(b).locally_owned_elements().fill_index_vector(
+            indices[b]);
+          size += indices[b].size();
+        }
+      std::vector<double> buffer(size);
+      const int ierr = MPI_Recv(buffer.data(),
+                                buffer.size(),
+                                MPI_DOUBLE,
+                                source,
+                                parareal_tag,
+                                slice_communicator,
+                                MPI_STATUS_IGNORE);
+      AssertThrowMPI(ierr);
+      auto begin = buffer.begin();
+      for (unsigned int b = 0; b < solution.n_blocks(); ++b)
+        {
+          solution.block(b).set(
+            indices[b],
+            std::vector<double>(begin, begin + indices[b].size()));
+          begin += indices[b].size();
+        }
+      solution.compress(VectorOperation::insert);
+    }
+
+    template <int dim>
+    void Parareal<dim>::run(FluidSolver<dim> &fine, FluidSolver<dim> &coarse)
+    {
+      fine.setup_time_slices();
+      coarse.reuse_setup(fine);
+      coarse.setup_time_slices();
+
+      const double fine_delta_t = fine_parameters.time_step;
+      const double coarse_delta_t = coarse_parameters.time_step;
+      // The solution at the start of the slice of this group, and at its
+      // end from the fine solver, the coarse solver, and the correction.
+      PETScWrappers::MPI::BlockVector start =
+        owned_copy(fine.get_current_solution(), group_communicator);
+      PETScWrappers::MPI::BlockVector change(start);
+      PETScWrappers::MPI::BlockVector fine_end(start);
+      PETScWrappers::MPI::BlockVector coarse_end(start);
+      PETScWrappers::MPI::BlockVector next_start(start);
+
+      for (unsigned int first = 0; first < n_slices; first += n_groups)
+        {
+          const unsigned int n_active = std::min(n_groups, n_slices - first);
+          const bool active = group < n_active;
+          const unsigned int slice = first + group;
+          pcout << "Parareal slices " << first << " to "
+                << first + n_active - 1 << " of " << n_slices << std::endl;
+
+          // The coarse sweep, which passes on the first guesses.
+          if (active)
+            {
+              if (group > 0)
+                {
+                  receive(start, group - 1);
+                }
+              coarse.run_time_slice(
+                start,
+                slice_start(slice, coarse_delta_t, n_coarse_steps),
+                n_coarse_steps);
+              coarse_end =
+                owned_copy(coarse.get_current_solution(), group_communicator);
+              if (group + 1 < n_active)
+                {
+                  send(coarse_end, group + 1);
+                }
+              next_start = coarse_end;
+            }
+
+          // After iteration k, the starts of the slices up to k are exact, so
+          // group g runs the fine solver at most up to iteration g + 1, and
+          // the coarse one up to iteration g.
+          const unsigned int n_iterations =
+            std::min(fine_parameters.parareal_max_iterations, n_active);
+          for (unsigned int k = 1; k <= n_iterations; ++k)
+            {
+              double relative_change = 0;
+              if (active)
+                {
+                  if (k <= group + 1)
+                    {
+                      fine.run_time_slice(
+                        start,
+                        slice_start(slice, fine_delta_t, n_fine_steps),
+                        n_fine_steps);
+                      fine_end = owned_copy(fine.get_current_solution(),
+                                            group_communicator);
+                    }
+                  next_start = fine_end;
+                  if (group > 0)
+                    {
+                      change = start;
+                      receive(start, group - 1);
+                      change -= start;
+                      relative_change =
+                        change.l2_norm() / std::max(start.l2_norm(), 1e-30);
+                    }
+                  if (group > 0 && k <= group)
+                    {
+                      coarse.run_time_slice(
+                        start,
+                        slice_start(slice, coarse_delta_t, n_coarse_steps),
+                        n_coarse_steps);
+                      next_start -= coarse_end;
+                      coarse_end = owned_copy(coarse.get_current_solution(),
+                                              group_communicator);
+                      next_start += coarse_end;
+                    }
+                  if (group + 1 < n_active)
+                    {
+                      send(next_start, group + 1);
+                    }
+                }
+              relative_change =
+                Utilities::MPI::max(relative_change, world_communicator);
+              pcout << "Parareal iteration " << k
+                    << ", relative change = " << std::scientific
+                    << relative_change << std::endl;
+              if (relative_change < fine_parameters.parareal_tolerance)
+                {
+                  break;
+                }
+            }
+
+          // The next window starts at the end of the last slice.
+          if (first + n_groups < n_slices)
+            {
+              if (n_groups == 1)
+                {
+                  start = next_start;
+                }
+              else if (group + 1 == n_groups)
+                {
+                  send(next_start, 0);
+                }
+              else if (group == 0)
+                {
+                  receive(start, n_groups - 1);
+                }
+            }
+        }
+    }
+
+    template class Parareal<2>;
+    template class Parareal<3>;
+  } // namespace MPI
+} // namespace Fluid
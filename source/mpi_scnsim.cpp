@@ -7,13 +7,14 @@ namespace Fluid
     template <int dim>
     SCnsIM<dim>::BlockIncompSchurPreconditioner::SchurComplementTpp::
       SchurComplementTpp(TimerOutput &timer2,
-                         const std::vector<IndexSet> &owned_partitioning,
                          const PETScWrappers::MPI::BlockSparseMatrix &system,
-                         const PETScWrappers::PreconditionerBase &Pvvinv)
-      : timer2(timer2), system_matrix(&system), Pvv_inverse(&Pvvinv)
+                         const PETScWrappers::PreconditionerBase &Pvvinv,
+                         Utils::VectorPool &workspace)
+      : timer2(timer2),
+        system_matrix(&system),
+        Pvv_inverse(&Pvvinv),
+        workspace(&workspace)
     {
-      dumb_vector.reinit(owned_partitioning,
-                         system_matrix->get_mpi_communicator());
     }
 
     template <int dim>
@@ -22,13 +23,13 @@ namespace Fluid
       const PETScWrappers::MPI::Vector &src) const
     {
       // this is the exact representation of Tpp = App - Apv * Pvv * Avp.
-      PETScWrappers::MPI::Vector tmp1(dumb_vector.block(0)),
-        tmp2(dumb_vector.block(0)), tmp3(src);
-      system_matrix->block(0, 1).vmult(tmp1, src);
-      Pvv_inverse->vmult(tmp2, tmp1);
-      system_matrix->block(1, 0).vmult(tmp3, tmp2);
+      Utils::VectorPool::Handle tmp1(*workspace, 0), tmp2(*workspace, 0),
+        tmp3(*workspace, 1);
+      system_matrix->block(0, 1).vmult(*tmp1, src);
+      Pvv_inverse->vmult(*tmp2, *tmp1);
+      system_matrix->block(1, 0).vmult(*tmp3, *tmp2);
       system_matrix->block(1, 1).vmult(dst, src);
-      dst -= tmp3;
+      dst -= *tmp3;
     }
 
     template <int dim>
@@ -38,19 +39,35 @@ namespace Fluid
       const PETScWrappers::MPI::BlockSparseMatrix &system,
       PETScWrappers::MPI::SparseMatrix &absA,
       PETScWrappers::MPI::SparseMatrix &schur,
-      PETScWrappers::MPI::SparseMatrix &B2pp)
+      PETScWrappers::MPI::SparseMatrix &B2pp,
+      Utils::VectorPool &workspace,
+      const Parameters::AllParameters &parameters,
+      const bool build_inverses)
       : timer2(timer2),
         system_matrix(&system),
         Abs_A_matrix(&absA),
         schur_matrix(&schur),
         B2pp_matrix(&B2pp),
+        workspace(&workspace),
+        schur_tolerance(parameters.fluid_schur_tolerance),
         Tpp_itr(0)
     {
-      // Initialize the Pvv inverse (the ILU(0) factorization of Avv)
-      Pvv_inverse.initialize(system_matrix->block(0, 0));
-      // Initialize Tpp
-      Tpp.reset(new SchurComplementTpp(
-        timer2, owned_partitioning, *system_matrix, Pvv_inverse));
+      // Initialize the Pvv inverse (by default the ILU(0) factorization of
+      // Avv).
+      // The factorizations are kept when the system is reassembled, since
+      // the preconditioner may be reused.
+      if (build_inverses)
+        {
+          Pvv_inverse.initialize(PreconditionSelector::choose(
+                                   parameters.fluid_velocity_preconditioner,
+                                   "euclid"),
+                                 system_matrix->block(0, 0),
+                                 false);
+          Pvv_inverse.keep_factorization();
+          // Initialize Tpp
+          Tpp.reset(new SchurComplementTpp(
+            timer2, *system_matrix, Pvv_inverse, workspace));
+        }
 
       // Compute B2pp matrix App - Apv*rowsum(|Avv|)^(-1)*Avp
       // as the preconditioner to solve Tpp^-1
@@ -63,6 +80,9 @@ namespace Fluid
                            system_matrix->get_mpi_communicator());
       // Want to set ReverseRowSum to 1 to calculate the Rowsum first
       IdentityVector.block(0) = 1;
+      *Abs_A_matrix = 0;
+      *schur_matrix = 0;
+      *B2pp_matrix = 0;
       // iterate the Avv matrix to set everything to positive.
       Abs_A_matrix->add(1, system_matrix->block(0, 0));
       Abs_A_matrix->compress(VectorOperation::add);
@@ -127,7 +147,15 @@ namespace Fluid
       B2pp_matrix->add(-1, *schur_matrix);
       B2pp_matrix->add(1, system_matrix->block(1, 1));
       B2pp_matrix->compress(VectorOperation::add);
-      B2pp_inverse.initialize(*B2pp_matrix);
+      if (build_inverses)
+        {
+          B2pp_inverse.initialize(PreconditionSelector::choose(
+                                    parameters.fluid_schur_preconditioner,
+                                    "euclid"),
+                                  *B2pp_matrix,
+                                  false);
+          B2pp_inverse.keep_factorization();
+        }
     }
 
     /**
@@ -143,11 +171,11 @@ namespace Fluid
       //      |I           0|*|src(0)| = |src(0)|
       //      |-ApvPvv^-1  I| |src(1)|   |ptmp  |
       /////////////////////////////////////////
-      PETScWrappers::MPI::Vector ptmp1(src.block(0)), ptmp(src.block(1));
-      Pvv_inverse.vmult(ptmp1, src.block(0));
-      this->Apv().vmult(ptmp, ptmp1);
-      ptmp *= -1.0;
-      ptmp += src.block(1);
+      Utils::VectorPool::Handle ptmp1(*workspace, 0), ptmp(*workspace, 1);
+      Pvv_inverse.vmult(*ptmp1, src.block(0));
+      this->Apv().vmult(*ptmp, *ptmp1);
+      *ptmp *= -1.0;
+      *ptmp += src.block(1);
 
       // Compute the final vector:
       //      |Pvv^-1     -Pvv^-1*Avp*Tpp^-1|*|src(0)|
@@ -158,34 +186,35 @@ namespace Fluid
       // Compute Tpp^-1 * ptmp first, which is equal to the problem Tpp*x = ptmp
       // Set up initial guess first
       {
-        PETScWrappers::MPI::Vector c(ptmp), Sc(ptmp);
-        Tpp->vmult(Sc, c);
-        double alpha = (ptmp * c) / (Sc * c);
-        c *= alpha;
-        dst.block(1) = c;
+        Utils::VectorPool::Handle c(*workspace, 1), Sc(*workspace, 1);
+        *c = *ptmp;
+        Tpp->vmult(*Sc, *c);
+        double alpha = (*ptmp * *c) / (*Sc * *c);
+        *c *= alpha;
+        dst.block(1) = *c;
       }
       // Compute the multiplication
       timer2.enter_subsection("Solving Tpp");
       SolverControl solver_control(
-        ptmp.size(), 1e-3 * ptmp.l2_norm(), true, true);
+        ptmp->size(), schur_tolerance * ptmp->l2_norm(), true, true);
       GrowingVectorMemory<PETScWrappers::MPI::Vector> vector_memory;
       SolverGMRES<PETScWrappers::MPI::Vector> gmres(
         solver_control,
         vector_memory,
         SolverGMRES<PETScWrappers::MPI::Vector>::AdditionalData(200));
-      gmres.solve(*Tpp, dst.block(1), ptmp, B2pp_inverse);
-      // B2pp_inverse.vmult(dst.block(1), ptmp);
+      gmres.solve(*Tpp, dst.block(1), *ptmp, B2pp_inverse);
+      // B2pp_inverse.vmult(dst.block(1), *ptmp);
       // Count iterations for this solver solving Tpp inverse
       Tpp_itr += solver_control.last_step();
 
       timer2.leave_subsection("Solving Tpp");
 
       // Compute Pvv^-1*src(0) - Pvv^-1*Avp*dst(1)
-      PETScWrappers::MPI::Vector utmp1(src.block(0)), utmp2(src.block(0));
-      this->Avp().vmult(utmp1, dst.block(1));
-      Pvv_inverse.vmult(utmp2, utmp1);
+      Utils::VectorPool::Handle utmp1(*workspace, 0), utmp2(*workspace, 0);
+      this->Avp().vmult(*utmp1, dst.block(1));
+      Pvv_inverse.vmult(*utmp2, *utmp1);
       Pvv_inverse.vmult(dst.block(0), src.block(0));
-      dst.block(0) -= utmp2;
+      dst.block(0) -= *utmp2;
     }
 
     template <int dim>
@@ -193,17 +222,26 @@ namespace Fluid
                         const Parameters::AllParameters &parameters,
                         std::shared_ptr<Function<dim>> pml,
                         std::shared_ptr<TensorFunction<1, dim>> bf)
-      : FluidSolver<dim>(tria, parameters), sigma_pml_field(pml), body_force(bf)
+      : FluidSolver<dim>(tria, parameters),
+        last_gmres_iterations(0),
+        forcing(parameters.fluid_max_forcing),
+        sigma_pml_field(pml),
+        body_force(bf)
     {
       AssertThrow(parameters.fluid_velocity_degree ==
                     parameters.fluid_pressure_degree,
                   ExcMessage("Velocity degree must the same as pressure!"));
+      AssertThrow(parameters.fluid_time_integration == "implicit" ||
+                    parameters.simulation_type == "Fluid",
+                  ExcMessage("Explicit time integration is only available "
+                             "for fluid simulations!"));
     }
 
     template <int dim>
     void SCnsIM<dim>::initialize_system()
     {
       preconditioner.reset();
+      fieldsplit.reset();
       system_matrix.clear();
       Abs_A_matrix.clear();
       schur_matrix.clear();
@@ -246,6 +284,14 @@ namespace Fluid
                           owned_partitioning[1],
                           schur_dsp,
                           mpi_communicator);
+      if (parameters.memory_report)
+        {
+          // The dynamic patterns only live during the setup.
+          memory_report.add("Sparsity",
+                            "Dynamic patterns at setup",
+                            dsp.memory_consumption() +
+                              schur_dsp.memory_consumption());
+        }
 
       // present_solution is ghosted because it is used in the
       // output and mesh refinement functions.
@@ -262,12 +308,23 @@ namespace Fluid
       // system_rhs is non-ghosted because it is only used in the linear
       // solver and residual evaluation.
       system_rhs.reinit(owned_partitioning, mpi_communicator);
+      if (parameters.fluid_time_integration == "explicit")
+        {
+          lumped_mass.reinit(owned_partitioning, mpi_communicator);
+          rk_update.reinit(owned_partitioning, mpi_communicator);
+          rk_solution.reinit(owned_partitioning, mpi_communicator);
+        }
+      workspace.reinit(owned_partitioning, mpi_communicator);
+      recycle_space.clear();
+      solution_history.clear();
+      solution_history_times.clear();
 
       fsi_acceleration.reinit(
         owned_partitioning, relevant_partitioning, mpi_communicator);
 
       // Cell property
       setup_cell_property();
+      setup_pml_cache();
 
       stress = std::vector<std::vector<PETScWrappers::MPI::Vector>>(
         dim,
@@ -280,32 +337,79 @@ namespace Fluid
       // apply_initial_condition();
     }
 
+    template <int dim>
+    void SCnsIM<dim>::add_memory(Utils::MemoryReport &report) const
+    {
+      FluidSolver<dim>::add_memory(report);
+      report.add("Matrices",
+                 "|A| matrix",
+                 Utils::MemoryReport::matrix_memory(Abs_A_matrix));
+      report.add("Matrices",
+                 "Schur matrix",
+                 Utils::MemoryReport::matrix_memory(schur_matrix));
+      report.add("Matrices",
+                 "B2pp matrix",
+                 Utils::MemoryReport::matrix_memory(B2pp_matrix));
+      report.add("Vectors",
+                 "Newton update and evaluation point",
+                 newton_update.memory_consumption() +
+                   evaluation_point.memory_consumption());
+      if (parameters.fluid_time_integration == "explicit")
+        {
+          report.add("Vectors",
+                     "Runge-Kutta registers and lumped mass",
+                     lumped_mass.memory_consumption() +
+                       rk_update.memory_consumption() +
+                       rk_solution.memory_consumption());
+        }
+    }
+
+    template <int dim>
+    void SCnsIM<dim>::setup_pml_cache()
+    {
+      const unsigned int n_q_points = volume_quad_formula.size();
+      const unsigned int n_cells = triangulation.n_active_cells();
+      pml_sigma_values.assign(n_cells * n_q_points, 0.0);
+      pml_cells.assign(n_cells, false);
+
+      FEValues<dim> fe_values(
+        fe, volume_quad_formula, update_quadrature_points);
+      std::vector<double> sigma(n_q_points);
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (!cell->is_locally_owned())
+            {
+              continue;
+            }
+          fe_values.reinit(cell);
+          sigma_pml_field->value_list(
+            fe_values.get_quadrature_points(), sigma, 0);
+          const unsigned int offset = cell->active_cell_index() * n_q_points;
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              pml_sigma_values[offset + q] = sigma[q];
+              if (sigma[q] != 0)
+                {
+                  pml_cells[cell->active_cell_index()] = true;
+                }
+            }
+        }
+    }
+
     template <int dim>
     void SCnsIM<dim>::assemble(const bool use_nonzero_constraints)
     {
       TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::CounterRegion counter_region("Assemble system");
 
       Tensor<1, dim> gravity;
       for (unsigned int i = 0; i < dim; ++i)
         gravity[i] = parameters.gravity[i];
 
       system_matrix = 0;
-      Abs_A_matrix = 0;
-      schur_matrix = 0;
-      B2pp_matrix = 0;
-
       system_rhs = 0;
 
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_quadrature_points |
-                                update_JxW_values | update_gradients);
-      FEFaceValues<dim> fe_face_values(fe,
-                                       face_quad_formula,
-                                       update_values | update_normal_vectors |
-                                         update_quadrature_points |
-                                         update_JxW_values);
-
       const unsigned int dofs_per_cell = fe.dofs_per_cell;
       const unsigned int u_dofs = fe.base_element(0).dofs_per_cell;
       const unsigned int p_dofs = fe.base_element(1).dofs_per_cell;
@@ -316,34 +420,6 @@ namespace Fluid
                   ExcMessage("Wrong partitioning of dofs!"));
 
       const FEValuesExtractors::Vector velocities(0);
-      const FEValuesExtractors::Scalar pressure(dim);
-
-      FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
-      Vector<double> local_rhs(dofs_per_cell);
-
-      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-      // For the linearized system, we create temporary storage for current
-      // velocity
-      // and gradient, current pressure, and present velocity. In practice, they
-      // are
-      // all obtained through their shape functions at quadrature points.
-
-      std::vector<Tensor<1, dim>> current_velocity_values(n_q_points);
-      std::vector<Tensor<2, dim>> current_velocity_gradients(n_q_points);
-      std::vector<double> current_pressure_values(n_q_points);
-      std::vector<Tensor<1, dim>> current_pressure_gradients(n_q_points);
-      std::vector<Tensor<1, dim>> present_velocity_values(n_q_points);
-      std::vector<double> present_pressure_values(n_q_points);
-      std::vector<double> sigma_pml(n_q_points);
-      std::vector<Tensor<1, dim>> artificial_bf(n_q_points);
-      std::vector<Tensor<1, dim>> fsi_acc_values(n_q_points);
-
-      std::vector<double> div_phi_u(dofs_per_cell);
-      std::vector<Tensor<1, dim>> phi_u(dofs_per_cell);
-      std::vector<Tensor<2, dim>> grad_phi_u(dofs_per_cell);
-      std::vector<double> phi_p(dofs_per_cell);
-      std::vector<Tensor<1, dim>> grad_phi_p(dofs_per_cell);
 
       // The parameters that is used in isentropic continuity equation:
       // heat capacity ratio and atmospheric pressure.
@@ -351,365 +427,403 @@ namespace Fluid
       const double atm = 1013250;
       const double kappa_s = 1e4;
 
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
-        {
-          if (cell->is_locally_owned())
+      // The cell loop runs on WorkStream, see assemble_cells.
+      auto local_assemble =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            AssemblyScratchData &scratch,
+            AssemblyCopyData &data) {
+          FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+          auto &local_matrix = data.local_matrix;
+          auto &local_rhs = data.local_rhs;
+          auto &current_velocity_values = scratch.current_velocity_values;
+          auto &current_velocity_gradients = scratch.current_velocity_gradients;
+          auto &current_pressure_values = scratch.current_pressure_values;
+          auto &current_pressure_gradients = scratch.current_pressure_gradients;
+          auto &present_velocity_values = scratch.present_velocity_values;
+          auto &present_pressure_values = scratch.present_pressure_values;
+          auto &sigma_pml = scratch.sigma_pml;
+          auto &artificial_bf = scratch.artificial_bf;
+          auto &fsi_acc_values = scratch.fsi_acc_values;
+          auto &div_phi_u = scratch.div_phi_u;
+          auto &phi_u = scratch.phi_u;
+          auto &grad_phi_u = scratch.grad_phi_u;
+          auto &phi_p = scratch.phi_p;
+          auto &grad_phi_p = scratch.grad_phi_p;
+
+          const unsigned int cell_index = cell->active_cell_index();
+          const SymmetricTensor<2, dim> &fsi_stress =
+            cell_property.fsi_stress[cell_index];
+          const int ind = cell_property.indicator[cell_index];
+          const bool in_pml = pml_cells[cell_index];
+          if (in_pml)
             {
-              auto p = cell_property.get_data(cell);
-              const int ind = p[0]->indicator;
+              std::copy_n(pml_sigma_values.begin() + cell_index * n_q_points,
+                          n_q_points,
+                          sigma_pml.begin());
+            }
+          else
+            {
+              std::fill(sigma_pml.begin(), sigma_pml.end(), 0.0);
+            }
 
-              fe_values.reinit(cell);
+          scratch.reinit(cell);
 
-              local_matrix = 0;
-              local_rhs = 0;
+          local_matrix = 0;
+          local_rhs = 0;
 
-              fe_values[velocities].get_function_values(
-                evaluation_point, current_velocity_values);
+          {
+            std::lock_guard<std::mutex> lock(assembly_mutex);
+            scratch.get_velocity_values(
+              evaluation_point, current_velocity_values);
 
-              fe_values[velocities].get_function_gradients(
-                evaluation_point, current_velocity_gradients);
+            scratch.get_velocity_gradients(
+              evaluation_point, current_velocity_gradients);
 
-              fe_values[pressure].get_function_values(evaluation_point,
-                                                      current_pressure_values);
+            scratch.get_pressure_values(
+              evaluation_point, current_pressure_values);
 
-              fe_values[pressure].get_function_gradients(
-                evaluation_point, current_pressure_gradients);
+            scratch.get_pressure_gradients(
+              evaluation_point, current_pressure_gradients);
 
-              fe_values[velocities].get_function_values(
-                present_solution, present_velocity_values);
+            scratch.get_velocity_values(
+              present_solution, present_velocity_values);
 
-              fe_values[pressure].get_function_values(present_solution,
-                                                      present_pressure_values);
+            scratch.get_pressure_values(
+              present_solution, present_pressure_values);
 
-              sigma_pml_field->value_list(
-                fe_values.get_quadrature_points(), sigma_pml, 0);
-              body_force->value_list(fe_values.get_quadrature_points(),
-                                     artificial_bf);
+            body_force->value_list(scratch.get_quadrature_points(),
+                                   artificial_bf);
 
-              fe_values[velocities].get_function_values(fsi_acceleration,
-                                                        fsi_acc_values);
+            scratch.get_velocity_values(fsi_acceleration, fsi_acc_values);
+          }
 
-              for (unsigned int q = 0; q < n_q_points; ++q)
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              const double rho = parameters.fluid_rho *
+                                   (1 + present_pressure_values[q] / atm) *
+                                   (1 - ind) +
+                                 ind * parameters.solid_rho;
+              const double viscosity =
+                (ind == 1 ? 1 : parameters.viscosity);
+
+              for (unsigned int k = 0; k < dofs_per_cell; ++k)
                 {
-                  const double rho = parameters.fluid_rho *
-                                       (1 + present_pressure_values[q] / atm) *
-                                       (1 - ind) +
-                                     ind * parameters.solid_rho;
-                  const double viscosity =
-                    (ind == 1 ? 1 : parameters.viscosity);
-
-                  for (unsigned int k = 0; k < dofs_per_cell; ++k)
-                    {
-                      div_phi_u[k] = fe_values[velocities].divergence(k, q);
-                      grad_phi_u[k] = fe_values[velocities].gradient(k, q);
-                      phi_u[k] = fe_values[velocities].value(k, q);
-                      phi_p[k] = fe_values[pressure].value(k, q);
-                      grad_phi_p[k] = fe_values[pressure].gradient(k, q);
-                    }
+                  div_phi_u[k] = scratch.velocity_divergence(k, q);
+                  grad_phi_u[k] = scratch.velocity_gradient(k, q);
+                  phi_u[k] = scratch.velocity_value(k, q);
+                  phi_p[k] = scratch.pressure_value(k, q);
+                  grad_phi_p[k] = scratch.pressure_gradient(k, q);
+                }
 
-                  // Define the UGN based SUPG parameters (Tezduyar):
-                  // tau_SUPG and tau_PSPG. They are
-                  // evaluated based on the results from the last Newton
-                  // iteration.
-                  double tau_SUPG, tau_PSPG, tau_LSIC;
-                  // the length scale h is the length of the element in the
-                  // direction
-                  // of convection
-                  double h = 0;
-                  for (unsigned int a = 0;
-                       a < dofs_per_cell / fe.dofs_per_vertex;
-                       ++a)
-                    {
-                      h += abs(present_velocity_values[q] *
-                               fe_values.shape_grad(a, q));
-                    }
-                  if (h)
-                    h = 2 * present_velocity_values[q].norm() / h;
-                  else
-                    h = 0;
-                  double nu = viscosity / rho;
-                  double v_norm = present_velocity_values[q].norm();
-                  if (h)
-                    tau_SUPG = 1 / sqrt((pow(2 / time.get_delta_t(), 2) +
-                                         pow(2 * v_norm / h, 2) +
-                                         pow(4 * nu / pow(h, 2), 2)));
-                  else
-                    tau_SUPG = time.get_delta_t() / 2;
-                  tau_PSPG = tau_SUPG / rho;
-                  double localRe = v_norm * h / (2 * nu);
-                  double z = localRe <= 3 ? (localRe / 3) : 1;
-                  tau_LSIC = h / 2 * v_norm * z;
-
-                  for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              // Define the UGN based SUPG parameters (Tezduyar):
+              // tau_SUPG and tau_PSPG. They are
+              // evaluated based on the results from the last Newton
+              // iteration.
+              double tau_SUPG, tau_PSPG, tau_LSIC;
+              // the length scale h is the length of the element in the
+              // direction
+              // of convection
+              double h = 0;
+              for (unsigned int a = 0;
+                   a < dofs_per_cell / fe.dofs_per_vertex;
+                   ++a)
+                {
+                  h += abs(present_velocity_values[q] *
+                           scratch.shape_grad(a, q));
+                }
+              if (h)
+                h = 2 * present_velocity_values[q].norm() / h;
+              else
+                h = 0;
+              double nu = viscosity / rho;
+              double v_norm = present_velocity_values[q].norm();
+              if (h)
+                tau_SUPG = 1 / sqrt((pow(2 / time.get_delta_t(), 2) +
+                                     pow(2 * v_norm / h, 2) +
+                                     pow(4 * nu / pow(h, 2), 2)));
+              else
+                tau_SUPG = time.get_delta_t() / 2;
+              tau_PSPG = tau_SUPG / rho;
+              double localRe = v_norm * h / (2 * nu);
+              double z = localRe <= 3 ? (localRe / 3) : 1;
+              tau_LSIC = h / 2 * v_norm * z;
+
+              for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                {
+                  double current_velocity_divergence =
+                    trace(current_velocity_gradients[q]);
+                  for (unsigned int j = 0; j < dofs_per_cell; ++j)
                     {
-                      double current_velocity_divergence =
-                        trace(current_velocity_gradients[q]);
-                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                      // Let the linearized diffusion, continuity
+                      // terms be written as
+                      // the bilinear operator: \f$A = a((\delta{u},
+                      // \delta{p}), (\delta{v}, \delta{q}))\f$,
+                      // the linearized convection term be: \f$C =
+                      // c(u;\delta{u}, \delta{v})\f$,
+                      // and the linearized inertial term be:
+                      // \f$M = m(\delta{u}, \delta{v})$, then LHS is: $(A
+                      // +
+                      // C) + M/{\Delta{t}}\f$
+                      local_matrix(i, j) +=
+                        ((viscosity *
+                            scalar_product(grad_phi_u[j], grad_phi_u[i]) +
+                          rho * current_velocity_gradients[q] * phi_u[j] *
+                            phi_u[i] +
+                          rho * grad_phi_u[j] * current_velocity_values[q] *
+                            phi_u[i] -
+                          div_phi_u[i] * phi_p[j]) +
+                         rho * phi_u[i] * phi_u[j] / time.get_delta_t()) *
+                        scratch.JxW(q);
+                      // PML attenuation
+                      if (in_pml)
                         {
-                          // Let the linearized diffusion, continuity
-                          // terms be written as
-                          // the bilinear operator: \f$A = a((\delta{u},
-                          // \delta{p}), (\delta{v}, \delta{q}))\f$,
-                          // the linearized convection term be: \f$C =
-                          // c(u;\delta{u}, \delta{v})\f$,
-                          // and the linearized inertial term be:
-                          // \f$M = m(\delta{u}, \delta{v})$, then LHS is: $(A
-                          // +
-                          // C) + M/{\Delta{t}}\f$
-                          local_matrix(i, j) +=
-                            ((viscosity *
-                                scalar_product(grad_phi_u[j], grad_phi_u[i]) +
-                              rho * current_velocity_gradients[q] * phi_u[j] *
-                                phi_u[i] +
-                              rho * grad_phi_u[j] * current_velocity_values[q] *
-                                phi_u[i] -
-                              div_phi_u[i] * phi_p[j]) +
-                             rho * phi_u[i] * phi_u[j] / time.get_delta_t()) *
-                            fe_values.JxW(q);
-                          // PML attenuation
                           local_matrix(i, j) +=
                             (rho * sigma_pml[q] * phi_u[j] * phi_u[i] +
                              sigma_pml[q] * phi_p[j] * phi_p[i] / atm) *
-                            fe_values.JxW(q);
-                          // Add SUPG and PSPG stabilization
-                          local_matrix(i, j) +=
-                            // SUPG Convection
-                            (tau_SUPG * rho *
-                               (current_velocity_values[q] * grad_phi_u[i]) *
-                               (phi_u[j] * current_velocity_gradients[q]) +
-                             tau_SUPG * rho *
-                               (current_velocity_values[q] * grad_phi_u[i]) *
-                               (current_velocity_values[q] * grad_phi_u[j]) +
-                             tau_SUPG * rho * (phi_u[j] * grad_phi_u[i]) *
-                               (current_velocity_values[q] *
-                                current_velocity_gradients[q]) +
-                             // SUPG Acceleration
-                             tau_SUPG * rho * current_velocity_values[q] *
-                               grad_phi_u[i] * phi_u[j] / time.get_delta_t() +
-                             tau_SUPG * rho * phi_u[j] * grad_phi_u[i] *
-                               (current_velocity_values[q] -
-                                present_velocity_values[q]) /
-                               time.get_delta_t() +
-                             // SUPG Pressure
-                             tau_SUPG * current_velocity_values[q] *
-                               grad_phi_u[i] * grad_phi_p[j] +
-                             tau_SUPG * phi_u[j] * grad_phi_u[i] *
-                               current_pressure_gradients[q] -
-                             // SUPG body force
-                             tau_SUPG * phi_u[j] * grad_phi_u[i] * rho *
-                               (gravity + artificial_bf[q]) +
-                             // SUPG PML
-                             tau_SUPG * rho * current_velocity_values[q] *
-                               grad_phi_u[i] * sigma_pml[q] * phi_u[j] +
-                             tau_SUPG * rho * phi_u[j] * grad_phi_u[i] *
-                               sigma_pml[q] * current_velocity_values[q] +
-                             // PSPG Convection
-                             tau_PSPG * rho * grad_phi_p[i] *
-                               (phi_u[j] * current_velocity_gradients[q]) +
-                             tau_PSPG * rho * grad_phi_p[i] *
-                               (current_velocity_values[q] * grad_phi_u[j]) +
-                             // PSPG Acceleration
-                             tau_PSPG * rho * grad_phi_p[i] * phi_u[j] /
-                               time.get_delta_t() +
-                             // PSPG Pressure
-                             tau_PSPG * grad_phi_p[i] * grad_phi_p[j] +
-                             // PSPG PML
-                             tau_PSPG * rho * grad_phi_p[i] * sigma_pml[q] *
-                               phi_u[j] +
-                             // LSIC acceleration
-                             tau_LSIC * rho * div_phi_u[i] * phi_p[j] /
-                               time.get_delta_t() * (1 - ind) / atm +
-                             // LSIC bulk acceleration in artificial fluid
-                             tau_LSIC * rho * 1 / kappa_s * div_phi_u[i] *
-                               phi_p[j] / time.get_delta_t() * ind +
-                             // LSIC velocity divergence
-                             tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
-                               div_phi_u[j] +
-                             tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
-                               current_pressure_values[q] * (1 - ind) *
-                               div_phi_u[j] / atm +
-                             tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
-                               phi_p[j] * (1 - ind) *
-                               current_velocity_divergence / atm +
-                             // LSIC pressure gradients
-                             tau_LSIC * rho * div_phi_u[i] *
-                               current_velocity_values[q] * grad_phi_p[j] /
-                               atm * (1 - ind) +
-                             tau_LSIC * rho * div_phi_u[i] * phi_u[j] *
-                               current_pressure_gradients[q] / atm *
-                               (1 - ind)) *
-                            fe_values.JxW(q);
-                          // For more clear demonstration, write continuity
-                          // equation
-                          // separately.
-                          // The original strong form is:
-                          // \f$p_{,t} + \frac{C_p}{C_v} * (p_0 + p) * (\nabla
-                          // \times u) + u (\nabla p) = 0\f$
+                            scratch.JxW(q);
+                        }
+                      // Add SUPG and PSPG stabilization
+                      local_matrix(i, j) +=
+                        // SUPG Convection
+                        (tau_SUPG * rho *
+                           (current_velocity_values[q] * grad_phi_u[i]) *
+                           (phi_u[j] * current_velocity_gradients[q]) +
+                         tau_SUPG * rho *
+                           (current_velocity_values[q] * grad_phi_u[i]) *
+                           (current_velocity_values[q] * grad_phi_u[j]) +
+                         tau_SUPG * rho * (phi_u[j] * grad_phi_u[i]) *
+                           (current_velocity_values[q] *
+                            current_velocity_gradients[q]) +
+                         // SUPG Acceleration
+                         tau_SUPG * rho * current_velocity_values[q] *
+                           grad_phi_u[i] * phi_u[j] / time.get_delta_t() +
+                         tau_SUPG * rho * phi_u[j] * grad_phi_u[i] *
+                           (current_velocity_values[q] -
+                            present_velocity_values[q]) /
+                           time.get_delta_t() +
+                         // SUPG Pressure
+                         tau_SUPG * current_velocity_values[q] *
+                           grad_phi_u[i] * grad_phi_p[j] +
+                         tau_SUPG * phi_u[j] * grad_phi_u[i] *
+                           current_pressure_gradients[q] -
+                         // SUPG body force
+                         tau_SUPG * phi_u[j] * grad_phi_u[i] * rho *
+                           (gravity + artificial_bf[q]) +
+                         // SUPG PML
+                         tau_SUPG * rho * current_velocity_values[q] *
+                           grad_phi_u[i] * sigma_pml[q] * phi_u[j] +
+                         tau_SUPG * rho * phi_u[j] * grad_phi_u[i] *
+                           sigma_pml[q] * current_velocity_values[q] +
+                         // PSPG Convection
+                         tau_PSPG * rho * grad_phi_p[i] *
+                           (phi_u[j] * current_velocity_gradients[q]) +
+                         tau_PSPG * rho * grad_phi_p[i] *
+                           (current_velocity_values[q] * grad_phi_u[j]) +
+                         // PSPG Acceleration
+                         tau_PSPG * rho * grad_phi_p[i] * phi_u[j] /
+                           time.get_delta_t() +
+                         // PSPG Pressure
+                         tau_PSPG * grad_phi_p[i] * grad_phi_p[j] +
+                         // PSPG PML
+                         tau_PSPG * rho * grad_phi_p[i] * sigma_pml[q] *
+                           phi_u[j] +
+                         // LSIC acceleration
+                         tau_LSIC * rho * div_phi_u[i] * phi_p[j] /
+                           time.get_delta_t() * (1 - ind) / atm +
+                         // LSIC bulk acceleration in artificial fluid
+                         tau_LSIC * rho * 1 / kappa_s * div_phi_u[i] *
+                           phi_p[j] / time.get_delta_t() * ind +
+                         // LSIC velocity divergence
+                         tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
+                           div_phi_u[j] +
+                         tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
+                           current_pressure_values[q] * (1 - ind) *
+                           div_phi_u[j] / atm +
+                         tau_LSIC * rho * cp_to_cv * div_phi_u[i] *
+                           phi_p[j] * (1 - ind) *
+                           current_velocity_divergence / atm +
+                         // LSIC pressure gradients
+                         tau_LSIC * rho * div_phi_u[i] *
+                           current_velocity_values[q] * grad_phi_p[j] /
+                           atm * (1 - ind) +
+                         tau_LSIC * rho * div_phi_u[i] * phi_u[j] *
+                           current_pressure_gradients[q] / atm *
+                           (1 - ind)) *
+                        scratch.JxW(q);
+                      // For more clear demonstration, write continuity
+                      // equation
+                      // separately.
+                      // The original strong form is:
+                      // \f$p_{,t} + \frac{C_p}{C_v} * (p_0 + p) * (\nabla
+                      // \times u) + u (\nabla p) = 0\f$
+                      local_matrix(i, j) +=
+                        (cp_to_cv *
+                           (atm + current_pressure_values[q] * (1 - ind)) *
+                           div_phi_u[j] * phi_p[i] +
+                         phi_p[j] * current_velocity_divergence * phi_p[i] *
+                           (1 - ind) +
+                         current_velocity_values[q] * grad_phi_p[j] *
+                           phi_p[i] * (1 - ind) +
+                         phi_u[j] * current_pressure_gradients[q] *
+                           phi_p[i] * (1 - ind) +
+                         phi_p[i] * phi_p[j] / time.get_delta_t() *
+                           (1 - ind)) /
+                          atm * scratch.JxW(q) +
+                        1 / kappa_s * phi_p[i] * phi_p[j] * ind /
+                          time.get_delta_t() * scratch.JxW(q);
+                      if (ind == 1)
+                        {
                           local_matrix(i, j) +=
-                            (cp_to_cv *
-                               (atm + current_pressure_values[q] * (1 - ind)) *
-                               div_phi_u[j] * phi_p[i] +
-                             phi_p[j] * current_velocity_divergence * phi_p[i] *
-                               (1 - ind) +
-                             current_velocity_values[q] * grad_phi_p[j] *
-                               phi_p[i] * (1 - ind) +
-                             phi_u[j] * current_pressure_gradients[q] *
-                               phi_p[i] * (1 - ind) +
-                             phi_p[i] * phi_p[j] / time.get_delta_t() *
-                               (1 - ind)) /
-                              atm * fe_values.JxW(q) +
-                            1 / kappa_s * phi_p[i] * phi_p[j] * ind /
-                              time.get_delta_t() * fe_values.JxW(q);
-                          if (ind == 1)
-                            {
-                              local_matrix(i, j) +=
-                                -(tau_SUPG * phi_u[j] * grad_phi_u[i] *
-                                  (fsi_acc_values[q] * rho)) *
-                                fe_values.JxW(q);
-                            }
+                            -(tau_SUPG * phi_u[j] * grad_phi_u[i] *
+                              (fsi_acc_values[q] * rho)) *
+                            scratch.JxW(q);
                         }
+                    }
 
-                      // RHS is \f$-(A_{current} + C_{current}) -
-                      // M_{present-current}/\Delta{t}\f$.
-                      local_rhs(i) +=
-                        ((-viscosity *
-                            scalar_product(current_velocity_gradients[q],
-                                           grad_phi_u[i]) -
-                          rho * current_velocity_gradients[q] *
-                            current_velocity_values[q] * phi_u[i] +
-                          current_pressure_values[q] * div_phi_u[i]) -
-                         rho *
-                           (current_velocity_values[q] -
-                            present_velocity_values[q]) *
-                           phi_u[i] / time.get_delta_t() +
-                         (gravity + artificial_bf[q]) * phi_u[i] * rho) *
-                        fe_values.JxW(q);
+                  // RHS is \f$-(A_{current} + C_{current}) -
+                  // M_{present-current}/\Delta{t}\f$.
+                  local_rhs(i) +=
+                    ((-viscosity *
+                        scalar_product(current_velocity_gradients[q],
+                                       grad_phi_u[i]) -
+                      rho * current_velocity_gradients[q] *
+                        current_velocity_values[q] * phi_u[i] +
+                      current_pressure_values[q] * div_phi_u[i]) -
+                     rho *
+                       (current_velocity_values[q] -
+                        present_velocity_values[q]) *
+                       phi_u[i] / time.get_delta_t() +
+                     (gravity + artificial_bf[q]) * phi_u[i] * rho) *
+                    scratch.JxW(q);
+                  if (in_pml)
+                    {
                       local_rhs(i) +=
                         -(rho * sigma_pml[q] * current_velocity_values[q] *
                             phi_u[i] +
-                          sigma_pml[q] * current_pressure_values[q] * phi_p[i] /
-                            atm) *
-                        fe_values.JxW(q);
-                      local_rhs(i) +=
-                        -(cp_to_cv *
-                            (atm + current_pressure_values[q] * (1 - ind)) *
-                            current_velocity_divergence * phi_p[i] +
-                          current_velocity_values[q] *
-                            current_pressure_gradients[q] * phi_p[i] *
-                            (1 - ind) +
-                          (current_pressure_values[q] -
-                           present_pressure_values[q]) *
-                            phi_p[i] / time.get_delta_t() * (1 - ind)) /
-                          atm * fe_values.JxW(q) -
-                        1 / kappa_s *
-                          (current_pressure_values[q] -
-                           present_pressure_values[q]) *
-                          phi_p[i] * ind / time.get_delta_t() *
-                          fe_values.JxW(q);
-                      // Add SUPG and PSPS rhs terms.
-                      local_rhs(i) +=
-                        -((tau_SUPG * current_velocity_values[q] *
-                           grad_phi_u[i]) *
-                            (rho * ((current_velocity_values[q] -
-                                     present_velocity_values[q]) /
-                                      time.get_delta_t() +
-                                    current_velocity_values[q] *
-                                      current_velocity_gradients[q]) +
-                             current_pressure_gradients[q] -
-                             rho * (gravity + artificial_bf[q]) +
-                             rho * sigma_pml[q] * current_velocity_values[q]) +
-                          (tau_PSPG * grad_phi_p[i]) *
-                            (rho * ((current_velocity_values[q] -
-                                     present_velocity_values[q]) /
-                                      time.get_delta_t() +
-                                    current_velocity_values[q] *
-                                      current_velocity_gradients[q]) +
-                             current_pressure_gradients[q] -
-                             rho * (gravity + artificial_bf[q]) +
-                             rho * sigma_pml[q] * current_velocity_values[q])) *
-                        fe_values.JxW(q);
-                      // Add LSIC rhs terms.
+                          sigma_pml[q] * current_pressure_values[q] *
+                            phi_p[i] / atm) *
+                        scratch.JxW(q);
+                    }
+                  local_rhs(i) +=
+                    -(cp_to_cv *
+                        (atm + current_pressure_values[q] * (1 - ind)) *
+                        current_velocity_divergence * phi_p[i] +
+                      current_velocity_values[q] *
+                        current_pressure_gradients[q] * phi_p[i] *
+                        (1 - ind) +
+                      (current_pressure_values[q] -
+                       present_pressure_values[q]) *
+                        phi_p[i] / time.get_delta_t() * (1 - ind)) /
+                      atm * scratch.JxW(q) -
+                    1 / kappa_s *
+                      (current_pressure_values[q] -
+                       present_pressure_values[q]) *
+                      phi_p[i] * ind / time.get_delta_t() *
+                      scratch.JxW(q);
+                  // Add SUPG and PSPS rhs terms.
+                  local_rhs(i) +=
+                    -((tau_SUPG * current_velocity_values[q] *
+                       grad_phi_u[i]) *
+                        (rho * ((current_velocity_values[q] -
+                                 present_velocity_values[q]) /
+                                  time.get_delta_t() +
+                                current_velocity_values[q] *
+                                  current_velocity_gradients[q]) +
+                         current_pressure_gradients[q] -
+                         rho * (gravity + artificial_bf[q]) +
+                         rho * sigma_pml[q] * current_velocity_values[q]) +
+                      (tau_PSPG * grad_phi_p[i]) *
+                        (rho * ((current_velocity_values[q] -
+                                 present_velocity_values[q]) /
+                                  time.get_delta_t() +
+                                current_velocity_values[q] *
+                                  current_velocity_gradients[q]) +
+                         current_pressure_gradients[q] -
+                         rho * (gravity + artificial_bf[q]) +
+                         rho * sigma_pml[q] * current_velocity_values[q])) *
+                    scratch.JxW(q);
+                  // Add LSIC rhs terms.
+                  local_rhs(i) +=
+                    -((tau_LSIC * rho * div_phi_u[i]) *
+                        ((current_pressure_values[q] -
+                          present_pressure_values[q]) /
+                           time.get_delta_t() * (1 - ind) +
+                         cp_to_cv * atm * current_velocity_divergence +
+                         cp_to_cv * current_pressure_values[q] *
+                           current_velocity_divergence * (1 - ind) +
+                         current_velocity_values[q] *
+                           current_pressure_gradients[q] * (1 - ind)) /
+                        atm +
+                      (tau_LSIC * rho * div_phi_u[i]) *
+                        (1 / kappa_s *
+                         (current_pressure_values[q] -
+                          present_pressure_values[q]) /
+                         time.get_delta_t()) *
+                        ind) *
+                    scratch.JxW(q);
+                  if (ind == 1)
+                    {
                       local_rhs(i) +=
-                        -((tau_LSIC * rho * div_phi_u[i]) *
-                            ((current_pressure_values[q] -
-                              present_pressure_values[q]) /
-                               time.get_delta_t() * (1 - ind) +
-                             cp_to_cv * atm * current_velocity_divergence +
-                             cp_to_cv * current_pressure_values[q] *
-                               current_velocity_divergence * (1 - ind) +
-                             current_velocity_values[q] *
-                               current_pressure_gradients[q] * (1 - ind)) /
-                            atm +
-                          (tau_LSIC * rho * div_phi_u[i]) *
-                            (1 / kappa_s *
-                             (current_pressure_values[q] -
-                              present_pressure_values[q]) /
-                             time.get_delta_t()) *
-                            ind) *
-                        fe_values.JxW(q);
-                      if (ind == 1)
-                        {
-                          local_rhs(i) +=
-                            (scalar_product(grad_phi_u[i], p[0]->fsi_stress) +
-                             (fsi_acc_values[q] * rho) *
-                               (phi_u[i] + tau_PSPG * grad_phi_p[i] +
-                                tau_SUPG * current_velocity_values[q] *
-                                  grad_phi_u[i])) *
-                            fe_values.JxW(q);
-                        }
+                        (scalar_product(grad_phi_u[i], fsi_stress) +
+                         (fsi_acc_values[q] * rho) *
+                           (phi_u[i] + tau_PSPG * grad_phi_p[i] +
+                            tau_SUPG * current_velocity_values[q] *
+                              grad_phi_u[i])) *
+                        scratch.JxW(q);
                     }
                 }
+            }
 
-              // Impose pressure boundary here if specified, loop over faces on
-              // the
-              // cell
-              // and apply pressure boundary conditions:
-              // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
-              if (parameters.n_fluid_neumann_bcs != 0)
+          // Impose pressure boundary here if specified, loop over faces on
+          // the
+          // cell
+          // and apply pressure boundary conditions:
+          // \f$\int_{\Gamma_n} -p\bold{n}d\Gamma\f$
+          if (parameters.n_fluid_neumann_bcs != 0)
+            {
+              for (unsigned int face_n = 0;
+                   face_n < GeometryInfo<dim>::faces_per_cell;
+                   ++face_n)
                 {
-                  for (unsigned int face_n = 0;
-                       face_n < GeometryInfo<dim>::faces_per_cell;
-                       ++face_n)
+                  if (cell->at_boundary(face_n) &&
+                      parameters.fluid_neumann_bcs.find(
+                        cell->face(face_n)->boundary_id()) !=
+                        parameters.fluid_neumann_bcs.end())
                     {
-                      if (cell->at_boundary(face_n) &&
-                          parameters.fluid_neumann_bcs.find(
-                            cell->face(face_n)->boundary_id()) !=
-                            parameters.fluid_neumann_bcs.end())
+                      fe_face_values.reinit(cell, face_n);
+                      unsigned int p_bc_id =
+                        cell->face(face_n)->boundary_id();
+                      double boundary_values_p =
+                        parameters.fluid_neumann_bcs.at(p_bc_id);
+                      for (unsigned int q = 0; q < n_face_q_points; ++q)
                         {
-                          fe_face_values.reinit(cell, face_n);
-                          unsigned int p_bc_id =
-                            cell->face(face_n)->boundary_id();
-                          double boundary_values_p =
-                            parameters.fluid_neumann_bcs[p_bc_id];
-                          for (unsigned int q = 0; q < n_face_q_points; ++q)
+                          for (unsigned int i = 0; i < dofs_per_cell; ++i)
                             {
-                              for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                                {
-                                  local_rhs(i) += -(
-                                    fe_face_values[velocities].value(i, q) *
-                                    fe_face_values.normal_vector(q) *
-                                    boundary_values_p * fe_face_values.JxW(q));
-                                }
+                              local_rhs(i) += -(
+                                fe_face_values[velocities].value(i, q) *
+                                fe_face_values.normal_vector(q) *
+                                boundary_values_p * fe_face_values.JxW(q));
                             }
                         }
                     }
                 }
+            }
 
-              cell->get_dof_indices(local_dof_indices);
+          cell->get_dof_indices(data.local_dof_indices);
+        };
 
-              const AffineConstraints<double> &constraints_used =
-                use_nonzero_constraints ? nonzero_constraints
-                                        : zero_constraints;
+      const AffineConstraints<double> &constraints_used =
+        use_nonzero_constraints ? nonzero_constraints : zero_constraints;
+      auto copy_local_to_global = [&](const AssemblyCopyData &data) {
+        constraints_used.distribute_local_to_global(data.local_matrix,
+                                                    data.local_rhs,
+                                                    data.local_dof_indices,
+                                                    system_matrix,
+                                                    system_rhs,
+                                                    true);
+      };
 
-              constraints_used.distribute_local_to_global(local_matrix,
-                                                          local_rhs,
-                                                          local_dof_indices,
-                                                          system_matrix,
-                                                          system_rhs,
-                                                          true);
-            }
-        }
+      assemble_cells(local_assemble, copy_local_to_global);
 
       system_matrix.compress(VectorOperation::add);
       system_rhs.compress(VectorOperation::add);
@@ -717,35 +831,107 @@ namespace Fluid
 
     template <int dim>
     std::pair<unsigned int, double>
-    SCnsIM<dim>::solve(const bool use_nonzero_constraints)
+    SCnsIM<dim>::solve(const bool use_nonzero_constraints,
+                       const double forcing)
     {
       // This section includes the work done in the preconditioner
       // and GMRES solver.
       TimerOutput::Scope timer_section(timer, "Solve linear system");
-      preconditioner.reset(
-        new BlockIncompSchurPreconditioner(timer2,
-                                           owned_partitioning,
-                                           system_matrix,
-                                           Abs_A_matrix,
-                                           schur_matrix,
-                                           B2pp_matrix));
+      const bool use_fieldsplit = parameters.fluid_block_solver == "fieldsplit";
+      // Building the preconditioner takes several passes over the matrices,
+      // so the old one is used as long as it keeps the iterations low.
+      bool rebuilt = false;
+      if (!preconditioner ||
+          last_gmres_iterations >= parameters.fluid_rebuild_iterations ||
+          (parameters.fluid_rebuild_tpp_iterations > 0 &&
+           static_cast<unsigned int>(preconditioner->get_Tpp_itr_count()) >=
+             parameters.fluid_rebuild_tpp_iterations))
+        {
+          preconditioner.reset(
+            new BlockIncompSchurPreconditioner(timer2,
+                                               owned_partitioning,
+                                               system_matrix,
+                                               Abs_A_matrix,
+                                               schur_matrix,
+                                               B2pp_matrix,
+                                               workspace,
+                                               parameters,
+                                               !use_fieldsplit));
+          rebuilt = true;
+        }
+      else
+        {
+          preconditioner->Erase_Tpp_count();
+        }
 
+      const int tpp_iterations = preconditioner->get_Tpp_itr_count();
       SolverControl solver_control(
-        system_matrix.m(), 1e-6 * system_rhs.l2_norm(), true);
-
-      // Because PETScWrappers::SolverGMRES requires preconditioner derived
-      // from PETScWrappers::PreconditionBase, we use dealii SolverFGMRES.
-      GrowingVectorMemory<PETScWrappers::MPI::BlockVector> vector_memory;
-      SolverFGMRES<PETScWrappers::MPI::BlockVector> gmres(solver_control,
-                                                          vector_memory);
+        system_matrix.m(),
+        std::max(1e-6, forcing) * system_rhs.l2_norm(),
+        true);
 
       // The solution vector must be non-ghosted
-      gmres.solve(system_matrix, newton_update, system_rhs, *preconditioner);
+      if (use_fieldsplit)
+        {
+          // The same splits as BlockIncompSchurPreconditioner: Euclid on
+          // Avv, and GMRES on the Schur complement preconditioned with
+          // Euclid on B2pp. The Schur complement applies the velocity split
+          // as Pvv, so it is the same Tpp.
+          if (!fieldsplit)
+            {
+              fieldsplit.reset(new Utils::FieldSplitSolver(
+                "fluid_",
+                {{"fieldsplit_0_ksp_type", "preonly"},
+                 {"fieldsplit_0_pc_type", "hypre"},
+                 {"fieldsplit_0_pc_hypre_type", "euclid"},
+                 {"fieldsplit_1_ksp_type", "gmres"},
+                 {"fieldsplit_1_ksp_rtol",
+                  Utilities::to_string(parameters.fluid_schur_tolerance)},
+                 {"fieldsplit_1_ksp_gmres_restart", "200"},
+                 {"fieldsplit_1_pc_type", "hypre"},
+                 {"fieldsplit_1_pc_hypre_type", "euclid"}}));
+              fieldsplit->initialize(
+                system_matrix, owned_partitioning, &B2pp_matrix);
+            }
+          auto state = fieldsplit->solve(newton_update,
+                                         system_rhs,
+                                         solver_control.tolerance(),
+                                         !rebuilt);
+          solver_control.check(state.first, state.second);
+        }
+      else if (parameters.fluid_recycled_vectors > 0)
+        {
+          Utils::SolverGCRO<PETScWrappers::MPI::BlockVector> gcro(
+            solver_control,
+            recycle_space,
+            Utils::SolverGCRO<PETScWrappers::MPI::BlockVector>::AdditionalData(
+              30, parameters.fluid_recycled_vectors));
+          gcro.solve(
+            system_matrix, newton_update, system_rhs, *preconditioner);
+        }
+      else
+        {
+          // Because PETScWrappers::SolverGMRES requires preconditioner
+          // derived from PETScWrappers::PreconditionBase, we use dealii
+          // SolverFGMRES.
+          GrowingVectorMemory<PETScWrappers::MPI::BlockVector> vector_memory;
+          SolverFGMRES<PETScWrappers::MPI::BlockVector> gmres(solver_control,
+                                                              vector_memory);
+          gmres.solve(
+            system_matrix, newton_update, system_rhs, *preconditioner);
+        }
 
       const AffineConstraints<double> &constraints_used =
         use_nonzero_constraints ? nonzero_constraints : zero_constraints;
       constraints_used.distribute(newton_update);
 
+      last_gmres_iterations = solver_control.last_step();
+      performance.add("Krylov iterations", solver_control.last_step());
+      performance.add("Linear solves", 1);
+      telemetry.add("Krylov iterations", solver_control.last_step());
+      telemetry.set("Krylov residual", solver_control.last_value());
+      telemetry.add("Inner Krylov iterations",
+                    preconditioner->get_Tpp_itr_count() - tpp_iterations);
       return {solver_control.last_step(), solver_control.last_value()};
     }
 
@@ -762,17 +948,242 @@ namespace Fluid
           output_results(0);
         }
 
+      update_solution_history();
       time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
       pcout << std::string(96, '*') << std::endl
             << "Time step = " << time.get_timestep()
             << ", at t = " << std::scientific << time.current() << std::endl;
 
+      if (parameters.fluid_time_integration == "explicit")
+        {
+          explicit_step(apply_nonzero_constraints);
+        }
+      else
+        {
+          implicit_step(apply_nonzero_constraints);
+        }
+
+      // Update solution increment, which is used in FSI application.
+      PETScWrappers::MPI::BlockVector tmp1, tmp2;
+      tmp1.reinit(owned_partitioning, mpi_communicator);
+      tmp2.reinit(owned_partitioning, mpi_communicator);
+      tmp1 = evaluation_point;
+      tmp2 = present_solution;
+      tmp2 -= tmp1;
+      solution_increment = tmp2;
+      // Newton iteration converges, update time and solution
+      present_solution = evaluation_point;
+      // Output
+      monitor.monitor(time.get_timestep(), time.current(), present_solution);
+      if (time.time_to_output())
+        {
+          // The stress is only needed by the output.
+          if (parameters.output_field("stress"))
+            update_stress();
+          output_results(time.get_timestep());
+        }
+      // Save checkpoint
+      if (parameters.simulation_type == "Fluid" && time.time_to_save())
+        {
+          save_checkpoint(time.get_timestep());
+        }
+      if (parameters.simulation_type == "Fluid" && time.time_to_refine())
+        {
+          refine_mesh(parameters.global_refinements[0],
+                      parameters.global_refinements[0] + 3);
+        }
+    }
+
+    template <int dim>
+    void SCnsIM<dim>::assemble_explicit_residual()
+    {
+      TimerOutput::Scope timer_section(timer, "Assemble explicit residual");
+      Utils::CounterRegion counter_region("Assemble explicit residual");
+
+      Tensor<1, dim> gravity;
+      for (unsigned int i = 0; i < dim; ++i)
+        gravity[i] = parameters.gravity[i];
+
+      system_rhs = 0;
+      lumped_mass = 0;
+
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      const unsigned int n_q_points = volume_quad_formula.size();
+      const unsigned int n_face_q_points = face_quad_formula.size();
+
+      const FEValuesExtractors::Vector velocities(0);
+
+      // The same parameters as in assemble.
+      const double cp_to_cv = 1.4;
+      const double atm = 1013250;
+
+      auto local_assemble =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            AssemblyScratchData &scratch,
+            AssemblyCopyData &data) {
+          FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+          auto &local_rhs = data.local_rhs;
+          auto &local_mass = data.local_mass_matrix;
+          auto &current_velocity_values = scratch.current_velocity_values;
+          auto &current_velocity_gradients = scratch.current_velocity_gradients;
+          auto &current_pressure_values = scratch.current_pressure_values;
+          auto &current_pressure_gradients = scratch.current_pressure_gradients;
+          auto &sigma_pml = scratch.sigma_pml;
+          auto &artificial_bf = scratch.artificial_bf;
+          auto &div_phi_u = scratch.div_phi_u;
+          auto &phi_u = scratch.phi_u;
+          auto &grad_phi_u = scratch.grad_phi_u;
+          auto &phi_p = scratch.phi_p;
+          auto &grad_phi_p = scratch.grad_phi_p;
+
+          const unsigned int cell_index = cell->active_cell_index();
+          const bool in_pml = pml_cells[cell_index];
+          if (in_pml)
+            {
+              std::copy_n(pml_sigma_values.begin() + cell_index * n_q_points,
+                          n_q_points,
+                          sigma_pml.begin());
+            }
+
+          scratch.reinit(cell);
+
+          local_rhs = 0;
+          local_mass = 0;
+
+          {
+            std::lock_guard<std::mutex> lock(assembly_mutex);
+            scratch.get_velocity_values(
+              evaluation_point, current_velocity_values);
+            scratch.get_velocity_gradients(
+              evaluation_point, current_velocity_gradients);
+            scratch.get_pressure_values(
+              evaluation_point, current_pressure_values);
+            scratch.get_pressure_gradients(
+              evaluation_point, current_pressure_gradients);
+            body_force->value_list(scratch.get_quadrature_points(),
+                                   artificial_bf);
+          }
+
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              const double rho =
+                parameters.fluid_rho * (1 + current_pressure_values[q] / atm);
+              const double current_velocity_divergence =
+                trace(current_velocity_gradients[q]);
+
+              for (unsigned int k = 0; k < dofs_per_cell; ++k)
+                {
+                  div_phi_u[k] = scratch.velocity_divergence(k, q);
+                  grad_phi_u[k] = scratch.velocity_gradient(k, q);
+                  phi_u[k] = scratch.velocity_value(k, q);
+                  phi_p[k] = scratch.pressure_value(k, q);
+                  grad_phi_p[k] = scratch.pressure_gradient(k, q);
+                }
+
+              for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                {
+                  // The row sums of the mass matrix: every shape function
+                  // has a single nonzero component.
+                  const unsigned int component =
+                    fe.system_to_component_index(i).first;
+                  local_mass(i, i) += (component < dim ? rho : 1 / atm) *
+                                      scratch.shape_value(i, q) *
+                                      scratch.JxW(q);
+
+                  // The rhs of assemble without the inertial terms.
+                  local_rhs(i) +=
+                    (-parameters.viscosity *
+                       scalar_product(current_velocity_gradients[q],
+                                      grad_phi_u[i]) -
+                     rho * current_velocity_gradients[q] *
+                       current_velocity_values[q] * phi_u[i] +
+                     current_pressure_values[q] * div_phi_u[i] +
+                     (gravity + artificial_bf[q]) * phi_u[i] * rho -
+                     (cp_to_cv * (atm + current_pressure_values[q]) *
+                        current_velocity_divergence +
+                      current_velocity_values[q] *
+                        current_pressure_gradients[q]) *
+                       phi_p[i] / atm) *
+                    scratch.JxW(q);
+                  if (in_pml)
+                    {
+                      local_rhs(i) +=
+                        -(rho * sigma_pml[q] * current_velocity_values[q] *
+                            phi_u[i] +
+                          sigma_pml[q] * current_pressure_values[q] *
+                            phi_p[i] / atm) *
+                        scratch.JxW(q);
+                    }
+                }
+            }
+
+          if (parameters.n_fluid_neumann_bcs != 0)
+            {
+              for (unsigned int face_n = 0;
+                   face_n < GeometryInfo<dim>::faces_per_cell;
+                   ++face_n)
+                {
+                  if (cell->at_boundary(face_n) &&
+                      parameters.fluid_neumann_bcs.find(
+                        cell->face(face_n)->boundary_id()) !=
+                        parameters.fluid_neumann_bcs.end())
+                    {
+                      fe_face_values.reinit(cell, face_n);
+                      const double boundary_values_p =
+                        parameters.fluid_neumann_bcs.at(
+                          cell->face(face_n)->boundary_id());
+                      for (unsigned int q = 0; q < n_face_q_points; ++q)
+                        {
+                          for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                            {
+                              local_rhs(i) += -(
+                                fe_face_values[velocities].value(i, q) *
+                                fe_face_values.normal_vector(q) *
+                                boundary_values_p * fe_face_values.JxW(q));
+                            }
+                        }
+                    }
+                }
+            }
+
+          cell->get_dof_indices(data.local_dof_indices);
+        };
+
+      // The copier runs serially, so it can share the buffer.
+      Vector<double> cell_mass(dofs_per_cell);
+      auto copy_local_to_global = [&](const AssemblyCopyData &data) {
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+          {
+            cell_mass[i] = data.local_mass_matrix(i, i);
+          }
+        zero_constraints.distribute_local_to_global(
+          data.local_rhs, data.local_dof_indices, system_rhs);
+        zero_constraints.distribute_local_to_global(
+          cell_mass, data.local_dof_indices, lumped_mass);
+      };
+
+      assemble_cells(local_assemble, copy_local_to_global);
+
+      system_rhs.compress(VectorOperation::add);
+      lumped_mass.compress(VectorOperation::add);
+    }
+
+    template <int dim>
+    void SCnsIM<dim>::implicit_step(const bool apply_nonzero_constraints)
+    {
       // Resetting
       double current_residual = 1.0;
       double initial_residual = 1.0;
       double relative_residual = 1.0;
       unsigned int outer_iteration = 0;
-      evaluation_point = present_solution;
+      n_linear_iterations = 0;
+      extrapolate_solution(evaluation_point);
+      forcing.reset();
+      // Whether the line search of the last iteration has already assembled
+      // the system at evaluation_point.
+      bool assembled = false;
       while (relative_residual > parameters.fluid_tolerance &&
              current_residual > 1e-14)
         {
@@ -788,9 +1199,18 @@ namespace Fluid
           // should be applied at the first iteration of every time step;
           // if they are time-independent, nonzero_constraints should be
           // applied only at the first iteration of the first time step.
-          assemble(apply_nonzero_constraints && outer_iteration == 0);
-          auto state = solve(apply_nonzero_constraints && outer_iteration == 0);
+          const bool use_nonzero_constraints =
+            apply_nonzero_constraints && outer_iteration == 0;
+          if (!assembled)
+            {
+              assemble(use_nonzero_constraints);
+            }
           current_residual = system_rhs.l2_norm();
+          const double eta = parameters.fluid_inexact_newton
+                               ? forcing.next(current_residual)
+                               : 0;
+          auto state = solve(use_nonzero_constraints, eta);
+          n_linear_iterations = std::max(n_linear_iterations, state.first);
 
           // Update evaluation_point. Since newton_update has been set to
           // the correct bc values, there is no need to distribute the
@@ -799,14 +1219,42 @@ namespace Fluid
           PETScWrappers::MPI::BlockVector tmp;
           tmp.reinit(owned_partitioning, mpi_communicator);
           tmp = evaluation_point;
-          tmp += newton_update;
-          evaluation_point = tmp;
+          double step = 1;
+          assembled = false;
+          // As in InsIM, the step that applies the Dirichlet values is
+          // always taken in full, and the system at the accepted trial point
+          // is used by the next iteration.
+          if (parameters.fluid_line_search_steps > 0 &&
+              !use_nonzero_constraints)
+            {
+              const PETScWrappers::MPI::BlockVector base(tmp);
+              step = Utils::line_search(
+                [&](const double s) {
+                  tmp = base;
+                  tmp.add(s, newton_update);
+                  start_ghost_update(evaluation_point, tmp);
+                  assemble(false);
+                  return system_rhs.l2_norm();
+                },
+                current_residual,
+                std::max(1e-6, eta),
+                parameters.fluid_line_search_steps);
+              assembled = true;
+            }
+          else
+            {
+              // The ghost values are exchanged during the next assembly.
+              tmp += newton_update;
+              start_ghost_update(evaluation_point, tmp);
+            }
 
           if (outer_iteration == 0)
             {
               initial_residual = current_residual;
             }
           relative_residual = current_residual / initial_residual;
+          telemetry.add("Newton iterations", 1);
+          telemetry.set("Newton residual", current_residual);
 
           pcout << std::scientific << std::left << " ITR = " << std::setw(2)
                 << outer_iteration << " ABS_RES = " << current_residual
@@ -814,36 +1262,81 @@ namespace Fluid
                 << " GMRES_ITR = " << std::setw(3) << state.first
                 << " GMRES_RES = " << state.second
                 << " INNER_GMRES_ITR = " << std::setw(3)
-                << preconditioner->get_Tpp_itr_count() << std::endl;
+                << preconditioner->get_Tpp_itr_count();
+          if (parameters.fluid_line_search_steps > 0)
+            {
+              pcout << " STEP = " << step;
+            }
+          pcout << std::endl;
           outer_iteration++;
         }
-      // Update solution increment, which is used in FSI application.
-      PETScWrappers::MPI::BlockVector tmp1, tmp2;
-      tmp1.reinit(owned_partitioning, mpi_communicator);
-      tmp2.reinit(owned_partitioning, mpi_communicator);
-      tmp1 = evaluation_point;
-      tmp2 = present_solution;
-      tmp2 -= tmp1;
-      solution_increment = tmp2;
-      // Newton iteration converges, update time and solution
-      present_solution = evaluation_point;
-      // Update stress for output
-      update_stress();
-      // Output
-      if (time.time_to_output())
-        {
-          output_results(time.get_timestep());
-        }
-      // Save checkpoint
-      if (parameters.simulation_type == "Fluid" && time.time_to_save())
+      finish_ghost_updates();
+      n_newton_iterations = outer_iteration;
+    }
+
+    template <int dim>
+    void SCnsIM<dim>::explicit_step(const bool apply_nonzero_constraints)
+    {
+      // The LSRK4(5) 2N-storage coefficients, M. H. Carpenter and
+      // C. A. Kennedy, Fourth-order 2N-storage Runge-Kutta schemes,
+      // NASA TM-109112 (1994). The stage times are not needed since the
+      // boundary values are fixed over the step.
+      static const std::array<double, 5> rk_a = {
+        {0.0,
+         -567301805773.0 / 1357537059087.0,
+         -2404267990393.0 / 2016746695238.0,
+         -3550918686646.0 / 2091501179385.0,
+         -1275806237668.0 / 842570457699.0}};
+      static const std::array<double, 5> rk_b = {
+        {1432997174477.0 / 9575080441755.0,
+         5161836677717.0 / 13612068292357.0,
+         1720146321549.0 / 2090206949498.0,
+         3134564353537.0 / 4481467310338.0,
+         2277821191437.0 / 14882151754819.0}};
+
+      rk_solution = present_solution;
+      if (apply_nonzero_constraints)
         {
-          save_checkpoint(time.get_timestep());
+          nonzero_constraints.distribute(rk_solution);
         }
-      if (parameters.simulation_type == "Fluid" && time.time_to_refine())
+      rk_update = 0;
+      for (unsigned int stage = 0; stage < rk_a.size(); ++stage)
         {
-          refine_mesh(parameters.global_refinements[0],
-                      parameters.global_refinements[0] + 3);
+          start_ghost_update(evaluation_point, rk_solution);
+          assemble_explicit_residual();
+
+          // Apply the inverse of the lumped mass. The constrained dofs have
+          // no mass, their rates are set by the zero constraints.
+          for (unsigned int b = 0; b < system_rhs.n_blocks(); ++b)
+            {
+              PetscScalar *rhs;
+              const PetscScalar *mass;
+              PetscErrorCode ierr = VecGetArray(system_rhs.block(b), &rhs);
+              AssertThrow(ierr == 0, ExcPETScError(ierr));
+              ierr = VecGetArrayRead(lumped_mass.block(b), &mass);
+              AssertThrow(ierr == 0, ExcPETScError(ierr));
+              for (unsigned int i = 0; i < system_rhs.block(b).local_size();
+                   ++i)
+                {
+                  rhs[i] = mass[i] != 0 ? rhs[i] / mass[i] : 0;
+                }
+              ierr = VecRestoreArrayRead(lumped_mass.block(b), &mass);
+              AssertThrow(ierr == 0, ExcPETScError(ierr));
+              ierr = VecRestoreArray(system_rhs.block(b), &rhs);
+              AssertThrow(ierr == 0, ExcPETScError(ierr));
+            }
+          zero_constraints.distribute(system_rhs);
+
+          rk_update.sadd(rk_a[stage], time.get_delta_t(), system_rhs);
+          rk_solution.add(rk_b[stage], rk_update);
         }
+      evaluation_point = rk_solution;
+
+      n_newton_iterations = 0;
+      n_linear_iterations = 0;
+      performance.add("Residual evaluations", rk_a.size());
+      telemetry.add("Residual evaluations", rk_a.size());
+      pcout << " Explicit step with " << rk_a.size() << " stages" << std::endl;
     }
 
     template <int dim>
@@ -918,7 +1411,9 @@ namespace Fluid
                   bc.second.advance_time(time.get_delta_t());
                 }
             }
-          triangulation.refine_global(parameters.global_refinements[0]);
+          // The mesh of a reused setup is refined already.
+          if (!setup_reused)
+            triangulation.refine_global(parameters.global_refinements[0]);
           setup_dofs();
           make_constraints();
           initialize_system();
@@ -933,6 +1428,8 @@ namespace Fluid
         run_one_step(true);
       while (time.end() - time.current() > 1e-12)
         {
+          // The boundary values are advanced with the new step size.
+          adapt_time_step();
           if (!hard_coded_boundary_values.empty())
             {
               // Only for time dependent BCs!
@@ -1,50 +1,5 @@
 #include "mpi_shared_hyper_elasticity.h"
 
-namespace Internal
-{
-  using namespace dealii;
-
-  template <int dim>
-  void PointHistory<dim>::setup(const Parameters::AllParameters &parameters,
-                                const unsigned int &mat_id)
-  {
-    if (parameters.solid_type == "NeoHookean")
-      {
-        Assert(parameters.C[mat_id - 1].size() >= 2, ExcInternalError());
-        material.reset(new Solid::NeoHookean<dim>(parameters.C[mat_id - 1][0],
-                                                  parameters.C[mat_id - 1][1],
-                                                  parameters.solid_rho));
-        update(parameters, Tensor<2, dim>());
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-  }
-
-  template <int dim>
-  void PointHistory<dim>::update(const Parameters::AllParameters &parameters,
-                                 const Tensor<2, dim> &Grad_u)
-  {
-    const Tensor<2, dim> F = Physics::Elasticity::Kinematics::F(Grad_u);
-    material->update_data(F);
-    F_inv = invert(F);
-    if (parameters.solid_type == "NeoHookean")
-      {
-        auto nh = std::dynamic_pointer_cast<Solid::NeoHookean<dim>>(material);
-        Assert(nh, ExcInternalError());
-        tau = nh->get_tau();
-        Jc = nh->get_Jc();
-      }
-    else
-      {
-        Assert(false, ExcNotImplemented());
-      }
-    dPsi_vol_dJ = material->get_dPsi_vol_dJ();
-    d2Psi_vol_dJ2 = material->get_d2Psi_vol_dJ2();
-  }
-} // namespace Internal
-
 namespace Solid
 {
   namespace MPI
@@ -53,14 +8,32 @@ namespace Solid
 
     template <int dim>
     SharedHyperElasticity<dim>::SharedHyperElasticity(
-      Triangulation<dim> &tria, const Parameters::AllParameters &params)
-      : SharedSolidSolver<dim>(tria, params)
+      Triangulation<dim> &tria,
+      const Parameters::AllParameters &params,
+      const MPI_Comm &mpi_comm)
+      : SharedSolidSolver<dim>(tria, params, mpi_comm)
+    {
+      this->use_system_matrix = params.solid_integrator == "implicit";
+      this->use_mass_matrix = params.solid_integrator == "implicit";
+    }
+
+    template <int dim>
+    void SharedHyperElasticity<dim>::assemble_explicit_force()
     {
+      // The residual is the external minus the internal force.
+      update_qph(current_displacement);
+      assemble_system(false, false);
     }
 
     template <int dim>
     void SharedHyperElasticity<dim>::run_one_step(bool first_step)
     {
+      if (parameters.solid_integrator == "explicit")
+        {
+          this->run_one_explicit_step(first_step);
+          return;
+        }
+
       double gamma = 0.5 + parameters.damping;
       double beta = pow((gamma + 0.5), 2) / 4;
 
@@ -77,6 +50,8 @@ namespace Solid
       PETScWrappers::MPI::Vector tmp(current_displacement);
 
       time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
 
       pcout << std::endl
             << "Timestep " << time.get_timestep() << " @ " << time.current()
@@ -95,12 +70,21 @@ namespace Solid
 
       // The prediction of the current displacement,
       // which is what we want to solve.
-      predicted_displacement = previous_displacement;
-      predicted_displacement.add(
-        dt, previous_velocity, (0.5 - beta) * dt * dt, previous_acceleration);
+      const Utils::NewmarkUpdate newmark(beta, gamma, dt);
+      newmark.predict(predicted_displacement,
+                      previous_displacement,
+                      previous_velocity,
+                      previous_acceleration);
 
       pcout << std::string(100, '_') << std::endl;
 
+      // The tangent is always assembled at the first iteration, the modified
+      // Newton method then keeps it while it is recent and converges well.
+      bool assemble_tangent = true;
+      unsigned int tangent_age = 0;
+      double previous_error_residual = 0;
+      Utils::ForcingTerm forcing(parameters.solid_max_forcing);
+
       while ((normalized_error_update > parameters.tol_d ||
               normalized_error_residual > parameters.tol_f) &&
              error_update > 1e-12 && error_update > 1e-12)
@@ -109,24 +93,36 @@ namespace Solid
                       ExcMessage("Too many Newton iterations!"));
 
           // Compute the displacement, velocity and acceleration
-          current_acceleration = current_displacement;
-          current_acceleration -= predicted_displacement;
-          current_acceleration /= (beta * dt * dt);
-          current_velocity = previous_velocity;
-          current_velocity.add(dt * (1 - gamma),
-                               previous_acceleration,
-                               dt * gamma,
-                               current_acceleration);
+          newmark.correct_from_displacement(current_displacement,
+                                            predicted_displacement,
+                                            current_acceleration,
+                                            current_velocity,
+                                            previous_acceleration,
+                                            previous_velocity);
 
           // Assemble the system, and modify the RHS to account for
           // the time-discretization.
-          assemble_system(false);
+          assemble_system(false, assemble_tangent);
           mass_matrix.vmult(tmp, current_acceleration);
           system_rhs -= tmp;
+          if (assemble_tangent)
+            {
+              tangent_age = 0;
+              // Make solve_factorized factorize the new tangent.
+              this->factorized_delta_t = 0;
+            }
 
+          // The forcing term of the inexact Newton method, which is ignored by
+          // the direct solver.
+          const double eta = parameters.solid_inexact_newton
+                               ? forcing.next(system_rhs.l2_norm())
+                               : 0;
           // Solve linear system
           const std::pair<unsigned int, double> lin_solver_output =
-            this->solve(system_matrix, newton_update, system_rhs);
+            parameters.solid_tangent_reuse > 0 &&
+                parameters.solid_cached_factorization
+              ? this->solve_factorized(newton_update, system_rhs)
+              : this->solve(system_matrix, newton_update, system_rhs, eta);
 
           // Error evaluation
           {
@@ -146,6 +142,17 @@ namespace Solid
               }
             normalized_error_update = error_update / initial_error_update;
           }
+          telemetry.add("Newton iterations", 1);
+          telemetry.set("Newton residual", error_residual);
+
+          // Reassemble the tangent if it is too old, or if it has not halved
+          // the residual.
+          ++tangent_age;
+          assemble_tangent =
+            tangent_age > parameters.solid_tangent_reuse ||
+            (newton_iteration > 0 &&
+             error_residual > 0.5 * previous_error_residual);
+          previous_error_residual = error_residual;
 
           current_displacement += newton_update;
           // Update the quadrature point history with the newest displacement
@@ -161,19 +168,15 @@ namespace Solid
           newton_iteration++;
         }
 
-      // Once converged, update current acceleration and velocity again.
-      current_acceleration = current_displacement;
-      current_acceleration -= predicted_displacement;
-      current_acceleration /= (beta * dt * dt);
-      current_velocity = previous_velocity;
-      current_velocity.add(dt * (1 - gamma),
-                           previous_acceleration,
-                           dt * gamma,
-                           current_acceleration);
-      // Update the previous values
-      previous_acceleration = current_acceleration;
-      previous_velocity = current_velocity;
-      previous_displacement = current_displacement;
+      // Once converged, update current acceleration and velocity again, and
+      // the previous values in the same pass.
+      newmark.correct_from_displacement(current_displacement,
+                                        predicted_displacement,
+                                        current_acceleration,
+                                        current_velocity,
+                                        previous_acceleration,
+                                        previous_velocity,
+                                        previous_displacement);
 
       pcout << std::string(100, '_') << std::endl
             << "Relative errors:" << std::endl
@@ -200,10 +203,28 @@ namespace Solid
       setup_qph();
     }
 
+    template <int dim>
+    void
+    SharedHyperElasticity<dim>::add_memory(Utils::MemoryReport &report) const
+    {
+      SharedSolidSolver<dim>::add_memory(report);
+      report.add_object(
+        "Cell data", "Quadrature point history", quad_point_history);
+    }
+
     template <int dim>
     void SharedHyperElasticity<dim>::setup_qph()
     {
+      Assert(parameters.solid_type == "NeoHookean", ExcNotImplemented());
       const unsigned int n_q_points = volume_quad_formula.size();
+      quad_point_history.reinit(
+        parameters,
+        triangulation.n_active_cells(),
+        GridTools::count_cells_with_subdomain_association(triangulation,
+                                                          this_mpi_process),
+        n_q_points);
+      // Start from the undeformed configuration.
+      const std::vector<Tensor<2, dim>> grad_u(n_q_points);
       for (auto cell = triangulation.begin_active();
            cell != triangulation.end();
            ++cell)
@@ -213,14 +234,11 @@ namespace Solid
           unsigned int mat_id = cell->material_id();
           if (parameters.n_solid_parts == 1)
             mat_id = 1;
-          quad_point_history.initialize(cell, n_q_points);
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
-          for (unsigned int q = 0; q < n_q_points; ++q)
-            {
-              lqph[q]->setup(parameters, mat_id);
-            }
+          quad_point_history.add_cell(cell->active_cell_index(), mat_id);
+          HyperElasticKernel<NeoHookean, dim>::update(
+            quad_point_history,
+            quad_point_history.begin(cell->active_cell_index()),
+            grad_u);
         }
     }
 
@@ -229,11 +247,12 @@ namespace Solid
       const PETScWrappers::MPI::Vector &evaluation_point)
     {
       timer.enter_subsection("Update QPH data");
+      Utils::CounterRegion counter_region("Update QPH data");
 
       // displacement gradient at quad points
       const unsigned int n_q_points = volume_quad_formula.size();
       FEValuesExtractors::Vector displacement(0);
-      std::vector<Tensor<2, dim>> grad_u(volume_quad_formula.size());
+      std::vector<Tensor<2, dim>> grad_u(n_q_points);
       FEValues<dim> fe_values(
         fe, volume_quad_formula, update_values | update_gradients);
 
@@ -244,17 +263,15 @@ namespace Solid
         {
           if (cell->subdomain_id() != this_mpi_process)
             continue;
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first_point =
+            quad_point_history.begin(cell->active_cell_index());
 
           fe_values.reinit(cell);
           fe_values[displacement].get_function_gradients(tmp, grad_u);
 
-          for (unsigned int q = 0; q < n_q_points; ++q)
-            {
-              lqph[q]->update(parameters, grad_u[q]);
-            }
+          // NeoHookean is the only material, see setup_qph.
+          HyperElasticKernel<NeoHookean, dim>::update(
+            quad_point_history, first_point, grad_u);
         }
       timer.leave_subsection();
     }
@@ -272,12 +289,12 @@ namespace Solid
           if (cell->subdomain_id() != this_mpi_process)
             continue;
           fe_values.reinit(cell);
-          const std::vector<std::shared_ptr<const Internal::PointHistory<dim>>>
-            lqph = quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first_point =
+            quad_point_history.begin(cell->active_cell_index());
           for (unsigned int q = 0; q < n_q_points; ++q)
             {
-              const double det = lqph[q]->get_det_F();
+              const unsigned int point = first_point + q;
+              const double det = quad_point_history.get_det_F(point);
               const double JxW = fe_values.JxW(q);
               volume += det * JxW;
             }
@@ -298,9 +315,11 @@ namespace Solid
     }
 
     template <int dim>
-    void SharedHyperElasticity<dim>::assemble_system(bool initial_step)
+    void SharedHyperElasticity<dim>::assemble_system(bool initial_step,
+                                                     bool assemble_matrix)
     {
       timer.enter_subsection("Assemble tangent matrix");
+      Utils::CounterRegion counter_region("Assemble tangent matrix");
 
       const unsigned int n_q_points = volume_quad_formula.size();
       const unsigned int n_f_q_points = face_quad_formula.size();
@@ -313,7 +332,10 @@ namespace Solid
         {
           mass_matrix = 0.0;
         }
-      system_matrix = 0.0;
+      if (assemble_matrix)
+        {
+          system_matrix = 0.0;
+        }
       system_rhs = 0.0;
 
       FEValues<dim> fe_values(fe,
@@ -331,6 +353,7 @@ namespace Solid
         n_q_points, std::vector<Tensor<2, dim>>(dofs_per_cell));
       std::vector<std::vector<SymmetricTensor<2, dim>>> sym_grad_phi(
         n_q_points, std::vector<SymmetricTensor<2, dim>>(dofs_per_cell));
+      std::vector<SymmetricTensor<2, dim>> Jc_sym_grad_phi(dofs_per_cell);
 
       FullMatrix<double> local_matrix(dofs_per_cell, dofs_per_cell);
       FullMatrix<double> local_mass(dofs_per_cell, dofs_per_cell);
@@ -363,13 +386,13 @@ namespace Solid
           local_matrix = 0;
           local_rhs = 0;
 
-          const std::vector<std::shared_ptr<Internal::PointHistory<dim>>> lqph =
-            quad_point_history.get_data(cell);
-          Assert(lqph.size() == n_q_points, ExcInternalError());
+          const unsigned int first_point =
+            quad_point_history.begin(cell->active_cell_index());
 
           for (unsigned int q = 0; q < n_q_points; ++q)
             {
-              const Tensor<2, dim> F_inv = lqph[q]->get_F_inv();
+              const unsigned int point = first_point + q;
+              const Tensor<2, dim> F_inv = quad_point_history.get_F_inv(point);
               for (unsigned int k = 0; k < dofs_per_cell; ++k)
                 {
                   phi[q][k] = fe_values[displacement].value(k, q);
@@ -378,12 +401,24 @@ namespace Solid
                   sym_grad_phi[q][k] = symmetrize(grad_phi[q][k]);
                 }
 
-              const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-              const SymmetricTensor<4, dim> Jc = lqph[q]->get_Jc();
-              const double rho = lqph[q]->get_density();
+              const SymmetricTensor<2, dim> tau =
+                quad_point_history.get_tau(point);
+              const SymmetricTensor<4, dim> &Jc =
+                quad_point_history.get_Jc(point);
+              const double rho = quad_point_history.get_density();
               const double dt = time.get_delta_t();
               const double JxW = fe_values.JxW(q);
 
+              if (!initial_step && assemble_matrix)
+                {
+                  // Contract the tangent once per shape function rather
+                  // than once per pair of them.
+                  for (unsigned int k = 0; k < dofs_per_cell; ++k)
+                    {
+                      Jc_sym_grad_phi[k] = Jc * sym_grad_phi[q][k];
+                    }
+                }
+
               for (unsigned int i = 0; i < dofs_per_cell; ++i)
                 {
                   const unsigned int component_i =
@@ -394,13 +429,13 @@ namespace Solid
                         {
                           local_mass(i, j) += rho * phi[q][i] * phi[q][j] * JxW;
                         }
-                      else
+                      else if (assemble_matrix)
                         {
                           const unsigned int component_j =
                             fe.system_to_component_index(j).first;
                           local_matrix(i, j) +=
                             (phi[q][i] * phi[q][j] * rho / (beta * dt * dt) +
-                             sym_grad_phi[q][i] * Jc * sym_grad_phi[q][j]) *
+                             sym_grad_phi[q][i] * Jc_sym_grad_phi[j]) *
                             JxW;
                           if (component_i == component_j)
                             {
@@ -434,24 +469,11 @@ namespace Solid
           // type should be either Traction or Pressure; it this is a FSI
           // simulation, the Neumann boundary type must be FSI.
 
-          for (unsigned int face = 0; face < GeometryInfo<dim>::faces_per_cell;
-               ++face)
+          for (const auto &neumann_face :
+               neumann_faces(cell->active_cell_index()))
             {
-              unsigned int id = cell->face(face)->boundary_id();
-
-              if (!cell->face(face)->at_boundary())
-                {
-                  // Not a Neumann boundary
-                  continue;
-                }
-
-              if (parameters.simulation_type != "FSI" &&
-                  parameters.solid_neumann_bcs.find(id) ==
-                    parameters.solid_neumann_bcs.end())
-                {
-                  // Traction-free boundary, do nothing
-                  continue;
-                }
+              const unsigned int face = neumann_face.face;
+              unsigned int id = neumann_face.boundary_id;
 
               Tensor<1, dim> traction;
               std::vector<double> prescribed_value;
@@ -552,7 +574,7 @@ namespace Solid
                                                      mass_matrix,
                                                      system_rhs);
             }
-          else
+          else if (assemble_matrix)
             {
               constraints.distribute_local_to_global(local_matrix,
                                                      local_rhs,
@@ -560,13 +582,18 @@ namespace Solid
                                                      system_matrix,
                                                      system_rhs);
             }
+          else
+            {
+              constraints.distribute_local_to_global(
+                local_rhs, local_dof_indices, system_rhs);
+            }
         }
 
       if (initial_step)
         {
           mass_matrix.compress(VectorOperation::add);
         }
-      else
+      else if (assemble_matrix)
         {
           system_matrix.compress(VectorOperation::add);
         }
@@ -577,6 +604,7 @@ namespace Solid
     template <int dim>
     void SharedHyperElasticity<dim>::update_strain_and_stress()
     {
+      Utils::CounterRegion counter_region("Update strain and stress");
       for (unsigned int i = 0; i < dim; ++i)
         {
           for (unsigned int j = 0; j < dim; ++j)
@@ -588,93 +616,54 @@ namespace Solid
       PETScWrappers::MPI::Vector surrounding_cells(locally_owned_scalar_dofs,
                                                    mpi_communicator);
       surrounding_cells = 0.0;
-      // The strain and stress tensors are stored as 2D vectors of shape dim*dim
-      // at cell and quadrature point level.
-      std::vector<std::vector<Vector<double>>> cell_strain(
-        dim,
-        std::vector<Vector<double>>(dim,
-                                    Vector<double>(scalar_fe.dofs_per_cell)));
-      std::vector<std::vector<Vector<double>>> cell_stress(
-        dim,
-        std::vector<Vector<double>>(dim,
-                                    Vector<double>(scalar_fe.dofs_per_cell)));
-      std::vector<std::vector<Vector<double>>> quad_strain(
-        dim,
-        std::vector<Vector<double>>(
-          dim, Vector<double>(volume_quad_formula.size())));
-      std::vector<std::vector<Vector<double>>> quad_stress(
-        dim,
-        std::vector<Vector<double>>(
-          dim, Vector<double>(volume_quad_formula.size())));
-
-      // Displacement gradients at quadrature points.
-      std::vector<Tensor<2, dim>> current_displacement_gradients(
-        volume_quad_formula.size());
-
-      // The projection matrix from quadrature points to the dofs.
-      FullMatrix<double> qpt_to_dof(scalar_fe.dofs_per_cell,
-                                    volume_quad_formula.size());
-      FETools::compute_projection_from_quadrature_points_matrix(
-        scalar_fe, volume_quad_formula, volume_quad_formula, qpt_to_dof);
-
-      const FEValuesExtractors::Vector displacement(0);
+      // The deformation gradient and the Cauchy stress are projected as the
+      // components i * dim + j and dim * dim + i * dim + j.
+      Utils::NodalProjection<dim> projection(scalar_fe,
+                                             volume_quad_formula,
+                                             2 * dim * dim,
+                                             scalar_dof_handler.n_dofs());
+      std::vector<types::global_dof_index> dof_indices(scalar_fe.dofs_per_cell);
 
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_gradients |
-                                update_quadrature_points | update_JxW_values);
       auto cell = dof_handler.begin_active();
       auto scalar_cell = scalar_dof_handler.begin_active();
-      Vector<double> local_sorrounding_cells(scalar_fe.dofs_per_cell);
-      local_sorrounding_cells = 1.0;
-
-      Vector<double> localized_current_displacement(current_displacement);
-
       for (; cell != dof_handler.end(); ++cell, ++scalar_cell)
         {
           if (cell->subdomain_id() == this_mpi_process)
             {
-              fe_values.reinit(cell);
-              const std::vector<std::shared_ptr<Internal::PointHistory<dim>>>
-                lqph = quad_point_history.get_data(cell);
+              const unsigned int first_point =
+                quad_point_history.begin(cell->active_cell_index());
 
               for (unsigned int q = 0; q < volume_quad_formula.size(); ++q)
                 {
-                  const SymmetricTensor<2, dim> tau = lqph[q]->get_tau();
-                  const Tensor<2, dim> F = invert(lqph[q]->get_F_inv());
-                  const double J = lqph[q]->get_det_F();
+                  const unsigned int point = first_point + q;
+                  const SymmetricTensor<2, dim> tau =
+                    quad_point_history.get_tau(point);
+                  const Tensor<2, dim> F =
+                    invert(quad_point_history.get_F_inv(point));
+                  const double J = quad_point_history.get_det_F(point);
                   for (unsigned int i = 0; i < dim; ++i)
                     {
                       for (unsigned int j = 0; j < dim; ++j)
                         {
-                          quad_strain[i][j][q] = F[i][j];
-                          quad_stress[i][j][q] = tau[i][j] / J;
+                          projection.value(q, i * dim + j) = F[i][j];
+                          projection.value(q, dim * dim + i * dim + j) =
+                            tau[i][j] / J;
                         }
                     }
                 }
-
-              for (unsigned int i = 0; i < dim; ++i)
-                {
-                  for (unsigned int j = 0; j < dim; ++j)
-                    {
-                      qpt_to_dof.vmult(cell_strain[i][j], quad_strain[i][j]);
-                      qpt_to_dof.vmult(cell_stress[i][j], quad_stress[i][j]);
-                      scalar_cell->distribute_local_to_global(cell_strain[i][j],
-                                                              strain[i][j]);
-                      scalar_cell->distribute_local_to_global(cell_stress[i][j],
-                                                              stress[i][j]);
-                    }
-                }
-              scalar_cell->distribute_local_to_global(local_sorrounding_cells,
-                                                      surrounding_cells);
+              scalar_cell->get_dof_indices(dof_indices);
+              projection.add_cell(dof_indices);
             }
         }
+      projection.add_counts_to(surrounding_cells);
       surrounding_cells.compress(VectorOperation::add);
 
       for (unsigned int i = 0; i < dim; ++i)
         {
           for (unsigned int j = 0; j < dim; ++j)
             {
+              projection.add_to(i * dim + j, strain[i][j]);
+              projection.add_to(dim * dim + i * dim + j, stress[i][j]);
               strain[i][j].compress(VectorOperation::add);
               stress[i][j].compress(VectorOperation::add);
               const unsigned int local_begin =
@@ -29,6 +29,52 @@ namespace
     };
     return f;
   }
+
+  // In every stage of the time integration, a particle is updated from the
+  // quadrature points in its support, and these from the particles in
+  // theirs. The halo covers two support radii for each of the four stages,
+  // so that the truncated supports at its outer edge do not reach the owned
+  // particles within a step.
+  const double halo_support_radii = 8;
+
+  // The state of a particle or a quadrature point at the end of a step.
+  template <int dim>
+  void pack_state(const particle<dim> *p, std::vector<double> &buffer)
+  {
+    for (unsigned int n = 0; n < dim; ++n)
+      {
+        buffer.push_back(p->x[n]);
+        buffer.push_back(p->v[n]);
+        buffer.push_back(p->previous_v[n]);
+        buffer.push_back(p->a[n]);
+        buffer.push_back(p->v_t[n]);
+      }
+    buffer.push_back(p->rho);
+    buffer.push_back(p->p);
+    for (unsigned int r = 0; r < dim; ++r)
+      for (unsigned int c = 0; c < dim; ++c)
+        buffer.push_back(p->S(r, c));
+  }
+
+  // Restore a state packed by pack_state, and return the end of it.
+  template <int dim>
+  const double *unpack_state(const double *value, particle<dim> *p)
+  {
+    for (unsigned int n = 0; n < dim; ++n)
+      {
+        p->x[n] = *value++;
+        p->v[n] = *value++;
+        p->previous_v[n] = *value++;
+        p->a[n] = *value++;
+        p->v_t[n] = *value++;
+      }
+    p->rho = *value++;
+    p->p = *value++;
+    for (unsigned int r = 0; r < dim; ++r)
+      for (unsigned int c = 0; c < dim; ++c)
+        p->S(r, c) = *value++;
+    return value;
+  }
 } // namespace
 
 namespace Solid
@@ -42,58 +88,37 @@ namespace Solid
       Triangulation<dim> &tria,
       const Parameters::AllParameters &params,
       double dx,
-      double hdx)
-      : SharedSolidSolver<dim>(tria, params), dx(dx), hdx(hdx)
+      double hdx,
+      const MPI_Comm &mpi_comm)
+      : SharedSolidSolver<dim>(tria, params, mpi_comm), dx(dx), hdx(hdx)
     {
+      AssertThrow(!params.adaptive_time_stepping,
+                  ExcMessage("The particle solver takes a fixed time step!"));
     }
 
+
     template <int dim>
     void SharedHypoElasticity<dim>::run_one_step(bool first_step)
     {
-      // Not parallelized yet, only rank 0 does work!
       if (first_step)
         {
-          if (this_mpi_process == 0)
-            {
-              construct_particles();
-              utilities<dim>::vtk_write_particle(m_body->get_particles(),
-                                                 m_body->get_num_part(),
-                                                 time.get_timestep(),
-                                                 "particles");
-            }
+          construct_particles();
+          write_particles();
           this->output_results(time.get_timestep());
         }
       time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
       pcout << std::endl
             << "Timestep " << time.get_timestep() << " @ " << time.current()
             << "s" << std::endl;
-      if (this_mpi_process == 0)
-        {
-          m_body->step();
-          synchronize();
-        }
-      // distribute
-      Vector<double> displacement(dof_handler.n_dofs());
-      Vector<double> velocity(dof_handler.n_dofs());
-      Vector<double> acceleration(dof_handler.n_dofs());
-      Utilities::MPI::sum(
-        serialized_displacement, mpi_communicator, displacement);
-      Utilities::MPI::sum(serialized_velocity, mpi_communicator, velocity);
-      Utilities::MPI::sum(
-        serialized_acceleration, mpi_communicator, acceleration);
-      current_displacement = displacement;
-      current_velocity = velocity;
-      current_acceleration = acceleration;
+      m_body->step();
+      update_ghosts();
+      synchronize();
       if (time.time_to_output())
         {
           this->output_results(time.get_timestep());
-          if (this_mpi_process == 0)
-            {
-              utilities<dim>::vtk_write_particle(m_body->get_particles(),
-                                                 m_body->get_num_part(),
-                                                 time.get_timestep(),
-                                                 "particles");
-            }
+          write_particles();
         }
       if (parameters.simulation_type == "Solid" && time.time_to_save())
         {
@@ -101,15 +126,6 @@ namespace Solid
         }
     }
 
-    template <int dim>
-    void SharedHypoElasticity<dim>::initialize_system()
-    {
-      SharedSolidSolver<dim>::initialize_system();
-      serialized_displacement = Vector<double>(dof_handler.n_dofs());
-      serialized_velocity = Vector<double>(dof_handler.n_dofs());
-      serialized_acceleration = Vector<double>(dof_handler.n_dofs());
-    }
-
     template <int dim>
     void SharedHypoElasticity<dim>::assemble_system(bool initial_step)
     {
@@ -123,34 +139,79 @@ namespace Solid
       // do nothing
     }
 
+    template <int dim>
+    void SharedHypoElasticity<dim>::update_ghosts()
+    {
+      // Every buffer has the particles then the quadrature points.
+      std::map<unsigned int, std::vector<double>> buffers;
+      for (const auto &ids : particles_to_send)
+        {
+          auto &buffer = buffers[ids.first];
+          for (const unsigned int id : ids.second)
+            {
+              pack_state(m_body->get_particles()[id], buffer);
+            }
+        }
+      for (const auto &ids : quad_points_to_send)
+        {
+          auto &buffer = buffers[ids.first];
+          for (const unsigned int id : ids.second)
+            {
+              pack_state(m_body->get_quad_points()[id], buffer);
+            }
+        }
+      const auto received =
+        Utilities::MPI::some_to_some(mpi_communicator, buffers);
+      for (const auto &buffer : received)
+        {
+          const double *value = buffer.second.data();
+          auto particle_ids = particles_to_receive.find(buffer.first);
+          if (particle_ids != particles_to_receive.end())
+            {
+              for (const unsigned int id : particle_ids->second)
+                {
+                  unpack_state(value, m_body->get_cur_particles()[id]);
+                  value = unpack_state(value, m_body->get_particles()[id]);
+                }
+            }
+          auto quad_ids = quad_points_to_receive.find(buffer.first);
+          if (quad_ids != quad_points_to_receive.end())
+            {
+              for (const unsigned int id : quad_ids->second)
+                {
+                  value = unpack_state(value, m_body->get_quad_points()[id]);
+                }
+            }
+          Assert(value == buffer.second.data() + buffer.second.size(),
+                 ExcMessage("Ghost states do not match!"));
+        }
+    }
+
     template <int dim>
     void SharedHypoElasticity<dim>::synchronize()
     {
       std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
-      const unsigned int dofs_per_cell = fe.dofs_per_cell;
       unsigned int n_face_q_points = face_quad_formula.size();
       unsigned int face_quad_point_id = 0;
 
       const FEValuesExtractors::Vector displacement(0);
 
-      FEValues<dim> fe_values(fe, volume_quad_formula, update_values);
-
       FEFaceValues<dim> fe_face_values(
         fe,
         face_quad_formula,
         update_values | update_quadrature_points | update_normal_vectors |
           update_JxW_values);
 
-      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
       std::vector<std::vector<Tensor<1, dim>>> fsi_stress_rows_values(dim);
       for (unsigned int d = 0; d < dim; ++d)
         {
           fsi_stress_rows_values[d].resize(n_face_q_points);
         }
 
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
+      // The ghost particles are up to date, so the tractions are evaluated
+      // on all the local faces, whose quadrature points can be in the
+      // supports of the owned particles.
+      for (const auto &cell : local_cells)
         {
           for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
                ++v)
@@ -159,22 +220,22 @@ namespace Solid
                 {
                   vertex_touched[cell->vertex_index(v)] = true;
                   int id = vertex_mapping[cell->vertex_index(v)];
+                  if (!owned_particles[id])
+                    continue;
                   auto disp = m_body->get_particles()[id]->x -
                               m_body->get_particles()[id]->X;
                   auto vel = m_body->get_particles()[id]->v;
                   auto acc = m_body->get_particles()[id]->a;
                   for (unsigned int n = 0; n < dim; ++n)
                     {
-                      serialized_displacement(cell->vertex_dof_index(v, n)) =
+                      current_displacement[cell->vertex_dof_index(v, n)] =
                         disp[n];
-                      serialized_velocity(cell->vertex_dof_index(v, n)) =
-                        vel[n];
-                      serialized_acceleration(cell->vertex_dof_index(v, n)) =
+                      current_velocity[cell->vertex_dof_index(v, n)] = vel[n];
+                      current_acceleration[cell->vertex_dof_index(v, n)] =
                         acc[n];
                     }
                 }
             }
-          cell->get_dof_indices(local_dof_indices);
           for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
             {
               if (cell->face(f)->at_boundary())
@@ -185,10 +246,12 @@ namespace Solid
                        v < GeometryInfo<dim>::vertices_per_face;
                        ++v)
                     {
+                      int id = vertex_mapping[cell->face(f)->vertex_index(v)];
                       for (unsigned int d = 0; d < dim; ++d)
                         {
-                          vertex_displacement[v][d] = serialized_displacement(
-                            cell->face(f)->vertex_dof_index(v, d));
+                          vertex_displacement[v][d] =
+                            m_body->get_particles()[id]->x[d] -
+                            m_body->get_particles()[id]->X[d];
                         }
                       cell->face(f)->vertex(v) += vertex_displacement[v];
                     }
@@ -229,54 +292,147 @@ namespace Solid
                 }
             }
         }
+      current_displacement.compress(VectorOperation::insert);
+      current_velocity.compress(VectorOperation::insert);
+      current_acceleration.compress(VectorOperation::insert);
+    }
+
+    template <int dim>
+    void SharedHypoElasticity<dim>::write_particles() const
+    {
+      std::vector<particle<dim> *> particles;
+      for (unsigned int i = 0; i < owned_particles.size(); ++i)
+        {
+          if (owned_particles[i])
+            particles.push_back(m_body->get_particles()[i]);
+        }
+      const std::string name =
+        n_mpi_processes == 1
+          ? "particles"
+          : "particles-" + Utilities::int_to_string(this_mpi_process, 4);
+      utilities<dim>::vtk_write_particle(
+        particles.data(), particles.size(), time.get_timestep(), name);
     }
 
     template <int dim>
     void SharedHypoElasticity<dim>::construct_particles()
     {
+      const double support = hdx * dx;
+      // The owned cells, then the halo around them.
+      local_cells.clear();
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (cell->subdomain_id() == this_mpi_process)
+            local_cells.push_back(cell);
+        }
+      const unsigned int n_owned_cells = local_cells.size();
+      if (n_mpi_processes > 1)
+        {
+          // The halo is found from the vertices, so add a cell diameter.
+          const auto halo = GridTools::compute_ghost_cell_layer_within_distance(
+            dof_handler,
+            std::function<bool(
+              const typename DoFHandler<dim>::active_cell_iterator &)>(
+              [this](const typename DoFHandler<dim>::active_cell_iterator
+                       &cell) {
+                return cell->subdomain_id() == this_mpi_process;
+              }),
+            halo_support_radii * support +
+              GridTools::maximal_cell_diameter(triangulation));
+          local_cells.insert(local_cells.end(), halo.begin(), halo.end());
+        }
+      std::vector<int> cell_mapping(triangulation.n_active_cells(), -1);
+      for (unsigned int i = 0; i < local_cells.size(); ++i)
+        {
+          cell_mapping[local_cells[i]->active_cell_index()] = i;
+        }
+
+      // The mass of a particle comes from the first cell of its vertex in
+      // the whole mesh, so that it does not depend on the partition.
+      std::vector<double> vertex_mass(triangulation.n_vertices(), -1);
+      for (auto cell = triangulation.begin_active();
+           cell != triangulation.end();
+           ++cell)
+        {
+          for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+               ++v)
+            {
+              if (vertex_mass[cell->vertex_index(v)] < 0)
+                vertex_mass[cell->vertex_index(v)] =
+                  cell->measure() * parameters.solid_rho;
+            }
+        }
+      std::vector<types::subdomain_id> dof_owners(dof_handler.n_dofs());
+      DoFTools::get_subdomain_association(dof_handler, dof_owners);
+
       FEValues<dim> fe_values(
         fe, volume_quad_formula, update_quadrature_points | update_JxW_values);
       unsigned int n_q_points = volume_quad_formula.size();
       // Particles
-      unsigned int n_particles = triangulation.n_vertices();
-      particle<dim> **particles = new particle<dim> *[n_particles];
-      unsigned int particle_id = 0;
       vertex_mapping = std::vector<int>(triangulation.n_vertices(), -1);
-      // Volume quadrature points, assuming 2nd order integration
-      unsigned int n_vol_quad =
-        volume_quad_formula.size() * triangulation.n_active_cells();
-      particle<dim> **vol_quad_points = new particle<dim> *[n_vol_quad];
-      unsigned int vol_quad_point_id = 0;
-      // Face quadrature points, assuming 2nd order integration
-      unsigned int n_face_q_points = face_quad_formula.size();
-      unsigned int n_face_quad = 0;
-      // Boundary conditions
-      boundary_conditions<dim> bc;
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
+      std::vector<typename DoFHandler<dim>::active_cell_iterator>
+        particle_cells;
+      std::vector<unsigned int> particle_vertices;
+      for (const auto &cell : local_cells)
         {
-          // Vertex
           for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
                ++v)
             {
               if (vertex_mapping[cell->vertex_index(v)] == -1)
                 {
-                  particles[particle_id] = new particle<dim>(particle_id);
-                  for (unsigned int n = 0; n < dim; ++n)
-                    {
-                      particles[particle_id]->X[n] = cell->vertex(v)[n];
-                      particles[particle_id]->x[n] = cell->vertex(v)[n];
-                    }
-                  particles[particle_id]->rho = parameters.solid_rho;
-                  particles[particle_id]->h = hdx * dx;
-                  particles[particle_id]->m =
-                    cell->measure() * parameters.solid_rho;
-                  particles[particle_id]->quad_weight =
-                    particles[particle_id]->m / particles[particle_id]->rho;
-                  vertex_mapping[cell->vertex_index(v)] = particle_id++;
+                  vertex_mapping[cell->vertex_index(v)] =
+                    particle_vertices.size();
+                  particle_cells.push_back(cell);
+                  particle_vertices.push_back(v);
                 }
             }
-          // Volume quad point
+        }
+      unsigned int n_particles = particle_vertices.size();
+      particle<dim> **particles = new particle<dim> *[n_particles];
+      owned_particles = std::vector<bool>(n_particles);
+      particles_to_send.clear();
+      particles_to_receive.clear();
+      quad_points_to_send.clear();
+      quad_points_to_receive.clear();
+      // The vertices then the cells that every process needs from the
+      // others.
+      std::map<unsigned int, std::vector<unsigned int>> ghost_vertices;
+      std::map<unsigned int, std::vector<unsigned int>> ghost_cells;
+      for (unsigned int particle_id = 0; particle_id < n_particles;
+           ++particle_id)
+        {
+          const auto &cell = particle_cells[particle_id];
+          const unsigned int v = particle_vertices[particle_id];
+          particles[particle_id] = new particle<dim>(particle_id);
+          for (unsigned int n = 0; n < dim; ++n)
+            {
+              particles[particle_id]->X[n] = cell->vertex(v)[n];
+              particles[particle_id]->x[n] = cell->vertex(v)[n];
+            }
+          particles[particle_id]->rho = parameters.solid_rho;
+          particles[particle_id]->h = support;
+          particles[particle_id]->m = vertex_mass[cell->vertex_index(v)];
+          particles[particle_id]->quad_weight =
+            particles[particle_id]->m / particles[particle_id]->rho;
+          const unsigned int owner = dof_owners[cell->vertex_dof_index(v, 0)];
+          owned_particles[particle_id] = (owner == this_mpi_process);
+          if (!owned_particles[particle_id])
+            {
+              ghost_vertices[owner].push_back(cell->vertex_index(v));
+              particles_to_receive[owner].push_back(particle_id);
+            }
+        }
+      // Volume quad point, assuming 2nd order integration
+      unsigned int n_vol_quad = n_q_points * local_cells.size();
+      particle<dim> **vol_quad_points = new particle<dim> *[n_vol_quad];
+      unsigned int vol_quad_point_id = 0;
+      // Face quadrature points, assuming 2nd order integration
+      unsigned int n_face_q_points = face_quad_formula.size();
+      unsigned int n_face_quad = 0;
+      for (unsigned int i = 0; i < local_cells.size(); ++i)
+        {
+          const auto &cell = local_cells[i];
           fe_values.reinit(cell);
           for (unsigned int q = 0; q < n_q_points; ++q)
             {
@@ -290,10 +446,16 @@ namespace Solid
                 }
               vol_quad_points[vol_quad_point_id]->quad_weight =
                 fe_values.JxW(q);
-              vol_quad_points[vol_quad_point_id]->h = hdx * dx;
+              vol_quad_points[vol_quad_point_id]->h = support;
               vol_quad_points[vol_quad_point_id]->rho = parameters.solid_rho;
+              if (i >= n_owned_cells)
+                quad_points_to_receive[cell->subdomain_id()].push_back(
+                  vol_quad_point_id);
               vol_quad_point_id++;
             }
+          if (i >= n_owned_cells)
+            ghost_cells[cell->subdomain_id()].push_back(
+              cell->active_cell_index());
           // Count face quad points first
           for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
             {
@@ -303,16 +465,62 @@ namespace Solid
                 }
             }
         }
-      AssertThrow(triangulation.n_vertices() == particle_id,
-                  ExcMessage("Vertices do not match!"));
       AssertThrow(n_vol_quad == vol_quad_point_id,
                   ExcMessage("Volume quadrature points do not match!"));
+
+      // Tell the owners which of their particles and quadrature points
+      // this process needs, as the number of vertices, the vertices and the
+      // cells.
+      std::map<unsigned int, std::vector<unsigned int>> requests;
+      for (const auto &vertices : ghost_vertices)
+        {
+          auto &request = requests[vertices.first];
+          request.push_back(vertices.second.size());
+          request.insert(
+            request.end(), vertices.second.begin(), vertices.second.end());
+        }
+      for (const auto &cells : ghost_cells)
+        {
+          auto &request = requests[cells.first];
+          if (request.empty())
+            request.push_back(0);
+          request.insert(
+            request.end(), cells.second.begin(), cells.second.end());
+        }
+      const auto received_requests =
+        Utilities::MPI::some_to_some(mpi_communicator, requests);
+      for (const auto &request : received_requests)
+        {
+          const unsigned int n_vertices = request.second[0];
+          for (unsigned int i = 1; i < request.second.size(); ++i)
+            {
+              if (i <= n_vertices)
+                {
+                  const int id = vertex_mapping[request.second[i]];
+                  Assert(id >= 0 && owned_particles[id],
+                         ExcMessage("A ghost particle is not owned here!"));
+                  particles_to_send[request.first].push_back(id);
+                }
+              else
+                {
+                  const int cell_id = cell_mapping[request.second[i]];
+                  Assert(cell_id >= 0 &&
+                           cell_id < static_cast<int>(n_owned_cells),
+                         ExcMessage("A ghost cell is not owned here!"));
+                  for (unsigned int q = 0; q < n_q_points; ++q)
+                    quad_points_to_send[request.first].push_back(
+                      cell_id * n_q_points + q);
+                }
+            }
+        }
+
       particle<dim> **face_quad_points = new particle<dim> *[n_face_quad];
       FEFaceValues<dim> fe_face_values(
         fe, face_quad_formula, update_quadrature_points | update_JxW_values);
       unsigned int face_quad_point_id = 0;
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
+      // Boundary conditions
+      boundary_conditions<dim> bc;
+      for (const auto &cell : local_cells)
         {
           // Then set face quad points
           for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
@@ -343,7 +551,7 @@ namespace Solid
                         }
                       face_quad_points[face_quad_point_id]->quad_weight =
                         fe_face_values.JxW(q);
-                      face_quad_points[face_quad_point_id]->h = hdx * dx;
+                      face_quad_points[face_quad_point_id]->h = support;
                       face_quad_points[face_quad_point_id]->rho =
                         parameters.solid_rho;
                       neumann_ids.push_back(face_quad_point_id);
@@ -385,11 +593,11 @@ namespace Solid
       AssertThrow(n_face_quad == face_quad_point_id,
                   ExcMessage("Face quadrature points do not match!"));
 
-      utilities<dim>::find_neighbors(particles, n_particles, hdx * dx);
+      utilities<dim>::find_neighbors(particles, n_particles, support);
       utilities<dim>::find_neighbors(
-        particles, n_particles, vol_quad_points, n_vol_quad, hdx * dx);
+        particles, n_particles, vol_quad_points, n_vol_quad, support);
       utilities<dim>::find_neighbors(
-        particles, n_particles, face_quad_points, n_face_quad, hdx * dx);
+        particles, n_particles, face_quad_points, n_face_quad, support);
       utilities<dim>::precomp_rkpm(particles, vol_quad_points, n_vol_quad);
       utilities<dim>::precomp_rkpm(particles, face_quad_points, n_face_quad);
       utilities<dim>::precomp_rkpm(particles, n_particles);
@@ -411,6 +619,17 @@ namespace Solid
                                            parameters.damping);
     }
 
+
+    template <int dim>
+    void SharedHypoElasticity<dim>::save_step_state()
+    {
+      // The stress of the particles is integrated in time, and is not
+      // recovered from the displacement.
+      AssertThrow(false,
+                  ExcMessage("The hypoelastic solver cannot repeat a time "
+                             "step, use a single coupling iteration!"));
+    }
+
     template <int dim>
     bool SharedHypoElasticity<dim>::load_checkpoint()
     {
@@ -423,8 +642,7 @@ namespace Solid
       Vector<double> localized_displacement(current_displacement);
       Vector<double> localized_velocity(current_velocity);
       Vector<double> localized_acceleration(current_acceleration);
-      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-           ++cell)
+      for (const auto &cell : local_cells)
         {
           for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
                ++v)
@@ -465,17 +683,26 @@ namespace Solid
         }
       AssertThrow(checkpoint_file != local_path,
                   ExcMessage("Could not find restart files for stress!"));
-      // set time step load the checkpoint file
-      Vector<double> stress(m_body->get_num_quad_points() * (dim * dim + 1));
+      // The stress of all the volume quadrature points, in the order of the
+      // active cells.
+      const unsigned int n_q_points = volume_quad_formula.size();
+      Vector<double> stress(triangulation.n_active_cells() * n_q_points *
+                            (dim * dim + 1));
       std::ifstream fs_stress(checkpoint_file);
       stress.block_read(fs_stress);
-      unsigned int iter = 0;
-      for (unsigned int i = 0; i < m_body->get_num_quad_points(); ++i)
+      for (unsigned int i = 0; i < local_cells.size(); ++i)
         {
-          for (unsigned int r = 0; r < dim; ++r)
-            for (unsigned int c = 0; c < dim; ++c)
-              m_body->get_quad_points()[i]->S(r, c) = stress[iter++];
-          m_body->get_quad_points()[i]->p = stress[iter++];
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              unsigned int iter =
+                (local_cells[i]->active_cell_index() * n_q_points + q) *
+                (dim * dim + 1);
+              auto quad_point = m_body->get_quad_points()[i * n_q_points + q];
+              for (unsigned int r = 0; r < dim; ++r)
+                for (unsigned int c = 0; c < dim; ++c)
+                  quad_point->S(r, c) = stress[iter++];
+              quad_point->p = stress[iter++];
+            }
         }
       return true;
     }
@@ -484,19 +711,31 @@ namespace Solid
     void SharedHypoElasticity<dim>::save_checkpoint(const int output_index)
     {
       SharedSolidSolver<dim>::save_checkpoint(output_index);
-      // Stress at quad points
-      if (this_mpi_process == 0)
+      // Stress at the owned quad points, gathered in the order of the
+      // active cells
+      const unsigned int n_q_points = volume_quad_formula.size();
+      Vector<double> local_stress(triangulation.n_active_cells() * n_q_points *
+                                  (dim * dim + 1));
+      for (unsigned int i = 0; i < local_cells.size(); ++i)
         {
-          Vector<double> stress(m_body->get_num_quad_points() *
-                                (dim * dim + 1));
-          unsigned int iter = 0;
-          for (unsigned int i = 0; i < m_body->get_num_quad_points(); ++i)
+          if (local_cells[i]->subdomain_id() != this_mpi_process)
+            break;
+          for (unsigned int q = 0; q < n_q_points; ++q)
             {
+              unsigned int iter =
+                (local_cells[i]->active_cell_index() * n_q_points + q) *
+                (dim * dim + 1);
+              auto quad_point = m_body->get_quad_points()[i * n_q_points + q];
               for (unsigned int r = 0; r < dim; ++r)
                 for (unsigned int c = 0; c < dim; ++c)
-                  stress[iter++] = m_body->get_quad_points()[i]->S(r, c);
-              stress[iter++] = m_body->get_quad_points()[i]->p;
+                  local_stress[iter++] = quad_point->S(r, c);
+              local_stress[iter++] = quad_point->p;
             }
+        }
+      Vector<double> stress(local_stress.size());
+      Utilities::MPI::sum(local_stress, mpi_communicator, stress);
+      if (this_mpi_process == 0)
+        {
           fs::path local_path = fs::current_path();
           std::set<fs::path> checkpoints;
           for (const auto &p : fs::directory_iterator(local_path))
@@ -8,8 +8,10 @@ namespace Solid
 
     template <int dim>
     SharedLinearElasticity<dim>::SharedLinearElasticity(
-      Triangulation<dim> &tria, const Parameters::AllParameters &parameters)
-      : SharedSolidSolver<dim>(tria, parameters)
+      Triangulation<dim> &tria,
+      const Parameters::AllParameters &parameters,
+      const MPI_Comm &mpi_comm)
+      : SharedSolidSolver<dim>(tria, parameters, mpi_comm)
     {
       material.resize(parameters.n_solid_parts, LinearElasticMaterial<dim>());
       for (unsigned int i = 0; i < parameters.n_solid_parts; ++i)
@@ -20,20 +22,37 @@ namespace Solid
                                          parameters.eta[i]);
           material[i] = tmp;
         }
+      if (parameters.solid_integrator == "implicit")
+        {
+          this->use_system_matrix = true;
+          this->use_stiffness_matrix = !parameters.solid_matrix_free;
+          this->use_damping_matrix =
+            !parameters.solid_matrix_free &&
+            std::any_of(parameters.eta.begin(),
+                        parameters.eta.end(),
+                        [](const double eta) { return eta > 0; });
+        }
     }
 
     template <int dim>
-    void SharedLinearElasticity<dim>::assemble_system(const bool is_initial)
+    void SharedLinearElasticity<dim>::assemble(const bool is_initial,
+                                               const bool assemble_matrix)
     {
       TimerOutput::Scope timer_section(timer, "Assemble system");
+      Utils::CounterRegion counter_region("Assemble system");
 
       double alpha = -parameters.damping;
       double gamma = 0.5 - alpha;
       double beta = pow((1 + alpha), 2) / 4;
 
-      system_matrix = 0;
-      stiffness_matrix = 0;
-      damping_matrix = 0;
+      if (assemble_matrix)
+        {
+          system_matrix = 0;
+          if (this->use_stiffness_matrix)
+            stiffness_matrix = 0;
+          if (this->use_damping_matrix)
+            damping_matrix = 0;
+        }
       system_rhs = 0;
 
       FEValues<dim> fe_values(fe,
@@ -65,6 +84,16 @@ namespace Solid
 
       Vector<double> localized_displacement(current_displacement);
 
+      // The explicit integrator needs the total force on the rhs.
+      const bool internal_force = !assemble_matrix;
+      Vector<double> localized_velocity;
+      std::vector<SymmetricTensor<2, dim>> symmetric_grad_u(n_q_points);
+      std::vector<SymmetricTensor<2, dim>> symmetric_grad_v(n_q_points);
+      if (internal_force)
+        {
+          localized_velocity = current_velocity;
+        }
+
       // The symmetric gradients of the displacement shape functions at a
       // certain point. There are dofs_per_cell shape functions so the size is
       // dofs_per_cell.
@@ -103,10 +132,21 @@ namespace Solid
               local_rhs = 0;
 
               fe_values.reinit(cell);
+              if (internal_force)
+                {
+                  fe_values[displacements].get_function_symmetric_gradients(
+                    localized_displacement, symmetric_grad_u);
+                  fe_values[displacements].get_function_symmetric_gradients(
+                    localized_velocity, symmetric_grad_v);
+                }
 
               // Loop over quadrature points
               for (unsigned int q = 0; q < n_q_points; ++q)
                 {
+                  const SymmetricTensor<2, dim> sigma =
+                    internal_force ? elasticity * symmetric_grad_u[q] +
+                                       viscosity * symmetric_grad_v[q]
+                                   : SymmetricTensor<2, dim>();
                   // Loop over the dofs once, to calculate the grad_ph_u
                   for (unsigned int k = 0; k < dofs_per_cell; ++k)
                     {
@@ -117,155 +157,149 @@ namespace Solid
                   // Loop over the dofs again, to assemble
                   for (unsigned int i = 0; i < dofs_per_cell; ++i)
                     {
-                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                      if (assemble_matrix)
                         {
-                          if (is_initial)
-                            {
-                              local_matrix[i][j] +=
-                                rho * phi[i] * phi[j] * fe_values.JxW(q);
-                            }
-                          else
+                          for (unsigned int j = 0; j < dofs_per_cell; ++j)
                             {
-                              local_matrix[i][j] +=
-                                (rho * phi[i] * phi[j] +
-                                 symmetric_grad_phi[i] * viscosity *
-                                   symmetric_grad_phi[j] * gamma * dt *
-                                   (1 + alpha) +
-                                 symmetric_grad_phi[i] * elasticity *
-                                   symmetric_grad_phi[j] * beta * dt * dt *
-                                   (1 + alpha)) *
-                                fe_values.JxW(q);
-                              local_stiffness[i][j] +=
-                                symmetric_grad_phi[i] * elasticity *
-                                symmetric_grad_phi[j] * fe_values.JxW(q);
-                              local_damping[i][j] +=
-                                symmetric_grad_phi[i] * viscosity *
-                                symmetric_grad_phi[j] * fe_values.JxW(q);
+                              if (is_initial)
+                                {
+                                  local_matrix[i][j] +=
+                                    rho * phi[i] * phi[j] * fe_values.JxW(q);
+                                }
+                              else
+                                {
+                                  local_matrix[i][j] +=
+                                    (rho * phi[i] * phi[j] +
+                                     symmetric_grad_phi[i] * viscosity *
+                                       symmetric_grad_phi[j] * gamma * dt *
+                                       (1 + alpha) +
+                                     symmetric_grad_phi[i] * elasticity *
+                                       symmetric_grad_phi[j] * beta * dt * dt *
+                                       (1 + alpha)) *
+                                    fe_values.JxW(q);
+                                  local_stiffness[i][j] +=
+                                    symmetric_grad_phi[i] * elasticity *
+                                    symmetric_grad_phi[j] * fe_values.JxW(q);
+                                  local_damping[i][j] +=
+                                    symmetric_grad_phi[i] * viscosity *
+                                    symmetric_grad_phi[j] * fe_values.JxW(q);
+                                }
                             }
                         }
                       local_rhs[i] += phi[i] * gravity * rho * fe_values.JxW(q);
+                      // -internal force
+                      local_rhs[i] -=
+                        symmetric_grad_phi[i] * sigma * fe_values.JxW(q);
                     }
                 }
 
               cell->get_dof_indices(local_dof_indices);
 
               // Traction or Pressure
-              for (unsigned int face = 0;
-                   face < GeometryInfo<dim>::faces_per_cell;
-                   ++face)
+              for (const auto &neumann_face :
+                   neumann_faces(cell->active_cell_index()))
                 {
-                  if (cell->face(face)->at_boundary())
+                  const unsigned int face = neumann_face.face;
+                  unsigned int id = neumann_face.boundary_id;
+
+                  std::vector<double> value;
+                  if (parameters.simulation_type != "FSI")
+                    {
+                      // In stand-alone simulation, the boundary value
+                      // is prescribed by the user.
+                      value = parameters.solid_neumann_bcs[id];
+                    }
+                  Tensor<1, dim> traction;
+                  if (parameters.simulation_type != "FSI" &&
+                      parameters.solid_neumann_bc_type == "Traction")
                     {
-                      unsigned int id = cell->face(face)->boundary_id();
-                      if (!cell->face(face)->at_boundary())
+                      for (unsigned int i = 0; i < dim; ++i)
                         {
-                          // Not a Neumann boundary
-                          continue;
+                          traction[i] = value[i];
                         }
+                    }
 
-                      if (parameters.simulation_type != "FSI" &&
-                          parameters.solid_neumann_bcs.find(id) ==
-                            parameters.solid_neumann_bcs.end())
+                  // Get FSI stress values on face quadrature points
+                  std::vector<Tensor<2, dim>> fsi_stress(n_f_q_points);
+                  if (parameters.simulation_type == "FSI")
+                    {
+                      std::vector<Point<dim>> vertex_displacement(
+                        GeometryInfo<dim>::vertices_per_face);
+                      for (unsigned int v = 0;
+                           v < GeometryInfo<dim>::vertices_per_face;
+                           ++v)
                         {
-                          // Traction-free boundary, do nothing
-                          continue;
+                          for (unsigned int d = 0; d < dim; ++d)
+                            {
+                              vertex_displacement[v][d] =
+                                localized_displacement(
+                                  cell->face(face)->vertex_dof_index(v, d));
+                            }
+                          cell->face(face)->vertex(v) += vertex_displacement[v];
                         }
-
-                      std::vector<double> value;
-                      if (parameters.simulation_type != "FSI")
+                      fe_face_values.reinit(cell, face);
+                      for (unsigned int d = 0; d < dim; ++d)
                         {
-                          // In stand-alone simulation, the boundary value
-                          // is prescribed by the user.
-                          value = parameters.solid_neumann_bcs[id];
+
+                          fe_face_values[displacements].get_function_values(
+                            fsi_stress_rows[d], fsi_stress_rows_values[d]);
                         }
-                      Tensor<1, dim> traction;
-                      if (parameters.simulation_type != "FSI" &&
-                          parameters.solid_neumann_bc_type == "Traction")
+                      for (unsigned int v = 0;
+                           v < GeometryInfo<dim>::vertices_per_face;
+                           ++v)
                         {
-                          for (unsigned int i = 0; i < dim; ++i)
-                            {
-                              traction[i] = value[i];
-                            }
+                          cell->face(face)->vertex(v) -= vertex_displacement[v];
                         }
-
-                      // Get FSI stress values on face quadrature points
-                      std::vector<Tensor<2, dim>> fsi_stress(n_f_q_points);
-                      if (parameters.simulation_type == "FSI")
+                      for (unsigned int q = 0; q < n_f_q_points; ++q)
                         {
-                          std::vector<Point<dim>> vertex_displacement(
-                            GeometryInfo<dim>::vertices_per_face);
-                          for (unsigned int v = 0;
-                               v < GeometryInfo<dim>::vertices_per_face;
-                               ++v)
+                          for (unsigned int d1 = 0; d1 < dim; ++d1)
                             {
-                              for (unsigned int d = 0; d < dim; ++d)
+                              for (unsigned int d2 = 0; d2 < dim; ++d2)
                                 {
-                                  vertex_displacement[v][d] =
-                                    localized_displacement(
-                                      cell->face(face)->vertex_dof_index(v, d));
+                                  fsi_stress[q][d1][d2] =
+                                    fsi_stress_rows_values[d1][q][d2];
                                 }
-                              cell->face(face)->vertex(v) +=
-                                vertex_displacement[v];
                             }
-                          fe_face_values.reinit(cell, face);
-                          for (unsigned int d = 0; d < dim; ++d)
-                            {
+                        } // End looping face quadrature points
+                    }
+                  else
+                    {
+                      fe_face_values.reinit(cell, face);
+                    }
 
-                              fe_face_values[displacements].get_function_values(
-                                fsi_stress_rows[d], fsi_stress_rows_values[d]);
-                            }
-                          for (unsigned int v = 0;
-                               v < GeometryInfo<dim>::vertices_per_face;
-                               ++v)
-                            {
-                              cell->face(face)->vertex(v) -=
-                                vertex_displacement[v];
-                            }
-                          for (unsigned int q = 0; q < n_f_q_points; ++q)
-                            {
-                              for (unsigned int d1 = 0; d1 < dim; ++d1)
-                                {
-                                  for (unsigned int d2 = 0; d2 < dim; ++d2)
-                                    {
-                                      fsi_stress[q][d1][d2] =
-                                        fsi_stress_rows_values[d1][q][d2];
-                                    }
-                                }
-                            } // End looping face quadrature points
+                  for (unsigned int q = 0; q < n_f_q_points; ++q)
+                    {
+                      if (parameters.simulation_type != "FSI" &&
+                          parameters.solid_neumann_bc_type == "Pressure")
+                        {
+                          // The normal is w.r.t. reference
+                          // configuration!
+                          traction = fe_face_values.normal_vector(q);
+                          traction *= value[0];
                         }
-                      else
+                      else if (parameters.simulation_type == "FSI")
                         {
-                          fe_face_values.reinit(cell, face);
+                          traction =
+                            fsi_stress[q] * fe_face_values.normal_vector(q);
                         }
-
-                      for (unsigned int q = 0; q < n_f_q_points; ++q)
+                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
                         {
-                          if (parameters.simulation_type != "FSI" &&
-                              parameters.solid_neumann_bc_type == "Pressure")
-                            {
-                              // The normal is w.r.t. reference
-                              // configuration!
-                              traction = fe_face_values.normal_vector(q);
-                              traction *= value[0];
-                            }
-                          else if (parameters.simulation_type == "FSI")
-                            {
-                              traction =
-                                fsi_stress[q] * fe_face_values.normal_vector(q);
-                            }
-                          for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                            {
-                              const unsigned int component_j =
-                                fe.system_to_component_index(j).first;
-                              // +external force
-                              local_rhs(j) += fe_face_values.shape_value(j, q) *
-                                              traction[component_j] *
-                                              fe_face_values.JxW(q);
-                            }
+                          const unsigned int component_j =
+                            fe.system_to_component_index(j).first;
+                          // +external force
+                          local_rhs(j) += fe_face_values.shape_value(j, q) *
+                                          traction[component_j] *
+                                          fe_face_values.JxW(q);
                         }
                     }
                 }
 
+              if (!assemble_matrix)
+                {
+                  constraints.distribute_local_to_global(
+                    local_rhs, local_dof_indices, system_rhs);
+                  continue;
+                }
               // Now distribute local data to the system, and apply the
               // hanging node constraints at the same time.
               constraints.distribute_local_to_global(local_matrix,
@@ -273,22 +307,97 @@ namespace Solid
                                                      local_dof_indices,
                                                      system_matrix,
                                                      system_rhs);
-              constraints.distribute_local_to_global(
-                local_stiffness, local_dof_indices, stiffness_matrix);
-              constraints.distribute_local_to_global(
-                local_damping, local_dof_indices, damping_matrix);
+              if (this->use_stiffness_matrix)
+                constraints.distribute_local_to_global(
+                  local_stiffness, local_dof_indices, stiffness_matrix);
+              if (this->use_damping_matrix)
+                constraints.distribute_local_to_global(
+                  local_damping, local_dof_indices, damping_matrix);
             }
         }
       // Synchronize with other processors.
-      system_matrix.compress(VectorOperation::add);
       system_rhs.compress(VectorOperation::add);
-      stiffness_matrix.compress(VectorOperation::add);
-      damping_matrix.compress(VectorOperation::add);
+      if (assemble_matrix)
+        {
+          system_matrix.compress(VectorOperation::add);
+          if (this->use_stiffness_matrix)
+            stiffness_matrix.compress(VectorOperation::add);
+          if (this->use_damping_matrix)
+            damping_matrix.compress(VectorOperation::add);
+        }
+    }
+
+    template <int dim>
+    void SharedLinearElasticity<dim>::apply_stiffness_and_damping(
+      const PETScWrappers::MPI::Vector &displacement,
+      const PETScWrappers::MPI::Vector &velocity,
+      PETScWrappers::MPI::Vector &dst)
+    {
+      TimerOutput::Scope timer_section(timer, "Apply stiffness");
+
+      FEValues<dim> fe_values(
+        fe, volume_quad_formula, update_gradients | update_JxW_values);
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      const unsigned int n_q_points = volume_quad_formula.size();
+      Vector<double> local_dst(dofs_per_cell);
+      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+      std::vector<SymmetricTensor<2, dim>> symmetric_grad_u(n_q_points);
+      std::vector<SymmetricTensor<2, dim>> symmetric_grad_v(n_q_points);
+      const FEValuesExtractors::Vector displacements(0);
+      Vector<double> localized_displacement(displacement);
+      Vector<double> localized_velocity(velocity);
+
+      dst = 0;
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (cell->subdomain_id() != this_mpi_process)
+            {
+              continue;
+            }
+          int mat_id = cell->material_id();
+          if (material.size() == 1)
+            mat_id = 1;
+          const SymmetricTensor<4, dim> elasticity =
+            material[mat_id - 1].get_elasticity();
+          const SymmetricTensor<4, dim> viscosity =
+            material[mat_id - 1].get_viscosity();
+
+          fe_values.reinit(cell);
+          fe_values[displacements].get_function_symmetric_gradients(
+            localized_displacement, symmetric_grad_u);
+          fe_values[displacements].get_function_symmetric_gradients(
+            localized_velocity, symmetric_grad_v);
+          local_dst = 0;
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              const SymmetricTensor<2, dim> sigma =
+                elasticity * symmetric_grad_u[q] +
+                viscosity * symmetric_grad_v[q];
+              for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                {
+                  local_dst[i] +=
+                    fe_values[displacements].symmetric_gradient(i, q) * sigma *
+                    fe_values.JxW(q);
+                }
+            }
+          cell->get_dof_indices(local_dof_indices);
+          // The same condensation as the one of the matrices.
+          constraints.distribute_local_to_global(
+            local_dst, local_dof_indices, dst);
+        }
+      dst.compress(VectorOperation::add);
     }
 
     template <int dim>
     void SharedLinearElasticity<dim>::run_one_step(bool first_step)
     {
+      if (parameters.solid_integrator == "explicit")
+        {
+          this->run_one_explicit_step(first_step);
+          return;
+        }
+
       std::cout.precision(6);
       std::cout.width(12);
 
@@ -307,10 +416,12 @@ namespace Solid
           this->output_results(time.get_timestep());
         }
 
-      else if (parameters.simulation_type == "FSI")
+      else if (parameters.simulation_type == "FSI" || time.adaptive())
+        // The system matrix depends on the time step size.
         assemble_system(false);
 
       const double dt = time.get_delta_t();
+      const Utils::NewmarkUpdate newmark(beta, gamma, dt);
 
       PETScWrappers::MPI::Vector tmp1(locally_owned_dofs, mpi_communicator);
       PETScWrappers::MPI::Vector tmp2(locally_owned_dofs, mpi_communicator);
@@ -319,48 +430,50 @@ namespace Solid
       PETScWrappers::MPI::Vector tmp5(locally_owned_dofs, mpi_communicator);
 
       time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
       pcout << std::string(91, '*') << std::endl
             << "Time step = " << time.get_timestep()
             << ", at t = " << std::scientific << time.current() << std::endl;
 
       // Modify the RHS
       tmp1 = system_rhs;
-      tmp2 = previous_displacement;
-      tmp2.add((1 + alpha) * dt,
-               previous_velocity,
-               (0.5 - beta) * dt * dt * (1 + alpha),
-               previous_acceleration);
-      stiffness_matrix.vmult(tmp3, tmp2);
-
-      tmp4 = previous_velocity;
-      tmp4.add((1 + alpha) * (1 - gamma) * dt, previous_acceleration);
-      damping_matrix.vmult(tmp5, tmp4);
-      tmp1 -= tmp3;
-      tmp1 -= tmp5;
+      newmark.predict(tmp2,
+                      tmp4,
+                      previous_displacement,
+                      previous_velocity,
+                      previous_acceleration,
+                      1 + alpha);
+      if (parameters.solid_matrix_free)
+        {
+          apply_stiffness_and_damping(tmp2, tmp4, tmp3);
+          tmp1 -= tmp3;
+        }
+      else
+        {
+          stiffness_matrix.vmult(tmp3, tmp2);
+          tmp1 -= tmp3;
+          if (this->use_damping_matrix)
+            {
+              damping_matrix.vmult(tmp5, tmp4);
+              tmp1 -= tmp5;
+            }
+        }
 
-      auto state = this->solve(system_matrix, current_acceleration, tmp1);
+      auto state =
+        parameters.solid_cached_factorization
+          ? this->solve_factorized(current_acceleration, tmp1)
+          : this->solve(system_matrix, current_acceleration, tmp1);
 
       // update the current velocity
       // \f$ v_{n+1} = v_n + (1-\gamma)\Delta{t}a_n + \gamma\Delta{t}a_{n+1}
-      // \f$
-      current_velocity = previous_velocity;
-      current_velocity.add(dt * (1 - gamma),
-                           previous_acceleration,
-                           dt * gamma,
-                           current_acceleration);
-
-      // update the current displacement
-      current_displacement = previous_displacement;
-      current_displacement.add(dt, previous_velocity);
-      current_displacement.add(dt * dt * (0.5 - beta),
-                               previous_acceleration,
-                               dt * dt * beta,
-                               current_acceleration);
-
-      // update the previous values
-      previous_acceleration = current_acceleration;
-      previous_velocity = current_velocity;
-      previous_displacement = current_displacement;
+      // \f$ and displacement, and the previous values, in one pass
+      newmark.correct(current_acceleration,
+                      current_velocity,
+                      current_displacement,
+                      previous_acceleration,
+                      previous_velocity,
+                      previous_displacement);
 
       pcout << std::scientific << std::left << " CG iteration: " << std::setw(3)
             << state.first << " CG residual: " << state.second << std::endl;
@@ -392,6 +505,7 @@ namespace Solid
     template <int dim>
     void SharedLinearElasticity<dim>::update_strain_and_stress()
     {
+      Utils::CounterRegion counter_region("Update strain and stress");
       for (unsigned int i = 0; i < dim; ++i)
         {
           for (unsigned int j = 0; j < dim; ++j)
@@ -403,46 +517,24 @@ namespace Solid
       PETScWrappers::MPI::Vector surrounding_cells(locally_owned_scalar_dofs,
                                                    mpi_communicator);
       surrounding_cells = 0.0;
-      // The strain and stress tensors are stored as 2D vectors of shape dim*dim
-      // at cell and quadrature point level.
-      std::vector<std::vector<Vector<double>>> cell_strain(
-        dim,
-        std::vector<Vector<double>>(dim,
-                                    Vector<double>(scalar_fe.dofs_per_cell)));
-      std::vector<std::vector<Vector<double>>> cell_stress(
-        dim,
-        std::vector<Vector<double>>(dim,
-                                    Vector<double>(scalar_fe.dofs_per_cell)));
-      std::vector<std::vector<Vector<double>>> quad_strain(
-        dim,
-        std::vector<Vector<double>>(
-          dim, Vector<double>(volume_quad_formula.size())));
-      std::vector<std::vector<Vector<double>>> quad_stress(
-        dim,
-        std::vector<Vector<double>>(
-          dim, Vector<double>(volume_quad_formula.size())));
+      // The strain and the stress are projected as the components
+      // i * dim + j and dim * dim + i * dim + j.
+      Utils::NodalProjection<dim> projection(scalar_fe,
+                                             volume_quad_formula,
+                                             2 * dim * dim,
+                                             scalar_dof_handler.n_dofs());
+      std::vector<types::global_dof_index> dof_indices(scalar_fe.dofs_per_cell);
 
       // Displacement gradients at quadrature points.
       std::vector<Tensor<2, dim>> current_displacement_gradients(
         volume_quad_formula.size());
 
-      // The projection matrix from quadrature points to the dofs.
-      FullMatrix<double> qpt_to_dof(scalar_fe.dofs_per_cell,
-                                    volume_quad_formula.size());
-      FETools::compute_projection_from_quadrature_points_matrix(
-        scalar_fe, volume_quad_formula, volume_quad_formula, qpt_to_dof);
-
       SymmetricTensor<4, dim> elasticity;
       const FEValuesExtractors::Vector displacements(0);
 
-      FEValues<dim> fe_values(fe,
-                              volume_quad_formula,
-                              update_values | update_gradients |
-                                update_quadrature_points | update_JxW_values);
+      FEValues<dim> fe_values(fe, volume_quad_formula, update_gradients);
       auto cell = dof_handler.begin_active();
       auto scalar_cell = scalar_dof_handler.begin_active();
-      Vector<double> local_sorrounding_cells(scalar_fe.dofs_per_cell);
-      local_sorrounding_cells = 1.0;
 
       Vector<double> localized_current_displacement(current_displacement);
 
@@ -469,7 +561,6 @@ namespace Solid
                             (current_displacement_gradients[q][i][j] +
                              current_displacement_gradients[q][j][i]) /
                             2;
-                          quad_strain[i][j][q] = tmp_strain[i][j];
                         }
                     }
                   tmp_stress = elasticity * tmp_strain;
@@ -477,33 +568,25 @@ namespace Solid
                     {
                       for (unsigned int j = 0; j < dim; ++j)
                         {
-                          quad_stress[i][j][q] = tmp_stress[i][j];
+                          projection.value(q, i * dim + j) = tmp_strain[i][j];
+                          projection.value(q, dim * dim + i * dim + j) =
+                            tmp_stress[i][j];
                         }
                     }
                 }
-
-              for (unsigned int i = 0; i < dim; ++i)
-                {
-                  for (unsigned int j = 0; j < dim; ++j)
-                    {
-                      qpt_to_dof.vmult(cell_strain[i][j], quad_strain[i][j]);
-                      qpt_to_dof.vmult(cell_stress[i][j], quad_stress[i][j]);
-                      scalar_cell->distribute_local_to_global(cell_strain[i][j],
-                                                              strain[i][j]);
-                      scalar_cell->distribute_local_to_global(cell_stress[i][j],
-                                                              stress[i][j]);
-                    }
-                }
-              scalar_cell->distribute_local_to_global(local_sorrounding_cells,
-                                                      surrounding_cells);
+              scalar_cell->get_dof_indices(dof_indices);
+              projection.add_cell(dof_indices);
             }
         }
+      projection.add_counts_to(surrounding_cells);
       surrounding_cells.compress(VectorOperation::add);
 
       for (unsigned int i = 0; i < dim; ++i)
         {
           for (unsigned int j = 0; j < dim; ++j)
             {
+              projection.add_to(i * dim + j, strain[i][j]);
+              projection.add_to(dim * dim + i * dim + j, stress[i][j]);
               strain[i][j].compress(VectorOperation::add);
               stress[i][j].compress(VectorOperation::add);
               const unsigned int local_begin =
@@ -9,7 +9,8 @@ namespace Solid
     template <int dim, int spacedim>
     SharedSolidSolver<dim, spacedim>::SharedSolidSolver(
       Triangulation<dim, spacedim> &tria,
-      const Parameters::AllParameters &parameters)
+      const Parameters::AllParameters &parameters,
+      const MPI_Comm &mpi_comm)
       : triangulation(tria),
         parameters(parameters),
         dof_handler(triangulation),
@@ -18,7 +19,11 @@ namespace Solid
         scalar_fe(parameters.solid_degree),
         volume_quad_formula(parameters.solid_degree + 1),
         face_quad_formula(parameters.solid_degree + 1),
-        mpi_communicator(MPI_COMM_WORLD),
+        use_system_matrix(false),
+        use_mass_matrix(false),
+        use_stiffness_matrix(false),
+        use_damping_matrix(false),
+        mpi_communicator(mpi_comm),
         n_mpi_processes(Utilities::MPI::n_mpi_processes(mpi_communicator)),
         this_mpi_process(Utilities::MPI::this_mpi_process(mpi_communicator)),
         pcout(std::cout, (this_mpi_process == 0)),
@@ -28,8 +33,22 @@ namespace Solid
              parameters.refinement_interval,
              parameters.save_interval),
         timer(
-          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times)
+          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+        performance(mpi_communicator, parameters.performance_summary),
+        telemetry(mpi_communicator, parameters.telemetry_prefix, "solid"),
+        memory_report(mpi_communicator, "solid solver"),
+        writer(parameters.async_output),
+        amg_setup_iterations(0),
+        amg_last_iterations(0),
+        factorized_delta_t(0)
     {
+      telemetry.watch(timer);
+      if (parameters.adaptive_time_stepping)
+        {
+          time.set_adaptive(parameters.min_time_step,
+                            parameters.max_time_step,
+                            parameters.max_time_step_growth);
+        }
     }
 
     template <int dim, int spacedim>
@@ -38,6 +57,7 @@ namespace Solid
       scalar_dof_handler.clear();
       dof_handler.clear();
       timer.print_summary();
+      performance.write("solid", timer);
     }
 
     template <int dim, int spacedim>
@@ -49,9 +69,13 @@ namespace Solid
       // here we partition it.
       GridTools::partition_triangulation(n_mpi_processes, triangulation);
 
+      // subdomain_wise keeps the locality ordering within the subdomains.
       dof_handler.distribute_dofs(fe);
+      Utils::renumber_dofs(dof_handler, parameters.dof_renumbering, "none");
       DoFRenumbering::subdomain_wise(dof_handler);
       scalar_dof_handler.distribute_dofs(scalar_fe);
+      Utils::renumber_dofs(
+        scalar_dof_handler, parameters.dof_renumbering, "none");
       DoFRenumbering::subdomain_wise(scalar_dof_handler);
 
       // Extract the locally owned and relevant dofs
@@ -105,6 +129,12 @@ namespace Solid
 
       constraints.close();
 
+      neumann_faces.reinit(triangulation, [this](const types::boundary_id id) {
+        return parameters.simulation_type == "FSI" ||
+               parameters.solid_neumann_bcs.find(id) !=
+                 parameters.solid_neumann_bcs.end();
+      });
+
       pcout << "  Number of active solid cells: "
             << triangulation.n_active_cells() << std::endl
             << "  Number of degrees of freedom: " << dof_handler.n_dofs()
@@ -114,24 +144,50 @@ namespace Solid
     template <int dim, int spacedim>
     void SharedSolidSolver<dim, spacedim>::initialize_system()
     {
+      // The AMG and the factorization refer to the old matrices.
+      amg.clear();
+      rigid_modes.clear();
+      amg_setup_iterations = 0;
+      system_factor.clear();
+      factorized_delta_t = 0;
       DynamicSparsityPattern dsp(dof_handler.n_dofs(), dof_handler.n_dofs());
 
       DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
 
-      system_matrix.reinit(
-        locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
-
-      mass_matrix.reinit(
-        locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
-
-      stiffness_matrix.reinit(
-        locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
+      // Each matrix takes as much memory as the others, so only the ones in
+      // use are allocated.
+      if (use_system_matrix)
+        {
+          system_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
+        }
+      if (use_mass_matrix)
+        {
+          mass_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
+        }
+      if (use_stiffness_matrix)
+        {
+          stiffness_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
+        }
+      if (use_damping_matrix)
+        {
+          damping_matrix.reinit(
+            locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
+        }
 
-      damping_matrix.reinit(
-        locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
+      if (parameters.memory_report)
+        {
+          // The dynamic pattern of the whole mesh only lives during the setup.
+          memory_report.add(
+            "Sparsity", "Dynamic pattern at setup", dsp.memory_consumption());
+        }
 
       system_rhs.reinit(locally_owned_dofs, mpi_communicator);
 
+      inverse_lumped_mass.clear();
+
       current_acceleration.reinit(locally_owned_dofs, mpi_communicator);
 
       current_velocity.reinit(locally_owned_dofs, mpi_communicator);
@@ -169,26 +225,219 @@ namespace Solid
     std::pair<unsigned int, double> SharedSolidSolver<dim, spacedim>::solve(
       const PETScWrappers::MPI::SparseMatrix &A,
       PETScWrappers::MPI::Vector &x,
-      const PETScWrappers::MPI::Vector &b)
+      const PETScWrappers::MPI::Vector &b,
+      const double forcing)
     {
       TimerOutput::Scope timer_section(timer, "Solve linear system");
 
+      const double tolerance = parameters.solid_linear_tolerance > 0
+                                 ? parameters.solid_linear_tolerance
+                                 : 1e-8;
       SolverControl solver_control(dof_handler.n_dofs() * 2,
-                                   1e-8 * b.l2_norm());
-
-      PETScWrappers::SolverCG cg(solver_control, mpi_communicator);
+                                   std::max(tolerance, forcing) * b.l2_norm());
 
-      PETScWrappers::PreconditionNone preconditioner(A);
+      Utils::SolverKrylov cg(
+        solver_control, mpi_communicator, parameters.solid_krylov);
 
-      cg.solve(A, x, b, preconditioner);
+      if (parameters.solid_preconditioner == "amg")
+        {
+          if (rigid_modes.empty())
+            {
+              rigid_modes = Utils::rigid_body_modes(
+                dof_handler, locally_owned_dofs, mpi_communicator);
+            }
+          // Keep the hierarchy while the solves converge nearly as fast as
+          // the first one with it.
+          const bool rebuilt =
+            amg.update(A,
+                       rigid_modes,
+                       amg_last_iterations <= 2 * amg_setup_iterations);
+          cg.solve(A, x, b, amg);
+          amg_last_iterations = solver_control.last_step();
+          if (rebuilt)
+            {
+              amg_setup_iterations = amg_last_iterations;
+            }
+        }
+      else
+        {
+          PreconditionSelector preconditioner;
+          preconditioner.initialize(
+            PreconditionSelector::choose(parameters.solid_preconditioner,
+                                         "none"),
+            A);
+          cg.solve(A, x, b, preconditioner);
+        }
 
       Vector<double> localized_x(x);
       constraints.distribute(localized_x);
       x = localized_x;
 
+      performance.add("Krylov iterations", solver_control.last_step());
+      performance.add("Linear solves", 1);
+      telemetry.add("Krylov iterations", solver_control.last_step());
+      telemetry.set("Krylov residual", solver_control.last_value());
       return {solver_control.last_step(), solver_control.last_value()};
     }
 
+    template <int dim, int spacedim>
+    std::pair<unsigned int, double>
+    SharedSolidSolver<dim, spacedim>::solve_factorized(
+      PETScWrappers::MPI::Vector &x, const PETScWrappers::MPI::Vector &b)
+    {
+      TimerOutput::Scope timer_section(timer, "Solve linear system");
+
+      // The matrix is reassembled at every step in FSI, but its values only
+      // depend on the time step size.
+      system_factor.update(system_matrix,
+                           factorized_delta_t == time.get_delta_t());
+      factorized_delta_t = time.get_delta_t();
+      system_factor.vmult(x, b);
+      Vector<double> localized_x(x);
+      constraints.distribute(localized_x);
+      x = localized_x;
+
+      PETScWrappers::MPI::Vector residual(locally_owned_dofs, mpi_communicator);
+      return {0, system_matrix.residual(residual, x, b)};
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::assemble_lumped_mass()
+    {
+      TimerOutput::Scope timer_section(timer, "Assemble lumped mass");
+
+      FEValues<dim, spacedim> fe_values(
+        fe, volume_quad_formula, update_values | update_JxW_values);
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      const unsigned int n_q_points = volume_quad_formula.size();
+      const double rho = parameters.solid_rho;
+      Vector<double> local_mass(dofs_per_cell);
+      std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+      PETScWrappers::MPI::Vector lumped_mass(locally_owned_dofs,
+                                             mpi_communicator);
+
+      for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+           ++cell)
+        {
+          if (cell->subdomain_id() != this_mpi_process)
+            {
+              continue;
+            }
+          fe_values.reinit(cell);
+          local_mass = 0;
+          // The row sum of the mass matrix is the integral of the shape
+          // function, because the shape functions sum up to 1.
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                {
+                  local_mass[i] +=
+                    rho * fe_values.shape_value(i, q) * fe_values.JxW(q);
+                }
+            }
+          cell->get_dof_indices(local_dof_indices);
+          // Condensing the vector gives the row sums of the condensed matrix.
+          constraints.distribute_local_to_global(
+            local_mass, local_dof_indices, lumped_mass);
+        }
+      lumped_mass.compress(VectorOperation::add);
+
+      inverse_lumped_mass.reinit(locally_owned_dofs, mpi_communicator);
+      const auto range = lumped_mass.local_range();
+      for (auto i = range.first; i < range.second; ++i)
+        {
+          if (!constraints.is_constrained(i))
+            {
+              Assert(lumped_mass[i] > 0, ExcInternalError());
+              inverse_lumped_mass[i] = 1.0 / lumped_mass[i];
+            }
+        }
+      inverse_lumped_mass.compress(VectorOperation::insert);
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::assemble_explicit_force()
+    {
+      AssertThrow(false,
+                  ExcMessage("The explicit time integrator is not "
+                             "implemented for this solid solver!"));
+    }
+
+    template <int dim, int spacedim>
+    void
+    SharedSolidSolver<dim, spacedim>::run_one_explicit_step(bool first_step)
+    {
+      // After a restart or a refinement
+      if (inverse_lumped_mass.size() != dof_handler.n_dofs())
+        {
+          assemble_lumped_mass();
+        }
+
+      // M_L a = f(u, v), and the constrained acceleration follows from the
+      // constraints.
+      auto solve_acceleration = [this](PETScWrappers::MPI::Vector &a) {
+        a = system_rhs;
+        a.scale(inverse_lumped_mass);
+        Vector<double> localized_a(a);
+        constraints.distribute(localized_a);
+        a = localized_a;
+      };
+
+      if (first_step)
+        {
+          assemble_explicit_force();
+          solve_acceleration(previous_acceleration);
+          current_acceleration = previous_acceleration;
+          output_results(time.get_timestep());
+        }
+
+      const double dt = time.get_delta_t();
+      AssertThrow(dt <= get_stable_time_step() * (1 + 1e-10),
+                  ExcMessage("The time step size exceeds the stability "
+                             "limit of the explicit time integrator!"));
+
+      time.increment();
+      telemetry.begin_step(time.get_timestep(), time.current());
+      report_memory();
+      pcout << std::string(91, '*') << std::endl
+            << "Time step = " << time.get_timestep()
+            << ", at t = " << std::scientific << time.current() << std::endl;
+
+      // \f$ v_{n+1/2} = v_n + \frac{\Delta{t}}{2}a_n \f$,
+      // \f$ u_{n+1} = u_n + \Delta{t}v_{n+1/2} \f$
+      current_velocity = previous_velocity;
+      current_velocity.add(0.5 * dt, previous_acceleration);
+      current_displacement = previous_displacement;
+      current_displacement.add(dt, current_velocity);
+
+      // \f$ v_{n+1} = v_{n+1/2} + \frac{\Delta{t}}{2}a_{n+1} \f$
+      assemble_explicit_force();
+      solve_acceleration(current_acceleration);
+      current_velocity.add(0.5 * dt, current_acceleration);
+
+      previous_acceleration = current_acceleration;
+      previous_velocity = current_velocity;
+      previous_displacement = current_displacement;
+
+      update_strain_and_stress();
+
+      if (time.time_to_output())
+        {
+          output_results(time.get_timestep());
+        }
+
+      if (parameters.simulation_type == "Solid" && time.time_to_refine())
+        {
+          refine_mesh(parameters.global_refinements[1],
+                      parameters.global_refinements[1] + 3);
+        }
+
+      if (parameters.simulation_type == "Solid" && time.time_to_save())
+        {
+          save_checkpoint(time.get_timestep());
+        }
+    }
+
     template <int dim, int spacedim>
     void SharedSolidSolver<dim, spacedim>::output_results(
       const unsigned int output_index)
@@ -199,8 +448,14 @@ namespace Solid
       // Since only process 0 writes the output, we want all the others
       // to sned their data to process 0, which is automatically done
       // in this copy constructor.
-      Vector<double> displacement(current_displacement);
-      Vector<double> velocity(current_velocity);
+      // Only the selected fields are gathered.
+      const bool output_strain = parameters.output_field("strain");
+      const bool output_stress = parameters.output_field("stress");
+      Vector<double> displacement, velocity;
+      if (parameters.output_field("displacement"))
+        displacement = current_displacement;
+      if (parameters.output_field("velocity"))
+        velocity = current_velocity;
 
       std::vector<std::vector<Vector<double>>> localized_strain(
         spacedim, std::vector<Vector<double>>(spacedim));
@@ -210,8 +465,10 @@ namespace Solid
         {
           for (unsigned int j = 0; j < dim; ++j)
             {
-              localized_strain[i][j] = strain[i][j];
-              localized_stress[i][j] = stress[i][j];
+              if (output_strain)
+                localized_strain[i][j] = strain[i][j];
+              if (output_stress)
+                localized_stress[i][j] = stress[i][j];
             }
         }
       if (this_mpi_process == 0)
@@ -225,25 +482,33 @@ namespace Solid
           data_out.attach_dof_handler(dof_handler);
 
           // displacements
-          data_out.add_data_vector(
-            displacement,
-            solution_names,
-            DataOut<dim, DoFHandler<dim, spacedim>>::type_dof_data,
-            data_component_interpretation);
+          if (parameters.output_field("displacement"))
+            {
+              data_out.add_data_vector(
+                displacement,
+                solution_names,
+                DataOut<dim, DoFHandler<dim, spacedim>>::type_dof_data,
+                data_component_interpretation);
+            }
 
           // velocity
-          solution_names = std::vector<std::string>(spacedim, "velocities");
-          data_out.add_data_vector(
-            velocity,
-            solution_names,
-            DataOut<dim, DoFHandler<dim, spacedim>>::type_dof_data,
-            data_component_interpretation);
+          if (parameters.output_field("velocity"))
+            {
+              solution_names =
+                std::vector<std::string>(spacedim, "velocities");
+              data_out.add_data_vector(
+                velocity,
+                solution_names,
+                DataOut<dim, DoFHandler<dim, spacedim>>::type_dof_data,
+                data_component_interpretation);
+            }
 
           std::vector<unsigned int> subdomain_int(
             triangulation.n_active_cells());
           GridTools::get_subdomain_association(triangulation, subdomain_int);
           Vector<float> subdomain(subdomain_int.begin(), subdomain_int.end());
-          data_out.add_data_vector(subdomain, "subdomain");
+          if (parameters.output_field("subdomain"))
+            data_out.add_data_vector(subdomain, "subdomain");
 
           // material ID
           Vector<float> mat(triangulation.n_active_cells());
@@ -254,49 +519,43 @@ namespace Solid
             {
               mat[i++] = cell->material_id();
             }
-          data_out.add_data_vector(mat, "material_id");
-
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_strain[0][0], "Exx");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_strain[0][1], "Exy");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_strain[1][1], "Eyy");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_stress[0][0], "Sxx");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_stress[0][1], "Sxy");
-          data_out.add_data_vector(
-            scalar_dof_handler, localized_stress[1][1], "Syy");
-          if (spacedim == 3)
+          if (parameters.output_field("material_id"))
+            data_out.add_data_vector(mat, "material_id");
+
+          const char *axes = "xyz";
+          for (unsigned int k = 0; k < spacedim; ++k)
             {
-              data_out.add_data_vector(
-                scalar_dof_handler, localized_strain[0][2], "Exz");
-              data_out.add_data_vector(
-                scalar_dof_handler, localized_strain[1][2], "Eyz");
-              data_out.add_data_vector(
-                scalar_dof_handler, localized_strain[2][2], "Ezz");
-              data_out.add_data_vector(
-                scalar_dof_handler, localized_stress[0][2], "Sxz");
-              data_out.add_data_vector(
-                scalar_dof_handler, localized_stress[1][2], "Syz");
-              data_out.add_data_vector(
-                scalar_dof_handler, localized_stress[2][2], "Szz");
+              for (unsigned int l = k; l < spacedim; ++l)
+                {
+                  const std::string suffix{axes[k], axes[l]};
+                  if (output_strain)
+                    data_out.add_data_vector(scalar_dof_handler,
+                                             localized_strain[k][l],
+                                             "E" + suffix);
+                  if (output_stress)
+                    data_out.add_data_vector(scalar_dof_handler,
+                                             localized_stress[k][l],
+                                             "S" + suffix);
+                }
             }
 
-          data_out.build_patches();
+          Utils::select_output_cells(data_out, parameters.output_region);
+          data_out.build_patches(parameters.output_subdivisions);
+          data_out.set_flags(Utils::vtk_flags(parameters.output_compression));
 
           std::string basename =
             "solid-" + Utilities::int_to_string(output_index, 6);
 
           std::string filename = basename + ".vtu";
 
-          std::ofstream output(filename);
-          data_out.write_vtu(output);
+          writer.write(filename, [&data_out](std::ostream &out) {
+            data_out.write_vtu(out);
+          });
 
           times_and_names.push_back({time.current(), filename});
-          std::ofstream pvd_output("solid.pvd");
-          DataOutBase::write_pvd_record(pvd_output, times_and_names);
+          writer.write("solid.pvd", [this](std::ostream &out) {
+            DataOutBase::write_pvd_record(out, times_and_names);
+          });
         }
     }
 
@@ -396,15 +655,113 @@ namespace Solid
       // Time loop
       if (!success_load)
         run_one_step(true);
-      else
+      else if (parameters.solid_integrator == "implicit")
         // If we load from previous task, we need to assemble the mass matrix
         assemble_system(true);
       while (time.end() - time.current() > 1e-12)
         {
+          if (time.adaptive())
+            {
+              time.adapt_delta_t(get_stable_time_step());
+            }
           run_one_step(false);
         }
     }
 
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::add_memory(
+      Utils::MemoryReport &report) const
+    {
+      report.add_object("Mesh", "Triangulation", triangulation);
+      report.add_object("Mesh", "DoFHandler", dof_handler);
+      report.add_object("Mesh", "Scalar DoFHandler", scalar_dof_handler);
+      report.add_object("Sparsity", "Constraints", constraints);
+      report.add("Matrices",
+                 "System matrix",
+                 Utils::MemoryReport::matrix_memory(system_matrix));
+      report.add("Matrices",
+                 "Mass matrix",
+                 Utils::MemoryReport::matrix_memory(mass_matrix));
+      report.add("Matrices",
+                 "Stiffness matrix",
+                 Utils::MemoryReport::matrix_memory(stiffness_matrix));
+      report.add("Matrices",
+                 "Damping matrix",
+                 Utils::MemoryReport::matrix_memory(damping_matrix));
+      report.add("Vectors",
+                 "Newmark states and rhs",
+                 current_acceleration.memory_consumption() +
+                   current_velocity.memory_consumption() +
+                   current_displacement.memory_consumption() +
+                   previous_acceleration.memory_consumption() +
+                   previous_velocity.memory_consumption() +
+                   previous_displacement.memory_consumption() +
+                   system_rhs.memory_consumption());
+      double fsi_stress = 0;
+      for (const auto &row : fsi_stress_rows)
+        {
+          fsi_stress += row.memory_consumption();
+        }
+      report.add("Vectors", "FSI stress", fsi_stress);
+      double nodal = 0;
+      for (const auto &row : stress)
+        {
+          for (const auto &component : row)
+            {
+              nodal += component.memory_consumption();
+            }
+        }
+      for (const auto &row : strain)
+        {
+          for (const auto &component : row)
+            {
+              nodal += component.memory_consumption();
+            }
+        }
+      report.add("Vectors", "Nodal strain and stress", nodal);
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::report_memory()
+    {
+      if (!parameters.memory_report || memory_report.empty())
+        {
+          return;
+        }
+      add_memory(memory_report);
+      memory_report.print(pcout,
+                          "at time step " +
+                            Utilities::int_to_string(time.get_timestep()));
+    }
+
+    template <int dim, int spacedim>
+    double SharedSolidSolver<dim, spacedim>::get_stable_time_step() const
+    {
+      // Every process has the entire triangulation.
+      double delta_t = std::numeric_limits<double>::max();
+      double courant = parameters.solid_courant;
+      if (courant == 0 && parameters.solid_integrator == "explicit")
+        {
+          courant = 1;
+        }
+      if (courant == 0)
+        {
+          return delta_t;
+        }
+      for (auto cell = triangulation.begin_active();
+           cell != triangulation.end();
+           ++cell)
+        {
+          const unsigned int part =
+            parameters.n_solid_parts == 1 ? 0 : cell->material_id() - 1;
+          delta_t = std::min(delta_t,
+                             courant * cell->minimum_vertex_distance() /
+                               (parameters.solid_degree *
+                                parameters.wave_speed(part)));
+        }
+      return delta_t;
+    }
+
     template <int dim, int spacedim>
     PETScWrappers::MPI::Vector
     SharedSolidSolver<dim, spacedim>::get_current_solution() const
@@ -423,6 +780,9 @@ namespace Solid
 
       if (this_mpi_process == 0)
         {
+          // The previous checkpoint must be on disk before the old ones are
+          // removed.
+          writer.wait();
           // Specify the current working path
           fs::path local_path = fs::current_path();
           // A set to store all the filenames for checkpoints
@@ -452,16 +812,22 @@ namespace Solid
           checkpoint_file.append(Utilities::int_to_string(output_index, 6));
           checkpoint_file.replace_extension(".solid_checkpoint_displacement");
           pcout << "Prepare to save to " << checkpoint_file << std::endl;
-          std::ofstream disp(checkpoint_file);
+          writer.write(checkpoint_file.string(),
+                       [&localized_disp](std::ostream &out) {
+                         localized_disp.block_write(out);
+                       });
           checkpoint_file.replace_extension(".solid_checkpoint_velocity");
           pcout << "Prepare to save to " << checkpoint_file << std::endl;
-          std::ofstream vel(checkpoint_file);
+          writer.write(checkpoint_file.string(),
+                       [&localized_vel](std::ostream &out) {
+                         localized_vel.block_write(out);
+                       });
           checkpoint_file.replace_extension(".solid_checkpoint_acceleration");
-          std::ofstream acc(checkpoint_file);
           pcout << "Prepare to save to " << checkpoint_file << std::endl;
-          localized_disp.block_write(disp);
-          localized_vel.block_write(vel);
-          localized_acc.block_write(acc);
+          writer.write(checkpoint_file.string(),
+                       [&localized_acc](std::ostream &out) {
+                         localized_acc.block_write(out);
+                       });
         }
 
       pcout << "Checkpoint file successfully saved at time step "
@@ -493,6 +859,9 @@ namespace Solid
             << std::endl;
           return false;
         }
+      AssertThrow(!time.adaptive(),
+                  ExcMessage("Restarting is not supported with adaptive time "
+                             "stepping!"));
       // set time step load the checkpoint file
       setup_dofs();
       initialize_system();
@@ -514,11 +883,45 @@ namespace Solid
       previous_displacement = current_displacement;
       previous_velocity = current_velocity;
       previous_acceleration = current_acceleration;
+      restore_time(Utilities::string_to_int(checkpoint_file.stem()));
+
+      pcout << "Checkpoint file successfully loaded from time step "
+            << time.get_timestep() << "!" << std::endl;
+      return true;
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::save_step_state()
+    {
+      step_state.time = time.state();
+      step_state.current_acceleration = current_acceleration;
+      step_state.current_velocity = current_velocity;
+      step_state.current_displacement = current_displacement;
+      step_state.previous_acceleration = previous_acceleration;
+      step_state.previous_velocity = previous_velocity;
+      step_state.previous_displacement = previous_displacement;
+      step_state.n_outputs = times_and_names.size();
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::restore_step_state()
+    {
+      time.rewind(step_state.time);
+      current_acceleration = step_state.current_acceleration;
+      current_velocity = step_state.current_velocity;
+      current_displacement = step_state.current_displacement;
+      previous_acceleration = step_state.previous_acceleration;
+      previous_velocity = step_state.previous_velocity;
+      previous_displacement = step_state.previous_displacement;
+      times_and_names.resize(step_state.n_outputs);
+    }
+
+    template <int dim, int spacedim>
+    void SharedSolidSolver<dim, spacedim>::restore_time(const int timestep)
+    {
       // Update the time and names to set the current time and write
       // correct .pvd file.
-
-      for (int i = 0; i <= Utilities::string_to_int(checkpoint_file.stem());
-           ++i)
+      for (int i = 0; i <= timestep; ++i)
         {
           if ((time.current() == 0 || time.time_to_output()) &&
               Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
@@ -529,14 +932,10 @@ namespace Solid
 
               times_and_names.push_back({time.current(), filename});
             }
-          if (i == Utilities::string_to_int(checkpoint_file.stem()))
+          if (i == timestep)
             break;
           time.increment();
         }
-
-      pcout << "Checkpoint file successfully loaded from time step "
-            << time.get_timestep() << "!" << std::endl;
-      return true;
     }
 
     template class SharedSolidSolver<2>;
@@ -6,8 +6,8 @@ namespace Solid
   {
     using namespace dealii;
 
-    template <int dim>
-    SolidSolver<dim>::SolidSolver(
+    template <int dim, typename Backend>
+    SolidSolver<dim, Backend>::SolidSolver(
       parallel::distributed::Triangulation<dim> &tria,
       const Parameters::AllParameters &parameters)
       : triangulation(tria),
@@ -21,31 +21,49 @@ namespace Solid
         mpi_communicator(MPI_COMM_WORLD),
         pcout(std::cout,
               (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)),
+        hdf5_output(mpi_communicator, "solid"),
+        insitu_output(
+          mpi_communicator, "solid-insitu", parameters.insitu_actions),
+        writer(parameters.async_output),
         time(parameters.end_time,
              parameters.time_step,
              parameters.output_interval,
              parameters.refinement_interval,
              parameters.save_interval),
         timer(
-          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times)
+          mpi_communicator, pcout, TimerOutput::never, TimerOutput::wall_times),
+        performance(mpi_communicator, parameters.performance_summary),
+        telemetry(mpi_communicator, parameters.telemetry_prefix, "solid"),
+        memory_report(mpi_communicator, "solid solver"),
+        amg_setup_iterations(0),
+        amg_last_iterations(0),
+        factorized_delta_t(0)
     {
+      telemetry.watch(timer);
+      if (parameters.adaptive_time_stepping)
+        {
+          time.set_adaptive(parameters.min_time_step,
+                            parameters.max_time_step,
+                            parameters.max_time_step_growth);
+        }
     }
 
-    template <int dim>
-    SolidSolver<dim>::~SolidSolver()
+    template <int dim, typename Backend>
+    SolidSolver<dim, Backend>::~SolidSolver()
     {
       dg_dof_handler.clear();
       dof_handler.clear();
       timer.print_summary();
+      performance.write("solid", timer);
     }
 
-    template <int dim>
-    void SolidSolver<dim>::setup_dofs()
+    template <int dim, typename Backend>
+    void SolidSolver<dim, Backend>::setup_dofs()
     {
       TimerOutput::Scope timer_section(timer, "Setup system");
 
       dof_handler.distribute_dofs(fe);
-      DoFRenumbering::Cuthill_McKee(dof_handler);
+      Utils::renumber_dofs(dof_handler, parameters.dof_renumbering);
       dg_dof_handler.distribute_dofs(dg_fe);
 
       // Extract the locally owned and relevant dofs
@@ -95,15 +113,26 @@ namespace Solid
 
       constraints.close();
 
+      neumann_faces.reinit(triangulation, [this](const types::boundary_id id) {
+        return parameters.simulation_type == "FSI" ||
+               parameters.solid_neumann_bcs.find(id) !=
+                 parameters.solid_neumann_bcs.end();
+      });
+
       pcout << "  Number of active solid cells: "
             << triangulation.n_global_active_cells() << std::endl
             << "  Number of degrees of freedom: " << dof_handler.n_dofs()
             << std::endl;
     }
 
-    template <int dim>
-    void SolidSolver<dim>::initialize_system()
+    template <int dim, typename Backend>
+    void SolidSolver<dim, Backend>::initialize_system()
     {
+      // The AMG and the factorization refer to the old matrices.
+      amg.clear();
+      amg_setup_iterations = 0;
+      system_factor.clear();
+      factorized_delta_t = 0;
       DynamicSparsityPattern dsp(locally_relevant_dofs);
 
       DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
@@ -123,6 +152,13 @@ namespace Solid
       stiffness_matrix.reinit(
         locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
 
+      if (parameters.memory_report)
+        {
+          // The dynamic pattern only lives during the setup.
+          memory_report.add(
+            "Sparsity", "Dynamic pattern at setup", dsp.memory_consumption());
+        }
+
       system_rhs.reinit(locally_owned_dofs, mpi_communicator);
 
       current_acceleration.reinit(locally_owned_dofs, mpi_communicator);
@@ -136,31 +172,93 @@ namespace Solid
       previous_velocity.reinit(locally_owned_dofs, mpi_communicator);
 
       previous_displacement.reinit(locally_owned_dofs, mpi_communicator);
+
+      fsi_stress_rows.resize(dim);
+      for (unsigned int d = 0; d < dim; ++d)
+        {
+          fsi_stress_rows[d].reinit(
+            locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
+        }
     }
 
     // Solve linear system \f$Ax = b\f$ using CG solver.
-    template <int dim>
+    template <int dim, typename Backend>
     std::pair<unsigned int, double>
-    SolidSolver<dim>::solve(const PETScWrappers::MPI::SparseMatrix &A,
-                            PETScWrappers::MPI::Vector &x,
-                            const PETScWrappers::MPI::Vector &b)
+    SolidSolver<dim, Backend>::solve(const MatrixType &A,
+                                     VectorType &x,
+                                     const VectorType &b,
+                                     const double forcing)
     {
       TimerOutput::Scope timer_section(timer, "Solve linear system");
 
-      SolverControl solver_control(dof_handler.n_dofs(), 1e-8 * b.l2_norm());
-
-      PETScWrappers::SolverCG cg(solver_control, mpi_communicator);
+      const double tolerance = parameters.solid_linear_tolerance > 0
+                                 ? parameters.solid_linear_tolerance
+                                 : 1e-8;
+      SolverControl solver_control(dof_handler.n_dofs(),
+                                   std::max(tolerance, forcing) * b.l2_norm());
 
-      PETScWrappers::PreconditionBlockJacobi preconditioner(A);
+      typename Traits::SolverCG cg(
+        solver_control, mpi_communicator, parameters.solid_krylov);
 
-      cg.solve(A, x, b, preconditioner);
+      if (parameters.solid_preconditioner == "amg")
+        {
+          // Keep the hierarchy while the solves converge nearly as fast as
+          // the first one with it.
+          const bool rebuilt =
+            amg.update(A,
+                       dof_handler,
+                       mpi_communicator,
+                       amg_last_iterations <= 2 * amg_setup_iterations);
+          cg.solve(A, x, b, amg);
+          amg_last_iterations = solver_control.last_step();
+          if (rebuilt)
+            {
+              amg_setup_iterations = amg_last_iterations;
+            }
+        }
+      else if (parameters.solid_preconditioner == "default")
+        {
+          typename Traits::DefaultPreconditioner preconditioner;
+          preconditioner.initialize(A);
+          cg.solve(A, x, b, preconditioner);
+        }
+      else
+        {
+          typename Traits::PreconditionSelector preconditioner;
+          preconditioner.initialize(parameters.solid_preconditioner, A);
+          cg.solve(A, x, b, preconditioner);
+        }
       constraints.distribute(x);
 
+      performance.add("Krylov iterations", solver_control.last_step());
+      performance.add("Linear solves", 1);
+      telemetry.add("Krylov iterations", solver_control.last_step());
+      telemetry.set("Krylov residual", solver_control.last_value());
       return {solver_control.last_step(), solver_control.last_value()};
     }
 
-    template <int dim>
-    void SolidSolver<dim>::output_results(const unsigned int output_index) const
+    template <int dim, typename Backend>
+    std::pair<unsigned int, double>
+    SolidSolver<dim, Backend>::solve_factorized(VectorType &x,
+                                                const VectorType &b)
+    {
+      TimerOutput::Scope timer_section(timer, "Solve linear system");
+
+      // The matrix is reassembled at every step in FSI, but its values only
+      // depend on the time step size.
+      system_factor.update(system_matrix,
+                           factorized_delta_t == time.get_delta_t());
+      factorized_delta_t = time.get_delta_t();
+      system_factor.vmult(x, b);
+      constraints.distribute(x);
+
+      VectorType residual(locally_owned_dofs, mpi_communicator);
+      return {0, system_matrix.residual(residual, x, b)};
+    }
+
+    template <int dim, typename Backend>
+    void SolidSolver<dim, Backend>::output_results(
+      const unsigned int output_index) const
     {
       TimerOutput::Scope timer_section(timer, "Output results");
       pcout << "Writing solid results..." << std::endl;
@@ -174,21 +272,25 @@ namespace Solid
 
       // DataOut needs more than locally owned dofs, so we have to construct a
       // ghosted vector to store the solution.
-      PETScWrappers::MPI::Vector solution(
+      VectorType solution(
         locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
       solution = current_displacement;
 
-      data_out.add_data_vector(solution,
-                               solution_names,
-                               DataOut<dim>::type_dof_data,
-                               data_component_interpretation);
+      if (parameters.output_field("displacement"))
+        {
+          data_out.add_data_vector(solution,
+                                   solution_names,
+                                   DataOut<dim>::type_dof_data,
+                                   data_component_interpretation);
+        }
 
       Vector<float> subdomain(triangulation.n_active_cells());
       for (unsigned int i = 0; i < subdomain.size(); ++i)
         {
           subdomain(i) = triangulation.locally_owned_subdomain();
         }
-      data_out.add_data_vector(subdomain, "subdomain");
+      if (parameters.output_field("subdomain"))
+        data_out.add_data_vector(subdomain, "subdomain");
 
       // material ID
       Vector<float> mat(triangulation.n_active_cells());
@@ -199,9 +301,23 @@ namespace Solid
         {
           mat[i++] = cell->material_id();
         }
-      data_out.add_data_vector(mat, "material_id");
+      if (parameters.output_field("material_id"))
+        data_out.add_data_vector(mat, "material_id");
 
-      data_out.build_patches();
+      Utils::select_output_cells(data_out, parameters.output_region);
+      data_out.build_patches(parameters.output_subdivisions);
+      data_out.set_flags(Utils::vtk_flags(parameters.output_compression));
+
+      if (parameters.output_format == "hdf5")
+        {
+          hdf5_output.write(data_out, output_index, time.current());
+          return;
+        }
+      if (parameters.output_format == "ascent")
+        {
+          insitu_output.publish(data_out, output_index, time.current());
+          return;
+        }
 
       std::string basename =
         "solid-" + Utilities::int_to_string(output_index, 6) + "-";
@@ -211,8 +327,8 @@ namespace Solid
         Utilities::int_to_string(triangulation.locally_owned_subdomain(), 4) +
         ".vtu";
 
-      std::ofstream output(filename);
-      data_out.write_vtu(output);
+      writer.write(filename,
+                   [&data_out](std::ostream &out) { data_out.write_vtu(out); });
 
       // Processor 0 writes the pvd file that tells ParaView filenames and time.
       static std::vector<std::pair<double, std::string>> times_and_names;
@@ -226,22 +342,25 @@ namespace Solid
                 {time.current(),
                  basename + Utilities::int_to_string(i, 4) + ".vtu"});
             }
-          std::ofstream pvd_output("solid.pvd");
-          DataOutBase::write_pvd_record(pvd_output, times_and_names);
+          writer.write("solid.pvd", [](std::ostream &out) {
+            DataOutBase::write_pvd_record(out, times_and_names);
+          });
         }
     }
 
-    template <int dim>
-    void SolidSolver<dim>::refine_mesh(const unsigned int min_grid_level,
-                                       const unsigned int max_grid_level)
+    template <int dim, typename Backend>
+    void
+    SolidSolver<dim, Backend>::refine_mesh(const unsigned int min_grid_level,
+                                           const unsigned int max_grid_level)
     {
       TimerOutput::Scope timer_section(timer, "Refine mesh");
       pcout << "Refining mesh..." << std::endl;
+      hdf5_output.mesh_changed();
 
       Vector<float> estimated_error_per_cell(triangulation.n_active_cells());
 
       // In order to estimate error, the distributed vector must be ghosted.
-      PETScWrappers::MPI::Vector solution;
+      VectorType solution;
       solution.reinit(
         locally_owned_dofs, locally_relevant_dofs, mpi_communicator);
       solution = current_displacement;
@@ -272,16 +391,13 @@ namespace Solid
         }
 
       // Prepare to transfer previous solutions
-      std::vector<parallel::distributed::
-                    SolutionTransfer<dim, PETScWrappers::MPI::Vector>>
-        trans(
-          3,
-          parallel::distributed::SolutionTransfer<dim,
-                                                  PETScWrappers::MPI::Vector>(
-            dof_handler));
-      std::vector<PETScWrappers::MPI::Vector> buffers(
+      std::vector<parallel::distributed::SolutionTransfer<dim, VectorType>>
+        trans(3,
+              parallel::distributed::SolutionTransfer<dim, VectorType>(
+                dof_handler));
+      std::vector<VectorType> buffers(
         3,
-        PETScWrappers::MPI::Vector(
+        VectorType(
           locally_owned_dofs, locally_relevant_dofs, mpi_communicator));
       buffers[0] = previous_displacement;
       buffers[1] = previous_velocity;
@@ -311,8 +427,8 @@ namespace Solid
       constraints.distribute(previous_acceleration);
     }
 
-    template <int dim>
-    void SolidSolver<dim>::run()
+    template <int dim, typename Backend>
+    void SolidSolver<dim, Backend>::run()
     {
       triangulation.refine_global(parameters.global_refinements[1]);
       setup_dofs();
@@ -322,17 +438,100 @@ namespace Solid
       run_one_step(true);
       while (time.end() - time.current() > 1e-12)
         {
+          if (time.adaptive())
+            {
+              time.adapt_delta_t(get_stable_time_step());
+            }
           run_one_step(false);
         }
     }
 
-    template <int dim>
-    PETScWrappers::MPI::Vector SolidSolver<dim>::get_current_solution() const
+    template <int dim, typename Backend>
+    void
+    SolidSolver<dim, Backend>::add_memory(Utils::MemoryReport &report) const
+    {
+      report.add_object("Mesh", "Triangulation", triangulation);
+      report.add_object("Mesh", "DoFHandler", dof_handler);
+      report.add_object("Mesh", "DG DoFHandler", dg_dof_handler);
+      report.add_object("Sparsity", "Constraints", constraints);
+      report.add("Matrices",
+                 "System matrix",
+                 Traits::matrix_memory(system_matrix));
+      report.add("Matrices",
+                 "Mass matrix",
+                 Traits::matrix_memory(mass_matrix));
+      report.add("Matrices",
+                 "Stiffness matrix",
+                 Traits::matrix_memory(stiffness_matrix));
+      report.add("Vectors",
+                 "Newmark states and rhs",
+                 current_acceleration.memory_consumption() +
+                   current_velocity.memory_consumption() +
+                   current_displacement.memory_consumption() +
+                   previous_acceleration.memory_consumption() +
+                   previous_velocity.memory_consumption() +
+                   previous_displacement.memory_consumption() +
+                   system_rhs.memory_consumption());
+      double fsi_stress = 0;
+      for (const auto &row : fsi_stress_rows)
+        {
+          fsi_stress += row.memory_consumption();
+        }
+      report.add("Vectors", "FSI stress", fsi_stress);
+    }
+
+    template <int dim, typename Backend>
+    void SolidSolver<dim, Backend>::report_memory()
+    {
+      if (!parameters.memory_report || memory_report.empty())
+        {
+          return;
+        }
+      add_memory(memory_report);
+      memory_report.print(pcout,
+                          "at time step " +
+                            Utilities::int_to_string(time.get_timestep()));
+    }
+
+    template <int dim, typename Backend>
+    double SolidSolver<dim, Backend>::get_stable_time_step() const
+    {
+      double delta_t = std::numeric_limits<double>::max();
+      if (parameters.solid_courant == 0)
+        {
+          return delta_t;
+        }
+      for (auto cell = triangulation.begin_active();
+           cell != triangulation.end();
+           ++cell)
+        {
+          if (!cell->is_locally_owned())
+            {
+              continue;
+            }
+          const unsigned int part =
+            parameters.n_solid_parts == 1 ? 0 : cell->material_id() - 1;
+          delta_t = std::min(delta_t,
+                             parameters.solid_courant *
+                               cell->minimum_vertex_distance() /
+                               (parameters.solid_degree *
+                                parameters.wave_speed(part)));
+        }
+      return Utilities::MPI::min(delta_t, mpi_communicator);
+    }
+
+    template <int dim, typename Backend>
+    typename SolidSolver<dim, Backend>::VectorType
+    SolidSolver<dim, Backend>::get_current_solution() const
     {
       return current_displacement;
     }
 
     template class SolidSolver<2>;
     template class SolidSolver<3>;
+#ifdef OPENIFEM_WITH_TRILINOS
+    template class SolidSolver<2, Utils::TrilinosBackend>;
+    template class SolidSolver<3, Utils::TrilinosBackend>;
+#endif
   } // namespace MPI
 } // namespace Solid
@@ -0,0 +1,310 @@
+#include "output_writers.h"
+#include <experimental/filesystem>
+#include <sstream>
+
+namespace Utils
+{
+  template <int dim, typename DoFHandlerType>
+  void select_output_cells(DataOut<dim, DoFHandlerType> &data_out,
+                           const std::vector<double> &region)
+  {
+    if (region.empty())
+      {
+        return;
+      }
+    constexpr int spacedim = DoFHandlerType::space_dimension;
+    AssertDimension(region.size(), 2 * spacedim);
+    using cell_iterator = typename DataOut<dim, DoFHandlerType>::cell_iterator;
+    using active_cell_iterator =
+      typename Triangulation<dim, spacedim>::active_cell_iterator;
+    // Skip the cells of the other processes like DataOut does by default.
+    auto selected = [region](const active_cell_iterator &cell) {
+      if (!cell->is_locally_owned())
+        return false;
+      const Point<spacedim> center = cell->center();
+      for (int d = 0; d < spacedim; ++d)
+        {
+          if (center[d] < region[d] || center[d] > region[spacedim + d])
+            return false;
+        }
+      return true;
+    };
+    auto next_selected = [selected](const Triangulation<dim, spacedim> &tria,
+                                    active_cell_iterator cell) {
+      while (cell != tria.end() && !selected(cell))
+        {
+          ++cell;
+        }
+      return cell_iterator(cell);
+    };
+    data_out.set_cell_selection(
+      [next_selected](const Triangulation<dim, spacedim> &tria) {
+        return next_selected(tria, tria.begin_active());
+      },
+      [next_selected](const Triangulation<dim, spacedim> &tria,
+                      const cell_iterator &cell) {
+        active_cell_iterator next(cell);
+        return next_selected(tria, ++next);
+      });
+  }
+
+  DataOutBase::VtkFlags vtk_flags(const std::string &compression)
+  {
+    DataOutBase::VtkFlags flags;
+    if (compression == "best_speed")
+      flags.compression_level = DataOutBase::VtkFlags::best_speed;
+    else if (compression == "best_compression")
+      flags.compression_level = DataOutBase::VtkFlags::best_compression;
+    else if (compression == "none")
+      flags.compression_level = DataOutBase::VtkFlags::no_compression;
+    return flags;
+  }
+
+  HDF5Output::HDF5Output(const MPI_Comm &comm, const std::string &name)
+    : mpi_communicator(comm), basename(name), write_mesh(true)
+  {
+  }
+
+  template <int dim>
+  void HDF5Output::write(const DataOut<dim> &data_out,
+                         const unsigned int output_index,
+                         const double time)
+  {
+    // XDMF requires the duplicated vertices of the patches to be merged.
+    DataOutBase::DataOutFilter data_filter(
+      DataOutBase::DataOutFilterFlags(true, true));
+    data_out.write_filtered_data(data_filter);
+
+    const std::string index = Utilities::int_to_string(output_index, 6);
+    if (write_mesh)
+      {
+        mesh_filename = basename + "-mesh-" + index + ".h5";
+      }
+    const std::string solution_filename = basename + "-" + index + ".h5";
+    data_out.write_hdf5_parallel(data_filter,
+                                 write_mesh,
+                                 mesh_filename,
+                                 solution_filename,
+                                 mpi_communicator);
+    write_mesh = false;
+
+    entries.push_back(data_out.create_xdmf_entry(
+      data_filter, mesh_filename, solution_filename, time, mpi_communicator));
+    data_out.write_xdmf_file(entries, basename + ".xdmf", mpi_communicator);
+  }
+
+  InSituOutput::InSituOutput(const MPI_Comm &comm,
+                             const std::string &name,
+                             const std::string &actions)
+    : mpi_communicator(comm),
+      directory(name),
+      actions_file(actions)
+#ifdef OPENIFEM_WITH_ASCENT
+      ,
+      opened(false)
+#endif
+  {
+  }
+
+  InSituOutput::~InSituOutput()
+  {
+#ifdef OPENIFEM_WITH_ASCENT
+    if (opened)
+      {
+        ascent.close();
+      }
+#endif
+  }
+
+  template <int dim>
+  void InSituOutput::publish(const DataOut<dim> &data_out,
+                             const unsigned int output_index,
+                             const double time)
+  {
+#ifdef OPENIFEM_WITH_ASCENT
+    if (!opened)
+      {
+        if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+          {
+            std::experimental::filesystem::create_directories(directory);
+          }
+        int ierr = MPI_Barrier(mpi_communicator);
+        AssertThrowMPI(ierr);
+        conduit::Node options;
+        options["mpi_comm"] = MPI_Comm_c2f(mpi_communicator);
+        options["actions_file"] = actions_file;
+        options["default_dir"] = directory;
+        ascent.open(options);
+        opened = true;
+      }
+
+    // The cells of the merged patches are quadrilaterals or hexahedra with
+    // the vertices in the same order as in VTK and Blueprint.
+    data_filter =
+      DataOutBase::DataOutFilter(DataOutBase::DataOutFilterFlags(true, true));
+    data_out.write_filtered_data(data_filter);
+    data_filter.fill_node_data(node_data);
+    data_filter.fill_cell_data(0, cell_data);
+    const unsigned int n_nodes = data_filter.n_nodes();
+    const char *axes[] = {"x", "y", "z"};
+
+    conduit::Node mesh;
+    mesh["state/cycle"] = output_index;
+    mesh["state/time"] = time;
+    mesh["state/domain_id"] =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    mesh["coordsets/coords/type"] = "explicit";
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        mesh["coordsets/coords/values"][axes[d]].set_external(
+          node_data.data(),
+          n_nodes,
+          d * sizeof(double),
+          dim * sizeof(double));
+      }
+    mesh["topologies/mesh/type"] = "unstructured";
+    mesh["topologies/mesh/coordset"] = "coords";
+    mesh["topologies/mesh/elements/shape"] = (dim == 2 ? "quad" : "hex");
+    mesh["topologies/mesh/elements/connectivity"].set_external(
+      cell_data.data(), cell_data.size());
+    // The components of a data set are interleaved, and vectors have three
+    // of them in 2D as well.
+    for (unsigned int i = 0; i < data_filter.n_data_sets(); ++i)
+      {
+        conduit::Node &field =
+          mesh["fields"][data_filter.get_data_set_name(i)];
+        field["association"] = "vertex";
+        field["topology"] = "mesh";
+        const unsigned int n_components = data_filter.get_data_set_dim(i);
+        double *values = const_cast<double *>(data_filter.get_data_set(i));
+        if (n_components == 1)
+          {
+            field["values"].set_external(values, n_nodes);
+            continue;
+          }
+        for (unsigned int c = 0; c < n_components; ++c)
+          {
+            field["values"][axes[c]].set_external(values,
+                                                 n_nodes,
+                                                 c * sizeof(double),
+                                                 n_components *
+                                                   sizeof(double));
+          }
+      }
+
+    ascent.publish(mesh);
+    // The actions come from the actions file.
+    conduit::Node actions;
+    ascent.execute(actions);
+#else
+    (void)data_out;
+    (void)output_index;
+    (void)time;
+    AssertThrow(false,
+                ExcMessage("The ascent output format requires OpenIFEM to be "
+                           "configured with OPENIFEM_WITH_ascent!"));
+#endif
+  }
+
+  AsyncWriter::AsyncWriter(const bool async) : asynchronous(async), stop(false)
+  {
+  }
+
+  AsyncWriter::~AsyncWriter()
+  {
+    if (thread.joinable())
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          stop = true;
+        }
+        condition.notify_all();
+        thread.join();
+      }
+  }
+
+  void AsyncWriter::write(
+    const std::string &filename,
+    const std::function<void(std::ostream &)> &format)
+  {
+    if (!asynchronous)
+      {
+        std::ofstream file(filename);
+        format(file);
+        AssertThrow(file, ExcMessage("Failed to write " + filename + "!"));
+        return;
+      }
+    check_error();
+    std::ostringstream contents;
+    format(contents);
+    // The thread is only started with the first file.
+    if (!thread.joinable())
+      {
+        thread = std::thread(&AsyncWriter::run, this);
+      }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.emplace_back(filename, contents.str());
+    }
+    condition.notify_all();
+  }
+
+  void AsyncWriter::wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this] { return queue.empty(); });
+    lock.unlock();
+    check_error();
+  }
+
+  void AsyncWriter::run()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+      {
+        condition.wait(lock, [this] { return stop || !queue.empty(); });
+        if (queue.empty())
+          {
+            return;
+          }
+        // The file stays in the queue until it is written, so that wait
+        // does not return before.
+        const auto &file = queue.front();
+        lock.unlock();
+        std::ofstream output(file.first);
+        output << file.second;
+        const bool success = static_cast<bool>(output);
+        output.close();
+        lock.lock();
+        if (!success && error.empty())
+          {
+            error = "Failed to write " + file.first + "!";
+          }
+        queue.pop_front();
+        condition.notify_all();
+      }
+  }
+
+  void AsyncWriter::check_error()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    AssertThrow(error.empty(), ExcMessage(error));
+  }
+
+  template void select_output_cells(DataOut<2> &, const std::vector<double> &);
+  template void select_output_cells(DataOut<3> &, const std::vector<double> &);
+  template void select_output_cells(DataOut<2, DoFHandler<2, 3>> &,
+                                    const std::vector<double> &);
+  template void InSituOutput::publish(const DataOut<2> &,
+                                      const unsigned int,
+                                      const double);
+  template void InSituOutput::publish(const DataOut<3> &,
+                                      const unsigned int,
+                                      const double);
+  template void HDF5Output::write(const DataOut<2> &,
+                                  const unsigned int,
+                                  const double);
+  template void HDF5Output::write(const DataOut<3> &,
+                                  const unsigned int,
+                                  const double);
+} // namespace Utils
@@ -1,5 +1,8 @@
 #include "parameters.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace Parameters
 {
   using namespace dealii;
@@ -23,6 +26,47 @@ namespace Parameters
         "Time step size", "1.0", Patterns::Double(0.0), "Time step size");
       prm.declare_entry(
         "Output interval", "1.0", Patterns::Double(0.0), "Output interval");
+      prm.declare_entry("Output format",
+                        "vtu",
+                        Patterns::Selection("vtu|hdf5|ascent"),
+                        "One vtu file per process per output, one HDF5 "
+                        "file per output indexed by an XDMF file, or the "
+                        "in-situ pipelines of Ascent without any files");
+      prm.declare_entry("In-situ actions",
+                        "ascent_actions.yaml",
+                        Patterns::FileName(),
+                        "The Ascent actions file that describes the in-situ "
+                        "pipelines, scenes and extracts");
+      prm.declare_entry("Output fields",
+                        "all",
+                        Patterns::List(Patterns::Anything()),
+                        "Fields of the MPI solvers to write, all of them by "
+                        "default");
+      prm.declare_entry("Output subdivisions",
+                        "0",
+                        Patterns::Integer(0),
+                        "Subdivisions of the cells in the output, 0 for the "
+                        "default of the solver");
+      prm.declare_entry("Output region",
+                        "",
+                        Patterns::List(Patterns::Double()),
+                        "Lower and upper corners of the box of the cells to "
+                        "write, all cells if empty");
+      prm.declare_entry(
+        "Output compression",
+        "default",
+        Patterns::Selection("default|best_speed|best_compression|none"),
+        "Compression level of the vtu files");
+      prm.declare_entry("Asynchronous output",
+                        "false",
+                        Patterns::Bool(),
+                        "Write the output and checkpoint files of the MPI "
+                        "solvers on a background thread");
+      prm.declare_entry("Checkpoint format",
+                        "separate",
+                        Patterns::Selection("separate|coupled"),
+                        "Separate checkpoints of the solvers, or one coupled "
+                        "checkpoint of the MPI FSI");
       prm.declare_entry("Refinement interval",
                         "1.0",
                         Patterns::Double(0.0),
@@ -34,6 +78,70 @@ namespace Parameters
         "",
         Patterns::List(dealii::Patterns::Double()),
         "Gravity acceleration that applies to both fluid and solid");
+      prm.declare_entry("Adaptive time stepping",
+                        "false",
+                        Patterns::Bool(),
+                        "Adapt the time step size, starting from Time step "
+                        "size");
+      prm.declare_entry("Minimum time step size",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Minimum adaptive time step size");
+      prm.declare_entry("Maximum time step size",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Maximum adaptive time step size, 0 for Time step "
+                        "size");
+      prm.declare_entry("Maximum time step growth",
+                        "1.2",
+                        Patterns::Double(1.0),
+                        "Maximum ratio of two adaptive time step sizes");
+      prm.declare_entry("Target CFL number",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Fluid CFL number to adapt the time step to, 0 to "
+                        "ignore");
+      prm.declare_entry("Target Newton iterations",
+                        "0",
+                        Patterns::Integer(0),
+                        "Fluid Newton iterations per time step to adapt the "
+                        "time step to, 0 to ignore");
+      prm.declare_entry("Target linear iterations",
+                        "0",
+                        Patterns::Integer(0),
+                        "Fluid linear solver iterations to adapt the time "
+                        "step to, 0 to ignore");
+      prm.declare_entry("Solid Courant number",
+                        "0",
+                        Patterns::Double(0.0),
+                        "Courant number of the elastic waves that limits the "
+                        "solid time step, 0 to ignore");
+      prm.declare_entry("Performance steps",
+                        "0",
+                        Patterns::Integer(0),
+                        "Run this many time steps of Time step size instead "
+                        "of up to End time, 0 to ignore");
+      prm.declare_entry("Performance summary",
+                        "",
+                        Patterns::Anything(),
+                        "JSON lines file to append the timer sections and "
+                        "the Krylov iterations of the MPI solvers to");
+      prm.declare_entry("Telemetry prefix",
+                        "",
+                        Patterns::Anything(),
+                        "Prefix of the per time step CSV logs of the MPI "
+                        "solvers, empty to disable");
+      prm.declare_entry("Memory report",
+                        "false",
+                        Patterns::Bool(),
+                        "Print the memory of the subsystems of the MPI "
+                        "solvers after every setup of their systems");
+      prm.declare_entry(
+        "DoF renumbering",
+        "default",
+        Patterns::Selection("default|cuthill_mckee|hierarchical|none"),
+        "Locality ordering of the dofs within the blocks and subdomains of "
+        "all solvers");
     }
     prm.leave_subsection();
   }
@@ -53,6 +161,18 @@ namespace Parameters
       end_time = prm.get_double("End time");
       time_step = prm.get_double("Time step size");
       output_interval = prm.get_double("Output interval");
+      output_format = prm.get("Output format");
+      insitu_actions = prm.get("In-situ actions");
+      async_output = prm.get_bool("Asynchronous output");
+      output_fields = Utilities::split_string_list(prm.get("Output fields"));
+      output_subdivisions = prm.get_integer("Output subdivisions");
+      output_region = Utilities::string_to_double(
+        Utilities::split_string_list(prm.get("Output region")));
+      AssertThrow(output_region.empty() ||
+                    static_cast<int>(output_region.size()) == 2 * dimension,
+                  ExcMessage("Incorrect dimension of output region!"));
+      output_compression = prm.get("Output compression");
+      checkpoint_format = prm.get("Checkpoint format");
       refinement_interval = prm.get_double("Refinement interval");
       save_interval = prm.get_double("Save interval");
       raw_input = prm.get("Gravity");
@@ -60,10 +180,42 @@ namespace Parameters
       gravity = Utilities::string_to_double(parsed_input);
       AssertThrow(static_cast<int>(gravity.size()) == dimension,
                   ExcMessage("Inconsistent dimension of gravity!"));
+      adaptive_time_stepping = prm.get_bool("Adaptive time stepping");
+      min_time_step = prm.get_double("Minimum time step size");
+      max_time_step = prm.get_double("Maximum time step size");
+      if (max_time_step == 0)
+        {
+          max_time_step = time_step;
+        }
+      AssertThrow(min_time_step <= max_time_step,
+                  ExcMessage("Inconsistent bounds of the time step size!"));
+      max_time_step_growth = prm.get_double("Maximum time step growth");
+      target_cfl = prm.get_double("Target CFL number");
+      target_newton_iterations = prm.get_integer("Target Newton iterations");
+      target_linear_iterations = prm.get_integer("Target linear iterations");
+      solid_courant = prm.get_double("Solid Courant number");
+      const unsigned int performance_steps =
+        prm.get_integer("Performance steps");
+      if (performance_steps > 0)
+        {
+          end_time = performance_steps * time_step;
+        }
+      performance_summary = prm.get("Performance summary");
+      telemetry_prefix = prm.get("Telemetry prefix");
+      memory_report = prm.get_bool("Memory report");
+      dof_renumbering = prm.get("DoF renumbering");
     }
     prm.leave_subsection();
   }
 
+  bool Simulation::output_field(const std::string &name) const
+  {
+    return std::find(output_fields.begin(), output_fields.end(), "all") !=
+             output_fields.end() ||
+           std::find(output_fields.begin(), output_fields.end(), name) !=
+             output_fields.end();
+  }
+
   void FluidFESystem::declareParameters(ParameterHandler &prm)
   {
     prm.enter_subsection("Fluid finite element system");
@@ -76,6 +228,11 @@ namespace Parameters
                         "2",
                         Patterns::Integer(1),
                         "Velocity element polynomial order");
+      prm.declare_entry("Equal-order stabilization",
+                        "false",
+                        Patterns::Bool(),
+                        "Stabilize equal velocity and pressure degrees with "
+                        "PSPG and SUPG (MPI InsIM, PSPG only in MPI InsIMEX)");
     }
     prm.leave_subsection();
   }
@@ -86,6 +243,7 @@ namespace Parameters
     {
       fluid_pressure_degree = prm.get_integer("Pressure degree");
       fluid_velocity_degree = prm.get_integer("Velocity degree");
+      fluid_stabilization = prm.get_bool("Equal-order stabilization");
     }
     prm.leave_subsection();
   }
@@ -131,6 +289,139 @@ namespace Parameters
         "1e-10",
         Patterns::Double(0.0),
         "The absolute tolerance of the nonlinear system residual");
+      prm.declare_entry("Matrix-free velocity block",
+                        "false",
+                        Patterns::Bool(),
+                        "Solve the velocity block in the preconditioner with "
+                        "a matrix-free operator");
+      prm.declare_entry("Stale factor iterations",
+                        "0",
+                        Patterns::Integer(0),
+                        "Reuse the factorization of the velocity block as "
+                        "long as GMRES takes fewer iterations than this, 0 "
+                        "to refactorize after every assembly (InsIM and "
+                        "MPI InsIM)");
+      prm.declare_entry("Preconditioner rebuild iterations",
+                        "0",
+                        Patterns::Integer(0),
+                        "Reuse the incomplete Schur preconditioner until "
+                        "GMRES takes this number of iterations, 0 to "
+                        "rebuild it at every solve");
+      prm.declare_entry("Preconditioner rebuild Tpp iterations",
+                        "0",
+                        Patterns::Integer(0),
+                        "Reuse the incomplete Schur preconditioner until "
+                        "the inner Tpp solves of a GMRES solve take this "
+                        "number of iterations in total, 0 to ignore");
+      prm.declare_entry("Threads per process",
+                        "0",
+                        Patterns::Integer(0),
+                        "The number of threads that the MPI fluid solvers "
+                        "assemble with, 0 to keep the default");
+      prm.declare_entry("Recycled Krylov vectors",
+                        "0",
+                        Patterns::Integer(0),
+                        "The number of directions that the outer Krylov "
+                        "solver of the MPI fluid solvers keeps between "
+                        "solves, 0 to use FGMRES");
+      prm.declare_entry("Extrapolation order",
+                        "0",
+                        Patterns::Integer(0, 2),
+                        "The order of the polynomial in time that the MPI "
+                        "fluid solvers extrapolate the initial guess of "
+                        "Newton's method with, 0 to start from the last "
+                        "solution");
+      prm.declare_entry("Mixed precision inner solves",
+                        "false",
+                        Patterns::Bool(),
+                        "Solve the pressure mass and Schur complement "
+                        "systems inside the MPI block Schur preconditioners "
+                        "in single precision");
+      prm.declare_entry("Linear algebra backend",
+                        "cpu",
+                        Patterns::Selection("cpu|cuda|kokkos"),
+                        "The PETSc backend that the inner CG solves of the "
+                        "MPI InsIMEX preconditioner run on");
+      prm.declare_entry("Time integration",
+                        "implicit",
+                        Patterns::Selection("implicit|explicit"),
+                        "Backward Euler with Newton's method, or a "
+                        "low-storage explicit Runge-Kutta method with a "
+                        "lumped mass matrix (MPI SCnsIM only)");
+      prm.declare_entry("Block solver",
+                        "dealii",
+                        Patterns::Selection("dealii|fieldsplit"),
+                        "The deal.II FGMRES with the block preconditioners, "
+                        "or PETSc FGMRES with PCFIELDSPLIT (MPI InsIM, "
+                        "InsIMEX and SCnsIM)");
+      const std::string preconditioners =
+        "default|amg|gamg|pilut|euclid|jacobi|sor|chebyshev|none";
+      prm.declare_entry("Velocity preconditioner",
+                        "default",
+                        Patterns::Selection(preconditioners),
+                        "The preconditioner of the velocity block (MPI "
+                        "InsIMEX and InsProjection CG and SCnsIM Pvv)");
+      prm.declare_entry("Pressure mass preconditioner",
+                        "default",
+                        Patterns::Selection(preconditioners),
+                        "The preconditioner of the pressure mass CG (MPI "
+                        "InsIM, InsIMEX and InsProjection)");
+      prm.declare_entry("Schur preconditioner",
+                        "default",
+                        Patterns::Selection(preconditioners),
+                        "The preconditioner of the Schur complement "
+                        "(MPI InsIM and InsIMEX Sm CG, InsProjection "
+                        "pressure Poisson CG, SCnsIM B2pp)");
+      prm.declare_entry("Velocity inner tolerance",
+                        "1e-4",
+                        Patterns::Double(0.0, 1.0),
+                        "The relative tolerance of the inner velocity solve "
+                        "(MPI InsIMEX)");
+      prm.declare_entry("Pressure mass inner tolerance",
+                        "1e-6",
+                        Patterns::Double(0.0, 1.0),
+                        "The relative tolerance of the inner pressure mass "
+                        "solve (MPI InsIM and InsIMEX)");
+      prm.declare_entry("Schur inner tolerance",
+                        "1e-3",
+                        Patterns::Double(0.0, 1.0),
+                        "The relative tolerance of the inner Schur "
+                        "complement solve (MPI InsIM, InsIMEX and SCnsIM)");
+      prm.declare_entry("Schur approximation",
+                        "mass",
+                        Patterns::Selection("mass|pcd"),
+                        "The approximation of the Schur complement inverse "
+                        "of the MPI InsIM block preconditioner: the pressure "
+                        "mass and Sm terms, or the pressure "
+                        "convection-diffusion one");
+      prm.declare_entry("Inner Krylov method",
+                        "cg",
+                        Patterns::Selection("cg|pipecg|groppcg|pipecr"),
+                        "The PETSc CG variant of the inner solves (MPI InsIM, "
+                        "InsIMEX and InsProjection)");
+      prm.declare_entry("Inexact Newton",
+                        "false",
+                        Patterns::Bool(),
+                        "Solve the Newton systems to the Eisenstat-Walker "
+                        "tolerances rather than a fixed one (MPI InsIM and "
+                        "SCnsIM)");
+      prm.declare_entry("Maximum forcing term",
+                        "0.1",
+                        Patterns::Double(0.0, 1.0),
+                        "The largest relative tolerance of a Newton system "
+                        "with the inexact Newton method");
+      prm.declare_entry("Line search steps",
+                        "0",
+                        Patterns::Integer(0),
+                        "The number of times that the backtracking line "
+                        "search may halve a Newton step, 0 to take the "
+                        "full steps (MPI InsIM and SCnsIM)");
+      prm.declare_entry("Geometry cache memory",
+                        "0",
+                        Patterns::Double(0.0),
+                        "The largest memory in MB per process of the cell "
+                        "geometry cache of the MPI fluid assembly, 0 to "
+                        "disable it");
     }
     prm.leave_subsection();
   }
@@ -142,6 +433,32 @@ namespace Parameters
       grad_div = prm.get_double("Grad-Div stabilization");
       fluid_max_iterations = prm.get_integer("Max Newton iterations");
       fluid_tolerance = prm.get_double("Nonlinear system tolerance");
+      fluid_matrix_free = prm.get_bool("Matrix-free velocity block");
+      fluid_stale_factor_iterations =
+        prm.get_integer("Stale factor iterations");
+      fluid_rebuild_iterations =
+        prm.get_integer("Preconditioner rebuild iterations");
+      fluid_rebuild_tpp_iterations =
+        prm.get_integer("Preconditioner rebuild Tpp iterations");
+      fluid_n_threads = prm.get_integer("Threads per process");
+      fluid_recycled_vectors = prm.get_integer("Recycled Krylov vectors");
+      fluid_extrapolation_order = prm.get_integer("Extrapolation order");
+      fluid_mixed_precision = prm.get_bool("Mixed precision inner solves");
+      fluid_backend = prm.get("Linear algebra backend");
+      fluid_time_integration = prm.get("Time integration");
+      fluid_block_solver = prm.get("Block solver");
+      fluid_velocity_preconditioner = prm.get("Velocity preconditioner");
+      fluid_mass_preconditioner = prm.get("Pressure mass preconditioner");
+      fluid_schur_preconditioner = prm.get("Schur preconditioner");
+      fluid_velocity_tolerance = prm.get_double("Velocity inner tolerance");
+      fluid_mass_tolerance = prm.get_double("Pressure mass inner tolerance");
+      fluid_schur_tolerance = prm.get_double("Schur inner tolerance");
+      fluid_schur_approximation = prm.get("Schur approximation");
+      fluid_inner_krylov = prm.get("Inner Krylov method");
+      fluid_inexact_newton = prm.get_bool("Inexact Newton");
+      fluid_max_forcing = prm.get_double("Maximum forcing term");
+      fluid_line_search_steps = prm.get_integer("Line search steps");
+      fluid_geometry_cache_memory = prm.get_double("Geometry cache memory");
     }
     prm.leave_subsection();
   }
@@ -386,6 +703,23 @@ namespace Parameters
     prm.leave_subsection();
   }
 
+  double SolidMaterial::wave_speed(const unsigned int part) const
+  {
+    // The P-wave modulus is lambda + 2 mu for the linear elastic material,
+    // and kappa + 4/3 mu with mu = 2 C1 for the Neo-Hookean material.
+    double modulus = 0;
+    if (solid_type == "LinearElastic")
+      {
+        modulus = E[part] * (1 - nu[part]) /
+                  ((1 + nu[part]) * (1 - 2 * nu[part]));
+      }
+    else if (solid_type == "NeoHookean")
+      {
+        modulus = C[part][1] + 8.0 / 3.0 * C[part][0];
+      }
+    return std::sqrt(modulus / solid_rho);
+  }
+
   void SolidSolver::declareParameters(ParameterHandler &prm)
   {
     prm.enter_subsection("Solid solver control");
@@ -407,6 +741,62 @@ namespace Parameters
                         "1e-10",
                         Patterns::Double(0.0),
                         "The tolerance of the force equilibrium");
+      prm.declare_entry(
+        "Preconditioner",
+        "default",
+        Patterns::Selection(
+          "default|amg|pilut|euclid|jacobi|sor|chebyshev|none"),
+        "The preconditioner of the CG solver of the solid solvers");
+      prm.declare_entry("Linear solver tolerance",
+                        "0",
+                        Patterns::Double(0.0, 1.0),
+                        "The relative tolerance of the CG solver, 0 for the "
+                        "default of the solver");
+      prm.declare_entry("Krylov method",
+                        "cg",
+                        Patterns::Selection("cg|pipecg|groppcg|pipecr"),
+                        "The PETSc CG variant of the MPI solid solvers");
+      prm.declare_entry("Inexact Newton",
+                        "false",
+                        Patterns::Bool(),
+                        "Solve the Newton systems to the Eisenstat-Walker "
+                        "tolerances rather than a fixed one, hyperelastic "
+                        "only");
+      prm.declare_entry("Maximum forcing term",
+                        "0.1",
+                        Patterns::Double(0.0, 1.0),
+                        "The largest relative tolerance of a Newton system "
+                        "with the inexact Newton method");
+      prm.declare_entry("Cached factorization",
+                        "false",
+                        Patterns::Bool(),
+                        "Solve the linear elastic system with a direct "
+                        "factorization that is kept between the time steps");
+      prm.declare_entry("Tangent reuse iterations",
+                        "0",
+                        Patterns::Integer(0),
+                        "Number of Newton iterations that reuse the last "
+                        "assembled tangent, 0 for the full Newton method");
+      prm.declare_entry("Time integrator",
+                        "implicit",
+                        Patterns::Selection("implicit|explicit"),
+                        "Newmark or central difference time integration");
+      prm.declare_entry("Matrix-free stiffness",
+                        "false",
+                        Patterns::Bool(),
+                        "Apply the linear elastic stiffness and damping in "
+                        "the rhs cell by cell instead of storing them");
+      prm.declare_entry("Matrix-free tangent",
+                        "false",
+                        Patterns::Bool(),
+                        "Apply the hyperelastic tangent with sum "
+                        "factorization instead of assembling it (MPI "
+                        "HyperElasticity only)");
+      prm.declare_entry("Chebyshev degree",
+                        "4",
+                        Patterns::Integer(1),
+                        "The degree of the Chebyshev preconditioner of the "
+                        "matrix-free tangent");
     }
     prm.leave_subsection();
   }
@@ -419,6 +809,17 @@ namespace Parameters
       solid_max_iterations = prm.get_integer("Max Newton iterations");
       tol_d = prm.get_double("Displacement tolerance");
       tol_f = prm.get_double("Force tolerance");
+      solid_preconditioner = prm.get("Preconditioner");
+      solid_linear_tolerance = prm.get_double("Linear solver tolerance");
+      solid_krylov = prm.get("Krylov method");
+      solid_inexact_newton = prm.get_bool("Inexact Newton");
+      solid_max_forcing = prm.get_double("Maximum forcing term");
+      solid_cached_factorization = prm.get_bool("Cached factorization");
+      solid_tangent_reuse = prm.get_integer("Tangent reuse iterations");
+      solid_integrator = prm.get("Time integrator");
+      solid_matrix_free = prm.get_bool("Matrix-free stiffness");
+      solid_matrix_free_tangent = prm.get_bool("Matrix-free tangent");
+      solid_chebyshev_degree = prm.get_integer("Chebyshev degree");
     }
     prm.leave_subsection();
   }
@@ -526,11 +927,309 @@ namespace Parameters
     prm.leave_subsection();
   }
 
-  AllParameters::AllParameters(const std::string &infile)
+  void FSIControl::declareParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("FSI control");
+    {
+      prm.declare_entry("Incremental indicator",
+                        "true",
+                        Patterns::Bool(),
+                        "Only update the indicator of the fluid cells that "
+                        "the solid boundary has swept over");
+      prm.declare_entry("Solid processes",
+                        "0",
+                        Patterns::Integer(0),
+                        "Number of processes that run the solid solver "
+                        "concurrently with the fluid solver, 0 to run both "
+                        "solvers on all of the processes");
+      prm.declare_entry("Solid substeps",
+                        "1",
+                        Patterns::Integer(1),
+                        "Number of solid time steps in one coupling time "
+                        "step");
+      prm.declare_entry("Fluid substeps",
+                        "1",
+                        Patterns::Integer(1),
+                        "Number of fluid time steps in one coupling time "
+                        "step");
+      prm.declare_entry("Coupling profile",
+                        "",
+                        Patterns::Anything(),
+                        "CSV file to write the per-step, per-process timings "
+                        "and counters of the coupling to");
+      prm.declare_entry("Load imbalance threshold",
+                        "0",
+                        Patterns::Double(0),
+                        "Repartition the fluid with cost weights on the "
+                        "cells near the solid when the slowest process "
+                        "takes this many times the average time, 0 to "
+                        "disable");
+      prm.declare_entry("Node shared solid state",
+                        "false",
+                        Patterns::Bool(),
+                        "Keep one localized copy of the solid state per "
+                        "node in MPI-3 shared memory");
+      prm.declare_entry("Eulerian solid mapping",
+                        "false",
+                        Patterns::Bool(),
+                        "Represent the deformed solid with an Eulerian "
+                        "mapping instead of moving the solid mesh");
+      prm.declare_entry("Coupling iterations",
+                        "1",
+                        Patterns::Integer(1),
+                        "Most iterations of the implicit coupling in a "
+                        "time step, 1 for the staggered coupling");
+      prm.declare_entry("Coupling tolerance",
+                        "1e-4",
+                        Patterns::Double(0),
+                        "Relative residual of the interface stress at which "
+                        "the coupling iterations stop");
+      prm.declare_entry("Coupling acceleration",
+                        "aitken",
+                        Patterns::Selection("aitken|iqn-ils"),
+                        "Acceleration of the coupling iterations, Aitken "
+                        "relaxation or interface quasi-Newton");
+      prm.declare_entry("Initial relaxation",
+                        "0.5",
+                        Patterns::Double(0, 1),
+                        "Relaxation of the first coupling iteration of a "
+                        "time step");
+      prm.declare_entry("Refinement distance",
+                        "1",
+                        Patterns::Double(0),
+                        "Distance to the solid boundary, in cell diameters, "
+                        "within which the fluid cells are refined");
+      prm.declare_entry("Coarsening distance",
+                        "2",
+                        Patterns::Double(0),
+                        "Distance to the solid boundary, in cell diameters, "
+                        "beyond which the fluid cells are coarsened");
+    }
+    prm.leave_subsection();
+  }
+
+  void FSIControl::parseParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("FSI control");
+    {
+      incremental_indicator = prm.get_bool("Incremental indicator");
+      n_solid_processes = prm.get_integer("Solid processes");
+      solid_substeps = prm.get_integer("Solid substeps");
+      fluid_substeps = prm.get_integer("Fluid substeps");
+      coupling_profile = prm.get("Coupling profile");
+      load_imbalance_threshold = prm.get_double("Load imbalance threshold");
+      node_shared_solid_state = prm.get_bool("Node shared solid state");
+      eulerian_solid_mapping = prm.get_bool("Eulerian solid mapping");
+      coupling_iterations = prm.get_integer("Coupling iterations");
+      coupling_tolerance = prm.get_double("Coupling tolerance");
+      coupling_acceleration = prm.get("Coupling acceleration");
+      coupling_relaxation = prm.get_double("Initial relaxation");
+      refinement_distance = prm.get_double("Refinement distance");
+      coarsening_distance = prm.get_double("Coarsening distance");
+      AssertThrow(coarsening_distance >= refinement_distance,
+                  ExcMessage("The coarsening distance must not be smaller "
+                             "than the refinement distance!"));
+    }
+    prm.leave_subsection();
+  }
+
+  void Monitors::declareParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("Monitors");
+    {
+      prm.declare_entry("Monitor file",
+                        "",
+                        Patterns::Anything(),
+                        "CSV file of the monitored quantities of every time "
+                        "step, empty to disable the monitors");
+      prm.declare_entry("Probe points",
+                        "",
+                        Patterns::Anything(),
+                        "Points to sample the velocity and the pressure at, "
+                        "separated by semicolons");
+      prm.declare_entry("Sample lines",
+                        "",
+                        Patterns::Anything(),
+                        "Lines to sample at evenly spaced points, given by "
+                        "the start point, the end point and the number of "
+                        "points, separated by semicolons");
+      prm.declare_entry("Sample planes",
+                        "",
+                        Patterns::Anything(),
+                        "Parallelograms to sample on a grid of points, given "
+                        "by the origin, the corners next to it and the "
+                        "numbers of points along the two edges, separated by "
+                        "semicolons");
+      prm.declare_entry("Force boundaries",
+                        "",
+                        Patterns::List(Patterns::Integer(0)),
+                        "Ids of the boundaries to integrate the fluid force "
+                        "on");
+    }
+    prm.leave_subsection();
+  }
+
+  void Monitors::parseParameters(ParameterHandler &prm)
+  {
+    // Split an entry into its semicolon separated items, each of which is a
+    // comma separated list of the given number of numbers.
+    auto parse_items = [](const std::string &raw,
+                          const unsigned int n_numbers,
+                          const std::string &name) {
+      std::vector<std::vector<double>> items;
+      for (const auto &item : Utilities::split_string_list(raw, ';'))
+        {
+          items.push_back(
+            Utilities::string_to_double(Utilities::split_string_list(item)));
+          AssertThrow(items.back().size() == n_numbers,
+                      ExcMessage("Each of the " + name + " must have " +
+                                 std::to_string(n_numbers) + " numbers!"));
+        }
+      return items;
+    };
+    const unsigned int dim = monitor_dim;
+    auto point = [dim](const std::vector<double> &numbers,
+                       const unsigned int first) {
+      Point<3> p;
+      for (unsigned int d = 0; d < dim; ++d)
+        {
+          p[d] = numbers[first + d];
+        }
+      return p;
+    };
+    prm.enter_subsection("Monitors");
+    {
+      monitor_file = prm.get("Monitor file");
+      probe_points.clear();
+      for (const auto &numbers :
+           parse_items(prm.get("Probe points"), dim, "probe points"))
+        {
+          probe_points.push_back(point(numbers, 0));
+        }
+      sample_lines.clear();
+      for (const auto &numbers :
+           parse_items(prm.get("Sample lines"), 2 * dim + 1, "sample lines"))
+        {
+          AssertThrow(numbers[2 * dim] >= 2,
+                      ExcMessage("A sample line needs at least 2 points!"));
+          sample_lines.push_back(
+            {{{point(numbers, 0), point(numbers, dim)}},
+             static_cast<unsigned int>(numbers[2 * dim])});
+        }
+      sample_planes.clear();
+      for (const auto &numbers : parse_items(
+             prm.get("Sample planes"), 3 * dim + 2, "sample planes"))
+        {
+          AssertThrow(numbers[3 * dim] >= 2 && numbers[3 * dim + 1] >= 2,
+                      ExcMessage("A sample plane needs at least 2 points "
+                                 "along each edge!"));
+          const std::array<Point<3>, 3> corners = {
+            {point(numbers, 0), point(numbers, dim), point(numbers, 2 * dim)}};
+          sample_planes.push_back(
+            {corners,
+             {{static_cast<unsigned int>(numbers[3 * dim]),
+               static_cast<unsigned int>(numbers[3 * dim + 1])}}});
+        }
+      std::vector<int> ids = Utilities::string_to_int(
+        Utilities::split_string_list(prm.get("Force boundaries")));
+      force_boundaries.assign(ids.begin(), ids.end());
+    }
+    prm.leave_subsection();
+  }
+
+  void EnsembleControl::declareParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("Ensemble");
+    {
+      prm.declare_entry("Ensemble groups",
+                        "1",
+                        Patterns::Integer(1),
+                        "Number of groups of processes that run the variants "
+                        "concurrently");
+      prm.declare_entry("Ensemble variants",
+                        "",
+                        Patterns::Anything(),
+                        "Variants of the parameters separated by semicolons, "
+                        "each given by the entries it overrides as "
+                        "Subsection/Entry = value separated by |");
+    }
+    prm.leave_subsection();
+  }
+
+  void EnsembleControl::parseParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("Ensemble");
+    {
+      ensemble_groups = prm.get_integer("Ensemble groups");
+      ensemble_variants =
+        Utilities::split_string_list(prm.get("Ensemble variants"), ';');
+    }
+    prm.leave_subsection();
+  }
+
+  void PararealControl::declareParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("Parareal");
+    {
+      prm.declare_entry("Parareal groups",
+                        "1",
+                        Patterns::Integer(1),
+                        "Number of groups of processes that run the time "
+                        "slices concurrently");
+      prm.declare_entry("Slice steps",
+                        "10",
+                        Patterns::Integer(1),
+                        "Number of fine time steps of a time slice");
+      prm.declare_entry("Coarse step factor",
+                        "10",
+                        Patterns::Integer(1),
+                        "Ratio of the coarse and the fine time step sizes");
+      prm.declare_entry("Max iterations",
+                        "5",
+                        Patterns::Integer(1),
+                        "Maximum number of Parareal iterations of the slices "
+                        "run concurrently");
+      prm.declare_entry("Tolerance",
+                        "1e-6",
+                        Patterns::Double(0),
+                        "Relative change of the solutions at the starts of "
+                        "the slices that the iterations stop at");
+    }
+    prm.leave_subsection();
+  }
+
+  void PararealControl::parseParameters(ParameterHandler &prm)
+  {
+    prm.enter_subsection("Parareal");
+    {
+      parareal_groups = prm.get_integer("Parareal groups");
+      parareal_slice_steps = prm.get_integer("Slice steps");
+      parareal_coarse_factor = prm.get_integer("Coarse step factor");
+      parareal_max_iterations = prm.get_integer("Max iterations");
+      parareal_tolerance = prm.get_double("Tolerance");
+    }
+    prm.leave_subsection();
+  }
+
+  AllParameters::AllParameters(const std::string &infile,
+                               const std::string &overrides)
   {
     ParameterHandler prm;
     declareParameters(prm);
     prm.parse_input(infile);
+    for (const auto &item : Utilities::split_string_list(overrides, '|'))
+      {
+        const auto slash = item.find('/');
+        const auto equal = item.find('=');
+        AssertThrow(slash != std::string::npos &&
+                      equal != std::string::npos && slash < equal,
+                    ExcMessage("The override \"" + item +
+                               "\" is not Subsection/Entry = value!"));
+        prm.enter_subsection(Utilities::trim(item.substr(0, slash)));
+        prm.set(Utilities::trim(item.substr(slash + 1, equal - slash - 1)),
+                Utilities::trim(item.substr(equal + 1)));
+        prm.leave_subsection();
+      }
     parseParameters(prm);
   }
 
@@ -547,6 +1246,10 @@ namespace Parameters
     SolidSolver::declareParameters(prm);
     SolidDirichlet::declareParameters(prm);
     SolidNeumann::declareParameters(prm);
+    FSIControl::declareParameters(prm);
+    Monitors::declareParameters(prm);
+    EnsembleControl::declareParameters(prm);
+    PararealControl::declareParameters(prm);
   }
 
   void AllParameters::parseParameters(ParameterHandler &prm)
@@ -564,5 +1267,11 @@ namespace Parameters
     // Set the dummy member in Solid Neumann BCs subsection
     solid_neumann_bc_dim = dimension;
     SolidNeumann::parseParameters(prm);
+    FSIControl::parseParameters(prm);
+    // Set the dummy member in Monitors subsection
+    monitor_dim = dimension;
+    Monitors::parseParameters(prm);
+    EnsembleControl::parseParameters(prm);
+    PararealControl::parseParameters(prm);
   }
 } // namespace Parameters
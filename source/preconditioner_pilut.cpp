@@ -227,4 +227,271 @@ void PreconditionEuclid::initialize(const PETScWrappers::MatrixBase &matrix_)
   AssertThrow(ierr == 0, ExcPETScError(ierr));
 }
 
-/* ----------------- PreconditionEuclid ------------------------ */
+void PreconditionEuclid::keep_factorization()
+{
+  PetscErrorCode ierr = PCSetReusePreconditioner(pc, PETSC_TRUE);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+}
+
+/* ----------------- PreconditionMUMPS ------------------------ */
+
+bool PreconditionMUMPS::update(const PETScWrappers::MatrixBase &matrix_,
+                               const bool keep_stale)
+{
+  PetscObjectState state;
+  PetscErrorCode ierr =
+    PetscObjectStateGet(reinterpret_cast<PetscObject>(
+                          static_cast<Mat>(matrix_)),
+                        &state);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  if (pc != nullptr && (keep_stale || state == factorized_state))
+    {
+      // Otherwise PCApply would refactorize the modified matrix.
+      ierr = PCSetReusePreconditioner(pc, PETSC_TRUE);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      return false;
+    }
+
+  if (pc == nullptr)
+    {
+      matrix = static_cast<Mat>(matrix_);
+
+      ierr = PCCreate(matrix_.get_mpi_communicator(), &pc);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+      ierr = PCSetOperators(pc, matrix, matrix);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+      ierr = PCSetType(pc, const_cast<char *>(PCLU));
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+#if DEAL_II_PETSC_VERSION_LT(3, 9, 0)
+      ierr = PCFactorSetMatSolverPackage(pc, MATSOLVERMUMPS);
+#else
+      ierr = PCFactorSetMatSolverType(pc, MATSOLVERMUMPS);
+#endif
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+      ierr = PCSetFromOptions(pc);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+    }
+
+  // PETSc compares the state of the matrix with that of the last setup, and
+  // reuses the symbolic factorization if the nonzero pattern is unchanged.
+  ierr = PCSetReusePreconditioner(pc, PETSC_FALSE);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+  ierr = PCSetUp(pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+  factorized_state = state;
+  return true;
+}
+
+/* ----------------- PreconditionElasticAMG ------------------------ */
+
+bool PreconditionElasticAMG::update(
+  const PETScWrappers::MatrixBase &matrix_,
+  const std::vector<PETScWrappers::MPI::Vector> &modes,
+  const bool keep_hierarchy)
+{
+  PetscErrorCode ierr;
+  if (pc != nullptr && matrix != static_cast<Mat>(matrix_))
+    {
+      clear();
+    }
+
+  if (pc != nullptr && keep_hierarchy)
+    {
+      // Otherwise PCApply would redo the setup for the modified matrix.
+      ierr = PCSetReusePreconditioner(pc, PETSC_TRUE);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      return false;
+    }
+
+  if (pc == nullptr)
+    {
+      matrix = static_cast<Mat>(matrix_);
+
+      // MatNullSpaceCreate expects orthonormal vectors.
+      std::vector<PETScWrappers::MPI::Vector> basis(modes);
+      std::vector<Vec> vectors;
+      for (unsigned int i = 0; i < basis.size(); ++i)
+        {
+          for (unsigned int j = 0; j < i; ++j)
+            {
+              basis[i].add(-(basis[i] * basis[j]), basis[j]);
+            }
+          basis[i] /= basis[i].l2_norm();
+          vectors.push_back(basis[i]);
+        }
+      MatNullSpace near_nullspace;
+      ierr = MatNullSpaceCreate(matrix_.get_mpi_communicator(),
+                                PETSC_FALSE,
+                                vectors.size(),
+                                vectors.data(),
+                                &near_nullspace);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      ierr = MatSetNearNullSpace(matrix, near_nullspace);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      // The matrix keeps a reference to the nullspace.
+      ierr = MatNullSpaceDestroy(&near_nullspace);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+      ierr = PCCreate(matrix_.get_mpi_communicator(), &pc);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+      ierr = PCSetOperators(pc, matrix, matrix);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+      ierr = PCSetType(pc, const_cast<char *>(PCGAMG));
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+      ierr = PCGAMGSetType(pc, PCGAMGAGG);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+      ierr = PCSetFromOptions(pc);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+    }
+
+  ierr = PCSetReusePreconditioner(pc, PETSC_FALSE);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+  ierr = PCSetUp(pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+  return true;
+}
+
+/* ----------------- PreconditionSelector ------------------------ */
+
+std::string PreconditionSelector::names()
+{
+  return "amg|gamg|pilut|euclid|jacobi|sor|chebyshev|none";
+}
+
+void PreconditionSelector::initialize(const std::string &name,
+                                      const PETScWrappers::MatrixBase &matrix_,
+                                      const bool symmetric)
+{
+  clear();
+
+  matrix = static_cast<Mat>(matrix_);
+
+  PetscErrorCode ierr = PCCreate(matrix_.get_mpi_communicator(), &pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetOperators(pc, matrix, matrix);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  if (name == "amg" || name == "pilut" || name == "euclid")
+    {
+      ierr = PCSetType(pc, const_cast<char *>(PCHYPRE));
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      if (name == "amg")
+        {
+          ierr = PCHYPRESetType(pc, "boomeramg");
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+        }
+      else if (name == "pilut")
+        {
+          ierr = PCHYPRESetType(pc, "pilut");
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+        }
+      else
+        {
+          ierr = PCHYPRESetType_Euclid(pc);
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+        }
+    }
+  else if (name == "gamg")
+    {
+      ierr = PCSetType(pc, const_cast<char *>(PCGAMG));
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      ierr = PCGAMGSetType(pc, PCGAMGAGG);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+    }
+  else if (name == "jacobi")
+    {
+      ierr = PCSetType(pc, const_cast<char *>(PCJACOBI));
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+    }
+  else if (name == "sor")
+    {
+      ierr = PCSetType(pc, const_cast<char *>(PCSOR));
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      ierr = PCSORSetSymmetric(
+        pc, symmetric ? SOR_LOCAL_SYMMETRIC_SWEEP : SOR_LOCAL_FORWARD_SWEEP);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+    }
+  else if (name == "chebyshev")
+    {
+      // The inner solver runs a fixed number of iterations without a
+      // convergence test, so it is the same linear operator every time.
+      ierr = PCSetType(pc, const_cast<char *>(PCKSP));
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      KSP ksp;
+      ierr = PCKSPGetKSP(pc, &ksp);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      ierr = KSPSetOperators(ksp, matrix, matrix);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      ierr = KSPSetType(ksp, KSPCHEBYSHEV);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      ierr = KSPChebyshevEstEigSet(ksp, 0, 0.1, 0, 1.1);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      ierr = KSPSetNormType(ksp, KSP_NORM_NONE);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      ierr = KSPSetTolerances(ksp, 0, 0, PETSC_DEFAULT, 5);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      PC inner_pc;
+      ierr = KSPGetPC(ksp, &inner_pc);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      ierr = PCSetType(inner_pc, const_cast<char *>(PCJACOBI));
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+    }
+  else
+    {
+      AssertThrow(name == "none",
+                  ExcMessage("Unknown preconditioner " + name + "!"));
+      ierr = PCSetType(pc, const_cast<char *>(PCNONE));
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+    }
+
+  ierr = PCSetFromOptions(pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  ierr = PCSetUp(pc);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+  if (name == "gamg")
+    {
+      // The levels exist after the setup. Every level but the coarsest is
+      // smoothed by 2 Chebyshev iterations with Jacobi, which keep the
+      // V-cycle a fixed symmetric operator for CG.
+      PetscInt n_levels;
+      ierr = PCMGGetLevels(pc, &n_levels);
+      AssertThrow(ierr == 0, ExcPETScError(ierr));
+      for (PetscInt level = 1; level < n_levels; ++level)
+        {
+          KSP smoother;
+          ierr = PCMGGetSmoother(pc, level, &smoother);
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+          ierr = KSPSetType(smoother, KSPCHEBYSHEV);
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+          ierr = KSPChebyshevEstEigSet(smoother, 0, 0.1, 0, 1.1);
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+          ierr = KSPSetNormType(smoother, KSP_NORM_NONE);
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+          ierr = KSPSetTolerances(smoother, 0, 0, PETSC_DEFAULT, 2);
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+          PC smoother_pc;
+          ierr = KSPGetPC(smoother, &smoother_pc);
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+          ierr = PCSetType(smoother_pc, const_cast<char *>(PCJACOBI));
+          AssertThrow(ierr == 0, ExcPETScError(ierr));
+        }
+    }
+}
+
+void PreconditionSelector::keep_factorization()
+{
+  PetscErrorCode ierr = PCSetReusePreconditioner(pc, PETSC_TRUE);
+  AssertThrow(ierr == 0, ExcPETScError(ierr));
+}
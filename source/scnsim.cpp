@@ -612,11 +612,11 @@ namespace Fluid
     solution_increment -= present_solution;
     // Newton iteration converges, update time and solution
     present_solution = evaluation_point;
-    // Update stress for output
-    update_stress();
     // Output
     if (time.time_to_output())
       {
+        // The stress is only needed by the output.
+        update_stress();
         output_results(time.get_timestep());
       }
     if (parameters.simulation_type == "Fluid" && time.time_to_refine())
@@ -82,6 +82,26 @@ namespace Solid
 
   void ShellSolidSolver::construct_mesh()
   {
+    // The transfers to and from m_shell only go through this map.
+    vertex_dofs.assign(3 * triangulation.n_vertices(),
+                       numbers::invalid_dof_index);
+    vertex_scalar_dofs.assign(triangulation.n_vertices(),
+                              numbers::invalid_dof_index);
+    auto scalar_cell = scalar_dof_handler.begin_active();
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell, ++scalar_cell)
+      {
+        for (unsigned int v = 0; v < GeometryInfo<2>::vertices_per_cell; ++v)
+          {
+            const unsigned int index = cell->vertex_index(v);
+            for (unsigned int n : {0, 1, 2})
+              {
+                vertex_dofs[3 * index + n] = cell->vertex_dof_index(v, n);
+              }
+            vertex_scalar_dofs[index] = scalar_cell->vertex_dof_index(v, 0);
+          }
+      }
+
     m_mesh.allow_renumbering(false);
     // Add nodes
     auto vertices = this->triangulation.get_vertices();
@@ -139,50 +159,38 @@ namespace Solid
 
   void ShellSolidSolver::grab_solution()
   {
-    std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
     const std::vector<libMesh::Number> &solution(m_shell->get_solution());
     AssertThrow(solution.size() == current_displacement.size() * 5,
                 ExcMessage("Inconsistent solution size!"));
     // Copy the solutions
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
+    for (unsigned int v = 0; v < vertex_scalar_dofs.size(); ++v)
       {
-        for (unsigned int v = 0; v < GeometryInfo<2>::vertices_per_cell; ++v)
+        if (vertex_scalar_dofs[v] == numbers::invalid_dof_index)
           {
-            if (!vertex_touched[cell->vertex_index(v)])
-              {
-                vertex_touched[cell->vertex_index(v)] = true;
-                for (unsigned int n : {0, 1, 2})
-                  {
-                    current_displacement(cell->vertex_dof_index(v, n)) =
-                      solution[15 * cell->vertex_index(v) + n];
-                    current_drilling(cell->vertex_dof_index(v, n)) =
-                      solution[15 * cell->vertex_index(v) + 3 + n];
-                  }
-              }
+            continue;
+          }
+        for (unsigned int n : {0, 1, 2})
+          {
+            current_displacement(vertex_dofs[3 * v + n]) =
+              solution[15 * v + n];
+            current_drilling(vertex_dofs[3 * v + n]) = solution[15 * v + 3 + n];
           }
       }
   }
 
   void ShellSolidSolver::push_solution()
   {
-    std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
     std::vector<libMesh::Number> solution(current_displacement.size() * 2);
     // Copy the solutions
-    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
-         ++cell)
+    for (unsigned int v = 0; v < vertex_scalar_dofs.size(); ++v)
       {
-        for (unsigned int v = 0; v < GeometryInfo<2>::vertices_per_cell; ++v)
+        if (vertex_scalar_dofs[v] == numbers::invalid_dof_index)
           {
-            if (!vertex_touched[cell->vertex_index(v)])
-              {
-                vertex_touched[cell->vertex_index(v)] = true;
-                for (unsigned int n : {0, 1, 2})
-                  {
-                    solution[6 * cell->vertex_index(v) + n] =
-                      current_displacement(cell->vertex_dof_index(v, n));
-                  }
-              }
+            continue;
+          }
+        for (unsigned int n : {0, 1, 2})
+          {
+            solution[6 * v + n] = current_displacement(vertex_dofs[3 * v + n]);
           }
       }
     this->m_shell->set_solution(solution);
@@ -190,27 +198,21 @@ namespace Solid
 
   void ShellSolidSolver::grab_stress()
   {
-    std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
     const std::vector<libMesh::Number> &solution(m_shell->get_solution());
     AssertThrow(solution.size() == current_displacement.size() * 5,
                 ExcMessage("Inconsistent solution size!"));
     // Copy the solutions
-    for (auto cell = scalar_dof_handler.begin_active();
-         cell != scalar_dof_handler.end();
-         ++cell)
+    for (unsigned int v = 0; v < vertex_scalar_dofs.size(); ++v)
       {
-        for (unsigned int v = 0; v < GeometryInfo<2>::vertices_per_cell; ++v)
+        if (vertex_scalar_dofs[v] == numbers::invalid_dof_index)
           {
-            if (!vertex_touched[cell->vertex_index(v)])
-              {
-                vertex_touched[cell->vertex_index(v)] = true;
-                for (unsigned int i : {0, 1, 2})
-                  {
-                    for (unsigned int j : {0, 1, 2})
-                      stress[i][j](cell->vertex_dof_index(v, 0)) =
-                        solution[15 * cell->vertex_index(v) + 3 * i + j];
-                  }
-              }
+            continue;
+          }
+        for (unsigned int i : {0, 1, 2})
+          {
+            for (unsigned int j : {0, 1, 2})
+              stress[i][j](vertex_scalar_dofs[v]) =
+                solution[15 * v + 3 * i + j];
           }
       }
   }
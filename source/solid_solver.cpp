@@ -16,13 +16,25 @@ namespace Solid
       scalar_fe(parameters.solid_degree),
       volume_quad_formula(parameters.solid_degree + 1),
       face_quad_formula(parameters.solid_degree + 1),
+      use_system_matrix(false),
+      use_mass_matrix(false),
+      use_stiffness_matrix(false),
       time(parameters.end_time,
            parameters.time_step,
            parameters.output_interval,
            parameters.refinement_interval,
            parameters.save_interval),
-      timer(std::cout, TimerOutput::never, TimerOutput::wall_times)
+      timer(std::cout, TimerOutput::never, TimerOutput::wall_times),
+      factorized_delta_t(0)
   {
+    // The implicit solvers assume a constant time step size.
+    if (parameters.adaptive_time_stepping &&
+        parameters.solid_integrator == "explicit")
+      {
+        time.set_adaptive(parameters.min_time_step,
+                          parameters.max_time_step,
+                          parameters.max_time_step_growth);
+      }
   }
 
   template <int dim, int spacedim>
@@ -39,7 +51,7 @@ namespace Solid
     TimerOutput::Scope timer_section(timer, "Setup system");
 
     dof_handler.distribute_dofs(fe);
-    DoFRenumbering::Cuthill_McKee(dof_handler);
+    Utils::renumber_dofs(dof_handler, parameters.dof_renumbering);
     scalar_dof_handler.distribute_dofs(scalar_fe);
 
     // The Dirichlet boundary conditions are stored in the
@@ -82,19 +94,38 @@ namespace Solid
       }
 
     constraints.close();
+
+    neumann_faces.reinit(triangulation, [this](const types::boundary_id id) {
+      return parameters.simulation_type == "FSI" ||
+             parameters.solid_neumann_bcs.find(id) !=
+               parameters.solid_neumann_bcs.end();
+    });
   }
 
   template <int dim, int spacedim>
   void SolidSolver<dim, spacedim>::initialize_system()
   {
+    factorized_delta_t = 0;
     DynamicSparsityPattern dsp(dof_handler.n_dofs(), dof_handler.n_dofs());
     DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints);
     pattern.copy_from(dsp);
 
-    system_matrix.reinit(pattern);
-    mass_matrix.reinit(pattern);
-    stiffness_matrix.reinit(pattern);
+    // Each matrix takes as much memory as the others, so only the ones in use
+    // are allocated.
+    if (use_system_matrix)
+      {
+        system_matrix.reinit(pattern);
+      }
+    if (use_mass_matrix)
+      {
+        mass_matrix.reinit(pattern);
+      }
+    if (use_stiffness_matrix)
+      {
+        stiffness_matrix.reinit(pattern);
+      }
     system_rhs.reinit(dof_handler.n_dofs());
+    inverse_lumped_mass.reinit(0);
     current_acceleration.reinit(dof_handler.n_dofs());
     current_velocity.reinit(dof_handler.n_dofs());
     current_displacement.reinit(dof_handler.n_dofs());
@@ -121,22 +152,199 @@ namespace Solid
   // Solve linear system \f$Ax = b\f$ using CG solver.
   template <int dim, int spacedim>
   std::pair<unsigned int, double> SolidSolver<dim, spacedim>::solve(
-    const SparseMatrix<double> &A, Vector<double> &x, const Vector<double> &b)
+    const SparseMatrix<double> &A,
+    Vector<double> &x,
+    const Vector<double> &b,
+    const double forcing)
   {
     TimerOutput::Scope timer_section(timer, "Solve linear system");
 
-    SolverControl solver_control(A.m(), 1e-6 * b.l2_norm());
+    const double tolerance = parameters.solid_linear_tolerance > 0
+                               ? parameters.solid_linear_tolerance
+                               : 1e-6;
+    SolverControl solver_control(A.m(),
+                                 std::max(tolerance, forcing) * b.l2_norm());
     SolverCG<> cg(solver_control);
 
-    PreconditionSSOR<> preconditioner;
-    preconditioner.initialize(A, 1.2);
-
-    cg.solve(A, x, b, preconditioner);
+    const std::string &name = parameters.solid_preconditioner;
+    if (name == "default" || name == "sor")
+      {
+        PreconditionSSOR<> preconditioner;
+        preconditioner.initialize(A, 1.2);
+        cg.solve(A, x, b, preconditioner);
+      }
+    else if (name == "jacobi")
+      {
+        PreconditionJacobi<> preconditioner;
+        preconditioner.initialize(A);
+        cg.solve(A, x, b, preconditioner);
+      }
+    else if (name == "chebyshev")
+      {
+        // Chebyshev iteration on the Jacobi preconditioned matrix over the
+        // upper part of its spectrum, the same as in the MPI solvers.
+        using Chebyshev =
+          PreconditionChebyshev<SparseMatrix<double>, Vector<double>>;
+        Chebyshev::AdditionalData data;
+        data.degree = 5;
+        data.smoothing_range = 10;
+        Chebyshev preconditioner;
+        preconditioner.initialize(A, data);
+        cg.solve(A, x, b, preconditioner);
+      }
+    else if (name == "none")
+      {
+        cg.solve(A, x, b, PreconditionIdentity());
+      }
+    else
+      {
+        AssertThrow(false,
+                    ExcMessage("Preconditioner " + name +
+                               " is not available in the serial solid "
+                               "solver!"));
+      }
     constraints.distribute(x);
 
     return {solver_control.last_step(), solver_control.last_value()};
   }
 
+  template <int dim, int spacedim>
+  std::pair<unsigned int, double>
+  SolidSolver<dim, spacedim>::solve_factorized(Vector<double> &x,
+                                               const Vector<double> &b)
+  {
+    TimerOutput::Scope timer_section(timer, "Solve linear system");
+
+    if (factorized_delta_t != time.get_delta_t())
+      {
+        system_factor.initialize(system_matrix);
+        factorized_delta_t = time.get_delta_t();
+      }
+    system_factor.vmult(x, b);
+    constraints.distribute(x);
+
+    Vector<double> residual(b.size());
+    return {0, system_matrix.residual(residual, x, b)};
+  }
+
+  template <int dim, int spacedim>
+  void SolidSolver<dim, spacedim>::assemble_lumped_mass()
+  {
+    TimerOutput::Scope timer_section(timer, "Assemble lumped mass");
+
+    FEValues<dim, spacedim> fe_values(
+      fe, volume_quad_formula, update_values | update_JxW_values);
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    const unsigned int n_q_points = volume_quad_formula.size();
+    const double rho = parameters.solid_rho;
+    Vector<double> local_mass(dofs_per_cell);
+    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    Vector<double> lumped_mass(dof_handler.n_dofs());
+
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        fe_values.reinit(cell);
+        local_mass = 0;
+        // The row sum of the mass matrix is the integral of the shape
+        // function, because the shape functions sum up to 1.
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                local_mass[i] +=
+                  rho * fe_values.shape_value(i, q) * fe_values.JxW(q);
+              }
+          }
+        cell->get_dof_indices(local_dof_indices);
+        // Condensing the vector gives the row sums of the condensed matrix.
+        constraints.distribute_local_to_global(
+          local_mass, local_dof_indices, lumped_mass);
+      }
+
+    inverse_lumped_mass.reinit(dof_handler.n_dofs());
+    for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+      {
+        if (!constraints.is_constrained(i))
+          {
+            Assert(lumped_mass[i] > 0, ExcInternalError());
+            inverse_lumped_mass[i] = 1.0 / lumped_mass[i];
+          }
+      }
+  }
+
+  template <int dim, int spacedim>
+  void SolidSolver<dim, spacedim>::assemble_explicit_force()
+  {
+    AssertThrow(false,
+                ExcMessage("The explicit time integrator is not "
+                           "implemented for this solid solver!"));
+  }
+
+  template <int dim, int spacedim>
+  void SolidSolver<dim, spacedim>::run_one_explicit_step(bool first_step)
+  {
+    // After a refinement
+    if (inverse_lumped_mass.size() != dof_handler.n_dofs())
+      {
+        assemble_lumped_mass();
+      }
+
+    // M_L a = f(u, v), and the constrained acceleration follows from the
+    // constraints.
+    auto solve_acceleration = [this](Vector<double> &a) {
+      a = system_rhs;
+      a.scale(inverse_lumped_mass);
+      constraints.distribute(a);
+    };
+
+    if (first_step)
+      {
+        assemble_explicit_force();
+        solve_acceleration(previous_acceleration);
+        current_acceleration = previous_acceleration;
+        output_results(time.get_timestep());
+      }
+
+    const double dt = time.get_delta_t();
+    AssertThrow(dt <= get_stable_time_step() * (1 + 1e-10),
+                ExcMessage("The time step size exceeds the stability limit "
+                           "of the explicit time integrator!"));
+
+    time.increment();
+    std::cout << std::string(91, '*') << std::endl
+              << "Time step = " << time.get_timestep()
+              << ", at t = " << std::scientific << time.current() << std::endl;
+
+    // \f$ v_{n+1/2} = v_n + \frac{\Delta{t}}{2}a_n \f$,
+    // \f$ u_{n+1} = u_n + \Delta{t}v_{n+1/2} \f$
+    current_velocity = previous_velocity;
+    current_velocity.add(0.5 * dt, previous_acceleration);
+    current_displacement = previous_displacement;
+    current_displacement.add(dt, current_velocity);
+
+    // \f$ v_{n+1} = v_{n+1/2} + \frac{\Delta{t}}{2}a_{n+1} \f$
+    assemble_explicit_force();
+    solve_acceleration(current_acceleration);
+    current_velocity.add(0.5 * dt, current_acceleration);
+
+    previous_acceleration = current_acceleration;
+    previous_velocity = current_velocity;
+    previous_displacement = current_displacement;
+
+    update_strain_and_stress();
+
+    if (time.time_to_output())
+      {
+        output_results(time.get_timestep());
+      }
+
+    if (time.time_to_refine())
+      {
+        refine_mesh(1, 4);
+      }
+  }
+
   template <int dim, int spacedim>
   void
   SolidSolver<dim, spacedim>::output_results(const unsigned int output_index)
@@ -280,10 +488,40 @@ namespace Solid
     run_one_step(true);
     while (time.end() - time.current() > 1e-12)
       {
+        if (time.adaptive())
+          {
+            time.adapt_delta_t(get_stable_time_step());
+          }
         run_one_step(false);
       }
   }
 
+  template <int dim, int spacedim>
+  double SolidSolver<dim, spacedim>::get_stable_time_step() const
+  {
+    double delta_t = std::numeric_limits<double>::max();
+    double courant = parameters.solid_courant;
+    if (courant == 0 && parameters.solid_integrator == "explicit")
+      {
+        courant = 1;
+      }
+    if (courant == 0)
+      {
+        return delta_t;
+      }
+    for (auto cell = triangulation.begin_active(); cell != triangulation.end();
+         ++cell)
+      {
+        const unsigned int part =
+          parameters.n_solid_parts == 1 ? 0 : cell->material_id() - 1;
+        delta_t = std::min(delta_t,
+                           courant * cell->minimum_vertex_distance() /
+                             (parameters.solid_degree *
+                              parameters.wave_speed(part)));
+      }
+    return delta_t;
+  }
+
   template <int dim, int spacedim>
   Vector<double> SolidSolver<dim, spacedim>::get_current_solution() const
   {
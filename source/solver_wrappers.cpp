@@ -0,0 +1,577 @@
+#include "solver_wrappers.h"
+#include <deal.II/lac/solver_cg.h>
+#include <deal.II/lac/sparse_direct.h>
+#include <umfpack.h>
+#include <algorithm>
+
+namespace Utils
+{
+  void SinglePrecisionCG::reinit(const PETScWrappers::MPI::SparseMatrix &matrix)
+  {
+    AssertThrow(matrix.m() == matrix.n(),
+                ExcMessage("The matrix must be square!"));
+    const auto range = matrix.local_range();
+    IndexSet owned(matrix.m());
+    owned.add_range(range.first, range.second);
+
+    row_starts.assign(1, 0);
+    values.clear();
+    std::vector<types::global_dof_index> global_columns;
+    std::vector<types::global_dof_index> ghost_list;
+    std::vector<float> diagonal(range.second - range.first, 0);
+    for (auto r = range.first; r < range.second; ++r)
+      {
+        for (auto entry = matrix.begin(r); entry != matrix.end(r); ++entry)
+          {
+            const auto column = entry->column();
+            global_columns.push_back(column);
+            values.push_back(static_cast<float>(entry->value()));
+            if (column == r)
+              {
+                diagonal[r - range.first] = values.back();
+              }
+            else if (!owned.is_element(column))
+              {
+                ghost_list.push_back(column);
+              }
+          }
+        row_starts.push_back(values.size());
+      }
+    std::sort(ghost_list.begin(), ghost_list.end());
+    ghost_list.erase(std::unique(ghost_list.begin(), ghost_list.end()),
+                     ghost_list.end());
+    IndexSet ghosts(matrix.m());
+    ghosts.add_indices(ghost_list.begin(), ghost_list.end());
+
+    auto partitioner = std::make_shared<const Utilities::MPI::Partitioner>(
+      owned, ghosts, matrix.get_mpi_communicator());
+    columns.resize(global_columns.size());
+    for (unsigned int k = 0; k < global_columns.size(); ++k)
+      {
+        columns[k] = partitioner->global_to_local(global_columns[k]);
+      }
+
+    x_buffer.reinit(partitioner);
+    b_buffer.reinit(partitioner);
+    auto &inverse = inverse_diagonal.get_vector();
+    inverse.reinit(partitioner);
+    // Like PETSc Jacobi, zero diagonal entries are replaced with 1.
+    for (unsigned int i = 0; i < diagonal.size(); ++i)
+      {
+        inverse.local_element(i) = diagonal[i] != 0 ? 1 / diagonal[i] : 1;
+      }
+  }
+
+  SolverKrylov::SolverKrylov(SolverControl &control,
+                             const MPI_Comm &communicator,
+                             const std::string &method)
+    : PETScWrappers::SolverBase(control, communicator), method(method)
+  {
+    AssertThrow(method == "cg" || method == "pipecg" || method == "groppcg" ||
+                  method == "pipecr",
+                ExcMessage("Unknown Krylov method " + method + "!"));
+  }
+
+  void SolverKrylov::set_solver_type(KSP &ksp) const
+  {
+    PetscErrorCode ierr = KSPSetType(ksp, method.c_str());
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    // The caller's initial guess is used, as by PETScWrappers::SolverCG.
+    ierr = KSPSetInitialGuessNonzero(ksp, PETSC_TRUE);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+  }
+
+  unsigned int SinglePrecisionCG::solve(PETScWrappers::MPI::Vector &x,
+                                        const PETScWrappers::MPI::Vector &b,
+                                        const double tolerance) const
+  {
+    const PetscScalar *b_values;
+    PetscErrorCode ierr = VecGetArrayRead(b, &b_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    std::copy(b_values, b_values + b_buffer.local_size(), b_buffer.begin());
+    ierr = VecRestoreArrayRead(b, &b_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+    x_buffer = 0;
+    SolverControl control(b.size(),
+                          std::max(tolerance, 1e-5 * b_buffer.l2_norm()));
+    SolverCG<VectorType> cg(control);
+    cg.solve(*this, x_buffer, b_buffer, inverse_diagonal);
+
+    PetscScalar *x_values;
+    ierr = VecGetArray(x, &x_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    std::copy(
+      x_buffer.begin(), x_buffer.begin() + x_buffer.local_size(), x_values);
+    ierr = VecRestoreArray(x, &x_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    return control.last_step();
+  }
+
+  void SinglePrecisionCG::vmult(VectorType &dst, const VectorType &src) const
+  {
+    src.update_ghost_values();
+    for (unsigned int i = 0; i + 1 < row_starts.size(); ++i)
+      {
+        float sum = 0;
+        for (unsigned int k = row_starts[i]; k < row_starts[i + 1]; ++k)
+          {
+            sum += values[k] * src.local_element(columns[k]);
+          }
+        dst.local_element(i) = sum;
+      }
+    src.zero_out_ghosts();
+  }
+
+  DeviceCG::DeviceCG() : matrix(nullptr), x(nullptr), b(nullptr), ksp(nullptr)
+  {
+  }
+
+  DeviceCG::~DeviceCG() { clear(); }
+
+  void DeviceCG::clear()
+  {
+    if (ksp)
+      {
+        KSPDestroy(&ksp);
+      }
+    if (x)
+      {
+        VecDestroy(&x);
+        VecDestroy(&b);
+      }
+    if (matrix)
+      {
+        MatDestroy(&matrix);
+      }
+  }
+
+  void DeviceCG::reinit(const PETScWrappers::MatrixBase &source,
+                        const std::string &backend,
+                        const std::string &preconditioner)
+  {
+    clear();
+    MatType type = nullptr;
+    if (backend == "cuda")
+      {
+        type = MATAIJCUSPARSE;
+      }
+#ifdef MATAIJKOKKOS
+    else if (backend == "kokkos")
+      {
+        type = MATAIJKOKKOS;
+      }
+#endif
+    AssertThrow(type != nullptr,
+                ExcMessage("PETSc does not support the " + backend +
+                           " backend!"));
+
+    PetscErrorCode ierr = MatConvert(source, type, MAT_INITIAL_MATRIX, &matrix);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = MatCreateVecs(matrix, &x, &b);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+    ierr = KSPCreate(source.get_mpi_communicator(), &ksp);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSetOperators(ksp, matrix, matrix);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSetType(ksp, KSPCG);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    // Like the deal.II solvers, the tolerance applies to the true residual.
+    ierr = KSPSetNormType(ksp, KSP_NORM_UNPRECONDITIONED);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    PC pc;
+    ierr = KSPGetPC(ksp, &pc);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    if (preconditioner == "boomeramg")
+      {
+        ierr = PCSetType(pc, PCHYPRE);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        ierr = PCHYPRESetType(pc, "boomeramg");
+      }
+    else
+      {
+        ierr = PCSetType(pc, PCJACOBI);
+      }
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSetUp(ksp);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+  }
+
+  unsigned int DeviceCG::solve(PETScWrappers::MPI::Vector &solution,
+                               const PETScWrappers::MPI::Vector &rhs,
+                               const double tolerance) const
+  {
+    const PetscScalar *host_values;
+    PetscScalar *device_values;
+    // Getting the array of a device vector syncs it to the host, and
+    // restoring it marks the host copy as the valid one.
+    PetscErrorCode ierr = VecGetArrayRead(rhs, &host_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = VecGetArray(b, &device_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    std::copy(host_values, host_values + rhs.local_size(), device_values);
+    ierr = VecRestoreArray(b, &device_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = VecRestoreArrayRead(rhs, &host_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+    ierr = VecSet(x, 0);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSetTolerances(
+      ksp, 0, tolerance, PETSC_DEFAULT, static_cast<PetscInt>(rhs.size()));
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSolve(ksp, b, x);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    PetscInt n_iterations;
+    PetscReal residual;
+    KSPConvergedReason reason;
+    KSPGetIterationNumber(ksp, &n_iterations);
+    KSPGetResidualNorm(ksp, &residual);
+    KSPGetConvergedReason(ksp, &reason);
+    AssertThrow(reason > 0,
+                SolverControl::NoConvergence(n_iterations, residual));
+
+    PetscScalar *solution_values;
+    ierr = VecGetArrayRead(x, &host_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = VecGetArray(solution, &solution_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    std::copy(
+      host_values, host_values + solution.local_size(), solution_values);
+    ierr = VecRestoreArray(solution, &solution_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = VecRestoreArrayRead(x, &host_values);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    return n_iterations;
+  }
+
+  FieldSplitSolver::FieldSplitSolver(
+    const std::string &prefix,
+    const std::map<std::string, std::string> &default_options)
+    : prefix(prefix),
+      default_options(default_options),
+      matrix(nullptr),
+      ksp(nullptr),
+      shell_pending(false)
+  {
+  }
+
+  FieldSplitSolver::~FieldSplitSolver() { clear(); }
+
+  void FieldSplitSolver::clear()
+  {
+    if (ksp)
+      {
+        KSPDestroy(&ksp);
+      }
+    if (matrix)
+      {
+        MatDestroy(&matrix);
+      }
+    shell_pending = false;
+  }
+
+  void FieldSplitSolver::initialize(
+    const PETScWrappers::MPI::BlockSparseMatrix &system,
+    const std::vector<IndexSet> &owned_partitioning,
+    const PETScWrappers::MPI::SparseMatrix *schur_matrix,
+    const SchurInverse &schur_inverse)
+  {
+    AssertDimension(system.n_block_rows(), 2);
+    AssertDimension(system.n_block_cols(), 2);
+    clear();
+    const MPI_Comm &comm = system.get_mpi_communicator();
+
+    // The defaults do not override the options on the command line.
+    for (const auto &option : default_options)
+      {
+        const std::string name = "-" + prefix + option.first;
+        PetscBool is_set;
+        PetscErrorCode ierr =
+          PetscOptionsHasName(nullptr, nullptr, name.c_str(), &is_set);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        if (!is_set)
+          {
+            ierr = PetscOptionsSetValue(
+              nullptr, name.c_str(), option.second.c_str());
+            AssertThrow(ierr == 0, ExcPETScError(ierr));
+          }
+      }
+
+    Mat blocks[4] = {system.block(0, 0),
+                     system.block(0, 1),
+                     system.block(1, 0),
+                     system.block(1, 1)};
+    PetscErrorCode ierr =
+      MatCreateNest(comm, 2, nullptr, 2, nullptr, blocks, &matrix);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    IS rows[2];
+    ierr = MatNestGetISs(matrix, rows, nullptr);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+    ierr = KSPCreate(comm, &ksp);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSetOptionsPrefix(ksp, prefix.c_str());
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSetOperators(ksp, matrix, matrix);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSetType(ksp, KSPFGMRES);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    PC pc;
+    ierr = KSPGetPC(ksp, &pc);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = PCSetType(pc, PCFIELDSPLIT);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = PCFieldSplitSetIS(pc, "0", rows[0]);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = PCFieldSplitSetIS(pc, "1", rows[1]);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = PCFieldSplitSetType(pc, PC_COMPOSITE_SCHUR);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = PCFieldSplitSetSchurFactType(pc, PC_FIELDSPLIT_SCHUR_FACT_UPPER);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    if (schur_matrix)
+      {
+        ierr = PCFieldSplitSetSchurPre(
+          pc, PC_FIELDSPLIT_SCHUR_PRE_USER, *schur_matrix);
+      }
+    else
+      {
+        ierr =
+          PCFieldSplitSetSchurPre(pc, PC_FIELDSPLIT_SCHUR_PRE_A11, nullptr);
+      }
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSetFromOptions(ksp);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+    this->schur_inverse = schur_inverse;
+    if (schur_inverse)
+      {
+        schur_src.reinit(owned_partitioning[1], comm);
+        schur_dst.reinit(owned_partitioning[1], comm);
+        // The sub-solvers only exist after the first setup.
+        shell_pending = true;
+      }
+  }
+
+  PetscErrorCode FieldSplitSolver::apply_schur_inverse(PC pc, Vec x, Vec y)
+  {
+    void *context;
+    PetscErrorCode ierr = PCShellGetContext(pc, &context);
+    CHKERRQ(ierr);
+    FieldSplitSolver &solver = *static_cast<FieldSplitSolver *>(context);
+    ierr = VecCopy(x, solver.schur_src);
+    CHKERRQ(ierr);
+    solver.schur_inverse(solver.schur_dst, solver.schur_src);
+    ierr = VecCopy(solver.schur_dst, y);
+    CHKERRQ(ierr);
+    return 0;
+  }
+
+  std::pair<unsigned int, double>
+  FieldSplitSolver::solve(PETScWrappers::MPI::BlockVector &solution,
+                          const PETScWrappers::MPI::BlockVector &rhs,
+                          const double tolerance,
+                          const bool reuse_preconditioner)
+  {
+    Assert(ksp, ExcNotInitialized());
+    const MPI_Comm &comm = rhs.block(0).get_mpi_communicator();
+    // The nested vectors refer to the blocks, rather than copying them.
+    Vec x_blocks[2] = {solution.block(0), solution.block(1)};
+    Vec b_blocks[2] = {rhs.block(0), rhs.block(1)};
+    Vec x, b;
+    PetscErrorCode ierr = VecCreateNest(comm, 2, nullptr, x_blocks, &x);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = VecCreateNest(comm, 2, nullptr, b_blocks, &b);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+
+    // Changing the values of the blocks does not change the state of the
+    // MatNest, which is what decides whether the preconditioner is set up
+    // again.
+    if (!reuse_preconditioner)
+      {
+        ierr = PetscObjectStateIncrease(reinterpret_cast<PetscObject>(matrix));
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+    ierr = KSPSetReusePreconditioner(
+      ksp, reuse_preconditioner ? PETSC_TRUE : PETSC_FALSE);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    if (shell_pending)
+      {
+        ierr = KSPSetUp(ksp);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        PC pc, schur_pc;
+        ierr = KSPGetPC(ksp, &pc);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        PetscInt n_splits;
+        KSP *sub_ksps;
+        ierr = PCFieldSplitGetSubKSP(pc, &n_splits, &sub_ksps);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        ierr = KSPGetPC(sub_ksps[1], &schur_pc);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        ierr = PetscFree(sub_ksps);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        ierr = PCSetType(schur_pc, PCSHELL);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        ierr = PCShellSetContext(schur_pc, this);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        ierr =
+          PCShellSetApply(schur_pc, &FieldSplitSolver::apply_schur_inverse);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        shell_pending = false;
+      }
+
+    ierr = VecSet(x, 0);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSetTolerances(
+      ksp, 0, tolerance, PETSC_DEFAULT, static_cast<PetscInt>(rhs.size()));
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    ierr = KSPSolve(ksp, b, x);
+    AssertThrow(ierr == 0, ExcPETScError(ierr));
+    PetscInt n_iterations;
+    PetscReal residual;
+    KSPConvergedReason reason;
+    KSPGetIterationNumber(ksp, &n_iterations);
+    KSPGetResidualNorm(ksp, &residual);
+    KSPGetConvergedReason(ksp, &reason);
+    VecDestroy(&x);
+    VecDestroy(&b);
+    AssertThrow(reason > 0,
+                SolverControl::NoConvergence(n_iterations, residual));
+    return {static_cast<unsigned int>(n_iterations), residual};
+  }
+
+  UMFPACKFactorization::UMFPACKFactorization()
+    : symbolic(nullptr), numeric(nullptr), control(UMFPACK_CONTROL)
+  {
+    umfpack_dl_defaults(control.data());
+  }
+
+  UMFPACKFactorization::~UMFPACKFactorization() { clear(); }
+
+  void UMFPACKFactorization::clear()
+  {
+    if (numeric != nullptr)
+      {
+        umfpack_dl_free_numeric(&numeric);
+      }
+    if (symbolic != nullptr)
+      {
+        umfpack_dl_free_symbolic(&symbolic);
+      }
+    numeric = nullptr;
+    symbolic = nullptr;
+    Ap.clear();
+    Ai.clear();
+    Ax.clear();
+    positions.clear();
+  }
+
+  bool UMFPACKFactorization::update(const SparseMatrix<double> &matrix,
+                                    const bool keep_stale)
+  {
+    Assert(matrix.m() == matrix.n(), ExcNotQuadratic());
+    if (numeric != nullptr && keep_stale)
+      {
+        return false;
+      }
+
+    const long int n = matrix.m();
+    if (symbolic == nullptr)
+      {
+        // Sort the column indices of every row, SparseMatrix stores the
+        // diagonal first.
+        Ap.assign(n + 1, 0);
+        Ai.clear();
+        Ai.reserve(matrix.n_nonzero_elements());
+        positions.clear();
+        positions.reserve(matrix.n_nonzero_elements());
+        // The column index and the position in the row of every entry.
+        std::vector<std::pair<long int, long int>> row;
+        for (long int i = 0; i < n; ++i)
+          {
+            row.clear();
+            long int j = 0;
+            for (auto entry = matrix.begin(i); entry != matrix.end(i); ++entry)
+              {
+                row.emplace_back(entry->column(), j++);
+              }
+            std::sort(row.begin(), row.end());
+            const long int offset = Ai.size();
+            positions.resize(offset + row.size());
+            for (unsigned int k = 0; k < row.size(); ++k)
+              {
+                positions[offset + row[k].second] = offset + k;
+                Ai.push_back(row[k].first);
+              }
+            Ap[i + 1] = Ai.size();
+          }
+        Ax.resize(Ai.size());
+      }
+    AssertDimension(Ap.size(), static_cast<std::size_t>(n + 1));
+    AssertDimension(positions.size(), matrix.n_nonzero_elements());
+
+    long int k = 0;
+    for (long int i = 0; i < n; ++i)
+      {
+        for (auto entry = matrix.begin(i); entry != matrix.end(i); ++entry)
+          {
+            Ax[positions[k++]] = entry->value();
+          }
+      }
+
+    long int status;
+    if (symbolic == nullptr)
+      {
+        status = umfpack_dl_symbolic(n,
+                                     n,
+                                     Ap.data(),
+                                     Ai.data(),
+                                     Ax.data(),
+                                     &symbolic,
+                                     control.data(),
+                                     nullptr);
+        AssertThrow(status == UMFPACK_OK,
+                    SparseDirectUMFPACK::ExcUMFPACKError("umfpack_dl_symbolic",
+                                                         int(status)));
+      }
+    if (numeric != nullptr)
+      {
+        umfpack_dl_free_numeric(&numeric);
+      }
+    status = umfpack_dl_numeric(Ap.data(),
+                                Ai.data(),
+                                Ax.data(),
+                                symbolic,
+                                &numeric,
+                                control.data(),
+                                nullptr);
+    AssertThrow(status == UMFPACK_OK,
+                SparseDirectUMFPACK::ExcUMFPACKError("umfpack_dl_numeric",
+                                                     int(status)));
+    return true;
+  }
+
+  void UMFPACKFactorization::vmult(Vector<double> &dst,
+                                   const Vector<double> &src) const
+  {
+    Assert(numeric != nullptr, ExcNotInitialized());
+    AssertDimension(src.size(), Ap.size() - 1);
+    dst.reinit(src.size(), true);
+    // The arrays hold the transpose of the matrix in compressed column
+    // storage, so the transposed system is solved.
+    const long int status = umfpack_dl_solve(UMFPACK_At,
+                                             Ap.data(),
+                                             Ai.data(),
+                                             Ax.data(),
+                                             dst.begin(),
+                                             src.begin(),
+                                             numeric,
+                                             control.data(),
+                                             nullptr);
+    AssertThrow(status == UMFPACK_OK,
+                SparseDirectUMFPACK::ExcUMFPACKError("umfpack_dl_solve",
+                                                     int(status)));
+  }
+} // namespace Utils
@@ -1,604 +1,3149 @@
 #include "utilities.h"
+#include <deal.II/grid/grid_in.h>
 #include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <sstream>
 
 namespace Utils
 {
+  namespace
+  {
+    // The times are accumulated step by step, so they are compared to the
+    // multiples of the intervals with a tolerance relative to the intervals.
+    const double time_tolerance = 1e-8;
+
+    /// The locally owned entries of a vector, which the PETSc vectors only
+    /// expose between the get and restore calls.
+    class LocalValues
+    {
+    public:
+      explicit LocalValues(Vector<double> &v)
+        : vector(nullptr), writable(true), values(v.begin()), n(v.size())
+      {
+      }
+
+      explicit LocalValues(const Vector<double> &v)
+        : vector(nullptr),
+          writable(false),
+          values(const_cast<double *>(v.begin())),
+          n(v.size())
+      {
+      }
+
+      explicit LocalValues(PETScWrappers::MPI::Vector &v)
+        : vector(v), writable(true), n(v.local_size())
+      {
+        PetscErrorCode ierr = VecGetArray(vector, &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+
+      explicit LocalValues(const PETScWrappers::MPI::Vector &v)
+        : vector(v), writable(false), n(v.local_size())
+      {
+        const PetscScalar *read_values;
+        PetscErrorCode ierr = VecGetArrayRead(vector, &read_values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        values = const_cast<PetscScalar *>(read_values);
+      }
+
+#ifdef OPENIFEM_WITH_TRILINOS
+      // The locally owned entries of an Epetra vector are contiguous.
+      explicit LocalValues(TrilinosWrappers::MPI::Vector &v)
+        : vector(nullptr), writable(true), values(v.begin()), n(v.local_size())
+      {
+      }
+
+      explicit LocalValues(const TrilinosWrappers::MPI::Vector &v)
+        : vector(nullptr),
+          writable(false),
+          values(const_cast<double *>(v.begin())),
+          n(v.local_size())
+      {
+      }
+#endif
+
+      ~LocalValues()
+      {
+        if (vector == nullptr)
+          {
+            return;
+          }
+        PetscErrorCode ierr;
+        if (writable)
+          {
+            ierr = VecRestoreArray(vector, &values);
+          }
+        else
+          {
+            const PetscScalar *read_values = values;
+            ierr = VecRestoreArrayRead(vector, &read_values);
+          }
+        AssertNothrow(ierr == 0, ExcPETScError(ierr));
+        (void)ierr;
+      }
+
+      double &operator[](const std::size_t i) const { return values[i]; }
+
+      std::size_t size() const { return n; }
+
+    private:
+      Vec vector;
+      const bool writable;
+      double *values;
+      const std::size_t n;
+    };
+  } // namespace
+
   bool Time::time_to_output() const
   {
+    if (is_adaptive)
+      {
+        return reached(output_interval);
+      }
     auto delta = static_cast<unsigned int>(output_interval / delta_t);
     return (timestep >= delta && timestep % delta == 0);
   }
 
   bool Time::time_to_refine() const
   {
+    if (is_adaptive)
+      {
+        return reached(refinement_interval);
+      }
     auto delta = static_cast<unsigned int>(refinement_interval / delta_t);
     return (timestep >= delta && timestep % delta == 0);
   }
 
   bool Time::time_to_save() const
   {
+    if (is_adaptive)
+      {
+        return reached(save_interval);
+      }
     auto delta = static_cast<unsigned int>(save_interval / delta_t);
     return (timestep >= delta && timestep % delta == 0);
   }
 
   void Time::increment()
   {
+    time_previous = time_current;
     time_current += delta_t;
     ++timestep;
   }
 
-  void Time::set_delta_t(double delta) { delta_t = delta; }
+  void Time::set_delta_t(double delta)
+  {
+    delta_t = delta;
+    nominal_delta_t = delta;
+  }
 
-  template <int dim, typename VectorType>
-  SPHInterpolator<dim, VectorType>::SPHInterpolator(
-    const DoFHandler<dim> &dof_handler, const Point<dim> &point)
-    : dof_handler(dof_handler), target(point)
+  Time::State Time::state() const
   {
-    for (auto cell : dof_handler.active_cell_iterators())
+    return {timestep, time_current, time_previous, delta_t, nominal_delta_t};
+  }
+
+  void Time::rewind(const State &state)
+  {
+    Assert(state.timestep <= timestep,
+           ExcMessage("Cannot rewind to a later time step!"));
+    set_state(state);
+  }
+
+  void Time::set_state(const State &state)
+  {
+    timestep = state.timestep;
+    time_current = state.time_current;
+    time_previous = state.time_previous;
+    delta_t = state.delta_t;
+    nominal_delta_t = state.nominal_delta_t;
+  }
+
+  void Time::set_adaptive(const double min_delta,
+                          const double max_delta,
+                          const double growth)
+  {
+    AssertThrow(min_delta >= 0 && max_delta > 0 && min_delta <= max_delta,
+                ExcMessage("Invalid bounds of the time step size!"));
+    AssertThrow(growth >= 1, ExcMessage("Invalid time step growth factor!"));
+    is_adaptive = true;
+    min_delta_t = min_delta;
+    max_delta_t = max_delta;
+    max_growth = growth;
+    delta_t = std::min(std::max(delta_t, min_delta_t), max_delta_t);
+    nominal_delta_t = delta_t;
+    land_on_event();
+  }
+
+  double Time::adapt_delta_t(const double limit, const double factor)
+  {
+    AssertThrow(is_adaptive,
+                ExcMessage("Adaptive time stepping is not enabled!"));
+    double delta =
+      std::min({max_delta_t, max_growth * nominal_delta_t, limit});
+    if (factor < std::numeric_limits<double>::max())
       {
-        if (!cell->is_locally_owned())
-          continue;
-        Point<dim> center = cell->center();
-        double h = cell->diameter();
-        double kernel_value = cubic_spline(center, target, h);
-        if (kernel_value > 1e-12)
-          {
-            sources.push_back({cell, kernel_value});
-          }
+        delta = std::min(delta, factor * nominal_delta_t);
       }
+    delta_t = std::max(delta, min_delta_t);
+    nominal_delta_t = delta_t;
+    land_on_event();
+    return delta_t;
   }
 
-  template <int dim, typename VectorType>
-  double SPHInterpolator<dim, VectorType>::cubic_spline(const Point<dim> &pi,
-                                                        const Point<dim> &pj,
-                                                        double h)
+  bool Time::reached(const double interval) const
   {
-    double w(0.);
-    double q = pi.distance(pj) / h;
-    // M_1_PI = 1 / pi
-    double coef = (dim == 2 ? 10 * M_1_PI / (7 * h * h) : M_1_PI / (h * h * h));
-    if (q < 2.)
+    return interval > 0 && timestep > 0 &&
+           std::floor(time_current / interval + time_tolerance) >
+             std::floor(time_previous / interval + time_tolerance);
+  }
+
+  double Time::next_event() const
+  {
+    double event = time_end;
+    for (const double interval :
+         {output_interval, refinement_interval, save_interval})
       {
-        if (q >= 1.)
-          {
-            w = coef * (0.25 * (2 - q) * (2 - q) * (2 - q));
-          }
-        else
+        if (interval > 0)
           {
-            w = coef * (1 - 1.5 * q * q + 0.75 * q * q * q);
+            event = std::min(
+              event,
+              (std::floor(time_current / interval + time_tolerance) + 1) *
+                interval);
           }
       }
-    return w;
+    return event;
   }
 
-  template <int dim, typename VectorType>
-  void SPHInterpolator<dim, VectorType>::point_value(
-    const VectorType &fe_function,
-    Vector<typename VectorType::value_type> &value)
+  void Time::land_on_event()
   {
-    typedef typename VectorType::value_type Number;
-    const FiniteElement<dim> &fe = dof_handler.get_fe();
-    Assert(value.size() == fe.n_components(),
-           ExcDimensionMismatch(value.size(), fe.n_components()));
-
-    // Cell center in unit coordinate system
-    Point<dim> unit_center;
-    for (unsigned int i = 0; i < dim; ++i)
-      unit_center[i] = 0.5;
-    Quadrature<dim> quad(unit_center);
-    MappingQGeneric<dim> mapping(1);
-    FEValues<dim> fe_values(mapping, fe, quad, update_values);
-    value = 0;
-    for (auto p : sources)
+    const double remaining = next_event() - time_current;
+    if (delta_t > remaining * (1 - time_tolerance))
       {
-        auto cell = p.first;
-        fe_values.reinit(cell);
-        std::vector<Vector<Number>> u_value(1,
-                                            Vector<Number>(fe.n_components()));
-        fe_values.get_function_values(fe_function, u_value);
-        // In SPH interpolation, volume must be multiplied because kernel
-        // function has a unit of LENGTH^{-dim}
-        u_value[0] *= p.second * cell->measure();
-        value += u_value[0];
+        delta_t = remaining;
+      }
+    else if (delta_t > 0.5 * remaining)
+      {
+        // Two equal steps rather than a full one and a sliver.
+        delta_t = 0.5 * remaining;
       }
   }
 
-  template <int dim, typename VectorType>
-  void SPHInterpolator<dim, VectorType>::point_gradient(
-    const VectorType &fe_function,
-    std::vector<Tensor<1, dim, typename VectorType::value_type>> &gradient)
+  double ForcingTerm::next(const double residual)
   {
-    typedef typename VectorType::value_type Number;
-    const FiniteElement<dim> &fe = dof_handler.get_fe();
-    Assert(gradient.size() == fe.n_components(),
-           ExcDimensionMismatch(gradient.size(), fe.n_components()));
-    // Cell center in unit coordinate system
-    Point<dim> unit_center;
-    for (unsigned int i = 0; i < dim; ++i)
-      unit_center[i] = 0.5;
-    Quadrature<dim> quad(unit_center);
-    MappingQGeneric<dim> mapping(1);
-    FEValues<dim> fe_values(mapping, fe, quad, update_gradients);
-    for (unsigned int i = 0; i < gradient.size(); ++i)
-      gradient[i] = 0;
-    for (auto p : sources)
+    if (previous_residual > 0)
       {
-        auto cell = p.first;
-        fe_values.reinit(cell);
-        std::vector<std::vector<Tensor<1, dim, Number>>> u_gradient(
-          1, std::vector<Tensor<1, dim, Number>>(fe.n_components()));
-        fe_values.get_function_gradients(fe_function, u_gradient);
-        for (unsigned int i = 0; i < gradient.size(); ++i)
+        const double safeguard = gamma * std::pow(eta, alpha);
+        eta = gamma * std::pow(residual / previous_residual, alpha);
+        // Do not let the forcing term drop abruptly while it is large.
+        if (safeguard > 0.1)
           {
-            // In SPH interpolation, volume must be multiplied because kernel
-            // function has a unit of LENGTH^{-dim}
-            u_gradient[0][i] *= p.second * cell->measure();
-            gradient[i] += u_gradient[0][i];
+            eta = std::max(eta, safeguard);
           }
+        eta = std::min(eta, eta_max);
       }
+    else
+      {
+        eta = eta_max;
+      }
+    previous_residual = residual;
+    return eta;
   }
 
-  template <int dim, typename VectorType>
-  GridInterpolator<dim, VectorType>::GridInterpolator(
-    const DoFHandler<dim> &dof_handler,
-    const Point<dim> &point,
-    const std::vector<bool> &mask,
-    const typename DoFHandler<dim>::active_cell_iterator &cell)
-    : dof_handler(dof_handler), point(point), cell_found(true)
+  double line_search(const std::function<double(const double)> &residual,
+                     const double initial_residual,
+                     const double eta,
+                     const unsigned int max_steps)
   {
-    // If the cell is valid we just use the cell
-    if (cell.state() == IteratorState::IteratorStates::valid)
+    // The sufficient decrease parameter of Eisenstat and Walker.
+    const double t = 1e-4;
+    double step = 1.0;
+    for (unsigned int n = 0;; ++n)
       {
-        cell_point.first = cell;
-        cell_point.second = mapping.transform_real_to_unit_cell(cell, point);
-        return;
+        const double trial = residual(step);
+        if (trial <= (1 - t * step * (1 - eta)) * initial_residual ||
+            n == max_steps)
+          {
+            return step;
+          }
+        step *= 0.5;
       }
-    // This function throws an exception of GridTools::ExcPointNotFound if the
-    // point
-    // does not lie in any cell. In this case, we set the cell pointer to null.
-    try
+  }
+
+  template <typename VectorType>
+  void NewmarkUpdate::predict(VectorType &predicted_displacement,
+                              const VectorType &previous_displacement,
+                              const VectorType &previous_velocity,
+                              const VectorType &previous_acceleration) const
+  {
+    const LocalValues d(predicted_displacement), d_n(previous_displacement),
+      v_n(previous_velocity), a_n(previous_acceleration);
+    AssertDimension(d.size(), d_n.size());
+    AssertDimension(d.size(), v_n.size());
+    AssertDimension(d.size(), a_n.size());
+    const double c = (0.5 - beta) * dt * dt;
+    for (std::size_t i = 0; i < d.size(); ++i)
       {
-        cell_point = GridTools::find_active_cell_around_point(
-          mapping, dof_handler, point, mask);
+        d[i] = d_n[i] + dt * v_n[i] + c * a_n[i];
       }
-    catch (GridTools::ExcPointNotFound<dim> &e)
+  }
+
+  template <typename VectorType>
+  void NewmarkUpdate::predict(VectorType &predicted_displacement,
+                              VectorType &predicted_velocity,
+                              const VectorType &previous_displacement,
+                              const VectorType &previous_velocity,
+                              const VectorType &previous_acceleration,
+                              const double factor) const
+  {
+    const LocalValues d(predicted_displacement), v(predicted_velocity),
+      d_n(previous_displacement), v_n(previous_velocity),
+      a_n(previous_acceleration);
+    AssertDimension(d.size(), v.size());
+    AssertDimension(d.size(), d_n.size());
+    AssertDimension(d.size(), v_n.size());
+    AssertDimension(d.size(), a_n.size());
+    const double cv = factor * dt;
+    const double ca = factor * (0.5 - beta) * dt * dt;
+    const double cva = factor * (1 - gamma) * dt;
+    for (std::size_t i = 0; i < d.size(); ++i)
       {
-        cell_point.first = dof_handler.end();
-        cell_point.second = point;
-        cell_found = false;
+        d[i] = d_n[i] + cv * v_n[i] + ca * a_n[i];
+        v[i] = v_n[i] + cva * a_n[i];
       }
   }
 
-  template <int dim, typename VectorType>
-  void GridInterpolator<dim, VectorType>::point_value(
-    const VectorType &fe_function,
-    Vector<typename VectorType::value_type> &value)
+  template <typename VectorType>
+  void NewmarkUpdate::correct(const VectorType &acceleration,
+                              VectorType &velocity,
+                              VectorType &displacement,
+                              VectorType &previous_acceleration,
+                              VectorType &previous_velocity,
+                              VectorType &previous_displacement) const
   {
-    typedef typename VectorType::value_type Number;
-    const FiniteElement<dim> &fe = dof_handler.get_fe();
-    Assert(value.size() == fe.n_components(),
-           ExcDimensionMismatch(value.size(), fe.n_components()));
-    // If for some reason, the point is not found in any cell,
-    // or it is on a cell that is not locally owned, return 0.
-    if (cell_point.first == dof_handler.end() ||
-        !cell_point.first->is_locally_owned())
+    const LocalValues a(acceleration), v(velocity), d(displacement),
+      a_n(previous_acceleration), v_n(previous_velocity),
+      d_n(previous_displacement);
+    AssertDimension(a.size(), v.size());
+    AssertDimension(a.size(), d.size());
+    AssertDimension(a.size(), a_n.size());
+    AssertDimension(a.size(), v_n.size());
+    AssertDimension(a.size(), d_n.size());
+    const double cva_n = (1 - gamma) * dt, cva = gamma * dt;
+    const double cda_n = (0.5 - beta) * dt * dt, cda = beta * dt * dt;
+    for (std::size_t i = 0; i < a.size(); ++i)
       {
-        value = 0;
-        return;
+        // The previous state is read before it is overwritten.
+        const double new_v = v_n[i] + cva_n * a_n[i] + cva * a[i];
+        const double new_d =
+          d_n[i] + dt * v_n[i] + cda_n * a_n[i] + cda * a[i];
+        v[i] = new_v;
+        d[i] = new_d;
+        a_n[i] = a[i];
+        v_n[i] = new_v;
+        d_n[i] = new_d;
       }
-    Assert(GeometryInfo<dim>::distance_to_unit_cell(cell_point.second) < 1e-10,
-           ExcInternalError());
-
-    const Quadrature<dim> quadrature(
-      GeometryInfo<dim>::project_to_unit_cell(cell_point.second));
-    FEValues<dim> fe_values(mapping, fe, quadrature, update_values);
-    fe_values.reinit(cell_point.first);
-    std::vector<Vector<Number>> u_value(1, Vector<Number>(fe.n_components()));
-    fe_values.get_function_values(fe_function, u_value);
-    value = u_value[0];
   }
 
-  template <int dim, typename VectorType>
-  void GridInterpolator<dim, VectorType>::point_gradient(
-    const VectorType &fe_function,
-    std::vector<Tensor<1, dim, typename VectorType::value_type>> &gradient)
+  template <typename VectorType>
+  void NewmarkUpdate::correct_from_displacement(
+    const VectorType &displacement,
+    const VectorType &predicted_displacement,
+    VectorType &acceleration,
+    VectorType &velocity,
+    const VectorType &previous_acceleration,
+    const VectorType &previous_velocity) const
   {
-    typedef typename VectorType::value_type Number;
-    const FiniteElement<dim> &fe = dof_handler.get_fe();
-    Assert(gradient.size() == fe.n_components(),
-           ExcDimensionMismatch(gradient.size(), fe.n_components()));
-    // If for some reason, the point is not found in any cell,
-    // or it is on a cell that is not locally owned, return 0.
-    if (cell_point.first == dof_handler.end() ||
-        !cell_point.first->is_locally_owned())
+    const LocalValues d(displacement), d_p(predicted_displacement),
+      a(acceleration), v(velocity), a_n(previous_acceleration),
+      v_n(previous_velocity);
+    AssertDimension(d.size(), d_p.size());
+    AssertDimension(d.size(), a.size());
+    AssertDimension(d.size(), v.size());
+    AssertDimension(d.size(), a_n.size());
+    AssertDimension(d.size(), v_n.size());
+    const double cd = 1 / (beta * dt * dt);
+    const double cva_n = (1 - gamma) * dt, cva = gamma * dt;
+    for (std::size_t i = 0; i < d.size(); ++i)
       {
-        for (auto &v : gradient)
-          {
-            v = 0;
-          }
-        return;
+        const double new_a = cd * (d[i] - d_p[i]);
+        a[i] = new_a;
+        v[i] = v_n[i] + cva_n * a_n[i] + cva * new_a;
       }
-    Assert(GeometryInfo<dim>::distance_to_unit_cell(cell_point.second) < 1e-10,
-           ExcInternalError());
+  }
 
-    const Quadrature<dim> quadrature(
-      GeometryInfo<dim>::project_to_unit_cell(cell_point.second));
-    FEValues<dim> fe_values(mapping, fe, quadrature, update_gradients);
-    fe_values.reinit(cell_point.first);
-    std::vector<std::vector<Tensor<1, dim, Number>>> u_gradient(
-      1, std::vector<Tensor<1, dim, Number>>(fe.n_components()));
-    fe_values.get_function_gradients(fe_function, u_gradient);
-    gradient = u_gradient[0];
+  template <typename VectorType>
+  void NewmarkUpdate::correct_from_displacement(
+    const VectorType &displacement,
+    const VectorType &predicted_displacement,
+    VectorType &acceleration,
+    VectorType &velocity,
+    VectorType &previous_acceleration,
+    VectorType &previous_velocity,
+    VectorType &previous_displacement) const
+  {
+    const LocalValues d(displacement), d_p(predicted_displacement),
+      a(acceleration), v(velocity), a_n(previous_acceleration),
+      v_n(previous_velocity), d_n(previous_displacement);
+    AssertDimension(d.size(), d_p.size());
+    AssertDimension(d.size(), a.size());
+    AssertDimension(d.size(), v.size());
+    AssertDimension(d.size(), a_n.size());
+    AssertDimension(d.size(), v_n.size());
+    AssertDimension(d.size(), d_n.size());
+    const double cd = 1 / (beta * dt * dt);
+    const double cva_n = (1 - gamma) * dt, cva = gamma * dt;
+    for (std::size_t i = 0; i < d.size(); ++i)
+      {
+        const double new_a = cd * (d[i] - d_p[i]);
+        const double new_v = v_n[i] + cva_n * a_n[i] + cva * new_a;
+        a[i] = new_a;
+        v[i] = new_v;
+        a_n[i] = new_a;
+        v_n[i] = new_v;
+        d_n[i] = d[i];
+      }
   }
 
-  template <int dim, typename VectorType>
-  const typename DoFHandler<dim>::active_cell_iterator
-  GridInterpolator<dim, VectorType>::get_cell() const
+  CouplingAccelerator::CouplingAccelerator(const std::string &method,
+                                           const double initial_relaxation,
+                                           const unsigned int max_columns)
+    : method(method),
+      initial_relaxation(initial_relaxation),
+      max_columns(max_columns),
+      iteration(0),
+      relaxation(initial_relaxation)
   {
-    return cell_point.first;
+    AssertThrow(method == "aitken" || method == "iqn-ils",
+                ExcMessage("Unknown coupling acceleration " + method + "!"));
   }
 
-  template <int dim, typename MeshType>
-  CellLocator<dim, MeshType>::CellLocator(
-    DoFHandler<dim> &dh,
-    const Point<dim> &p,
-    const typename MeshType::active_cell_iterator &hint)
-    : dof_handler(dh), point(p), hint(hint), cell_found(true)
+  void CouplingAccelerator::reset()
   {
+    iteration = 0;
+    relaxation = initial_relaxation;
+    residual_differences.clear();
+    output_differences.clear();
   }
 
-  template <int dim, typename MeshType>
-  const typename MeshType::active_cell_iterator
-  CellLocator<dim, MeshType>::search()
+  double CouplingAccelerator::next(const Vector<double> &input,
+                                   const Vector<double> &output,
+                                   Vector<double> &next_input)
   {
-    // If the hint is the begin iterator we do not use BFS.
-    if (hint == dof_handler.begin_active())
+    AssertDimension(input.size(), output.size());
+    Vector<double> residual(output);
+    residual -= input;
+    const double output_norm = output.l2_norm();
+    const double relative_residual =
+      residual.l2_norm() / (output_norm > 0 ? output_norm : 1.0);
+
+    next_input = input;
+    if (method == "aitken")
       {
-        MappingQ1<dim> mapping;
-        return (GridTools::find_active_cell_around_point(
-                  mapping, dof_handler, point))
-          .first;
+        if (iteration > 0)
+          {
+            Vector<double> difference(residual);
+            difference -= previous_residual;
+            const double denominator = difference * difference;
+            if (denominator > 0)
+              {
+                relaxation *= -(previous_residual * difference) / denominator;
+              }
+          }
+        next_input.add(relaxation, residual);
       }
-    // Create an unordered set to store the flagged cells
-    std::unordered_set<std::string> flag_table;
-    std::queue<typename MeshType::active_cell_iterator> cell_queue;
-    // Start with the hint cell
-    cell_queue.push(hint);
-    while (!cell_queue.empty())
+    else
       {
-        auto current_cell = cell_queue.front();
-        flag_table.insert(current_cell->id().to_string());
-        cell_queue.pop();
-        // If the point is inside current cell then we are done.
-        if (current_cell->point_inside(point))
+        if (iteration > 0)
+          {
+            residual_differences.push_front(residual);
+            residual_differences.front() -= previous_residual;
+            output_differences.push_front(output);
+            output_differences.front() -= previous_output;
+            if (residual_differences.size() > max_columns)
+              {
+                residual_differences.pop_back();
+                output_differences.pop_back();
+              }
+          }
+        // Least squares min |V c + r| with the modified Gram-Schmidt QR of
+        // the residual differences, dropping the columns that nearly depend
+        // on the preceding, more recent ones.
+        std::vector<Vector<double>> q;
+        std::vector<unsigned int> columns;
+        FullMatrix<double> r(residual_differences.size());
+        for (unsigned int j = 0; j < residual_differences.size(); ++j)
+          {
+            Vector<double> v(residual_differences[j]);
+            const double norm = v.l2_norm();
+            for (unsigned int i = 0; i < q.size(); ++i)
+              {
+                r(i, q.size()) = q[i] * v;
+                v.add(-r(i, q.size()), q[i]);
+              }
+            const double v_norm = v.l2_norm();
+            if (v_norm <= 1e-10 * norm || norm == 0)
+              {
+                continue;
+              }
+            r(q.size(), q.size()) = v_norm;
+            v /= v_norm;
+            q.push_back(v);
+            columns.push_back(j);
+          }
+        if (q.empty())
           {
-            return current_cell;
+            next_input.add(initial_relaxation, residual);
           }
-        std::vector<typename MeshType::active_cell_iterator> neightbors;
-        // Get all the active neighbors!
-        GridTools::get_active_neighbors<MeshType>(current_cell, neightbors);
-        for (unsigned int i = 0; i < neightbors.size(); ++i)
+        else
           {
-            // Push all the unflagged cells into the queue
-            if (flag_table.find(neightbors[i]->id().to_string()) ==
-                flag_table.end())
+            // Back substitution of R c = -Q^T r, then x = H(x) + W c.
+            const unsigned int n = q.size();
+            std::vector<double> c(n);
+            for (unsigned int i = n; i-- > 0;)
+              {
+                c[i] = -(q[i] * residual);
+                for (unsigned int j = i + 1; j < n; ++j)
+                  {
+                    c[i] -= r(i, j) * c[j];
+                  }
+                c[i] /= r(i, i);
+              }
+            next_input = output;
+            for (unsigned int i = 0; i < n; ++i)
               {
-                cell_queue.push(neightbors[i]);
-                flag_table.insert(neightbors[i]->id().to_string());
+                next_input.add(c[i], output_differences[columns[i]]);
               }
           }
       }
-    // If the queue is already empty, we failed in finding the cell
-    cell_found = false;
+    previous_residual = residual;
+    previous_output = output;
+    ++iteration;
+    return relative_residual;
+  }
+
+  bool
+  SparsityCache::matches(const std::vector<unsigned long long> &state) const
+  {
+    return n_patterns > 0 && key == state;
+  }
+
+  void SparsityCache::store(
+    const std::vector<unsigned long long> &state,
+    const std::vector<IndexSet> &owned_partitioning,
+    const std::vector<const BlockDynamicSparsityPattern *> &patterns)
+  {
+    clear();
+    key = state;
+    n_patterns = patterns.size();
+    n_blocks = owned_partitioning.size();
+    for (const auto pattern : patterns)
+      {
+        AssertDimension(pattern->n_block_rows(), n_blocks);
+        for (unsigned int i = 0; i < n_blocks; ++i)
+          {
+            for (unsigned int j = 0; j < n_blocks; ++j)
+              {
+                const DynamicSparsityPattern &block = pattern->block(i, j);
+                row_offsets.emplace_back(1, 0);
+                columns.emplace_back();
+                auto &offsets = row_offsets.back();
+                auto &cols = columns.back();
+                for (const auto row : owned_partitioning[i])
+                  {
+                    const auto length = block.row_length(row);
+                    for (types::global_dof_index k = 0; k < length; ++k)
+                      {
+                        cols.push_back(block.column_number(row, k));
+                      }
+                    offsets.push_back(cols.size());
+                  }
+              }
+          }
+      }
+  }
+
+  void
+  SparsityCache::restore(const unsigned int pattern,
+                         const std::vector<IndexSet> &owned_partitioning,
+                         BlockDynamicSparsityPattern &dsp) const
+  {
+    AssertIndexRange(pattern, n_patterns);
+    AssertDimension(owned_partitioning.size(), n_blocks);
+    for (unsigned int i = 0; i < n_blocks; ++i)
+      {
+        for (unsigned int j = 0; j < n_blocks; ++j)
+          {
+            const unsigned int b = (pattern * n_blocks + i) * n_blocks + j;
+            const auto &offsets = row_offsets[b];
+            const auto &cols = columns[b];
+            AssertDimension(offsets.size(),
+                            owned_partitioning[i].n_elements() + 1);
+            unsigned int r = 0;
+            for (const auto row : owned_partitioning[i])
+              {
+                // The columns of a DynamicSparsityPattern row are sorted.
+                dsp.block(i, j).add_entries(row,
+                                            cols.begin() + offsets[r],
+                                            cols.begin() + offsets[r + 1],
+                                            true);
+                ++r;
+              }
+          }
+      }
+  }
+
+  void SparsityCache::save(const std::string &filename) const
+  {
+    std::ofstream out(filename, std::ios::binary);
+    AssertThrow(out, ExcIO());
+    auto write = [&out](const auto &v) {
+      const std::size_t size = v.size();
+      out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+      out.write(reinterpret_cast<const char *>(v.data()),
+                size * sizeof(v[0]));
+    };
+    out.write(reinterpret_cast<const char *>(&n_patterns), sizeof(n_patterns));
+    out.write(reinterpret_cast<const char *>(&n_blocks), sizeof(n_blocks));
+    write(key);
+    for (unsigned int b = 0; b < row_offsets.size(); ++b)
+      {
+        write(row_offsets[b]);
+        write(columns[b]);
+      }
+    AssertThrow(out, ExcIO());
+  }
+
+  void SparsityCache::load(const std::string &filename)
+  {
+    clear();
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+      {
+        return;
+      }
+    auto read = [&in](auto &v) {
+      std::size_t size = 0;
+      in.read(reinterpret_cast<char *>(&size), sizeof(size));
+      if (in)
+        {
+          v.resize(size);
+          in.read(reinterpret_cast<char *>(v.data()), size * sizeof(v[0]));
+        }
+    };
+    unsigned int patterns = 0;
+    in.read(reinterpret_cast<char *>(&patterns), sizeof(patterns));
+    in.read(reinterpret_cast<char *>(&n_blocks), sizeof(n_blocks));
+    read(key);
+    const unsigned int n = patterns * n_blocks * n_blocks;
+    row_offsets.resize(n);
+    columns.resize(n);
+    for (unsigned int b = 0; b < n && in; ++b)
+      {
+        read(row_offsets[b]);
+        read(columns[b]);
+      }
+    if (!in)
+      {
+        // A truncated file is as good as none.
+        clear();
+        return;
+      }
+    n_patterns = patterns;
+  }
+
+  void SparsityCache::clear()
+  {
+    key.clear();
+    n_patterns = 0;
+    n_blocks = 0;
+    row_offsets.clear();
+    columns.clear();
+  }
+
+  std::size_t SparsityCache::memory_consumption() const
+  {
+    return MemoryConsumption::memory_consumption(key) +
+           MemoryConsumption::memory_consumption(row_offsets) +
+           MemoryConsumption::memory_consumption(columns);
+  }
+
+  template <typename VectorType>
+  GenericVectorPool<VectorType>::Handle::Handle(GenericVectorPool &p,
+                                                const unsigned int b)
+    : pool(p), block(b)
+  {
+    AssertIndexRange(block, pool.partitioning.size());
+    if (pool.available[block].empty())
+      {
+        pool.vectors[block].emplace_back(
+          new VectorType(pool.partitioning[block], pool.mpi_communicator));
+        pool.available[block].push_back(pool.vectors[block].back().get());
+      }
+    vector = pool.available[block].back();
+    pool.available[block].pop_back();
+  }
+
+  template <typename VectorType>
+  GenericVectorPool<VectorType>::Handle::~Handle()
+  {
+    pool.available[block].push_back(vector);
+  }
+
+  template <typename VectorType>
+  void GenericVectorPool<VectorType>::reinit(
+    const std::vector<IndexSet> &owned_partitioning, const MPI_Comm &comm)
+  {
+    for (unsigned int i = 0; i < vectors.size(); ++i)
+      {
+        Assert(available[i].size() == vectors[i].size(),
+               ExcMessage("Vectors of the pool are still in use!"));
+      }
+    partitioning = owned_partitioning;
+    mpi_communicator = comm;
+    vectors.clear();
+    vectors.resize(partitioning.size());
+    available.clear();
+    available.resize(partitioning.size());
+  }
+
+  NodeSharedVectors::NodeSharedVectors(const MPI_Comm &comm)
+    : mpi_communicator(comm),
+      node_communicator(MPI_COMM_NULL),
+      leader_communicator(MPI_COMM_NULL),
+      window(MPI_WIN_NULL),
+      data(nullptr),
+      n_vectors(0),
+      vector_size(0)
+  {
+  }
+
+  NodeSharedVectors::~NodeSharedVectors()
+  {
+    if (window != MPI_WIN_NULL)
+      {
+        MPI_Win_unlock_all(window);
+        MPI_Win_free(&window);
+      }
+    if (leader_communicator != MPI_COMM_NULL)
+      {
+        MPI_Comm_free(&leader_communicator);
+      }
+    if (node_communicator != MPI_COMM_NULL)
+      {
+        MPI_Comm_free(&node_communicator);
+      }
+  }
+
+  void NodeSharedVectors::allocate(const unsigned int n,
+                                   const std::size_t size)
+  {
+    int ierr;
+    if (node_communicator == MPI_COMM_NULL)
+      {
+        ierr = MPI_Comm_split_type(mpi_communicator,
+                                   MPI_COMM_TYPE_SHARED,
+                                   0,
+                                   MPI_INFO_NULL,
+                                   &node_communicator);
+        AssertThrowMPI(ierr);
+        const bool node_leader =
+          Utilities::MPI::this_mpi_process(node_communicator) == 0;
+        ierr = MPI_Comm_split(mpi_communicator,
+                              node_leader ? 0 : MPI_UNDEFINED,
+                              0,
+                              &leader_communicator);
+        AssertThrowMPI(ierr);
+      }
+    if (window != MPI_WIN_NULL)
+      {
+        ierr = MPI_Win_unlock_all(window);
+        AssertThrowMPI(ierr);
+        ierr = MPI_Win_free(&window);
+        AssertThrowMPI(ierr);
+      }
+    // Only the leader allocates the memory, the others map its segment.
+    const bool leader = leader_communicator != MPI_COMM_NULL;
+    const MPI_Aint bytes = leader ? n * size * sizeof(double) : 0;
+    ierr = MPI_Win_allocate_shared(bytes,
+                                   sizeof(double),
+                                   MPI_INFO_NULL,
+                                   node_communicator,
+                                   &data,
+                                   &window);
+    AssertThrowMPI(ierr);
+    if (!leader)
+      {
+        MPI_Aint segment_size;
+        int displacement_unit;
+        ierr = MPI_Win_shared_query(
+          window, 0, &segment_size, &displacement_unit, &data);
+        AssertThrowMPI(ierr);
+      }
+    ierr = MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+    AssertThrowMPI(ierr);
+    n_vectors = n;
+    vector_size = size;
+  }
+
+  void NodeSharedVectors::synchronize() const
+  {
+    int ierr = MPI_Win_sync(window);
+    AssertThrowMPI(ierr);
+    ierr = MPI_Barrier(node_communicator);
+    AssertThrowMPI(ierr);
+    ierr = MPI_Win_sync(window);
+    AssertThrowMPI(ierr);
+  }
+
+  void NodeSharedVectors::localize(
+    const std::vector<const PETScWrappers::MPI::Vector *> &vectors)
+  {
+    Assert(!vectors.empty(), ExcMessage("No vectors to localize!"));
+    const std::size_t size = vectors[0]->size();
+    // Whether anything has changed must be decided collectively, since the
+    // localization is.
+    bool changed = vectors.size() != n_vectors || size != vector_size;
+    std::vector<Vec> current_vectors(vectors.size());
+    std::vector<PetscObjectState> current_states(vectors.size());
+    for (unsigned int k = 0; k < vectors.size(); ++k)
+      {
+        AssertDimension(vectors[k]->size(), size);
+        current_vectors[k] = *vectors[k];
+        PetscErrorCode ierr = PetscObjectStateGet(
+          reinterpret_cast<PetscObject>(current_vectors[k]),
+          &current_states[k]);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+    changed = changed || current_vectors != last_vectors ||
+              current_states != last_states;
+    if (Utilities::MPI::max(static_cast<int>(changed), mpi_communicator) == 0)
+      {
+        return;
+      }
+    if (vectors.size() != n_vectors || size != vector_size)
+      {
+        allocate(vectors.size(), size);
+      }
+
+    const bool leader = leader_communicator != MPI_COMM_NULL;
+    if (leader)
+      {
+        std::fill(data, data + n_vectors * vector_size, 0.0);
+      }
+    synchronize();
+    for (unsigned int k = 0; k < n_vectors; ++k)
+      {
+        const auto range = vectors[k]->local_range();
+        const PetscScalar *values;
+        PetscErrorCode ierr = VecGetArrayRead(current_vectors[k], &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+        std::copy(values,
+                  values + (range.second - range.first),
+                  data + k * vector_size + range.first);
+        ierr = VecRestoreArrayRead(current_vectors[k], &values);
+        AssertThrow(ierr == 0, ExcPETScError(ierr));
+      }
+    synchronize();
+    if (leader)
+      {
+        const int ierr = MPI_Allreduce(MPI_IN_PLACE,
+                                       data,
+                                       n_vectors * vector_size,
+                                       MPI_DOUBLE,
+                                       MPI_SUM,
+                                       leader_communicator);
+        AssertThrowMPI(ierr);
+      }
+    synchronize();
+    last_vectors = current_vectors;
+    last_states = current_states;
+  }
+
+  ArrayView<const double> NodeSharedVectors::
+                          operator[](const unsigned int k) const
+  {
+    AssertIndexRange(k, n_vectors);
+    return ArrayView<const double>(data + k * vector_size, vector_size);
+  }
+
+  template <int dim>
+  void CellGeometryCache<dim>::reinit(const DoFHandler<dim> &dof_handler,
+                                      const Quadrature<dim> &quadrature,
+                                      const double budget,
+                                      const MPI_Comm &comm)
+  {
+    clear();
+    initialized = true;
+    n_q_points = quadrature.size();
+    const unsigned int n_cells =
+      dof_handler.get_triangulation().n_locally_owned_active_cells();
+    const double size =
+      static_cast<double>(n_cells) * n_q_points *
+        (sizeof(Tensor<2, dim>) + sizeof(double) + sizeof(Point<dim>)) +
+      dof_handler.get_triangulation().n_active_cells() * sizeof(unsigned int);
+    // All or none of the processes cache, so that the assembly is equally
+    // fast everywhere.
+    if (budget <= 0 || Utilities::MPI::max(size, comm) > budget * 1024 * 1024)
+      {
+        return;
+      }
+
+    positions.assign(dof_handler.get_triangulation().n_active_cells(),
+                     numbers::invalid_unsigned_int);
+    inverse_jacobian_values.reserve(n_cells * n_q_points);
+    JxW_values.reserve(n_cells * n_q_points);
+    quadrature_point_values.reserve(n_cells * n_q_points);
+    FEValues<dim> fe_values(dof_handler.get_fe(),
+                            quadrature,
+                            update_inverse_jacobians | update_JxW_values |
+                              update_quadrature_points);
+    unsigned int position = 0;
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      {
+        if (!cell->is_locally_owned())
+          {
+            continue;
+          }
+        fe_values.reinit(cell);
+        positions[cell->active_cell_index()] = position++;
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            inverse_jacobian_values.push_back(
+              Tensor<2, dim>(fe_values.inverse_jacobian(q)));
+            JxW_values.push_back(fe_values.JxW(q));
+            quadrature_point_values.push_back(fe_values.quadrature_point(q));
+          }
+      }
+  }
+
+  template <int dim>
+  void CellGeometryCache<dim>::clear()
+  {
+    initialized = false;
+    n_q_points = 0;
+    positions.clear();
+    inverse_jacobian_values.clear();
+    JxW_values.clear();
+    quadrature_point_values.clear();
+  }
+
+  template <int dim>
+  std::size_t CellGeometryCache<dim>::memory_consumption() const
+  {
+    return MemoryConsumption::memory_consumption(positions) +
+           MemoryConsumption::memory_consumption(inverse_jacobian_values) +
+           MemoryConsumption::memory_consumption(JxW_values) +
+           MemoryConsumption::memory_consumption(quadrature_point_values);
+  }
+
+  template <int dim, int spacedim>
+  std::vector<PETScWrappers::MPI::Vector>
+  rigid_body_modes(const DoFHandler<dim, spacedim> &dof_handler,
+                   const IndexSet &owned_dofs,
+                   const MPI_Comm &comm)
+  {
+    const unsigned int n_rotations = spacedim * (spacedim - 1) / 2;
+    std::vector<PETScWrappers::MPI::Vector> modes(
+      spacedim + n_rotations, PETScWrappers::MPI::Vector(owned_dofs, comm));
+    for (auto &mode : modes)
+      {
+        mode = 0;
+      }
+
+    const MappingQ1<dim, spacedim> mapping;
+    const auto &fe = dof_handler.get_fe();
+    const auto &unit_points = fe.get_unit_support_points();
+    std::vector<types::global_dof_index> dof_indices(fe.dofs_per_cell);
+    for (auto cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell)
+      {
+        if (cell->is_artificial())
+          {
+            continue;
+          }
+        cell->get_dof_indices(dof_indices);
+        for (unsigned int i = 0; i < fe.dofs_per_cell; ++i)
+          {
+            if (!owned_dofs.is_element(dof_indices[i]))
+              {
+                continue;
+              }
+            const unsigned int c = fe.system_to_component_index(i).first;
+            const Point<spacedim> x =
+              mapping.transform_unit_to_real_cell(cell, unit_points[i]);
+            modes[c][dof_indices[i]] = 1;
+            // The rotation in the (a, b) plane moves component a by -x_b and
+            // component b by x_a.
+            unsigned int r = spacedim;
+            for (unsigned int a = 0; a < spacedim; ++a)
+              {
+                for (unsigned int b = a + 1; b < spacedim; ++b, ++r)
+                  {
+                    if (c == a)
+                      {
+                        modes[r][dof_indices[i]] = -x[b];
+                      }
+                    else if (c == b)
+                      {
+                        modes[r][dof_indices[i]] = x[a];
+                      }
+                  }
+              }
+          }
+      }
+    for (auto &mode : modes)
+      {
+        mode.compress(VectorOperation::insert);
+      }
+    return modes;
+  }
+
+  template <int dim, typename VectorType>
+  SPHInterpolator<dim, VectorType>::SPHInterpolator(
+    const DoFHandler<dim> &dof_handler, const Point<dim> &point)
+    : dof_handler(dof_handler), target(point)
+  {
+    for (auto cell : dof_handler.active_cell_iterators())
+      {
+        if (!cell->is_locally_owned())
+          continue;
+        Point<dim> center = cell->center();
+        double h = cell->diameter();
+        double kernel_value = cubic_spline(center, target, h);
+        if (kernel_value > 1e-12)
+          {
+            sources.push_back({cell, kernel_value});
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  SPHInterpolator<dim, VectorType>::SPHInterpolator(
+    const DoFHandler<dim> &dof_handler,
+    const Point<dim> &point,
+    const SPHSourceCells<dim> &source_cells)
+    : dof_handler(dof_handler), target(point)
+  {
+    std::vector<unsigned int> candidates;
+    source_cells.candidates(target, candidates);
+    // The candidates are sorted, so are the sources.
+    for (auto i : candidates)
+      {
+        const auto &cell = source_cells.cell(i);
+        double kernel_value =
+          cubic_spline(cell->center(), target, cell->diameter());
+        if (kernel_value > 1e-12)
+          {
+            sources.push_back({cell, kernel_value});
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  double SPHInterpolator<dim, VectorType>::cubic_spline(const Point<dim> &pi,
+                                                        const Point<dim> &pj,
+                                                        double h)
+  {
+    double w(0.);
+    double q = pi.distance(pj) / h;
+    // M_1_PI = 1 / pi
+    double coef = (dim == 2 ? 10 * M_1_PI / (7 * h * h) : M_1_PI / (h * h * h));
+    if (q < 2.)
+      {
+        if (q >= 1.)
+          {
+            w = coef * (0.25 * (2 - q) * (2 - q) * (2 - q));
+          }
+        else
+          {
+            w = coef * (1 - 1.5 * q * q + 0.75 * q * q * q);
+          }
+      }
+    return w;
+  }
+
+  template <int dim, typename VectorType>
+  void SPHInterpolator<dim, VectorType>::point_value(
+    const VectorType &fe_function,
+    Vector<typename VectorType::value_type> &value)
+  {
+    typedef typename VectorType::value_type Number;
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    Assert(value.size() == fe.n_components(),
+           ExcDimensionMismatch(value.size(), fe.n_components()));
+
+    // Cell center in unit coordinate system
+    Point<dim> unit_center;
+    for (unsigned int i = 0; i < dim; ++i)
+      unit_center[i] = 0.5;
+    Quadrature<dim> quad(unit_center);
+    MappingQGeneric<dim> mapping(1);
+    FEValues<dim> fe_values(mapping, fe, quad, update_values);
+    value = 0;
+    std::vector<Vector<Number>> u_value(1, Vector<Number>(fe.n_components()));
+    for (auto p : sources)
+      {
+        auto cell = p.first;
+        fe_values.reinit(cell);
+        fe_values.get_function_values(fe_function, u_value);
+        // In SPH interpolation, volume must be multiplied because kernel
+        // function has a unit of LENGTH^{-dim}
+        u_value[0] *= p.second * cell->measure();
+        value += u_value[0];
+      }
+  }
+
+  template <int dim, typename VectorType>
+  void SPHInterpolator<dim, VectorType>::point_gradient(
+    const VectorType &fe_function,
+    std::vector<Tensor<1, dim, typename VectorType::value_type>> &gradient)
+  {
+    typedef typename VectorType::value_type Number;
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    Assert(gradient.size() == fe.n_components(),
+           ExcDimensionMismatch(gradient.size(), fe.n_components()));
+    // Cell center in unit coordinate system
+    Point<dim> unit_center;
+    for (unsigned int i = 0; i < dim; ++i)
+      unit_center[i] = 0.5;
+    Quadrature<dim> quad(unit_center);
+    MappingQGeneric<dim> mapping(1);
+    FEValues<dim> fe_values(mapping, fe, quad, update_gradients);
+    for (unsigned int i = 0; i < gradient.size(); ++i)
+      gradient[i] = 0;
+    std::vector<std::vector<Tensor<1, dim, Number>>> u_gradient(
+      1, std::vector<Tensor<1, dim, Number>>(fe.n_components()));
+    for (auto p : sources)
+      {
+        auto cell = p.first;
+        fe_values.reinit(cell);
+        fe_values.get_function_gradients(fe_function, u_gradient);
+        for (unsigned int i = 0; i < gradient.size(); ++i)
+          {
+            // In SPH interpolation, volume must be multiplied because kernel
+            // function has a unit of LENGTH^{-dim}
+            u_gradient[0][i] *= p.second * cell->measure();
+            gradient[i] += u_gradient[0][i];
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  SPHPointEvaluator<dim, VectorType>::SPHPointEvaluator(
+    const DoFHandler<dim> &dof_handler)
+    : dof_handler(dof_handler), mapping(1), n_points(0)
+  {
+  }
+
+  template <int dim, typename VectorType>
+  void SPHPointEvaluator<dim, VectorType>::reinit(
+    const std::vector<Point<dim>> &points,
+    const SPHSourceCells<dim> &source_cells)
+  {
+    n_points = points.size();
+    cells.clear();
+    cell_weights.clear();
+    std::map<unsigned int, unsigned int> cell_to_group;
+    std::vector<unsigned int> candidates;
+    for (unsigned int i = 0; i < n_points; ++i)
+      {
+        source_cells.candidates(points[i], candidates);
+        for (auto c : candidates)
+          {
+            const auto &cell = source_cells.cell(c);
+            const double w = SPHInterpolator<dim, VectorType>::cubic_spline(
+              cell->center(), points[i], cell->diameter());
+            if (w <= 1e-12)
+              continue;
+            auto group = cell_to_group.find(c);
+            if (group == cell_to_group.end())
+              {
+                group = cell_to_group.insert({c, cells.size()}).first;
+                cells.push_back(cell);
+                cell_weights.emplace_back();
+              }
+            // In SPH interpolation, volume must be multiplied because kernel
+            // function has a unit of LENGTH^{-dim}
+            cell_weights[group->second].push_back({i, w * cell->measure()});
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  void SPHPointEvaluator<dim, VectorType>::evaluate(
+    const VectorType &fe_function,
+    std::vector<Vector<Number>> &values,
+    std::vector<std::vector<Tensor<1, dim, Number>>> &gradients) const
+  {
+    evaluate(fe_function, &values, &gradients);
+  }
+
+  template <int dim, typename VectorType>
+  void SPHPointEvaluator<dim, VectorType>::evaluate(
+    const VectorType &fe_function, std::vector<Vector<Number>> &values) const
+  {
+    evaluate(fe_function, &values, nullptr);
+  }
+
+  template <int dim, typename VectorType>
+  void SPHPointEvaluator<dim, VectorType>::evaluate(
+    const VectorType &fe_function,
+    std::vector<Vector<Number>> *values,
+    std::vector<std::vector<Tensor<1, dim, Number>>> *gradients) const
+  {
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    const unsigned int n_components = fe.n_components();
+    values->assign(n_points, Vector<Number>(n_components));
+    if (gradients)
+      {
+        gradients->assign(
+          n_points, std::vector<Tensor<1, dim, Number>>(n_components));
+      }
+    // Cell center in unit coordinate system
+    Point<dim> unit_center;
+    for (unsigned int i = 0; i < dim; ++i)
+      unit_center[i] = 0.5;
+    const Quadrature<dim> quad(unit_center);
+    FEValues<dim> fe_values(
+      mapping,
+      fe,
+      quad,
+      (gradients ? update_values | update_gradients : update_values));
+    std::vector<Vector<Number>> u_value(1, Vector<Number>(n_components));
+    std::vector<std::vector<Tensor<1, dim, Number>>> u_gradient(
+      1, std::vector<Tensor<1, dim, Number>>(n_components));
+    for (unsigned int c = 0; c < cells.size(); ++c)
+      {
+        fe_values.reinit(cells[c]);
+        fe_values.get_function_values(fe_function, u_value);
+        if (gradients)
+          {
+            fe_values.get_function_gradients(fe_function, u_gradient);
+          }
+        for (auto &p : cell_weights[c])
+          {
+            (*values)[p.first].add(p.second, u_value[0]);
+            if (gradients)
+              {
+                for (unsigned int k = 0; k < n_components; ++k)
+                  {
+                    (*gradients)[p.first][k] += p.second * u_gradient[0][k];
+                  }
+              }
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  GridInterpolator<dim, VectorType>::GridInterpolator(
+    const DoFHandler<dim> &dof_handler,
+    const Point<dim> &point,
+    const std::vector<bool> &mask,
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const Mapping<dim> *deformed_mapping)
+    : dof_handler(dof_handler),
+      point(point),
+      cell_found(true),
+      deformed_mapping(deformed_mapping)
+  {
+    // If the cell is valid we just use the cell
+    if (cell.state() == IteratorState::IteratorStates::valid)
+      {
+        cell_point.first = cell;
+        cell_point.second =
+          mapping().transform_real_to_unit_cell(cell, point);
+        return;
+      }
+    // This function throws an exception of GridTools::ExcPointNotFound if the
+    // point
+    // does not lie in any cell. In this case, we set the cell pointer to null.
+    try
+      {
+        cell_point = GridTools::find_active_cell_around_point(
+          mapping(), dof_handler, point, mask);
+      }
+    catch (GridTools::ExcPointNotFound<dim> &e)
+      {
+        cell_point.first = dof_handler.end();
+        cell_point.second = point;
+        cell_found = false;
+      }
+  }
+
+  template <int dim, typename VectorType>
+  void GridInterpolator<dim, VectorType>::point_value(
+    const VectorType &fe_function,
+    Vector<typename VectorType::value_type> &value)
+  {
+    typedef typename VectorType::value_type Number;
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    Assert(value.size() == fe.n_components(),
+           ExcDimensionMismatch(value.size(), fe.n_components()));
+    // If for some reason, the point is not found in any cell,
+    // or it is on a cell that is not locally owned, return 0.
+    if (cell_point.first == dof_handler.end() ||
+        !cell_point.first->is_locally_owned())
+      {
+        value = 0;
+        return;
+      }
+    Assert(GeometryInfo<dim>::distance_to_unit_cell(cell_point.second) < 1e-10,
+           ExcInternalError());
+
+    const Quadrature<dim> quadrature(
+      GeometryInfo<dim>::project_to_unit_cell(cell_point.second));
+    FEValues<dim> fe_values(mapping(), fe, quadrature, update_values);
+    fe_values.reinit(cell_point.first);
+    std::vector<Vector<Number>> u_value(1, Vector<Number>(fe.n_components()));
+    fe_values.get_function_values(fe_function, u_value);
+    value = u_value[0];
+  }
+
+  template <int dim, typename VectorType>
+  void GridInterpolator<dim, VectorType>::point_value(
+    const ArrayView<const typename VectorType::value_type> &fe_function,
+    Vector<typename VectorType::value_type> &value)
+  {
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    Assert(value.size() == fe.n_components(),
+           ExcDimensionMismatch(value.size(), fe.n_components()));
+    AssertDimension(fe_function.size(), dof_handler.n_dofs());
+    value = 0;
+    if (cell_point.first == dof_handler.end() ||
+        !cell_point.first->is_locally_owned())
+      {
+        return;
+      }
+    Assert(GeometryInfo<dim>::distance_to_unit_cell(cell_point.second) < 1e-10,
+           ExcInternalError());
+
+    const Quadrature<dim> quadrature(
+      GeometryInfo<dim>::project_to_unit_cell(cell_point.second));
+    FEValues<dim> fe_values(mapping(), fe, quadrature, update_values);
+    fe_values.reinit(cell_point.first);
+    std::vector<types::global_dof_index> dof_indices(fe.dofs_per_cell);
+    cell_point.first->get_dof_indices(dof_indices);
+    for (unsigned int i = 0; i < fe.dofs_per_cell; ++i)
+      {
+        const unsigned int component = fe.system_to_component_index(i).first;
+        value[component] +=
+          fe_function[dof_indices[i]] * fe_values.shape_value(i, 0);
+      }
+  }
+
+  template <int dim, typename VectorType>
+  void GridInterpolator<dim, VectorType>::point_gradient(
+    const VectorType &fe_function,
+    std::vector<Tensor<1, dim, typename VectorType::value_type>> &gradient)
+  {
+    typedef typename VectorType::value_type Number;
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    Assert(gradient.size() == fe.n_components(),
+           ExcDimensionMismatch(gradient.size(), fe.n_components()));
+    // If for some reason, the point is not found in any cell,
+    // or it is on a cell that is not locally owned, return 0.
+    if (cell_point.first == dof_handler.end() ||
+        !cell_point.first->is_locally_owned())
+      {
+        for (auto &v : gradient)
+          {
+            v = 0;
+          }
+        return;
+      }
+    Assert(GeometryInfo<dim>::distance_to_unit_cell(cell_point.second) < 1e-10,
+           ExcInternalError());
+
+    const Quadrature<dim> quadrature(
+      GeometryInfo<dim>::project_to_unit_cell(cell_point.second));
+    FEValues<dim> fe_values(mapping(), fe, quadrature, update_gradients);
+    fe_values.reinit(cell_point.first);
+    std::vector<std::vector<Tensor<1, dim, Number>>> u_gradient(
+      1, std::vector<Tensor<1, dim, Number>>(fe.n_components()));
+    fe_values.get_function_gradients(fe_function, u_gradient);
+    gradient = u_gradient[0];
+  }
+
+  template <int dim, typename VectorType>
+  const typename DoFHandler<dim>::active_cell_iterator
+  GridInterpolator<dim, VectorType>::get_cell() const
+  {
+    return cell_point.first;
+  }
+
+  template <int dim, typename VectorType>
+  PointEvaluator<dim, VectorType>::PointEvaluator(
+    const DoFHandler<dim> &dof_handler)
+    : dof_handler(dof_handler),
+      cache(dof_handler.get_triangulation(), mapping),
+      n_points(0),
+      n_missing(0),
+      has_owned_cells(false)
+  {
+  }
+
+  template <int dim, typename VectorType>
+  void
+  PointEvaluator<dim, VectorType>::reinit(const std::vector<Point<dim>> &points,
+                                          const MPI_Comm &mpi_communicator)
+  {
+    const unsigned int n_ranks =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    n_points = points.size();
+    setup_search();
+
+    // Locate the points along a Morton curve, using the last found cell as
+    // the hint since consecutive points are close to each other then.
+    std::vector<unsigned int> owner(n_points, n_ranks);
+    point_cells.assign(n_points,
+                       typename DoFHandler<dim>::active_cell_iterator());
+    point_unit_points.assign(n_points, Point<dim>());
+    typename Triangulation<dim>::active_cell_iterator hint;
+    for (const unsigned int i : morton_order(points))
+      {
+        if (locate(points[i], hint, point_cells[i], point_unit_points[i]))
+          {
+            owner[i] = Utilities::MPI::this_mpi_process(mpi_communicator);
+          }
+      }
+    assign(owner, mpi_communicator);
+  }
+
+  template <int dim, typename VectorType>
+  void
+  PointEvaluator<dim, VectorType>::update(const std::vector<Point<dim>> &points,
+                                          const MPI_Comm &mpi_communicator)
+  {
+    if (marked_vertices.empty())
+      {
+        reinit(points, mpi_communicator);
+        return;
+      }
+    AssertDimension(points.size(), n_points);
+    const unsigned int this_rank =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    const unsigned int n_ranks =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+
+    // Keep the owned points that are still in their cells.
+    std::vector<unsigned int> owner(n_points, n_ranks);
+    for (unsigned int i = 0; i < n_points; ++i)
+      {
+        if (!owned[i])
+          continue;
+        try
+          {
+            const Point<dim> unit_point =
+              mapping.transform_real_to_unit_cell(point_cells[i], points[i]);
+            if (GeometryInfo<dim>::is_inside_unit_cell(unit_point, 1e-10))
+              {
+                owner[i] = this_rank;
+                point_unit_points[i] =
+                  GeometryInfo<dim>::project_to_unit_cell(unit_point);
+              }
+          }
+        catch (typename Mapping<dim>::ExcTransformationFailed &)
+          {
+          }
+      }
+    Utilities::MPI::min(owner, mpi_communicator, owner);
+
+    // Search the others again in the Morton order, starting from their old
+    // cells.
+    typename Triangulation<dim>::active_cell_iterator hint;
+    for (const unsigned int i : morton_order(points))
+      {
+        if (owner[i] != n_ranks)
+          continue;
+        if (point_cells[i].state() == IteratorState::valid)
+          {
+            hint = point_cells[i];
+          }
+        if (locate(points[i], hint, point_cells[i], point_unit_points[i]))
+          {
+            owner[i] = this_rank;
+          }
+      }
+    assign(owner, mpi_communicator);
+  }
+
+  template <int dim, typename VectorType>
+  void PointEvaluator<dim, VectorType>::clear()
+  {
+    n_points = 0;
+    n_missing = 0;
+    owned.clear();
+    marked_vertices.clear();
+    point_cells.clear();
+    point_unit_points.clear();
+    cells.clear();
+    cell_point_indices.clear();
+    cell_unit_points.clear();
+  }
+
+  template <int dim, typename VectorType>
+  void PointEvaluator<dim, VectorType>::setup_search()
+  {
+    // Mark the vertices of the locally owned cells and compute the bounding
+    // box of them to quickly rule out the remote points.
+    marked_vertices.assign(dof_handler.get_triangulation().n_vertices(),
+                           false);
+    has_owned_cells = false;
+    for (auto cell : dof_handler.active_cell_iterators())
+      {
+        if (!cell->is_locally_owned())
+          continue;
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            marked_vertices[cell->vertex_index(v)] = true;
+            if (!has_owned_cells)
+              {
+                lower = upper = cell->vertex(v);
+                has_owned_cells = true;
+              }
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                lower[d] = std::min(lower[d], cell->vertex(v)[d]);
+                upper[d] = std::max(upper[d], cell->vertex(v)[d]);
+              }
+          }
+      }
+  }
+
+  template <int dim, typename VectorType>
+  bool PointEvaluator<dim, VectorType>::locate(
+    const Point<dim> &point,
+    typename Triangulation<dim>::active_cell_iterator &hint,
+    typename DoFHandler<dim>::active_cell_iterator &cell,
+    Point<dim> &unit_point) const
+  {
+    if (!has_owned_cells)
+      return false;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        if (point[d] < lower[d] || point[d] > upper[d])
+          return false;
+      }
+    std::pair<typename Triangulation<dim>::active_cell_iterator, Point<dim>>
+      cell_point;
+    try
+      {
+        cell_point = GridTools::find_active_cell_around_point(
+          cache, point, hint, marked_vertices);
+      }
+    catch (GridTools::ExcPointNotFound<dim> &e)
+      {
+        return false;
+      }
+    if (cell_point.first.state() != IteratorState::valid ||
+        !cell_point.first->is_locally_owned())
+      return false;
+    hint = cell_point.first;
+    cell = typename DoFHandler<dim>::active_cell_iterator(*cell_point.first,
+                                                          &dof_handler);
+    unit_point = GeometryInfo<dim>::project_to_unit_cell(cell_point.second);
+    return true;
+  }
+
+  template <int dim, typename VectorType>
+  void
+  PointEvaluator<dim, VectorType>::assign(std::vector<unsigned int> &owner,
+                                          const MPI_Comm &mpi_communicator)
+  {
+    const unsigned int this_rank =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    const unsigned int n_ranks =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+
+    // The lowest rank that finds a point owns it.
+    Utilities::MPI::min(owner, mpi_communicator, owner);
+
+    owned.assign(n_points, false);
+    n_missing = 0;
+    cells.clear();
+    cell_point_indices.clear();
+    cell_unit_points.clear();
+    std::map<typename DoFHandler<dim>::active_cell_iterator, unsigned int>
+      cell_to_group;
+    for (unsigned int i = 0; i < n_points; ++i)
+      {
+        if (owner[i] == n_ranks)
+          {
+            ++n_missing;
+            continue;
+          }
+        if (owner[i] != this_rank)
+          continue;
+        owned[i] = true;
+        auto group = cell_to_group.find(point_cells[i]);
+        if (group == cell_to_group.end())
+          {
+            group = cell_to_group.insert({point_cells[i], cells.size()}).first;
+            cells.push_back(point_cells[i]);
+            cell_point_indices.emplace_back();
+            cell_unit_points.emplace_back();
+          }
+        cell_point_indices[group->second].push_back(i);
+        cell_unit_points[group->second].push_back(point_unit_points[i]);
+      }
+  }
+
+  template <int dim, typename VectorType>
+  void PointEvaluator<dim, VectorType>::evaluate(
+    const VectorType &fe_function,
+    std::vector<Vector<Number>> &values,
+    std::vector<std::vector<Tensor<1, dim, Number>>> &gradients) const
+  {
+    evaluate(fe_function, &values, &gradients);
+  }
+
+  template <int dim, typename VectorType>
+  void PointEvaluator<dim, VectorType>::evaluate(
+    const VectorType &fe_function, std::vector<Vector<Number>> &values) const
+  {
+    evaluate(fe_function, &values, nullptr);
+  }
+
+  template <int dim, typename VectorType>
+  void PointEvaluator<dim, VectorType>::evaluate(
+    const VectorType &fe_function,
+    std::vector<Vector<Number>> *values,
+    std::vector<std::vector<Tensor<1, dim, Number>>> *gradients) const
+  {
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    const unsigned int n_components = fe.n_components();
+    values->assign(n_points, Vector<Number>(n_components));
+    if (gradients)
+      {
+        gradients->assign(
+          n_points, std::vector<Tensor<1, dim, Number>>(n_components));
+      }
+    const UpdateFlags flags =
+      (gradients ? update_values | update_gradients : update_values);
+    std::vector<Vector<Number>> cell_values;
+    std::vector<std::vector<Tensor<1, dim, Number>>> cell_gradients;
+    for (unsigned int c = 0; c < cells.size(); ++c)
+      {
+        // All the points in this cell are evaluated at once.
+        const Quadrature<dim> quadrature(cell_unit_points[c]);
+        FEValues<dim> fe_values(mapping, fe, quadrature, flags);
+        fe_values.reinit(cells[c]);
+        const unsigned int n_cell_points = quadrature.size();
+        cell_values.resize(n_cell_points, Vector<Number>(n_components));
+        fe_values.get_function_values(fe_function, cell_values);
+        if (gradients)
+          {
+            cell_gradients.resize(
+              n_cell_points,
+              std::vector<Tensor<1, dim, Number>>(n_components));
+            fe_values.get_function_gradients(fe_function, cell_gradients);
+          }
+        for (unsigned int q = 0; q < n_cell_points; ++q)
+          {
+            const unsigned int i = cell_point_indices[c][q];
+            (*values)[i] = cell_values[q];
+            if (gradients)
+              {
+                (*gradients)[i] = cell_gradients[q];
+              }
+          }
+      }
+  }
+
+  template <int dim>
+  std::vector<unsigned int> morton_order(const std::vector<Point<dim>> &points)
+  {
+    std::vector<unsigned int> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (points.size() < 2)
+      {
+        return order;
+      }
+    Point<dim> lower = points[0], upper = points[0];
+    for (const auto &p : points)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            lower[d] = std::min(lower[d], p[d]);
+            upper[d] = std::max(upper[d], p[d]);
+          }
+      }
+    const unsigned int bits = 64 / dim;
+    const double n_steps =
+      static_cast<double>((std::uint64_t(1) << bits) - 1);
+    std::vector<std::uint64_t> codes(points.size());
+    std::array<std::uint64_t, dim> x;
+    for (unsigned int i = 0; i < points.size(); ++i)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            const double extent = upper[d] - lower[d];
+            x[d] = extent > 0 ? static_cast<std::uint64_t>(
+                                  (points[i][d] - lower[d]) / extent * n_steps)
+                              : 0;
+          }
+        std::uint64_t code = 0;
+        for (int b = bits - 1; b >= 0; --b)
+          {
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                code = (code << 1) | ((x[d] >> b) & 1);
+              }
+          }
+        codes[i] = code;
+      }
+    std::sort(order.begin(),
+              order.end(),
+              [&codes](const unsigned int a, const unsigned int b) {
+                return codes[a] < codes[b];
+              });
+    return order;
+  }
+
+  template <int dim, typename MeshType>
+  CellLocator<dim, MeshType>::CellLocator(const MeshType &m)
+    : mesh(m),
+      deformed_mapping(nullptr),
+      cell_found(true),
+      searches(0),
+      bfs_steps(0),
+      epoch(0)
+  {
+  }
+
+  template <int dim, typename MeshType>
+  void CellLocator<dim, MeshType>::set_mapping(const Mapping<dim> &m)
+  {
+    deformed_mapping = &m;
+  }
+
+  template <int dim, typename MeshType>
+  bool CellLocator<dim, MeshType>::inside_deformed(
+    const typename MeshType::active_cell_iterator &cell,
+    const Point<dim> &point) const
+  {
+    // The inverse mapping fails for points far outside of the cell, which
+    // are not inside either.
+    try
+      {
+        return GeometryInfo<dim>::is_inside_unit_cell(
+          deformed_mapping->transform_real_to_unit_cell(cell, point), 1e-10);
+      }
+    catch (const typename Mapping<dim>::ExcTransformationFailed &)
+      {
+        return false;
+      }
+  }
+
+  template <int dim, typename MeshType>
+  void CellLocator<dim, MeshType>::reinit()
+  {
+    const unsigned int n_cells = mesh.get_triangulation().n_active_cells();
+    cells.resize(n_cells);
+    for (auto cell : mesh.active_cell_iterators())
+      {
+        cells[cell->active_cell_index()] = cell;
+      }
+    neighbor_offsets.resize(n_cells + 1);
+    neighbors.clear();
+    std::vector<typename MeshType::active_cell_iterator> active_neighbors;
+    for (unsigned int i = 0; i < n_cells; ++i)
+      {
+        neighbor_offsets[i] = neighbors.size();
+        GridTools::get_active_neighbors<MeshType>(cells[i], active_neighbors);
+        for (auto &neighbor : active_neighbors)
+          {
+            neighbors.push_back(neighbor->active_cell_index());
+          }
+      }
+    neighbor_offsets[n_cells] = neighbors.size();
+    visited.assign(n_cells, 0);
+    epoch = 0;
+    queue.reserve(n_cells);
+  }
+
+  template <int dim, typename MeshType>
+  const typename MeshType::active_cell_iterator
+  CellLocator<dim, MeshType>::search(
+    const Point<dim> &point,
+    const typename MeshType::active_cell_iterator &hint)
+  {
+    cell_found = true;
+    ++searches;
+    // If the hint is the begin iterator we do not use BFS.
+    if (hint == mesh.begin_active())
+      {
+        return (GridTools::find_active_cell_around_point(
+                  deformed_mapping ? *deformed_mapping : mapping, mesh, point))
+          .first;
+      }
+    Assert(cells.size() == mesh.get_triangulation().n_active_cells(),
+           ExcMessage("CellLocator must be reinitialized!"));
+    // Start a new epoch instead of clearing the flags, unless it overflows.
+    if (++epoch == 0)
+      {
+        std::fill(visited.begin(), visited.end(), 0);
+        epoch = 1;
+      }
+    queue.clear();
+    // Start with the hint cell
+    queue.push_back(hint->active_cell_index());
+    visited[queue.back()] = epoch;
+    for (unsigned int head = 0; head < queue.size(); ++head)
+      {
+        const unsigned int current = queue[head];
+        ++bfs_steps;
+        // If the point is inside current cell then we are done.
+        if (deformed_mapping ? inside_deformed(cells[current], point)
+                             : cells[current]->point_inside(point))
+          {
+            return cells[current];
+          }
+        // Push all the unvisited neighbors into the queue
+        for (unsigned int j = neighbor_offsets[current];
+             j < neighbor_offsets[current + 1];
+             ++j)
+          {
+            if (visited[neighbors[j]] != epoch)
+              {
+                visited[neighbors[j]] = epoch;
+                queue.push_back(neighbors[j]);
+              }
+          }
+      }
+    // If the queue is already empty, we failed in finding the cell
+    cell_found = false;
     // Return an invalid iterator
     typename MeshType::active_cell_iterator invalid_itr;
     return invalid_itr;
   }
 
-  // Written by Davis Wells on dealii mailing list.
   template <int dim>
-  void GridCreator<dim>::flow_around_cylinder_2d(Triangulation<2> &tria,
-                                                 bool compute_in_2d)
+  void GridCreator<dim>::flow_around_cylinder_2d(Triangulation<2> &tria,
+                                                 bool compute_in_2d)
+  {
+    flow_around_cylinder_2d_cells(tria, compute_in_2d);
+    flow_around_cylinder_2d_manifolds(tria);
+  }
+
+  // Written by Davis Wells on dealii mailing list.
+  template <int dim>
+  void
+  GridCreator<dim>::flow_around_cylinder_2d_cells(Triangulation<2> &tria,
+                                                  bool compute_in_2d)
+  {
+    double left = compute_in_2d ? 0.0 : -0.3;
+
+    // set up the bulk triangulation
+    Triangulation<2> bulk_triangulation;
+    GridGenerator::subdivided_hyper_rectangle(bulk_triangulation,
+                                              {compute_in_2d ? 22u : 25u, 4u},
+                                              Point<2>(left, 0.0),
+                                              Point<2>(2.2, 0.41));
+    std::set<Triangulation<2>::active_cell_iterator> cells_to_remove;
+    Tensor<1, 2> cylinder_triangulation_offset;
+    for (const auto cell : bulk_triangulation.active_cell_iterators())
+      {
+        if ((cell->center() - Point<2>(0.2, 0.2)).norm() < 0.15)
+          cells_to_remove.insert(cell);
+
+        if (cylinder_triangulation_offset == Point<2>())
+          {
+            for (unsigned int vertex_n = 0;
+                 vertex_n < GeometryInfo<2>::vertices_per_cell;
+                 ++vertex_n)
+              if (cell->vertex(vertex_n) == Point<2>(left, 0.0))
+                {
+                  // skip two cells in the bottom left corner
+                  cylinder_triangulation_offset =
+                    2.0 * (cell->vertex(3) - Point<2>(left, 0.0));
+                  break;
+                }
+          }
+      }
+    Triangulation<2> result_1;
+    GridGenerator::create_triangulation_with_removed_cells(
+      bulk_triangulation, cells_to_remove, result_1);
+
+    // set up the cylinder triangulation
+    Triangulation<2> cylinder_triangulation;
+    GridGenerator::hyper_cube_with_cylindrical_hole(
+      cylinder_triangulation, 0.05, 0.41 / 4.0);
+    GridTools::shift(cylinder_triangulation_offset, cylinder_triangulation);
+    // dumb hack
+    for (const auto cell : cylinder_triangulation.active_cell_iterators())
+      cell->set_material_id(2);
+
+    // merge them together
+    auto minimal_line_length = [](const Triangulation<2> &tria) -> double {
+      double min_line_length = 1000.0;
+
+      for (const auto cell : tria.active_cell_iterators())
+        {
+
+          min_line_length = std::min(
+            min_line_length, (cell->vertex(0) - cell->vertex(1)).norm());
+          min_line_length = std::min(
+            min_line_length, (cell->vertex(0) - cell->vertex(2)).norm());
+          min_line_length = std::min(
+            min_line_length, (cell->vertex(1) - cell->vertex(3)).norm());
+          min_line_length = std::min(
+            min_line_length, (cell->vertex(2) - cell->vertex(3)).norm());
+        }
+      return min_line_length;
+    };
+
+    // the cylindrical triangulation might not match the Cartesian grid: as a
+    // result the vertices might not be lined up. Get around this by deleting
+    // duplicated vertices with a very low numerical tolerance.
+    const double tolerance =
+      std::min(minimal_line_length(result_1),
+               minimal_line_length(cylinder_triangulation)) /
+      2.0;
+
+    GridGenerator::merge_triangulations(
+      result_1, cylinder_triangulation, tria, tolerance);
+  }
+
+  template <int dim>
+  void
+  GridCreator<dim>::flow_around_cylinder_2d_manifolds(Triangulation<2> &tria)
+  {
+    const types::manifold_id tfi_id = 1;
+
+    const types::manifold_id polar_id = 0;
+    for (const auto cell : tria.active_cell_iterators())
+
+      {
+        // set all non-boundary manifold ids to the new TFI manifold id.
+
+        if (cell->material_id() == 2)
+          {
+
+            cell->set_manifold_id(tfi_id);
+            for (unsigned int face_n = 0;
+                 face_n < GeometryInfo<2>::faces_per_cell;
+                 ++face_n)
+              {
+
+                if (cell->face(face_n)->at_boundary())
+                  cell->face(face_n)->set_manifold_id(polar_id);
+                else
+                  cell->face(face_n)->set_manifold_id(tfi_id);
+              }
+          }
+      }
+
+    PolarManifold<2> polar_manifold(Point<2>(0.2, 0.2));
+    tria.set_manifold(polar_id, polar_manifold);
+    TransfiniteInterpolationManifold<2> inner_manifold;
+    inner_manifold.initialize(tria);
+    tria.set_manifold(tfi_id, inner_manifold);
+
+    std::vector<Point<2> *> inner_pointers;
+    for (const auto cell : tria.active_cell_iterators())
+      {
+
+        for (unsigned int face_n = 0; face_n < GeometryInfo<2>::faces_per_cell;
+             ++face_n)
+          {
+
+            if (cell->face(face_n)->manifold_id() == polar_id)
+              {
+                inner_pointers.push_back(&cell->face(face_n)->vertex(0));
+                inner_pointers.push_back(&cell->face(face_n)->vertex(1));
+              }
+          }
+      }
+    // de-duplicate
+    std::sort(inner_pointers.begin(), inner_pointers.end());
+    inner_pointers.erase(
+      std::unique(inner_pointers.begin(), inner_pointers.end()),
+      inner_pointers.end());
+
+    // find the current center...
+    Point<2> center;
+    for (const Point<2> *const ptr : inner_pointers)
+      center += *ptr / double(inner_pointers.size());
+
+    // and recenter at (0.2, 0.2)
+    for (Point<2> *const ptr : inner_pointers)
+      *ptr += Point<2>(0.2, 0.2) - center;
+
+    Point<2> center2;
+    for (const Point<2> *const ptr : inner_pointers)
+      center2 += *ptr / double(inner_pointers.size());
+  }
+
+  template <>
+  void GridCreator<2>::flow_around_cylinder_boundary_ids(Triangulation<2> &tria)
+  {
+    // Set the left boundary (inflow) to 0, the right boundary (outflow) to 1,
+    // upper to 2, lower to 3 and the cylindrical surface to 4.
+    for (Triangulation<2>::active_cell_iterator cell = tria.begin();
+         cell != tria.end();
+         ++cell)
+      {
+        for (unsigned int f = 0; f < GeometryInfo<2>::faces_per_cell; ++f)
+          {
+            if (cell->face(f)->at_boundary())
+              {
+                if (std::abs(cell->face(f)->center()[0] - 2.2) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(1);
+                  }
+                else if (std::abs(cell->face(f)->center()[0] - 0.0) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(0);
+                  }
+                else if (std::abs(cell->face(f)->center()[1] - 0.41) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(3);
+                  }
+                else if (std::abs(cell->face(f)->center()[1]) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(2);
+                  }
+                else
+                  {
+                    cell->face(f)->set_all_boundary_ids(4);
+                  }
+              }
+          }
+      }
+  }
+
+  template <>
+  void GridCreator<3>::flow_around_cylinder_boundary_ids(Triangulation<3> &tria)
+  {
+    // Set boundaries in x direction to 0 and 1; y direction to 2 and 3;
+    // z direction to 4 and 5; the cylindrical surface 6.
+    for (Triangulation<3>::active_cell_iterator cell = tria.begin();
+         cell != tria.end();
+         ++cell)
+      {
+        for (unsigned int f = 0; f < GeometryInfo<3>::faces_per_cell; ++f)
+          {
+            if (cell->face(f)->at_boundary())
+              {
+                if (std::abs(cell->face(f)->center()[0] - 2.2) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(1);
+                  }
+                else if (std::abs(cell->face(f)->center()[0] + 0.3) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(0);
+                  }
+                else if (std::abs(cell->face(f)->center()[1] - 0.41) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(3);
+                  }
+                else if (std::abs(cell->face(f)->center()[1]) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(2);
+                  }
+                else if (std::abs(cell->face(f)->center()[2] - 0.41) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(5);
+                  }
+                else if (std::abs(cell->face(f)->center()[2]) < 1e-12)
+                  {
+                    cell->face(f)->set_all_boundary_ids(4);
+                  }
+                else
+                  {
+                    cell->face(f)->set_all_boundary_ids(6);
+                  }
+              }
+          }
+      }
+  }
+
+  template <int dim>
+  void GridCreator<dim>::broadcast_coarse_mesh(const Triangulation<dim> &coarse,
+                                               Triangulation<dim> &tria,
+                                               const MPI_Comm &mpi_communicator)
+  {
+    const bool root = (Utilities::MPI::this_mpi_process(mpi_communicator) == 0);
+    // The numbers of vertices, cells and boundary faces with nonzero ids.
+    unsigned int sizes[3] = {0, 0, 0};
+    std::vector<double> coordinates;
+    // The vertex indices and the material id of every cell, and of the
+    // boundary faces.
+    std::vector<unsigned int> cell_data;
+    std::vector<unsigned int> face_data;
+    const unsigned int n_cell_data = GeometryInfo<dim>::vertices_per_cell + 1;
+    const unsigned int n_face_data = GeometryInfo<dim>::vertices_per_face + 1;
+    if (root)
+      {
+        Assert(coarse.n_levels() == 1, ExcMessage("Only coarse meshes!"));
+        sizes[0] = coarse.n_vertices();
+        sizes[1] = coarse.n_active_cells();
+        for (auto &v : coarse.get_vertices())
+          {
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                coordinates.push_back(v[d]);
+              }
+          }
+        for (auto cell : coarse.active_cell_iterators())
+          {
+            for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell;
+                 ++v)
+              {
+                cell_data.push_back(cell->vertex_index(v));
+              }
+            cell_data.push_back(cell->material_id());
+            for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell;
+                 ++f)
+              {
+                if (cell->face(f)->at_boundary() &&
+                    cell->face(f)->boundary_id() != 0)
+                  {
+                    for (unsigned int v = 0;
+                         v < GeometryInfo<dim>::vertices_per_face;
+                         ++v)
+                      {
+                        face_data.push_back(cell->face(f)->vertex_index(v));
+                      }
+                    face_data.push_back(cell->face(f)->boundary_id());
+                  }
+              }
+          }
+        sizes[2] = face_data.size() / n_face_data;
+      }
+    int ierr = MPI_Bcast(sizes, 3, MPI_UNSIGNED, 0, mpi_communicator);
+    AssertThrowMPI(ierr);
+    coordinates.resize(sizes[0] * dim);
+    cell_data.resize(sizes[1] * n_cell_data);
+    face_data.resize(sizes[2] * n_face_data);
+    ierr = MPI_Bcast(coordinates.data(),
+                     coordinates.size(),
+                     MPI_DOUBLE,
+                     0,
+                     mpi_communicator);
+    AssertThrowMPI(ierr);
+    ierr = MPI_Bcast(cell_data.data(),
+                     cell_data.size(),
+                     MPI_UNSIGNED,
+                     0,
+                     mpi_communicator);
+    AssertThrowMPI(ierr);
+    ierr = MPI_Bcast(face_data.data(),
+                     face_data.size(),
+                     MPI_UNSIGNED,
+                     0,
+                     mpi_communicator);
+    AssertThrowMPI(ierr);
+
+    std::vector<Point<dim>> vertices(sizes[0]);
+    for (unsigned int i = 0; i < sizes[0]; ++i)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            vertices[i][d] = coordinates[i * dim + d];
+          }
+      }
+    std::vector<CellData<dim>> cells(sizes[1]);
+    for (unsigned int i = 0; i < sizes[1]; ++i)
+      {
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            cells[i].vertices[v] = cell_data[i * n_cell_data + v];
+          }
+        cells[i].material_id = cell_data[(i + 1) * n_cell_data - 1];
+      }
+    // The faces of the other boundary ids, which are lines in 2D and quads
+    // in 3D.
+    SubCellData boundary;
+    for (unsigned int i = 0; i < sizes[2]; ++i)
+      {
+        const unsigned int *data = &face_data[i * n_face_data];
+        if (dim == 2)
+          {
+            CellData<1> line;
+            line.vertices[0] = data[0];
+            line.vertices[1] = data[1];
+            line.boundary_id = data[2];
+            boundary.boundary_lines.push_back(line);
+          }
+        else
+          {
+            CellData<2> quad;
+            for (unsigned int v = 0; v < 4; ++v)
+              {
+                quad.vertices[v] = data[v];
+              }
+            quad.boundary_id = data[4];
+            boundary.boundary_quads.push_back(quad);
+          }
+      }
+    // The cells are taken from a valid triangulation, so they are already
+    // oriented consistently.
+    tria.create_triangulation(vertices, cells, boundary);
+  }
+
+  template <int dim>
+  void GridCreator<dim>::read_msh(
+    parallel::distributed::Triangulation<dim> &tria,
+    const std::string &filename)
+  {
+    const MPI_Comm &mpi_communicator = tria.get_communicator();
+    Triangulation<dim> coarse;
+    // All the processes have to know if the file is missing, or the others
+    // would wait for the broadcast forever.
+    int found = 0;
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      {
+        std::ifstream input(filename);
+        found = input.good();
+        if (found)
+          {
+            GridIn<dim> gridin;
+            gridin.attach_triangulation(coarse);
+            gridin.read_msh(input);
+          }
+      }
+    int ierr = MPI_Bcast(&found, 1, MPI_INT, 0, mpi_communicator);
+    AssertThrowMPI(ierr);
+    AssertThrow(found, ExcFileNotOpen(filename));
+    broadcast_coarse_mesh(coarse, tria, mpi_communicator);
+  }
+
+  // Create 2D triangulation:
+  template <>
+  void GridCreator<2>::flow_around_cylinder(Triangulation<2> &tria)
+  {
+    flow_around_cylinder_2d(tria);
+    flow_around_cylinder_boundary_ids(tria);
+  }
+
+  template <>
+  void GridCreator<2>::flow_around_cylinder(
+    parallel::distributed::Triangulation<2> &tria)
+  {
+    const MPI_Comm &mpi_communicator = tria.get_communicator();
+    Triangulation<2> coarse;
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      {
+        flow_around_cylinder_2d_cells(coarse, true);
+      }
+    broadcast_coarse_mesh(coarse, tria, mpi_communicator);
+    flow_around_cylinder_2d_manifolds(tria);
+    flow_around_cylinder_boundary_ids(tria);
+  }
+
+  // Create 3D triangulation:
+  template <>
+  void GridCreator<3>::flow_around_cylinder(Triangulation<3> &tria)
+  {
+    Triangulation<2> tria_2d;
+    flow_around_cylinder_2d(tria_2d, false);
+    GridGenerator::extrude_triangulation(tria_2d, 9, 0.41, tria);
+    flow_around_cylinder_boundary_ids(tria);
+  }
+
+  template <>
+  void GridCreator<3>::flow_around_cylinder(
+    parallel::distributed::Triangulation<3> &tria)
+  {
+    // The extruded mesh has no manifolds.
+    const MPI_Comm &mpi_communicator = tria.get_communicator();
+    Triangulation<3> coarse;
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      {
+        flow_around_cylinder(coarse);
+      }
+    broadcast_coarse_mesh(coarse, tria, mpi_communicator);
+    flow_around_cylinder_boundary_ids(tria);
+  }
+
+  template <int dim>
+  void GridCreator<dim>::sphere(Triangulation<dim> &tria,
+                                const Point<dim> &center,
+                                double radius)
   {
-    double left = compute_in_2d ? 0.0 : -0.3;
+    SphericalManifold<dim> spherical_manifold(center);
+    TransfiniteInterpolationManifold<dim> inner_manifold;
+    GridGenerator::hyper_ball(tria, center, radius);
+    tria.set_all_manifold_ids(1);
+    tria.set_all_manifold_ids_on_boundary(0);
+    tria.set_manifold(0, spherical_manifold);
+    inner_manifold.initialize(tria);
+    tria.set_manifold(1, inner_manifold);
+  }
 
-    // set up the bulk triangulation
-    Triangulation<2> bulk_triangulation;
-    GridGenerator::subdivided_hyper_rectangle(bulk_triangulation,
-                                              {compute_in_2d ? 22u : 25u, 4u},
-                                              Point<2>(left, 0.0),
-                                              Point<2>(2.2, 0.41));
-    std::set<Triangulation<2>::active_cell_iterator> cells_to_remove;
-    Tensor<1, 2> cylinder_triangulation_offset;
-    for (const auto cell : bulk_triangulation.active_cell_iterators())
+  template <>
+  void GridCreator<2>::cylinder(Triangulation<2> &tria,
+                                const double radius,
+                                const double length)
+  {
+    (void)tria;
+    (void)radius;
+    (void)length;
+    AssertThrow(false, ExcNotImplemented());
+  }
+
+  template <>
+  void GridCreator<3>::cylinder(Triangulation<3> &tria,
+                                const double radius,
+                                const double length)
+  {
+    Triangulation<2> tria2d;
+    Point<2> center(0, 0);
+    GridCreator<2>::sphere(tria2d, center, radius);
+    GridGenerator::extrude_triangulation(
+      tria2d, static_cast<unsigned int>(length / (4 * radius)), length, tria);
+    tria.set_all_manifold_ids_on_boundary(0);
+    for (auto cell = tria.begin(); cell != tria.end(); ++cell)
       {
-        if ((cell->center() - Point<2>(0.2, 0.2)).norm() < 0.15)
-          cells_to_remove.insert(cell);
+        for (unsigned int i = 0; i < GeometryInfo<3>::faces_per_cell; ++i)
+          {
+            if (cell->at_boundary(i))
+              {
+                if (std::abs(cell->face(i)->center()(2)) < 1e-10)
+                  {
+                    cell->face(i)->set_boundary_id(1);
+                    cell->face(i)->set_manifold_id(numbers::flat_manifold_id);
+                  }
+                else if (std::abs(cell->face(i)->center()(2) - length) < 1e-10)
+                  {
+                    cell->face(i)->set_boundary_id(2);
+                    cell->face(i)->set_manifold_id(numbers::flat_manifold_id);
+                  }
+              }
+          }
+      }
+    tria.set_manifold(0, CylindricalManifold<3>(2));
+  }
 
-        if (cylinder_triangulation_offset == Point<2>())
+  template <int dim>
+  typename AABBTree<dim>::Box
+  AABBTree<dim>::bounding_box(const std::vector<Point<dim>> &points)
+  {
+    Assert(!points.empty(), ExcMessage("Empty list of points!"));
+    Box box(points[0], points[0]);
+    for (auto &p : points)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
           {
-            for (unsigned int vertex_n = 0;
-                 vertex_n < GeometryInfo<2>::vertices_per_cell;
-                 ++vertex_n)
-              if (cell->vertex(vertex_n) == Point<2>(left, 0.0))
-                {
-                  // skip two cells in the bottom left corner
-                  cylinder_triangulation_offset =
-                    2.0 * (cell->vertex(3) - Point<2>(left, 0.0));
-                  break;
-                }
+            box.first[d] = std::min(box.first[d], p[d]);
+            box.second[d] = std::max(box.second[d], p[d]);
           }
       }
-    Triangulation<2> result_1;
-    GridGenerator::create_triangulation_with_removed_cells(
-      bulk_triangulation, cells_to_remove, result_1);
+    return box;
+  }
 
-    // set up the cylinder triangulation
-    Triangulation<2> cylinder_triangulation;
-    GridGenerator::hyper_cube_with_cylindrical_hole(
-      cylinder_triangulation, 0.05, 0.41 / 4.0);
-    GridTools::shift(cylinder_triangulation_offset, cylinder_triangulation);
-    // dumb hack
-    for (const auto cell : cylinder_triangulation.active_cell_iterators())
-      cell->set_material_id(2);
+  template <int dim>
+  typename AABBTree<dim>::Box AABBTree<dim>::merge(const Box &a, const Box &b)
+  {
+    Box box(a);
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        box.first[d] = std::min(box.first[d], b.first[d]);
+        box.second[d] = std::max(box.second[d], b.second[d]);
+      }
+    return box;
+  }
 
-    // merge them together
-    auto minimal_line_length = [](const Triangulation<2> &tria) -> double {
-      double min_line_length = 1000.0;
+  template <int dim>
+  bool AABBTree<dim>::contains(const Box &box,
+                               const Point<dim> &point,
+                               const unsigned int skip_axis)
+  {
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        if (d != skip_axis &&
+            (point[d] < box.first[d] || point[d] > box.second[d]))
+          return false;
+      }
+    return true;
+  }
 
-      for (const auto cell : tria.active_cell_iterators())
-        {
+  template <int dim>
+  bool AABBTree<dim>::overlap(const Box &a,
+                              const Box &b,
+                              const unsigned int skip_axis)
+  {
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        if (d != skip_axis &&
+            (a.second[d] < b.first[d] || a.first[d] > b.second[d]))
+          return false;
+      }
+    return true;
+  }
 
-          min_line_length = std::min(
-            min_line_length, (cell->vertex(0) - cell->vertex(1)).norm());
-          min_line_length = std::min(
-            min_line_length, (cell->vertex(0) - cell->vertex(2)).norm());
-          min_line_length = std::min(
-            min_line_length, (cell->vertex(1) - cell->vertex(3)).norm());
-          min_line_length = std::min(
-            min_line_length, (cell->vertex(2) - cell->vertex(3)).norm());
-        }
-      return min_line_length;
-    };
+  template <int dim>
+  void AABBTree<dim>::build(const std::vector<Box> &boxes)
+  {
+    nodes.clear();
+    indices.resize(boxes.size());
+    for (unsigned int i = 0; i < boxes.size(); ++i)
+      {
+        indices[i] = i;
+      }
+    if (boxes.empty())
+      return;
+    std::vector<Point<dim>> centers(boxes.size());
+    for (unsigned int i = 0; i < boxes.size(); ++i)
+      {
+        centers[i] = (boxes[i].first + boxes[i].second) / 2;
+      }
+    // A balanced tree has at most 2n/leaf_size nodes.
+    nodes.reserve(2 * boxes.size() / leaf_size + 1);
+    build_node(0, boxes.size(), boxes, centers);
+    leaf_boxes.resize(boxes.size());
+    for (unsigned int i = 0; i < boxes.size(); ++i)
+      {
+        leaf_boxes[i] = boxes[indices[i]];
+      }
+  }
 
-    // the cylindrical triangulation might not match the Cartesian grid: as a
-    // result the vertices might not be lined up. Get around this by deleting
-    // duplicated vertices with a very low numerical tolerance.
-    const double tolerance =
-      std::min(minimal_line_length(result_1),
-               minimal_line_length(cylinder_triangulation)) /
-      2.0;
+  template <int dim>
+  unsigned int AABBTree<dim>::build_node(const unsigned int begin,
+                                         const unsigned int end,
+                                         const std::vector<Box> &boxes,
+                                         const std::vector<Point<dim>> &centers)
+  {
+    const unsigned int current = nodes.size();
+    nodes.push_back(Node());
+    Box box = boxes[indices[begin]];
+    for (unsigned int i = begin + 1; i < end; ++i)
+      {
+        box = merge(box, boxes[indices[i]]);
+      }
+    nodes[current].box = box;
+    nodes[current].begin = begin;
+    nodes[current].end = end;
+    nodes[current].left = numbers::invalid_unsigned_int;
+    nodes[current].right = numbers::invalid_unsigned_int;
+    if (end - begin <= leaf_size)
+      return current;
 
-    GridGenerator::merge_triangulations(
-      result_1, cylinder_triangulation, tria, tolerance);
+    // Split at the median of the centers along the longest axis.
+    unsigned int axis = 0;
+    for (unsigned int d = 1; d < dim; ++d)
+      {
+        if (box.second[d] - box.first[d] >
+            box.second[axis] - box.first[axis])
+          axis = d;
+      }
+    const unsigned int middle = (begin + end) / 2;
+    std::nth_element(indices.begin() + begin,
+                     indices.begin() + middle,
+                     indices.begin() + end,
+                     [&centers, axis](unsigned int a, unsigned int b) {
+                       return centers[a][axis] < centers[b][axis];
+                     });
+    const unsigned int left = build_node(begin, middle, boxes, centers);
+    const unsigned int right = build_node(middle, end, boxes, centers);
+    nodes[current].left = left;
+    nodes[current].right = right;
+    return current;
+  }
 
-    const types::manifold_id tfi_id = 1;
+  template <int dim>
+  void AABBTree<dim>::refit(const std::vector<Box> &boxes)
+  {
+    AssertThrow(boxes.size() == indices.size(),
+                ExcMessage("Number of primitives changed, rebuild the tree!"));
+    for (unsigned int i = 0; i < boxes.size(); ++i)
+      {
+        leaf_boxes[i] = boxes[indices[i]];
+      }
+    // Children are stored after their parents, so a reverse sweep updates
+    // all the children before their parents.
+    for (auto node = nodes.rbegin(); node != nodes.rend(); ++node)
+      {
+        if (node->left == numbers::invalid_unsigned_int)
+          {
+            node->box = leaf_boxes[node->begin];
+            for (unsigned int i = node->begin + 1; i < node->end; ++i)
+              {
+                node->box = merge(node->box, leaf_boxes[i]);
+              }
+          }
+        else
+          {
+            node->box = merge(nodes[node->left].box, nodes[node->right].box);
+          }
+      }
+  }
+
+  template <int dim>
+  void AABBTree<dim>::point_query(const Point<dim> &point,
+                                  std::vector<unsigned int> &hits) const
+  {
+    hits.clear();
+    if (nodes.empty())
+      return;
+    // The depth of a median-split tree is logarithmic in the number of
+    // primitives, so a small fixed-size stack suffices.
+    unsigned int stack[64];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+      {
+        const Node &node = nodes[stack[--top]];
+        if (!contains(node.box, point))
+          continue;
+        if (node.left == numbers::invalid_unsigned_int)
+          {
+            for (unsigned int i = node.begin; i < node.end; ++i)
+              {
+                if (contains(leaf_boxes[i], point))
+                  hits.push_back(indices[i]);
+              }
+          }
+        else
+          {
+            Assert(top + 2 <= 64, ExcInternalError());
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+          }
+      }
+  }
+
+  template <int dim>
+  void AABBTree<dim>::ray_query(const Point<dim> &point,
+                                const unsigned int axis,
+                                std::vector<unsigned int> &hits) const
+  {
+    ray_query(Box(point, point), axis, hits);
+  }
+
+  template <int dim>
+  void AABBTree<dim>::ray_query(const Box &box,
+                                const unsigned int axis,
+                                std::vector<unsigned int> &hits) const
+  {
+    Assert(axis < dim, ExcIndexRange(axis, 0, dim));
+    hits.clear();
+    if (nodes.empty())
+      return;
+    unsigned int stack[64];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+      {
+        const Node &node = nodes[stack[--top]];
+        // The swept region intersects the node if they overlap in the
+        // transverse directions, and the region does not start beyond it.
+        if (box.first[axis] > node.box.second[axis] ||
+            !overlap(node.box, box, axis))
+          continue;
+        if (node.left == numbers::invalid_unsigned_int)
+          {
+            for (unsigned int i = node.begin; i < node.end; ++i)
+              {
+                if (box.first[axis] <= leaf_boxes[i].second[axis] &&
+                    overlap(leaf_boxes[i], box, axis))
+                  hits.push_back(indices[i]);
+              }
+          }
+        else
+          {
+            Assert(top + 2 <= 64, ExcInternalError());
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+          }
+      }
+  }
+
+  template <int dim>
+  bool AABBTree<dim>::intersects(const Box &box) const
+  {
+    if (nodes.empty())
+      return false;
+    unsigned int stack[64];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+      {
+        const Node &node = nodes[stack[--top]];
+        if (!overlap(node.box, box))
+          continue;
+        if (node.left == numbers::invalid_unsigned_int)
+          {
+            for (unsigned int i = node.begin; i < node.end; ++i)
+              {
+                if (overlap(leaf_boxes[i], box))
+                  return true;
+              }
+          }
+        else
+          {
+            Assert(top + 2 <= 64, ExcInternalError());
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+          }
+      }
+    return false;
+  }
+
+  template <int dim>
+  void ClosedSurface::reinit(const Triangulation<dim> &tria)
+  {
+    AssertThrow(dim == 3, ExcNotImplemented());
+    triangle_vertices.clear();
+    for (auto cell = tria.begin_active(); cell != tria.end(); ++cell)
+      {
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+          {
+            if (!cell->face(f)->at_boundary())
+              continue;
+            // The vertices are numbered lexicographically on the face, so
+            // 0-1-3-2 goes around it. Flip the order if the normal given by
+            // the right-hand rule points into the cell.
+            std::array<unsigned int, 4> v;
+            std::array<Point<3>, 4> x;
+            for (unsigned int i = 0; i < 4; ++i)
+              {
+                v[i] = cell->face(f)->vertex_index(i);
+                for (unsigned int d = 0; d < dim; ++d)
+                  {
+                    x[i][d] = cell->face(f)->vertex(i)[d];
+                  }
+              }
+            Tensor<1, 3> outward;
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                outward[d] = cell->face(f)->center()[d] - cell->center()[d];
+              }
+            if (cross_product_3d(x[1] - x[0], x[2] - x[0]) * outward < 0)
+              {
+                std::swap(v[1], v[2]);
+              }
+            triangle_vertices.push_back({{v[0], v[1], v[3]}});
+            triangle_vertices.push_back({{v[0], v[3], v[2]}});
+          }
+      }
+    triangles.resize(triangle_vertices.size());
+    tree = AABBTree<3>();
+    update(tria);
+    std::vector<AABBTree<3>::Box> boxes(triangles.size());
+    for (unsigned int i = 0; i < triangles.size(); ++i)
+      {
+        boxes[i] = AABBTree<3>::bounding_box(
+          {triangles[i][0], triangles[i][1], triangles[i][2]});
+      }
+    tree.build(boxes);
+  }
 
-    const types::manifold_id polar_id = 0;
-    for (const auto cell : tria.active_cell_iterators())
+  template <int dim>
+  void ClosedSurface::update(const Triangulation<dim> &tria)
+  {
+    update(tria.get_vertices());
+  }
 
+  template <int dim>
+  void ClosedSurface::update(const std::vector<Point<dim>> &vertices)
+  {
+    AssertThrow(dim == 3, ExcNotImplemented());
+    std::vector<AABBTree<3>::Box> boxes(triangles.size());
+    for (unsigned int i = 0; i < triangles.size(); ++i)
       {
-        // set all non-boundary manifold ids to the new TFI manifold id.
-
-        if (cell->material_id() == 2)
+        for (unsigned int v = 0; v < 3; ++v)
           {
-
-            cell->set_manifold_id(tfi_id);
-            for (unsigned int face_n = 0;
-                 face_n < GeometryInfo<2>::faces_per_cell;
-                 ++face_n)
+            for (unsigned int d = 0; d < dim; ++d)
               {
-
-                if (cell->face(face_n)->at_boundary())
-                  cell->face(face_n)->set_manifold_id(polar_id);
-                else
-                  cell->face(face_n)->set_manifold_id(tfi_id);
+                triangles[i][v][d] = vertices[triangle_vertices[i][v]][d];
               }
           }
+        boxes[i] = AABBTree<3>::bounding_box(
+          {triangles[i][0], triangles[i][1], triangles[i][2]});
       }
+    diameter = 0;
+    if (!boxes.empty())
+      {
+        Point<3> lower = boxes[0].first, upper = boxes[0].second;
+        for (auto &box : boxes)
+          {
+            for (unsigned int d = 0; d < 3; ++d)
+              {
+                lower[d] = std::min(lower[d], box.first[d]);
+                upper[d] = std::max(upper[d], box.second[d]);
+              }
+          }
+        diameter = lower.distance(upper);
+      }
+    // The tree is only refitted when it has been built.
+    if (!tree.empty())
+      {
+        tree.refit(boxes);
+      }
+  }
 
-    PolarManifold<2> polar_manifold(Point<2>(0.2, 0.2));
-    tria.set_manifold(polar_id, polar_manifold);
-    TransfiniteInterpolationManifold<2> inner_manifold;
-    inner_manifold.initialize(tria);
-    tria.set_manifold(tfi_id, inner_manifold);
-
-    std::vector<Point<2> *> inner_pointers;
-    for (const auto cell : tria.active_cell_iterators())
+  template <int dim>
+  bool ClosedSurface::point_inside(const Point<dim> &p) const
+  {
+    AssertThrow(dim == 3, ExcNotImplemented());
+    Point<3> point;
+    for (unsigned int d = 0; d < dim; ++d)
       {
+        point[d] = p[d];
+      }
+    for (unsigned int axis = 0; axis < 3; ++axis)
+      {
+        RayResult result = cast_ray(point, axis);
+        if (result == on_surface)
+          return true;
+        if (result != ambiguous)
+          return result == odd;
+      }
+    // The winding number is 1/2 on the surface.
+    return std::abs(winding_number(point)) > 0.5 - 1e-8;
+  }
 
-        for (unsigned int face_n = 0; face_n < GeometryInfo<2>::faces_per_cell;
-             ++face_n)
+  ClosedSurface::RayResult ClosedSurface::cast_ray(const Point<3> &point,
+                                                   const unsigned int axis) const
+  {
+    // Tolerances for the barycentric coordinates and the distance
+    const double eps = 1e-10;
+    const double tol = 1e-12 * diameter;
+    Tensor<1, 3> direction;
+    direction[axis] = 1.0;
+    unsigned int crossings = 0;
+    bool is_ambiguous = false;
+    std::vector<unsigned int> &candidates = this->candidates.get();
+    tree.ray_query(point, axis, candidates);
+    // Moller-Trumbore ray-triangle intersection
+    for (auto i : candidates)
+      {
+        const Point<3> &a = triangles[i][0];
+        const Tensor<1, 3> edge1 = triangles[i][1] - a;
+        const Tensor<1, 3> edge2 = triangles[i][2] - a;
+        const Tensor<1, 3> pvec = cross_product_3d(direction, edge2);
+        const double det = edge1 * pvec;
+        const Tensor<1, 3> tvec = point - a;
+        if (std::abs(det) <= eps * edge1.norm() * edge2.norm())
           {
-
-            if (cell->face(face_n)->manifold_id() == polar_id)
+            // The ray is parallel to the triangle, it is ambiguous only if the
+            // ray is in the plane of the triangle, unless the point itself is
+            // on the triangle.
+            const Tensor<1, 3> normal = cross_product_3d(edge1, edge2);
+            const double area2 = normal * normal;
+            if (std::abs(tvec * normal) <= tol * normal.norm())
               {
-                inner_pointers.push_back(&cell->face(face_n)->vertex(0));
-                inner_pointers.push_back(&cell->face(face_n)->vertex(1));
+                const double u = cross_product_3d(tvec, edge2) * normal / area2;
+                const double v = cross_product_3d(edge1, tvec) * normal / area2;
+                if (u >= -eps && v >= -eps && u + v <= 1 + eps)
+                  return on_surface;
+                is_ambiguous = true;
               }
+            continue;
+          }
+        const double u = (tvec * pvec) / det;
+        if (u < -eps || u > 1 + eps)
+          continue;
+        const Tensor<1, 3> qvec = cross_product_3d(tvec, edge1);
+        const double v = (direction * qvec) / det;
+        if (v < -eps || u + v > 1 + eps)
+          continue;
+        const double t = (edge2 * qvec) / det;
+        if (std::abs(t) <= tol)
+          return on_surface;
+        if (t < 0)
+          continue;
+        // Hitting an edge or a vertex, which may be counted more than once.
+        if (u < eps || v < eps || u + v > 1 - eps)
+          {
+            is_ambiguous = true;
+            continue;
           }
+        ++crossings;
       }
-    // de-duplicate
-    std::sort(inner_pointers.begin(), inner_pointers.end());
-    inner_pointers.erase(
-      std::unique(inner_pointers.begin(), inner_pointers.end()),
-      inner_pointers.end());
+    if (is_ambiguous)
+      return ambiguous;
+    return (crossings % 2 == 0 ? even : odd);
+  }
 
-    // find the current center...
-    Point<2> center;
-    for (const Point<2> *const ptr : inner_pointers)
-      center += *ptr / double(inner_pointers.size());
+  double ClosedSurface::winding_number(const Point<3> &point) const
+  {
+    // Solid angle of each triangle by Van Oosterom and Strackee (1983)
+    double w = 0;
+    for (auto &triangle : triangles)
+      {
+        const Tensor<1, 3> a = triangle[0] - point;
+        const Tensor<1, 3> b = triangle[1] - point;
+        const Tensor<1, 3> c = triangle[2] - point;
+        const double la = a.norm(), lb = b.norm(), lc = c.norm();
+        const double numerator = a * cross_product_3d(b, c);
+        const double denominator =
+          la * lb * lc + (a * b) * lc + (a * c) * lb + (b * c) * la;
+        w += 2 * std::atan2(numerator, denominator);
+      }
+    return w / (4 * numbers::PI);
+  }
 
-    // and recenter at (0.2, 0.2)
-    for (Point<2> *const ptr : inner_pointers)
-      *ptr += Point<2>(0.2, 0.2) - center;
+  template <int dim>
+  void SPHSourceCells<dim>::reinit(const DoFHandler<dim> &dof_handler)
+  {
+    cells.clear();
+    std::vector<typename CellLinkedList<dim>::Box> boxes;
+    for (auto cell : dof_handler.active_cell_iterators())
+      {
+        if (!cell->is_locally_owned())
+          continue;
+        const Point<dim> center = cell->center();
+        const double radius = 2 * cell->diameter();
+        Point<dim> lower = center, upper = center;
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            lower[d] -= radius;
+            upper[d] += radius;
+          }
+        cells.push_back(cell);
+        boxes.push_back({lower, upper});
+      }
+    buckets.build(boxes);
+  }
 
-    Point<2> center2;
-    for (const Point<2> *const ptr : inner_pointers)
-      center2 += *ptr / double(inner_pointers.size());
+  template <int dim>
+  void
+  SPHSourceCells<dim>::candidates(const Point<dim> &point,
+                                  std::vector<unsigned int> &indices) const
+  {
+    buckets.point_query(point, indices);
   }
 
-  // Create 2D triangulation:
-  template <>
-  void GridCreator<2>::flow_around_cylinder(Triangulation<2> &tria)
+  template <int dim>
+  void CellLinkedList<dim>::build(const std::vector<Box> &boxes,
+                                  double bucket_size)
   {
-    flow_around_cylinder_2d(tria);
-    // Set the left boundary (inflow) to 0, the right boundary (outflow) to 1,
-    // upper to 2, lower to 3 and the cylindrical surface to 4.
-    for (Triangulation<2>::active_cell_iterator cell = tria.begin();
-         cell != tria.end();
-         ++cell)
+    buckets.clear();
+    ranges.clear();
+    if (boxes.empty())
+      return;
+
+    Box extent(boxes[0]);
+    double mean_extent = 0;
+    for (auto &box : boxes)
       {
-        for (unsigned int f = 0; f < GeometryInfo<2>::faces_per_cell; ++f)
+        double box_extent = 0;
+        for (unsigned int d = 0; d < dim; ++d)
           {
-            if (cell->face(f)->at_boundary())
-              {
-                if (std::abs(cell->face(f)->center()[0] - 2.2) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(1);
-                  }
-                else if (std::abs(cell->face(f)->center()[0] - 0.0) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(0);
-                  }
-                else if (std::abs(cell->face(f)->center()[1] - 0.41) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(3);
-                  }
-                else if (std::abs(cell->face(f)->center()[1]) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(2);
-                  }
-                else
-                  {
-                    cell->face(f)->set_all_boundary_ids(4);
-                  }
-              }
+            extent.first[d] = std::min(extent.first[d], box.first[d]);
+            extent.second[d] = std::max(extent.second[d], box.second[d]);
+            box_extent = std::max(box_extent, box.second[d] - box.first[d]);
+          }
+        mean_extent += box_extent / boxes.size();
+      }
+    size = bucket_size > 0 ? bucket_size : mean_extent;
+    // Degenerate boxes, e.g. points
+    if (size <= 0)
+      {
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            size = std::max(size, extent.second[d] - extent.first[d]);
           }
+        size = size > 0 ? size / boxes.size() : 1;
+      }
+    origin = extent.first;
+    while (true)
+      {
+        double n_total = 1;
+        for (unsigned int d = 0; d < dim; ++d)
+          {
+            n_buckets[d] = static_cast<unsigned int>(
+                             (extent.second[d] - extent.first[d]) / size) +
+                           1;
+            n_total *= n_buckets[d];
+          }
+        if (n_total <= 4.0 * boxes.size())
+          break;
+        size *= 2;
+      }
+
+    unsigned int n_total = 1;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        n_total *= n_buckets[d];
+      }
+    buckets.resize(n_total);
+    ranges.resize(boxes.size());
+    for (unsigned int i = 0; i < boxes.size(); ++i)
+      {
+        ranges[i] = bucket_range(boxes[i]);
+        insert(i, ranges[i]);
       }
   }
 
-  // Create 3D triangulation:
-  template <>
-  void GridCreator<3>::flow_around_cylinder(Triangulation<3> &tria)
+  template <int dim>
+  void CellLinkedList<dim>::update(const std::vector<Box> &boxes)
   {
-    Triangulation<2> tria_2d;
-    flow_around_cylinder_2d(tria_2d, false);
-    GridGenerator::extrude_triangulation(tria_2d, 9, 0.41, tria);
-    // Set boundaries in x direction to 0 and 1; y direction to 2 and 3;
-    // z direction to 4 and 5; the cylindrical surface 6.
-    for (Triangulation<3>::active_cell_iterator cell = tria.begin();
-         cell != tria.end();
-         ++cell)
+    AssertDimension(boxes.size(), ranges.size());
+    for (unsigned int i = 0; i < boxes.size(); ++i)
       {
-        for (unsigned int f = 0; f < GeometryInfo<3>::faces_per_cell; ++f)
+        const Range range = bucket_range(boxes[i]);
+        if (range != ranges[i])
           {
-            if (cell->face(f)->at_boundary())
+            remove(i, ranges[i]);
+            insert(i, range);
+            ranges[i] = range;
+          }
+      }
+  }
+
+  template <int dim>
+  void CellLinkedList<dim>::query(const Box &box,
+                                  std::vector<unsigned int> &items) const
+  {
+    items.clear();
+    if (empty())
+      return;
+    const Range range = bucket_range(box);
+    std::array<unsigned int, dim> index;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        index[d] = range[d];
+      }
+    // Loop over the buckets in the range like an odometer.
+    while (true)
+      {
+        const auto &bucket = buckets[bucket_index(index)];
+        items.insert(items.end(), bucket.begin(), bucket.end());
+        unsigned int d = 0;
+        for (; d < dim; ++d)
+          {
+            if (index[d] < range[dim + d])
               {
-                if (std::abs(cell->face(f)->center()[0] - 2.2) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(1);
-                  }
-                else if (std::abs(cell->face(f)->center()[0] + 0.3) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(0);
-                  }
-                else if (std::abs(cell->face(f)->center()[1] - 0.41) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(3);
-                  }
-                else if (std::abs(cell->face(f)->center()[1]) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(2);
-                  }
-                else if (std::abs(cell->face(f)->center()[2] - 0.41) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(5);
-                  }
-                else if (std::abs(cell->face(f)->center()[2]) < 1e-12)
-                  {
-                    cell->face(f)->set_all_boundary_ids(4);
-                  }
-                else
-                  {
-                    cell->face(f)->set_all_boundary_ids(6);
-                  }
+                ++index[d];
+                break;
               }
+            index[d] = range[d];
           }
+        if (d == dim)
+          break;
       }
+    // An item can be in several of the buckets.
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
   }
 
   template <int dim>
-  void GridCreator<dim>::sphere(Triangulation<dim> &tria,
-                                const Point<dim> &center,
-                                double radius)
+  void CellLinkedList<dim>::point_query(const Point<dim> &point,
+                                        std::vector<unsigned int> &items) const
   {
-    SphericalManifold<dim> spherical_manifold(center);
-    TransfiniteInterpolationManifold<dim> inner_manifold;
-    GridGenerator::hyper_ball(tria, center, radius);
-    tria.set_all_manifold_ids(1);
-    tria.set_all_manifold_ids_on_boundary(0);
-    tria.set_manifold(0, spherical_manifold);
-    inner_manifold.initialize(tria);
-    tria.set_manifold(1, inner_manifold);
+    query(Box(point, point), items);
   }
 
-  template <>
-  void GridCreator<2>::cylinder(Triangulation<2> &tria,
-                                const double radius,
-                                const double length)
+  template <int dim>
+  typename CellLinkedList<dim>::Range
+  CellLinkedList<dim>::bucket_range(const Box &box) const
   {
-    (void)tria;
-    (void)radius;
-    (void)length;
-    AssertThrow(false, ExcNotImplemented());
+    Range range;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        // Clamping is monotone, so overlapping boxes still share a bucket.
+        auto clamp = [&](const double x) {
+          const double i = std::floor((x - origin[d]) / size);
+          return static_cast<unsigned int>(
+            std::min(std::max(i, 0.0), n_buckets[d] - 1.0));
+        };
+        range[d] = clamp(box.first[d]);
+        range[dim + d] = clamp(box.second[d]);
+      }
+    return range;
   }
 
-  template <>
-  void GridCreator<3>::cylinder(Triangulation<3> &tria,
-                                const double radius,
-                                const double length)
+  template <int dim>
+  unsigned int CellLinkedList<dim>::bucket_index(
+    const std::array<unsigned int, dim> &index) const
   {
-    Triangulation<2> tria2d;
-    Point<2> center(0, 0);
-    GridCreator<2>::sphere(tria2d, center, radius);
-    GridGenerator::extrude_triangulation(
-      tria2d, static_cast<unsigned int>(length / (4 * radius)), length, tria);
-    tria.set_all_manifold_ids_on_boundary(0);
-    for (auto cell = tria.begin(); cell != tria.end(); ++cell)
+    unsigned int i = index[dim - 1];
+    for (int d = dim - 2; d >= 0; --d)
       {
-        for (unsigned int i = 0; i < GeometryInfo<3>::faces_per_cell; ++i)
+        i = i * n_buckets[d] + index[d];
+      }
+    return i;
+  }
+
+  template <int dim>
+  void CellLinkedList<dim>::insert(const unsigned int item, const Range &range)
+  {
+    std::array<unsigned int, dim> index;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        index[d] = range[d];
+      }
+    while (true)
+      {
+        buckets[bucket_index(index)].push_back(item);
+        unsigned int d = 0;
+        for (; d < dim; ++d)
           {
-            if (cell->at_boundary(i))
+            if (index[d] < range[dim + d])
               {
-                if (std::abs(cell->face(i)->center()(2)) < 1e-10)
-                  {
-                    cell->face(i)->set_boundary_id(1);
-                    cell->face(i)->set_manifold_id(numbers::flat_manifold_id);
-                  }
-                else if (std::abs(cell->face(i)->center()(2) - length) < 1e-10)
-                  {
-                    cell->face(i)->set_boundary_id(2);
-                    cell->face(i)->set_manifold_id(numbers::flat_manifold_id);
-                  }
+                ++index[d];
+                break;
               }
+            index[d] = range[d];
           }
+        if (d == dim)
+          break;
+      }
+  }
+
+  template <int dim>
+  void CellLinkedList<dim>::remove(const unsigned int item, const Range &range)
+  {
+    std::array<unsigned int, dim> index;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        index[d] = range[d];
+      }
+    while (true)
+      {
+        auto &bucket = buckets[bucket_index(index)];
+        bucket.erase(std::find(bucket.begin(), bucket.end(), item));
+        unsigned int d = 0;
+        for (; d < dim; ++d)
+          {
+            if (index[d] < range[dim + d])
+              {
+                ++index[d];
+                break;
+              }
+            index[d] = range[d];
+          }
+        if (d == dim)
+          break;
       }
-    tria.set_manifold(0, CylindricalManifold<3>(2));
   }
 
+  template class CellGeometryCache<2>;
+  template class CellGeometryCache<3>;
   template class GridCreator<2>;
   template class GridCreator<3>;
   template class GridInterpolator<2, Vector<double>>;
   template class GridInterpolator<3, Vector<double>>;
   template class GridInterpolator<2, BlockVector<double>>;
   template class GridInterpolator<3, BlockVector<double>>;
+  template class GridInterpolator<2, PETScWrappers::MPI::Vector>;
+  template class GridInterpolator<3, PETScWrappers::MPI::Vector>;
   template class GridInterpolator<2, PETScWrappers::MPI::BlockVector>;
   template class GridInterpolator<3, PETScWrappers::MPI::BlockVector>;
+  template class PointEvaluator<2, BlockVector<double>>;
+  template class PointEvaluator<3, BlockVector<double>>;
+  template class PointEvaluator<2, PETScWrappers::MPI::BlockVector>;
+  template class PointEvaluator<3, PETScWrappers::MPI::BlockVector>;
+  template class GenericVectorPool<PETScWrappers::MPI::Vector>;
   template class SPHInterpolator<2, Vector<double>>;
   template class SPHInterpolator<3, Vector<double>>;
   template class SPHInterpolator<2, PETScWrappers::MPI::BlockVector>;
   template class SPHInterpolator<3, PETScWrappers::MPI::BlockVector>;
+  template class SPHPointEvaluator<2, Vector<double>>;
+  template class SPHPointEvaluator<3, Vector<double>>;
+  template class SPHPointEvaluator<2, PETScWrappers::MPI::BlockVector>;
+  template class SPHPointEvaluator<3, PETScWrappers::MPI::BlockVector>;
+  template std::vector<unsigned int>
+  morton_order(const std::vector<Point<2>> &);
+  template std::vector<unsigned int>
+  morton_order(const std::vector<Point<3>> &);
   template class Utils::CellLocator<2, DoFHandler<2, 2>>;
   template class Utils::CellLocator<3, DoFHandler<3, 3>>;
+  template class AABBTree<2>;
+  template class AABBTree<3>;
+  template class CellLinkedList<2>;
+  template class CellLinkedList<3>;
+  template class SPHSourceCells<2>;
+  template class SPHSourceCells<3>;
+  template std::vector<PETScWrappers::MPI::Vector>
+  rigid_body_modes(const DoFHandler<2, 2> &,
+                   const IndexSet &,
+                   const MPI_Comm &);
+  template std::vector<PETScWrappers::MPI::Vector>
+  rigid_body_modes(const DoFHandler<3, 3> &,
+                   const IndexSet &,
+                   const MPI_Comm &);
+  template std::vector<PETScWrappers::MPI::Vector>
+  rigid_body_modes(const DoFHandler<2, 3> &,
+                   const IndexSet &,
+                   const MPI_Comm &);
+  template void NewmarkUpdate::predict(Vector<double> &,
+                                       const Vector<double> &,
+                                       const Vector<double> &,
+                                       const Vector<double> &) const;
+  template void
+  NewmarkUpdate::predict(PETScWrappers::MPI::Vector &,
+                         const PETScWrappers::MPI::Vector &,
+                         const PETScWrappers::MPI::Vector &,
+                         const PETScWrappers::MPI::Vector &) const;
+  template void NewmarkUpdate::predict(PETScWrappers::MPI::Vector &,
+                                       PETScWrappers::MPI::Vector &,
+                                       const PETScWrappers::MPI::Vector &,
+                                       const PETScWrappers::MPI::Vector &,
+                                       const PETScWrappers::MPI::Vector &,
+                                       const double) const;
+  template void NewmarkUpdate::correct(const Vector<double> &,
+                                       Vector<double> &,
+                                       Vector<double> &,
+                                       Vector<double> &,
+                                       Vector<double> &,
+                                       Vector<double> &) const;
+  template void NewmarkUpdate::correct(const PETScWrappers::MPI::Vector &,
+                                       PETScWrappers::MPI::Vector &,
+                                       PETScWrappers::MPI::Vector &,
+                                       PETScWrappers::MPI::Vector &,
+                                       PETScWrappers::MPI::Vector &,
+                                       PETScWrappers::MPI::Vector &) const;
+  template void
+  NewmarkUpdate::correct_from_displacement(const Vector<double> &,
+                                           const Vector<double> &,
+                                           Vector<double> &,
+                                           Vector<double> &,
+                                           const Vector<double> &,
+                                           const Vector<double> &) const;
+  template void NewmarkUpdate::correct_from_displacement(
+    const PETScWrappers::MPI::Vector &,
+    const PETScWrappers::MPI::Vector &,
+    PETScWrappers::MPI::Vector &,
+    PETScWrappers::MPI::Vector &,
+    const PETScWrappers::MPI::Vector &,
+    const PETScWrappers::MPI::Vector &) const;
+  template void
+  NewmarkUpdate::correct_from_displacement(const Vector<double> &,
+                                           const Vector<double> &,
+                                           Vector<double> &,
+                                           Vector<double> &,
+                                           Vector<double> &,
+                                           Vector<double> &,
+                                           Vector<double> &) const;
+  template void NewmarkUpdate::correct_from_displacement(
+    const PETScWrappers::MPI::Vector &,
+    const PETScWrappers::MPI::Vector &,
+    PETScWrappers::MPI::Vector &,
+    PETScWrappers::MPI::Vector &,
+    PETScWrappers::MPI::Vector &,
+    PETScWrappers::MPI::Vector &,
+    PETScWrappers::MPI::Vector &) const;
+#ifdef OPENIFEM_WITH_TRILINOS
+  template class PointEvaluator<2, TrilinosWrappers::MPI::BlockVector>;
+  template class PointEvaluator<3, TrilinosWrappers::MPI::BlockVector>;
+  template class GenericVectorPool<TrilinosWrappers::MPI::Vector>;
+  template void
+  NewmarkUpdate::predict(TrilinosWrappers::MPI::Vector &,
+                         const TrilinosWrappers::MPI::Vector &,
+                         const TrilinosWrappers::MPI::Vector &,
+                         const TrilinosWrappers::MPI::Vector &) const;
+  template void
+  NewmarkUpdate::correct(const TrilinosWrappers::MPI::Vector &,
+                         TrilinosWrappers::MPI::Vector &,
+                         TrilinosWrappers::MPI::Vector &,
+                         TrilinosWrappers::MPI::Vector &,
+                         TrilinosWrappers::MPI::Vector &,
+                         TrilinosWrappers::MPI::Vector &) const;
+#endif
+  template void ClosedSurface::reinit(const Triangulation<2> &);
+  template void ClosedSurface::reinit(const Triangulation<3> &);
+  template void ClosedSurface::update(const Triangulation<2> &);
+  template void ClosedSurface::update(const Triangulation<3> &);
+  template void ClosedSurface::update(const std::vector<Point<2>> &);
+  template void ClosedSurface::update(const std::vector<Point<3>> &);
+  template bool ClosedSurface::point_inside(const Point<2> &) const;
+  template bool ClosedSurface::point_inside(const Point<3> &) const;
 } // namespace Utils
@@ -0,0 +1,106 @@
+/**
+ * This program tests InsProjection solver on the Trilinos backend with a 2D
+ * flow around cylinder case.
+ * Hard-coded parabolic velocity input is used, and Re = 20.
+ * The velocity and the Poisson CG are preconditioned with MueLu, and the
+ * solution must agree with that of the solver run on PETSc, whose AMG is
+ * BoomerAMG, up to the tolerance of the linear solves.
+ */
+#include "mpi_insprojection.h"
+
+extern template class Fluid::MPI::InsProjection<2>;
+extern template class Fluid::MPI::InsProjection<3>;
+extern template class Fluid::MPI::InsProjection<2, Utils::TrilinosBackend>;
+extern template class Fluid::MPI::InsProjection<3, Utils::TrilinosBackend>;
+extern template class Utils::GridCreator<2>;
+extern template class Utils::GridCreator<3>;
+
+using namespace dealii;
+
+// Run the flow on a backend and return the norms of the velocity and the
+// pressure at the end.
+template <typename Backend>
+void run(const Parameters::AllParameters &params,
+         double &vnorm,
+         double &pnorm)
+{
+  auto inflow_bc = [](const Point<2> &p,
+                      const unsigned int component,
+                      const double time) -> double {
+    (void)time;
+    if (component == 0 && std::abs(p[0]) < 1e-10)
+      {
+        // For a parabolic velocity profile, Uavg = 2/3 * Umax in 2D.
+        // If nu = 0.001, D = 0.1, then Re = 100 * Uavg
+        double Uavg = 0.2;
+        double Umax = 3 * Uavg / 2;
+        return 4 * Umax * p[1] * (0.41 - p[1]) / (0.41 * 0.41);
+      }
+    return 0.0;
+  };
+
+  parallel::distributed::Triangulation<2> tria(MPI_COMM_WORLD);
+  Utils::GridCreator<2>::flow_around_cylinder(tria);
+  Fluid::MPI::InsProjection<2, Backend> flow(tria, params);
+  flow.add_hard_coded_boundary_condition(0, inflow_bc);
+  flow.run();
+  auto solution = flow.get_current_solution();
+  vnorm = solution.block(0).l2_norm();
+  pnorm = solution.block(1).l2_norm();
+}
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+
+      std::string infile("parameters.prm");
+      if (argc > 1)
+        {
+          infile = argv[1];
+        }
+      Parameters::AllParameters params(infile);
+      AssertThrow(params.dimension == 2,
+                  ExcMessage("This test should be run in 2D!"));
+
+      double vnorm = 0, pnorm = 0;
+      run<Utils::TrilinosBackend>(params, vnorm, pnorm);
+      AssertThrow(std::isfinite(vnorm) && std::isfinite(pnorm),
+                  ExcMessage("The Trilinos solution is not finite!"));
+
+      double vnorm_expected = 0, pnorm_expected = 0;
+      run<Utils::PETScBackend>(params, vnorm_expected, pnorm_expected);
+      double error =
+        std::max(std::abs(vnorm - vnorm_expected) / vnorm_expected,
+                 std::abs(pnorm - pnorm_expected) / pnorm_expected);
+      AssertThrow(error < 1e-4,
+                  ExcMessage("The backends give different solutions!"));
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
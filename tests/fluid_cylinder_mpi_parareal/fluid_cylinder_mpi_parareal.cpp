@@ -0,0 +1,123 @@
+/**
+ * This program tests the Parareal driver of the parallel NavierStokes solver
+ * with a 2D flow around cylinder case.
+ * Hard-coded parabolic velocity input is used, and Re = 20.
+ * The time slices are run by several groups of processes, and the solution
+ * at the end time must agree with that of the solver run in time on all of
+ * the processes.
+ */
+#include "mpi_insim.h"
+#include "mpi_parareal.h"
+#include "parameters.h"
+#include "utilities.h"
+
+extern template class Fluid::MPI::InsIM<2>;
+extern template class Fluid::MPI::InsIM<3>;
+extern template class Fluid::MPI::Parareal<2>;
+extern template class Fluid::MPI::Parareal<3>;
+extern template class Utils::GridCreator<2>;
+extern template class Utils::GridCreator<3>;
+
+using namespace dealii;
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+
+      std::string infile("parameters.prm");
+      if (argc > 1)
+        {
+          infile = argv[1];
+        }
+      Parameters::AllParameters params(infile);
+      AssertThrow(params.dimension == 2,
+                  ExcMessage("This test should be run in 2D!"));
+      AssertThrow(params.parareal_groups > 1,
+                  ExcMessage("This test needs more than one Parareal group!"));
+
+      auto inflow_bc = [](const Point<2> &p,
+                          const unsigned int component,
+                          const double time) -> double {
+        (void)time;
+        if (component == 0 && std::abs(p[0]) < 1e-10)
+          {
+            // For a parabolic velocity profile, Uavg = 2/3 * Umax in 2D.
+            // If nu = 0.001, D = 0.1, then Re = 100 * Uavg
+            double Uavg = 0.2;
+            double Umax = 3 * Uavg / 2;
+            return 4 * Umax * p[1] * (0.41 - p[1]) / (0.41 * 0.41);
+          }
+        return 0.0;
+      };
+
+      // The reference is run in time on all of the processes.
+      double vnorm_expected = 0, pnorm_expected = 0;
+      {
+        parallel::distributed::Triangulation<2> tria(MPI_COMM_WORLD);
+        Utils::GridCreator<2>::flow_around_cylinder(tria);
+        Fluid::MPI::InsIM<2> flow(tria, params);
+        flow.add_hard_coded_boundary_condition(0, inflow_bc);
+        flow.run();
+        auto solution = flow.get_current_solution();
+        vnorm_expected = solution.block(0).l2_norm();
+        pnorm_expected = solution.block(1).l2_norm();
+      }
+
+      // Only the group of the last slice has the solution at the end time.
+      double error = 0;
+      {
+        Fluid::MPI::Parareal<2> parareal(MPI_COMM_WORLD, params);
+        parallel::distributed::Triangulation<2> tria(
+          parareal.get_communicator());
+        Utils::GridCreator<2>::flow_around_cylinder(tria);
+        Fluid::MPI::InsIM<2> fine(tria, parareal.get_fine_parameters());
+        Fluid::MPI::InsIM<2> coarse(tria, parareal.get_coarse_parameters());
+        fine.add_hard_coded_boundary_condition(0, inflow_bc);
+        coarse.add_hard_coded_boundary_condition(0, inflow_bc);
+        parareal.run(fine, coarse);
+        const unsigned int n_slices = static_cast<unsigned int>(std::round(
+          params.end_time / (params.parareal_slice_steps * params.time_step)));
+        if (parareal.get_group() == (n_slices - 1) % params.parareal_groups)
+          {
+            auto solution = fine.get_current_solution();
+            double vnorm = solution.block(0).l2_norm();
+            double pnorm = solution.block(1).l2_norm();
+            error =
+              std::max(std::abs(vnorm - vnorm_expected) / vnorm_expected,
+                       std::abs(pnorm - pnorm_expected) / pnorm_expected);
+          }
+      }
+      error = Utilities::MPI::max(error, MPI_COMM_WORLD);
+      AssertThrow(error < 1e-4,
+                  ExcMessage("Parareal solution differs from the solution "
+                             "run in time!"));
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
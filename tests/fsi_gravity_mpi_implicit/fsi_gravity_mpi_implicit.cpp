@@ -0,0 +1,122 @@
+/**
+ * This program tests the implicit coupling of the parallel FSI solver with
+ * a 2D sphere falling under gravity.
+ * The coupling iterations of every time step must converge, and the solid
+ * displacement must agree with that of the staggered coupling with a 5 times
+ * smaller time step.
+ */
+#include "mpi_fsi.h"
+#include "mpi_insim.h"
+#include "mpi_shared_hyper_elasticity.h"
+
+extern template class Fluid::MPI::InsIM<2>;
+extern template class Fluid::MPI::InsIM<3>;
+extern template class Solid::MPI::SharedHyperElasticity<2>;
+extern template class Solid::MPI::SharedHyperElasticity<3>;
+extern template class Utils::GridCreator<2>;
+extern template class Utils::GridCreator<3>;
+
+extern template class MPI::FSI<2>;
+extern template class MPI::FSI<3>;
+
+using namespace dealii;
+
+// Run the falling sphere, and return the solid displacement at the end and
+// the largest coupling residual.
+PETScWrappers::MPI::Vector run(const Parameters::AllParameters &params,
+                               double &coupling_residual)
+{
+  double L = 1, W = 2, H = 5, R = 0.125, h = 0.25;
+
+  parallel::distributed::Triangulation<2> fluid_tria(MPI_COMM_WORLD);
+  dealii::GridGenerator::subdivided_hyper_rectangle(
+    fluid_tria,
+    {static_cast<unsigned int>(W / h), static_cast<unsigned int>(H / h)},
+    Point<2>(0, 0),
+    Point<2>(W, -H),
+    true);
+  // Refine the middle part
+  for (auto cell : fluid_tria.active_cell_iterators())
+    {
+      auto center = cell->center();
+      if (center[0] >= W / 2 - 2 * R && center[0] <= W / 2 + 2 * R)
+        {
+          cell->set_refine_flag();
+        }
+    }
+  fluid_tria.execute_coarsening_and_refinement();
+  Fluid::MPI::InsIM<2> fluid(fluid_tria, params);
+
+  Triangulation<2> solid_tria;
+  Point<2> center(L, -L);
+  Utils::GridCreator<2>::sphere(solid_tria, center, R);
+  Solid::MPI::SharedHyperElasticity<2> solid(solid_tria, params);
+
+  MPI::FSI<2> fsi(fluid, solid, params, true);
+  fsi.run();
+  coupling_residual = fsi.get_coupling_residual();
+  return solid.get_current_solution();
+}
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      std::string infile("parameters.prm");
+      if (argc > 1)
+        {
+          infile = argv[1];
+        }
+      Parameters::AllParameters params(infile);
+      AssertThrow(params.dimension == 2,
+                  ExcMessage("This test should be run in 2D!"));
+      AssertThrow(params.coupling_iterations > 1,
+                  ExcMessage("This test needs the implicit coupling!"));
+
+      double residual = 0;
+      auto u = run(params, residual);
+      AssertThrow(residual <= params.coupling_tolerance,
+                  ExcMessage("The coupling iterations did not converge!"));
+
+      // The reference is the staggered coupling with a smaller time step.
+      Parameters::AllParameters staggered_params(
+        infile,
+        "FSI control/Coupling iterations = 1|Simulation/Time step size = " +
+          Utilities::to_string(params.time_step / 5));
+      auto u_staggered = run(staggered_params, residual);
+
+      double u_norm = u_staggered.l2_norm();
+      u -= u_staggered;
+      double uerror = u.l2_norm() / u_norm;
+      AssertThrow(uerror < 5e-2,
+                  ExcMessage("Solid displacement differs from the staggered "
+                             "coupling!"));
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * This program tests the restart of the parallel FSI solver from a coupled
+ * checkpoint on a different number of processes, with a 2D sphere falling
+ * under gravity.
+ * It is run twice: "save" runs to half of the end time and saves the
+ * checkpoint, then "restart", on another number of processes, runs from it
+ * to the end time. The solution must agree with that of a run without a
+ * restart on the same processes.
+ */
+#include "mpi_fsi.h"
+#include "mpi_insim.h"
+#include "mpi_shared_hyper_elasticity.h"
+
+#include <experimental/filesystem>
+
+extern template class Fluid::MPI::InsIM<2>;
+extern template class Fluid::MPI::InsIM<3>;
+extern template class Solid::MPI::SharedHyperElasticity<2>;
+extern template class Solid::MPI::SharedHyperElasticity<3>;
+extern template class Utils::GridCreator<2>;
+extern template class Utils::GridCreator<3>;
+
+extern template class MPI::FSI<2>;
+extern template class MPI::FSI<3>;
+
+using namespace dealii;
+namespace fs = std::experimental::filesystem;
+
+// Run the falling sphere in a directory, which is emptied first if fresh is
+// true, and return the norms of the fluid solution and the solid
+// displacement at the end.
+void run(const Parameters::AllParameters &params,
+         const std::string &directory,
+         const bool fresh,
+         double &fluid_norm,
+         double &solid_norm)
+{
+  const fs::path base_path = fs::current_path();
+  if (Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0)
+    {
+      if (fresh)
+        {
+          fs::remove_all(directory);
+        }
+      fs::create_directories(directory);
+    }
+  MPI_Barrier(MPI_COMM_WORLD);
+  fs::current_path(directory);
+  {
+    double L = 1, W = 2, H = 5, R = 0.125, h = 0.25;
+
+    parallel::distributed::Triangulation<2> fluid_tria(MPI_COMM_WORLD);
+    dealii::GridGenerator::subdivided_hyper_rectangle(
+      fluid_tria,
+      {static_cast<unsigned int>(W / h), static_cast<unsigned int>(H / h)},
+      Point<2>(0, 0),
+      Point<2>(W, -H),
+      true);
+    // Refine the middle part
+    for (auto cell : fluid_tria.active_cell_iterators())
+      {
+        auto center = cell->center();
+        if (center[0] >= W / 2 - 2 * R && center[0] <= W / 2 + 2 * R)
+          {
+            cell->set_refine_flag();
+          }
+      }
+    fluid_tria.execute_coarsening_and_refinement();
+    Fluid::MPI::InsIM<2> fluid(fluid_tria, params);
+
+    Triangulation<2> solid_tria;
+    Point<2> center(L, -L);
+    Utils::GridCreator<2>::sphere(solid_tria, center, R);
+    Solid::MPI::SharedHyperElasticity<2> solid(solid_tria, params);
+
+    MPI::FSI<2> fsi(fluid, solid, params, true);
+    fsi.run();
+    fluid_norm = fluid.get_current_solution().l2_norm();
+    solid_norm = solid.get_current_solution().l2_norm();
+  }
+  fs::current_path(base_path);
+}
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+      std::string infile("parameters.prm");
+      if (argc > 1)
+        {
+          infile = argv[1];
+        }
+      const std::string stage(argc > 2 ? argv[2] : "restart");
+      Parameters::AllParameters params(infile);
+      AssertThrow(params.dimension == 2,
+                  ExcMessage("This test should be run in 2D!"));
+      AssertThrow(params.checkpoint_format == "coupled",
+                  ExcMessage("This test needs the coupled checkpoints!"));
+
+      double fluid_norm = 0, solid_norm = 0;
+      if (stage == "save")
+        {
+          Parameters::AllParameters half_params(
+            infile,
+            "Simulation/End time = " +
+              Utilities::to_string(params.end_time / 2));
+          run(half_params, "checkpoint", true, fluid_norm, solid_norm);
+          return 0;
+        }
+      AssertThrow(stage == "restart",
+                  ExcMessage("The stage must be save or restart!"));
+
+      // Without a checkpoint the run would start from the beginning.
+      bool found = false;
+      if (fs::exists("checkpoint"))
+        {
+          for (const auto &p : fs::directory_iterator("checkpoint"))
+            {
+              found = found || p.path().extension() == ".fsi_checkpoint";
+            }
+        }
+      AssertThrow(found,
+                  ExcMessage("Run the save stage before the restart!"));
+      run(params, "checkpoint", false, fluid_norm, solid_norm);
+
+      double fluid_reference = 0, solid_reference = 0;
+      run(params, "reference", true, fluid_reference, solid_reference);
+      double ferror = std::abs(fluid_norm - fluid_reference) / fluid_reference;
+      double serror = std::abs(solid_norm - solid_reference) / solid_reference;
+      AssertThrow(ferror < 1e-4 && serror < 1e-4,
+                  ExcMessage("The restarted solution is incorrect!"));
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Run an MPI test in the performance mode and compare it to a baseline.
+
+The test writes one JSON line per solver to the performance summary, with
+the wall times of its timer sections and its counters, e.g. the number of
+Krylov iterations. The run fails if a section or a counter exceeds the
+baseline by more than the tolerance, or if the baseline is missing.
+
+The committed baselines are only read. --update records the run to --record
+instead, in the build tree, and passes; the recording is reviewed and copied
+over the baseline by hand.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+
+def read_summary(filename):
+    """Merge the lines of a summary into {solver: {quantity: value}}."""
+    results = {}
+    with open(filename) as summary:
+        for line in summary:
+            if not line.strip():
+                continue
+            entry = json.loads(line)
+            solver = results.setdefault(entry["name"], {})
+            for group in ("sections", "counters"):
+                for key, value in entry.get(group, {}).items():
+                    solver[key] = solver.get(key, 0.0) + value
+    return results
+
+
+def compare(results, baseline, tolerance):
+    """Return the quantities that are slower than the baseline."""
+    failures = []
+    for solver, quantities in sorted(baseline.items()):
+        for key, reference in sorted(quantities.items()):
+            value = results.get(solver, {}).get(key)
+            if value is None:
+                continue
+            if value > reference * (1.0 + tolerance):
+                failures.append("{}/{}: {:.4g} > {:.4g} (+{:.0f}%)".format(
+                    solver, key, value, reference, tolerance * 100.0))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--summary", required=True,
+                        help="the summary file written by the test")
+    parser.add_argument("--baseline", required=True,
+                        help="the baseline of the test")
+    parser.add_argument("--tolerance", type=float, default=0.2,
+                        help="the allowed relative slowdown")
+    parser.add_argument("--update", action="store_true",
+                        help="record this run to --record instead of "
+                        "comparing it")
+    parser.add_argument("--record",
+                        help="the file that --update records the run to")
+    parser.add_argument("command", nargs=argparse.REMAINDER,
+                        help="the command that runs the test, after --")
+    args = parser.parse_args()
+
+    command = args.command[1:] if args.command[:1] == ["--"] else args.command
+    if args.update and not args.record:
+        parser.error("--update needs --record")
+    if os.path.exists(args.summary):
+        os.remove(args.summary)
+    status = subprocess.call(command)
+    if status != 0:
+        return status
+    if not os.path.exists(args.summary):
+        print("The test did not write " + args.summary)
+        return 1
+    results = read_summary(args.summary)
+
+    if args.update:
+        directory = os.path.dirname(os.path.abspath(args.record))
+        if not os.path.isdir(directory):
+            os.makedirs(directory)
+        with open(args.record, "w") as record:
+            json.dump(results, record, indent=2, sort_keys=True)
+            record.write("\n")
+        print("Recorded the run to " + args.record)
+        return 0
+
+    if not os.path.exists(args.baseline):
+        print("The baseline " + args.baseline + " is missing, record it with "
+              "--update")
+        return 1
+
+    with open(args.baseline) as baseline:
+        failures = compare(results, json.load(baseline), args.tolerance)
+    for failure in failures:
+        print(failure)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,83 @@
+/**
+ * This program tests the parallel linear elastic solver on the Trilinos
+ * backend with a 2D bending beam case. Constant traction is applied to the
+ * upper surface, and the CG is preconditioned with MueLu.
+ * The minimum displacement must agree with the reference of the PETSc test
+ * and with the solver run on PETSc.
+ */
+#include "mpi_linear_elasticity.h"
+
+extern template class Solid::MPI::LinearElasticity<2>;
+extern template class Solid::MPI::LinearElasticity<3>;
+extern template class Solid::MPI::LinearElasticity<2, Utils::TrilinosBackend>;
+extern template class Solid::MPI::LinearElasticity<3, Utils::TrilinosBackend>;
+
+// Run the bending beam on a backend and return the minimum displacement.
+template <typename Backend>
+double run(const Parameters::AllParameters &params)
+{
+  using namespace dealii;
+
+  double L = 8.0, H = 1.0;
+  parallel::distributed::Triangulation<2> tria(MPI_COMM_WORLD);
+  dealii::GridGenerator::subdivided_hyper_rectangle(
+    tria, {32, 4}, Point<2>(0, 0), Point<2>(L, H), true);
+  Solid::MPI::LinearElasticity<2, Backend> solid(tria, params);
+  solid.run();
+  return solid.get_current_solution().min();
+}
+
+int main(int argc, char *argv[])
+{
+  using namespace dealii;
+
+  try
+    {
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+
+      std::string infile("parameters.prm");
+      if (argc > 1)
+        {
+          infile = argv[1];
+        }
+      Parameters::AllParameters params(infile);
+      AssertThrow(params.dimension == 2,
+                  ExcMessage("This test should be run in 2D!"));
+
+      double umin = run<Utils::TrilinosBackend>(params);
+      double uerror = std::abs(umin + 0.1337) / 0.1337;
+      AssertThrow(uerror < 1e-3,
+                  ExcMessage("Minimum displacement is incorrect!"));
+
+      double umin_petsc = run<Utils::PETScBackend>(params);
+      double berror = std::abs(umin - umin_petsc) / std::abs(umin_petsc);
+      AssertThrow(berror < 1e-5,
+                  ExcMessage("The backends give different displacements!"));
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl
+                << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  return 0;
+}